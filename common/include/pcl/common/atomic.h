@@ -0,0 +1,104 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_COMMON_ATOMIC_H_
+#define PCL_COMMON_ATOMIC_H_
+
+#if defined _MSC_VER
+#  include <intrin.h>
+#endif
+
+namespace pcl
+{
+  /** \brief Atomically replace the value pointed to by \a ptr with \a desired, if it is equal to \a expected.
+    * The operation is a full memory barrier.
+    * \param[in,out] ptr the address of the value to update
+    * \param[in] expected the value \a ptr must hold for the update to happen
+    * \param[in] desired the value to store
+    * \return true if the value was replaced, false if it did not hold \a expected
+    * \ingroup common
+    */
+  inline bool
+  atomicCompareAndSwap (volatile int *ptr, int expected, int desired)
+  {
+#if defined _MSC_VER
+    return (_InterlockedCompareExchange (reinterpret_cast<volatile long*> (ptr), desired, expected) == expected);
+#else
+    return (__sync_bool_compare_and_swap (ptr, expected, desired));
+#endif
+  }
+
+  /** \brief Read the value pointed to by \a ptr, with acquire semantics: the memory operations that follow the
+    * read are not moved before it. Pairs with \ref atomicStoreRelease.
+    * \param[in] ptr the address of the value to read
+    * \ingroup common
+    */
+  inline int
+  atomicLoadAcquire (const volatile int *ptr)
+  {
+    const int value = *ptr;
+#if defined _MSC_VER
+    _ReadWriteBarrier ();
+#elif defined __i386__ || defined __x86_64__
+    __asm__ __volatile__ ("" ::: "memory");
+#else
+    __sync_synchronize ();
+#endif
+    return (value);
+  }
+
+  /** \brief Write \a value to the address \a ptr, with release semantics: the memory operations that precede
+    * the write are not moved after it. Pairs with \ref atomicLoadAcquire.
+    * \param[out] ptr the address of the value to write
+    * \param[in] value the value to store
+    * \ingroup common
+    */
+  inline void
+  atomicStoreRelease (volatile int *ptr, int value)
+  {
+#if defined _MSC_VER
+    _ReadWriteBarrier ();
+#elif defined __i386__ || defined __x86_64__
+    __asm__ __volatile__ ("" ::: "memory");
+#else
+    __sync_synchronize ();
+#endif
+    *ptr = value;
+  }
+}
+
+#endif  // PCL_COMMON_ATOMIC_H_
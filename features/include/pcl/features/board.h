@@ -251,6 +251,13 @@ namespace pcl
       virtual void
       computeFeature (PointCloudOut &output);
 
+      /** \brief Create a copy of the estimator for indices_[begin, end), see Feature::makeChunkEstimator. */
+      virtual typename Feature<PointInT, PointOutT>::Ptr
+      makeChunkEstimator (size_t begin, size_t end) const
+      {
+        return (Feature<PointInT, PointOutT>::copyForChunk (*this, begin, end));
+      }
+
       /** \brief Abstract feature estimation method.
         * \param[out] output the resultant features
         */
@@ -171,6 +171,13 @@ namespace pcl
       void 
       computeFeature (PointCloudOut &output);
 
+      /** \brief Create a copy of the estimator for indices_[begin, end), see Feature::makeChunkEstimator. */
+      virtual typename Feature<PointInT, PointOutT>::Ptr
+      makeChunkEstimator (size_t begin, size_t end) const
+      {
+        return (Feature<PointInT, PointOutT>::copyForChunk (*this, begin, end));
+      }
+
       /** \brief The decision boundary (angle threshold) that marks points as boundary or regular. (default \f$\pi / 2.0\f$) */
       float angle_threshold_;
 
@@ -46,6 +46,7 @@
 #include <pcl/common/centroid.h>
 #include <pcl/search/search.h>
 #include <pcl/features/boost.h>
+#include <typeinfo>
 
 namespace pcl
 {
@@ -127,7 +128,7 @@ namespace pcl
         feature_name_ (), search_method_surface_ (),
         surface_(), tree_(),
         search_parameter_(0), search_radius_(0), k_(0),
-        fake_surface_(false)
+        fake_surface_(false), threads_ (1)
       {}
 
       /** \brief Provide a pointer to a dataset to add additional information
@@ -202,6 +203,19 @@ namespace pcl
         return (search_radius_);
       }
 
+      /** \brief Set the number of threads \ref compute may use. The indices are split into chunks, and every chunk is
+        * processed by its own copy of the estimator, so the result is the same as with a single thread. Estimators
+        * that do not support chunked computation (see \ref makeChunkEstimator) run computeFeature as a whole, which
+        * may use the threads internally (e.g. \ref FPFHEstimation and the OpenMP estimators).
+        * \param[in] nr_threads the number of threads to use (default: 1, 0 sets the value to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads \ref compute may use (0 means automatic). */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Base method for feature estimation for all points given in
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface ()
         * and the spatial locator in setSearchMethod ()
@@ -257,6 +271,41 @@ namespace pcl
       /** \brief If no surface is given, we use the input PointCloud as the surface. */
       bool fake_surface_;
 
+      /** \brief The number of threads \ref compute may use (0 means automatic). */
+      unsigned int threads_;
+
+      /** \brief Create an estimator that computes the features of indices_[begin, end) with its own scratch state,
+        * to run concurrently with the others in \ref compute. It is called after \ref initCompute, so the copy shares
+        * the input, the surface and the search object, which are only read. Estimators whose computeFeature is a
+        * loop over indices_ without state carried from one point to the next enable chunked computation by
+        * returning copyForChunk (*this, begin, end); the default returns an empty pointer, and compute () stays serial.
+        * \param[in] begin the first position in indices_ of the chunk
+        * \param[in] end the position in indices_ past the last point of the chunk
+        */
+      virtual Ptr
+      makeChunkEstimator (size_t, size_t) const
+      {
+        return (Ptr ());
+      }
+
+      /** \brief Copy an estimator and restrict the copy to indices_[begin, end). A derived class that does not
+        * override \ref makeChunkEstimator would be sliced to EstimatorT by the copy, so an empty pointer is returned
+        * instead, and compute () stays serial.
+        * \param[in] estimator the estimator to copy
+        * \param[in] begin the first position in indices_ of the chunk
+        * \param[in] end the position in indices_ past the last point of the chunk
+        */
+      template <typename EstimatorT> static boost::shared_ptr<EstimatorT>
+      copyForChunk (const EstimatorT &estimator, size_t begin, size_t end)
+      {
+        if (typeid (estimator) != typeid (EstimatorT))
+          return (boost::shared_ptr<EstimatorT> ());
+        boost::shared_ptr<EstimatorT> copy (new EstimatorT (estimator));
+        Feature<PointInT, PointOutT> &chunk = *copy;
+        chunk.indices_.reset (new std::vector<int> (chunk.indices_->begin () + begin, chunk.indices_->begin () + end));
+        return (copy);
+      }
+
       /** \brief Search for k-nearest neighbors using the spatial locator from
         * \a setSearchmethod, and the given surface from \a setSearchSurface.
         * \param[in] index the index of the query point
@@ -292,6 +341,39 @@ namespace pcl
         return (search_method_surface_ (cloud, index, parameter, indices, distances));
       }
 
+      /** \brief Search for k-nearest neighbors using the spatial locator from \a setSearchmethod, and the given
+        * surface from \a setSearchSurface, storing the result in a reusable NeighborList. When the list is reused
+        * across queries (e.g., one per thread), no heap allocation takes place in steady state.
+        * \param[in] index the index of the query point
+        * \param[in] parameter the search parameter (either k or radius)
+        * \param[out] neighbors the resultant neighbors
+        *
+        * \return the number of neighbors found. If no neighbors are found or an error occurred, return 0.
+        */
+      inline int
+      searchForNeighbors (size_t index, double parameter, pcl::search::NeighborList &neighbors) const
+      {
+        return (searchForNeighbors (*input_, index, parameter, neighbors));
+      }
+
+      /** \brief Search for k-nearest neighbors using the spatial locator from \a setSearchmethod, and the given
+        * surface from \a setSearchSurface, storing the result in a reusable NeighborList.
+        * \param[in] cloud the query point cloud
+        * \param[in] index the index of the query point in \a cloud
+        * \param[in] parameter the search parameter (either k or radius)
+        * \param[out] neighbors the resultant neighbors
+        *
+        * \return the number of neighbors found. If no neighbors are found or an error occurred, return 0.
+        */
+      inline int
+      searchForNeighbors (const PointCloudIn &cloud, size_t index, double parameter,
+                          pcl::search::NeighborList &neighbors) const
+      {
+        if (k_ != 0)
+          return (tree_->nearestKSearch (cloud, static_cast<int> (index), static_cast<int> (parameter), neighbors));
+        return (tree_->radiusSearch (cloud, static_cast<int> (index), parameter, neighbors, 0));
+      }
+
     private:
       /** \brief Abstract feature estimation method.
         * \param[out] output the resultant features
@@ -41,6 +41,7 @@
 #define PCL_FPFH_H_
 
 #include <pcl/features/feature.h>
+#include <pcl/kdtree/kdtree_flann.h>
 #include <set>
 
 namespace pcl
@@ -69,8 +70,9 @@ namespace pcl
     *     doesn't have finite 3D coordinates. Therefore, any point that contains
     *     NaN data on x, y, or z, will have its FPFH feature property set to NaN.
     *
-    * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref FPFHEstimationOMP for examples on parallel implementations of the FPFH (Fast Point Feature Histogram).
+    * \note The neighborhood of every query point is searched once, and kept for both the SPFH and the weighting
+    * step. Both steps run on the number of threads given by setNumberOfThreads (); \ref FPFHEstimationOMP
+    * shares the same implementation.
     *
     * \author Radu B. Rusu
     * \ingroup features
@@ -93,7 +95,7 @@ namespace pcl
       /** \brief Empty constructor. */
       FPFHEstimation () : 
         nr_bins_f1_ (11), nr_bins_f2_ (11), nr_bins_f3_ (11), 
-        hist_f1_ (), hist_f2_ (), hist_f3_ (), fpfh_histogram_ (),
+        hist_f1_ (), hist_f2_ (), hist_f3_ (), fpfh_histogram_ (), query_neighbors_ (),
         d_pi_ (1.0f / (2.0f * static_cast<float> (M_PI)))
       {
         feature_name_ = "FPFHEstimation";
@@ -178,7 +180,8 @@ namespace pcl
 
     protected:
 
-      /** \brief Estimate the set of all SPFH (Simple Point Feature Histograms) signatures for the input cloud
+      /** \brief Estimate the set of all SPFH (Simple Point Feature Histograms) signatures for the input cloud, on a
+        * single thread. The neighborhoods of the query points are kept in query_neighbors_.
         * \param[out] spfh_hist_lookup a lookup table for all the SPF feature indices
         * \param[out] hist_f1 the resultant SPFH histogram for feature f1
         * \param[out] hist_f2 the resultant SPFH histogram for feature f2
@@ -188,6 +191,52 @@ namespace pcl
       computeSPFHSignatures (std::vector<int> &spf_hist_lookup, 
                              Eigen::MatrixXf &hist_f1, Eigen::MatrixXf &hist_f2, Eigen::MatrixXf &hist_f3);
 
+      /** \brief Estimate the SPFH signatures of all the surface points needed by the query points. A surface point
+        * that is also a query point reuses its neighborhood from \a query_neighbors instead of searching it again.
+        * \param[in] query_neighbors the neighborhoods of the query points, see \ref searchQueryNeighborhoods
+        * \param[out] spfh_hist_lookup a lookup table for all the SPF feature indices
+        * \param[out] hist_f1 the resultant SPFH histogram for feature f1
+        * \param[out] hist_f2 the resultant SPFH histogram for feature f2
+        * \param[out] hist_f3 the resultant SPFH histogram for feature f3
+        * \param[in] nr_threads the number of threads to use
+        */
+      void 
+      computeSPFHSignatures (const NeighborsCSR &query_neighbors, std::vector<int> &spfh_hist_lookup,
+                             Eigen::MatrixXf &hist_f1, Eigen::MatrixXf &hist_f2, Eigen::MatrixXf &hist_f3,
+                             int nr_threads);
+
+      /** \brief Search the neighborhoods of all the points in indices_, one query per position in indices_. The
+        * neighborhood of a point without finite 3D coordinates is left empty.
+        * \param[out] neighbors the neighborhoods of the query points
+        * \param[in] nr_threads the number of threads to use
+        */
+      void
+      searchQueryNeighborhoods (NeighborsCSR &neighbors, int nr_threads);
+
+      /** \brief Weight the SPFH signatures over the neighborhood of a query point, as found by
+        * \ref searchQueryNeighborhoods.
+        * \param[in] query_neighbors the neighborhoods of the query points
+        * \param[in] query the position of the query point in indices_
+        * \param[in] spfh_hist_lookup the lookup table filled by \ref computeSPFHSignatures
+        * \param[out] nn_indices scratch space for the rows of the neighbors in the spfh_hist_* matrices
+        * \param[out] nn_dists scratch space for the distances to the neighbors
+        * \param[out] fpfh_histogram the resultant FPFH histogram representing the feature at the query point
+        * \return false if the query point has no neighbors, true otherwise
+        */
+      bool
+      weightQuerySPFHSignature (const NeighborsCSR &query_neighbors, size_t query,
+                                const std::vector<int> &spfh_hist_lookup,
+                                std::vector<int> &nn_indices, std::vector<float> &nn_dists,
+                                Eigen::VectorXf &fpfh_histogram);
+
+      /** \brief Estimate the FPFH descriptors of all the points in indices_: search the query neighborhoods once,
+        * then compute the SPFH signatures and weight them, with both steps in parallel.
+        * \param[out] output the resultant FPFH descriptors
+        * \param[in] nr_threads the number of threads to use (0 sets the value to automatic)
+        */
+      void
+      computeFPFHSignatures (PointCloudOut &output, unsigned int nr_threads);
+
       /** \brief Estimate the Fast Point Feature Histograms (FPFH) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
         * setSearchMethod ()
@@ -211,6 +260,9 @@ namespace pcl
       /** \brief Placeholder for a point's FPFH signature. */
       Eigen::VectorXf fpfh_histogram_;
 
+      /** \brief The neighborhoods of the query points, searched once per compute () call. */
+      NeighborsCSR query_neighbors_;
+
       /** \brief Float constant = 1.0 / (2.0 * M_PI) */
       float d_pi_; 
 
@@ -266,6 +318,7 @@ namespace pcl
       using FPFHEstimation<PointInT, PointNT, pcl::FPFHSignature33>::input_;
       using FPFHEstimation<PointInT, PointNT, pcl::FPFHSignature33>::compute;
       using FPFHEstimation<PointInT, PointNT, pcl::FPFHSignature33>::fpfh_histogram_;
+      using FPFHEstimation<PointInT, PointNT, pcl::FPFHSignature33>::query_neighbors_;
 
     private:
       /** \brief Estimate the Fast Point Feature Histograms (FPFH) descriptors at a set of points given by
@@ -41,6 +41,9 @@
 #define PCL_FEATURES_IMPL_FEATURE_H_
 
 #include <pcl/search/pcl_search.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 inline void
@@ -213,8 +216,73 @@ pcl::Feature<PointInT, PointOutT>::compute (PointCloudOut &output)
   }
   output.is_dense = input_->is_dense;
 
+#ifdef _OPENMP
+  const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#else
+  const int threads = 1;
+#endif
+
+  // Split the indices in a few chunks per thread, to balance the load
+  std::vector<Ptr> chunk_estimators;
+  std::vector<size_t> chunk_begin;
+  if (threads > 1 && indices_->size () > 1)
+  {
+    const size_t nr_chunks = (std::min) (indices_->size (), static_cast<size_t> (threads) * 4);
+    for (size_t c = 0; c <= nr_chunks; ++c)
+      chunk_begin.push_back (indices_->size () * c / nr_chunks);
+    for (size_t c = 0; c < nr_chunks; ++c)
+    {
+      Ptr estimator = makeChunkEstimator (chunk_begin[c], chunk_begin[c + 1]);
+      if (!estimator)
+      {
+        chunk_estimators.clear ();
+        break;
+      }
+      chunk_estimators.push_back (estimator);
+    }
+  }
+
   // Perform the actual feature computation
-  computeFeature (output);
+  if (chunk_estimators.empty ())
+    computeFeature (output);
+  else
+  {
+    const int nr_chunks = static_cast<int> (chunk_estimators.size ());
+    std::vector<int> chunk_valid (nr_chunks), chunk_dense (nr_chunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+#endif
+    for (int c = 0; c < nr_chunks; ++c)
+    {
+      const size_t chunk_size = chunk_begin[c + 1] - chunk_begin[c];
+      PointCloudOut chunk_output;
+      chunk_output.header = output.header;
+      chunk_output.points.resize (chunk_size);
+      chunk_output.width = static_cast<uint32_t> (chunk_size);
+      chunk_output.height = 1;
+      chunk_output.is_dense = output.is_dense;
+
+      chunk_estimators[c]->computeFeature (chunk_output);
+
+      chunk_valid[c] = (chunk_output.points.size () == chunk_size);
+      chunk_dense[c] = chunk_output.is_dense;
+      if (chunk_valid[c])
+        std::copy (chunk_output.points.begin (), chunk_output.points.end (), output.points.begin () + chunk_begin[c]);
+    }
+
+    for (int c = 0; c < nr_chunks; ++c)
+    {
+      // An estimator that fails clears its output
+      if (!chunk_valid[c])
+      {
+        output.width = output.height = 0;
+        output.points.clear ();
+        break;
+      }
+      if (!chunk_dense[c])
+        output.is_dense = false;
+    }
+  }
 
   deinitCompute ();
 }
@@ -173,130 +173,233 @@ template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeSPFHSignatures (std::vector<int> &spfh_hist_lookup,
     Eigen::MatrixXf &hist_f1, Eigen::MatrixXf &hist_f2, Eigen::MatrixXf &hist_f3)
 {
-  // Allocate enough space to hold the NN search results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
+  searchQueryNeighborhoods (query_neighbors_, 1);
+  computeSPFHSignatures (query_neighbors_, spfh_hist_lookup, hist_f1, hist_f2, hist_f3, 1);
+}
 
-  std::set<int> spfh_indices;
-  spfh_hist_lookup.resize (surface_->points.size ());
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeSPFHSignatures (const NeighborsCSR &query_neighbors,
+    std::vector<int> &spfh_hist_lookup, Eigen::MatrixXf &hist_f1, Eigen::MatrixXf &hist_f2, Eigen::MatrixXf &hist_f3,
+    int nr_threads)
+{
+  std::vector<int> spfh_indices;
+  spfh_hist_lookup.assign (surface_->points.size (), 0);
 
   // Build a list of (unique) indices for which we will need to compute SPFH signatures
   // (We need an SPFH signature for every point that is a neighbor of any point in input_[indices_])
   if (surface_ != input_ ||
       indices_->size () != surface_->points.size ())
   { 
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
-    {
-      int p_idx = (*indices_)[idx];
-      if (this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-        continue;
-
-      spfh_indices.insert (nn_indices.begin (), nn_indices.end ());
-    }
+    std::vector<bool> is_neighbor (surface_->points.size (), false);
+    for (size_t i = 0; i < query_neighbors.indices.size (); ++i)
+      is_neighbor[query_neighbors.indices[i]] = true;
+    for (int p_idx = 0; p_idx < static_cast<int> (is_neighbor.size ()); ++p_idx)
+      if (is_neighbor[p_idx])
+        spfh_indices.push_back (p_idx);
   }
   else
   {
-    // Special case: When a feature must be computed at every point, there is no need for a neighborhood search
+    // Special case: When a feature must be computed at every point, there is no need to collect the neighbors
+    spfh_indices.resize (indices_->size ());
+    for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
+      spfh_indices[idx] = idx;
+  }
+
+  // The neighborhood of a surface point that is also a query point has been searched already
+  std::vector<int> query_lookup;
+  if (surface_ == input_)
+  {
+    query_lookup.assign (surface_->points.size (), -1);
     for (size_t idx = 0; idx < indices_->size (); ++idx)
-      spfh_indices.insert (static_cast<int> (idx));
+      query_lookup[(*indices_)[idx]] = static_cast<int> (idx);
   }
 
   // Initialize the arrays that will store the SPFH signatures
-  size_t data_size = spfh_indices.size ();
+  int data_size = static_cast<int> (spfh_indices.size ());
   hist_f1.setZero (data_size, nr_bins_f1_);
   hist_f2.setZero (data_size, nr_bins_f2_);
   hist_f3.setZero (data_size, nr_bins_f3_);
 
+  // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
+  for (int i = 0; i < data_size; ++i)
+    spfh_hist_lookup[spfh_indices[i]] = i;
+
   // Compute SPFH signatures for every point that needs them
-  std::set<int>::iterator spfh_indices_itr = spfh_indices.begin ();
-  for (int i = 0; i < static_cast<int> (spfh_indices.size ()); ++i)
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nr_threads)
+#endif
   {
-    // Get the next point index
-    int p_idx = *spfh_indices_itr;
-    ++spfh_indices_itr;
+    pcl::search::NeighborList neighbors;
+    std::vector<int> nn_indices;
 
-    // Find the neighborhood around p_idx
-    if (this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-      continue;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+    for (int i = 0; i < data_size; ++i)
+    {
+      int p_idx = spfh_indices[i];
+      int query = query_lookup.empty () ? -1 : query_lookup[p_idx];
 
-    // Estimate the SPFH signature around p_idx
-    computePointSPFHSignature (*surface_, *normals_, p_idx, i, nn_indices, hist_f1, hist_f2, hist_f3);
+      // Get the neighborhood around p_idx
+      if (query >= 0)
+      {
+        if (query_neighbors.getNumberOfNeighbors (query) == 0)
+          continue;
+        nn_indices.assign (query_neighbors.indices.begin () + query_neighbors.offsets[query],
+                           query_neighbors.indices.begin () + query_neighbors.offsets[query + 1]);
+      }
+      else
+      {
+        if (this->searchForNeighbors (*surface_, p_idx, search_parameter_, neighbors) == 0)
+          continue;
+        nn_indices.assign (neighbors.indices (), neighbors.indices () + neighbors.size ());
+      }
 
-    // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
-    spfh_hist_lookup[p_idx] = i;
+      // Estimate the SPFH signature around p_idx
+      computePointSPFHSignature (*surface_, *normals_, p_idx, i, nn_indices, hist_f1, hist_f2, hist_f3);
+    }
   }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
-pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::searchQueryNeighborhoods (NeighborsCSR &neighbors, int nr_threads)
 {
-  // Allocate enough space to hold the NN search results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
-
-  std::vector<int> spfh_hist_lookup;
-  computeSPFHSignatures (spfh_hist_lookup, hist_f1_, hist_f2_, hist_f3_);
-
-  output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
+  // Split the queries in a few blocks per thread. Every block collects its neighborhoods in its own lists, which
+  // are concatenated in order afterwards, so the result does not depend on the scheduling.
+  const size_t nr_queries = indices_->size ();
+  const int nr_blocks = static_cast<int> ((std::max) (static_cast<size_t> (1),
+                                          (std::min) (nr_queries, static_cast<size_t> (nr_threads) * 4)));
+  std::vector<size_t> block_begin (nr_blocks + 1);
+  for (int b = 0; b <= nr_blocks; ++b)
+    block_begin[b] = nr_queries * b / nr_blocks;
+  std::vector<NeighborsCSR> blocks (nr_blocks);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads)
+#endif
+  for (int b = 0; b < nr_blocks; ++b)
   {
-    // Iterate over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+    pcl::search::NeighborList neighbors;
+
+    NeighborsCSR &block = blocks[b];
+    block.offsets.reserve (block_begin[b + 1] - block_begin[b] + 1);
+    block.offsets.push_back (0);
+    for (size_t idx = block_begin[b]; idx < block_begin[b + 1]; ++idx)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      int p_idx = (*indices_)[idx];
+      if ((input_->is_dense || isFinite ((*input_)[p_idx])) &&
+          this->searchForNeighbors (p_idx, search_parameter_, neighbors) != 0)
       {
-        for (int d = 0; d < fpfh_histogram_.size (); ++d)
-          output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
-    
-        output.is_dense = false;
-        continue;
+        block.indices.insert (block.indices.end (), neighbors.indices (), neighbors.indices () + neighbors.size ());
+        block.sqr_distances.insert (block.sqr_distances.end (),
+                                    neighbors.sqrDistances (), neighbors.sqrDistances () + neighbors.size ());
       }
+      block.offsets.push_back (static_cast<int> (block.indices.size ()));
+    }
+  }
 
-      // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
-      // instead of indices into surface_->points
-      for (size_t i = 0; i < nn_indices.size (); ++i)
-        nn_indices[i] = spfh_hist_lookup[nn_indices[i]];
+  std::vector<int> block_start (nr_blocks + 1, 0);
+  for (int b = 0; b < nr_blocks; ++b)
+    block_start[b + 1] = block_start[b] + static_cast<int> (blocks[b].indices.size ());
 
-      // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-      weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram_);
+  neighbors.offsets.resize (nr_queries + 1);
+  neighbors.indices.resize (block_start[nr_blocks]);
+  neighbors.sqr_distances.resize (block_start[nr_blocks]);
+  neighbors.offsets[0] = 0;
 
-      // ...and copy it into the output cloud
-      for (int d = 0; d < fpfh_histogram_.size (); ++d)
-        output.points[idx].histogram[d] = fpfh_histogram_[d];
-    }
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads)
+#endif
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    const NeighborsCSR &block = blocks[b];
+    for (size_t q = 1; q < block.offsets.size (); ++q)
+      neighbors.offsets[block_begin[b] + q] = block_start[b] + block.offsets[q];
+    std::copy (block.indices.begin (), block.indices.end (), neighbors.indices.begin () + block_start[b]);
+    std::copy (block.sqr_distances.begin (), block.sqr_distances.end (), neighbors.sqr_distances.begin () + block_start[b]);
   }
-  else
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::weightQuerySPFHSignature (
+    const NeighborsCSR &query_neighbors, size_t query, const std::vector<int> &spfh_hist_lookup,
+    std::vector<int> &nn_indices, std::vector<float> &nn_dists, Eigen::VectorXf &fpfh_histogram)
+{
+  const int begin = query_neighbors.offsets[query], end = query_neighbors.offsets[query + 1];
+  if (begin == end)
+    return (false);
+
+  // Remap the neighbors so that they represent row indices in the spfh_hist_* matrices
+  // instead of indices into surface_->points
+  nn_indices.resize (end - begin);
+  for (int i = begin; i < end; ++i)
+    nn_indices[i - begin] = spfh_hist_lookup[query_neighbors.indices[i]];
+  nn_dists.assign (query_neighbors.sqr_distances.begin () + begin, query_neighbors.sqr_distances.begin () + end);
+
+  // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures)
+  weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeFPFHSignatures (PointCloudOut &output, unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  const int threads = nr_threads ? static_cast<int> (nr_threads) : omp_get_max_threads ();
+#else
+  const int threads = 1;
+  (void)nr_threads;
+#endif
+
+  // Search every query neighborhood once, for both the SPFH and the weighting step
+  searchQueryNeighborhoods (query_neighbors_, threads);
+
+  std::vector<int> spfh_hist_lookup;
+  computeSPFHSignatures (query_neighbors_, spfh_hist_lookup, hist_f1_, hist_f2_, hist_f3_, threads);
+
+  const int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
+  int is_dense = 1;
+
+  // Iterate over the entire index vector
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads) reduction(&&:is_dense)
+#endif
   {
-    // Iterate over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+    std::vector<int> nn_indices;
+    std::vector<float> nn_dists;
+    Eigen::VectorXf fpfh_histogram;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+    for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
     {
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      if (!weightQuerySPFHSignature (query_neighbors_, idx, spfh_hist_lookup, nn_indices, nn_dists, fpfh_histogram))
       {
-        for (int d = 0; d < fpfh_histogram_.size (); ++d)
+        for (int d = 0; d < nr_bins; ++d)
           output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
-    
-        output.is_dense = false;
+
+        is_dense = 0;
         continue;
       }
 
-      // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
-      // instead of indices into surface_->points
-      for (size_t i = 0; i < nn_indices.size (); ++i)
-        nn_indices[i] = spfh_hist_lookup[nn_indices[i]];
-
-      // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-      weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram_);
-
       // ...and copy it into the output cloud
-      for (int d = 0; d < fpfh_histogram_.size (); ++d)
-        output.points[idx].histogram[d] = fpfh_histogram_[d];
+      for (int d = 0; d < nr_bins; ++d)
+        output.points[idx].histogram[d] = fpfh_histogram[d];
     }
   }
+  output.is_dense = (is_dense != 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  computeFPFHSignatures (output, this->threads_);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -310,62 +413,29 @@ pcl::FPFHEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pc
   output.channels["fpfh"].count    = 33;
   output.channels["fpfh"].datatype = sensor_msgs::PointField::FLOAT32;
 
-  // Allocate enough space to hold the NN search results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
+  // Search every query neighborhood once, for both the SPFH and the weighting step
+  this->searchQueryNeighborhoods (query_neighbors_, 1);
 
   std::vector<int> spfh_hist_lookup;
-  this->computeSPFHSignatures (spfh_hist_lookup, hist_f1_, hist_f2_, hist_f3_);
+  this->computeSPFHSignatures (query_neighbors_, spfh_hist_lookup, hist_f1_, hist_f2_, hist_f3_, 1);
 
   // Intialize the array that will store the FPFH signature
   output.points.resize (indices_->size (), nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_);
   output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
-  {
-    // Iterate over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
-    {
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
-      {
-        output.points.row (idx).setConstant (std::numeric_limits<float>::quiet_NaN ());
-        output.is_dense = false;
-        continue;
-      }
 
-      // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
-      // instead of indices into surface_->points
-      for (size_t i = 0; i < nn_indices.size (); ++i)
-        nn_indices[i] = spfh_hist_lookup[nn_indices[i]];
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
 
-      // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-      this->weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram_);
-      output.points.row (idx) = fpfh_histogram_;
-    }
-  }
-  else
+  // Iterate over the entire index vector
+  for (size_t idx = 0; idx < indices_->size (); ++idx)
   {
-    // Iterate over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+    if (!this->weightQuerySPFHSignature (query_neighbors_, idx, spfh_hist_lookup, nn_indices, nn_dists, fpfh_histogram_))
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
-      {
-        output.points.row (idx).setConstant (std::numeric_limits<float>::quiet_NaN ());
-        output.is_dense = false;
-        continue;
-      }
-
-      // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
-      // instead of indices into surface_->points
-      for (size_t i = 0; i < nn_indices.size (); ++i)
-        nn_indices[i] = spfh_hist_lookup[nn_indices[i]];
-
-      // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-      this->weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram_);
-      output.points.row (idx) = fpfh_histogram_;
+      output.points.row (idx).setConstant (std::numeric_limits<float>::quiet_NaN ());
+      output.is_dense = false;
+      continue;
     }
+    output.points.row (idx) = fpfh_histogram_;
   }
 }
 
@@ -39,34 +39,123 @@
 #ifndef PCL_INTEGRAL_IMAGE2D_IMPL_H_
 #define PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Add a value to a running sum with Kahan compensation.
+      * \param[in,out] sum the running sum
+      * \param[in,out] compensation the rounding error carried over from the previous additions
+      * \param[in] value the value to add
+      */
+    template <typename T> inline void
+    addCompensatedSum (T &sum, T &compensation, const T &value)
+    {
+      const T corrected = value - compensation;
+      const T next = sum + corrected;
+      compensation = (next - sum) - corrected;
+      sum = next;
+    }
+
+    /** \brief Get the number of horizontal bands an integral image of the given height is built in.
+      * \param[in] nr_threads the number of threads requested (0 means automatic)
+      * \param[in] height the number of rows of the image
+      */
+    inline int
+    getIntegralImageBands (unsigned nr_threads, unsigned height)
+    {
+#ifdef _OPENMP
+      const int threads = nr_threads ? static_cast<int> (nr_threads) : omp_get_max_threads ();
+#else
+      const int threads = 1;
+      (void)nr_threads;
+#endif
+      return (std::max (1, std::min (threads, static_cast<int> (height))));
+    }
+
+    /** \brief Get the first row of a band, or the number of rows for band == nr_bands. */
+    inline unsigned
+    getIntegralImageBandBegin (int band, int nr_bands, unsigned height)
+    {
+      return (static_cast<unsigned> ((static_cast<size_t> (height) * band) / nr_bands));
+    }
+
+    /** \brief Turn an integral image whose bands were integrated separately into the integral image of the whole
+      * data, by adding the last row of all the bands above to every row of a band.
+      * \param[in,out] image the (width + 1) x (height + 1) integral image, its first row set to zero
+      * \param[in] width the width of the data
+      * \param[in] height the height of the data
+      * \param[in] nr_bands the number of bands
+      */
+    template <typename T> void
+    shiftIntegralImageBands (T *image, unsigned width, unsigned height, int nr_bands)
+    {
+      const unsigned stride = width + 1;
+      std::vector<T, Eigen::aligned_allocator<T> > offsets (nr_bands * stride);
+      for (int band = 1; band < nr_bands; ++band)
+      {
+        const T* last_row = image + getIntegralImageBandBegin (band, nr_bands, height) * stride;
+        T* offset = &offsets[band * stride];
+        for (unsigned colIdx = 0; colIdx < stride; ++colIdx)
+          offset [colIdx] = last_row [colIdx];
+        if (band > 1)
+          for (unsigned colIdx = 0; colIdx < stride; ++colIdx)
+            offset [colIdx] += offsets[(band - 1) * stride + colIdx];
+      }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(nr_bands - 1)
+#endif
+      for (int band = 1; band < nr_bands; ++band)
+      {
+        const T* offset = &offsets[band * stride];
+        const unsigned row_end = getIntegralImageBandBegin (band + 1, nr_bands, height);
+        for (unsigned rowIdx = getIntegralImageBandBegin (band, nr_bands, height); rowIdx < row_end; ++rowIdx)
+        {
+          T* row = image + (rowIdx + 1) * stride;
+          for (unsigned colIdx = 0; colIdx < stride; ++colIdx)
+            row [colIdx] += offset [colIdx];
+        }
+      }
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType, unsigned Dimension> void
-pcl::IntegralImage2D<DataType, Dimension>::setSecondOrderComputation (bool compute_second_order_integral_images)
+template <typename DataType, unsigned Dimension, typename IntegralType> void
+pcl::IntegralImage2D<DataType, Dimension, IntegralType>::setSecondOrderComputation (bool compute_second_order_integral_images)
 {
   compute_second_order_integral_images_ = compute_second_order_integral_images;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType, unsigned Dimension> void
-pcl::IntegralImage2D<DataType, Dimension>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
+template <typename DataType, unsigned Dimension, typename IntegralType> void
+pcl::IntegralImage2D<DataType, Dimension, IntegralType>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
+  // The buffers only grow, so that a stream of frames reuses them
+  width_  = width;
+  height_ = height;
+  const size_t size = (width_ + 1) * (height_ + 1);
+  if (size > first_order_integral_image_.size ())
   {
-    width_  = width;
-    height_ = height;
-    first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+    first_order_integral_image_.resize (size);
+    finite_values_integral_image_.resize (size);
   }
+  if (compute_second_order_integral_images_ && size > second_order_integral_image_.size ())
+    second_order_integral_image_.resize (size);
   computeIntegralImages (data, row_stride, element_stride);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType, unsigned Dimension> typename pcl::IntegralImage2D<DataType, Dimension>::ElementType
-pcl::IntegralImage2D<DataType, Dimension>::getFirstOrderSum (
+template <typename DataType, unsigned Dimension, typename IntegralType> typename pcl::IntegralImage2D<DataType, Dimension, IntegralType>::ElementType
+pcl::IntegralImage2D<DataType, Dimension, IntegralType>::getFirstOrderSum (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -79,8 +168,8 @@ pcl::IntegralImage2D<DataType, Dimension>::getFirstOrderSum (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType, unsigned Dimension> typename pcl::IntegralImage2D<DataType, Dimension>::SecondOrderType
-pcl::IntegralImage2D<DataType, Dimension>::getSecondOrderSum (
+template <typename DataType, unsigned Dimension, typename IntegralType> typename pcl::IntegralImage2D<DataType, Dimension, IntegralType>::SecondOrderType
+pcl::IntegralImage2D<DataType, Dimension, IntegralType>::getSecondOrderSum (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -93,8 +182,8 @@ pcl::IntegralImage2D<DataType, Dimension>::getSecondOrderSum (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType, unsigned Dimension> unsigned
-pcl::IntegralImage2D<DataType, Dimension>::getFiniteElementsCount (
+template <typename DataType, unsigned Dimension, typename IntegralType> unsigned
+pcl::IntegralImage2D<DataType, Dimension, IntegralType>::getFiniteElementsCount (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -107,8 +196,8 @@ pcl::IntegralImage2D<DataType, Dimension>::getFiniteElementsCount (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType, unsigned Dimension> typename pcl::IntegralImage2D<DataType, Dimension>::ElementType
-pcl::IntegralImage2D<DataType, Dimension>::getFirstOrderSumSE (
+template <typename DataType, unsigned Dimension, typename IntegralType> typename pcl::IntegralImage2D<DataType, Dimension, IntegralType>::ElementType
+pcl::IntegralImage2D<DataType, Dimension, IntegralType>::getFirstOrderSumSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -121,8 +210,8 @@ pcl::IntegralImage2D<DataType, Dimension>::getFirstOrderSumSE (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType, unsigned Dimension> typename pcl::IntegralImage2D<DataType, Dimension>::SecondOrderType
-pcl::IntegralImage2D<DataType, Dimension>::getSecondOrderSumSE (
+template <typename DataType, unsigned Dimension, typename IntegralType> typename pcl::IntegralImage2D<DataType, Dimension, IntegralType>::SecondOrderType
+pcl::IntegralImage2D<DataType, Dimension, IntegralType>::getSecondOrderSumSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -135,8 +224,8 @@ pcl::IntegralImage2D<DataType, Dimension>::getSecondOrderSumSE (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType, unsigned Dimension> unsigned
-pcl::IntegralImage2D<DataType, Dimension>::getFiniteElementsCountSE (
+template <typename DataType, unsigned Dimension, typename IntegralType> unsigned
+pcl::IntegralImage2D<DataType, Dimension, IntegralType>::getFiniteElementsCountSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -149,69 +238,153 @@ pcl::IntegralImage2D<DataType, Dimension>::getFiniteElementsCountSE (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType, unsigned Dimension> void
-pcl::IntegralImage2D<DataType, Dimension>::computeIntegralImages (
+template <typename DataType, unsigned Dimension, typename IntegralType> void
+pcl::IntegralImage2D<DataType, Dimension, IntegralType>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
+  const unsigned stride = width_ + 1;
+  memset (&first_order_integral_image_[0], 0, sizeof (ElementType) * stride);
+  memset (&finite_values_integral_image_[0], 0, sizeof (unsigned) * stride);
+  if (compute_second_order_integral_images_)
+    memset (&second_order_integral_image_[0], 0, sizeof (SecondOrderType) * stride);
+
+  const int nr_bands = pcl::detail::getIntegralImageBands (threads_, height_);
+
+  // Integrate every band of rows as if it was an image of its own
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(nr_bands)
+#endif
+  for (int band = 0; band < nr_bands; ++band)
+  {
+    const unsigned row_begin = pcl::detail::getIntegralImageBandBegin (band, nr_bands, height_);
+    const unsigned row_end   = pcl::detail::getIntegralImageBandBegin (band + 1, nr_bands, height_);
+    if (use_compensated_summation_)
+      integrateRows<true> (data, row_stride, element_stride, row_begin, row_end);
+    else
+      integrateRows<false> (data, row_stride, element_stride, row_begin, row_end);
+  }
+
+  // Add the sums of the bands above to every band
+  if (nr_bands > 1)
+  {
+    pcl::detail::shiftIntegralImageBands (&first_order_integral_image_[0], width_, height_, nr_bands);
+    pcl::detail::shiftIntegralImageBands (&finite_values_integral_image_[0], width_, height_, nr_bands);
+    if (compute_second_order_integral_images_)
+      pcl::detail::shiftIntegralImageBands (&second_order_integral_image_[0], width_, height_, nr_bands);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType, unsigned Dimension, typename IntegralType> template <bool compensated> void
+pcl::IntegralImage2D<DataType, Dimension, IntegralType>::integrateRows (
+    const DataType *data, unsigned row_stride, unsigned element_stride, unsigned row_begin, unsigned row_end)
+{
+  const unsigned stride = width_ + 1;
 
+  // The first row of the band is integrated on top of the (zero) first row of the integral image
+  ElementType* previous_row = &first_order_integral_image_[0];
+  ElementType* current_row  = previous_row + (row_begin + 1) * stride;
   unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
+  unsigned* count_current_row  = count_previous_row + (row_begin + 1) * stride;
+  data += row_begin * row_stride;
+
+  // The rounding errors of the running sums down the columns
+  std::vector<ElementType, Eigen::aligned_allocator<ElementType> > compensation;
+  if (compensated)
+    compensation.resize (stride, ElementType::Zero ());
 
+  ElementType element, row_sum, row_compensation;
   if (!compute_second_order_integral_images_)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    for (unsigned rowIdx = row_begin; rowIdx < row_end; ++rowIdx, data += row_stride,
+                                                        previous_row = current_row, current_row += stride,
+                                                        count_previous_row = count_current_row, count_current_row += stride)
     {
       current_row [0].setZero ();
       count_current_row [0] = 0;
+      row_sum.setZero ();
+      row_compensation.setZero ();
+      unsigned count_row_sum = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (pcl_isfinite (element->sum ()))
+        const InputType* input = reinterpret_cast <const InputType*> (&data [valIdx]);
+        if (pcl_isfinite (input->sum ()))
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
+          element = input->template cast<IntegralType> ();
+          if (compensated)
+            pcl::detail::addCompensatedSum (row_sum, row_compensation, element);
+          else
+            row_sum += element;
+          ++count_row_sum;
         }
+        if (compensated)
+        {
+          current_row [colIdx + 1] = previous_row [colIdx + 1];
+          pcl::detail::addCompensatedSum (current_row [colIdx + 1], compensation [colIdx + 1], row_sum);
+        }
+        else
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + row_sum;
+        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_row_sum;
       }
     }
   }
   else
   {
     SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    SecondOrderType so_element;
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    SecondOrderType* so_current_row  = so_previous_row + (row_begin + 1) * stride;
+
+    std::vector<SecondOrderType, Eigen::aligned_allocator<SecondOrderType> > so_compensation;
+    if (compensated)
+      so_compensation.resize (stride, SecondOrderType::Zero ());
+
+    SecondOrderType so_element, so_row_sum, so_row_compensation;
+    for (unsigned rowIdx = row_begin; rowIdx < row_end; ++rowIdx, data += row_stride,
+                                                        previous_row = current_row, current_row += stride,
+                                                        count_previous_row = count_current_row, count_current_row += stride,
+                                                        so_previous_row = so_current_row, so_current_row += stride)
     {
       current_row [0].setZero ();
       so_current_row [0].setZero ();
       count_current_row [0] = 0;
+      row_sum.setZero ();
+      row_compensation.setZero ();
+      so_row_sum.setZero ();
+      so_row_compensation.setZero ();
+      unsigned count_row_sum = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (pcl_isfinite (element->sum ()))
+        const InputType* input = reinterpret_cast <const InputType*> (&data [valIdx]);
+        if (pcl_isfinite (input->sum ()))
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
+          element = input->template cast<IntegralType> ();
           for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
             for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
-              so_current_row [colIdx + 1][elIdx] += (*element)[myIdx] * (*element)[mxIdx];
+              so_element [elIdx] = element [myIdx] * element [mxIdx];
+          if (compensated)
+          {
+            pcl::detail::addCompensatedSum (row_sum, row_compensation, element);
+            pcl::detail::addCompensatedSum (so_row_sum, so_row_compensation, so_element);
+          }
+          else
+          {
+            row_sum += element;
+            so_row_sum += so_element;
+          }
+          ++count_row_sum;
+        }
+        if (compensated)
+        {
+          current_row [colIdx + 1] = previous_row [colIdx + 1];
+          pcl::detail::addCompensatedSum (current_row [colIdx + 1], compensation [colIdx + 1], row_sum);
+          so_current_row [colIdx + 1] = so_previous_row [colIdx + 1];
+          pcl::detail::addCompensatedSum (so_current_row [colIdx + 1], so_compensation [colIdx + 1], so_row_sum);
         }
+        else
+        {
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + row_sum;
+          so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_row_sum;
+        }
+        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_row_sum;
       }
     }
   }
@@ -219,24 +392,26 @@ pcl::IntegralImage2D<DataType, Dimension>::computeIntegralImages (
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-template <typename DataType> void
-pcl::IntegralImage2D<DataType, 1>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
+template <typename DataType, typename IntegralType> void
+pcl::IntegralImage2D<DataType, 1, IntegralType>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
+  // The buffers only grow, so that a stream of frames reuses them
+  width_  = width;
+  height_ = height;
+  const size_t size = (width_ + 1) * (height_ + 1);
+  if (size > first_order_integral_image_.size ())
   {
-    width_  = width;
-    height_ = height;
-    first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+    first_order_integral_image_.resize (size);
+    finite_values_integral_image_.resize (size);
   }
+  if (compute_second_order_integral_images_ && size > second_order_integral_image_.size ())
+    second_order_integral_image_.resize (size);
   computeIntegralImages (data, row_stride, element_stride);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType> typename pcl::IntegralImage2D<DataType, 1>::ElementType
-pcl::IntegralImage2D<DataType, 1>::getFirstOrderSum (
+template <typename DataType, typename IntegralType> typename pcl::IntegralImage2D<DataType, 1, IntegralType>::ElementType
+pcl::IntegralImage2D<DataType, 1, IntegralType>::getFirstOrderSum (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -249,8 +424,8 @@ pcl::IntegralImage2D<DataType, 1>::getFirstOrderSum (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType> typename pcl::IntegralImage2D<DataType, 1>::SecondOrderType
-pcl::IntegralImage2D<DataType, 1>::getSecondOrderSum (
+template <typename DataType, typename IntegralType> typename pcl::IntegralImage2D<DataType, 1, IntegralType>::SecondOrderType
+pcl::IntegralImage2D<DataType, 1, IntegralType>::getSecondOrderSum (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -263,8 +438,8 @@ pcl::IntegralImage2D<DataType, 1>::getSecondOrderSum (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType> unsigned
-pcl::IntegralImage2D<DataType, 1>::getFiniteElementsCount (
+template <typename DataType, typename IntegralType> unsigned
+pcl::IntegralImage2D<DataType, 1, IntegralType>::getFiniteElementsCount (
     unsigned start_x, unsigned start_y, unsigned width, unsigned height) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -277,8 +452,8 @@ pcl::IntegralImage2D<DataType, 1>::getFiniteElementsCount (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType> typename pcl::IntegralImage2D<DataType, 1>::ElementType
-pcl::IntegralImage2D<DataType, 1>::getFirstOrderSumSE (
+template <typename DataType, typename IntegralType> typename pcl::IntegralImage2D<DataType, 1, IntegralType>::ElementType
+pcl::IntegralImage2D<DataType, 1, IntegralType>::getFirstOrderSumSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -291,8 +466,8 @@ pcl::IntegralImage2D<DataType, 1>::getFirstOrderSumSE (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType> typename pcl::IntegralImage2D<DataType, 1>::SecondOrderType
-pcl::IntegralImage2D<DataType, 1>::getSecondOrderSumSE (
+template <typename DataType, typename IntegralType> typename pcl::IntegralImage2D<DataType, 1, IntegralType>::SecondOrderType
+pcl::IntegralImage2D<DataType, 1, IntegralType>::getSecondOrderSumSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -305,8 +480,8 @@ pcl::IntegralImage2D<DataType, 1>::getSecondOrderSumSE (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType> unsigned
-pcl::IntegralImage2D<DataType, 1>::getFiniteElementsCountSE (
+template <typename DataType, typename IntegralType> unsigned
+pcl::IntegralImage2D<DataType, 1, IntegralType>::getFiniteElementsCountSE (
     unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const
 {
   const unsigned upper_left_idx      = start_y * (width_ + 1) + start_x;
@@ -319,66 +494,146 @@ pcl::IntegralImage2D<DataType, 1>::getFiniteElementsCountSE (
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename DataType> void
-pcl::IntegralImage2D<DataType, 1>::computeIntegralImages (
+template <typename DataType, typename IntegralType> void
+pcl::IntegralImage2D<DataType, 1, IntegralType>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
+  const unsigned stride = width_ + 1;
+  memset (&first_order_integral_image_[0], 0, sizeof (ElementType) * stride);
+  memset (&finite_values_integral_image_[0], 0, sizeof (unsigned) * stride);
+  if (compute_second_order_integral_images_)
+    memset (&second_order_integral_image_[0], 0, sizeof (SecondOrderType) * stride);
+
+  const int nr_bands = pcl::detail::getIntegralImageBands (threads_, height_);
+
+  // Integrate every band of rows as if it was an image of its own
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(nr_bands)
+#endif
+  for (int band = 0; band < nr_bands; ++band)
+  {
+    const unsigned row_begin = pcl::detail::getIntegralImageBandBegin (band, nr_bands, height_);
+    const unsigned row_end   = pcl::detail::getIntegralImageBandBegin (band + 1, nr_bands, height_);
+    if (use_compensated_summation_)
+      integrateRows<true> (data, row_stride, element_stride, row_begin, row_end);
+    else
+      integrateRows<false> (data, row_stride, element_stride, row_begin, row_end);
+  }
+
+  // Add the sums of the bands above to every band
+  if (nr_bands > 1)
+  {
+    pcl::detail::shiftIntegralImageBands (&first_order_integral_image_[0], width_, height_, nr_bands);
+    pcl::detail::shiftIntegralImageBands (&finite_values_integral_image_[0], width_, height_, nr_bands);
+    if (compute_second_order_integral_images_)
+      pcl::detail::shiftIntegralImageBands (&second_order_integral_image_[0], width_, height_, nr_bands);
+  }
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType, typename IntegralType> template <bool compensated> void
+pcl::IntegralImage2D<DataType, 1, IntegralType>::integrateRows (
+    const DataType *data, unsigned row_stride, unsigned element_stride, unsigned row_begin, unsigned row_end)
+{
+  const unsigned stride = width_ + 1;
+
+  // The first row of the band is integrated on top of the (zero) first row of the integral image
+  ElementType* previous_row = &first_order_integral_image_[0];
+  ElementType* current_row  = previous_row + (row_begin + 1) * stride;
   unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
+  unsigned* count_current_row  = count_previous_row + (row_begin + 1) * stride;
+  data += row_begin * row_stride;
+
+  // The rounding errors of the running sums down the columns
+  std::vector<ElementType> compensation;
+  if (compensated)
+    compensation.resize (stride, 0);
 
   if (!compute_second_order_integral_images_)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    for (unsigned rowIdx = row_begin; rowIdx < row_end; ++rowIdx, data += row_stride,
+                                                        previous_row = current_row, current_row += stride,
+                                                        count_previous_row = count_current_row, count_current_row += stride)
     {
-      current_row [0] = 0.0;
+      current_row [0] = 0;
       count_current_row [0] = 0;
+      ElementType row_sum = 0, row_compensation = 0;
+      unsigned count_row_sum = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
         if (pcl_isfinite (data [valIdx]))
         {
-          current_row [colIdx + 1] += data [valIdx];
-          ++(count_current_row [colIdx + 1]);
+          if (compensated)
+            pcl::detail::addCompensatedSum (row_sum, row_compensation, static_cast<ElementType> (data [valIdx]));
+          else
+            row_sum += data [valIdx];
+          ++count_row_sum;
         }
+        if (compensated)
+        {
+          current_row [colIdx + 1] = previous_row [colIdx + 1];
+          pcl::detail::addCompensatedSum (current_row [colIdx + 1], compensation [colIdx + 1], row_sum);
+        }
+        else
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + row_sum;
+        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_row_sum;
       }
     }
   }
   else
   {
     SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
+    SecondOrderType* so_current_row  = so_previous_row + (row_begin + 1) * stride;
+
+    std::vector<SecondOrderType> so_compensation;
+    if (compensated)
+      so_compensation.resize (stride, 0);
 
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    for (unsigned rowIdx = row_begin; rowIdx < row_end; ++rowIdx, data += row_stride,
+                                                        previous_row = current_row, current_row += stride,
+                                                        count_previous_row = count_current_row, count_current_row += stride,
+                                                        so_previous_row = so_current_row, so_current_row += stride)
     {
-      current_row [0] = 0.0;
-      so_current_row [0] = 0.0;
+      current_row [0] = 0;
+      so_current_row [0] = 0;
       count_current_row [0] = 0;
+      ElementType row_sum = 0, row_compensation = 0;
+      SecondOrderType so_row_sum = 0, so_row_compensation = 0;
+      unsigned count_row_sum = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (pcl_isfinite (data[valIdx]))
+        if (pcl_isfinite (data [valIdx]))
+        {
+          const ElementType element = static_cast<ElementType> (data [valIdx]);
+          if (compensated)
+          {
+            pcl::detail::addCompensatedSum (row_sum, row_compensation, element);
+            pcl::detail::addCompensatedSum (so_row_sum, so_row_compensation, static_cast<SecondOrderType> (element * element));
+          }
+          else
+          {
+            row_sum += element;
+            so_row_sum += element * element;
+          }
+          ++count_row_sum;
+        }
+        if (compensated)
+        {
+          current_row [colIdx + 1] = previous_row [colIdx + 1];
+          pcl::detail::addCompensatedSum (current_row [colIdx + 1], compensation [colIdx + 1], row_sum);
+          so_current_row [colIdx + 1] = so_previous_row [colIdx + 1];
+          pcl::detail::addCompensatedSum (so_current_row [colIdx + 1], so_compensation [colIdx + 1], so_row_sum);
+        }
+        else
         {
-          current_row [colIdx + 1] += data[valIdx];
-          so_current_row [colIdx + 1] += data[valIdx] * data[valIdx];
-          ++(count_current_row [colIdx + 1]);
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + row_sum;
+          so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_row_sum;
         }
+        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_row_sum;
       }
     }
   }
 }
+
 #endif    // PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
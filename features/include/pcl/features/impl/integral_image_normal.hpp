@@ -44,10 +44,6 @@
 template <typename PointInT, typename PointOutT>
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::~IntegralImageNormalEstimation ()
 {
-  if (diff_x_ != NULL) delete diff_x_;
-  if (diff_y_ != NULL) delete diff_y_;
-  if (depth_data_ != NULL) delete depth_data_;
-  if (distance_map_ != NULL) delete distance_map_;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -66,16 +62,6 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initData ()
     PCL_THROW_EXCEPTION (InitFailedException,
                          "[pcl::IntegralImageNormalEstimation::initData] unknown normal estimation method.");
 
-  // compute derivatives
-  if (diff_x_ != NULL) delete diff_x_;
-  if (diff_y_ != NULL) delete diff_y_;
-  if (depth_data_ != NULL) delete depth_data_;
-  if (distance_map_ != NULL) delete distance_map_;
-  diff_x_ = NULL;
-  diff_y_ = NULL;
-  depth_data_ = NULL;
-  distance_map_ = NULL;
-
   if (normal_estimation_method_ == COVARIANCE_MATRIX)
     initCovarianceMatrixMethod ();
   else if (normal_estimation_method_ == AVERAGE_3D_GRADIENT)
@@ -111,6 +97,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initSimple3DGradientMet
   const float *data_ = reinterpret_cast<const float*> (&input_->points[0]);
 
   integral_image_XYZ_.setSecondOrderComputation (false);
+  integral_image_XYZ_.setNumberOfThreads (threads_);
   integral_image_XYZ_.setInput (data_, input_->width, input_->height, element_stride, row_stride);
 
   init_simple_3d_gradient_ = true;
@@ -129,6 +116,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initCovarianceMatrixMet
   const float *data_ = reinterpret_cast<const float*> (&input_->points[0]);
 
   integral_image_XYZ_.setSecondOrderComputation (true);
+  integral_image_XYZ_.setNumberOfThreads (threads_);
   integral_image_XYZ_.setInput (data_, input_->width, input_->height, element_stride, row_stride);
 
   init_covariance_matrix_ = true;
@@ -139,47 +127,61 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initCovarianceMatrixMet
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMethod ()
 {
-  size_t data_size = (input_->points.size () << 2);
-  diff_x_ = new float[data_size];
-  diff_y_ = new float[data_size];
+  const int width  = static_cast<int> (input_->width);
+  const int height = static_cast<int> (input_->height);
 
-  memset (diff_x_, 0, sizeof(float) * data_size);
-  memset (diff_y_, 0, sizeof(float) * data_size);
+  // Reuse the buffers of the previous cloud; the first and last rows are never written below
+  size_t data_size = (input_->points.size () << 2);
+  diff_x_.resize (data_size);
+  diff_y_.resize (data_size);
+  std::fill (diff_x_.begin (), diff_x_.begin () + (width << 2), 0.0f);
+  std::fill (diff_y_.begin (), diff_y_.begin () + (width << 2), 0.0f);
+  std::fill (diff_x_.end () - (width << 2), diff_x_.end (), 0.0f);
+  std::fill (diff_y_.end () - (width << 2), diff_y_.end (), 0.0f);
 
   // x u x
   // l x r
   // x d x
-  const PointInT* point_up = &(input_->points [1]);
-  const PointInT* point_dn = point_up + (input_->width << 1);//&(input_->points [1 + (input_->width << 1)]);
-  const PointInT* point_lf = &(input_->points [input_->width]);
-  const PointInT* point_rg = point_lf + 2; //&(input_->points [input_->width + 2]);
-  float* diff_x_ptr = diff_x_ + ((input_->width + 1) << 2);
-  float* diff_y_ptr = diff_y_ + ((input_->width + 1) << 2);
-  unsigned diff_skip = 8; // skip last element in row and the first in the next row
-
-  for (size_t ri = 1; ri < input_->height - 1; ++ri
-                                             , point_up += input_->width
-                                             , point_dn += input_->width
-                                             , point_lf += input_->width
-                                             , point_rg += input_->width
-                                             , diff_x_ptr += diff_skip
-                                             , diff_y_ptr += diff_skip)
+#ifdef _OPENMP
+  const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for schedule(static) num_threads(threads)
+#endif
+  for (int ri = 1; ri < height - 1; ++ri)
   {
-    for (size_t ci = 0; ci < input_->width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
+    const PointInT* point_up = &(input_->points [(ri - 1) * width + 1]);
+    const PointInT* point_dn = &(input_->points [(ri + 1) * width + 1]);
+    const PointInT* point_lf = &(input_->points [ri * width]);
+    const PointInT* point_rg = point_lf + 2;
+    float* diff_x_ptr = &diff_x_[ri * width << 2];
+    float* diff_y_ptr = &diff_y_[ri * width << 2];
+
+    // the first and the last element in the row stay zero
+    std::fill (diff_x_ptr, diff_x_ptr + 4, 0.0f);
+    std::fill (diff_y_ptr, diff_y_ptr + 4, 0.0f);
+    std::fill (diff_x_ptr + ((width - 1) << 2), diff_x_ptr + (width << 2), 0.0f);
+    std::fill (diff_y_ptr + ((width - 1) << 2), diff_y_ptr + (width << 2), 0.0f);
+    diff_x_ptr += 4;
+    diff_y_ptr += 4;
+
+    for (int ci = 0; ci < width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
     {
       diff_x_ptr[0] = point_rg[ci].x - point_lf[ci].x;
       diff_x_ptr[1] = point_rg[ci].y - point_lf[ci].y;
       diff_x_ptr[2] = point_rg[ci].z - point_lf[ci].z;
+      diff_x_ptr[3] = 0.0f;
 
       diff_y_ptr[0] = point_dn[ci].x - point_up[ci].x;
       diff_y_ptr[1] = point_dn[ci].y - point_up[ci].y;
       diff_y_ptr[2] = point_dn[ci].z - point_up[ci].z;
+      diff_y_ptr[3] = 0.0f;
     }
   }
 
   // Compute integral images
-  integral_image_DX_.setInput (diff_x_, input_->width, input_->height, 4, input_->width << 2);
-  integral_image_DY_.setInput (diff_y_, input_->width, input_->height, 4, input_->width << 2);
+  integral_image_DX_.setNumberOfThreads (threads_);
+  integral_image_DY_.setNumberOfThreads (threads_);
+  integral_image_DX_.setInput (&diff_x_[0], input_->width, input_->height, 4, input_->width << 2);
+  integral_image_DY_.setInput (&diff_y_[0], input_->width, input_->height, 4, input_->width << 2);
   init_covariance_matrix_ = init_depth_change_ = init_simple_3d_gradient_ = false;
   init_average_3d_gradient_ = true;
 }
@@ -196,6 +198,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverageDepthChangeM
   const float *data_ = reinterpret_cast<const float*> (&input_->points[0]);
 
   // integral image over the z - value
+  integral_image_depth_.setNumberOfThreads (threads_);
   integral_image_depth_.setInput (&(data_[2]), input_->width, input_->height, element_stride, row_stride);
   init_depth_change_ = true;
   init_covariance_matrix_ = init_average_3d_gradient_ = init_simple_3d_gradient_ = false;
@@ -853,7 +856,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
   // compute depth-change map
-  unsigned char * depthChangeMap = new unsigned char[input_->points.size ()];
+  depth_change_map_.resize (input_->points.size ());
+  unsigned char * depthChangeMap = &depth_change_map_[0];
   memset (depthChangeMap, 255, input_->points.size ());
 
   unsigned index = 0;
@@ -887,9 +891,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
 
   // compute distance map
   //float *distanceMap = new float[input_->points.size ()];
-  if (distance_map_ != NULL) delete distance_map_;
-  distance_map_ = new float[input_->points.size ()];
-  float *distanceMap = distance_map_;
+  distance_map_.resize (input_->points.size ());
+  float *distanceMap = &distance_map_[0];
   for (size_t index = 0; index < input_->points.size (); ++index)
   {
     if (depthChangeMap[index] == 0)
@@ -942,6 +945,10 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
     current_row -= input_->width;
   }
 
+  // In the region-of-interest mode, the normals whose neighborhood did not change are copied from the previous frame
+  const bool reuse_normals = initChangedDepthROI ();
+  size_t nr_reused_normals = 0;
+
   if (border_policy_ == BORDER_POLICY_IGNORE)
   {
     // Set all normals that we do not touch to NaN
@@ -993,7 +1000,15 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
             continue;
           }
 
-          float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+          const float max_smoothing = normal_smoothing_size_ + static_cast<float>(depth)/10.0f;
+          if (reuse_normals && !hasChangedDepth (ci, ri, max_smoothing))
+          {
+            output [index] = previous_normals_[index];
+            ++nr_reused_normals;
+            continue;
+          }
+
+          float smoothing = (std::min)(distanceMap[index], max_smoothing);
 
           if (smoothing > 2.0f)
           {
@@ -1027,6 +1042,13 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
             continue;
           }
 
+          if (reuse_normals && !hasChangedDepth (ci, ri, smoothing_constant))
+          {
+            output [index] = previous_normals_[index];
+            ++nr_reused_normals;
+            continue;
+          }
+
           float smoothing = (std::min)(distanceMap[index], smoothing_constant);
 
           if (smoothing > 2.0f)
@@ -1067,7 +1089,15 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
             continue;
           }
 
-          float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+          const float max_smoothing = normal_smoothing_size_ + static_cast<float>(depth)/10.0f;
+          if (reuse_normals && !hasChangedDepth (ci, ri, max_smoothing))
+          {
+            output [index] = previous_normals_[index];
+            ++nr_reused_normals;
+            continue;
+          }
+
+          float smoothing = (std::min)(distanceMap[index], max_smoothing);
 
           if (smoothing > 2.0f)
           {
@@ -1103,6 +1133,13 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
             continue;
           }
 
+          if (reuse_normals && !hasChangedDepth (ci, ri, smoothing_constant))
+          {
+            output [index] = previous_normals_[index];
+            ++nr_reused_normals;
+            continue;
+          }
+
           float smoothing = (std::min)(distanceMap[index], smoothing_constant);
 
           if (smoothing > 2.0f)
@@ -1120,8 +1157,87 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
     }
   }
 
-  delete[] depthChangeMap;
-  //delete[] distanceMap;
+  nr_updated_normals_ = output.points.size () - nr_reused_normals;
+
+  if (use_changed_depth_roi_)
+  {
+    previous_normals_ = output.points;
+    previous_frame_valid_ = true;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initChangedDepthROI ()
+{
+  if (!use_changed_depth_roi_)
+  {
+    previous_frame_valid_ = false;
+    return (false);
+  }
+
+  const int nr_points = static_cast<int> (input_->points.size ());
+  if (!previous_frame_valid_ || previous_depth_.size () != input_->points.size () ||
+      previous_normals_.size () != input_->points.size ())
+  {
+    previous_depth_.resize (nr_points);
+    for (int idx = 0; idx < nr_points; ++idx)
+      previous_depth_[idx] = input_->points[idx].z;
+    return (false);
+  }
+
+  // Mark the points whose depth changed, and remember their new depth. The others keep the depth their normals
+  // were computed from, so that small changes add up until they exceed the threshold.
+  changed_depth_mask_.resize (nr_points);
+#ifdef _OPENMP
+  const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for schedule(static) num_threads(threads)
+#endif
+  for (int idx = 0; idx < nr_points; ++idx)
+  {
+    const float depth = input_->points[idx].z;
+    const float previous_depth = previous_depth_[idx];
+    bool changed;
+    if (pcl_isfinite (depth) && pcl_isfinite (previous_depth))
+      changed = fabsf (depth - previous_depth) > roi_depth_change_threshold_;
+    else
+      changed = pcl_isfinite (depth) || pcl_isfinite (previous_depth);
+
+    changed_depth_mask_[idx] = changed ? 1 : 0;
+    if (changed)
+      previous_depth_[idx] = depth;
+  }
+
+  changed_depth_image_.setNumberOfThreads (threads_);
+  changed_depth_image_.setInput (&changed_depth_mask_[0], input_->width, input_->height, 1, input_->width);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::hasChangedDepth (
+    const int pos_x, const int pos_y, const float max_smoothing) const
+{
+  // The normal depends on the points within its smoothing area, and the smoothing area on the depth changes within
+  // the same distance, which in turn compare every point with its neighbors
+  const int width  = static_cast<int> (input_->width);
+  const int height = static_cast<int> (input_->height);
+  const int radius = (std::max) (0, static_cast<int> (max_smoothing)) + 2;
+  if (changed_depth_image_.getFirstOrderSumSE ((std::max) (0, pos_x - radius), (std::max) (0, pos_y - radius),
+                                               (std::min) (width, pos_x + radius + 1), (std::min) (height, pos_y + radius + 1)) != 0)
+    return (true);
+
+  // The distance map passes run over the rows laid end to end, so the left and the right border touch each other,
+  // one row apart
+  const unsigned start_y = (std::max) (0, pos_y - radius - 1);
+  const unsigned end_y = (std::min) (height, pos_y + radius + 2);
+  if (pos_x - radius < 0 &&
+      changed_depth_image_.getFirstOrderSumSE ((std::max) (0, width + pos_x - radius), start_y, width, end_y) != 0)
+    return (true);
+  if (pos_x + radius >= width &&
+      changed_depth_image_.getFirstOrderSumSE (0, start_y, (std::min) (width, pos_x + radius + 1 - width), end_y) != 0)
+    return (true);
+  return (false);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
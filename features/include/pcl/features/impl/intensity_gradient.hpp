@@ -41,6 +41,9 @@
 #define PCL_FEATURES_IMPL_INTENSITY_GRADIENT_H_
 
 #include <pcl/features/intensity_gradient.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename IntensitySelectorT> void
@@ -152,7 +155,8 @@ pcl::IntensityGradientEstimation<PointInT, PointNT, PointOutT, IntensitySelector
   if (surface_->is_dense)
   {
 #ifdef _OPENMP
-#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads_)
+    const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads)
 #endif
     // Iterating over the entire index vector
     for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
@@ -190,7 +194,8 @@ pcl::IntensityGradientEstimation<PointInT, PointNT, PointOutT, IntensitySelector
   else
   {
 #ifdef _OPENMP
-#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads_)
+    const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads)
 #endif
     // Iterating over the entire index vector
     for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
@@ -46,56 +46,64 @@
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  // Allocate enough space to hold the results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
+  pcl::search::NeighborList neighbors;
 
   output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
+  computeNormals (0, indices_->size (), neighbors, output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::NormalEstimation<PointInT, PointOutT>::computeNormals (
+    size_t begin, size_t end, pcl::search::NeighborList &neighbors, PointCloudOut &output)
+{
+  normal_simd::PlaneFitBatch batch;
+  size_t batch_idx[normal_simd::PACKET_SIZE];
+  for (size_t idx = begin; idx < end; ++idx)
   {
-    // Iterating over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+    // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+    if ((!input_->is_dense && !isFinite ((*input_)[(*indices_)[idx]])) ||
+        this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
-      {
-        output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
-
-        output.is_dense = false;
-        continue;
-      }
-
-      computePointNormal (*surface_, nn_indices,
-                          output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2], output.points[idx].curvature);
-
-      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
+      output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
 
+      output.is_dense = false;
+      continue;
     }
-  }
-  else
-  {
-    // Iterating over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
-    {
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
-      {
-        output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
 
-        output.is_dense = false;
-        continue;
-      }
+    if (batch.addCovariance (*surface_, neighbors.indices (), neighbors.size ()) == 0)
+    {
+      output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+      continue;
+    }
+    batch_idx[batch.size () - 1] = idx;
 
-      computePointNormal (*surface_, nn_indices,
-                          output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2], output.points[idx].curvature);
+    if (batch.full ())
+      solveBatch (batch, batch_idx, output);
+  }
+  solveBatch (batch, batch_idx, output);
+}
 
-      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::NormalEstimation<PointInT, PointOutT>::solveBatch (
+    normal_simd::PlaneFitBatch &batch, const size_t *batch_idx, PointCloudOut &output)
+{
+  if (batch.size () == 0)
+    return;
 
-    }
+  float nx[normal_simd::PACKET_SIZE], ny[normal_simd::PACKET_SIZE], nz[normal_simd::PACKET_SIZE];
+  float curvature[normal_simd::PACKET_SIZE];
+  batch.solvePlaneParameters (nx, ny, nz, curvature);
+  for (int i = 0; i < batch.size (); ++i)
+  {
+    PointOutT &point = output.points[batch_idx[i]];
+    point.normal[0] = nx[i]; point.normal[1] = ny[i]; point.normal[2] = nz[i];
+    point.curvature = curvature[i];
+    flipNormalTowardsViewpoint (input_->points[(*indices_)[batch_idx[i]]], vpx_, vpy_, vpz_,
+                                point.normal[0], point.normal[1], point.normal[2]);
   }
+  batch.clear ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
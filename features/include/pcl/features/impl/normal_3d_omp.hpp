@@ -59,7 +59,8 @@ pcl::NormalEstimationOMP<PointInT, Eigen::MatrixXf>::computeFeatureEigen (pcl::P
   std::vector<float> nn_dists (k_);
 
 #ifdef _OPENMP
-#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads_)
+  const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads)
 #endif
   // Iterating over the entire index vector
   for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
@@ -95,47 +96,25 @@ pcl::NormalEstimationOMP<PointInT, Eigen::MatrixXf>::computeFeatureEigen (pcl::P
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimationOMP<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  float vpx, vpy, vpz;
-  getViewPoint (vpx, vpy, vpz);
-
   output.is_dense = true;
 
-  // Allocate enough space to hold the results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
-
-  // Iterating over the entire index vector
+  // Every thread solves the plane fits of a block of points in batches, and reuses its neighbor list
+  const int block_size = 16 * normal_simd::PACKET_SIZE;
+  const int nr_blocks = (static_cast<int> (indices_->size ()) + block_size - 1) / block_size;
 #ifdef _OPENMP
-#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads_)
+  const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(threads)
 #endif
-  for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
   {
-    if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-        this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+    pcl::search::NeighborList neighbors;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (int block = 0; block < nr_blocks; ++block)
     {
-      output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
-  
-      output.is_dense = false;
-      continue;
+      const size_t begin = static_cast<size_t> (block) * block_size;
+      this->computeNormals (begin, (std::min) (begin + block_size, indices_->size ()), neighbors, output);
     }
-
-    // 16-bytes aligned placeholder for the XYZ centroid of a surface patch
-    Eigen::Vector4f xyz_centroid;
-    // Estimate the XYZ centroid
-    compute3DCentroid (*surface_, nn_indices, xyz_centroid);
-
-    // Placeholder for the 3x3 covariance matrix at each surface patch
-    EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
-    // Compute the 3x3 covariance matrix
-    computeCovarianceMatrix (*surface_, nn_indices, xyz_centroid, covariance_matrix);
-
-    // Get the plane normal and surface curvature
-    solvePlaneParameters (covariance_matrix,
-                          output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2], output.points[idx].curvature);
-
-    flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx, vpy, vpz,
-                                output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
   }
 }
 
@@ -68,7 +68,11 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computePointPFHSignature (
   // Factorization constant
   float hist_incr = 100.0f / static_cast<float> (indices.size () * (indices.size () - 1) / 2);
 
-  std::pair<int, int> key;
+  // The cache is only sized between initCompute () and deinitCompute (), so it is empty when this method is called
+  // on its own
+  PairFeatureCache *cache = (use_cache_ && feature_cache_->getCapacity () > 0) ? feature_cache_.get () : NULL;
+  uint64_t cache_hits = 0, cache_misses = 0;
+
   // Iterate over all the points in the neighborhood
   for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
   {
@@ -78,32 +82,24 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computePointPFHSignature (
       if (!isFinite (cloud.points[indices[i_idx]]) || !isFinite (cloud.points[indices[j_idx]]))
         continue;
 
-      if (use_cache_)
+      if (cache)
       {
-        // In order to create the key, always use the smaller index as the first key pair member
-        int p1, p2;
-  //      if (indices[i_idx] >= indices[j_idx])
-  //      {
-          p1 = indices[i_idx];
-          p2 = indices[j_idx];
-  //      }
-  //      else
-  //      {
-  //        p1 = indices[j_idx];
-  //        p2 = indices[i_idx];
-  //      }
-        key = std::pair<int, int> (p1, p2);
-
-        // Check to see if we already estimated this pair in the global hashmap
-        std::map<std::pair<int, int>, Eigen::Vector4f, std::less<std::pair<int, int> >, Eigen::aligned_allocator<Eigen::Vector4f> >::iterator fm_it = feature_map_.find (key);
-        if (fm_it != feature_map_.end ())
-          pfh_tuple_ = fm_it->second;
+        // Always use the smaller index as the source, so that the cached features do not depend on which
+        // neighborhood (or thread) computed the pair first
+        int p1 = (std::min) (indices[i_idx], indices[j_idx]);
+        int p2 = (std::max) (indices[i_idx], indices[j_idx]);
+
+        // Check to see if we already estimated this pair in the shared cache
+        if (cache->find (p1, p2, pfh_tuple_))
+          ++cache_hits;
         else
         {
+          ++cache_misses;
           // Compute the pair NNi to NNj
-          if (!computePairFeatures (cloud, normals, indices[i_idx], indices[j_idx],
+          if (!computePairFeatures (cloud, normals, p1, p2,
                                     pfh_tuple_[0], pfh_tuple_[1], pfh_tuple_[2], pfh_tuple_[3]))
             continue;
+          cache->insert (p1, p2, pfh_tuple_);
         }
       }
       else
@@ -133,41 +129,53 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computePointPFHSignature (
         h_p     *= nr_split;
       }
       pfh_histogram[h_index] += hist_incr;
+    }
+  }
 
-      if (use_cache_)
-      {
-        // Save the value in the hashmap
-        feature_map_[key] = pfh_tuple_;
+  if (cache)
+    cache->addStatistics (cache_hits, cache_misses);
+}
 
-        // Use a maximum cache so that we don't go overboard on RAM usage
-        key_list_.push (key);
-        // Check to see if we need to remove an element due to exceeding max_size
-        if (key_list_.size () > max_cache_size_)
-        {
-          // Remove the last element.
-          feature_map_.erase (key_list_.back ());
-          key_list_.pop ();
-        }
-      }
-    }
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::PFHEstimation<PointInT, PointNT, PointOutT>::initCompute ()
+{
+  if (!FeatureFromNormals<PointInT, PointNT, PointOutT>::initCompute ())
+    return (false);
+
+  // Size the cache from the number of query points: a neighborhood of k points shares most of its pairs with
+  // the neighborhoods around it, which leaves about 2k new pairs per query point. Twice that keeps the probe
+  // windows short.
+  if (use_cache_)
+  {
+    const size_t nr_neighbors = k_ > 0 ? static_cast<size_t> (k_) : 32;
+    feature_cache_->reset ((std::min) (static_cast<size_t> (max_cache_size_), 4 * nr_neighbors * indices_->size ()));
   }
+  else
+    feature_cache_->reset (0);
+  cache_hit_rate_ = 0;
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::PFHEstimation<PointInT, PointNT, PointOutT>::deinitCompute ()
+{
+  // The entries are keyed by point indices only, so they are dropped together with the cloud they belong to
+  cache_hit_rate_ = feature_cache_->getHitRate ();
+  feature_cache_->reset (0);
+  return (FeatureFromNormals<PointInT, PointNT, PointOutT>::deinitCompute ());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  // Clear the feature map
-  feature_map_.clear ();
-  std::queue<std::pair<int, int> > empty;
-  std::swap (key_list_, empty);
-
   pfh_histogram_.setZero (nr_subdiv_ * nr_subdiv_ * nr_subdiv_);
 
-  // Allocate enough space to hold the results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
+  // Neighbor storage, reused across the query points
+  pcl::search::NeighborList neighbors;
+  std::vector<int> nn_indices;
 
   output.is_dense = true;
   // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
@@ -176,7 +184,7 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
     // Iterating over the entire index vector
     for (size_t idx = 0; idx < indices_->size (); ++idx)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0)
       {
         for (int d = 0; d < pfh_histogram_.size (); ++d)
           output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
@@ -186,6 +194,7 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
       }
 
       // Estimate the PFH signature at each patch
+      nn_indices.assign (neighbors.indices (), neighbors.indices () + neighbors.size ());
       computePointPFHSignature (*surface_, *normals_, nn_indices, nr_subdiv_, pfh_histogram_);
 
       // Copy into the resultant cloud
@@ -199,7 +208,7 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
     for (size_t idx = 0; idx < indices_->size (); ++idx)
     {
       if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0)
       {
         for (int d = 0; d < pfh_histogram_.size (); ++d)
           output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
@@ -209,6 +218,7 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
       }
 
       // Estimate the PFH signature at each patch
+      nn_indices.assign (neighbors.indices (), neighbors.indices () + neighbors.size ());
       computePointPFHSignature (*surface_, *normals_, nn_indices, nr_subdiv_, pfh_histogram_);
 
       // Copy into the resultant cloud
@@ -229,17 +239,12 @@ pcl::PFHEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
   output.channels["pfh"].count    = nr_subdiv_ * nr_subdiv_ * nr_subdiv_;
   output.channels["pfh"].datatype = sensor_msgs::PointField::FLOAT32;
 
-  // Clear the feature map
-  feature_map_.clear ();
-  std::queue<std::pair<int, int> > empty;
-  std::swap (key_list_, empty);
   pfh_histogram_.setZero (nr_subdiv_ * nr_subdiv_ * nr_subdiv_);
 
   // Allocate enough space to hold the results
   output.points.resize (indices_->size (), nr_subdiv_ * nr_subdiv_ * nr_subdiv_);
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
+  pcl::search::NeighborList neighbors;
+  std::vector<int> nn_indices;
 
   output.is_dense = true;
   // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
@@ -248,7 +253,7 @@ pcl::PFHEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
     // Iterating over the entire index vector
     for (size_t idx = 0; idx < indices_->size (); ++idx)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0)
       {
         output.points.row (idx).setConstant (std::numeric_limits<float>::quiet_NaN ());
         output.is_dense = false;
@@ -256,6 +261,7 @@ pcl::PFHEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
       }
 
       // Estimate the PFH signature at each patch
+      nn_indices.assign (neighbors.indices (), neighbors.indices () + neighbors.size ());
       computePointPFHSignature (*surface_, *normals_, nn_indices, nr_subdiv_, pfh_histogram_);
       output.points.row (idx) = pfh_histogram_;
     }
@@ -266,7 +272,7 @@ pcl::PFHEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
     for (size_t idx = 0; idx < indices_->size (); ++idx)
     {
       if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0)
       {
         output.points.row (idx).setConstant (std::numeric_limits<float>::quiet_NaN ());
         output.is_dense = false;
@@ -274,6 +280,7 @@ pcl::PFHEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
       }
 
       // Estimate the PFH signature at each patch
+      nn_indices.assign (neighbors.indices (), neighbors.indices () + neighbors.size ());
       computePointPFHSignature (*surface_, *normals_, nn_indices, nr_subdiv_, pfh_histogram_);
       output.points.row (idx) = pfh_histogram_;
     }
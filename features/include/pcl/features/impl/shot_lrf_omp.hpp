@@ -40,6 +40,9 @@
 #include <utility>
 #include <pcl/features/shot_lrf_omp.h>
 #include <pcl/features/shot_lrf.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 template<typename PointInT, typename PointOutT>
 void
@@ -57,7 +60,8 @@ pcl::SHOTLocalReferenceFrameEstimationOMP<PointInT, PointOutT>::computeFeature (
 
   int data_size = static_cast<int> (indices_->size ());
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(threads_)
+  const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for num_threads(threads)
 #endif
   for (int i = 0; i < data_size; ++i)
   {
@@ -113,7 +117,8 @@ pcl::SHOTLocalReferenceFrameEstimationOMP<PointInT, PointOutT>::computeFeatureEi
   output.points.resize (data_size, 9);
 
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(threads_)
+  const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for num_threads(threads)
 #endif
   for (int i = 0; i < data_size; ++i)
   {
@@ -40,6 +40,9 @@
 #include <pcl/features/shot_omp.h>
 #include <pcl/common/time.h>
 #include <pcl/features/shot_lrf_omp.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> bool
 pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
@@ -134,7 +137,8 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
   output.is_dense = true;
   // Iterating over the entire index vector
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(threads_)
+  const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for num_threads(threads)
 #endif
   for (int idx = 0; idx < data_size; ++idx)
   {
@@ -208,7 +212,8 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeat
   output.is_dense = true;
   // Iterating over the entire index vector
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(threads_)
+  const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for num_threads(threads)
 #endif
   for (int idx = 0; idx < data_size; ++idx)
   {
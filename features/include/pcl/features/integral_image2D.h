@@ -100,15 +100,19 @@ namespace pcl
   };
 
   /** \brief Determines an integral image representation for a given organized data array
+    * \note The sums are accumulated in IntegralType, which defaults to IntegralImageTypeTraits<DataType>::IntegralType
+    * (double for float data). IntegralImage2D<float, N, float> halves the memory traffic at the cost of precision on
+    * large images, which \ref setCompensatedSummation partially recovers.
     * \author Suat Gedikli
     */
-  template <class DataType, unsigned Dimension>
+  template <class DataType, unsigned Dimension,
+            class IntegralType = typename IntegralImageTypeTraits<DataType>::IntegralType>
   class IntegralImage2D
   {
     public:
       static const unsigned second_order_size = (Dimension * (Dimension + 1)) >> 1;
-      typedef Eigen::Matrix<typename IntegralImageTypeTraits<DataType>::IntegralType, Dimension, 1> ElementType;
-      typedef Eigen::Matrix<typename IntegralImageTypeTraits<DataType>::IntegralType, second_order_size, 1> SecondOrderType;
+      typedef Eigen::Matrix<IntegralType, Dimension, 1> ElementType;
+      typedef Eigen::Matrix<IntegralType, second_order_size, 1> SecondOrderType;
 
       /** \brief Constructor for an Integral Image
         * \param[in] compute_second_order_integral_images set to true if we want to compute a second order image
@@ -119,7 +123,9 @@ namespace pcl
         finite_values_integral_image_ (),
         width_ (1), 
         height_ (1), 
-        compute_second_order_integral_images_ (compute_second_order_integral_images)
+        compute_second_order_integral_images_ (compute_second_order_integral_images),
+        use_compensated_summation_ (false),
+        threads_ (1)
       {
       }
 
@@ -133,6 +139,26 @@ namespace pcl
       void 
       setSecondOrderComputation (bool compute_second_order_integral_images);
 
+      /** \brief Set whether the sums are accumulated with Kahan compensation. This mostly matters for integral
+        * images stored in float; it costs about twice the additions while building.
+        * \param[in] use_compensated_summation true to compensate the rounding errors of the running sums
+        */
+      inline void
+      setCompensatedSummation (bool use_compensated_summation)
+      {
+        use_compensated_summation_ = use_compensated_summation;
+      }
+
+      /** \brief Set the number of threads \ref setInput may use. The rows are split into horizontal bands that are
+        * integrated concurrently, and then shifted by the sums of the bands above them.
+        * \param[in] nr_threads the number of threads to use (default: 1, 0 sets the value to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
+
       /** \brief Set the input data to compute the integral image for
         * \param[in] data the input data
         * \param[in] width the width of the data
@@ -209,6 +235,17 @@ namespace pcl
       void
       computeIntegralImages (const DataType * data, unsigned row_stride, unsigned element_stride);
 
+      /** \brief Integrate a band of rows of the data, as if the row above it was zero
+        * \param[in] data the input data
+        * \param[in] row_stride the row stride of the data
+        * \param[in] element_stride the element stride of the data
+        * \param[in] row_begin the first row of the band
+        * \param[in] row_end the row past the last row of the band
+        */
+      template <bool compensated> void
+      integrateRows (const DataType * data, unsigned row_stride, unsigned element_stride,
+                     unsigned row_begin, unsigned row_end);
+
       std::vector<ElementType, Eigen::aligned_allocator<ElementType> > first_order_integral_image_;
       std::vector<SecondOrderType, Eigen::aligned_allocator<SecondOrderType> > second_order_integral_image_;
       std::vector<unsigned> finite_values_integral_image_;
@@ -220,18 +257,24 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief Indicates whether the sums are accumulated with Kahan compensation */
+      bool use_compensated_summation_;
+
+      /** \brief The number of threads used to compute the integral images (0 means automatic) */
+      unsigned threads_;
    };
 
    /**
      * \brief partial template specialization for integral images with just one channel.
      */
-  template <class DataType>
-  class IntegralImage2D <DataType, 1>
+  template <class DataType, class IntegralType>
+  class IntegralImage2D <DataType, 1, IntegralType>
   {
     public:
       static const unsigned second_order_size = 1;
-      typedef typename IntegralImageTypeTraits<DataType>::IntegralType ElementType;
-      typedef typename IntegralImageTypeTraits<DataType>::IntegralType SecondOrderType;
+      typedef IntegralType ElementType;
+      typedef IntegralType SecondOrderType;
 
       /** \brief Constructor for an Integral Image
         * \param[in] compute_second_order_integral_images set to true if we want to compute a second order image
@@ -241,7 +284,9 @@ namespace pcl
         second_order_integral_image_ (),
         finite_values_integral_image_ (),
         width_ (1), height_ (1), 
-        compute_second_order_integral_images_ (compute_second_order_integral_images)
+        compute_second_order_integral_images_ (compute_second_order_integral_images),
+        use_compensated_summation_ (false),
+        threads_ (1)
       {
       }
 
@@ -249,6 +294,26 @@ namespace pcl
       virtual
       ~IntegralImage2D () { }
 
+      /** \brief Set whether the sums are accumulated with Kahan compensation. This mostly matters for integral
+        * images stored in float; it costs about twice the additions while building.
+        * \param[in] use_compensated_summation true to compensate the rounding errors of the running sums
+        */
+      inline void
+      setCompensatedSummation (bool use_compensated_summation)
+      {
+        use_compensated_summation_ = use_compensated_summation;
+      }
+
+      /** \brief Set the number of threads \ref setInput may use. The rows are split into horizontal bands that are
+        * integrated concurrently, and then shifted by the sums of the bands above them.
+        * \param[in] nr_threads the number of threads to use (default: 1, 0 sets the value to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
+
       /** \brief Set the input data to compute the integral image for
         * \param[in] data the input data
         * \param[in] width the width of the data
@@ -325,6 +390,17 @@ namespace pcl
       void
       computeIntegralImages (const DataType * data, unsigned row_stride, unsigned element_stride);
 
+      /** \brief Integrate a band of rows of the data, as if the row above it was zero
+        * \param[in] data the input data
+        * \param[in] row_stride the row stride of the data
+        * \param[in] element_stride the element stride of the data
+        * \param[in] row_begin the first row of the band
+        * \param[in] row_end the row past the last row of the band
+        */
+      template <bool compensated> void
+      integrateRows (const DataType * data, unsigned row_stride, unsigned element_stride,
+                     unsigned row_begin, unsigned row_end);
+
       std::vector<ElementType, Eigen::aligned_allocator<ElementType> > first_order_integral_image_;
       std::vector<SecondOrderType, Eigen::aligned_allocator<SecondOrderType> > second_order_integral_image_;
       std::vector<unsigned> finite_values_integral_image_;
@@ -336,6 +412,12 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief Indicates whether the sums are accumulated with Kahan compensation */
+      bool use_compensated_summation_;
+
+      /** \brief The number of threads used to compute the integral images (0 means automatic) */
+      unsigned threads_;
    };
  }
 
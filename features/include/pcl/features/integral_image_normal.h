@@ -49,6 +49,10 @@
 namespace pcl
 {
   /** \brief Surface normal estimation on organized data using integral images.
+    * \note The integral images are built when the input cloud is set, using the number of threads set with
+    * setNumberOfThreads (), and their buffers are reused for the following clouds of the same size. For streams of
+    * frames, \ref setChangedDepthROI restricts the computation to the regions whose depth changed since the
+    * previous frame.
     * \author Stefan Holzer
     */
   template <typename PointInT, typename PointOutT>
@@ -58,6 +62,7 @@ namespace pcl
     using Feature<PointInT, PointOutT>::feature_name_;
     using Feature<PointInT, PointOutT>::tree_;
     using Feature<PointInT, PointOutT>::k_;
+    using Feature<PointInT, PointOutT>::threads_;
 
     public:
 
@@ -101,10 +106,10 @@ namespace pcl
         , integral_image_DY_ (false)
         , integral_image_depth_ (false)
         , integral_image_XYZ_ (true)
-        , diff_x_ (NULL)
-        , diff_y_ (NULL)
-        , depth_data_ (NULL)
-        , distance_map_ (NULL)
+        , diff_x_ ()
+        , diff_y_ ()
+        , depth_change_map_ ()
+        , distance_map_ ()
         , use_depth_dependent_smoothing_ (false)
         , max_depth_change_factor_ (20.0f*0.001f)
         , normal_smoothing_size_ (10.0f)
@@ -116,6 +121,14 @@ namespace pcl
         , vpy_ (0.0f)
         , vpz_ (0.0f)
         , use_sensor_origin_ (true)
+        , use_changed_depth_roi_ (false)
+        , roi_depth_change_threshold_ (0.0f)
+        , changed_depth_image_ (false)
+        , changed_depth_mask_ ()
+        , previous_depth_ ()
+        , previous_normals_ ()
+        , previous_frame_valid_ (false)
+        , nr_updated_normals_ (0)
       {
         feature_name_ = "IntegralImagesNormalEstimation";
         tree_.reset ();
@@ -139,6 +152,7 @@ namespace pcl
       setBorderPolicy (const BorderPolicy border_policy)
       {
         border_policy_ = border_policy;
+        previous_frame_valid_ = false;
       }
 
       /** \brief Computes the normal at the specified position.
@@ -167,6 +181,7 @@ namespace pcl
       setMaxDepthChangeFactor (float max_depth_change_factor)
       {
         max_depth_change_factor_ = max_depth_change_factor;
+        previous_frame_valid_ = false;
       }
 
       /** \brief Set the normal smoothing size
@@ -183,6 +198,7 @@ namespace pcl
           return;
         }
         normal_smoothing_size_ = normal_smoothing_size;
+        previous_frame_valid_ = false;
       }
 
       /** \brief Set the normal estimation method. The current implemented algorithms are:
@@ -201,6 +217,7 @@ namespace pcl
       setNormalEstimationMethod (NormalEstimationMethod normal_estimation_method)
       {
         normal_estimation_method_ = normal_estimation_method;
+        previous_frame_valid_ = false;
       }
 
       /** \brief Set whether to use depth depending smoothing or not
@@ -210,6 +227,7 @@ namespace pcl
       setDepthDependentSmoothing (bool use_depth_dependent_smoothing)
       {
         use_depth_dependent_smoothing_ = use_depth_dependent_smoothing;
+        previous_frame_valid_ = false;
       }
 
        /** \brief Provide a pointer to the input dataset (overwrites the PCLBase::setInputCloud method)
@@ -229,6 +247,9 @@ namespace pcl
         
         if (use_sensor_origin_)
         {
+          if (vpx_ != input_->sensor_origin_.coeff (0) || vpy_ != input_->sensor_origin_.coeff (1) ||
+              vpz_ != input_->sensor_origin_.coeff (2))
+            previous_frame_valid_ = false;
           vpx_ = input_->sensor_origin_.coeff (0);
           vpy_ = input_->sensor_origin_.coeff (1);
           vpz_ = input_->sensor_origin_.coeff (2);
@@ -243,7 +264,7 @@ namespace pcl
       inline float*
       getDistanceMap ()
       {
-        return (distance_map_);
+        return (distance_map_.empty () ? NULL : &distance_map_[0]);
       }
 
       /** \brief Set the viewpoint.
@@ -258,6 +279,7 @@ namespace pcl
         vpy_ = vpy;
         vpz_ = vpz;
         use_sensor_origin_ = false;
+        previous_frame_valid_ = false;
       }
 
       /** \brief Get the viewpoint.
@@ -284,6 +306,7 @@ namespace pcl
       useSensorOriginAsViewPoint ()
       {
         use_sensor_origin_ = true;
+        previous_frame_valid_ = false;
         if (input_)
         {
           vpx_ = input_->sensor_origin_.coeff (0);
@@ -297,6 +320,34 @@ namespace pcl
           vpz_ = 0;
         }
       }
+
+      /** \brief Set whether to compute the normals only where the depth changed since the previous frame. A normal
+        * is recomputed when any depth within its smoothing area (plus a margin for the depth change map) changed by
+        * more than the threshold, or became valid or invalid; all the other normals are copied from the previous
+        * frame. The integral images are still built for the whole frame, so the recomputed normals match a full
+        * computation up to the rounding of the integral image sums. The first frame, and every frame after a change of
+        * the cloud size or of the estimation parameters, is computed in full.
+        * \param[in] use_changed_depth_roi true to enable the region-of-interest mode
+        * \param[in] depth_change_threshold the depth change below which a point counts as unchanged. The depths are
+        * compared with the last depth that exceeded it, so slow drifts are caught up with.
+        * \note Only the z coordinates are compared, which suits clouds grabbed from depth sensors.
+        */
+      inline void
+      setChangedDepthROI (bool use_changed_depth_roi, float depth_change_threshold = 0.0f)
+      {
+        use_changed_depth_roi_ = use_changed_depth_roi;
+        roi_depth_change_threshold_ = depth_change_threshold;
+        previous_frame_valid_ = false;
+      }
+
+      /** \brief Get the number of normals the last call to compute () computed, rather than copied from the
+        * previous frame in the region-of-interest mode (see \ref setChangedDepthROI).
+        */
+      inline size_t
+      getNumberOfUpdatedNormals () const
+      {
+        return (nr_updated_normals_);
+      }
       
     protected:
 
@@ -344,15 +395,15 @@ namespace pcl
       IntegralImage2D<float, 3> integral_image_XYZ_;
 
       /** derivatives in x-direction */
-      float *diff_x_;
+      std::vector<float> diff_x_;
       /** derivatives in y-direction */
-      float *diff_y_;
+      std::vector<float> diff_y_;
 
-      /** depth data */
-      float *depth_data_;
+      /** depth change map */
+      std::vector<unsigned char> depth_change_map_;
 
       /** distance map */
-      float *distance_map_;
+      std::vector<float> distance_map_;
 
       /** \brief Smooth data based on depth (true/false). */
       bool use_depth_dependent_smoothing_;
@@ -381,6 +432,31 @@ namespace pcl
 
       /** whether the sensor origin of the input cloud or a user given viewpoint should be used.*/
       bool use_sensor_origin_;
+
+      /** \brief Compute the normals only where the depth changed since the previous frame (true/false). */
+      bool use_changed_depth_roi_;
+
+      /** \brief The depth change below which a point counts as unchanged in the region-of-interest mode. */
+      float roi_depth_change_threshold_;
+
+      /** \brief Integral image of changed_depth_mask_, to test whether a neighborhood changed. */
+      IntegralImage2D<unsigned char, 1> changed_depth_image_;
+
+      /** \brief 1 for the points whose depth changed since the previous frame, 0 otherwise. */
+      std::vector<unsigned char> changed_depth_mask_;
+
+      /** \brief The depths the current normals were computed from. */
+      std::vector<float> previous_depth_;
+
+      /** \brief The normals of the previous frame. */
+      typename PointCloudOut::VectorType previous_normals_;
+
+      /** \brief True when previous_depth_ and previous_normals_ belong to a frame computed with the current
+        * parameters. */
+      bool previous_frame_valid_;
+
+      /** \brief The number of normals computed by the last call to compute (). */
+      size_t nr_updated_normals_;
       
       /** \brief This method should get called before starting the actual computation. */
       bool
@@ -402,6 +478,21 @@ namespace pcl
       void
       initSimple3DGradientMethod ();
 
+      /** \brief Compare the depths of the input cloud with those of the previous frame, and build the integral
+        * image of the changed points.
+        * \return true if the normals of the previous frame can be reused where the depth did not change
+        */
+      bool
+      initChangedDepthROI ();
+
+      /** \brief Check whether any depth changed in the neighborhood the normal at a position is computed from.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] max_smoothing the largest smoothing size the normal at this position can be computed with
+        */
+      bool
+      hasChangedDepth (const int pos_x, const int pos_y, const float max_smoothing) const;
+
     private:
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud
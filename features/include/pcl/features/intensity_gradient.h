@@ -66,18 +66,15 @@ namespace pcl
       typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
 
       /** \brief Empty constructor. */
-      IntensityGradientEstimation () : intensity_ (), threads_ (0)
+      IntensityGradientEstimation () : intensity_ ()
       {
         feature_name_ = "IntensityGradientEstimation";
+        threads_ = 0;
       };
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
-        */
-      inline void
-      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
-
     protected:
+      using Feature<PointInT, PointOutT>::threads_;
+
       /** \brief Estimate the intensity gradients for a set of points given in <setInputCloud (), setIndices ()> using
         *  the surface in setSearchSurface () and the spatial locator in setSearchMethod ().
         *  \param output the resultant point cloud that contains the intensity gradient vectors
@@ -110,8 +107,6 @@ namespace pcl
     protected:
       ///intensity field accessor structure
       IntensitySelectorT intensity_;
-      ///number of threads to be used, default 0 (auto)
-      unsigned int threads_;
   };
 
   /** \brief IntensityGradientEstimation estimates the intensity gradient for a point cloud that contains position
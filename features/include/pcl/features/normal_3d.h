@@ -41,6 +41,7 @@
 #define PCL_NORMAL_3D_H_
 
 #include <pcl/features/feature.h>
+#include <pcl/features/normal_3d_simd.h>
 
 namespace pcl
 {
@@ -342,6 +343,31 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output);
 
+      /** \brief Estimate the normals of indices_[begin, end). The covariance matrices of normal_simd::PACKET_SIZE
+        * points are collected in a batch, and their plane parameters are solved at once.
+        * \param[in] begin the first position in indices_
+        * \param[in] end the position in indices_ past the last point
+        * \param[out] neighbors placeholder for the neighbors, reused across the queries
+        * \param[out] output the resultant point cloud, with a point for every index
+        */
+      void
+      computeNormals (size_t begin, size_t end, pcl::search::NeighborList &neighbors, PointCloudOut &output);
+
+      /** \brief Solve the plane parameters of a batch, store them in the output, and clear the batch.
+        * \param[in,out] batch the batch of covariance matrices
+        * \param[in] batch_idx the positions in indices_ of the points in the batch
+        * \param[out] output the resultant point cloud
+        */
+      void
+      solveBatch (normal_simd::PlaneFitBatch &batch, const size_t *batch_idx, PointCloudOut &output);
+
+      /** \brief Create a copy of the estimator for indices_[begin, end), see Feature::makeChunkEstimator. */
+      virtual typename Feature<PointInT, PointOutT>::Ptr
+      makeChunkEstimator (size_t begin, size_t end) const
+      {
+        return (Feature<PointInT, PointOutT>::copyForChunk (*this, begin, end));
+      }
+
       /** \brief Values describing the viewpoint ("pinhole" camera model assumed). For per point viewpoints, inherit
         * from NormalEstimation and provide your own computeFeature (). By default, the viewpoint is set to 0,0,0. */
       float vpx_, vpy_, vpz_;
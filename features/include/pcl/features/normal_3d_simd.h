@@ -0,0 +1,380 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_NORMAL_3D_SIMD_H_
+#define PCL_FEATURES_NORMAL_3D_SIMD_H_
+
+#include <pcl/features/feature.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Pick the widest instruction set the compiler was asked to target
+#if defined (__AVX__)
+#  include <immintrin.h>
+#  define PCL_NORMAL_SIMD_AVX
+#  define PCL_NORMAL_SIMD_WIDTH 8
+#elif defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define PCL_NORMAL_SIMD_SSE
+#  define PCL_NORMAL_SIMD_WIDTH 4
+#else
+#  define PCL_NORMAL_SIMD_WIDTH 1
+#endif
+
+namespace pcl
+{
+  /** \brief Vectorized covariance and plane fitting kernels for normal estimation.
+    *
+    * The covariance matrix of a neighborhood is accumulated PACKET_SIZE neighbors at a time, from coordinates
+    * gathered into structure of arrays registers and shifted to a point of the neighborhood, which keeps single
+    * precision accurate far from the origin. The covariance matrices of PACKET_SIZE neighborhoods are collected in
+    * a \ref PlaneFitBatch, which solves their smallest eigenvalue problems at once: the smallest eigenvalue is
+    * the first root of the characteristic polynomial, which Newton's method reaches monotonically from 0 for
+    * symmetric positive semi-definite matrices, and the eigenvector is the largest cross product of two rows of
+    * the shifted matrix, as in pcl::eigen33. Lanes that do not converge fall back to pcl::solvePlaneParameters.
+    *
+    * \author Open Perception
+    * \ingroup features
+    */
+  namespace normal_simd
+  {
+    /** \brief The number of neighbors accumulated, and of eigenvalue problems solved, at once. */
+    const int PACKET_SIZE = PCL_NORMAL_SIMD_WIDTH;
+
+#if defined (PCL_NORMAL_SIMD_AVX)
+    typedef __m256 Packet;
+    inline Packet load (const float *p)                  { return (_mm256_loadu_ps (p)); }
+    inline void   store (float *p, Packet a)             { _mm256_storeu_ps (p, a); }
+    inline Packet set1 (float a)                         { return (_mm256_set1_ps (a)); }
+    inline Packet add (Packet a, Packet b)               { return (_mm256_add_ps (a, b)); }
+    inline Packet sub (Packet a, Packet b)               { return (_mm256_sub_ps (a, b)); }
+    inline Packet mul (Packet a, Packet b)               { return (_mm256_mul_ps (a, b)); }
+    inline Packet div (Packet a, Packet b)               { return (_mm256_div_ps (a, b)); }
+    inline Packet maximum (Packet a, Packet b)           { return (_mm256_max_ps (a, b)); }
+    inline Packet sqrt (Packet a)                        { return (_mm256_sqrt_ps (a)); }
+    inline Packet abs (Packet a)                         { return (_mm256_andnot_ps (_mm256_set1_ps (-0.0f), a)); }
+    inline Packet cmple (Packet a, Packet b)             { return (_mm256_cmp_ps (a, b, _CMP_LE_OQ)); }
+    inline Packet select (Packet m, Packet a, Packet b)  { return (_mm256_blendv_ps (b, a, m)); }
+    inline Packet andMask (Packet a, Packet b)           { return (_mm256_and_ps (a, b)); }
+    inline Packet orMask (Packet a, Packet b)            { return (_mm256_or_ps (a, b)); }
+    inline bool   all (Packet m)                         { return (_mm256_movemask_ps (m) == 0xff); }
+#elif defined (PCL_NORMAL_SIMD_SSE)
+    typedef __m128 Packet;
+    inline Packet load (const float *p)                  { return (_mm_loadu_ps (p)); }
+    inline void   store (float *p, Packet a)             { _mm_storeu_ps (p, a); }
+    inline Packet set1 (float a)                         { return (_mm_set1_ps (a)); }
+    inline Packet add (Packet a, Packet b)               { return (_mm_add_ps (a, b)); }
+    inline Packet sub (Packet a, Packet b)               { return (_mm_sub_ps (a, b)); }
+    inline Packet mul (Packet a, Packet b)               { return (_mm_mul_ps (a, b)); }
+    inline Packet div (Packet a, Packet b)               { return (_mm_div_ps (a, b)); }
+    inline Packet maximum (Packet a, Packet b)           { return (_mm_max_ps (a, b)); }
+    inline Packet sqrt (Packet a)                        { return (_mm_sqrt_ps (a)); }
+    inline Packet abs (Packet a)                         { return (_mm_andnot_ps (_mm_set1_ps (-0.0f), a)); }
+    inline Packet cmple (Packet a, Packet b)             { return (_mm_cmple_ps (a, b)); }
+    inline Packet select (Packet m, Packet a, Packet b)  { return (_mm_or_ps (_mm_and_ps (m, a), _mm_andnot_ps (m, b))); }
+    inline Packet andMask (Packet a, Packet b)           { return (_mm_and_ps (a, b)); }
+    inline Packet orMask (Packet a, Packet b)            { return (_mm_or_ps (a, b)); }
+    inline bool   all (Packet m)                         { return (_mm_movemask_ps (m) == 0xf); }
+#else
+    // Masks are 1 (true) or 0 (false)
+    typedef float Packet;
+    inline Packet load (const float *p)                  { return (*p); }
+    inline void   store (float *p, Packet a)             { *p = a; }
+    inline Packet set1 (float a)                         { return (a); }
+    inline Packet add (Packet a, Packet b)               { return (a + b); }
+    inline Packet sub (Packet a, Packet b)               { return (a - b); }
+    inline Packet mul (Packet a, Packet b)               { return (a * b); }
+    inline Packet div (Packet a, Packet b)               { return (a / b); }
+    inline Packet maximum (Packet a, Packet b)           { return (a > b ? a : b); }
+    inline Packet sqrt (Packet a)                        { return (sqrtf (a)); }
+    inline Packet abs (Packet a)                         { return (fabsf (a)); }
+    inline Packet cmple (Packet a, Packet b)             { return (a <= b ? 1.0f : 0.0f); }
+    inline Packet select (Packet m, Packet a, Packet b)  { return (m != 0.0f ? a : b); }
+    inline Packet andMask (Packet a, Packet b)           { return (a != 0.0f && b != 0.0f ? 1.0f : 0.0f); }
+    inline Packet orMask (Packet a, Packet b)            { return (a != 0.0f || b != 0.0f ? 1.0f : 0.0f); }
+    inline bool   all (Packet m)                         { return (m != 0.0f); }
+#endif
+
+    /** \brief Sum the lanes of a packet. */
+    inline float
+    sum (Packet a)
+    {
+      float lanes[PACKET_SIZE];
+      store (lanes, a);
+      float s = 0;
+      for (int i = 0; i < PACKET_SIZE; ++i)
+        s += lanes[i];
+      return (s);
+    }
+
+    /** \brief Compute the cross product of two packets of 3D vectors. */
+    inline void
+    cross3 (Packet ax, Packet ay, Packet az, Packet bx, Packet by, Packet bz, Packet &cx, Packet &cy, Packet &cz)
+    {
+      cx = sub (mul (ay, bz), mul (az, by));
+      cy = sub (mul (az, bx), mul (ax, bz));
+      cz = sub (mul (ax, by), mul (ay, bx));
+    }
+
+    /** \brief Compute the covariance matrix of a set of points, given by their indices, with packet
+      * accumulation. Non-finite points are skipped if the cloud is not dense.
+      * \param[in] cloud the input point cloud
+      * \param[in] indices the indices of the points
+      * \param[in] nr_indices the number of indices
+      * \param[out] covariance the upper triangle of the covariance matrix: xx, xy, xz, yy, yz, zz
+      * \return the number of valid points used to compute the covariance matrix
+      */
+    template <typename PointT> inline unsigned int
+    computeCovariance (const pcl::PointCloud<PointT> &cloud, const int *indices, size_t nr_indices,
+                       float covariance[6])
+    {
+      // Shift the coordinates to a valid point of the set, so that the moments stay small
+      size_t first = 0;
+      if (!cloud.is_dense)
+        while (first < nr_indices && !isFinite (cloud.points[indices[first]]))
+          ++first;
+      if (first == nr_indices)
+        return (0);
+      const PointT &ref = cloud.points[indices[first]];
+      const Packet rx = set1 (ref.x), ry = set1 (ref.y), rz = set1 (ref.z);
+
+      Packet sx = set1 (0), sy = set1 (0), sz = set1 (0);
+      Packet sxx = set1 (0), sxy = set1 (0), sxz = set1 (0), syy = set1 (0), syz = set1 (0), szz = set1 (0);
+      unsigned int point_count = 0;
+
+      float bx[PACKET_SIZE], by[PACKET_SIZE], bz[PACKET_SIZE];
+      size_t i = first;
+      while (i < nr_indices)
+      {
+        // Gather the next PACKET_SIZE valid points, and pad with the reference point, which adds nothing
+        int n = 0;
+        for (; n < PACKET_SIZE && i < nr_indices; ++i)
+        {
+          const PointT &p = cloud.points[indices[i]];
+          if (!cloud.is_dense && !isFinite (p))
+            continue;
+          bx[n] = p.x; by[n] = p.y; bz[n] = p.z;
+          ++n;
+        }
+        point_count += n;
+        for (; n < PACKET_SIZE; ++n)
+        {
+          bx[n] = ref.x; by[n] = ref.y; bz[n] = ref.z;
+        }
+
+        Packet x = sub (load (bx), rx), y = sub (load (by), ry), z = sub (load (bz), rz);
+        sx = add (sx, x); sy = add (sy, y); sz = add (sz, z);
+        sxx = add (sxx, mul (x, x)); sxy = add (sxy, mul (x, y)); sxz = add (sxz, mul (x, z));
+        syy = add (syy, mul (y, y)); syz = add (syz, mul (y, z)); szz = add (szz, mul (z, z));
+      }
+
+      const float inv_count = 1.0f / static_cast<float> (point_count);
+      const float mx = sum (sx) * inv_count, my = sum (sy) * inv_count, mz = sum (sz) * inv_count;
+      covariance[0] = sum (sxx) * inv_count - mx * mx;
+      covariance[1] = sum (sxy) * inv_count - mx * my;
+      covariance[2] = sum (sxz) * inv_count - mx * mz;
+      covariance[3] = sum (syy) * inv_count - my * my;
+      covariance[4] = sum (syz) * inv_count - my * mz;
+      covariance[5] = sum (szz) * inv_count - mz * mz;
+      return (point_count);
+    }
+
+    /** \brief Compute the covariance matrix of a set of points, given by a vector of indices.
+      * \param[in] cloud the input point cloud
+      * \param[in] indices the indices of the points
+      * \param[out] covariance the upper triangle of the covariance matrix: xx, xy, xz, yy, yz, zz
+      * \return the number of valid points used to compute the covariance matrix
+      */
+    template <typename PointT> inline unsigned int
+    computeCovariance (const pcl::PointCloud<PointT> &cloud, const std::vector<int> &indices, float covariance[6])
+    {
+      return (indices.empty () ? 0 : computeCovariance (cloud, &indices[0], indices.size (), covariance));
+    }
+
+    /** \brief A batch of up to PACKET_SIZE covariance matrices, stored as structure of arrays, whose plane
+      * normals and curvatures are solved at once.
+      */
+    class PlaneFitBatch
+    {
+      public:
+        /** \brief The maximum number of Newton iterations before a lane falls back to pcl::eigen33. */
+        static const int MAX_ITERATIONS = 24;
+
+        PlaneFitBatch () : size_ (0) {}
+
+        /** \brief Remove all the covariance matrices. */
+        inline void
+        clear () { size_ = 0; }
+
+        /** \brief Get the number of covariance matrices in the batch. */
+        inline int
+        size () const { return (size_); }
+
+        /** \brief Check whether the batch holds PACKET_SIZE covariance matrices. */
+        inline bool
+        full () const { return (size_ == PACKET_SIZE); }
+
+        /** \brief Add the covariance matrix of a set of points to the batch, if the batch is not full.
+          * \param[in] cloud the input point cloud
+          * \param[in] indices the indices of the points
+          * \return the number of valid points; nothing is added to the batch if it is 0
+          */
+        template <typename PointT> inline unsigned int
+        addCovariance (const pcl::PointCloud<PointT> &cloud, const std::vector<int> &indices)
+        {
+          return (indices.empty () ? 0 : addCovariance (cloud, &indices[0], indices.size ()));
+        }
+
+        /** \brief Add the covariance matrix of a set of points to the batch, if the batch is not full.
+          * \param[in] cloud the input point cloud
+          * \param[in] indices the indices of the points
+          * \param[in] nr_indices the number of indices
+          * \return the number of valid points; nothing is added to the batch if it is 0
+          */
+        template <typename PointT> inline unsigned int
+        addCovariance (const pcl::PointCloud<PointT> &cloud, const int *indices, size_t nr_indices)
+        {
+          float covariance[6];
+          unsigned int point_count = computeCovariance (cloud, indices, nr_indices, covariance);
+          if (point_count != 0)
+          {
+            for (int c = 0; c < 6; ++c)
+              cov_[c][size_] = covariance[c];
+            ++size_;
+          }
+          return (point_count);
+        }
+
+        /** \brief Solve the plane parameters of all the covariance matrices in the batch.
+          * \param[out] nx the X components of the plane normals, one per covariance matrix
+          * \param[out] ny the Y components of the plane normals
+          * \param[out] nz the Z components of the plane normals
+          * \param[out] curvature the surface curvatures, as the smallest eigenvalue over the trace
+          */
+        void
+        solvePlaneParameters (float *nx, float *ny, float *nz, float *curvature)
+        {
+          if (size_ == 0)
+            return;
+
+          // Replicate the last matrix into the unused lanes
+          for (int c = 0; c < 6; ++c)
+            for (int i = size_; i < PACKET_SIZE; ++i)
+              cov_[c][i] = cov_[c][size_ - 1];
+
+          const Packet c00 = load (cov_[0]), c01 = load (cov_[1]), c02 = load (cov_[2]);
+          const Packet c11 = load (cov_[3]), c12 = load (cov_[4]), c22 = load (cov_[5]);
+
+          // Scale the matrices so that their entries are in [-1, 1]
+          Packet scale = maximum (maximum (maximum (abs (c00), abs (c01)), maximum (abs (c02), abs (c11))), maximum (abs (c12), abs (c22)));
+          scale = select (cmple (scale, set1 (std::numeric_limits<float>::min ())), set1 (1.0f), scale);
+          const Packet inv_scale = div (set1 (1.0f), scale);
+          Packet m00 = mul (c00, inv_scale), m01 = mul (c01, inv_scale), m02 = mul (c02, inv_scale);
+          Packet m11 = mul (c11, inv_scale), m12 = mul (c12, inv_scale), m22 = mul (c22, inv_scale);
+
+          // Characteristic polynomial x^3 - k2*x^2 + k1*x - k0
+          const Packet k2 = add (add (m00, m11), m22);
+          const Packet k1 = sub (add (add (mul (m00, m11), mul (m00, m22)), mul (m11, m22)),
+                                 add (add (mul (m01, m01), mul (m02, m02)), mul (m12, m12)));
+          const Packet k0 = sub (add (mul (mul (m00, m11), m22), mul (set1 (2.0f), mul (mul (m01, m02), m12))),
+                                 add (add (mul (m00, mul (m12, m12)), mul (m11, mul (m02, m02))), mul (m22, mul (m01, m01))));
+
+          // The polynomial is negative and concave left of its smallest root, so Newton's method from 0
+          // approaches the root from below
+          const Packet tolerance = mul (k2, set1 (16.0f * std::numeric_limits<float>::epsilon ()));
+          Packet x = set1 (0), done = set1 (0);
+          for (int it = 0; it < MAX_ITERATIONS && !all (done); ++it)
+          {
+            Packet p = sub (mul (add (mul (sub (x, k2), x), k1), x), k0);
+            Packet dp = add (mul (sub (mul (set1 (3.0f), x), mul (set1 (2.0f), k2)), x), k1);
+            Packet step = div (p, dp);
+            x = select (done, x, sub (x, step));
+            done = orMask (done, cmple (abs (step), tolerance));
+          }
+          // The eigenvalues of a positive semi-definite matrix can not be negative
+          x = maximum (x, set1 (0));
+
+          // The eigenvector is the largest cross product of two rows of the shifted matrix
+          m00 = sub (m00, x); m11 = sub (m11, x); m22 = sub (m22, x);
+          Packet v1x, v1y, v1z, v2x, v2y, v2z, v3x, v3y, v3z;
+          cross3 (m00, m01, m02, m01, m11, m12, v1x, v1y, v1z);
+          cross3 (m00, m01, m02, m02, m12, m22, v2x, v2y, v2z);
+          cross3 (m01, m11, m12, m02, m12, m22, v3x, v3y, v3z);
+          const Packet len1 = add (add (mul (v1x, v1x), mul (v1y, v1y)), mul (v1z, v1z));
+          const Packet len2 = add (add (mul (v2x, v2x), mul (v2y, v2y)), mul (v2z, v2z));
+          const Packet len3 = add (add (mul (v3x, v3x), mul (v3y, v3y)), mul (v3z, v3z));
+          const Packet use1 = andMask (cmple (len2, len1), cmple (len3, len1));
+          const Packet use2 = cmple (len3, len2);
+          Packet vx = select (use1, v1x, select (use2, v2x, v3x));
+          Packet vy = select (use1, v1y, select (use2, v2y, v3y));
+          Packet vz = select (use1, v1z, select (use2, v2z, v3z));
+          const Packet inv_len = div (set1 (1.0f), sqrt (select (use1, len1, select (use2, len2, len3))));
+
+          const Packet trace = add (add (c00, c11), c22);
+          const Packet zero_trace = andMask (cmple (trace, set1 (0)), cmple (set1 (0), trace));
+          Packet curv = select (zero_trace, set1 (0), abs (div (mul (x, scale), trace)));
+
+          float converged[PACKET_SIZE];
+          store (nx, mul (vx, inv_len)); store (ny, mul (vy, inv_len)); store (nz, mul (vz, inv_len));
+          store (curvature, curv);
+          store (converged, done);
+
+          // Solve the lanes that did not converge, e.g. with repeated smallest eigenvalues, with pcl::eigen33
+          for (int i = 0; i < size_; ++i)
+          {
+            if (converged[i] != 0.0f && pcl_isfinite (nx[i]) && pcl_isfinite (ny[i]) && pcl_isfinite (nz[i]))
+              continue;
+            EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
+            covariance_matrix << cov_[0][i], cov_[1][i], cov_[2][i],
+                                 cov_[1][i], cov_[3][i], cov_[4][i],
+                                 cov_[2][i], cov_[4][i], cov_[5][i];
+            pcl::solvePlaneParameters (covariance_matrix, nx[i], ny[i], nz[i], curvature[i]);
+          }
+        }
+
+      private:
+        /** \brief The upper triangles of the covariance matrices: xx, xy, xz, yy, yz, zz. */
+        float cov_[6][PACKET_SIZE];
+
+        /** \brief The number of covariance matrices in the batch. */
+        int size_;
+    };
+  }
+}
+
+#endif  //#ifndef PCL_FEATURES_NORMAL_3D_SIMD_H_
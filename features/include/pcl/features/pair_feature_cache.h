@@ -0,0 +1,252 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef PCL_FEATURES_PAIR_FEATURE_CACHE_H_
+#define PCL_FEATURES_PAIR_FEATURE_CACHE_H_
+
+#include <algorithm>
+#include <vector>
+#include <Eigen/Core>
+#include <pcl/pcl_macros.h>
+#include <pcl/common/atomic.h>
+
+namespace pcl
+{
+  /** \brief PairFeatureCache memoizes the 4-tuple features (f1, f2, f3, f4) of point pairs, keyed by the unordered
+    * pair of point indices. It is used by \ref PFHEstimation to avoid computing the same pair for every
+    * neighborhood that contains both points.
+    *
+    * The cache is a fixed size, open addressing hash table that any number of threads can probe and fill at once
+    * without locks. A free slot is claimed with a compare-and-swap, and published once its key and features are
+    * written; it is never overwritten afterwards. An insertion that finds no free slot within a short probe window
+    * is dropped, so a full cache keeps serving the pairs it already holds.
+    *
+    * \author Open Perception
+    * \ingroup features
+    */
+  class PairFeatureCache
+  {
+    public:
+      /** \brief Constructor.
+        * \param[in] capacity the maximum number of entries, see \ref reset
+        */
+      PairFeatureCache (size_t capacity = 0) : entries_ (), hits_ (0), misses_ (0)
+      {
+        reset (capacity);
+      }
+
+      /** \brief Remove all the entries and reset the statistics. The table is resized to the largest power of two
+        * not above \a capacity. Must not be called while other threads use the cache.
+        * \param[in] capacity the maximum number of entries
+        */
+      inline void
+      reset (size_t capacity)
+      {
+        size_t size = capacity ? 1 : 0;
+        while (size && size <= capacity / 2)
+          size *= 2;
+
+        if (entries_.size () != size)
+          std::vector<Entry> (size).swap (entries_);
+        else
+          for (size_t i = 0; i < entries_.size (); ++i)
+            entries_[i].state = EMPTY;
+        hits_ = misses_ = 0;
+      }
+
+      /** \brief Get the number of entries the table can hold. */
+      inline size_t
+      getCapacity () const
+      {
+        return (entries_.size ());
+      }
+
+      /** \brief Look the features of a pair up.
+        * \param[in] p_idx the index of the first point
+        * \param[in] q_idx the index of the second point; the order of \a p_idx and \a q_idx does not matter
+        * \param[out] features the cached features, if any
+        * \return true if the pair was found
+        */
+      inline bool
+      find (int p_idx, int q_idx, Eigen::Vector4f &features) const
+      {
+        if (entries_.empty ())
+          return (false);
+        const int lo = (std::min) (p_idx, q_idx), hi = (std::max) (p_idx, q_idx);
+        const size_t mask = entries_.size () - 1;
+        size_t slot = hash (lo, hi) & mask;
+        for (int probe = 0; probe < PROBE_LENGTH; ++probe, slot = (slot + 1) & mask)
+        {
+          const Entry &entry = entries_[slot];
+          const int state = atomicLoadAcquire (&entry.state);
+          // Entries are never removed, so the pair would have been stored in the first free slot
+          if (state == EMPTY)
+            return (false);
+          if (state == READY && entry.p_idx == lo && entry.q_idx == hi)
+          {
+            features = Eigen::Vector4f (entry.features[0], entry.features[1], entry.features[2], entry.features[3]);
+            return (true);
+          }
+        }
+        return (false);
+      }
+
+      /** \brief Store the features of a pair. Nothing is stored if the probe window of the pair is full.
+        * \param[in] p_idx the index of the first point
+        * \param[in] q_idx the index of the second point; the order of \a p_idx and \a q_idx does not matter
+        * \param[in] features the features of the pair
+        */
+      inline void
+      insert (int p_idx, int q_idx, const Eigen::Vector4f &features)
+      {
+        if (entries_.empty ())
+          return;
+        const int lo = (std::min) (p_idx, q_idx), hi = (std::max) (p_idx, q_idx);
+        const size_t mask = entries_.size () - 1;
+        size_t slot = hash (lo, hi) & mask;
+        for (int probe = 0; probe < PROBE_LENGTH; ++probe, slot = (slot + 1) & mask)
+        {
+          Entry &entry = entries_[slot];
+          const int state = atomicLoadAcquire (&entry.state);
+          if (state == READY && entry.p_idx == lo && entry.q_idx == hi)
+            return;
+          // A failed swap means another thread claimed the slot first; its pair is unknown yet, so move on
+          if (state == EMPTY && atomicCompareAndSwap (&entry.state, EMPTY, WRITING))
+          {
+            entry.p_idx = lo;
+            entry.q_idx = hi;
+            for (int d = 0; d < 4; ++d)
+              entry.features[d] = features[d];
+            atomicStoreRelease (&entry.state, READY);
+            return;
+          }
+        }
+      }
+
+      /** \brief Add the outcome of a series of lookups to the statistics. Safe to call from OpenMP threads.
+        * \param[in] hits the number of lookups that found their pair
+        * \param[in] misses the number of lookups that did not
+        */
+      inline void
+      addStatistics (uint64_t hits, uint64_t misses)
+      {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        hits_ += hits;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        misses_ += misses;
+      }
+
+      /** \brief Get the number of lookups that found their pair since the last \ref reset. */
+      inline uint64_t
+      getHits () const
+      {
+        return (hits_);
+      }
+
+      /** \brief Get the number of lookups that did not find their pair since the last \ref reset. */
+      inline uint64_t
+      getMisses () const
+      {
+        return (misses_);
+      }
+
+      /** \brief Get the fraction of the lookups that found their pair since the last \ref reset (0 if none). */
+      inline double
+      getHitRate () const
+      {
+        const uint64_t lookups = hits_ + misses_;
+        return (lookups ? static_cast<double> (hits_) / static_cast<double> (lookups) : 0.0);
+      }
+
+    protected:
+      /** \brief The states of a slot: free, claimed by a writer, or holding a pair. */
+      enum { EMPTY = 0, WRITING = 1, READY = 2 };
+
+      /** \brief The number of slots probed, starting at the hash of a pair, before giving up. */
+      enum { PROBE_LENGTH = 16 };
+
+      /** \brief A slot of the table. */
+      struct Entry
+      {
+        Entry () : state (EMPTY), p_idx (0), q_idx (0)
+        {
+          features[0] = features[1] = features[2] = features[3] = 0.0f;
+        }
+
+        /** \brief The state of the slot, only accessed atomically. */
+        int state;
+        /** \brief The smaller point index of the pair. */
+        int p_idx;
+        /** \brief The larger point index of the pair. */
+        int q_idx;
+        /** \brief The features of the pair. */
+        float features[4];
+      };
+
+      /** \brief Hash an ordered pair of point indices.
+        * \param[in] lo the smaller point index
+        * \param[in] hi the larger point index
+        */
+      static inline size_t
+      hash (int lo, int hi)
+      {
+        uint32_t h = static_cast<uint32_t> (lo) * 0x9e3779b1u + static_cast<uint32_t> (hi);
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return (static_cast<size_t> (h));
+      }
+
+      /** \brief The slots of the table; the size is a power of two. */
+      std::vector<Entry> entries_;
+
+      /** \brief The number of lookups that found their pair. */
+      uint64_t hits_;
+
+      /** \brief The number of lookups that did not find their pair. */
+      uint64_t misses_;
+  };
+}
+
+#endif  // PCL_FEATURES_PAIR_FEATURE_CACHE_H_
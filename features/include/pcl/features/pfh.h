@@ -42,6 +42,7 @@
 
 #include <pcl/point_types.h>
 #include <pcl/features/feature.h>
+#include <pcl/features/pair_feature_cache.h>
 #include <map>
 
 namespace pcl
@@ -91,8 +92,10 @@ namespace pcl
     *     doesn't have finite 3D coordinates. Therefore, any point that contains
     *     NaN data on x, y, or z, will have its PFH feature property set to NaN.
     *
-    * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref FPFHEstimationOMP for examples on parallel implementations of the FPFH (Fast Point Feature Histogram).
+    * \note The estimation runs on several threads with setNumberOfThreads (). The threads of a compute () call
+    * share the internal pair feature cache (see \ref setUseInternalCache), so a pair computed for one neighborhood
+    * is reused by all the others. The cache only lives for one compute () call, and copies of an estimator get
+    * their own cache.
     *
     * \author Radu B. Rusu
     * \ingroup features
@@ -121,16 +124,51 @@ namespace pcl
         pfh_histogram_ (),
         pfh_tuple_ (),
         d_pi_ (1.0f / (2.0f * static_cast<float> (M_PI))), 
-        feature_map_ (),
-        key_list_ (),
+        feature_cache_ (new PairFeatureCache),
         // Default 1GB memory size. Need to set it to something more conservative.
         max_cache_size_ ((1ul*1024ul*1024ul*1024ul) / sizeof (std::pair<std::pair<int, int>, Eigen::Vector4f>)),
-        use_cache_ (false)
+        use_cache_ (false),
+        cache_hit_rate_ (0)
       {
         feature_name_ = "PFHEstimation";
       };
 
-      /** \brief Set the maximum internal cache size. Defaults to 2GB worth of entries.
+      /** \brief Copy constructor. The copy gets its own, empty internal cache.
+        * \param[in] src the estimator to copy
+        */
+      PFHEstimation (const PFHEstimation &src) :
+        FeatureFromNormals<PointInT, PointNT, PointOutT> (src),
+        nr_subdiv_ (src.nr_subdiv_),
+        pfh_histogram_ (src.pfh_histogram_),
+        pfh_tuple_ (src.pfh_tuple_),
+        d_pi_ (src.d_pi_),
+        feature_cache_ (new PairFeatureCache),
+        max_cache_size_ (src.max_cache_size_),
+        use_cache_ (src.use_cache_),
+        cache_hit_rate_ (src.cache_hit_rate_)
+      {
+      }
+
+      /** \brief Copy operator. The estimator keeps its own internal cache, which is emptied.
+        * \param[in] src the estimator to copy
+        */
+      PFHEstimation&
+      operator = (const PFHEstimation &src)
+      {
+        FeatureFromNormals<PointInT, PointNT, PointOutT>::operator = (src);
+        nr_subdiv_ = src.nr_subdiv_;
+        pfh_histogram_ = src.pfh_histogram_;
+        pfh_tuple_ = src.pfh_tuple_;
+        d_pi_ = src.d_pi_;
+        feature_cache_.reset (new PairFeatureCache);
+        max_cache_size_ = src.max_cache_size_;
+        use_cache_ = src.use_cache_;
+        cache_hit_rate_ = src.cache_hit_rate_;
+        return (*this);
+      }
+
+      /** \brief Set the maximum internal cache size, in number of point pairs. Defaults to 1GB worth of entries.
+        * The cache is sized for each compute () call from the number of query points, up to this maximum.
         * \param[in] cache_size maximum cache size 
         */
       inline void
@@ -155,6 +193,11 @@ namespace pcl
         *
         * See \ref setMaximumCacheSize for setting the maximum cache size
         *
+        * \note With the cache, the features of a pair are always computed from its smaller point index, whatever
+        * the order of the two points in the neighborhood. Without it, the order of the neighborhood is used. This
+        * only makes a difference for a pair whose two normals make the same angle with the line joining the points
+        * (e.g. two points with the same normal), where the sign of the third feature depends on the order.
+        *
         * \param[in] use_cache set to true to use the internal cache, false otherwise
         */
       inline void
@@ -170,6 +213,15 @@ namespace pcl
         return (use_cache_);
       }
 
+      /** \brief Get the fraction of the pair lookups served by the internal cache during the last compute () call
+        * (0 if the cache is not used).
+        */
+      inline double
+      getCacheHitRate () const
+      {
+        return (cache_hit_rate_);
+      }
+
       /** \brief Compute the 4-tuple representation containing the three angles and one distance between two points
         * represented by Cartesian coordinates and normals.
         * \note For explanations about the features, please see the literature mentioned above (the order of the
@@ -201,6 +253,18 @@ namespace pcl
                                 const std::vector<int> &indices, int nr_split, Eigen::VectorXf &pfh_histogram);
 
     protected:
+      /** \brief This method should get called before starting the actual computation. On top of the checks of
+        * FeatureFromNormals, it sizes and clears the internal cache when it is used.
+        */
+      virtual bool
+      initCompute ();
+
+      /** \brief This method should get called after ending the actual computation. It records the hit rate of the
+        * internal cache and empties it, so that its entries are not used for another cloud.
+        */
+      virtual bool
+      deinitCompute ();
+
       /** \brief Estimate the Point Feature Histograms (PFH) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
         * setSearchMethod ()
@@ -209,6 +273,17 @@ namespace pcl
       void 
       computeFeature (PointCloudOut &output);
 
+      /** \brief Create a copy of the estimator for indices_[begin, end), see Feature::makeChunkEstimator. Unlike
+        * other copies, the chunk estimators share the internal cache of this estimator.
+        */
+      virtual typename Feature<PointInT, PointOutT>::Ptr
+      makeChunkEstimator (size_t begin, size_t end) const
+      {
+        boost::shared_ptr<PFHEstimation> chunk = Feature<PointInT, PointOutT>::copyForChunk (*this, begin, end);
+        chunk->feature_cache_ = feature_cache_;
+        return (chunk);
+      }
+
       /** \brief The number of subdivisions for each angular feature interval. */
       int nr_subdiv_;
 
@@ -224,17 +299,19 @@ namespace pcl
       /** \brief Float constant = 1.0 / (2.0 * M_PI) */
       float d_pi_; 
 
-      /** \brief Internal hashmap, used to optimize efficiency of redundant computations. */
-      std::map<std::pair<int, int>, Eigen::Vector4f, std::less<std::pair<int, int> >, Eigen::aligned_allocator<Eigen::Vector4f> > feature_map_;
-
-      /** \brief Queue of pairs saved, used to constrain memory usage. */
-      std::queue<std::pair<int, int> > key_list_;
+      /** \brief Internal cache of pair features, used to optimize efficiency of redundant computations. It is
+        * only shared with the chunk estimators that compute () runs on several threads (see \ref makeChunkEstimator).
+        */
+      boost::shared_ptr<PairFeatureCache> feature_cache_;
 
       /** \brief Maximum size of internal cache memory. */
       unsigned int max_cache_size_;
 
       /** \brief Set to true to use the internal cache for removing redundant computations. */
       bool use_cache_;
+
+      /** \brief Fraction of the pair lookups served by the internal cache during the last compute () call. */
+      double cache_hit_rate_;
     private:
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud 
@@ -285,8 +362,7 @@ namespace pcl
       using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::normals_;
       using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::computePointPFHSignature;
       using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::compute;
-      using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::feature_map_;
-      using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::key_list_;
+      using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::feature_cache_;
 
     private:
       /** \brief Estimate the Point Feature Histograms (PFH) descriptors at a set of points given by
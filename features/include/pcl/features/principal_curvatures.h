@@ -111,6 +111,13 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output);
 
+      /** \brief Create a copy of the estimator for indices_[begin, end), see Feature::makeChunkEstimator. */
+      virtual typename Feature<PointInT, PointOutT>::Ptr
+      makeChunkEstimator (size_t begin, size_t end) const
+      {
+        return (Feature<PointInT, PointOutT>::copyForChunk (*this, begin, end));
+      }
+
     private:
       /** \brief A pointer to the input dataset that contains the point normals of the XYZ dataset. */
       std::vector<Eigen::Vector3f> projected_normals_;
@@ -202,6 +202,17 @@ namespace pcl
       void 
       computeFeature (PointCloudOut &output);
 
+      /** \brief Create a copy of the estimator for indices_[begin, end), see Feature::makeChunkEstimator. The
+        * saved histograms are gathered by a single estimator, so they are only computed serially.
+        */
+      virtual typename Feature<PointInT, PointOutT>::Ptr
+      makeChunkEstimator (size_t begin, size_t end) const
+      {
+        if (save_histograms_)
+          return (typename Feature<PointInT, PointOutT>::Ptr ());
+        return (Feature<PointInT, PointOutT>::copyForChunk (*this, begin, end));
+      }
+
       /** \brief The list of full distance-angle histograms for all points. */
       boost::shared_ptr<std::vector<Eigen::MatrixXf, Eigen::aligned_allocator<Eigen::MatrixXf> > > histograms_;
 
@@ -245,6 +245,13 @@ namespace pcl
       virtual void 
       computeFeature (PointCloudOut &output); 
 
+      /** \brief Create a copy of the estimator for indices_[begin, end), see Feature::makeChunkEstimator. */
+      virtual typename Feature<PointInT, PointOutT>::Ptr
+      makeChunkEstimator (size_t begin, size_t end) const
+      {
+        return (Feature<PointInT, PointOutT>::copyForChunk (*this, begin, end));
+      }
+
       /** \brief initializes computations specific to spin-image.
         * 
         * \return true iff input data and initialization are correct
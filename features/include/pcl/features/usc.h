@@ -163,6 +163,21 @@ namespace pcl
       virtual void
       computeFeature (PointCloudOut &output);
 
+      /** \brief Create a copy of the estimator for indices_[begin, end), with the matching local reference frames,
+        * see Feature::makeChunkEstimator.
+        */
+      virtual typename Feature<PointInT, PointOutT>::Ptr
+      makeChunkEstimator (size_t begin, size_t end) const
+      {
+        Ptr copy = Feature<PointInT, PointOutT>::copyForChunk (*this, begin, end);
+        typename pcl::PointCloud<PointRFT>::Ptr frames (new pcl::PointCloud<PointRFT>);
+        frames->points.assign (frames_->points.begin () + begin, frames_->points.begin () + end);
+        frames->width = static_cast<uint32_t> (frames->points.size ());
+        frames->height = 1;
+        copy->frames_ = frames;
+        return (copy);
+      }
+
       /** \brief values of the radii interval. */
       std::vector<float> radii_interval_;
 
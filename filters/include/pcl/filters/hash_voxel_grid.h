@@ -0,0 +1,206 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FILTERS_HASH_VOXEL_GRID_H_
+#define PCL_FILTERS_HASH_VOXEL_GRID_H_
+
+#include <pcl/filters/voxel_grid.h>
+
+namespace pcl
+{
+  /** \brief HashVoxelGrid downsamples a PointCloud like \ref VoxelGrid, but accumulates the centroids in an
+    * open-addressing hash table keyed by the grid cell coordinates, in a single pass over the data.
+    *
+    * No bounding box is needed and nothing is sorted, so the memory used scales with the number of occupied
+    * cells, not with the volume of the grid. The centroids are exact (they are identical to the ones computed
+    * by \ref VoxelGrid), but the output points come in the order in which their cells are first seen in the
+    * input, instead of the grid order.
+    *
+    * The hash table is kept after filtering and its capacity is reused by the next call, which makes the
+    * filter suited for streams of clouds. The cell lookup methods (\a getCentroidIndex, \a getCentroidIndexAt
+    * and \a getNeighborCentroidIndices) are served from the hash table, so the dense leaf layout of
+    * \ref VoxelGrid is never allocated, and \a setSaveLeafLayout has no effect.
+    *
+    * \ingroup filters
+    */
+  template <typename PointT>
+  class HashVoxelGrid: public VoxelGrid<PointT>
+  {
+    protected:
+      using VoxelGrid<PointT>::filter_name_;
+      using VoxelGrid<PointT>::getClassName;
+      using VoxelGrid<PointT>::input_;
+      using VoxelGrid<PointT>::indices_;
+      using VoxelGrid<PointT>::inverse_leaf_size_;
+      using VoxelGrid<PointT>::downsample_all_data_;
+      using VoxelGrid<PointT>::min_b_;
+      using VoxelGrid<PointT>::max_b_;
+      using VoxelGrid<PointT>::div_b_;
+      using VoxelGrid<PointT>::divb_mul_;
+      using VoxelGrid<PointT>::filter_field_name_;
+      using VoxelGrid<PointT>::filter_limit_min_;
+      using VoxelGrid<PointT>::filter_limit_max_;
+      using VoxelGrid<PointT>::filter_limit_negative_;
+
+      typedef typename VoxelGrid<PointT>::PointCloud PointCloud;
+      typedef typename PointCloud::Ptr PointCloudPtr;
+      typedef typename PointCloud::ConstPtr PointCloudConstPtr;
+      typedef typename pcl::traits::fieldList<PointT>::type FieldList;
+
+      /** \brief An entry of the hash table: the grid coordinates of a cell, and the index of its centroid in
+        * the output cloud (-1 if the entry is empty).
+        */
+      struct Cell
+      {
+        Cell () : ix (0), iy (0), iz (0), index (-1) {}
+        int ix, iy, iz;
+        int index;
+      };
+
+    public:
+      /** \brief Empty constructor. */
+      HashVoxelGrid () : cells_ (), nr_cells_ (0)
+      {
+        filter_name_ = "HashVoxelGrid";
+      }
+
+      /** \brief Destructor. */
+      virtual ~HashVoxelGrid ()
+      {
+      }
+
+      /** \brief Get the number of occupied cells (i.e. of output points) found by the last call to filter (). */
+      inline size_t
+      getNrOccupiedCells () const { return (nr_cells_); }
+
+      /** \brief Get the current capacity of the hash table. */
+      inline size_t
+      getHashTableSize () const { return (cells_.size ()); }
+
+      /** \brief Returns the index in the resulting downsampled cloud of the specified point (or -1 if its cell
+        * is empty).
+        * \param[in] p the point to get the index at
+        */
+      inline int 
+      getCentroidIndex (const PointT &p) const
+      {
+        return (findCell (static_cast<int> (floor (p.x * inverse_leaf_size_[0])), 
+                          static_cast<int> (floor (p.y * inverse_leaf_size_[1])), 
+                          static_cast<int> (floor (p.z * inverse_leaf_size_[2]))));
+      }
+
+      /** \brief Returns the index in the downsampled cloud corresponding to a given set of coordinates (or -1
+        * if the cell is empty).
+        * \param[in] ijk the coordinates (i,j,k) in the grid
+        */
+      inline int 
+      getCentroidIndexAt (const Eigen::Vector3i &ijk) const
+      {
+        return (findCell (ijk[0], ijk[1], ijk[2]));
+      }
+
+      /** \brief Returns the indices in the resulting downsampled cloud of the points at the specified grid coordinates,
+        * relative to the grid coordinates of the specified point (or -1 if the cell was empty).
+        * \param[in] reference_point the coordinates of the reference point (corresponding cell is allowed to be empty)
+        * \param[in] relative_coordinates matrix with the columns being the coordinates of the requested cells, relative to the reference point's cell
+        */
+      inline std::vector<int> 
+      getNeighborCentroidIndices (const PointT &reference_point, const Eigen::MatrixXi &relative_coordinates) const
+      {
+        int i = static_cast<int> (floor (reference_point.x * inverse_leaf_size_[0]));
+        int j = static_cast<int> (floor (reference_point.y * inverse_leaf_size_[1]));
+        int k = static_cast<int> (floor (reference_point.z * inverse_leaf_size_[2]));
+        std::vector<int> neighbors (relative_coordinates.cols ());
+        for (int ni = 0; ni < relative_coordinates.cols (); ni++)
+          neighbors[ni] = findCell (i + relative_coordinates (0, ni), j + relative_coordinates (1, ni), k + relative_coordinates (2, ni));
+        return (neighbors);
+      }
+
+    protected:
+      /** \brief The open-addressing (linear probing) hash table, with a power of two size. */
+      std::vector<Cell> cells_;
+
+      /** \brief The number of occupied entries in \a cells_. */
+      size_t nr_cells_;
+
+      /** \brief Hash the grid coordinates of a cell into a slot of \a cells_. */
+      inline size_t
+      hashCell (int ix, int iy, int iz) const
+      {
+        uint64_t h = static_cast<uint64_t> (static_cast<uint32_t> (ix)) * 0x9E3779B97F4A7C15ULL ^
+                     static_cast<uint64_t> (static_cast<uint32_t> (iy)) * 0xC2B2AE3D27D4EB4FULL ^
+                     static_cast<uint64_t> (static_cast<uint32_t> (iz)) * 0x165667B19E3779F9ULL;
+        h ^= h >> 29;
+        return (static_cast<size_t> (h) & (cells_.size () - 1));
+      }
+
+      /** \brief Find the output index of the cell at the given grid coordinates, or -1 if it is empty. */
+      inline int
+      findCell (int ix, int iy, int iz) const
+      {
+        if (cells_.empty ())
+          return (-1);
+        for (size_t slot = hashCell (ix, iy, iz); ; slot = (slot + 1) & (cells_.size () - 1))
+        {
+          const Cell &cell = cells_[slot];
+          if (cell.index == -1)
+            return (-1);
+          if (cell.ix == ix && cell.iy == iy && cell.iz == iz)
+            return (cell.index);
+        }
+      }
+
+      /** \brief Find the cell at the given grid coordinates, inserting it with the next output index if it is
+        * not in the table yet. The table grows when it gets more than half full.
+        * \return the output index of the cell
+        */
+      int
+      insertCell (int ix, int iy, int iz);
+
+      /** \brief Resize the hash table to \a size entries (a power of two), re-inserting the occupied ones. */
+      void
+      rehash (size_t size);
+
+      /** \brief Downsample a Point Cloud using a hashed voxel grid, in a single pass
+        * \param[out] output the resultant point cloud message
+        */
+      void 
+      applyFilter (PointCloud &output);
+  };
+}
+
+#endif  //#ifndef PCL_FILTERS_HASH_VOXEL_GRID_H_
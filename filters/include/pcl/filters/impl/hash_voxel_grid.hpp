@@ -0,0 +1,273 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_HASH_VOXEL_GRID_H_
+#define PCL_FILTERS_IMPL_HASH_VOXEL_GRID_H_
+
+#include <pcl/common/io.h>
+#include <pcl/filters/hash_voxel_grid.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::HashVoxelGrid<PointT>::rehash (size_t size)
+{
+  std::vector<Cell> old_cells (size);
+  cells_.swap (old_cells);
+  for (size_t i = 0; i < old_cells.size (); ++i)
+  {
+    if (old_cells[i].index == -1)
+      continue;
+    size_t slot = hashCell (old_cells[i].ix, old_cells[i].iy, old_cells[i].iz);
+    while (cells_[slot].index != -1)
+      slot = (slot + 1) & (cells_.size () - 1);
+    cells_[slot] = old_cells[i];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::HashVoxelGrid<PointT>::insertCell (int ix, int iy, int iz)
+{
+  // Keep the load factor under 1/2, so that the probe sequences stay short
+  if (2 * (nr_cells_ + 1) > cells_.size ())
+    rehash (2 * cells_.size ());
+
+  size_t slot = hashCell (ix, iy, iz);
+  while (cells_[slot].index != -1)
+  {
+    const Cell &cell = cells_[slot];
+    if (cell.ix == ix && cell.iy == iy && cell.iz == iz)
+      return (cell.index);
+    slot = (slot + 1) & (cells_.size () - 1);
+  }
+
+  cells_[slot].ix = ix;
+  cells_[slot].iy = iy;
+  cells_[slot].iz = iz;
+  cells_[slot].index = static_cast<int> (nr_cells_++);
+  return (cells_[slot].index);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::HashVoxelGrid<PointT>::applyFilter (PointCloud &output)
+{
+  // Has the input dataset been set already?
+  if (!input_)
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] No input dataset given!\n", getClassName ().c_str ());
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+
+  // Copy the header (and thus the frame_id) + allocate enough space for points
+  output.height       = 1;                    // downsampling breaks the organized structure
+  output.is_dense     = true;                 // we filter out invalid points
+
+  int centroid_size = 4;
+  if (downsample_all_data_)
+    centroid_size = boost::mpl::size<FieldList>::value;
+
+  // ---[ RGB special case
+  std::vector<sensor_msgs::PointField> fields;
+  int rgba_index = -1;
+  rgba_index = pcl::getFieldIndex (*input_, "rgb", fields);
+  if (rgba_index == -1)
+    rgba_index = pcl::getFieldIndex (*input_, "rgba", fields);
+  if (rgba_index >= 0)
+  {
+    rgba_index = fields[rgba_index].offset;
+    centroid_size += 3;
+  }
+
+  // Get the distance field offset, if we filter points along a field first
+  int distance_offset = -1;
+  if (!filter_field_name_.empty ())
+  {
+    std::vector<sensor_msgs::PointField> distance_fields;
+    int distance_idx = pcl::getFieldIndex (*input_, filter_field_name_, distance_fields);
+    if (distance_idx == -1)
+      PCL_WARN ("[pcl::%s::applyFilter] Invalid filter field name. Index is %d.\n", getClassName ().c_str (), distance_idx);
+    else
+      distance_offset = distance_fields[distance_idx].offset;
+  }
+
+  // Empty the hash table, but keep its capacity from the previous call
+  if (cells_.empty ())
+    cells_.resize (1024);
+  else
+    std::fill (cells_.begin (), cells_.end (), Cell ());
+  nr_cells_ = 0;
+
+  // The running sums of every occupied cell, and the number of points in it
+  std::vector<float> sums;
+  std::vector<unsigned int> counts;
+  Eigen::VectorXf temporary = Eigen::VectorXf::Zero (centroid_size);
+  Eigen::Vector3i min_ijk = Eigen::Vector3i::Constant (std::numeric_limits<int>::max ());
+  Eigen::Vector3i max_ijk = Eigen::Vector3i::Constant (std::numeric_limits<int>::min ());
+
+  // Single pass: insert every point in the cell it falls into, and add it to the cell sum
+  for (size_t cp = 0; cp < input_->points.size (); ++cp)
+  {
+    if (!input_->is_dense)
+      // Check if the point is invalid
+      if (!pcl_isfinite (input_->points[cp].x) || 
+          !pcl_isfinite (input_->points[cp].y) || 
+          !pcl_isfinite (input_->points[cp].z))
+        continue;
+
+    if (!filter_field_name_.empty ())
+    {
+      // Get the distance value
+      const uint8_t* pt_data = reinterpret_cast<const uint8_t*> (&input_->points[cp]);
+      float distance_value = 0;
+      if (distance_offset >= 0)
+        memcpy (&distance_value, pt_data + distance_offset, sizeof (float));
+
+      if (filter_limit_negative_)
+      {
+        // Use a threshold for cutting out points which inside the interval
+        if ((distance_value < filter_limit_max_) && (distance_value > filter_limit_min_))
+          continue;
+      }
+      else
+      {
+        // Use a threshold for cutting out points which are too close/far away
+        if ((distance_value > filter_limit_max_) || (distance_value < filter_limit_min_))
+          continue;
+      }
+    }
+
+    Eigen::Vector3i ijk (static_cast<int> (floor (input_->points[cp].x * inverse_leaf_size_[0])), 
+                         static_cast<int> (floor (input_->points[cp].y * inverse_leaf_size_[1])), 
+                         static_cast<int> (floor (input_->points[cp].z * inverse_leaf_size_[2])));
+    min_ijk = min_ijk.cwiseMin (ijk);
+    max_ijk = max_ijk.cwiseMax (ijk);
+
+    const size_t index = static_cast<size_t> (insertCell (ijk[0], ijk[1], ijk[2]));
+    bool first = false;
+    if (index == counts.size ())
+    {
+      counts.push_back (0);
+      sums.resize (sums.size () + centroid_size);
+      first = true;
+    }
+    ++counts[index];
+    Eigen::Map<Eigen::VectorXf> centroid (&sums[index * centroid_size], centroid_size);
+
+    // The first point of a cell is copied rather than added, exactly like VoxelGrid does
+    if (!downsample_all_data_) 
+    {
+      if (first)
+      {
+        centroid[0] = input_->points[cp].x;
+        centroid[1] = input_->points[cp].y;
+        centroid[2] = input_->points[cp].z;
+      }
+      else
+      {
+        centroid[0] += input_->points[cp].x;
+        centroid[1] += input_->points[cp].y;
+        centroid[2] += input_->points[cp].z;
+      }
+    }
+    else 
+    {
+      // ---[ RGB special case
+      if (rgba_index >= 0)
+      {
+        // Fill r/g/b data, assuming that the order is BGRA
+        pcl::RGB rgb;
+        memcpy (&rgb, reinterpret_cast<const char*> (&input_->points[cp]) + rgba_index, sizeof (RGB));
+        temporary[centroid_size-3] = rgb.r;
+        temporary[centroid_size-2] = rgb.g;
+        temporary[centroid_size-1] = rgb.b;
+      }
+      pcl::for_each_type <FieldList> (NdCopyPointEigenFunctor <PointT> (input_->points[cp], temporary));
+      if (first)
+        centroid = temporary;
+      else
+        centroid += temporary;
+    }
+  }
+
+  // Keep the grid bounds up to date, for getMinBoxCoordinates () & co.
+  if (nr_cells_ > 0)
+  {
+    min_b_ = Eigen::Vector4i (min_ijk[0], min_ijk[1], min_ijk[2], 0);
+    max_b_ = Eigen::Vector4i (max_ijk[0], max_ijk[1], max_ijk[2], 0);
+    div_b_ = max_b_ - min_b_ + Eigen::Vector4i::Ones ();
+    div_b_[3] = 0;
+    divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  }
+
+  // Divide the sums and store the centroids, in the order their cells were first seen
+  output.points.resize (nr_cells_);
+  Eigen::VectorXf centroid (centroid_size);
+  for (size_t index = 0; index < nr_cells_; ++index)
+  {
+    centroid = Eigen::Map<const Eigen::VectorXf> (&sums[index * centroid_size], centroid_size);
+    centroid /= static_cast<float> (counts[index]);
+
+    // store centroid
+    // Do we need to process all the fields?
+    if (!downsample_all_data_) 
+    {
+      output.points[index].x = centroid[0];
+      output.points[index].y = centroid[1];
+      output.points[index].z = centroid[2];
+    }
+    else 
+    {
+      pcl::for_each_type<FieldList> (pcl::NdCopyEigenPointFunctor <PointT> (centroid, output.points[index]));
+      // ---[ RGB special case
+      if (rgba_index >= 0) 
+      {
+        // pack r/g/b into rgb
+        float r = centroid[centroid_size-3], g = centroid[centroid_size-2], b = centroid[centroid_size-1];
+        int rgb = (static_cast<int> (r) << 16) | (static_cast<int> (g) << 8) | static_cast<int> (b);
+        memcpy (reinterpret_cast<char*> (&output.points[index]) + rgba_index, &rgb, sizeof (float));
+      }
+    }
+  }
+  output.width = static_cast<uint32_t> (output.points.size ());
+}
+
+#define PCL_INSTANTIATE_HashVoxelGrid(T) template class PCL_EXPORTS pcl::HashVoxelGrid<T>;
+
+#endif    // PCL_FILTERS_IMPL_HASH_VOXEL_GRID_H_
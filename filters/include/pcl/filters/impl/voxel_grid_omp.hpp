@@ -0,0 +1,426 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_VOXEL_GRID_OMP_H_
+#define PCL_FILTERS_IMPL_VOXEL_GRID_OMP_H_
+
+#include <pcl/common/common.h>
+#include <pcl/common/io.h>
+#include <pcl/filters/voxel_grid_omp.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+struct cloud_point_index_key
+{
+  uint64_t idx;
+  unsigned int cloud_point_index;
+
+  cloud_point_index_key () : idx (0), cloud_point_index (0) {}
+  cloud_point_index_key (uint64_t idx_, unsigned int cloud_point_index_) : idx (idx_), cloud_point_index (cloud_point_index_) {}
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::VoxelGridOMP<PointT>::getNumberOfBlocks () const
+{
+  if (threads_ != 0)
+    return (static_cast<int> (threads_));
+#ifdef _OPENMP
+  return (omp_get_max_threads ());
+#else
+  return (1);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelGridOMP<PointT>::applyFilter (PointCloud &output)
+{
+  // Has the input dataset been set already?
+  if (!input_)
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] No input dataset given!\n", getClassName ().c_str ());
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+
+  // Copy the header (and thus the frame_id) + allocate enough space for points
+  output.height       = 1;                    // downsampling breaks the organized structure
+  output.is_dense     = true;                 // we filter out invalid points
+
+  Eigen::Vector4f min_p, max_p;
+  // Get the minimum and maximum dimensions
+  if (!filter_field_name_.empty ()) // If we don't want to process the entire cloud...
+    getMinMax3D<PointT>(input_, filter_field_name_, static_cast<float> (filter_limit_min_), static_cast<float> (filter_limit_max_), min_p, max_p, filter_limit_negative_);
+  else
+    getMinMax3D<PointT>(*input_, min_p, max_p);
+
+  // Compute the minimum and maximum bounding box values
+  min_b_[0] = static_cast<int> (floor (min_p[0] * inverse_leaf_size_[0]));
+  max_b_[0] = static_cast<int> (floor (max_p[0] * inverse_leaf_size_[0]));
+  min_b_[1] = static_cast<int> (floor (min_p[1] * inverse_leaf_size_[1]));
+  max_b_[1] = static_cast<int> (floor (max_p[1] * inverse_leaf_size_[1]));
+  min_b_[2] = static_cast<int> (floor (min_p[2] * inverse_leaf_size_[2]));
+  max_b_[2] = static_cast<int> (floor (max_p[2] * inverse_leaf_size_[2]));
+
+  // Compute the number of divisions needed along all axis
+  div_b_ = max_b_ - min_b_ + Eigen::Vector4i::Ones ();
+  div_b_[3] = 0;
+
+  // Set up the division multiplier
+  divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+
+  // The same multipliers, in 64 bits, so that the cell keys do not overflow on large grids
+  const uint64_t mul_y = static_cast<uint64_t> (div_b_[0]);
+  const uint64_t mul_z = mul_y * static_cast<uint64_t> (div_b_[1]);
+  const uint64_t nr_cells = mul_z * static_cast<uint64_t> (div_b_[2]);
+  const uint64_t invalid_key = std::numeric_limits<uint64_t>::max ();
+
+  int centroid_size = 4;
+  if (downsample_all_data_)
+    centroid_size = boost::mpl::size<FieldList>::value;
+
+  // ---[ RGB special case
+  std::vector<sensor_msgs::PointField> fields;
+  int rgba_index = -1;
+  rgba_index = pcl::getFieldIndex (*input_, "rgb", fields);
+  if (rgba_index == -1)
+    rgba_index = pcl::getFieldIndex (*input_, "rgba", fields);
+  if (rgba_index >= 0)
+  {
+    rgba_index = fields[rgba_index].offset;
+    centroid_size += 3;
+  }
+
+  // Get the distance field offset, if we filter points along a field first
+  int distance_offset = -1;
+  if (!filter_field_name_.empty ())
+  {
+    std::vector<sensor_msgs::PointField> distance_fields;
+    int distance_idx = pcl::getFieldIndex (*input_, filter_field_name_, distance_fields);
+    if (distance_idx == -1)
+      PCL_WARN ("[pcl::%s::applyFilter] Invalid filter field name. Index is %d.\n", getClassName ().c_str (), distance_idx);
+    else
+      distance_offset = distance_fields[distance_idx].offset;
+  }
+
+  const int nr_blocks = getNumberOfBlocks ();
+  const size_t nr_points = input_->points.size ();
+
+  // First pass: compute the cell key of every point, in parallel. Each block counts its valid points, so
+  // that the keys can be compacted afterwards without changing their relative order
+  std::vector<uint64_t> keys (nr_points);
+  std::vector<size_t> block_offsets (nr_blocks + 1, 0);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_blocks)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    const size_t begin = nr_points * block / nr_blocks, end = nr_points * (block + 1) / nr_blocks;
+    size_t nr_valid = 0;
+    for (size_t cp = begin; cp < end; ++cp)
+    {
+      keys[cp] = invalid_key;
+      if (!input_->is_dense)
+        // Check if the point is invalid
+        if (!pcl_isfinite (input_->points[cp].x) || 
+            !pcl_isfinite (input_->points[cp].y) || 
+            !pcl_isfinite (input_->points[cp].z))
+          continue;
+
+      if (!filter_field_name_.empty ())
+      {
+        // Get the distance value
+        const uint8_t* pt_data = reinterpret_cast<const uint8_t*> (&input_->points[cp]);
+        float distance_value = 0;
+        if (distance_offset >= 0)
+          memcpy (&distance_value, pt_data + distance_offset, sizeof (float));
+
+        if (filter_limit_negative_)
+        {
+          // Use a threshold for cutting out points which inside the interval
+          if ((distance_value < filter_limit_max_) && (distance_value > filter_limit_min_))
+            continue;
+        }
+        else
+        {
+          // Use a threshold for cutting out points which are too close/far away
+          if ((distance_value > filter_limit_max_) || (distance_value < filter_limit_min_))
+            continue;
+        }
+      }
+
+      int ijk0 = static_cast<int> (floor (input_->points[cp].x * inverse_leaf_size_[0]) - min_b_[0]);
+      int ijk1 = static_cast<int> (floor (input_->points[cp].y * inverse_leaf_size_[1]) - min_b_[1]);
+      int ijk2 = static_cast<int> (floor (input_->points[cp].z * inverse_leaf_size_[2]) - min_b_[2]);
+
+      // Compute the centroid leaf index
+      keys[cp] = static_cast<uint64_t> (ijk0) + static_cast<uint64_t> (ijk1) * mul_y + static_cast<uint64_t> (ijk2) * mul_z;
+      ++nr_valid;
+    }
+    block_offsets[block + 1] = nr_valid;
+  }
+  for (int block = 0; block < nr_blocks; ++block)
+    block_offsets[block + 1] += block_offsets[block];
+
+  std::vector<cloud_point_index_key> index_vector (block_offsets[nr_blocks]);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_blocks)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    const size_t begin = nr_points * block / nr_blocks, end = nr_points * (block + 1) / nr_blocks;
+    size_t pos = block_offsets[block];
+    for (size_t cp = begin; cp < end; ++cp)
+      if (keys[cp] != invalid_key)
+        index_vector[pos++] = cloud_point_index_key (keys[cp], static_cast<unsigned int> (cp));
+  }
+  std::vector<uint64_t> ().swap (keys);
+
+  // Second pass: stable LSD radix sort of the index_vector vector on the cell keys, one byte at a time. Only
+  // the bytes needed to represent the largest key are sorted. Stability keeps the points of every cell in
+  // their input order, which is what makes the centroids identical to the ones computed by VoxelGrid
+  const size_t nr_entries = index_vector.size ();
+  int nr_key_bits = 0;
+  while (nr_key_bits < 64 && (nr_cells - 1) >> nr_key_bits)
+    ++nr_key_bits;
+
+  std::vector<cloud_point_index_key> sorted (nr_entries);
+  std::vector<size_t> histograms (nr_blocks * 256);
+  for (int shift = 0; shift < nr_key_bits; shift += 8)
+  {
+    std::fill (histograms.begin (), histograms.end (), 0);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_blocks)
+#endif
+    for (int block = 0; block < nr_blocks; ++block)
+    {
+      const size_t begin = nr_entries * block / nr_blocks, end = nr_entries * (block + 1) / nr_blocks;
+      size_t *histogram = &histograms[block * 256];
+      for (size_t i = begin; i < end; ++i)
+        ++histogram[(index_vector[i].idx >> shift) & 0xff];
+    }
+
+    // Exclusive prefix sum, digit-major and block-minor, gives every block its scatter positions
+    size_t sum = 0;
+    bool single_digit = false;
+    for (int d = 0; d < 256; ++d)
+    {
+      size_t digit_count = 0;
+      for (int block = 0; block < nr_blocks; ++block)
+      {
+        size_t count = histograms[block * 256 + d];
+        histograms[block * 256 + d] = sum;
+        sum += count;
+        digit_count += count;
+      }
+      if (digit_count == nr_entries)
+        single_digit = true;
+    }
+    // All the keys share this byte, nothing to reorder
+    if (single_digit)
+      continue;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_blocks)
+#endif
+    for (int block = 0; block < nr_blocks; ++block)
+    {
+      const size_t begin = nr_entries * block / nr_blocks, end = nr_entries * (block + 1) / nr_blocks;
+      size_t *offsets = &histograms[block * 256];
+      for (size_t i = begin; i < end; ++i)
+        sorted[offsets[(index_vector[i].idx >> shift) & 0xff]++] = index_vector[i];
+    }
+    index_vector.swap (sorted);
+  }
+  std::vector<cloud_point_index_key> ().swap (sorted);
+
+  // Third pass: find the first entry of every output cell, in parallel
+  std::fill (block_offsets.begin (), block_offsets.end (), 0);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_blocks)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    const size_t begin = nr_entries * block / nr_blocks, end = nr_entries * (block + 1) / nr_blocks;
+    size_t nr_starts = 0;
+    for (size_t i = begin; i < end; ++i)
+      if (i == 0 || index_vector[i].idx != index_vector[i - 1].idx)
+        ++nr_starts;
+    block_offsets[block + 1] = nr_starts;
+  }
+  for (int block = 0; block < nr_blocks; ++block)
+    block_offsets[block + 1] += block_offsets[block];
+
+  const size_t total = block_offsets[nr_blocks];
+  std::vector<size_t> cell_starts (total + 1, nr_entries);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_blocks)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    const size_t begin = nr_entries * block / nr_blocks, end = nr_entries * (block + 1) / nr_blocks;
+    size_t pos = block_offsets[block];
+    for (size_t i = begin; i < end; ++i)
+      if (i == 0 || index_vector[i].idx != index_vector[i - 1].idx)
+        cell_starts[pos++] = i;
+  }
+
+  // Fourth pass: compute centroids, insert them into their final position
+  output.points.resize (total);
+  if (save_leaf_layout_)
+  {
+    if (nr_cells > static_cast<uint64_t> (std::numeric_limits<int>::max ()))
+      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout", 
+        "voxel_grid_omp.hpp", "applyFilter");
+    try
+    { 
+      // Resizing won't reset old elements to -1.  If leaf_layout_ has been used previously, it needs to be re-initialized to -1
+      size_t new_layout_size = static_cast<size_t> (nr_cells);
+      size_t reinit_size = std::min (new_layout_size, leaf_layout_.size ());
+      std::fill (leaf_layout_.begin (), leaf_layout_.begin () + reinit_size, -1);
+      leaf_layout_.resize (new_layout_size, -1);
+    }
+    catch (std::bad_alloc&)
+    {
+      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout", 
+        "voxel_grid_omp.hpp", "applyFilter");
+    }
+    catch (std::length_error&)
+    {
+      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout", 
+        "voxel_grid_omp.hpp", "applyFilter");
+    }
+  }
+
+  // Every block reduces a contiguous range of cells, with its own scratch centroids
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_blocks)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    const size_t begin = total * block / nr_blocks, end = total * (block + 1) / nr_blocks;
+    Eigen::VectorXf centroid = Eigen::VectorXf::Zero (centroid_size);
+    Eigen::VectorXf temporary = Eigen::VectorXf::Zero (centroid_size);
+
+    for (size_t index = begin; index < end; ++index)
+    {
+      const size_t cp = cell_starts[index], last = cell_starts[index + 1];
+
+      // calculate centroid - sum values from all input points, that have the same idx value in index_vector array
+      if (!downsample_all_data_) 
+      {
+        centroid[0] = input_->points[index_vector[cp].cloud_point_index].x;
+        centroid[1] = input_->points[index_vector[cp].cloud_point_index].y;
+        centroid[2] = input_->points[index_vector[cp].cloud_point_index].z;
+      }
+      else 
+      {
+        // ---[ RGB special case
+        if (rgba_index >= 0)
+        {
+          // Fill r/g/b data, assuming that the order is BGRA
+          pcl::RGB rgb;
+          memcpy (&rgb, reinterpret_cast<const char*> (&input_->points[index_vector[cp].cloud_point_index]) + rgba_index, sizeof (RGB));
+          centroid[centroid_size-3] = rgb.r;
+          centroid[centroid_size-2] = rgb.g;
+          centroid[centroid_size-1] = rgb.b;
+        }
+        pcl::for_each_type <FieldList> (NdCopyPointEigenFunctor <PointT> (input_->points[index_vector[cp].cloud_point_index], centroid));
+      }
+
+      for (size_t i = cp + 1; i < last; ++i)
+      {
+        if (!downsample_all_data_) 
+        {
+          centroid[0] += input_->points[index_vector[i].cloud_point_index].x;
+          centroid[1] += input_->points[index_vector[i].cloud_point_index].y;
+          centroid[2] += input_->points[index_vector[i].cloud_point_index].z;
+        }
+        else 
+        {
+          // ---[ RGB special case
+          if (rgba_index >= 0)
+          {
+            // Fill r/g/b data, assuming that the order is BGRA
+            pcl::RGB rgb;
+            memcpy (&rgb, reinterpret_cast<const char*> (&input_->points[index_vector[i].cloud_point_index]) + rgba_index, sizeof (RGB));
+            temporary[centroid_size-3] = rgb.r;
+            temporary[centroid_size-2] = rgb.g;
+            temporary[centroid_size-1] = rgb.b;
+          }
+          pcl::for_each_type <FieldList> (NdCopyPointEigenFunctor <PointT> (input_->points[index_vector[i].cloud_point_index], temporary));
+          centroid += temporary;
+        }
+      }
+
+      // index is centroid final position in resulting PointCloud
+      if (save_leaf_layout_)
+        leaf_layout_[static_cast<size_t> (index_vector[cp].idx)] = static_cast<int> (index);
+
+      centroid /= static_cast<float> (last - cp);
+
+      // store centroid
+      // Do we need to process all the fields?
+      if (!downsample_all_data_) 
+      {
+        output.points[index].x = centroid[0];
+        output.points[index].y = centroid[1];
+        output.points[index].z = centroid[2];
+      }
+      else 
+      {
+        pcl::for_each_type<FieldList> (pcl::NdCopyEigenPointFunctor <PointT> (centroid, output.points[index]));
+        // ---[ RGB special case
+        if (rgba_index >= 0) 
+        {
+          // pack r/g/b into rgb
+          float r = centroid[centroid_size-3], g = centroid[centroid_size-2], b = centroid[centroid_size-1];
+          int rgb = (static_cast<int> (r) << 16) | (static_cast<int> (g) << 8) | static_cast<int> (b);
+          memcpy (reinterpret_cast<char*> (&output.points[index]) + rgba_index, &rgb, sizeof (float));
+        }
+      }
+    }
+  }
+  output.width = static_cast<uint32_t> (output.points.size ());
+}
+
+#define PCL_INSTANTIATE_VoxelGridOMP(T) template class PCL_EXPORTS pcl::VoxelGridOMP<T>;
+
+#endif    // PCL_FILTERS_IMPL_VOXEL_GRID_OMP_H_
@@ -0,0 +1,122 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FILTERS_VOXEL_GRID_OMP_H_
+#define PCL_FILTERS_VOXEL_GRID_OMP_H_
+
+#include <pcl/filters/voxel_grid.h>
+
+namespace pcl
+{
+  /** \brief VoxelGridOMP assembles a local 3D grid over a given PointCloud, and downsamples + filters the data,
+    * in parallel, using the OpenMP standard.
+    *
+    * The grid cell keys are computed in parallel as 64-bit integers (so grids with more than 2^32 cells are
+    * supported), sorted with a parallel, stable LSD radix sort, and the centroids of the occupied cells are
+    * reduced in parallel. The output is identical to the one produced by \ref VoxelGrid, point for point.
+    *
+    * \note The leaf layout (see \a setSaveLeafLayout) is still a dense array over the bounding box, and cannot
+    * be saved for grids with more than INT_MAX cells.
+    * \ingroup filters
+    */
+  template <typename PointT>
+  class VoxelGridOMP: public VoxelGrid<PointT>
+  {
+    protected:
+      using VoxelGrid<PointT>::filter_name_;
+      using VoxelGrid<PointT>::getClassName;
+      using VoxelGrid<PointT>::input_;
+      using VoxelGrid<PointT>::indices_;
+      using VoxelGrid<PointT>::inverse_leaf_size_;
+      using VoxelGrid<PointT>::downsample_all_data_;
+      using VoxelGrid<PointT>::save_leaf_layout_;
+      using VoxelGrid<PointT>::leaf_layout_;
+      using VoxelGrid<PointT>::min_b_;
+      using VoxelGrid<PointT>::max_b_;
+      using VoxelGrid<PointT>::div_b_;
+      using VoxelGrid<PointT>::divb_mul_;
+      using VoxelGrid<PointT>::filter_field_name_;
+      using VoxelGrid<PointT>::filter_limit_min_;
+      using VoxelGrid<PointT>::filter_limit_max_;
+      using VoxelGrid<PointT>::filter_limit_negative_;
+
+      typedef typename VoxelGrid<PointT>::PointCloud PointCloud;
+      typedef typename PointCloud::Ptr PointCloudPtr;
+      typedef typename PointCloud::ConstPtr PointCloudConstPtr;
+      typedef typename pcl::traits::fieldList<PointT>::type FieldList;
+
+    public:
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      VoxelGridOMP (unsigned int nr_threads = 0) : threads_ (nr_threads)
+      {
+        filter_name_ = "VoxelGridOMP";
+      }
+
+      /** \brief Destructor. */
+      virtual ~VoxelGridOMP ()
+      {
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void 
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads the scheduler uses (0 means automatic). */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
+    protected:
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Get the number of blocks the work is split into: one per thread. */
+      int
+      getNumberOfBlocks () const;
+
+      /** \brief Downsample a Point Cloud using a voxelized grid approach, in parallel
+        * \param[out] output the resultant point cloud message
+        */
+      void 
+      applyFilter (PointCloud &output);
+  };
+}
+
+#endif  //#ifndef PCL_FILTERS_VOXEL_GRID_OMP_H_
@@ -0,0 +1,324 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_COMPRESSION_OCTREE_OCCUPANCY_CODER_IMPL_H_
+#define PCL_COMPRESSION_OCTREE_OCCUPANCY_CODER_IMPL_H_
+
+#include <pcl/compression/octree_occupancy_coder.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned long
+pcl::OctreeOccupancyCoder::encodeTreeToStream (const std::vector<char>& binaryTree_arg,
+                                               const std::vector<char>& prevOccupancy_arg,
+                                               unsigned int treeDepth_arg, bool doXOREncoding_arg,
+                                               std::vector<char>& occupancy_arg,
+                                               std::ostream& outputByteStream_arg)
+{
+  initialize (prevOccupancy_arg, treeDepth_arg, doXOREncoding_arg, occupancy_arg);
+
+  treeData_ = &binaryTree_arg;
+  treeDataPos_ = 0;
+
+  low_ = 0;
+  range_ = 0xFFFFFFFF;
+  cache_ = 0;
+  cacheSize_ = 1;
+  outputCharVector_.clear ();
+  outputCharVector_.reserve (binaryTree_arg.size () / 2);
+
+  // serialized tree is traversed in depth-first order, starting at the root node
+  if (!binaryTree_arg.empty ())
+    encodeNodeRecursive (0, doXOREncoding_ && !prevOccupancy_arg.empty (), 0, 0);
+
+  // flush coder interval
+  for (int i = 0; i < 5; i++)
+    shiftLow ();
+
+  // write amount of branch nodes, size of compressed data and compressed data to output stream
+  QWord nodeCount = occupancy_arg.size ();
+  QWord compressedSize = outputCharVector_.size ();
+  outputByteStream_arg.write (reinterpret_cast<const char*> (&nodeCount), sizeof (nodeCount));
+  outputByteStream_arg.write (reinterpret_cast<const char*> (&compressedSize), sizeof (compressedSize));
+  if (compressedSize)
+    outputByteStream_arg.write (&outputCharVector_[0], outputCharVector_.size ());
+
+  treeData_ = 0;
+  prevOccupancy_ = 0;
+  occupancy_ = 0;
+
+  // return amount of written bytes
+  return (static_cast<unsigned long> (sizeof (nodeCount) + sizeof (compressedSize) + compressedSize));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned long
+pcl::OctreeOccupancyCoder::decodeStreamToTree (std::istream& inputByteStream_arg,
+                                               const std::vector<char>& prevOccupancy_arg,
+                                               unsigned int treeDepth_arg, bool doXOREncoding_arg,
+                                               std::vector<char>& binaryTree_arg,
+                                               std::vector<char>& occupancy_arg)
+{
+  QWord nodeCount;
+  QWord compressedSize;
+
+  // read amount of branch nodes, size of compressed data and compressed data from input stream
+  inputByteStream_arg.read (reinterpret_cast<char*> (&nodeCount), sizeof (nodeCount));
+  inputByteStream_arg.read (reinterpret_cast<char*> (&compressedSize), sizeof (compressedSize));
+
+  inputCharVector_.resize (static_cast<std::size_t> (compressedSize));
+  if (compressedSize)
+    inputByteStream_arg.read (&inputCharVector_[0], compressedSize);
+  inputCharPos_ = 0;
+
+  initialize (prevOccupancy_arg, treeDepth_arg, doXOREncoding_arg, occupancy_arg);
+  nodeCount_ = static_cast<std::size_t> (nodeCount);
+
+  binaryTree_arg.clear ();
+  binaryTree_arg.reserve (nodeCount_);
+  occupancy_arg.reserve (nodeCount_);
+
+  range_ = 0xFFFFFFFF;
+  code_ = 0;
+  for (int i = 0; i < 5; i++)
+    code_ = (code_ << 8) | readByte ();
+
+  if (nodeCount_)
+    decodeNodeRecursive (0, doXOREncoding_ && !prevOccupancy_arg.empty (), 0, 0, binaryTree_arg);
+
+  prevOccupancy_ = 0;
+  occupancy_ = 0;
+
+  // return amount of read bytes
+  return (static_cast<unsigned long> (sizeof (nodeCount) + sizeof (compressedSize) + compressedSize));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::OctreeOccupancyCoder::initialize (const std::vector<char>& prevOccupancy_arg, unsigned int treeDepth_arg,
+                                       bool doXOREncoding_arg, std::vector<char>& occupancy_arg)
+{
+  // all bits start with a probability of one half
+  probabilities_.assign (contextCount_ * 256, static_cast<boost::uint16_t> (1 << (probabilityBits_ - 1)));
+  observations_.assign (contextCount_ * 256, 0);
+
+  if (siblingContexts_.empty ())
+  {
+    siblingContexts_.resize (256 * 8 * 8);
+    for (unsigned int parent = 0; parent < 256; parent++)
+      for (unsigned char childIdx = 0; childIdx < 8; childIdx++)
+        for (unsigned char i = 0; i < 8; i++)
+        {
+          // child i touches the sibling of its node along every axis where the child and the node sit on different
+          // sides, the state counts these siblings and how many of them are occupied
+          unsigned char adjacent = static_cast<unsigned char> (i ^ childIdx);
+          unsigned int possible = 0;
+          unsigned int occupied = 0;
+          for (unsigned char axis = 1; axis < 8; axis <<= 1)
+          {
+            if (adjacent & axis)
+            {
+              possible++;
+              occupied += (parent >> (childIdx ^ axis)) & 1;
+            }
+          }
+          siblingContexts_[(parent * 8 + childIdx) * 8 + i] =
+              static_cast<unsigned char> (possible * (possible + 1) / 2 + occupied);
+        }
+  }
+
+  treeDepth_ = treeDepth_arg;
+  doXOREncoding_ = doXOREncoding_arg;
+
+  prevOccupancy_ = &prevOccupancy_arg;
+  prevOccupancyPos_ = 0;
+
+  occupancy_ = &occupancy_arg;
+  occupancy_->clear ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::OctreeOccupancyCoder::encodeNodeRecursive (unsigned int depth_arg, bool hasPrev_arg, unsigned char parent_arg,
+                                                unsigned char childIdx_arg)
+{
+  unsigned char prev = 0;
+  if (hasPrev_arg && prevOccupancyPos_ < prevOccupancy_->size ())
+    prev = static_cast<unsigned char> ((*prevOccupancy_)[prevOccupancyPos_++]);
+  else
+    hasPrev_arg = false;
+
+  // recover occupancy from XOR bit pattern
+  unsigned char data = static_cast<unsigned char> ((*treeData_)[treeDataPos_++]);
+  unsigned char node = doXOREncoding_ ? static_cast<unsigned char> (data ^ prev) : data;
+  occupancy_->push_back (static_cast<char> (node));
+
+  unsigned int contexts[8];
+  getContexts (depth_arg, parent_arg, childIdx_arg, contexts);
+
+  // encode bits of the occupancy byte, the already coded bits select the probability within the context
+  unsigned int partial = 1;
+  bool match = true;
+  for (unsigned char i = 0; i < 8; i++)
+  {
+    unsigned int bit = (node >> i) & 1;
+    unsigned int prevBit = (prev >> i) & 1;
+    encodeBit (getProbabilityIdx (contexts[i], hasPrev_arg, prevBit, match, partial), bit);
+    partial = (partial << 1) | bit;
+    match = match && (bit == prevBit);
+  }
+
+  if (depth_arg + 1 >= treeDepth_)
+    return;
+
+  // proceed with child branch nodes in serialization order
+  for (unsigned char i = 0; i < 8; i++)
+  {
+    bool inCurrent = ((node >> i) & 1) != 0;
+    bool inPrev = hasPrev_arg && ((prev >> i) & 1);
+
+    if (inCurrent)
+    {
+      if (treeDataPos_ >= treeData_->size ())
+        return;
+      encodeNodeRecursive (depth_arg + 1, inPrev, node, i);
+    }
+    else if (inPrev)
+      skipPrevNodeRecursive (depth_arg + 1);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::OctreeOccupancyCoder::decodeNodeRecursive (unsigned int depth_arg, bool hasPrev_arg, unsigned char parent_arg,
+                                                unsigned char childIdx_arg, std::vector<char>& binaryTree_arg)
+{
+  unsigned char prev = 0;
+  if (hasPrev_arg && prevOccupancyPos_ < prevOccupancy_->size ())
+    prev = static_cast<unsigned char> ((*prevOccupancy_)[prevOccupancyPos_++]);
+  else
+    hasPrev_arg = false;
+
+  unsigned int contexts[8];
+  getContexts (depth_arg, parent_arg, childIdx_arg, contexts);
+
+  // decode bits of the occupancy byte
+  unsigned int partial = 1;
+  bool match = true;
+  unsigned char node = 0;
+  for (unsigned char i = 0; i < 8; i++)
+  {
+    unsigned int prevBit = (prev >> i) & 1;
+    unsigned int bit = decodeBit (getProbabilityIdx (contexts[i], hasPrev_arg, prevBit, match, partial));
+    node = static_cast<unsigned char> (node | (bit << i));
+    partial = (partial << 1) | bit;
+    match = match && (bit == prevBit);
+  }
+
+  occupancy_->push_back (static_cast<char> (node));
+  binaryTree_arg.push_back (static_cast<char> (doXOREncoding_ ? node ^ prev : node));
+
+  if (depth_arg + 1 >= treeDepth_)
+    return;
+
+  // proceed with child branch nodes in serialization order
+  for (unsigned char i = 0; i < 8; i++)
+  {
+    bool inCurrent = ((node >> i) & 1) != 0;
+    bool inPrev = hasPrev_arg && ((prev >> i) & 1);
+
+    if (inCurrent)
+    {
+      // stop at corrupted input data
+      if (occupancy_->size () >= nodeCount_)
+        return;
+      decodeNodeRecursive (depth_arg + 1, inPrev, node, i, binaryTree_arg);
+    }
+    else if (inPrev)
+      skipPrevNodeRecursive (depth_arg + 1);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::OctreeOccupancyCoder::skipPrevNodeRecursive (unsigned int depth_arg)
+{
+  if (prevOccupancyPos_ >= prevOccupancy_->size ())
+    return;
+
+  unsigned char prev = static_cast<unsigned char> ((*prevOccupancy_)[prevOccupancyPos_++]);
+
+  if (depth_arg + 1 >= treeDepth_)
+    return;
+
+  for (unsigned char i = 0; i < 8; i++)
+    if ((prev >> i) & 1)
+      skipPrevNodeRecursive (depth_arg + 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::OctreeOccupancyCoder::getContexts (unsigned int depth_arg, unsigned char parent_arg, unsigned char childIdx_arg,
+                                        unsigned int contexts_arg[8]) const
+{
+  // nodes whose children are leaf nodes are modelled separately
+  const unsigned int leafLevel = (depth_arg + 1 >= treeDepth_) ? 10 : 0;
+
+  const unsigned char* siblings = &siblingContexts_[(parent_arg * 8 + childIdx_arg) * 8];
+  for (unsigned char i = 0; i < 8; i++)
+    contexts_arg[i] = leafLevel + siblings[i];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::OctreeOccupancyCoder::shiftLow ()
+{
+  if (static_cast<DWord> (low_) < 0xFF000000u || (low_ >> 32) != 0)
+  {
+    unsigned char carry = static_cast<unsigned char> (low_ >> 32);
+    unsigned char pending = cache_;
+    do
+    {
+      outputCharVector_.push_back (static_cast<char> (pending + carry));
+      pending = 0xFF;
+    } while (--cacheSize_ != 0);
+    cache_ = static_cast<unsigned char> (low_ >> 24);
+  }
+  cacheSize_++;
+  low_ = (low_ & 0x00FFFFFF) << 8;
+}
+
+#endif  // PCL_COMPRESSION_OCTREE_OCCUPANCY_CODER_IMPL_H_
@@ -46,8 +46,13 @@
 #include <vector>
 #include <string.h>
 #include <iostream>
+#include <sstream>
 #include <stdio.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace pcl::octree;
 
 namespace pcl
@@ -121,6 +126,13 @@ namespace pcl
         pointCoder_.initializeEncoding ();
         pointCoder_.setPointCount (static_cast<unsigned int> (cloud_arg->points.size ()));
 
+        // reset subtree offsets of the data vectors
+        treeDataOffsets_.clear ();
+        pointAvgColorOffsets_.clear ();
+        pointCountOffsets_.clear ();
+        pointDiffOffsets_.clear ();
+        pointDiffColorOffsets_.clear ();
+
         // serialize octree
         if (iFrame_)
           // i-frame encoding - encode tree structure without referencing previous buffer
@@ -251,58 +263,65 @@ namespace pcl
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::entropyEncoding (std::ostream& compressedTreeDataOut_arg)
     {
-      uint64_t binaryTreeDataVector_size;
-      uint64_t pointAvgColorDataVector_size;
+      std::vector<DataSegment> segments;
+      std::vector<std::size_t> segmentCounts;
+      std::size_t segmentIdx = 0;
 
       compressedPointDataLen_ = 0;
       compressedColorDataLen_ = 0;
 
-      // encode binary octree structure
-      binaryTreeDataVector_size = binaryTreeDataVector_.size ();
-      compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&binaryTreeDataVector_size), sizeof (binaryTreeDataVector_size));
-      compressedPointDataLen_ += entropyCoder_.encodeCharVectorToStream (binaryTreeDataVector_,
-                                                                         compressedTreeDataOut_arg);
+      // split all data vectors into segments, in the order they are written to the stream
+      if (!doContextAdaptiveTreeCoding_)
+        segmentCounts.push_back (addDataSegments (&binaryTreeDataVector_, 0, treeDataOffsets_, segments));
 
       if (cloudWithColor_)
+        segmentCounts.push_back (addDataSegments (&colorCoder_.getAverageDataVector (), 0, pointAvgColorOffsets_,
+                                                  segments));
+
+      if (!doVoxelGridEnDecoding_)
       {
-        // encode averaged voxel color information
-        std::vector<char>& pointAvgColorDataVector = colorCoder_.getAverageDataVector ();
-        pointAvgColorDataVector_size = pointAvgColorDataVector.size ();
-        compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&pointAvgColorDataVector_size),
-                                         sizeof (pointAvgColorDataVector_size));
-        compressedColorDataLen_ += entropyCoder_.encodeCharVectorToStream (pointAvgColorDataVector,
-                                                                           compressedTreeDataOut_arg);
+        segmentCounts.push_back (addDataSegments (0, &pointCountDataVector_, pointCountOffsets_, segments));
+        segmentCounts.push_back (addDataSegments (&pointCoder_.getDifferentialDataVector (), 0, pointDiffOffsets_,
+                                                  segments));
+
+        if (cloudWithColor_)
+          segmentCounts.push_back (addDataSegments (&colorCoder_.getDifferentialDataVector (), 0,
+                                                    pointDiffColorOffsets_, segments));
       }
 
-      if (!doVoxelGridEnDecoding_)
+      std::vector<std::size_t>::const_iterator segmentCount = segmentCounts.begin ();
+
+      // entropy encode all segments in parallel
+      encodeDataSegments (segments);
+
+      // encode binary octree structure
+      if (doContextAdaptiveTreeCoding_)
       {
-        uint64_t pointCountDataVector_size;
-        uint64_t pointDiffDataVector_size;
-        uint64_t pointDiffColorDataVector_size;
+        compressedPointDataLen_ += occupancyCoder_.encodeTreeToStream (binaryTreeDataVector_, prevOccupancyVector_,
+                                                                       this->octreeDepth_, !iFrame_,
+                                                                       occupancyVector_, compressedTreeDataOut_arg);
+        prevOccupancyVector_.swap (occupancyVector_);
+      }
+      else
+        compressedPointDataLen_ += writeDataSegments (segments, segmentIdx, *segmentCount++, compressedTreeDataOut_arg);
 
+      if (cloudWithColor_)
+        // encode averaged voxel color information
+        compressedColorDataLen_ += writeDataSegments (segments, segmentIdx, *segmentCount++, compressedTreeDataOut_arg);
+
+      if (!doVoxelGridEnDecoding_)
+      {
         // encode amount of points per voxel
-        pointCountDataVector_size = pointCountDataVector_.size ();
-        compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&pointCountDataVector_size), sizeof (pointCountDataVector_size));
-        compressedPointDataLen_ += entropyCoder_.encodeIntVectorToStream (pointCountDataVector_,
-                                                                          compressedTreeDataOut_arg);
+        compressedPointDataLen_ += writeDataSegments (segments, segmentIdx, *segmentCount++, compressedTreeDataOut_arg);
 
         // encode differential point information
-        std::vector<char>& pointDiffDataVector = pointCoder_.getDifferentialDataVector ();
-        pointDiffDataVector_size = pointDiffDataVector.size ();
-        compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&pointDiffDataVector_size), sizeof (pointDiffDataVector_size));
-        compressedPointDataLen_ += entropyCoder_.encodeCharVectorToStream (pointDiffDataVector,
-                                                                           compressedTreeDataOut_arg);
+        compressedPointDataLen_ += writeDataSegments (segments, segmentIdx, *segmentCount++, compressedTreeDataOut_arg);
+
         if (cloudWithColor_)
-        {
           // encode differential color information
-          std::vector<char>& pointDiffColorDataVector = colorCoder_.getDifferentialDataVector ();
-          pointDiffColorDataVector_size = pointDiffColorDataVector.size ();
-          compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&pointDiffColorDataVector_size),
-                                           sizeof (pointDiffColorDataVector_size));
-          compressedColorDataLen_ += entropyCoder_.encodeCharVectorToStream (pointDiffColorDataVector,
-                                                                             compressedTreeDataOut_arg);
-        }
+          compressedColorDataLen_ += writeDataSegments (segments, segmentIdx, *segmentCount++, compressedTreeDataOut_arg);
       }
+
       // flush output stream
       compressedTreeDataOut_arg.flush ();
     }
@@ -311,59 +330,261 @@ namespace pcl
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::entropyDecoding (std::istream& compressedTreeDataIn_arg)
     {
-      uint64_t binaryTreeDataVector_size;
-      uint64_t pointAvgColorDataVector_size;
+      std::vector<DataSegment> segments;
 
       compressedPointDataLen_ = 0;
       compressedColorDataLen_ = 0;
 
-      // decode binary octree structure
-      compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&binaryTreeDataVector_size), sizeof (binaryTreeDataVector_size));
-      binaryTreeDataVector_.resize (static_cast<std::size_t> (binaryTreeDataVector_size));
-      compressedPointDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                         binaryTreeDataVector_);
-
-      if (dataWithColor_)
+      // read binary octree structure
+      if (doContextAdaptiveTreeCoding_)
       {
-        // decode averaged voxel color information
-        std::vector<char>& pointAvgColorDataVector = colorCoder_.getAverageDataVector ();
-        compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&pointAvgColorDataVector_size), sizeof (pointAvgColorDataVector_size));
-        pointAvgColorDataVector.resize (static_cast<std::size_t> (pointAvgColorDataVector_size));
-        compressedColorDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                           pointAvgColorDataVector);
+        compressedPointDataLen_ += occupancyCoder_.decodeStreamToTree (compressedTreeDataIn_arg, prevOccupancyVector_,
+                                                                       this->octreeDepth_, !iFrame_,
+                                                                       binaryTreeDataVector_, occupancyVector_);
+        prevOccupancyVector_.swap (occupancyVector_);
       }
+      else
+        compressedPointDataLen_ += readDataSegments (compressedTreeDataIn_arg, &binaryTreeDataVector_, 0, segments);
+
+      if (dataWithColor_)
+        // read averaged voxel color information
+        compressedColorDataLen_ += readDataSegments (compressedTreeDataIn_arg, &colorCoder_.getAverageDataVector (), 0,
+                                                     segments);
 
       if (!doVoxelGridEnDecoding_)
       {
-        uint64_t pointCountDataVector_size;
-        uint64_t pointDiffDataVector_size;
-        uint64_t pointDiffColorDataVector_size;
-
-        // decode amount of points per voxel
-        compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&pointCountDataVector_size), sizeof (pointCountDataVector_size));
-        pointCountDataVector_.resize (static_cast<std::size_t> (pointCountDataVector_size));
-        compressedPointDataLen_ += entropyCoder_.decodeStreamToIntVector (compressedTreeDataIn_arg, pointCountDataVector_);
-        pointCountDataVectorIterator_ = pointCountDataVector_.begin ();
-
-        // decode differential point information
-        std::vector<char>& pointDiffDataVector = pointCoder_.getDifferentialDataVector ();
-        compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&pointDiffDataVector_size), sizeof (pointDiffDataVector_size));
-        pointDiffDataVector.resize (static_cast<std::size_t> (pointDiffDataVector_size));
-        compressedPointDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                           pointDiffDataVector);
+        // read amount of points per voxel
+        compressedPointDataLen_ += readDataSegments (compressedTreeDataIn_arg, 0, &pointCountDataVector_, segments);
+
+        // read differential point information
+        compressedPointDataLen_ += readDataSegments (compressedTreeDataIn_arg, &pointCoder_.getDifferentialDataVector (),
+                                                     0, segments);
 
         if (dataWithColor_)
+          // read differential color information
+          compressedColorDataLen_ += readDataSegments (compressedTreeDataIn_arg,
+                                                       &colorCoder_.getDifferentialDataVector (), 0, segments);
+      }
+
+      // entropy decode all segments in parallel
+      decodeDataSegments (segments);
+
+      pointCountDataVectorIterator_ = pointCountDataVector_.begin ();
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> std::size_t
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::addDataSegments (
+        std::vector<char>* charData_arg, std::vector<unsigned int>* intData_arg,
+        const std::vector<std::size_t>& offsets_arg, std::vector<DataSegment>& segments_arg) const
+    {
+      const std::size_t minSegmentSize = 1 << 16;
+
+#ifdef _OPENMP
+      const std::size_t threadCount = this->threads_ ? this->threads_ : omp_get_max_threads ();
+#else
+      const std::size_t threadCount = 1;
+#endif
+      // the amount of segments per data vector is stored in a single byte
+      const std::size_t maxSegments = std::min<std::size_t> (threadCount, 255);
+
+      const std::size_t dataSize = charData_arg ? charData_arg->size () : intData_arg->size ();
+      const std::size_t segmentSize = std::max (minSegmentSize, (dataSize + maxSegments - 1) / maxSegments);
+
+      // start a new segment at the first subtree beyond the segment size
+      const std::size_t firstSegment = segments_arg.size ();
+      std::size_t begin = 0;
+      for (std::size_t i = 0; i < offsets_arg.size (); i++)
+      {
+        if (offsets_arg[i] - begin >= segmentSize && dataSize - offsets_arg[i] >= minSegmentSize)
+        {
+          segments_arg.push_back (DataSegment (charData_arg, intData_arg, begin, offsets_arg[i]));
+          begin = offsets_arg[i];
+        }
+      }
+
+      if (dataSize > begin)
+        segments_arg.push_back (DataSegment (charData_arg, intData_arg, begin, dataSize));
+
+      return (segments_arg.size () - firstSegment);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::encodeDataSegments (
+        std::vector<DataSegment>& segments_arg) const
+    {
+      const int segmentCount = static_cast<int> (segments_arg.size ());
+
+#ifdef _OPENMP
+      const int threadCount = this->threads_ ? static_cast<int> (this->threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(threadCount)
+#endif
+      {
+        StaticRangeCoder entropyCoder;
+        std::vector<char> charData;
+        std::vector<unsigned int> intData;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (int i = 0; i < segmentCount; i++)
+        {
+          DataSegment& segment = segments_arg[i];
+          std::ostringstream compressedData;
+
+          if (segment.charData_)
+          {
+            charData.assign (segment.charData_->begin () + segment.begin_, segment.charData_->begin () + segment.end_);
+            entropyCoder.encodeCharVectorToStream (charData, compressedData);
+          }
+          else
+          {
+            intData.assign (segment.intData_->begin () + segment.begin_, segment.intData_->begin () + segment.end_);
+            entropyCoder.encodeIntVectorToStream (intData, compressedData);
+          }
+
+          segment.compressedData_ = compressedData.str ();
+        }
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::decodeDataSegments (
+        std::vector<DataSegment>& segments_arg) const
+    {
+      const int segmentCount = static_cast<int> (segments_arg.size ());
+
+#ifdef _OPENMP
+      const int threadCount = this->threads_ ? static_cast<int> (this->threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(threadCount)
+#endif
+      {
+        StaticRangeCoder entropyCoder;
+        std::vector<char> charData;
+        std::vector<unsigned int> intData;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (int i = 0; i < segmentCount; i++)
         {
-          // decode differential color information
-          std::vector<char>& pointDiffColorDataVector = colorCoder_.getDifferentialDataVector ();
-          compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&pointDiffColorDataVector_size), sizeof (pointDiffColorDataVector_size));
-          pointDiffColorDataVector.resize (static_cast<std::size_t> (pointDiffColorDataVector_size));
-          compressedColorDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                             pointDiffColorDataVector);
+          DataSegment& segment = segments_arg[i];
+          std::istringstream compressedData (segment.compressedData_);
+
+          if (segment.charData_)
+          {
+            charData.resize (segment.end_ - segment.begin_);
+            entropyCoder.decodeStreamToCharVector (compressedData, charData);
+            std::copy (charData.begin (), charData.end (), segment.charData_->begin () + segment.begin_);
+          }
+          else
+          {
+            intData.resize (segment.end_ - segment.begin_);
+            entropyCoder.decodeStreamToIntVector (compressedData, intData);
+            std::copy (intData.begin (), intData.end (), segment.intData_->begin () + segment.begin_);
+          }
         }
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> uint64_t
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::writeDataSegments (
+        const std::vector<DataSegment>& segments_arg, std::size_t& segmentIdx_arg, std::size_t segmentCount_arg,
+        std::ostream& compressedTreeDataOut_arg)
+    {
+      uint64_t dataVector_size = 0;
+      unsigned char segmentCount = static_cast<unsigned char> (segmentCount_arg);
+      uint64_t compressedDataLen = 0;
+
+      // the segments of a data vector are stored one after another, an empty data vector has no segments
+      const std::size_t segmentEnd = segmentIdx_arg + segmentCount_arg;
+      if (segmentCount_arg)
+      {
+        const DataSegment& first = segments_arg[segmentIdx_arg];
+        dataVector_size = first.charData_ ? first.charData_->size () : first.intData_->size ();
+      }
+
+      // encode vector size and amount of segments
+      compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&dataVector_size), sizeof (dataVector_size));
+      compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&segmentCount), sizeof (segmentCount));
+
+      for (; segmentIdx_arg < segmentEnd; segmentIdx_arg++)
+      {
+        const DataSegment& segment = segments_arg[segmentIdx_arg];
+        uint64_t segment_size = segment.end_ - segment.begin_;
+        uint64_t compressedData_size = segment.compressedData_.size ();
+
+        // encode segment size, size of entropy coded data and entropy coded data
+        compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&segment_size), sizeof (segment_size));
+        compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&compressedData_size), sizeof (compressedData_size));
+        compressedTreeDataOut_arg.write (segment.compressedData_.data (), compressedData_size);
+
+        compressedDataLen += compressedData_size;
+      }
+
+      return (compressedDataLen);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> uint64_t
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::readDataSegments (
+        std::istream& compressedTreeDataIn_arg, std::vector<char>* charData_arg,
+        std::vector<unsigned int>* intData_arg, std::vector<DataSegment>& segments_arg)
+    {
+      uint64_t dataVector_size;
+      unsigned char segmentCount;
+      uint64_t compressedDataLen = 0;
+      std::size_t begin = 0;
+
+      // decode vector size
+      compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&dataVector_size), sizeof (dataVector_size));
+
+      if (charData_arg)
+        charData_arg->resize (static_cast<std::size_t> (dataVector_size));
+      else
+        intData_arg->resize (static_cast<std::size_t> (dataVector_size));
+
+      if (legacyFrame_)
+      {
+        // legacy frames contain a single range coded stream of unknown length, decode it right away
+        StaticRangeCoder entropyCoder;
+        if (charData_arg)
+          return (entropyCoder.decodeStreamToCharVector (compressedTreeDataIn_arg, *charData_arg));
+        else
+          return (entropyCoder.decodeStreamToIntVector (compressedTreeDataIn_arg, *intData_arg));
+      }
+
+      // decode amount of segments
+      compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&segmentCount), sizeof (segmentCount));
+
+      for (unsigned char i = 0; i < segmentCount; i++)
+      {
+        uint64_t segment_size;
+        uint64_t compressedData_size;
+
+        // decode segment size and size of entropy coded data
+        compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&segment_size), sizeof (segment_size));
+        compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&compressedData_size), sizeof (compressedData_size));
+
+        segments_arg.push_back (DataSegment (charData_arg, intData_arg, begin,
+                                             begin + static_cast<std::size_t> (segment_size)));
+        begin += static_cast<std::size_t> (segment_size);
+
+        // read entropy coded data
+        std::string& compressedData = segments_arg.back ().compressedData_;
+        compressedData.resize (static_cast<std::size_t> (compressedData_size));
+        if (compressedData_size)
+          compressedTreeDataIn_arg.read (&compressedData[0], compressedData_size);
+
+        compressedDataLen += compressedData_size;
+      }
+
+      return (compressedDataLen);
+    }
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::writeFrameHeader (std::ostream& compressedTreeDataOut_arg)
@@ -396,6 +617,7 @@ namespace pcl
         // encode coding configuration
         compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&doVoxelGridEnDecoding_), sizeof (doVoxelGridEnDecoding_));
         compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&cloudWithColor_), sizeof (cloudWithColor_));
+        compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&doContextAdaptiveTreeCoding_), sizeof (doContextAdaptiveTreeCoding_));
         compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&pointCount_), sizeof (pointCount_));
         compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&octreeResolution), sizeof (octreeResolution));
         compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&colorBitDepth), sizeof (colorBitDepth));
@@ -415,14 +637,30 @@ namespace pcl
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::syncToHeader ( std::istream& compressedTreeDataIn_arg)
     {
-      // sync to frame header
-      unsigned int headerIdPos = 0;
-      while (headerIdPos < strlen (frameHeaderIdentifier_))
+      // sync to frame header, the most recently read characters are compared to both frame identifiers
+      const std::size_t headerIdLen = strlen (frameHeaderIdentifier_);
+      const std::size_t legacyHeaderIdLen = strlen (legacyFrameHeaderIdentifier_);
+      std::string readChars;
+
+      char readChar;
+      while (compressedTreeDataIn_arg.read (static_cast<char*> (&readChar), sizeof (readChar)))
       {
-        char readChar;
-        compressedTreeDataIn_arg.read (static_cast<char*> (&readChar), sizeof (readChar));
-        if (readChar != frameHeaderIdentifier_[headerIdPos++])
-          headerIdPos = (frameHeaderIdentifier_[0]==readChar)?1:0;
+        readChars.push_back (readChar);
+        if (readChars.size () > headerIdLen)
+          readChars.erase (0, 1);
+
+        if (readChars.size () == headerIdLen && readChars.compare (0, headerIdLen, frameHeaderIdentifier_) == 0)
+        {
+          legacyFrame_ = false;
+          break;
+        }
+        if (readChars.size () >= legacyHeaderIdLen
+            && readChars.compare (readChars.size () - legacyHeaderIdLen, legacyHeaderIdLen,
+                                  legacyFrameHeaderIdentifier_) == 0)
+        {
+          legacyFrame_ = true;
+          break;
+        }
       }
     }
 
@@ -443,6 +681,11 @@ namespace pcl
         // read coder configuration
         compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&doVoxelGridEnDecoding_), sizeof (doVoxelGridEnDecoding_));
         compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&dataWithColor_), sizeof (dataWithColor_));
+        // the tree coder selection is only stored in frames of the current format
+        if (legacyFrame_)
+          doContextAdaptiveTreeCoding_ = false;
+        else
+          compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&doContextAdaptiveTreeCoding_), sizeof (doContextAdaptiveTreeCoding_));
         compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&pointCount_), sizeof (pointCount_));
         compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&octreeResolution), sizeof (octreeResolution));
         compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&colorBitDepth), sizeof (colorBitDepth));
@@ -475,6 +718,28 @@ namespace pcl
       // reference to point indices vector stored within octree leaf
       const std::vector<int>& leafIdx = leaf_arg.getDataTVector ();
 
+      // record the start of a new subtree below the third tree level in the data vectors, the vectors are split into
+      // independently coded segments at these positions
+      const unsigned int subtreeDepth = std::min (this->octreeDepth_, 3u);
+      const unsigned int subtreeShift = this->octreeDepth_ - subtreeDepth;
+
+      OctreeKey subtreeKey;
+      subtreeKey.x = key_arg.x >> subtreeShift;
+      subtreeKey.y = key_arg.y >> subtreeShift;
+      subtreeKey.z = key_arg.z >> subtreeShift;
+
+      if (treeDataOffsets_.empty () || !(subtreeKey == segmentKey_))
+      {
+        segmentKey_ = subtreeKey;
+
+        // the branch nodes of the new subtree down to this leaf are already serialized
+        treeDataOffsets_.push_back (treeDataOffsets_.empty () ? 0 : binaryTreeDataVector_.size () - subtreeShift);
+        pointAvgColorOffsets_.push_back (colorCoder_.getAverageDataVector ().size ());
+        pointCountOffsets_.push_back (pointCountDataVector_.size ());
+        pointDiffOffsets_.push_back (pointCoder_.getDifferentialDataVector ().size ());
+        pointDiffColorOffsets_.push_back (colorCoder_.getDifferentialDataVector ().size ());
+      }
+
       if (!doVoxelGridEnDecoding_)
       {
         double lowerVoxelCorner[3];
@@ -0,0 +1,323 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_COMPRESSION_OCTREE_OCCUPANCY_CODER_H_
+#define PCL_COMPRESSION_OCTREE_OCCUPANCY_CODER_H_
+
+#include <iostream>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+namespace pcl
+{
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief @b OctreeOccupancyCoder compression class
+   *  \note This class provides context-adaptive binary arithmetic coding of serialized octree structures.
+   *  \note Every occupancy byte is coded as 8 binary decisions. Their probabilities are adapted during coding and
+   *  \note conditioned on the already coded bits of the byte, on the occupancy of the face-adjacent sibling nodes
+   *  \note (taken from the parent occupancy byte) and, for XOR encoded prediction frames, on the occupancy of the
+   *  \note same node in the previous frame. No frequency table is stored in the output stream; new contexts adapt
+   *  \note quickly and slow down as they collect statistics.
+   *  \note
+   *  \author Open Perception
+   */
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  class OctreeOccupancyCoder
+  {
+    public:
+      /** \brief Constructor. */
+      OctreeOccupancyCoder () :
+        probabilities_ (), observations_ (), siblingContexts_ (), treeDepth_ (0), doXOREncoding_ (false), treeData_ (0), treeDataPos_ (0),
+        prevOccupancy_ (0), prevOccupancyPos_ (0), occupancy_ (0), nodeCount_ (0), low_ (0), range_ (0), code_ (0),
+        cache_ (0), cacheSize_ (0), outputCharVector_ (), inputCharVector_ (), inputCharPos_ (0)
+      {
+      }
+
+      /** \brief Empty deconstructor. */
+      virtual
+      ~OctreeOccupancyCoder ()
+      {
+      }
+
+      /** \brief Encode serialized octree structure to output stream
+        * \param[in] binaryTree_arg serialized octree structure (XOR bit patterns if doXOREncoding_arg is set)
+        * \param[in] prevOccupancy_arg occupancy bytes of the previous frame, as returned in occupancy_arg
+        * \param[in] treeDepth_arg depth of the octree
+        * \param[in] doXOREncoding_arg binaryTree_arg is XOR encoded against the previous frame
+        * \param[out] occupancy_arg occupancy bytes of the current frame
+        * \param[out] outputByteStream_arg output stream containing compressed data
+        * \return amount of bytes written to output stream
+        */
+      unsigned long
+      encodeTreeToStream (const std::vector<char>& binaryTree_arg, const std::vector<char>& prevOccupancy_arg,
+                          unsigned int treeDepth_arg, bool doXOREncoding_arg, std::vector<char>& occupancy_arg,
+                          std::ostream& outputByteStream_arg);
+
+      /** \brief Decode stream to serialized octree structure
+        * \param[in] inputByteStream_arg input stream of compressed data
+        * \param[in] prevOccupancy_arg occupancy bytes of the previous frame, as returned in occupancy_arg
+        * \param[in] treeDepth_arg depth of the octree
+        * \param[in] doXOREncoding_arg return the octree structure XOR encoded against the previous frame
+        * \param[out] binaryTree_arg serialized octree structure
+        * \param[out] occupancy_arg occupancy bytes of the current frame
+        * \return amount of bytes read from input stream
+        */
+      unsigned long
+      decodeStreamToTree (std::istream& inputByteStream_arg, const std::vector<char>& prevOccupancy_arg,
+                          unsigned int treeDepth_arg, bool doXOREncoding_arg, std::vector<char>& binaryTree_arg,
+                          std::vector<char>& occupancy_arg);
+
+    protected:
+      typedef boost::uint32_t DWord; // 4 bytes
+      typedef boost::uint64_t QWord; // 8 bytes
+
+      /** \brief Amount of bits of the probability values. */
+      static const unsigned int probabilityBits_ = 12;
+
+      /** \brief Amount of contexts: 2 tree levels x 10 sibling states, without previous frame information or
+        * combined with the previous frame bit and whether the byte matches the previous frame so far. */
+      static const unsigned int contextCount_ = 2 * 10 + 2 * 10 * 2 * 2;
+
+      /** \brief Reset probabilities and arithmetic coder state. */
+      void
+      initialize (const std::vector<char>& prevOccupancy_arg, unsigned int treeDepth_arg, bool doXOREncoding_arg,
+                  std::vector<char>& occupancy_arg);
+
+      /** \brief Recursively encode a branch node and its child branch nodes
+        * \param[in] depth_arg depth of the branch node
+        * \param[in] hasPrev_arg the node existed in the previous frame
+        * \param[in] parent_arg occupancy byte of the parent node
+        * \param[in] childIdx_arg child index of the node within its parent
+        */
+      void
+      encodeNodeRecursive (unsigned int depth_arg, bool hasPrev_arg, unsigned char parent_arg,
+                           unsigned char childIdx_arg);
+
+      /** \brief Recursively decode a branch node and its child branch nodes
+        * \param[in] depth_arg depth of the branch node
+        * \param[in] hasPrev_arg the node existed in the previous frame
+        * \param[in] parent_arg occupancy byte of the parent node
+        * \param[in] childIdx_arg child index of the node within its parent
+        * \param[out] binaryTree_arg serialized octree structure
+        */
+      void
+      decodeNodeRecursive (unsigned int depth_arg, bool hasPrev_arg, unsigned char parent_arg,
+                           unsigned char childIdx_arg, std::vector<char>& binaryTree_arg);
+
+      /** \brief Skip a subtree of the previous frame that does not exist in the current frame
+        * \param[in] depth_arg depth of the branch node
+        */
+      void
+      skipPrevNodeRecursive (unsigned int depth_arg);
+
+      /** \brief Compute the spatial context of every bit of an occupancy byte
+        * \param[in] depth_arg depth of the branch node
+        * \param[in] parent_arg occupancy byte of the parent node
+        * \param[in] childIdx_arg child index of the node within its parent
+        * \param[out] contexts_arg tree level and sibling state of the 8 bits
+        */
+      void
+      getContexts (unsigned int depth_arg, unsigned char parent_arg, unsigned char childIdx_arg,
+                   unsigned int contexts_arg[8]) const;
+
+      /** \brief Get the probability index of a bit
+        * \param[in] context_arg spatial context of the bit
+        * \param[in] hasPrev_arg the node existed in the previous frame
+        * \param[in] prevBit_arg value of the bit in the previous frame
+        * \param[in] match_arg the already coded bits equal the previous frame
+        * \param[in] partial_arg already coded bits of the byte, with a leading one
+        */
+      inline std::size_t
+      getProbabilityIdx (unsigned int context_arg, bool hasPrev_arg, unsigned int prevBit_arg, bool match_arg,
+                         unsigned int partial_arg) const
+      {
+        unsigned int context = context_arg;
+        if (hasPrev_arg)
+          context = 2 * 10 + (context_arg * 2 + prevBit_arg) * 2 + (match_arg ? 1 : 0);
+        return (context * 256 + partial_arg);
+      }
+
+      /** \brief Adapt a probability value to a coded bit
+        * \param[in] idx_arg probability index
+        * \param[in] bit_arg bit value
+        */
+      inline void
+      updateProbability (std::size_t idx_arg, unsigned int bit_arg)
+      {
+        // adaptation slows down from a shift of 1 to 5 as the context collects observations
+        static const unsigned char shifts[16] = {1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 5};
+        unsigned char& observations = observations_[idx_arg];
+        const unsigned int shift = shifts[observations];
+        if (observations < 15)
+          observations++;
+
+        // the update keeps the probability within [1, 2^probabilityBits_ - 1]
+        boost::uint16_t& probability = probabilities_[idx_arg];
+        if (!bit_arg)
+          probability = static_cast<boost::uint16_t> (probability + (((1 << probabilityBits_) - probability) >> shift));
+        else
+          probability = static_cast<boost::uint16_t> (probability - (probability >> shift));
+      }
+
+      /** \brief Encode a single bit
+        * \param[in] idx_arg probability index
+        * \param[in] bit_arg bit value
+        */
+      inline void
+      encodeBit (std::size_t idx_arg, unsigned int bit_arg)
+      {
+        const DWord bound = (range_ >> probabilityBits_) * probabilities_[idx_arg];
+        if (!bit_arg)
+          range_ = bound;
+        else
+        {
+          low_ += bound;
+          range_ -= bound;
+        }
+        updateProbability (idx_arg, bit_arg);
+
+        while (range_ < (1u << 24))
+        {
+          range_ <<= 8;
+          shiftLow ();
+        }
+      }
+
+      /** \brief Decode a single bit
+        * \param[in] idx_arg probability index
+        * \return bit value
+        */
+      inline unsigned int
+      decodeBit (std::size_t idx_arg)
+      {
+        const DWord bound = (range_ >> probabilityBits_) * probabilities_[idx_arg];
+        unsigned int bit;
+        if (code_ < bound)
+        {
+          range_ = bound;
+          bit = 0;
+        }
+        else
+        {
+          code_ -= bound;
+          range_ -= bound;
+          bit = 1;
+        }
+        updateProbability (idx_arg, bit);
+
+        while (range_ < (1u << 24))
+        {
+          range_ <<= 8;
+          code_ = (code_ << 8) | readByte ();
+        }
+        return (bit);
+      }
+
+      /** \brief Move the top byte of the coder interval to the output vector, propagating carries. */
+      void
+      shiftLow ();
+
+      /** \brief Read next byte of compressed data (zero at the end of the data). */
+      inline DWord
+      readByte ()
+      {
+        if (inputCharPos_ < inputCharVector_.size ())
+          return (static_cast<unsigned char> (inputCharVector_[inputCharPos_++]));
+        return (0);
+      }
+
+    private:
+      /** \brief Adaptive probabilities of a zero bit, 256 per context (indexed by the already coded bits). */
+      std::vector<boost::uint16_t> probabilities_;
+
+      /** \brief Amount of coded bits per probability value, saturating at 15. */
+      std::vector<unsigned char> observations_;
+
+      /** \brief Sibling state of every bit, indexed by parent occupancy byte, child index and bit. */
+      std::vector<unsigned char> siblingContexts_;
+
+      /** \brief Depth of the octree. */
+      unsigned int treeDepth_;
+
+      /** \brief Serialized structure is XOR encoded against the previous frame. */
+      bool doXOREncoding_;
+
+      /** \brief Serialized octree structure to be encoded. */
+      const std::vector<char>* treeData_;
+
+      /** \brief Read position in the serialized octree structure. */
+      std::size_t treeDataPos_;
+
+      /** \brief Occupancy bytes of the previous frame. */
+      const std::vector<char>* prevOccupancy_;
+
+      /** \brief Read position in the occupancy bytes of the previous frame. */
+      std::size_t prevOccupancyPos_;
+
+      /** \brief Occupancy bytes of the current frame. */
+      std::vector<char>* occupancy_;
+
+      /** \brief Amount of branch nodes to be decoded. */
+      std::size_t nodeCount_;
+
+      /** \brief Lower bound of the coder interval. */
+      QWord low_;
+
+      /** \brief Size of the coder interval. */
+      DWord range_;
+
+      /** \brief Decoder position within the coder interval. */
+      DWord code_;
+
+      /** \brief Pending output byte, which may still receive a carry. */
+      unsigned char cache_;
+
+      /** \brief Amount of pending output bytes. */
+      QWord cacheSize_;
+
+      /** \brief Vector containing compressed data. */
+      std::vector<char> outputCharVector_;
+
+      /** \brief Vector containing compressed input data. */
+      std::vector<char> inputCharVector_;
+
+      /** \brief Read position in the compressed input data. */
+      std::size_t inputCharPos_;
+  };
+}
+
+#endif  // PCL_COMPRESSION_OCTREE_OCCUPANCY_CODER_H_
@@ -42,6 +42,7 @@
 #include <pcl/common/io.h>
 #include <pcl/octree/octree_pointcloud.h>
 #include "entropy_range_coder.h"
+#include "octree_occupancy_coder.h"
 #include "color_coding.h"
 #include "point_coding.h"
 
@@ -64,6 +65,14 @@ namespace pcl
     /** \brief @b Octree pointcloud compression class
      *  \note This class enables compression and decompression of point cloud data based on octree data structures.
      *  \note
+     *  \note The encoded data vectors are split at subtree boundaries into segments that are entropy coded
+     *  \note independently, in parallel on the number of threads given by setNumberOfThreads (0: automatic).
+     *  \note The octree structure can alternatively be coded with a context-adaptive binary arithmetic coder
+     *  \note (see setContextAdaptiveTreeCoding).
+     *  \note
+     *  \note Frames are written with the "<PCL-OCT-COMPRESSED-V2>" identifier. Streams of the unsegmented
+     *  \note "<PCL-OCT-COMPRESSED>" format can still be decoded.
+     *  \note
      *  \note typename: PointT: type of point used in pointcloud
      *  \author Julius Kammerl (julius@kammerl.de)
      */
@@ -112,7 +121,16 @@ namespace pcl
           pointCountDataVectorIterator_ (),
           colorCoder_ (),
           pointCoder_ (),
-          entropyCoder_ (),
+          treeDataOffsets_ (),
+          pointAvgColorOffsets_ (),
+          pointCountOffsets_ (),
+          pointDiffOffsets_ (),
+          pointDiffColorOffsets_ (),
+          segmentKey_ (),
+          occupancyCoder_ (),
+          occupancyVector_ (),
+          prevOccupancyVector_ (),
+          doContextAdaptiveTreeCoding_ (false), legacyFrame_ (false),
           doVoxelGridEnDecoding_ (doVoxelGridDownDownSampling_arg), iFrameRate_ (iFrameRate_arg),
           iFrameCounter_ (0), frameID_ (0), pointCount_ (0), iFrame_ (true),
           doColorEncoding_ (doColorEncoding_arg), cloudWithColor_ (false), dataWithColor_ (false),
@@ -181,6 +199,26 @@ namespace pcl
           return (output_);
         }
 
+        /** \brief Enable context-adaptive binary arithmetic coding of the octree structure. The occupancy bytes are
+          * coded conditioned on the parent and previous frame occupancy instead of a static frequency table. The
+          * setting is stored in the I-frame header of the "<PCL-OCT-COMPRESSED-V2>" format and forces the next frame
+          * to be an I-frame. Legacy "<PCL-OCT-COMPRESSED>" frames are always decoded with the static range coder.
+          * \param enable_arg: use the context-adaptive coder (true) or the static range coder (false)
+          */
+        inline void
+        setContextAdaptiveTreeCoding (bool enable_arg)
+        {
+          doContextAdaptiveTreeCoding_ = enable_arg;
+          iFrame_ = true;
+        }
+
+        /** \brief Get whether the octree structure is coded with the context-adaptive binary arithmetic coder. */
+        inline bool
+        getContextAdaptiveTreeCoding () const
+        {
+          return (doContextAdaptiveTreeCoding_);
+        }
+
         /** \brief Encode point cloud to output stream
           * \param cloud_arg:  point cloud to be compressed
           * \param compressedTreeDataOut_arg:  binary output stream containing compressed data
@@ -209,7 +247,7 @@ namespace pcl
         void
         readFrameHeader (std::istream& compressedTreeDataIn_arg);
 
-        /** \brief Synchronize to frame header
+        /** \brief Synchronize to frame header, either of the current or of the legacy frame format
           * \param compressedTreeDataIn_arg: binary input stream
           */
         void
@@ -241,6 +279,87 @@ namespace pcl
         virtual void
         deserializeTreeCallback (LeafNode&, const OctreeKey& key_arg);
 
+        /** \brief @b Segment of a data vector that is entropy coded independently of the other segments
+          * \note A segment refers to either a char or an unsigned int data vector.
+          */
+        class DataSegment
+        {
+          public:
+            /** \brief Constructor.
+              * \param charData_arg: char data vector of the segment (or 0)
+              * \param intData_arg: unsigned int data vector of the segment (or 0)
+              * \param begin_arg: index of the first element of the segment
+              * \param end_arg: index after the last element of the segment
+              */
+            DataSegment (std::vector<char>* charData_arg, std::vector<unsigned int>* intData_arg,
+                         std::size_t begin_arg, std::size_t end_arg) :
+              charData_ (charData_arg), intData_ (intData_arg), begin_ (begin_arg), end_ (end_arg), compressedData_ ()
+            {
+            }
+
+            /** \brief Char data vector of the segment. */
+            std::vector<char>* charData_;
+
+            /** \brief Unsigned int data vector of the segment. */
+            std::vector<unsigned int>* intData_;
+
+            /** \brief Index of the first element of the segment. */
+            std::size_t begin_;
+
+            /** \brief Index after the last element of the segment. */
+            std::size_t end_;
+
+            /** \brief Entropy coded data of the segment. */
+            std::string compressedData_;
+        };
+
+        /** \brief Split a data vector into segments at the recorded subtree offsets
+          * \note The segments hold at least 64k elements, and the vector is split into at most one segment per thread.
+          * \param charData_arg: char data vector (or 0)
+          * \param intData_arg: unsigned int data vector (or 0)
+          * \param offsets_arg: start positions of subtrees in the data vector
+          * \param segments_arg: the segments are appended to this vector
+          * \return amount of segments appended (0 for an empty data vector)
+          */
+        std::size_t
+        addDataSegments (std::vector<char>* charData_arg, std::vector<unsigned int>* intData_arg,
+                         const std::vector<std::size_t>& offsets_arg, std::vector<DataSegment>& segments_arg) const;
+
+        /** \brief Entropy encode data segments in parallel
+          * \param segments_arg: data segments to be encoded
+          */
+        void
+        encodeDataSegments (std::vector<DataSegment>& segments_arg) const;
+
+        /** \brief Entropy decode data segments in parallel
+          * \param segments_arg: data segments to be decoded into their data vectors
+          */
+        void
+        decodeDataSegments (std::vector<DataSegment>& segments_arg) const;
+
+        /** \brief Write the encoded segments of a data vector to output stream
+          * \param segments_arg: encoded data segments
+          * \param segmentIdx_arg: index of the first segment of the data vector, advanced to the next data vector
+          * \param segmentCount_arg: amount of segments of the data vector
+          * \param compressedTreeDataOut_arg: binary output stream
+          * \return amount of entropy coded bytes written to output stream
+          */
+        uint64_t
+        writeDataSegments (const std::vector<DataSegment>& segments_arg, std::size_t& segmentIdx_arg,
+                           std::size_t segmentCount_arg, std::ostream& compressedTreeDataOut_arg);
+
+        /** \brief Read the encoded segments of a data vector from input stream and resize the data vector
+          * \note Legacy frames hold a single range coded stream per data vector, which is decoded directly.
+          * \param compressedTreeDataIn_arg: binary input stream
+          * \param charData_arg: char data vector (or 0)
+          * \param intData_arg: unsigned int data vector (or 0)
+          * \param segments_arg: the segments are appended to this vector
+          * \return amount of entropy coded bytes read from input stream
+          */
+        uint64_t
+        readDataSegments (std::istream& compressedTreeDataIn_arg, std::vector<char>* charData_arg,
+                          std::vector<unsigned int>* intData_arg, std::vector<DataSegment>& segments_arg);
+
 
         /** \brief Pointer to output point cloud dataset. */
         PointCloudPtr output_;
@@ -263,8 +382,37 @@ namespace pcl
         /** \brief Point coding instance */
         PointCoding<PointT> pointCoder_;
 
-        /** \brief Static range coder instance */
-        StaticRangeCoder entropyCoder_;
+        /** \brief Start positions of subtrees in the binary tree structure vector */
+        std::vector<std::size_t> treeDataOffsets_;
+
+        /** \brief Start positions of subtrees in the average color vector */
+        std::vector<std::size_t> pointAvgColorOffsets_;
+
+        /** \brief Start positions of subtrees in the points per voxel vector */
+        std::vector<std::size_t> pointCountOffsets_;
+
+        /** \brief Start positions of subtrees in the differential point vector */
+        std::vector<std::size_t> pointDiffOffsets_;
+
+        /** \brief Start positions of subtrees in the differential color vector */
+        std::vector<std::size_t> pointDiffColorOffsets_;
+
+        /** \brief Key of the subtree currently serialized */
+        OctreeKey segmentKey_;
+
+        /** \brief Context-adaptive binary arithmetic coder instance for the octree structure */
+        OctreeOccupancyCoder occupancyCoder_;
+
+        /** \brief Vector for storing the occupancy bytes of the current frame */
+        std::vector<char> occupancyVector_;
+
+        /** \brief Vector for storing the occupancy bytes of the previous frame */
+        std::vector<char> prevOccupancyVector_;
+
+        bool doContextAdaptiveTreeCoding_;
+
+        /** \brief Frame read by syncToHeader uses the legacy, unsegmented format */
+        bool legacyFrame_;
 
         bool doVoxelGridEnDecoding_;
         uint32_t iFrameRate_;
@@ -286,6 +434,9 @@ namespace pcl
         // frame header identifier
         static const char* frameHeaderIdentifier_;
 
+        // frame header identifier of the legacy, unsegmented format
+        static const char* legacyFrameHeaderIdentifier_;
+
         const compression_Profiles_e selectedProfile_;
         const double pointResolution_;
         const double octreeResolution_;
@@ -295,7 +446,11 @@ namespace pcl
 
     // define frame identifier
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
-      const char* OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::frameHeaderIdentifier_ = "<PCL-OCT-COMPRESSED>";
+      const char* OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::frameHeaderIdentifier_ = "<PCL-OCT-COMPRESSED-V2>";
+
+    // define legacy frame identifier
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
+      const char* OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::legacyFrameHeaderIdentifier_ = "<PCL-OCT-COMPRESSED>";
   }
 
 }
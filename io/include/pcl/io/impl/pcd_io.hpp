@@ -255,6 +255,144 @@ pcl::PCDWriter::writeBinary (const std::string &file_name,
   return (0);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::PCDWriter::writeBinaryAligned (const std::string &file_name, 
+                                    const pcl::PointCloud<PointT> &cloud)
+{
+  if (cloud.empty ())
+  {
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Input point cloud has no data!");
+    return (-1);
+  }
+  // Store the points with the memory layout of PointT and align the data, so
+  // that the mapped file can be used in place (see PCDMappedCloud)
+  std::vector<sensor_msgs::PointField> fields;
+  std::vector<int> fields_sizes;
+  size_t nri = 0;
+  pcl::getFields (cloud, fields);
+  for (size_t i = 0; i < fields.size (); ++i)
+  {
+    if (fields[i].name == "_")
+      continue;
+    fields_sizes.push_back (fields[i].count * getFieldSize (fields[i].datatype));
+    fields[nri++] = fields[i];
+  }
+  fields.resize (nri);
+  std::string header = generateHeaderBinaryAligned (fields, sizeof (PointT), cloud.width, cloud.height,
+                                                    cloud.sensor_origin_, cloud.sensor_orientation_);
+  int data_idx = static_cast<int> (header.size ());
+
+#if _WIN32
+  HANDLE h_native_file = CreateFileA (file_name.c_str (), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (h_native_file == INVALID_HANDLE_VALUE)
+  {
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during CreateFile!");
+    return (-1);
+  }
+#else
+  int fd = pcl_open (file_name.c_str (), O_RDWR | O_CREAT | O_TRUNC, static_cast<mode_t> (0600));
+  if (fd < 0)
+  {
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during open!");
+    return (-1);
+  }
+#endif
+  // Mandatory lock file
+  boost::interprocess::file_lock file_lock;
+  setLockingPermissions (file_name, file_lock);
+
+  size_t data_size = cloud.points.size () * sizeof (PointT);
+
+  // Prepare the map
+#if _WIN32
+  HANDLE fm = CreateFileMappingA (h_native_file, NULL, PAGE_READWRITE, 0, (DWORD) (data_idx + data_size), NULL);
+  char *map = static_cast<char*>(MapViewOfFile (fm, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, data_idx + data_size));
+  CloseHandle (fm);
+
+#else
+  // Stretch the file size to the size of the data
+  int result = static_cast<int> (pcl_lseek (fd, getpagesize () + data_size - 1, SEEK_SET));
+  if (result < 0)
+  {
+    pcl_close (fd);
+    resetLockingPermissions (file_name, file_lock);
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during lseek ()!");
+    return (-1);
+  }
+  // Write a bogus entry so that the new file size comes in effect
+  result = static_cast<int> (::write (fd, "", 1));
+  if (result != 1)
+  {
+    pcl_close (fd);
+    resetLockingPermissions (file_name, file_lock);
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during write ()!");
+    return (-1);
+  }
+
+  char *map = static_cast<char*> (mmap (0, data_idx + data_size, PROT_WRITE, MAP_SHARED, fd, 0));
+  if (map == reinterpret_cast<char*> (-1)) //MAP_FAILED)
+  {
+    pcl_close (fd);
+    resetLockingPermissions (file_name, file_lock);
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during mmap ()!");
+    return (-1);
+  }
+#endif
+
+  // Copy the header
+  memcpy (&map[0], header.c_str (), data_idx);
+
+  // Copy the data field by field, so that the padding of PointT is written as zeros
+  char *out = &map[0] + data_idx;
+  memset (out, 0, data_size);
+  for (size_t i = 0; i < cloud.points.size (); ++i, out += sizeof (PointT))
+    for (size_t j = 0; j < fields.size (); ++j)
+      memcpy (out + fields[j].offset, reinterpret_cast<const char*> (&cloud.points[i]) + fields[j].offset, fields_sizes[j]);
+
+  // If the user set the synchronization flag on, call msync
+#if !_WIN32
+  if (map_synchronization_)
+    msync (map, data_idx + data_size, MS_SYNC);
+#endif
+
+  // Unmap the pages of memory
+#if _WIN32
+    UnmapViewOfFile (map);
+#else
+  if (munmap (map, (data_idx + data_size)) == -1)
+  {
+    pcl_close (fd);
+    resetLockingPermissions (file_name, file_lock);
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during munmap ()!");
+    return (-1);
+  }
+#endif
+  // Close file
+#if _WIN32
+  CloseHandle (h_native_file);
+#else
+  pcl_close (fd);
+#endif
+  resetLockingPermissions (file_name, file_lock);
+  return (0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::PCDWriter::writeBinaryChunked (const std::string &file_name, 
+                                    const pcl::PointCloud<PointT> &cloud)
+{
+  if (cloud.empty ())
+  {
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryChunked] Input point cloud has no data!");
+    return (-1);
+  }
+  sensor_msgs::PointCloud2 blob;
+  pcl::toROSMsg (cloud, blob);
+  return (writeBinaryChunked (file_name, blob, cloud.sensor_origin_, cloud.sensor_orientation_));
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name, 
@@ -746,6 +884,131 @@ pcl::PCDWriter::writeBinary (const std::string &file_name,
   return (0);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::PCDWriter::writeBinaryAligned (const std::string &file_name, 
+                                    const pcl::PointCloud<PointT> &cloud, 
+                                    const std::vector<int> &indices)
+{
+  if (cloud.points.empty () || indices.empty ())
+  {
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Input point cloud has no data or empty indices given!");
+    return (-1);
+  }
+  // Store the points with the memory layout of PointT and align the data, so
+  // that the mapped file can be used in place (see PCDMappedCloud)
+  std::vector<sensor_msgs::PointField> fields;
+  std::vector<int> fields_sizes;
+  size_t nri = 0;
+  pcl::getFields (cloud, fields);
+  for (size_t i = 0; i < fields.size (); ++i)
+  {
+    if (fields[i].name == "_")
+      continue;
+    fields_sizes.push_back (fields[i].count * getFieldSize (fields[i].datatype));
+    fields[nri++] = fields[i];
+  }
+  fields.resize (nri);
+  std::string header = generateHeaderBinaryAligned (fields, sizeof (PointT), static_cast<uint32_t> (indices.size ()), 1,
+                                                    cloud.sensor_origin_, cloud.sensor_orientation_);
+  int data_idx = static_cast<int> (header.size ());
+
+#if _WIN32
+  HANDLE h_native_file = CreateFileA (file_name.c_str (), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (h_native_file == INVALID_HANDLE_VALUE)
+  {
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during CreateFile!");
+    return (-1);
+  }
+#else
+  int fd = pcl_open (file_name.c_str (), O_RDWR | O_CREAT | O_TRUNC, static_cast<mode_t> (0600));
+  if (fd < 0)
+  {
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during open!");
+    return (-1);
+  }
+#endif
+  // Mandatory lock file
+  boost::interprocess::file_lock file_lock;
+  setLockingPermissions (file_name, file_lock);
+
+  size_t data_size = indices.size () * sizeof (PointT);
+
+  // Prepare the map
+#if _WIN32
+  HANDLE fm = CreateFileMapping (h_native_file, NULL, PAGE_READWRITE, 0, data_idx + data_size, NULL);
+  char *map = static_cast<char*>(MapViewOfFile (fm, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, data_idx + data_size));
+  CloseHandle (fm);
+
+#else
+  // Stretch the file size to the size of the data
+  int result = static_cast<int> (pcl_lseek (fd, getpagesize () + data_size - 1, SEEK_SET));
+  if (result < 0)
+  {
+    pcl_close (fd);
+    resetLockingPermissions (file_name, file_lock);
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during lseek ()!");
+    return (-1);
+  }
+  // Write a bogus entry so that the new file size comes in effect
+  result = static_cast<int> (::write (fd, "", 1));
+  if (result != 1)
+  {
+    pcl_close (fd);
+    resetLockingPermissions (file_name, file_lock);
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during write ()!");
+    return (-1);
+  }
+
+  char *map = static_cast<char*> (mmap (0, data_idx + data_size, PROT_WRITE, MAP_SHARED, fd, 0));
+  if (map == reinterpret_cast<char*> (-1)) //MAP_FAILED)
+  {
+    pcl_close (fd);
+    resetLockingPermissions (file_name, file_lock);
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during mmap ()!");
+    return (-1);
+  }
+#endif
+
+  // Copy the header
+  memcpy (&map[0], header.c_str (), data_idx);
+
+  // Copy the data field by field, so that the padding of PointT is written as zeros
+  char *out = &map[0] + data_idx;
+  memset (out, 0, data_size);
+  for (size_t i = 0; i < indices.size (); ++i, out += sizeof (PointT))
+    for (size_t j = 0; j < fields.size (); ++j)
+      memcpy (out + fields[j].offset, reinterpret_cast<const char*> (&cloud.points[indices[i]]) + fields[j].offset, fields_sizes[j]);
+
+#if !_WIN32
+  // If the user set the synchronization flag on, call msync
+  if (map_synchronization_)
+    msync (map, data_idx + data_size, MS_SYNC);
+#endif
+
+  // Unmap the pages of memory
+#if _WIN32
+    UnmapViewOfFile (map);
+#else
+  if (munmap (map, (data_idx + data_size)) == -1)
+  {
+    pcl_close (fd);
+    resetLockingPermissions (file_name, file_lock);
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryAligned] Error during munmap ()!");
+    return (-1);
+  }
+#endif
+  // Close file
+#if _WIN32
+  CloseHandle(h_native_file);
+#else
+  pcl_close (fd);
+#endif
+  
+  resetLockingPermissions (file_name, file_lock);
+  return (0);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::PCDWriter::writeASCII (const std::string &file_name, 
@@ -0,0 +1,155 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_IO_PCD_MAPPED_CLOUD_IMPL_H_
+#define PCL_IO_PCD_MAPPED_CLOUD_IMPL_H_
+
+#include <pcl/common/io.h>
+#include <pcl/console/print.h>
+#include <boost/type_traits/alignment_of.hpp>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::PCDMappedCloud<PointT>::open (const std::string &file_name, const int offset)
+{
+  PCDMappedFile::Ptr file (new PCDMappedFile);
+  if (file->open (file_name, offset) < 0)
+  {
+    file_.reset ();
+    field_map_.clear ();
+    direct_ = false;
+    return (-1);
+  }
+  return (setInputFile (file));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::PCDMappedCloud<PointT>::setInputFile (const PCDMappedFile::ConstPtr &file)
+{
+  field_map_.clear ();
+  direct_ = false;
+  if (!file || !file->isOpen ())
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::setInputFile] No mapped file given!\n");
+    file_.reset ();
+    return (-1);
+  }
+  file_ = file;
+
+  const sensor_msgs::PointCloud2 &header = file_->getHeader ();
+  createMapping<PointT> (header.fields, field_map_);
+
+  // The points can be used in place only if every field of PointT is stored
+  // at the same offset, with the same type, and the serialized point has the
+  // size and the alignment of PointT
+  if (header.point_step != sizeof (PointT) ||
+      reinterpret_cast<size_t> (file_->getData ()) % boost::alignment_of<PointT>::value != 0)
+    return (0);
+
+  std::vector<sensor_msgs::PointField> fields;
+  pcl::getFields<PointT> (fields);
+  for (size_t i = 0; i < fields.size (); ++i)
+  {
+    if (fields[i].name == "_")
+      continue;
+    int idx = pcl::getFieldIndex (header, fields[i].name);
+    if (idx == -1 ||
+        header.fields[idx].offset != fields[i].offset ||
+        header.fields[idx].datatype != fields[i].datatype ||
+        header.fields[idx].count != fields[i].count)
+      return (0);
+  }
+  direct_ = true;
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> template <typename T> pcl::PCDMappedFieldView<T>
+pcl::PCDMappedCloud<PointT>::getFieldView (const std::string &name, const unsigned int element) const
+{
+  if (!file_)
+    return (PCDMappedFieldView<T> ());
+
+  const sensor_msgs::PointCloud2 &header = file_->getHeader ();
+  int idx = pcl::getFieldIndex (header, name);
+  if (idx == -1)
+  {
+    PCL_WARN ("[pcl::PCDMappedCloud::getFieldView] Field %s not found in %s!\n", name.c_str (), file_->getFileName ().c_str ());
+    return (PCDMappedFieldView<T> ());
+  }
+  const sensor_msgs::PointField &field = header.fields[idx];
+  if (pcl::getFieldSize (field.datatype) != static_cast<int> (sizeof (T)) || element >= field.count)
+  {
+    PCL_WARN ("[pcl::PCDMappedCloud::getFieldView] Field %s (size %d, count %u) cannot be viewed as element %u of a %d bytes type!\n",
+              name.c_str (), pcl::getFieldSize (field.datatype), field.count, element, static_cast<int> (sizeof (T)));
+    return (PCDMappedFieldView<T> ());
+  }
+  return (PCDMappedFieldView<T> (file_->getData () + field.offset + element * sizeof (T),
+                                 header.point_step, file_->size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PCDMappedCloud<PointT>::copyTo (pcl::PointCloud<PointT> &cloud) const
+{
+  if (!file_)
+  {
+    cloud.points.clear ();
+    cloud.width = cloud.height = 0;
+    return;
+  }
+
+  cloud.width    = width ();
+  cloud.height   = height ();
+  cloud.is_dense = file_->getHeader ().is_dense == 1;
+  cloud.sensor_origin_      = file_->getSensorOrigin ();
+  cloud.sensor_orientation_ = file_->getSensorOrientation ();
+  cloud.points.resize (size ());
+  if (cloud.points.empty ())
+    return;
+
+  if (direct_)
+  {
+    memcpy (&cloud.points[0], file_->getData (), size () * sizeof (PointT));
+    return;
+  }
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+    at (i, cloud.points[i]);
+}
+
+#endif  //#ifndef PCL_IO_PCD_MAPPED_CLOUD_IMPL_H_
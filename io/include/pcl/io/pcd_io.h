@@ -53,7 +53,7 @@ namespace pcl
   {
     public:
       /** Empty constructor */      
-      PCDReader () : FileReader () {}
+      PCDReader () : FileReader (), threads_ (0) {}
       /** Empty destructor */      
       ~PCDReader () {}
       /** \brief Various PCD file versions.
@@ -97,7 +97,7 @@ namespace pcl
         * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
         * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
         * \param[out] pcd_version the PCD version of the file (i.e., PCD_V6, PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed) 
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary chunked) 
         * \param[out] data_idx the offset of cloud data within the file
         * \param[in] offset the offset of where to expect the PCD Header in the
         * file (optional parameter). One usage example for setting the offset
@@ -153,7 +153,7 @@ namespace pcl
         * \param[in] file_name the name of the file to load
         * \param[out] cloud the resultant point cloud dataset (only the properties will be filled)
         * \param[out] pcd_version the PCD version of the file (either PCD_V6 or PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed) 
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary chunked) 
         * \param[out] data_idx the offset of cloud data within the file
         * \param[in] offset the offset of where to expect the PCD Header in the
         * file (optional parameter). One usage example for setting the offset
@@ -262,8 +262,118 @@ namespace pcl
         */
       int
       readEigen (const std::string &file_name, pcl::PointCloud<Eigen::MatrixXf> &cloud, const int offset = 0);
-      
-    
+
+      /** \brief Read a contiguous range of points from a PCD file and store it into a sensor_msgs/PointCloud2.
+        *
+        * For binary_chunked files only the chunks overlapping the range are
+        * decompressed, and for binary files only the requested bytes are read.
+        * ASCII and binary_compressed files have to be decoded completely.
+        *
+        * \param[in] file_name the name of the file containing the actual PointCloud data
+        * \param[in] first_point the index of the first point to read
+        * \param[in] nr_points the number of points to read
+        * \param[out] cloud the resultant (unorganized) PointCloud message holding the points
+        * \param[in] offset the offset of where to expect the PCD Header in the
+        * file (optional parameter, see read ())
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      readPointRange (const std::string &file_name, const unsigned int first_point, const unsigned int nr_points,
+                      sensor_msgs::PointCloud2 &cloud, const int offset = 0);
+
+      /** \brief Read a contiguous range of points from a PCD file, and convert it to the given template format.
+        * \param[in] file_name the name of the file containing the actual PointCloud data
+        * \param[in] first_point the index of the first point to read
+        * \param[in] nr_points the number of points to read
+        * \param[out] cloud the resultant (unorganized) point cloud
+        * \param[in] offset the offset of where to expect the PCD Header in the file
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      template<typename PointT> int
+      readPointRange (const std::string &file_name, const unsigned int first_point, const unsigned int nr_points,
+                      pcl::PointCloud<PointT> &cloud, const int offset = 0)
+      {
+        sensor_msgs::PointCloud2 blob;
+        int res = readPointRange (file_name, first_point, nr_points, blob, offset);
+
+        // If no error, convert the data
+        if (res == 0)
+          pcl::fromROSMsg (blob, cloud);
+        return (res);
+      }
+
+      /** \brief Read the chunk index of a binary_chunked PCD file. The compressed
+        * size of every chunk is either listed in the CHUNKS header entry, or stored
+        * after the data when the entry reads "CHUNKS <points per chunk> INDEX <position>"
+        * (see PCDStreamWriter).
+        * \param[in] file_name the name of the file
+        * \param[in] cloud the header of the file, as filled by readHeader
+        * \param[in] data_idx the offset of the data within the file
+        * \param[out] points_per_chunk the number of points in every chunk but the last
+        * \param[out] chunk_offsets the offsets of the chunks relative to the start of
+        * the data, with one extra entry holding the total size of the chunks
+        * \param[in] offset the offset of the PCD header within the file
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      readChunkIndex (const std::string &file_name, const sensor_msgs::PointCloud2 &cloud,
+                      const unsigned int data_idx, unsigned int &points_per_chunk,
+                      std::vector<size_t> &chunk_offsets, const int offset = 0);
+
+      /** \brief Decode the points [first_point, first_point + nr_points) of binary_chunked
+        * data held in memory. Only the chunks overlapping the range are decompressed.
+        * \param[in] data the start of the data, holding chunk_offsets.back () bytes
+        * \param[in] cloud the header of the file, as filled by readHeader
+        * \param[in] points_per_chunk the number of points per chunk (see readChunkIndex)
+        * \param[in] chunk_offsets the chunk index (see readChunkIndex)
+        * \param[in] first_point the index of the first point to decode
+        * \param[in] nr_points the number of points to decode
+        * \param[out] data_out the decoded points, with cloud.point_step bytes per point
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      decodeChunks (const char *data, const sensor_msgs::PointCloud2 &cloud,
+                    const unsigned int points_per_chunk, const std::vector<size_t> &chunk_offsets,
+                    const size_t first_point, const size_t nr_points, std::vector<uint8_t> &data_out);
+
+      /** \brief Set the number of threads used to decompress binary_chunked files.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+    protected:
+      /** \brief Decode the points [first_point, first_point + nr_points) of a binary_chunked file.
+        * \param[in] file_name the name of the file
+        * \param[in] cloud the header of the file, as filled by readHeader
+        * \param[in] data_idx the offset of the data within the file
+        * \param[in] offset the offset of the PCD header within the file
+        * \param[in] first_point the index of the first point to decode
+        * \param[in] nr_points the number of points to decode
+        * \param[out] data the decoded points, with cloud.point_step bytes per point
+        */
+      int
+      readBinaryChunked (const std::string &file_name, const sensor_msgs::PointCloud2 &cloud,
+                         const unsigned int data_idx, const int offset,
+                         const size_t first_point, const size_t nr_points,
+                         std::vector<uint8_t> &data);
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+    public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   };
@@ -275,7 +385,7 @@ namespace pcl
   class PCL_EXPORTS PCDWriter : public FileWriter
   {
     public:
-      PCDWriter() : FileWriter(), map_synchronization_(false) {}
+      PCDWriter() : FileWriter(), map_synchronization_(false), threads_ (0), points_per_chunk_ (65536) {}
       ~PCDWriter() {}
 
       /** \brief Set whether mmap() synchornization via msync() is desired before munmap() calls. 
@@ -292,6 +402,24 @@ namespace pcl
         map_synchronization_ = sync;
       }
 
+      /** \brief Set the number of threads used to compress binary_chunked files.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Set the number of points compressed together in a chunk of a binary_chunked file.
+        * Smaller chunks allow finer grained range reads and parallelism, at the cost of a
+        * slightly lower compression ratio. Default: 65536.
+        * \param[in] nr_points the number of points per chunk
+        */
+      inline void
+      setChunkSize (unsigned int nr_points) { points_per_chunk_ = nr_points; }
+
+      /** \brief Get the number of points compressed together in a chunk of a binary_chunked file. */
+      inline unsigned int
+      getChunkSize () const { return (points_per_chunk_); }
+
       /** \brief Generate the header of a PCD file format
         * \param[in] cloud the point cloud data message
         * \param[in] origin the sensor acquisition origin
@@ -302,6 +430,24 @@ namespace pcl
                             const Eigen::Vector4f &origin, 
                             const Eigen::Quaternionf &orientation);
 
+      /** \brief Generate the header of a BINARY PCD file that stores the points with
+        * the memory layout of their type. The gaps between the fields are stored as
+        * "_" padding fields, and the header ends with a DATA line placed so that the
+        * data starts on a 16 byte boundary (see PCDMappedCloud).
+        * \param[in] fields the fields of the point type
+        * \param[in] point_step the size of the point type in bytes
+        * \param[in] width the width of the point cloud
+        * \param[in] height the height of the point cloud
+        * \param[in] origin the sensor acquisition origin
+        * \param[in] orientation the sensor acquisition orientation
+        */
+      std::string
+      generateHeaderBinaryAligned (const std::vector<sensor_msgs::PointField> &fields,
+                                   const uint32_t point_step,
+                                   const uint32_t width, const uint32_t height,
+                                   const Eigen::Vector4f &origin, 
+                                   const Eigen::Quaternionf &orientation);
+
       /** \brief Generate the header of a BINARY_COMPRESSED PCD file format
         * \param[in] cloud the point cloud data message
         * \param[in] origin the sensor acquisition origin
@@ -388,6 +534,25 @@ namespace pcl
                              const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (), 
                              const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
 
+      /** \brief Save point cloud data to a PCD file containing n-D points, in BINARY_CHUNKED format.
+        *
+        * Like BINARY_COMPRESSED, the fields are stored plane by plane (xxyyzz) and
+        * compressed with LZF, but the points are split into chunks of
+        * getChunkSize () points that are compressed independently and in
+        * parallel. The compressed size of every chunk is listed in a CHUNKS
+        * header entry, which allows readers to decompress chunks in parallel
+        * and to decode a range of points on its own (see PCDReader::readPointRange).
+        *
+        * \param[in] file_name the output file name
+        * \param[in] cloud the point cloud data message
+        * \param[in] origin the sensor acquisition origin
+        * \param[in] orientation the sensor acquisition orientation
+        */
+      int 
+      writeBinaryChunked (const std::string &file_name, const sensor_msgs::PointCloud2 &cloud,
+                          const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (), 
+                          const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
+
       /** \brief Save point cloud data to a PCD file containing n-D points
         * \param[in] file_name the output file name
         * \param[in] cloud the point cloud data message
@@ -449,6 +614,18 @@ namespace pcl
       writeBinary (const std::string &file_name, 
                    const pcl::PointCloud<PointT> &cloud);
 
+      /** \brief Save point cloud data to a PCD file containing n-D points, in BINARY
+        * format, with the memory layout of PointT. Unlike writeBinary (), the gaps
+        * between the fields are kept as "_" padding fields (written as zeros) and
+        * the data starts on a 16 byte boundary, so that PCDMappedCloud<PointT> can
+        * use the mapped points in place.
+        * \param[in] file_name the output file name
+        * \param[in] cloud the point cloud data message
+        */
+      template <typename PointT> int 
+      writeBinaryAligned (const std::string &file_name, 
+                          const pcl::PointCloud<PointT> &cloud);
+
       /** \brief Save point cloud data to a PCD file containing n-D points, in BINARY format
         * \note This version is specialized for PointCloud<Eigen::MatrixXf> data types. 
         * \attention The PCD data is \b always stored in ROW major format! The
@@ -469,6 +646,14 @@ namespace pcl
       writeBinaryCompressed (const std::string &file_name, 
                              const pcl::PointCloud<PointT> &cloud);
 
+      /** \brief Save point cloud data to a binary chunked PCD file (see writeBinaryChunked ()).
+        * \param[in] file_name the output file name
+        * \param[in] cloud the point cloud data
+        */
+      template <typename PointT> int 
+      writeBinaryChunked (const std::string &file_name, 
+                          const pcl::PointCloud<PointT> &cloud);
+
       /** \brief Save point cloud data to a binary comprssed PCD file.
         * \note This version is specialized for PointCloud<Eigen::MatrixXf> data types. 
         * \attention The PCD data is \b always stored in ROW major format! The
@@ -491,6 +676,17 @@ namespace pcl
                    const pcl::PointCloud<PointT> &cloud, 
                    const std::vector<int> &indices);
 
+      /** \brief Save point cloud data to a PCD file containing n-D points, in BINARY
+        * format, with the memory layout of PointT (see writeBinaryAligned ()).
+        * \param[in] file_name the output file name
+        * \param[in] cloud the point cloud data message
+        * \param[in] indices the set of point indices that we want written to disk
+        */
+      template <typename PointT> int 
+      writeBinaryAligned (const std::string &file_name, 
+                          const pcl::PointCloud<PointT> &cloud, 
+                          const std::vector<int> &indices);
+
       /** \brief Save point cloud data to a PCD file containing n-D points, in ASCII format
         * \param[in] file_name the output file name
         * \param[in] cloud the point cloud data message
@@ -598,6 +794,12 @@ namespace pcl
       /** \brief Set to true if msync() should be called before munmap(). Prevents data loss on NFS systems. */
       bool map_synchronization_;
 
+      /** \brief The number of threads the scheduler should use to compress binary_chunked files. */
+      unsigned int threads_;
+
+      /** \brief The number of points per chunk of binary_chunked files. */
+      unsigned int points_per_chunk_;
+
       typedef std::pair<std::string, pcl::ChannelProperties> pair_channel_properties;
       /** \brief Internal structure used to sort the ChannelProperties in the
         * cloud.channels map based on their offset. 
@@ -0,0 +1,380 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_IO_PCD_MAPPED_CLOUD_H_
+#define PCL_IO_PCD_MAPPED_CLOUD_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/ros/conversions.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <boost/shared_ptr.hpp>
+#include <cstring>
+#include <string>
+
+namespace pcl
+{
+  /** \brief Read-only memory mapping of a binary PCD file.
+    *
+    * The whole file is mapped with shared, read-only pages: opening a file is
+    * O(1) in its size, nothing is copied, and all processes that map the same
+    * file share a single copy of the data in the page cache. Only uncompressed
+    * \b binary PCD files can be mapped; ASCII and binary_compressed files are
+    * rejected, use PCDReader for those.
+    *
+    * PCDMappedFile is untyped. Use PCDMappedCloud to access the points.
+    *
+    * \author Open Perception
+    * \ingroup io
+    */
+  class PCL_EXPORTS PCDMappedFile
+  {
+    public:
+      typedef boost::shared_ptr<PCDMappedFile> Ptr;
+      typedef boost::shared_ptr<const PCDMappedFile> ConstPtr;
+
+      /** \brief Empty constructor. */
+      PCDMappedFile ();
+
+      /** \brief Destructor. Unmaps the file. */
+      ~PCDMappedFile ();
+
+      /** \brief Map a binary PCD file into memory.
+        * \param[in] file_name the name of the file to map
+        * \param[in] offset the offset of where to expect the PCD header in the
+        * file (optional parameter, see PCDReader::read)
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      open (const std::string &file_name, const int offset = 0);
+
+      /** \brief Unmap the file. All data pointers obtained previously become invalid. */
+      void
+      close ();
+
+      /** \brief Return true if a file is currently mapped. */
+      inline bool
+      isOpen () const { return (map_ != NULL); }
+
+      /** \brief Get the header of the mapped file. The returned message
+        * describes the fields, width, height, point_step and row_step of the
+        * data, but its \a data member is always empty.
+        */
+      inline const sensor_msgs::PointCloud2&
+      getHeader () const { return (header_); }
+
+      /** \brief Get the sensor acquisition origin stored in the file. */
+      inline const Eigen::Vector4f&
+      getSensorOrigin () const { return (origin_); }
+
+      /** \brief Get the sensor acquisition orientation stored in the file. */
+      inline const Eigen::Quaternionf&
+      getSensorOrientation () const { return (orientation_); }
+
+      /** \brief Get the number of points in the file. */
+      inline size_t
+      size () const { return (static_cast<size_t> (header_.width) * header_.height); }
+
+      /** \brief Get the size of a serialized point in bytes. */
+      inline uint32_t
+      getPointStep () const { return (header_.point_step); }
+
+      /** \brief Get a pointer to the first serialized point, or NULL if no file is mapped. */
+      inline const uint8_t*
+      getData () const { return (data_); }
+
+      /** \brief Get a pointer to the serialized point at index \a i. */
+      inline const uint8_t*
+      getPoint (size_t i) const { return (data_ + i * header_.point_step); }
+
+      /** \brief Get the name of the mapped file. */
+      inline const std::string&
+      getFileName () const { return (file_name_); }
+
+    private:
+      /** \brief Non-copyable: the mapping is owned by exactly one object. */
+      PCDMappedFile (const PCDMappedFile&);
+      PCDMappedFile& operator = (const PCDMappedFile&);
+
+      /** \brief The header of the mapped file (without data). */
+      sensor_msgs::PointCloud2 header_;
+
+      /** \brief The sensor acquisition origin. */
+      Eigen::Vector4f origin_;
+
+      /** \brief The sensor acquisition orientation. */
+      Eigen::Quaternionf orientation_;
+
+      /** \brief The name of the mapped file. */
+      std::string file_name_;
+
+      /** \brief The start of the mapping (the beginning of the file). */
+      char *map_;
+
+      /** \brief The size of the mapping in bytes. */
+      size_t map_size_;
+
+      /** \brief The start of the point data inside the mapping. */
+      const uint8_t *data_;
+
+#ifdef _WIN32
+      /** \brief The file mapping handle (HANDLE). */
+      void *file_mapping_;
+#endif
+
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /** \brief Strided, read-only view of a single field of a mapped PCD file.
+    *
+    * Element \a i is read from the \a i-th serialized point, so iterating a
+    * view touches only the bytes of that field. Values are read with memcpy
+    * and are therefore safe regardless of the alignment of the field on disk.
+    *
+    * \author Open Perception
+    * \ingroup io
+    */
+  template <typename T>
+  class PCDMappedFieldView
+  {
+    public:
+      /** \brief Empty constructor: an invalid view. */
+      PCDMappedFieldView () : data_ (NULL), stride_ (0), size_ (0) {}
+
+      /** \brief Constructor.
+        * \param[in] data pointer to the field in the first point
+        * \param[in] stride the distance in bytes between two consecutive values
+        * \param[in] size the number of values
+        */
+      PCDMappedFieldView (const uint8_t *data, size_t stride, size_t size)
+        : data_ (data), stride_ (stride), size_ (size) {}
+
+      /** \brief Get the value of the field for point \a i. */
+      inline T
+      operator[] (size_t i) const
+      {
+        T value;
+        memcpy (&value, data_ + i * stride_, sizeof (T));
+        return (value);
+      }
+
+      /** \brief Return true if the view does not reference any field. */
+      inline bool
+      empty () const { return (data_ == NULL); }
+
+      /** \brief Get the number of values in the view. */
+      inline size_t
+      size () const { return (size_); }
+
+      /** \brief Get the distance in bytes between two consecutive values. */
+      inline size_t
+      stride () const { return (stride_); }
+
+      /** \brief Get a pointer to the first value. */
+      inline const uint8_t*
+      data () const { return (data_); }
+
+    private:
+      const uint8_t *data_;
+      size_t stride_;
+      size_t size_;
+  };
+
+  /** \brief Typed, read-only point access to a memory mapped binary PCD file.
+    *
+    * PCDMappedCloud keeps a PCDMappedFile alive and interprets its data as
+    * points of type PointT, replacing the PCDReader::read + fromROSMsg path
+    * (which copies the data twice) when the dataset is only going to be read.
+    *
+    * When the serialized layout is identical to PointT (same fields at the
+    * same offsets, point_step == sizeof (PointT)) and the data is suitably
+    * aligned in the file, which is the case for files written with
+    * PCDWriter::writeBinaryAligned (), the cloud is \a direct: operator[] and the
+    * iterators return references straight into the mapped pages. Otherwise
+    * points are assembled on demand with at (), using the same field mapping
+    * as fromROSMsg. Single fields can always be accessed in place with
+    * getFieldView ().
+    *
+    * \code
+    * pcl::PCDMappedCloud<pcl::PointXYZ> cloud;
+    * if (cloud.open ("tile.pcd") == 0)
+    * {
+    *   pcl::PCDMappedFieldView<float> z = cloud.getFieldView<float> ("z");
+    *   for (size_t i = 0; i < z.size (); ++i)
+    *     max_z = std::max (max_z, z[i]);
+    * }
+    * \endcode
+    *
+    * \author Open Perception
+    * \ingroup io
+    */
+  template <typename PointT>
+  class PCDMappedCloud
+  {
+    public:
+      typedef boost::shared_ptr<PCDMappedCloud<PointT> > Ptr;
+      typedef boost::shared_ptr<const PCDMappedCloud<PointT> > ConstPtr;
+
+      typedef const PointT* const_iterator;
+
+      /** \brief Empty constructor. */
+      PCDMappedCloud () : file_ (), field_map_ (), direct_ (false) {}
+
+      /** \brief Map a binary PCD file and interpret it as points of type PointT.
+        * \param[in] file_name the name of the file to map
+        * \param[in] offset the offset of where to expect the PCD header in the file
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      open (const std::string &file_name, const int offset = 0);
+
+      /** \brief Interpret an already mapped file as points of type PointT.
+        * Several typed views can share the same mapping.
+        * \param[in] file the mapped file
+        * \return
+        *  * < 0 (-1) on error (the file is not open)
+        *  * == 0 on success
+        */
+      int
+      setInputFile (const PCDMappedFile::ConstPtr &file);
+
+      /** \brief Get the underlying mapped file. */
+      inline PCDMappedFile::ConstPtr
+      getInputFile () const { return (file_); }
+
+      /** \brief Return true if points can be accessed in place (see operator[]). */
+      inline bool
+      isDirect () const { return (direct_); }
+
+      /** \brief Get the number of points. */
+      inline size_t
+      size () const { return (file_ ? file_->size () : 0); }
+
+      /** \brief Return true if there are no points. */
+      inline bool
+      empty () const { return (size () == 0); }
+
+      /** \brief Get the width of the dataset. */
+      inline uint32_t
+      width () const { return (file_ ? file_->getHeader ().width : 0); }
+
+      /** \brief Get the height of the dataset. */
+      inline uint32_t
+      height () const { return (file_ ? file_->getHeader ().height : 0); }
+
+      /** \brief Return true if the dataset is organized (height > 1). */
+      inline bool
+      isOrganized () const { return (height () > 1); }
+
+      /** \brief Get a reference to the mapped point at index \a i.
+        * \note Only valid if isDirect () returns true.
+        */
+      inline const PointT&
+      operator[] (size_t i) const
+      {
+        assert (direct_);
+        return (*reinterpret_cast<const PointT*> (file_->getPoint (i)));
+      }
+
+      /** \brief Iterator to the first mapped point. Only valid if isDirect (). */
+      inline const_iterator
+      begin () const { return (direct_ ? reinterpret_cast<const PointT*> (file_->getData ()) : NULL); }
+
+      /** \brief Iterator past the last mapped point. Only valid if isDirect (). */
+      inline const_iterator
+      end () const { return (direct_ ? begin () + size () : NULL); }
+
+      /** \brief Copy the point at index \a i into \a point. Works for any layout.
+        * Fields of PointT that are missing in the file are left untouched.
+        */
+      inline void
+      at (size_t i, PointT &point) const
+      {
+        const uint8_t *src = file_->getPoint (i);
+        if (direct_)
+        {
+          memcpy (&point, src, sizeof (PointT));
+          return;
+        }
+        uint8_t *dst = reinterpret_cast<uint8_t*> (&point);
+        for (size_t m = 0; m < field_map_.size (); ++m)
+          memcpy (dst + field_map_[m].struct_offset, src + field_map_[m].serialized_offset, field_map_[m].size);
+      }
+
+      /** \brief Get a copy of the point at index \a i. Works for any layout. */
+      inline PointT
+      at (size_t i) const
+      {
+        PointT point;
+        at (i, point);
+        return (point);
+      }
+
+      /** \brief Get a strided view of the field called \a name.
+        * \param[in] name the name of the field (e.g., "x")
+        * \param[in] element the element to view for fields with count > 1
+        * \return an empty view if the field does not exist or if sizeof (T)
+        * does not match the size of the serialized field
+        */
+      template <typename T> PCDMappedFieldView<T>
+      getFieldView (const std::string &name, const unsigned int element = 0) const;
+
+      /** \brief Copy the mapped data into a regular point cloud.
+        * \param[out] cloud the resultant point cloud
+        */
+      void
+      copyTo (pcl::PointCloud<PointT> &cloud) const;
+
+    private:
+      /** \brief The mapped file. */
+      PCDMappedFile::ConstPtr file_;
+
+      /** \brief Mapping between the serialized fields and the fields of PointT. */
+      MsgFieldMap field_map_;
+
+      /** \brief True if the serialized points can be reinterpreted as PointT in place. */
+      bool direct_;
+  };
+}
+
+#include <pcl/io/impl/pcd_mapped_cloud.hpp>
+
+#endif  //#ifndef PCL_IO_PCD_MAPPED_CLOUD_H_
@@ -0,0 +1,403 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_IO_PCD_STREAM_H_
+#define PCL_IO_PCD_STREAM_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/common/io.h>
+#include <pcl/ros/conversions.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/shared_ptr.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Cursor-style reader for PCD files that are too large to be loaded at once.
+    *
+    * After open (), every call to read () returns the next batch of points, so
+    * a file can be processed with memory bounded by the batch size:
+    *
+    * \code
+    * pcl::PCDStreamReader reader;
+    * pcl::PointCloud<pcl::PointXYZ> batch;
+    * reader.open ("survey.pcd");
+    * while (reader.read (batch, 1000000) > 0)
+    *   process (batch);
+    * \endcode
+    *
+    * ASCII, binary and binary_chunked files are read incrementally. The chunk
+    * index of a binary_chunked file is read once by open (), which also maps
+    * the file, so that every batch only decompresses the chunks it needs. A
+    * binary_compressed file is a single LZF block that has to be decompressed
+    * entirely on the first read (use PCDStreamWriter or the binary_chunked
+    * format for large compressed datasets).
+    *
+    * \author Open Perception
+    * \ingroup io
+    */
+  class PCL_EXPORTS PCDStreamReader
+  {
+    public:
+      /** \brief Empty constructor. */
+      PCDStreamReader ();
+
+      /** \brief Destructor. */
+      ~PCDStreamReader ();
+
+      /** \brief Open a PCD file and read its header. The cursor is set to the first point.
+        * \param[in] file_name the name of the file to read
+        * \param[in] offset the offset of where to expect the PCD header in the file
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      open (const std::string &file_name, const int offset = 0);
+
+      /** \brief Close the file and release all buffers. */
+      void
+      close ();
+
+      /** \brief Return true if a file is open. */
+      inline bool
+      isOpen () const { return (!file_name_.empty ()); }
+
+      /** \brief Get the header of the file (the \a data member is empty). */
+      inline const sensor_msgs::PointCloud2&
+      getHeader () const { return (header_); }
+
+      /** \brief Get the sensor acquisition origin stored in the file. */
+      inline const Eigen::Vector4f&
+      getSensorOrigin () const { return (origin_); }
+
+      /** \brief Get the sensor acquisition orientation stored in the file. */
+      inline const Eigen::Quaternionf&
+      getSensorOrientation () const { return (orientation_); }
+
+      /** \brief Get the total number of points in the file. */
+      inline size_t
+      getNumberOfPoints () const { return (static_cast<size_t> (header_.width) * header_.height); }
+
+      /** \brief Get the index of the next point to be read. */
+      inline size_t
+      tell () const { return (cursor_); }
+
+      /** \brief Return true if all points have been read. */
+      inline bool
+      eof () const { return (cursor_ >= getNumberOfPoints ()); }
+
+      /** \brief Move the cursor to the point at index \a point_index.
+        * Seeking is O(1) for binary files; for ASCII files seeking backwards
+        * restarts from the beginning of the data.
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      seek (size_t point_index);
+
+      /** \brief Read the next batch of points and advance the cursor.
+        * \param[out] cloud the resultant (unorganized) PointCloud message
+        * \param[in] nr_points the maximum number of points to read
+        * \return the number of points read (0 once all points have been read), or -1 on error
+        */
+      int
+      read (sensor_msgs::PointCloud2 &cloud, const unsigned int nr_points);
+
+      /** \brief Read the next batch of points, convert it to the given template format and advance the cursor.
+        * \param[out] cloud the resultant (unorganized) point cloud
+        * \param[in] nr_points the maximum number of points to read
+        * \return the number of points read (0 once all points have been read), or -1 on error
+        */
+      template <typename PointT> int
+      read (pcl::PointCloud<PointT> &cloud, const unsigned int nr_points)
+      {
+        sensor_msgs::PointCloud2 blob;
+        int res = read (blob, nr_points);
+        if (res >= 0)
+        {
+          pcl::fromROSMsg (blob, cloud);
+          cloud.sensor_origin_      = origin_;
+          cloud.sensor_orientation_ = orientation_;
+        }
+        return (res);
+      }
+
+    private:
+      /** \brief Read \a nr_points ASCII points into \a cloud. */
+      int
+      readASCII (sensor_msgs::PointCloud2 &cloud, const size_t nr_points);
+
+      /** \brief Make sure the decoded block (chunk or whole file) containing \a point_index is cached. */
+      int
+      loadBlock (const size_t point_index);
+
+      /** \brief The name of the open file. */
+      std::string file_name_;
+
+      /** \brief The offset of the PCD header in the file. */
+      int offset_;
+
+      /** \brief The file header (without data). */
+      sensor_msgs::PointCloud2 header_;
+
+      /** \brief The sensor acquisition origin. */
+      Eigen::Vector4f origin_;
+
+      /** \brief The sensor acquisition orientation. */
+      Eigen::Quaternionf orientation_;
+
+      /** \brief The type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary chunked). */
+      int data_type_;
+
+      /** \brief The offset of the data within the file. */
+      unsigned int data_idx_;
+
+      /** \brief The stream used for ASCII and binary data. */
+      std::ifstream fs_;
+
+      /** \brief The index of the next point to be read. */
+      size_t cursor_;
+
+      /** \brief The number of ASCII points the stream has been advanced over. */
+      size_t ascii_position_;
+
+      /** \brief The number of points per decoded block (chunk size, or all points for binary_compressed). */
+      size_t block_size_;
+
+      /** \brief The index of the cached block, or -1. */
+      int block_index_;
+
+      /** \brief The decoded points of the cached block. */
+      std::vector<uint8_t> block_;
+
+      /** \brief The chunk index of a binary_chunked file (see PCDReader::readChunkIndex). */
+      std::vector<size_t> chunk_offsets_;
+
+      /** \brief The read-only mapping of a binary_chunked file. */
+      boost::shared_ptr<boost::interprocess::mapped_region> map_;
+
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /** \brief Append-only writer for PCD files that are too large to be held in memory.
+    *
+    * Points are appended in batches with write (); close () then fills in the
+    * final WIDTH/HEIGHT/POINTS values of the header, for which space is
+    * reserved when the file is opened, so closing never moves the data:
+    *
+    * \code
+    * pcl::PCDStreamWriter writer;
+    * writer.open<pcl::PointXYZ> ("filtered.pcd", pcl::PCDStreamWriter::BINARY);
+    * while (reader.read (batch, 1000000) > 0)
+    * {
+    *   pass.setInputCloud (batch.makeShared ());
+    *   pass.filter (filtered);
+    *   writer.write (filtered);
+    * }
+    * writer.close ();
+    * \endcode
+    *
+    * \note A binary_compressed file is a single LZF block over all the points
+    * and cannot be appended to. Compressed streams are therefore written in the
+    * binary_chunked format, which PCDReader, PCDStreamReader and
+    * PCDReader::readPointRange decode chunk by chunk. The chunk sizes are not
+    * known in advance: close () writes them after the data, and the CHUNKS
+    * header entry points to them (see PCDReader::readChunkIndex).
+    *
+    * \author Open Perception
+    * \ingroup io
+    */
+  class PCL_EXPORTS PCDStreamWriter
+  {
+    public:
+      /** \brief Output data formats. The values match the data_type of PCDReader::readHeader. */
+      enum DataType
+      {
+        ASCII = 0,
+        BINARY = 1,
+        BINARY_CHUNKED = 3
+      };
+
+      /** \brief Empty constructor. */
+      PCDStreamWriter ();
+
+      /** \brief Destructor. Closes the file if needed. */
+      ~PCDStreamWriter ();
+
+      /** \brief Create a PCD file for points with the given layout.
+        * \param[in] file_name the output file name
+        * \param[in] layout a PointCloud message describing the fields and point_step
+        * of the points to be written (its data is ignored)
+        * \param[in] data_type the output format
+        * \param[in] origin the sensor acquisition origin
+        * \param[in] orientation the sensor acquisition orientation
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      open (const std::string &file_name, const sensor_msgs::PointCloud2 &layout,
+            const DataType data_type = BINARY,
+            const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
+            const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
+
+      /** \brief Create a PCD file for points of type PointT.
+        * \param[in] file_name the output file name
+        * \param[in] data_type the output format
+        * \param[in] origin the sensor acquisition origin
+        * \param[in] orientation the sensor acquisition orientation
+        */
+      template <typename PointT> int
+      open (const std::string &file_name, const DataType data_type = BINARY,
+            const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
+            const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ())
+      {
+        sensor_msgs::PointCloud2 layout;
+        pcl::getFields<PointT> (layout.fields);
+        layout.point_step = sizeof (PointT);
+        return (open (file_name, layout, data_type, origin, orientation));
+      }
+
+      /** \brief Append points to the file.
+        * \param[in] cloud the points to append; their layout must match the one given to open ()
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      write (const sensor_msgs::PointCloud2 &cloud);
+
+      /** \brief Append points to the file.
+        * \param[in] cloud the points to append
+        */
+      template <typename PointT> int
+      write (const pcl::PointCloud<PointT> &cloud)
+      {
+        if (cloud.points.empty ())
+          return (0);
+        sensor_msgs::PointCloud2 blob;
+        pcl::toROSMsg (cloud, blob);
+        return (write (blob));
+      }
+
+      /** \brief Flush the pending points, write the final header and close the file.
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      close ();
+
+      /** \brief Return true if a file is open. */
+      inline bool
+      isOpen () const { return (!file_name_.empty ()); }
+
+      /** \brief Get the number of points appended so far. */
+      inline size_t
+      getNumberOfPoints () const { return (nr_points_); }
+
+      /** \brief Set the numeric precision of ASCII output (default: 8). */
+      inline void
+      setPrecision (const int precision) { precision_ = precision; }
+
+      /** \brief Set the number of points per chunk of binary_chunked output (default: 65536).
+        * Must be called before open ().
+        */
+      inline void
+      setChunkSize (const unsigned int nr_points) { points_per_chunk_ = nr_points > 0 ? nr_points : 1; }
+
+    private:
+      /** \brief Generate the header, including the DATA line.
+        * \param[in] nr_points the number of points in the file
+        * \param[in] data_size the size of the binary_chunked data, where the chunk index starts
+        */
+      std::string
+      generateHeader (const size_t nr_points, const size_t data_size) const;
+
+      /** \brief Compress and append \a nr_points pending points, starting at \a first, as one chunk. */
+      int
+      flushChunk (const size_t first, const size_t nr_points);
+
+      /** \brief The name of the open file. */
+      std::string file_name_;
+
+      /** \brief The output stream. */
+      std::ofstream fs_;
+
+      /** \brief The layout of the points (without data). */
+      sensor_msgs::PointCloud2 layout_;
+
+      /** \brief The sensor acquisition origin. */
+      Eigen::Vector4f origin_;
+
+      /** \brief The sensor acquisition orientation. */
+      Eigen::Quaternionf orientation_;
+
+      /** \brief The output format. */
+      DataType data_type_;
+
+      /** \brief The numeric precision of ASCII output. */
+      int precision_;
+
+      /** \brief The number of points per chunk of binary_chunked output. */
+      unsigned int points_per_chunk_;
+
+      /** \brief The number of bytes reserved for the header at the beginning of the file. */
+      size_t header_size_;
+
+      /** \brief The number of points appended so far. */
+      size_t nr_points_;
+
+      /** \brief Points appended but not compressed yet (binary_chunked only). */
+      std::vector<uint8_t> pending_;
+
+      /** \brief The compressed sizes of the chunks written so far (binary_chunked only). */
+      std::vector<size_t> chunk_sizes_;
+
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#endif  //#ifndef PCL_IO_PCD_STREAM_H_
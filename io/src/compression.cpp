@@ -45,6 +45,9 @@
 #include <pcl/compression/entropy_range_coder.h>
 #include <pcl/compression/impl/entropy_range_coder.hpp>
 
+#include <pcl/compression/octree_occupancy_coder.h>
+#include <pcl/compression/impl/octree_occupancy_coder.hpp>
+
 #include <pcl/compression/octree_pointcloud_compression.h>
 #include <pcl/compression/impl/octree_pointcloud_compression.hpp>
 
@@ -40,6 +40,7 @@
 #include <fstream>
 #include <fcntl.h>
 #include <string>
+#include <algorithm>
 #include <stdlib.h>
 #include <pcl/io/boost.h>
 #include <pcl/common/io.h>
@@ -62,6 +63,9 @@
 # define pcl_lseek(fd,offset,origin) lseek(fd,offset,origin)
 #endif
 #include <boost/version.hpp>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 void
@@ -317,8 +321,6 @@ pcl::PCDReader::readHeader (const std::string &file_name, sensor_msgs::PointClou
       if (line_type.substr (0, 6) == "POINTS")
       {
         sstream >> nr_points;
-        // Need to allocate: N * point_step
-        cloud.data.resize (nr_points * cloud.point_step);
         continue;
       }
 
@@ -328,11 +330,17 @@ pcl::PCDReader::readHeader (const std::string &file_name, sensor_msgs::PointClou
         data_idx = static_cast<int> (fs.tellg ());
         if (st.at (1).substr (0, 17) == "binary_compressed")
          data_type = 2;
+        else if (st.at (1).substr (0, 14) == "binary_chunked")
+          data_type = 3;
         else
           if (st.at (1).substr (0, 6) == "binary")
             data_type = 1;
         continue;
       }
+
+      // The chunk index of binary_chunked files is parsed when the data is read
+      if (line_type.substr (0, 6) == "CHUNKS")
+        continue;
       break;
     }
   }
@@ -593,8 +601,6 @@ pcl::PCDReader::readHeader (const std::string &file_name, sensor_msgs::PointClou
       if (line_type.substr (0, 6) == "POINTS")
       {
         sstream >> nr_points;
-        // Need to allocate: N * point_step
-        cloud.data.resize (nr_points * cloud.point_step);
         continue;
       }
       break;
@@ -864,11 +870,17 @@ pcl::PCDReader::readHeaderEigen (const std::string &file_name, pcl::PointCloud<E
         data_idx = static_cast<int> (fs.tellg ());
         if (st.at (1).substr (0, 17) == "binary_compressed")
          data_type = 2;
+        else if (st.at (1).substr (0, 14) == "binary_chunked")
+          data_type = 3;
         else
           if (st.at (1).substr (0, 6) == "binary")
             data_type = 1;
         continue;
       }
+
+      // The chunk index of binary_chunked files is parsed when the data is read
+      if (line_type.substr (0, 6) == "CHUNKS")
+        continue;
       break;
     }
   }
@@ -918,6 +930,141 @@ pcl::PCDReader::readHeaderEigen (const std::string &file_name, pcl::PointCloud<E
   return (0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  /** \brief Get the fields that are stored in a compressed PCD file (the "_" padding fields are not stored). */
+  void
+  getStoredFields (const std::vector<sensor_msgs::PointField> &all_fields,
+                   std::vector<sensor_msgs::PointField> &fields, std::vector<int> &fields_sizes, int &fsize)
+  {
+    fields.clear ();
+    fields_sizes.clear ();
+    fsize = 0;
+    for (size_t i = 0; i < all_fields.size (); ++i)
+    {
+      if (all_fields[i].name == "_")
+        continue;
+      int fs = all_fields[i].count * pcl::getFieldSize (all_fields[i].datatype);
+      fields.push_back (all_fields[i]);
+      fields_sizes.push_back (fs);
+      fsize += fs;
+    }
+  }
+
+  /** \brief Decode the points [first, first + count) of a binary_chunked data block.
+    * Only the chunks overlapping the range are decompressed, in parallel.
+    * \param[in] data the start of the data block in the file
+    * \param[in] points_per_chunk the number of points per chunk
+    * \param[in] chunk_offsets the chunk index (see PCDReader::readChunkIndex)
+    * \param[in] nr_points the total number of points in the file
+    * \param[in] all_fields the fields of the file
+    * \param[in] point_step the size of a point in the output buffer
+    * \param[out] out the output buffer, holding count * point_step bytes
+    */
+  bool
+  decodeChunkRange (const char *data, const unsigned int points_per_chunk, const std::vector<size_t> &chunk_offsets,
+                const size_t nr_points, const std::vector<sensor_msgs::PointField> &all_fields,
+                const size_t point_step, const size_t first, const size_t count, uint8_t *out,
+                const unsigned int threads)
+  {
+    if (count == 0)
+      return (true);
+
+    std::vector<sensor_msgs::PointField> fields;
+    std::vector<int> fields_sizes;
+    int fsize;
+    getStoredFields (all_fields, fields, fields_sizes, fsize);
+
+    const int first_chunk = static_cast<int> (first / points_per_chunk);
+    const int last_chunk  = static_cast<int> ((first + count - 1) / points_per_chunk);
+    // One flag per chunk, so that the threads never write to the same variable
+    std::vector<char> failed (last_chunk - first_chunk + 1, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads ? threads : omp_get_max_threads ())
+#else
+    (void)threads;
+#endif
+    for (int c = first_chunk; c <= last_chunk; ++c)
+    {
+      const size_t chunk_begin = static_cast<size_t> (c) * points_per_chunk;
+      const size_t chunk_points = std::min (static_cast<size_t> (points_per_chunk), nr_points - chunk_begin);
+      const size_t raw_size = chunk_points * fsize;
+      const size_t stored_size = chunk_offsets[c + 1] - chunk_offsets[c];
+
+      // Uncompressible chunks are stored raw
+      std::vector<char> buf;
+      const char *soa = data + chunk_offsets[c];
+      if (stored_size != raw_size)
+      {
+        buf.resize (raw_size);
+        if (pcl::lzfDecompress (soa, static_cast<unsigned int> (stored_size),
+                                &buf[0], static_cast<unsigned int> (raw_size)) != raw_size)
+        {
+          failed[c - first_chunk] = 1;
+          continue;
+        }
+        soa = &buf[0];
+      }
+
+      // Unpack the xxyyzz of the requested points to xyz
+      const size_t begin = std::max (first, chunk_begin) - chunk_begin;
+      const size_t end   = std::min (first + count, chunk_begin + chunk_points) - chunk_begin;
+      uint8_t *dst = out + (chunk_begin + begin - first) * point_step;
+      const char *plane = soa;
+      for (size_t j = 0; j < fields.size (); ++j)
+      {
+        const char *src = plane + begin * fields_sizes[j];
+        uint8_t *pt = dst + fields[j].offset;
+        for (size_t i = begin; i < end; ++i, src += fields_sizes[j], pt += point_step)
+          memcpy (pt, src, fields_sizes[j]);
+        plane += chunk_points * fields_sizes[j];
+      }
+    }
+    return (std::find (failed.begin (), failed.end (), 1) == failed.end ());
+  }
+
+  /** \brief Map a whole file read-only. Returns NULL on failure. */
+  char*
+  mapFileReadOnly (const std::string &file_name, size_t &map_size)
+  {
+    map_size = static_cast<size_t> (boost::filesystem::file_size (file_name));
+    if (map_size == 0)
+      return (NULL);
+#ifdef _WIN32
+    int fd = pcl_open (file_name.c_str (), O_RDONLY);
+    if (fd == -1)
+      return (NULL);
+    HANDLE fm = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+    char *map = (fm == NULL) ? NULL : static_cast<char*> (MapViewOfFile (fm, FILE_MAP_READ, 0, 0, 0));
+    if (fm != NULL)
+      CloseHandle (fm);
+#else
+    int fd = pcl_open (file_name.c_str (), O_RDONLY);
+    if (fd == -1)
+      return (NULL);
+    char *map = static_cast<char*> (mmap (0, map_size, PROT_READ, MAP_SHARED, fd, 0));
+    if (map == reinterpret_cast<char*> (-1))    // MAP_FAILED
+      map = NULL;
+#endif
+    pcl_close (fd);
+    return (map);
+  }
+
+  /** \brief Unmap a file mapped with mapFileReadOnly. */
+  void
+  unmapFile (char *map, size_t map_size)
+  {
+#ifdef _WIN32
+    (void)map_size;
+    UnmapViewOfFile (map);
+#else
+    munmap (map, map_size);
+#endif
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cloud,
@@ -932,6 +1079,9 @@ pcl::PCDReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cl
   if (res < 0)
     return (res);
 
+  // Only the header has been read so far: allocate N * point_step
+  cloud.data.resize (static_cast<size_t> (cloud.width) * cloud.height * cloud.point_step);
+
   unsigned int idx = 0;
 
   // Get the number of points the cloud should have
@@ -1065,6 +1215,12 @@ pcl::PCDReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cl
     // Close file
     fs.close ();
   }
+  /// ---[ Binary chunked mode: independent LZF chunks, decoded in parallel
+  else if (data_type == 3)
+  {
+    if (readBinaryChunked (file_name, cloud, data_idx, offset, 0, nr_points, cloud.data) < 0)
+      return (-1);
+  }
   else 
   /// ---[ Binary mode only
   /// We must re-open the file and read with mmap () for binary
@@ -1421,6 +1577,8 @@ pcl::PCDReader::readEigen (const std::string &file_name, pcl::PointCloud<Eigen::
     /// ---[ Binary compressed mode only
     if (data_type == 2)
       throw pcl::IOException ("[pcl::PCDReader::readEigen] PCD binary_compressed mode not implemented for Eigen::MatrixXf!");
+    else if (data_type == 3)
+      throw pcl::IOException ("[pcl::PCDReader::readEigen] PCD binary_chunked mode not implemented for Eigen::MatrixXf!");
     else
     {
       // Is the given matrix row major?
@@ -1493,6 +1651,199 @@ pcl::PCDReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cl
   return (0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readChunkIndex (const std::string &file_name, const sensor_msgs::PointCloud2 &cloud,
+                                const unsigned int data_idx, unsigned int &points_per_chunk,
+                                std::vector<size_t> &chunk_offsets, const int offset)
+{
+  std::ifstream fs;
+  fs.open (file_name.c_str (), std::ios::binary);
+  if (!fs.is_open () || fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDReader::readChunkIndex] Could not open file %s.\n", file_name.c_str ());
+    return (-1);
+  }
+  fs.seekg (offset, std::ios::beg);
+
+  std::string line, chunks_line;
+  while (getline (fs, line))
+  {
+    boost::trim (line);
+    if (line.substr (0, 4) == "DATA")
+      break;
+    if (line.substr (0, 6) == "CHUNKS")
+    {
+      chunks_line = line;
+      break;
+    }
+  }
+  std::stringstream sstream (chunks_line);
+  sstream.imbue (std::locale::classic ());
+  std::string line_type, index_type;
+  points_per_chunk = 0;
+  sstream >> line_type >> points_per_chunk;
+  if (points_per_chunk == 0)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readChunkIndex] Missing or invalid CHUNKS entry in %s!\n", file_name.c_str ());
+    return (-1);
+  }
+
+  size_t total_points = static_cast<size_t> (cloud.width) * cloud.height;
+  size_t nr_chunks = (total_points + points_per_chunk - 1) / points_per_chunk;
+  chunk_offsets.assign (1, 0);
+  std::streampos sizes_begin = sstream.tellg ();
+  if (sstream >> index_type && index_type == "INDEX")
+  {
+    // The chunk sizes are stored after the data, as nr_chunks 64 bit values
+    size_t index_idx = 0;
+    sstream >> index_idx;
+    std::vector<uint64_t> chunk_sizes (nr_chunks);
+    fs.clear ();
+    fs.seekg (static_cast<std::streamoff> (data_idx + index_idx));
+    if (nr_chunks > 0)
+      fs.read (reinterpret_cast<char*> (&chunk_sizes[0]), nr_chunks * sizeof (uint64_t));
+    if (sstream.fail () || fs.fail ())
+    {
+      PCL_ERROR ("[pcl::PCDReader::readChunkIndex] The chunk index of %s is missing or truncated!\n", file_name.c_str ());
+      return (-1);
+    }
+    for (size_t c = 0; c < nr_chunks; ++c)
+      chunk_offsets.push_back (chunk_offsets.back () + static_cast<size_t> (chunk_sizes[c]));
+    if (chunk_offsets.back () != index_idx)
+    {
+      PCL_ERROR ("[pcl::PCDReader::readChunkIndex] The chunk sizes of %s do not end at their index!\n", file_name.c_str ());
+      return (-1);
+    }
+    return (0);
+  }
+
+  // The chunk sizes are listed in the header
+  sstream.clear ();
+  sstream.seekg (sizes_begin);
+  size_t chunk_size;
+  while (sstream >> chunk_size)
+    chunk_offsets.push_back (chunk_offsets.back () + chunk_size);
+  if (chunk_offsets.size () != nr_chunks + 1)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readChunkIndex] The chunk index of %s lists %lu chunks, but %lu are needed for %lu points!\n",
+               file_name.c_str (), static_cast<unsigned long> (chunk_offsets.size () - 1),
+               static_cast<unsigned long> (nr_chunks), static_cast<unsigned long> (total_points));
+    return (-1);
+  }
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::decodeChunks (const char *data, const sensor_msgs::PointCloud2 &cloud,
+                              const unsigned int points_per_chunk, const std::vector<size_t> &chunk_offsets,
+                              const size_t first_point, const size_t nr_points, std::vector<uint8_t> &data_out)
+{
+  data_out.resize (nr_points * cloud.point_step);
+  if (!decodeChunkRange (data, points_per_chunk, chunk_offsets, static_cast<size_t> (cloud.width) * cloud.height,
+                         cloud.fields, cloud.point_step, first_point, nr_points,
+                         data_out.empty () ? NULL : &data_out[0], threads_))
+  {
+    PCL_ERROR ("[pcl::PCDReader::decodeChunks] Size of decompressed lzf data does not match the chunk size!\n");
+    return (-1);
+  }
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readBinaryChunked (const std::string &file_name, const sensor_msgs::PointCloud2 &cloud,
+                                   const unsigned int data_idx, const int offset,
+                                   const size_t first_point, const size_t nr_points,
+                                   std::vector<uint8_t> &data)
+{
+  unsigned int points_per_chunk = 0;
+  std::vector<size_t> chunk_offsets;
+  if (readChunkIndex (file_name, cloud, data_idx, points_per_chunk, chunk_offsets, offset) < 0)
+    return (-1);
+
+  size_t map_size;
+  char *map = mapFileReadOnly (file_name, map_size);
+  if (map == NULL)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readBinaryChunked] Error mapping file %s.\n", file_name.c_str ());
+    return (-1);
+  }
+  if (map_size < data_idx + chunk_offsets.back ())
+  {
+    unmapFile (map, map_size);
+    PCL_ERROR ("[pcl::PCDReader::readBinaryChunked] File %s is truncated!\n", file_name.c_str ());
+    return (-1);
+  }
+
+  int res = decodeChunks (map + data_idx, cloud, points_per_chunk, chunk_offsets, first_point, nr_points, data);
+  unmapFile (map, map_size);
+  return (res);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readPointRange (const std::string &file_name, const unsigned int first_point, const unsigned int nr_points,
+                                sensor_msgs::PointCloud2 &cloud, const int offset)
+{
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int pcd_version, data_type;
+  unsigned int data_idx;
+  if (readHeader (file_name, cloud, origin, orientation, pcd_version, data_type, data_idx, offset) < 0)
+    return (-1);
+
+  size_t total_points = static_cast<size_t> (cloud.width) * cloud.height;
+  if (static_cast<size_t> (first_point) + nr_points > total_points)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readPointRange] Range [%u, %u) exceeds the %lu points of %s!\n",
+               first_point, first_point + nr_points, static_cast<unsigned long> (total_points), file_name.c_str ());
+    return (-1);
+  }
+
+  if (data_type == 3)
+  {
+    if (readBinaryChunked (file_name, cloud, data_idx, offset, first_point, nr_points, cloud.data) < 0)
+      return (-1);
+  }
+  else if (data_type == 1)
+  {
+    // Uncompressed points are stored contiguously: read only the requested bytes
+    std::ifstream fs;
+    fs.open (file_name.c_str (), std::ios::binary);
+    if (!fs.is_open () || fs.fail ())
+    {
+      PCL_ERROR ("[pcl::PCDReader::readPointRange] Could not open file %s.\n", file_name.c_str ());
+      return (-1);
+    }
+    cloud.data.resize (static_cast<size_t> (nr_points) * cloud.point_step);
+    fs.seekg (data_idx + static_cast<std::streamoff> (first_point) * cloud.point_step);
+    if (!cloud.data.empty ())
+      fs.read (reinterpret_cast<char*> (&cloud.data[0]), cloud.data.size ());
+    if (fs.fail ())
+    {
+      PCL_ERROR ("[pcl::PCDReader::readPointRange] File %s is truncated!\n", file_name.c_str ());
+      return (-1);
+    }
+  }
+  else
+  {
+    // ASCII and binary_compressed data cannot be decoded partially
+    sensor_msgs::PointCloud2 full;
+    if (read (file_name, full, origin, orientation, pcd_version, offset) < 0)
+      return (-1);
+    cloud.data.assign (full.data.begin () + static_cast<size_t> (first_point) * full.point_step,
+                       full.data.begin () + (static_cast<size_t> (first_point) + nr_points) * full.point_step);
+  }
+
+  cloud.width    = nr_points;
+  cloud.height   = 1;
+  cloud.row_step = cloud.point_step * cloud.width;
+  cloud.is_dense = false;
+  return (0);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 std::string
 pcl::PCDWriter::generateHeaderASCII (const sensor_msgs::PointCloud2 &cloud, 
@@ -1674,6 +2025,54 @@ pcl::PCDWriter::generateHeaderBinary (const sensor_msgs::PointCloud2 &cloud,
   return (oss.str ());
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  /** \brief Append the DATA line of a BINARY PCD file to a header. The header is
+    * padded with a comment so that the data starts on a 16 byte boundary, which
+    * allows the points to be used in place when the file is memory mapped (see
+    * PCDMappedCloud).
+    */
+  void
+  appendDataBinary (std::ostringstream &oss)
+  {
+    std::streamoff padding = (16 - (static_cast<std::streamoff> (oss.tellp ()) + 12) % 16) % 16;
+    if (padding > 0)
+      oss << std::string (padding - 1, '#') << "\n";
+    oss << "DATA binary\n";
+  }
+
+  bool
+  compareFieldOffsets (const sensor_msgs::PointField &lhs, const sensor_msgs::PointField &rhs)
+  {
+    return (lhs.offset < rhs.offset);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string
+pcl::PCDWriter::generateHeaderBinaryAligned (const std::vector<sensor_msgs::PointField> &fields,
+                                             const uint32_t point_step,
+                                             const uint32_t width, const uint32_t height,
+                                             const Eigen::Vector4f &origin, 
+                                             const Eigen::Quaternionf &orientation)
+{
+  // generateHeaderBinary () fills the gaps between consecutive fields, so they
+  // have to be sorted by offset (e.g. rgb comes before the normal in PointXYZRGBNormal)
+  sensor_msgs::PointCloud2 layout;
+  layout.fields = fields;
+  std::sort (layout.fields.begin (), layout.fields.end (), compareFieldOffsets);
+  layout.point_step = point_step;
+  layout.width      = width;
+  layout.height     = height;
+
+  std::ostringstream oss;
+  oss.imbue (std::locale::classic ());
+  oss << generateHeaderBinary (layout, origin, orientation);
+  appendDataBinary (oss);
+  return (oss.str ());
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 std::string
 pcl::PCDWriter::generateHeaderBinaryCompressed (const sensor_msgs::PointCloud2 &cloud, 
@@ -1853,7 +2252,8 @@ pcl::PCDWriter::writeBinary (const std::string &file_name, const sensor_msgs::Po
   std::ostringstream oss;
   oss.imbue (std::locale::classic ());
 
-  oss << generateHeaderBinary (cloud, origin, orientation) << "DATA binary\n";
+  oss << generateHeaderBinary (cloud, origin, orientation);
+  appendDataBinary (oss);
   oss.flush();
   data_idx = static_cast<unsigned int> (oss.tellp ());
 
@@ -2142,6 +2542,91 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name, const senso
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDWriter::writeBinaryChunked (const std::string &file_name, const sensor_msgs::PointCloud2 &cloud,
+                                    const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation)
+{
+  if (cloud.data.empty ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryChunked] Input point cloud has no data!\n");
+    return (-1);
+  }
+
+  std::vector<sensor_msgs::PointField> fields;
+  std::vector<int> fields_sizes;
+  int fsize;
+  getStoredFields (cloud.fields, fields, fields_sizes, fsize);
+
+  const size_t nr_points = static_cast<size_t> (cloud.width) * cloud.height;
+  const unsigned int points_per_chunk = points_per_chunk_ > 0 ? points_per_chunk_ : 1;
+  const int nr_chunks = static_cast<int> ((nr_points + points_per_chunk - 1) / points_per_chunk);
+
+  // Every chunk holds the xxyyzz planes of its points and is compressed on its own
+  std::vector<std::vector<char> > chunks (nr_chunks);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads_ ? threads_ : omp_get_max_threads ())
+#endif
+  for (int c = 0; c < nr_chunks; ++c)
+  {
+    const size_t chunk_begin = static_cast<size_t> (c) * points_per_chunk;
+    const size_t chunk_points = std::min (static_cast<size_t> (points_per_chunk), nr_points - chunk_begin);
+    const size_t raw_size = chunk_points * fsize;
+
+    std::vector<char> soa (raw_size);
+    char *plane = &soa[0];
+    for (size_t j = 0; j < fields.size (); ++j)
+    {
+      const uint8_t *src = &cloud.data[chunk_begin * cloud.point_step + fields[j].offset];
+      for (size_t i = 0; i < chunk_points; ++i, plane += fields_sizes[j], src += cloud.point_step)
+        memcpy (plane, src, fields_sizes[j]);
+    }
+
+    // Chunks that LZF cannot shrink are stored raw: their stored size equals their raw size
+    std::vector<char> &chunk = chunks[c];
+    chunk.resize (raw_size);
+    unsigned int compressed_size = pcl::lzfCompress (&soa[0], static_cast<unsigned int> (raw_size),
+                                                     &chunk[0], static_cast<unsigned int> (raw_size - 1));
+    if (compressed_size == 0)
+      chunk.swap (soa);
+    else
+      chunk.resize (compressed_size);
+  }
+
+  std::ostringstream oss;
+  oss.imbue (std::locale::classic ());
+  oss << generateHeaderBinaryCompressed (cloud, origin, orientation);
+  oss << "CHUNKS " << points_per_chunk;
+  for (int c = 0; c < nr_chunks; ++c)
+    oss << " " << chunks[c].size ();
+  oss << "\nDATA binary_chunked\n";
+
+  std::ofstream fs;
+  fs.open (file_name.c_str (), std::ios::binary | std::ios::trunc);
+  if (!fs.is_open () || fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryChunked] Could not open file '%s' for writing! Error : %s\n", file_name.c_str (), strerror (errno));
+    return (-1);
+  }
+  // Mandatory lock file
+  boost::interprocess::file_lock file_lock;
+  setLockingPermissions (file_name, file_lock);
+
+  std::string header = oss.str ();
+  fs.write (header.c_str (), header.size ());
+  for (int c = 0; c < nr_chunks; ++c)
+    fs.write (&chunks[c][0], chunks[c].size ());
+  fs.close ();
+
+  resetLockingPermissions (file_name, file_lock);
+  if (fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryChunked] Error writing to file '%s'!\n", file_name.c_str ());
+    return (-1);
+  }
+  return (0);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 std::string
 pcl::PCDWriter::generateHeaderEigen (const pcl::PointCloud<Eigen::MatrixXf> &cloud, 
@@ -0,0 +1,181 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <fcntl.h>
+#include <pcl/io/boost.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/io/pcd_mapped_cloud.h>
+#include <pcl/console/print.h>
+
+#ifdef _WIN32
+# include <io.h>
+# include <windows.h>
+#else
+# include <sys/mman.h>
+#endif
+
+namespace
+{
+  // pcl_open/pcl_close expand to open/close, which would resolve to the
+  // PCDMappedFile members inside the class scope
+  int
+  openReadOnly (const std::string &file_name)
+  {
+    return (pcl_open (file_name.c_str (), O_RDONLY));
+  }
+
+  void
+  closeDescriptor (int fd)
+  {
+    pcl_close (fd);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::PCDMappedFile::PCDMappedFile ()
+  : header_ ()
+  , origin_ (Eigen::Vector4f::Zero ())
+  , orientation_ (Eigen::Quaternionf::Identity ())
+  , file_name_ ()
+  , map_ (NULL)
+  , map_size_ (0)
+  , data_ (NULL)
+#ifdef _WIN32
+  , file_mapping_ (NULL)
+#endif
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::PCDMappedFile::~PCDMappedFile ()
+{
+  close ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDMappedFile::open (const std::string &file_name, const int offset)
+{
+  close ();
+
+  pcl::PCDReader reader;
+  int pcd_version, data_type;
+  unsigned int data_idx;
+  if (reader.readHeader (file_name, header_, origin_, orientation_, pcd_version, data_type, data_idx, offset) < 0)
+    return (-1);
+
+  if (data_type != 1)
+  {
+    PCL_ERROR ("[pcl::PCDMappedFile::open] File %s is not stored in uncompressed binary format and cannot be mapped!\n", file_name.c_str ());
+    return (-1);
+  }
+
+  // The data is not scanned for NaN/Inf values, so density is unknown
+  header_.is_dense = false;
+
+  size_t data_size = size () * header_.point_step;
+  size_t file_size = static_cast<size_t> (boost::filesystem::file_size (file_name));
+  if (file_size < data_idx + data_size)
+  {
+    PCL_ERROR ("[pcl::PCDMappedFile::open] File %s is truncated: expected %lu bytes of data, found %lu!\n",
+               file_name.c_str (), static_cast<unsigned long> (data_size),
+               static_cast<unsigned long> (file_size > data_idx ? file_size - data_idx : 0));
+    return (-1);
+  }
+
+  int fd = openReadOnly (file_name);
+  if (fd == -1)
+  {
+    PCL_ERROR ("[pcl::PCDMappedFile::open] Failure to open file %s\n", file_name.c_str ());
+    return (-1);
+  }
+
+  map_size_ = data_idx + data_size;
+#ifdef _WIN32
+  HANDLE fm = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  map_ = (fm == NULL) ? NULL : static_cast<char*> (MapViewOfFile (fm, FILE_MAP_READ, 0, 0, map_size_));
+  if (map_ == NULL)
+  {
+    if (fm != NULL)
+      CloseHandle (fm);
+    closeDescriptor (fd);
+    map_size_ = 0;
+    PCL_ERROR ("[pcl::PCDMappedFile::open] Error mapping view of file, %s\n", file_name.c_str ());
+    return (-1);
+  }
+  file_mapping_ = fm;
+#else
+  // Shared, read-only pages: the mapping is backed directly by the page cache
+  map_ = static_cast<char*> (mmap (0, map_size_, PROT_READ, MAP_SHARED, fd, 0));
+  if (map_ == reinterpret_cast<char*> (-1))    // MAP_FAILED
+  {
+    map_ = NULL;
+    map_size_ = 0;
+    closeDescriptor (fd);
+    PCL_ERROR ("[pcl::PCDMappedFile::open] Error preparing mmap for binary PCD file %s.\n", file_name.c_str ());
+    return (-1);
+  }
+#endif
+  // The mapping stays valid after the descriptor is closed
+  closeDescriptor (fd);
+
+  data_ = reinterpret_cast<const uint8_t*> (map_ + data_idx);
+  file_name_ = file_name;
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDMappedFile::close ()
+{
+  if (map_ != NULL)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile (map_);
+    CloseHandle (static_cast<HANDLE> (file_mapping_));
+    file_mapping_ = NULL;
+#else
+    if (munmap (map_, map_size_) == -1)
+      PCL_ERROR ("[pcl::PCDMappedFile::close] Munmap failure\n");
+#endif
+  }
+  map_ = NULL;
+  map_size_ = 0;
+  data_ = NULL;
+  header_ = sensor_msgs::PointCloud2 ();
+  file_name_.clear ();
+}
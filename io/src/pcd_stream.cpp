@@ -0,0 +1,669 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/io/boost.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/io/pcd_stream.h>
+#include <pcl/io/lzf.h>
+#include <pcl/console/print.h>
+#include <cstring>
+#include <cerrno>
+
+namespace
+{
+  /** \brief Check whether all floating point values of the cloud are finite. */
+  bool
+  isDense (const sensor_msgs::PointCloud2 &cloud)
+  {
+    const size_t nr_points = static_cast<size_t> (cloud.width) * cloud.height;
+    for (size_t d = 0; d < cloud.fields.size (); ++d)
+    {
+      const sensor_msgs::PointField &field = cloud.fields[d];
+      if (field.name == "_")
+        continue;
+      for (size_t i = 0; i < nr_points; ++i)
+      {
+        for (unsigned int c = 0; c < field.count; ++c)
+        {
+          if (field.datatype == sensor_msgs::PointField::FLOAT32 &&
+              !pcl::isValueFinite<float> (cloud, static_cast<unsigned int> (i), cloud.point_step, static_cast<unsigned int> (d), c))
+            return (false);
+          if (field.datatype == sensor_msgs::PointField::FLOAT64 &&
+              !pcl::isValueFinite<double> (cloud, static_cast<unsigned int> (i), cloud.point_step, static_cast<unsigned int> (d), c))
+            return (false);
+        }
+      }
+    }
+    return (true);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::PCDStreamReader::PCDStreamReader ()
+  : file_name_ ()
+  , offset_ (0)
+  , header_ ()
+  , origin_ (Eigen::Vector4f::Zero ())
+  , orientation_ (Eigen::Quaternionf::Identity ())
+  , data_type_ (0)
+  , data_idx_ (0)
+  , fs_ ()
+  , cursor_ (0)
+  , ascii_position_ (0)
+  , block_size_ (0)
+  , block_index_ (-1)
+  , block_ ()
+  , chunk_offsets_ ()
+  , map_ ()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::PCDStreamReader::~PCDStreamReader ()
+{
+  close ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDStreamReader::open (const std::string &file_name, const int offset)
+{
+  close ();
+
+  pcl::PCDReader reader;
+  int pcd_version;
+  if (reader.readHeader (file_name, header_, origin_, orientation_, pcd_version, data_type_, data_idx_, offset) < 0)
+    return (-1);
+
+  if (data_type_ == 0 || data_type_ == 1)
+  {
+    fs_.open (file_name.c_str (), std::ios::binary);
+    if (!fs_.is_open () || fs_.fail ())
+    {
+      PCL_ERROR ("[pcl::PCDStreamReader::open] Could not open file %s.\n", file_name.c_str ());
+      return (-1);
+    }
+    fs_.seekg (data_idx_);
+  }
+  else if (data_type_ == 2)
+    block_size_ = getNumberOfPoints ();
+  else
+  {
+    // Parse the chunk index once, and keep the file mapped so that every
+    // block only decompresses its own chunk
+    unsigned int points_per_chunk;
+    if (reader.readChunkIndex (file_name, header_, data_idx_, points_per_chunk, chunk_offsets_, offset) < 0)
+      return (-1);
+    block_size_ = points_per_chunk;
+    try
+    {
+      boost::interprocess::file_mapping file (file_name.c_str (), boost::interprocess::read_only);
+      map_.reset (new boost::interprocess::mapped_region (file, boost::interprocess::read_only));
+    }
+    catch (const boost::interprocess::interprocess_exception &e)
+    {
+      PCL_ERROR ("[pcl::PCDStreamReader::open] Error mapping file %s: %s\n", file_name.c_str (), e.what ());
+      return (-1);
+    }
+    if (map_->get_size () < data_idx_ + chunk_offsets_.back ())
+    {
+      PCL_ERROR ("[pcl::PCDStreamReader::open] File %s is truncated!\n", file_name.c_str ());
+      map_.reset ();
+      return (-1);
+    }
+  }
+
+  file_name_ = file_name;
+  offset_ = offset;
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDStreamReader::close ()
+{
+  if (fs_.is_open ())
+    fs_.close ();
+  fs_.clear ();
+  file_name_.clear ();
+  header_ = sensor_msgs::PointCloud2 ();
+  cursor_ = ascii_position_ = block_size_ = 0;
+  block_index_ = -1;
+  std::vector<uint8_t> ().swap (block_);
+  chunk_offsets_.clear ();
+  map_.reset ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDStreamReader::seek (size_t point_index)
+{
+  if (!isOpen () || point_index > getNumberOfPoints ())
+  {
+    PCL_ERROR ("[pcl::PCDStreamReader::seek] Cannot seek to point %lu!\n", static_cast<unsigned long> (point_index));
+    return (-1);
+  }
+  cursor_ = point_index;
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDStreamReader::read (sensor_msgs::PointCloud2 &cloud, const unsigned int nr_points)
+{
+  if (!isOpen ())
+  {
+    PCL_ERROR ("[pcl::PCDStreamReader::read] No file open!\n");
+    return (-1);
+  }
+
+  const size_t n = std::min (static_cast<size_t> (nr_points), getNumberOfPoints () - cursor_);
+  cloud.header     = header_.header;
+  cloud.fields     = header_.fields;
+  cloud.point_step = header_.point_step;
+  cloud.is_bigendian = header_.is_bigendian;
+  cloud.width      = static_cast<uint32_t> (n);
+  cloud.height     = 1;
+  cloud.row_step   = cloud.point_step * cloud.width;
+  cloud.data.resize (n * cloud.point_step);
+  if (n == 0)
+  {
+    cloud.is_dense = true;
+    return (0);
+  }
+
+  switch (data_type_)
+  {
+    case 0:
+    {
+      if (readASCII (cloud, n) < 0)
+        return (-1);
+      break;
+    }
+    case 1:
+    {
+      fs_.clear ();
+      fs_.seekg (data_idx_ + static_cast<std::streamoff> (cursor_) * cloud.point_step);
+      fs_.read (reinterpret_cast<char*> (&cloud.data[0]), cloud.data.size ());
+      if (fs_.fail ())
+      {
+        PCL_ERROR ("[pcl::PCDStreamReader::read] File %s is truncated!\n", file_name_.c_str ());
+        return (-1);
+      }
+      break;
+    }
+    default:
+    {
+      // Copy from the decoded blocks, loading the next block when needed
+      size_t copied = 0;
+      while (copied < n)
+      {
+        const size_t point_index = cursor_ + copied;
+        if (loadBlock (point_index) < 0)
+          return (-1);
+        const size_t block_begin = static_cast<size_t> (block_index_) * block_size_;
+        const size_t in_block = std::min (n - copied, block_begin + block_size_ - point_index);
+        memcpy (&cloud.data[copied * cloud.point_step],
+                &block_[(point_index - block_begin) * cloud.point_step],
+                in_block * cloud.point_step);
+        copied += in_block;
+      }
+      break;
+    }
+  }
+
+  cloud.is_dense = isDense (cloud);
+  cursor_ += n;
+  return (static_cast<int> (n));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDStreamReader::readASCII (sensor_msgs::PointCloud2 &cloud, const size_t nr_points)
+{
+  std::string line;
+  // Seeking backwards restarts from the beginning of the data
+  if (cursor_ < ascii_position_)
+  {
+    fs_.clear ();
+    fs_.seekg (data_idx_);
+    ascii_position_ = 0;
+  }
+  while (ascii_position_ < cursor_ && getline (fs_, line))
+  {
+    boost::trim (line);
+    if (!line.empty ())
+      ++ascii_position_;
+  }
+
+  std::vector<std::string> st;
+  size_t idx = 0;
+  try
+  {
+    while (idx < nr_points && getline (fs_, line))
+    {
+      // Ignore empty lines
+      boost::trim (line);
+      if (line.empty ())
+        continue;
+      boost::split (st, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
+
+      const unsigned int i = static_cast<unsigned int> (idx);
+      size_t total = 0;
+      for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
+      {
+        // Ignore invalid padded dimensions that are inherited from binary data
+        if (cloud.fields[d].name == "_")
+        {
+          total += cloud.fields[d].count; // jump over this many elements in the string token
+          continue;
+        }
+        for (unsigned int c = 0; c < cloud.fields[d].count; ++c)
+        {
+          switch (cloud.fields[d].datatype)
+          {
+            case sensor_msgs::PointField::INT8:
+              copyStringValue<pcl::traits::asType<sensor_msgs::PointField::INT8>::type> (st.at (total + c), cloud, i, d, c);
+              break;
+            case sensor_msgs::PointField::UINT8:
+              copyStringValue<pcl::traits::asType<sensor_msgs::PointField::UINT8>::type> (st.at (total + c), cloud, i, d, c);
+              break;
+            case sensor_msgs::PointField::INT16:
+              copyStringValue<pcl::traits::asType<sensor_msgs::PointField::INT16>::type> (st.at (total + c), cloud, i, d, c);
+              break;
+            case sensor_msgs::PointField::UINT16:
+              copyStringValue<pcl::traits::asType<sensor_msgs::PointField::UINT16>::type> (st.at (total + c), cloud, i, d, c);
+              break;
+            case sensor_msgs::PointField::INT32:
+              copyStringValue<pcl::traits::asType<sensor_msgs::PointField::INT32>::type> (st.at (total + c), cloud, i, d, c);
+              break;
+            case sensor_msgs::PointField::UINT32:
+              copyStringValue<pcl::traits::asType<sensor_msgs::PointField::UINT32>::type> (st.at (total + c), cloud, i, d, c);
+              break;
+            case sensor_msgs::PointField::FLOAT32:
+              copyStringValue<pcl::traits::asType<sensor_msgs::PointField::FLOAT32>::type> (st.at (total + c), cloud, i, d, c);
+              break;
+            case sensor_msgs::PointField::FLOAT64:
+              copyStringValue<pcl::traits::asType<sensor_msgs::PointField::FLOAT64>::type> (st.at (total + c), cloud, i, d, c);
+              break;
+            default:
+              PCL_WARN ("[pcl::PCDStreamReader::readASCII] Incorrect field data type specified (%d)!\n", cloud.fields[d].datatype);
+              break;
+          }
+        }
+        total += cloud.fields[d].count; // jump over this many elements in the string token
+      }
+      ++idx;
+    }
+  }
+  catch (const std::out_of_range &)
+  {
+    PCL_ERROR ("[pcl::PCDStreamReader::readASCII] Not enough values for point %lu in %s!\n",
+               static_cast<unsigned long> (cursor_ + idx), file_name_.c_str ());
+    return (-1);
+  }
+
+  ascii_position_ += idx;
+  if (idx != nr_points)
+  {
+    PCL_ERROR ("[pcl::PCDStreamReader::readASCII] Number of points read (%lu) is different than expected (%lu)\n",
+               static_cast<unsigned long> (cursor_ + idx), static_cast<unsigned long> (cursor_ + nr_points));
+    return (-1);
+  }
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDStreamReader::loadBlock (const size_t point_index)
+{
+  const int block_index = static_cast<int> (point_index / block_size_);
+  if (block_index == block_index_)
+    return (0);
+
+  pcl::PCDReader reader;
+  if (data_type_ == 2)
+  {
+    sensor_msgs::PointCloud2 blob;
+    Eigen::Vector4f origin;
+    Eigen::Quaternionf orientation;
+    int pcd_version;
+    if (reader.read (file_name_, blob, origin, orientation, pcd_version, offset_) < 0)
+      return (-1);
+    block_.swap (blob.data);
+  }
+  else
+  {
+    const size_t first = static_cast<size_t> (block_index) * block_size_;
+    const size_t count = std::min (block_size_, getNumberOfPoints () - first);
+    const char *data = static_cast<const char*> (map_->get_address ()) + data_idx_;
+    if (reader.decodeChunks (data, header_, static_cast<unsigned int> (block_size_), chunk_offsets_, first, count, block_) < 0)
+    {
+      block_index_ = -1;
+      return (-1);
+    }
+  }
+  block_index_ = block_index;
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::PCDStreamWriter::PCDStreamWriter ()
+  : file_name_ ()
+  , fs_ ()
+  , layout_ ()
+  , origin_ (Eigen::Vector4f::Zero ())
+  , orientation_ (Eigen::Quaternionf::Identity ())
+  , data_type_ (BINARY)
+  , precision_ (8)
+  , points_per_chunk_ (65536)
+  , header_size_ (0)
+  , nr_points_ (0)
+  , pending_ ()
+  , chunk_sizes_ ()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::PCDStreamWriter::~PCDStreamWriter ()
+{
+  if (isOpen ())
+    close ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string
+pcl::PCDStreamWriter::generateHeader (const size_t nr_points, const size_t data_size) const
+{
+  sensor_msgs::PointCloud2 cloud = layout_;
+  cloud.width  = static_cast<uint32_t> (nr_points);
+  cloud.height = 1;
+  cloud.row_step = cloud.point_step * cloud.width;
+
+  pcl::PCDWriter writer;
+  switch (data_type_)
+  {
+    case ASCII:
+      return (writer.generateHeaderASCII (cloud, origin_, orientation_) + "DATA ascii\n");
+    case BINARY:
+      return (writer.generateHeaderBinary (cloud, origin_, orientation_) + "DATA binary\n");
+    default:
+    {
+      std::ostringstream oss;
+      oss.imbue (std::locale::classic ());
+      oss << writer.generateHeaderBinaryCompressed (cloud, origin_, orientation_);
+      // The chunk sizes are written after the data, data_size bytes into the data section
+      oss << "CHUNKS " << points_per_chunk_ << " INDEX " << data_size;
+      oss << "\nDATA binary_chunked\n";
+      return (oss.str ());
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDStreamWriter::open (const std::string &file_name, const sensor_msgs::PointCloud2 &layout,
+                            const DataType data_type,
+                            const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation)
+{
+  if (isOpen ())
+    close ();
+
+  if (layout.fields.empty () || layout.point_step == 0)
+  {
+    PCL_ERROR ("[pcl::PCDStreamWriter::open] Invalid point layout given for %s!\n", file_name.c_str ());
+    return (-1);
+  }
+
+  layout_.fields     = layout.fields;
+  layout_.point_step = layout.point_step;
+  layout_.is_bigendian = layout.is_bigendian;
+  origin_      = origin;
+  orientation_ = orientation;
+  data_type_   = data_type;
+  nr_points_   = 0;
+  pending_.clear ();
+  chunk_sizes_.clear ();
+
+  // Reserve room for the largest possible WIDTH/POINTS values (and index
+  // position), rounded up so the data starts on a 16 byte boundary
+  header_size_ = generateHeader (std::numeric_limits<uint32_t>::max (), std::numeric_limits<size_t>::max ()).size ();
+  header_size_ = (header_size_ + 15) / 16 * 16;
+
+  fs_.open (file_name.c_str (), std::ios::binary | std::ios::trunc);
+  if (!fs_.is_open () || fs_.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDStreamWriter::open] Could not open file '%s' for writing! Error : %s\n", file_name.c_str (), strerror (errno));
+    return (-1);
+  }
+  // The header is written by close (), once the number of points is known
+  fs_ << std::string (header_size_, '\n');
+  file_name_ = file_name;
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDStreamWriter::write (const sensor_msgs::PointCloud2 &cloud)
+{
+  if (!isOpen ())
+  {
+    PCL_ERROR ("[pcl::PCDStreamWriter::write] No file open!\n");
+    return (-1);
+  }
+  if (cloud.point_step != layout_.point_step || cloud.fields.size () != layout_.fields.size ())
+  {
+    PCL_ERROR ("[pcl::PCDStreamWriter::write] The layout of the points differs from the one given to open ()!\n");
+    return (-1);
+  }
+
+  const size_t nr_points = static_cast<size_t> (cloud.width) * cloud.height;
+  if (nr_points == 0)
+    return (0);
+
+  switch (data_type_)
+  {
+    case ASCII:
+    {
+      std::ostringstream stream;
+      stream.precision (precision_);
+      stream.imbue (std::locale::classic ());
+      const int point_size = static_cast<int> (cloud.point_step);
+      for (unsigned int i = 0; i < nr_points; ++i)
+      {
+        for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
+        {
+          // Ignore invalid padded dimensions that are inherited from binary data
+          if (cloud.fields[d].name == "_")
+            continue;
+
+          int count = cloud.fields[d].count;
+          if (count == 0)
+            count = 1;          // we simply cannot tolerate 0 counts (coming from older converter code)
+
+          for (int c = 0; c < count; ++c)
+          {
+            switch (cloud.fields[d].datatype)
+            {
+              case sensor_msgs::PointField::INT8:
+                copyValueString<pcl::traits::asType<sensor_msgs::PointField::INT8>::type> (cloud, i, point_size, d, c, stream);
+                break;
+              case sensor_msgs::PointField::UINT8:
+                copyValueString<pcl::traits::asType<sensor_msgs::PointField::UINT8>::type> (cloud, i, point_size, d, c, stream);
+                break;
+              case sensor_msgs::PointField::INT16:
+                copyValueString<pcl::traits::asType<sensor_msgs::PointField::INT16>::type> (cloud, i, point_size, d, c, stream);
+                break;
+              case sensor_msgs::PointField::UINT16:
+                copyValueString<pcl::traits::asType<sensor_msgs::PointField::UINT16>::type> (cloud, i, point_size, d, c, stream);
+                break;
+              case sensor_msgs::PointField::INT32:
+                copyValueString<pcl::traits::asType<sensor_msgs::PointField::INT32>::type> (cloud, i, point_size, d, c, stream);
+                break;
+              case sensor_msgs::PointField::UINT32:
+                copyValueString<pcl::traits::asType<sensor_msgs::PointField::UINT32>::type> (cloud, i, point_size, d, c, stream);
+                break;
+              case sensor_msgs::PointField::FLOAT32:
+                copyValueString<pcl::traits::asType<sensor_msgs::PointField::FLOAT32>::type> (cloud, i, point_size, d, c, stream);
+                break;
+              case sensor_msgs::PointField::FLOAT64:
+                copyValueString<pcl::traits::asType<sensor_msgs::PointField::FLOAT64>::type> (cloud, i, point_size, d, c, stream);
+                break;
+              default:
+                PCL_WARN ("[pcl::PCDStreamWriter::write] Incorrect field data type specified (%d)!\n", cloud.fields[d].datatype);
+                break;
+            }
+            stream << " ";
+          }
+        }
+        // Copy the stream, trim it, and write it to disk
+        std::string result = stream.str ();
+        boost::trim (result);
+        stream.str ("");
+        fs_ << result << "\n";
+      }
+      break;
+    }
+    case BINARY:
+    {
+      fs_.write (reinterpret_cast<const char*> (&cloud.data[0]), nr_points * cloud.point_step);
+      break;
+    }
+    default:
+    {
+      pending_.insert (pending_.end (), cloud.data.begin (), cloud.data.begin () + nr_points * cloud.point_step);
+      // Compress all complete chunks
+      const size_t chunk_bytes = static_cast<size_t> (points_per_chunk_) * layout_.point_step;
+      size_t flushed = 0;
+      while (pending_.size () - flushed >= chunk_bytes)
+      {
+        if (flushChunk (flushed / layout_.point_step, points_per_chunk_) < 0)
+          return (-1);
+        flushed += chunk_bytes;
+      }
+      pending_.erase (pending_.begin (), pending_.begin () + flushed);
+      break;
+    }
+  }
+
+  if (fs_.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDStreamWriter::write] Error writing to file '%s'!\n", file_name_.c_str ());
+    return (-1);
+  }
+  nr_points_ += nr_points;
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDStreamWriter::flushChunk (const size_t first, const size_t nr_points)
+{
+  // Convert the pending xyzxyz points to xxyyzz planes, skipping padding
+  std::vector<char> soa;
+  soa.reserve (nr_points * layout_.point_step);
+  for (size_t d = 0; d < layout_.fields.size (); ++d)
+  {
+    const sensor_msgs::PointField &field = layout_.fields[d];
+    if (field.name == "_")
+      continue;
+    const size_t field_size = field.count * pcl::getFieldSize (field.datatype);
+    const uint8_t *src = &pending_[first * layout_.point_step + field.offset];
+    for (size_t i = 0; i < nr_points; ++i, src += layout_.point_step)
+      soa.insert (soa.end (), src, src + field_size);
+  }
+
+  // Chunks that LZF cannot shrink are stored raw: their stored size equals their raw size
+  std::vector<char> chunk (soa.size ());
+  unsigned int compressed_size = soa.empty () ? 0 :
+    pcl::lzfCompress (&soa[0], static_cast<unsigned int> (soa.size ()),
+                      &chunk[0], static_cast<unsigned int> (soa.size () - 1));
+  if (compressed_size == 0)
+    chunk.swap (soa);
+  else
+    chunk.resize (compressed_size);
+
+  if (!chunk.empty ())
+    fs_.write (&chunk[0], chunk.size ());
+  chunk_sizes_.push_back (chunk.size ());
+  return (fs_.fail () ? -1 : 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDStreamWriter::close ()
+{
+  if (!isOpen ())
+    return (-1);
+
+  int res = 0;
+  size_t data_size = 0;
+  if (data_type_ == BINARY_CHUNKED)
+  {
+    if (!pending_.empty ())
+      res = flushChunk (0, pending_.size () / layout_.point_step);
+    // Append the chunk index after the data
+    std::vector<uint64_t> chunk_sizes (chunk_sizes_.begin (), chunk_sizes_.end ());
+    for (size_t c = 0; c < chunk_sizes_.size (); ++c)
+      data_size += chunk_sizes_[c];
+    if (!chunk_sizes.empty ())
+      fs_.write (reinterpret_cast<const char*> (&chunk_sizes[0]), chunk_sizes.size () * sizeof (uint64_t));
+  }
+  std::vector<uint8_t> ().swap (pending_);
+
+  // Pad the header with a comment line so that it fills the reserved space exactly
+  const std::string header = generateHeader (nr_points_, data_size);
+  const size_t padding = header_size_ - header.size ();
+  const size_t data_line = header.rfind ("DATA");
+  std::string padded = header.substr (0, data_line);
+  if (padding > 0)
+    padded += std::string (padding - 1, '#') + "\n";
+  padded += header.substr (data_line);
+
+  fs_.seekp (0);
+  fs_.write (padded.c_str (), padded.size ());
+  fs_.close ();
+
+  if (fs_.fail ())
+    res = -1;
+  if (res < 0)
+    PCL_ERROR ("[pcl::PCDStreamWriter::close] Error writing to file '%s'!\n", file_name_.c_str ());
+  fs_.clear ();
+  file_name_.clear ();
+  chunk_sizes_.clear ();
+  return (res);
+}
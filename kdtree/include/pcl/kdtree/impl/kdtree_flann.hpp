@@ -40,6 +40,9 @@
 
 #include <pcl/kdtree/kdtree_flann.h>
 #include <pcl/console/print.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist> void 
@@ -80,28 +83,51 @@ pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointT &point, int k,
                                                 std::vector<int> &k_indices, 
                                                 std::vector<float> &k_distances) const
 {
-  assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
-
   if (k > total_nr_points_)
     k = total_nr_points_;
 
   k_indices.resize (k);
   k_distances.resize (k);
+  if (k <= 0)
+    return (0);
 
-  std::vector<float> query (dim_);
+  // Wrap the k_indices and k_distances vectors (no data copy)
+  return (nearestKSearch (point, k, &k_indices[0], &k_distances[0]));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int 
+pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointT &point, int k, 
+                                                int *k_indices, float *k_distances) const
+{
+  assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  if (k > total_nr_points_)
+    k = total_nr_points_;
+  if (k <= 0)
+    return (0);
+
+  // Vectorize the query on the stack, unless the point representation is unusually large
+  float query_buffer[32];
+  std::vector<float> query_storage;
+  float *query = query_buffer;
+  if (dim_ > 32)
+  {
+    query_storage.resize (dim_);
+    query = &query_storage[0];
+  }
   point_representation_->vectorize (static_cast<PointT> (point), query);
 
-  flann::Matrix<int> k_indices_mat (&k_indices[0], 1, k);
-  flann::Matrix<float> k_distances_mat (&k_distances[0], 1, k);
-  // Wrap the k_indices and k_distances vectors (no data copy)
-  flann_index_->knnSearch (flann::Matrix<float> (&query[0], 1, dim_), 
+  flann::Matrix<int> k_indices_mat (k_indices, 1, k);
+  flann::Matrix<float> k_distances_mat (k_distances, 1, k);
+  flann_index_->knnSearch (flann::Matrix<float> (query, 1, dim_), 
                            k_indices_mat, k_distances_mat,
                            k, param_k_);
 
   // Do mapping to original point cloud
   if (!identity_mapping_) 
   {
-    for (size_t i = 0; i < static_cast<size_t> (k); ++i)
+    for (int i = 0; i < k; ++i)
     {
       int& neighbor_index = k_indices[i];
       neighbor_index = index_mapping_[neighbor_index];
@@ -156,6 +182,235 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
   return (neighbors_in_radius);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int 
+pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                                                NeighborsCSR &neighbors) const
+{
+  std::vector<float> queries;
+  int nr_valid = convertQueriesToArray (cloud, indices, queries, neighbors.offsets);
+  int nr_queries = static_cast<int> (neighbors.offsets.size ()) - 1;
+
+  if (k > total_nr_points_)
+    k = total_nr_points_;
+  if (k <= 0 || nr_valid == 0)
+  {
+    neighbors.offsets.assign (nr_queries + 1, 0);
+    neighbors.indices.clear ();
+    neighbors.sqr_distances.clear ();
+    return (0);
+  }
+
+  // The valid queries are consecutive rows and each one gets exactly k neighbors, so FLANN can write
+  // straight into the flat result buffers
+  neighbors.indices.resize (static_cast<size_t> (nr_valid) * k);
+  neighbors.sqr_distances.resize (static_cast<size_t> (nr_valid) * k);
+
+  flann::Matrix<int> k_indices_mat (&neighbors.indices[0], nr_valid, k);
+  flann::Matrix<float> k_distances_mat (&neighbors.sqr_distances[0], nr_valid, k);
+  flann::SearchParams params (param_k_);
+  const int nr_threads = getNumberOfBatchThreads ();
+  params.cores = nr_threads;
+  flann_index_->knnSearch (flann::Matrix<float> (&queries[0], nr_valid, dim_), 
+                           k_indices_mat, k_distances_mat,
+                           k, params);
+
+  // Convert the query rows into neighbor offsets
+  for (int i = 0; i <= nr_queries; ++i)
+    neighbors.offsets[i] *= k;
+
+  // Do mapping to original point cloud
+  if (!identity_mapping_) 
+  {
+    const int nr_neighbors = static_cast<int> (neighbors.indices.size ());
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads)
+#endif
+    for (int i = 0; i < nr_neighbors; ++i)
+      neighbors.indices[i] = index_mapping_[neighbors.indices[i]];
+  }
+
+  return (nr_valid * k);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int 
+pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius, int *k_indices,
+                                              float *k_sqr_dists, int capacity, unsigned int max_nn) const
+{
+  assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  // Has max_nn been set properly?
+  if (max_nn == 0 || max_nn > static_cast<unsigned int> (total_nr_points_))
+    max_nn = total_nr_points_;
+  if (capacity > static_cast<int> (max_nn))
+    capacity = static_cast<int> (max_nn);
+  if (capacity <= 0)
+    return (0);
+
+  // Vectorize the query on the stack, unless the point representation is unusually large
+  float query_buffer[32];
+  std::vector<float> query_storage;
+  float *query = query_buffer;
+  if (dim_ > 32)
+  {
+    query_storage.resize (dim_);
+    query = &query_storage[0];
+  }
+  point_representation_->vectorize (static_cast<PointT> (point), query);
+
+  // FLANN fills the rows of the result matrices directly, keeping the closest neighbors if they do not fit
+  flann::SearchParams params (param_radius_);
+  if (capacity == total_nr_points_)
+    params.max_neighbors = -1;  // return all neighbors in radius
+  else
+    params.max_neighbors = capacity;
+
+  flann::Matrix<int> k_indices_mat (k_indices, 1, capacity);
+  flann::Matrix<float> k_distances_mat (k_sqr_dists, 1, capacity);
+  int neighbors_in_radius = flann_index_->radiusSearch (flann::Matrix<float> (query, 1, dim_),
+                                                        k_indices_mat, k_distances_mat,
+                                                        static_cast<float> (radius * radius),
+                                                        params);
+  if (neighbors_in_radius > capacity)
+    neighbors_in_radius = capacity;
+
+  // Do mapping to original point cloud
+  if (!identity_mapping_) 
+  {
+    for (int i = 0; i < neighbors_in_radius; ++i)
+    {
+      int& neighbor_index = k_indices[i];
+      neighbor_index = index_mapping_[neighbor_index];
+    }
+  }
+
+  return (neighbors_in_radius);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int 
+pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                                              NeighborsCSR &neighbors, unsigned int max_nn) const
+{
+  std::vector<float> queries;
+  int nr_valid = convertQueriesToArray (cloud, indices, queries, neighbors.offsets);
+  int nr_queries = static_cast<int> (neighbors.offsets.size ()) - 1;
+
+  if (nr_valid == 0 || total_nr_points_ == 0)
+  {
+    neighbors.offsets.assign (nr_queries + 1, 0);
+    neighbors.indices.clear ();
+    neighbors.sqr_distances.clear ();
+    return (0);
+  }
+
+  // Has max_nn been set properly?
+  if (max_nn == 0 || max_nn > static_cast<unsigned int> (total_nr_points_))
+    max_nn = total_nr_points_;
+
+  flann::SearchParams params (param_radius_);
+  if (max_nn == static_cast<unsigned int> (total_nr_points_))
+    params.max_neighbors = -1;  // return all neighbors in radius
+  else
+    params.max_neighbors = max_nn;
+  const int nr_threads = getNumberOfBatchThreads ();
+  params.cores = nr_threads;
+
+  // The number of neighbors per query is not known beforehand, so let FLANN size the rows
+  std::vector<std::vector<int> > rows_indices (nr_valid);
+  std::vector<std::vector<float> > rows_dists (nr_valid);
+  flann_index_->radiusSearch (flann::Matrix<float> (&queries[0], nr_valid, dim_),
+                              rows_indices, rows_dists,
+                              static_cast<float> (radius * radius), 
+                              params);
+
+  // Convert the query rows into neighbor offsets
+  std::vector<int> rows (neighbors.offsets);
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    int nr_found = 0;
+    if (rows[i + 1] != rows[i])
+      nr_found = static_cast<int> (rows_indices[rows[i]].size ());
+    neighbors.offsets[i + 1] = neighbors.offsets[i] + nr_found;
+  }
+  neighbors.indices.resize (neighbors.offsets[nr_queries]);
+  neighbors.sqr_distances.resize (neighbors.offsets[nr_queries]);
+
+  // Flatten the rows, and do mapping to original point cloud
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads)
+#endif
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    if (rows[i + 1] == rows[i])
+      continue;
+    const std::vector<int> &row_indices = rows_indices[rows[i]];
+    const std::vector<float> &row_dists = rows_dists[rows[i]];
+    for (size_t j = 0; j < row_indices.size (); ++j)
+    {
+      neighbors.indices[neighbors.offsets[i] + j] = identity_mapping_ ? row_indices[j] : index_mapping_[row_indices[j]];
+      neighbors.sqr_distances[neighbors.offsets[i] + j] = row_dists[j];
+    }
+  }
+
+  return (neighbors.offsets[nr_queries]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int 
+pcl::KdTreeFLANN<PointT, Dist>::getNumberOfBatchThreads () const
+{
+  if (threads_ != 0)
+    return (static_cast<int> (threads_));
+#ifdef _OPENMP
+  return (omp_get_max_threads ());
+#else
+  return (1);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int 
+pcl::KdTreeFLANN<PointT, Dist>::convertQueriesToArray (const PointCloud &cloud, const std::vector<int> &indices,
+                                                       std::vector<float> &queries, std::vector<int> &rows) const
+{
+  const int nr_queries = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+#ifdef _OPENMP
+  const int nr_threads = getNumberOfBatchThreads ();
+#endif
+  rows.resize (nr_queries + 1);
+  rows[0] = 0;
+
+  // Flag the valid queries
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads)
+#endif
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    const PointT &point = cloud.points[indices.empty () ? i : indices[i]];
+    rows[i + 1] = point_representation_->isValid (point) ? 1 : 0;
+  }
+
+  // Turn the flags into rows
+  for (int i = 0; i < nr_queries; ++i)
+    rows[i + 1] += rows[i];
+
+  queries.resize (static_cast<size_t> (rows[nr_queries]) * dim_);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads)
+#endif
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    if (rows[i + 1] == rows[i])
+      continue;
+    float* query_ptr = &queries[static_cast<size_t> (rows[i]) * dim_];
+    point_representation_->vectorize (cloud.points[indices.empty () ? i : indices[i]], query_ptr);
+  }
+
+  return (rows[nr_queries]);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist> void 
 pcl::KdTreeFLANN<PointT, Dist>::cleanup ()
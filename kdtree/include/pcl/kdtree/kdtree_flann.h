@@ -47,6 +47,36 @@
 
 namespace pcl
 {
+  /** \brief Flat (compressed sparse row) storage for the results of a batch of neighbor queries. The neighbors
+    * of the i-th query are stored in \a indices and \a sqr_distances, in the range [offsets[i], offsets[i+1]).
+    * \ingroup kdtree
+    */
+  struct NeighborsCSR
+  {
+    /** \brief Start of the neighbors of each query. Holds one element more than the number of queries. */
+    std::vector<int> offsets;
+
+    /** \brief The indices of the neighboring points, for all queries. */
+    std::vector<int> indices;
+
+    /** \brief The squared distances to the neighboring points, for all queries. */
+    std::vector<float> sqr_distances;
+
+    /** \brief Get the number of queries stored. */
+    inline size_t
+    size () const { return (offsets.empty () ? 0 : offsets.size () - 1); }
+
+    /** \brief Get the number of neighbors found for the given query.
+      * \param[in] query the index of the query
+      */
+    inline int
+    getNumberOfNeighbors (size_t query) const { return (offsets[query + 1] - offsets[query]); }
+
+    /** \brief Remove all the queries. */
+    inline void
+    clear () { offsets.clear (); indices.clear (); sqr_distances.clear (); }
+  };
+
   /** \brief KdTreeFLANN is a generic type of 3D spatial locator using kD-tree structures. The class is making use of
     * the FLANN (Fast Library for Approximate Nearest Neighbor) project by Marius Muja and David Lowe.
     *
@@ -88,7 +118,8 @@ namespace pcl
         index_mapping_ (), identity_mapping_ (false),
         dim_ (0), total_nr_points_ (0),
         param_k_ (flann::SearchParams (-1 , epsilon_)),
-        param_radius_ (flann::SearchParams (-1, epsilon_, sorted))
+        param_radius_ (flann::SearchParams (-1, epsilon_, sorted)),
+        threads_ (0)
       {
       }
 
@@ -101,7 +132,8 @@ namespace pcl
         index_mapping_ (), identity_mapping_ (false),
         dim_ (0), total_nr_points_ (0),
         param_k_ (flann::SearchParams (-1 , epsilon_)),
-        param_radius_ (flann::SearchParams (-1, epsilon_, false))
+        param_radius_ (flann::SearchParams (-1, epsilon_, false)),
+        threads_ (0)
       {
         *this = k;
       }
@@ -121,6 +153,7 @@ namespace pcl
         total_nr_points_ = k.total_nr_points_;
         param_k_ = k.param_k_;
         param_radius_ = k.param_radius_;
+        threads_ = k.threads_;
         return (*this);
       }
 
@@ -135,6 +168,16 @@ namespace pcl
         param_radius_ = flann::SearchParams (-1 , epsilon_, sorted_);
       }
 
+      /** \brief Set the number of threads used by the batch searches.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads used by the batch searches (0 means automatic). */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       inline void 
       setSortedResults (bool sorted)
       {
@@ -178,6 +221,19 @@ namespace pcl
       nearestKSearch (const PointT &point, int k, 
                       std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const;
 
+      /** \brief Search for k-nearest neighbors for the given query point, writing into caller-provided buffers.
+        * No heap allocation is performed for point representations of up to 32 dimensions.
+        * 
+        * \param[in] point a given \a valid (i.e., finite) query point
+        * \param[in] k the number of neighbors to search for
+        * \param[out] k_indices the resultant indices of the neighboring points (room for at least \a k elements)
+        * \param[out] k_sqr_distances the resultant squared distances to the neighboring points (room for at least
+        * \a k elements)
+        * \return number of neighbors found, i.e., \a k clamped to the number of points in the tree
+        */
+      int 
+      nearestKSearch (const PointT &point, int k, int *k_indices, float *k_sqr_distances) const;
+
       /** \brief Search for all the nearest neighbors of the query point in a given radius.
         * 
         * \attention This method does not do any bounds checking for the input index
@@ -198,11 +254,78 @@ namespace pcl
       radiusSearch (const PointT &point, double radius, std::vector<int> &k_indices,
                     std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
 
+      /** \brief Search for the nearest neighbors of the query point in a given radius, writing into caller-provided
+        * buffers. At most \a capacity neighbors are written; if the radius holds more points, the closest ones are
+        * kept, so a result of exactly \a capacity neighbors may be truncated and should be repeated with more room.
+        * No heap allocation is performed by PCL for point representations of up to 32 dimensions.
+        *
+        * \param[in] point a given \a valid (i.e., finite) query point
+        * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+        * \param[out] k_indices the resultant indices of the neighboring points (room for \a capacity elements)
+        * \param[out] k_sqr_distances the resultant squared distances to the neighboring points (room for
+        * \a capacity elements)
+        * \param[in] capacity the number of elements available in \a k_indices and \a k_sqr_distances
+        * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+        * \return number of neighbors written
+        */
+      int 
+      radiusSearch (const PointT &point, double radius, int *k_indices, float *k_sqr_distances,
+                    int capacity, unsigned int max_nn = 0) const;
+
+      /** \brief Search for the k-nearest neighbors of a batch of query points. All the queries are handed to
+        * FLANN at once and processed in parallel, and the results are written into flat buffers.
+        *
+        * Invalid (i.e., non-finite) query points get no neighbors.
+        *
+        * \param[in] cloud the point cloud holding the query points
+        * \param[in] indices the indices in \a cloud of the query points - if empty, every point in \a cloud is a query
+        * \param[in] k the number of neighbors to search for
+        * \param[out] neighbors the resultant neighbors, neighbors.offsets[i] corresponds to the i-th query point
+        * \return the total number of neighbors found
+        */
+      int
+      nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                      NeighborsCSR &neighbors) const;
+
+      /** \brief Search for all the nearest neighbors of a batch of query points in a given radius. All the queries
+        * are handed to FLANN at once and processed in parallel, and the results are written into flat buffers.
+        *
+        * Invalid (i.e., non-finite) query points get no neighbors.
+        *
+        * \param[in] cloud the point cloud holding the query points
+        * \param[in] indices the indices in \a cloud of the query points - if empty, every point in \a cloud is a query
+        * \param[in] radius the radius of the sphere bounding all of the neighbors of a query point
+        * \param[out] neighbors the resultant neighbors, neighbors.offsets[i] corresponds to the i-th query point
+        * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value. If \a max_nn is
+        * set to 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius
+        * will be returned.
+        * \return the total number of neighbors found
+        */
+      int
+      radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                    NeighborsCSR &neighbors, unsigned int max_nn = 0) const;
+
     private:
       /** \brief Internal cleanup method. */
       void 
       cleanup ();
 
+      /** \brief Get the number of threads to use for the batch searches. */
+      int
+      getNumberOfBatchThreads () const;
+
+      /** \brief Convert the valid query points of a batch into a FLANN query array. On return, rows[i] holds the
+        * row of query i in \a queries and rows[i+1] - rows[i] is 1 for a valid query and 0 otherwise. Returns the
+        * number of valid queries.
+        * \param[in] cloud the point cloud holding the query points
+        * \param[in] indices the indices of the query points (empty for all of \a cloud)
+        * \param[out] queries the query array
+        * \param[out] rows the row of each query in \a queries (one element more than the number of queries)
+        */
+      int
+      convertQueriesToArray (const PointCloud &cloud, const std::vector<int> &indices,
+                             std::vector<float> &queries, std::vector<int> &rows) const;
+
       /** \brief Converts a PointCloud to the internal FLANN point array representation. Returns the number
         * of points.
         * \param cloud the PointCloud 
@@ -246,6 +369,9 @@ namespace pcl
 
       /** \brief The KdTree search parameters for radius search. */
       flann::SearchParams param_radius_;
+
+      /** \brief The number of threads the batch searches should use. */
+      unsigned int threads_;
   };
 
   /** \brief KdTreeFLANN is a generic type of 3D spatial locator using kD-tree structures. The class is making use of
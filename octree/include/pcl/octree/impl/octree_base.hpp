@@ -295,6 +295,79 @@ namespace pcl
 
     }
 
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeBase<DataT, LeafT, BranchT>::addDataSorted (const std::vector<OctreeKey>& keys_arg,
+                                                      const std::vector<DataT>& data_arg)
+    {
+      assert (keys_arg.size () == data_arg.size ());
+
+      // leaf nodes of dynamic depth octrees are split while adding data
+      if (maxObjsPerLeaf_)
+      {
+        for (size_t i = 0; i < keys_arg.size (); ++i)
+          addData (keys_arg[i], data_arg[i]);
+        return;
+      }
+
+      // branch nodes on the path from the root node to the leaf node of the previous key
+      std::vector<BranchNode*> branchPath (octreeDepth_, static_cast<BranchNode*> (0));
+      branchPath[0] = rootNode_;
+      LeafNode* leaf = 0;
+
+      for (size_t i = 0; i < keys_arg.size (); ++i)
+      {
+        const OctreeKey& key = keys_arg[i];
+        const DataT& data = data_arg[i];
+
+        unsigned int depth = 0;
+        unsigned int depthMask = depthMask_;
+
+        // skip the tree levels shared with the previous key
+        if (leaf)
+        {
+          const OctreeKey& prevKey = keys_arg[i - 1];
+          while (depthMask && (key.getChildIdxWithDepthMask (depthMask) == prevKey.getChildIdxWithDepthMask (depthMask)))
+          {
+            branchPath[depth]->setData (data);
+            depthMask >>= 1;
+            depth++;
+          }
+        }
+
+        // descend to the leaf node and create missing nodes on the way
+        for (; depth < octreeDepth_; depth++, depthMask >>= 1)
+        {
+          BranchNode* branch = branchPath[depth];
+          branch->setData (data);
+
+          unsigned char childIdx = key.getChildIdxWithDepthMask (depthMask);
+          OctreeNode* childNode = (*branch)[childIdx];
+
+          if (depthMask > 1)
+          {
+            if (!childNode)
+            {
+              BranchNode* childBranch;
+              createBranchChild (*branch, childIdx, childBranch);
+              branchCount_++;
+              childNode = childBranch;
+            }
+            branchPath[depth + 1] = static_cast<BranchNode*> (childNode);
+          }
+          else if (!childNode)
+          {
+            createLeafChild (*branch, childIdx, leaf);
+            leafCount_++;
+          }
+          else
+            leaf = static_cast<LeafNode*> (childNode);
+        }
+
+        addDataToLeaf (*leaf, data);
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename DataT, typename LeafT, typename BranchT> void OctreeBase<
         DataT, LeafT, BranchT>::createLeafRecursive (
@@ -0,0 +1,667 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_LINEAR_BASE_HPP
+#define PCL_OCTREE_LINEAR_BASE_HPP
+
+#include <vector>
+
+#include <pcl/impl/instantiate.hpp>
+#include <pcl/point_types.h>
+#include <pcl/octree/octree_linear_base.h>
+
+namespace pcl
+{
+  namespace octree
+  {
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT>
+    OctreeLinearBase<DataT, LeafT, BranchT>::OctreeLinearBase () :
+      leafCount_ (0),
+      branchCount_ (1),
+      objectCount_ (0),
+      rootNode_ (new BranchNode ()),
+      depthMask_ (0),
+      octreeDepth_ (0),
+      maxKey_ (),
+      branchNodes_ (),
+      leafNodes_ (),
+      branchNodePool_ ()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT>
+    OctreeLinearBase<DataT, LeafT, BranchT>::~OctreeLinearBase ()
+    {
+      // deallocate tree structure
+      deleteTree ();
+      delete (rootNode_);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::setMaxVoxelIndex (unsigned int maxVoxelIndex_arg)
+    {
+      unsigned int treeDepth;
+
+      assert (maxVoxelIndex_arg>0);
+
+      // tree depth == amount of bits of maxVoxels
+      treeDepth = std::max ((std::min (static_cast<unsigned int> (sizeof (unsigned int) * 8),
+                                       static_cast<unsigned int> (std::ceil (Log2 (maxVoxelIndex_arg))))),
+                                       static_cast<unsigned int> (0));
+
+      // define depthMask_ by setting a single bit to 1 at bit position == tree depth
+      depthMask_ = (1 << (treeDepth - 1));
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::setTreeDepth (unsigned int depth_arg)
+    {
+      assert(depth_arg>0);
+
+      // set octree depth
+      octreeDepth_ = depth_arg;
+
+      // define depthMask_ by setting a single bit to 1 at bit position == tree depth
+      depthMask_ = (1 << (depth_arg - 1));
+
+      // define max. keys
+      maxKey_.x = maxKey_.y = maxKey_.z = (1 << depth_arg) - 1;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::addData (unsigned int idxX_arg, unsigned int idxY_arg,
+                                                      unsigned int idxZ_arg, const DataT& data_arg)
+    {
+      // generate key
+      OctreeKey key (idxX_arg, idxY_arg, idxZ_arg);
+
+      // add data_arg to octree
+      addData (key, data_arg);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> bool
+    OctreeLinearBase<DataT, LeafT, BranchT>::getData (unsigned int idxX_arg, unsigned int idxY_arg,
+                                                      unsigned int idxZ_arg, DataT& data_arg) const
+    {
+      // generate key
+      OctreeKey key (idxX_arg, idxY_arg, idxZ_arg);
+
+      // search for leaf at key
+      LeafNode* leaf = findLeaf (key);
+      if (leaf)
+      {
+        // if successful, decode data to data_arg
+        leaf->getData (data_arg);
+      }
+
+      // returns true on success
+      return (leaf != 0);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> bool
+    OctreeLinearBase<DataT, LeafT, BranchT>::existLeaf (unsigned int idxX_arg, unsigned int idxY_arg,
+                                                        unsigned int idxZ_arg) const
+    {
+      // generate key
+      OctreeKey key (idxX_arg, idxY_arg, idxZ_arg);
+
+      // check if key exist in octree
+      return (existLeaf (key));
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::removeLeaf (unsigned int idxX_arg, unsigned int idxY_arg,
+                                                         unsigned int idxZ_arg)
+    {
+      // generate key
+      OctreeKey key (idxX_arg, idxY_arg, idxZ_arg);
+
+      // check if key exist in octree
+      deleteLeafRecursive (key, depthMask_, rootNode_);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::deleteTree (bool freeMemory_arg)
+    {
+      // reset octree
+      rootNode_->reset ();
+      branchNodes_.clear ();
+      leafNodes_.clear ();
+      for (unsigned int i = 0; i < 8; i++)
+      {
+        freeBranchBlocks_[i].clear ();
+        freeLeafBlocks_[i].clear ();
+      }
+
+      leafCount_ = 0;
+      branchCount_ = 1;
+      objectCount_ = 0;
+
+      // release node arrays and node pool
+      if (freeMemory_arg)
+      {
+        std::vector<BranchNode> ().swap (branchNodes_);
+        std::vector<LeafNode> ().swap (leafNodes_);
+        poolCleanUp ();
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::serializeTree (std::vector<char>& binaryTreeOut_arg)
+    {
+      OctreeKey newKey;
+
+      // clear binary vector
+      binaryTreeOut_arg.clear ();
+      binaryTreeOut_arg.reserve (this->branchCount_);
+
+      serializeTreeRecursive (rootNode_, newKey, &binaryTreeOut_arg, 0 );
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::serializeTree (std::vector<char>& binaryTreeOut_arg,
+                                                            std::vector<DataT>& dataVector_arg)
+    {
+      OctreeKey newKey;
+
+      // clear output vectors
+      binaryTreeOut_arg.clear ();
+      dataVector_arg.clear ();
+
+      dataVector_arg.reserve (this->objectCount_);
+      binaryTreeOut_arg.reserve (this->branchCount_);
+
+      serializeTreeRecursive (rootNode_, newKey, &binaryTreeOut_arg, &dataVector_arg );
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::serializeLeafs (std::vector<DataT>& dataVector_arg)
+    {
+      OctreeKey newKey;
+
+      // clear output vector
+      dataVector_arg.clear ();
+
+      dataVector_arg.reserve (this->objectCount_);
+
+      serializeTreeRecursive (rootNode_, newKey, 0, &dataVector_arg );
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::deserializeTree (std::vector<char>& binaryTreeIn_arg)
+    {
+      OctreeKey newKey;
+      std::vector<OctreeKey> leafKeys;
+
+      // free existing tree before tree rebuild
+      deleteTree ();
+
+      //iterator for binary tree structure vector
+      std::vector<char>::const_iterator binaryTreeVectorIterator = binaryTreeIn_arg.begin ();
+      std::vector<char>::const_iterator binaryTreeVectorIteratorEnd = binaryTreeIn_arg.end ();
+
+      deserializeTreeRecursive (depthMask_, newKey, binaryTreeVectorIterator, binaryTreeVectorIteratorEnd, leafKeys);
+
+      buildLinearTree (leafKeys);
+
+      // execute deserialization callback
+      for (size_t i = 0; i < leafKeys.size (); i++)
+        deserializeTreeCallback (leafNodes_[i], leafKeys[i]);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::deserializeTree (std::vector<char>& binaryTreeIn_arg,
+                                                              std::vector<DataT>& dataVector_arg)
+    {
+      OctreeKey newKey;
+      OctreeKey dataKey;
+      std::vector<OctreeKey> leafKeys;
+
+      // set data iterator to first element
+      typename std::vector<DataT>::const_iterator dataVectorIterator = dataVector_arg.begin ();
+
+      // set data iterator to last element
+      typename std::vector<DataT>::const_iterator dataVectorEndIterator = dataVector_arg.end ();
+
+      // free existing tree before tree rebuild
+      deleteTree ();
+
+      //iterator for binary tree structure vector
+      std::vector<char>::const_iterator binaryTreeVectorIterator = binaryTreeIn_arg.begin ();
+      std::vector<char>::const_iterator binaryTreeVectorIteratorEnd = binaryTreeIn_arg.end ();
+
+      deserializeTreeRecursive (depthMask_, newKey, binaryTreeVectorIterator, binaryTreeVectorIteratorEnd, leafKeys);
+
+      buildLinearTree (leafKeys);
+
+      for (size_t i = 0; i < leafKeys.size (); i++)
+      {
+        LeafNode& childLeaf = leafNodes_[i];
+        bool bKeyBasedEncoding = false;
+
+        if (dataVectorIterator != dataVectorEndIterator)
+        {
+          // add DataT objects to octree leaf as long as their key fit to voxel
+          while ((dataVectorIterator != dataVectorEndIterator)
+              && (this->genOctreeKeyForDataT (*dataVectorIterator, dataKey) && (dataKey == leafKeys[i])))
+          {
+            childLeaf.setData (*dataVectorIterator);
+            dataVectorIterator++;
+            bKeyBasedEncoding = true;
+            objectCount_++;
+          }
+
+          // add single DataT object to octree if key-based encoding is disabled
+          if (!bKeyBasedEncoding)
+          {
+            childLeaf.setData (*dataVectorIterator);
+            dataVectorIterator++;
+            objectCount_++;
+          }
+        }
+
+        // execute deserialization callback
+        deserializeTreeCallback (childLeaf, leafKeys[i]);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::addDataSorted (const std::vector<OctreeKey>& keys_arg,
+                                                            const std::vector<DataT>& data_arg)
+    {
+      assert (keys_arg.size () == data_arg.size ());
+
+      if (leafCount_)
+      {
+        for (size_t i = 0; i < keys_arg.size (); ++i)
+          addData (keys_arg[i], data_arg[i]);
+        return;
+      }
+
+      // an empty octree only contains the branch nodes added by bounding box adjustments: a path from the root node
+      std::vector<unsigned char> branchPath;
+      const BranchNode* branch = rootNode_;
+      while (branch->getChildCount ())
+      {
+        assert ((branch->getChildCount () == 1) && !branch->hasLeafChildren ());
+
+        unsigned char childIdx = 0;
+        while (!branch->hasChild (childIdx))
+          childIdx++;
+
+        branchPath.push_back (childIdx);
+        branch = &branchNodes_[branch->getChildOffset ()];
+      }
+
+      deleteTree (false);
+
+      // collect leaf node keys
+      std::vector<OctreeKey> leafKeys;
+      leafKeys.reserve (keys_arg.size ());
+      for (size_t i = 0; i < keys_arg.size (); ++i)
+        if (leafKeys.empty () || !(leafKeys.back () == keys_arg[i]))
+          leafKeys.push_back (keys_arg[i]);
+
+      buildLinearTree (leafKeys);
+
+      // restore the branch node path
+      BranchNode* pathBranch = rootNode_;
+      for (size_t i = 0; i < branchPath.size (); ++i)
+      {
+        unsigned int childPos;
+        if (pathBranch->hasChild (branchPath[i]))
+          childPos = pathBranch->getChildPosition (branchPath[i]);
+        else
+        {
+          childPos = insertBranchChild (pathBranch, branchPath[i], false);
+          branchCount_++;
+        }
+        pathBranch = &branchNodes_[childPos];
+      }
+
+      // add data to leaf nodes
+      for (size_t i = 0; i < keys_arg.size (); ++i)
+      {
+        const OctreeKey& key = keys_arg[i];
+        const DataT& data = data_arg[i];
+
+        BranchNode* dataBranch = rootNode_;
+        unsigned int depthMask = depthMask_;
+
+        for (; depthMask > 1; depthMask >>= 1)
+        {
+          dataBranch->setData (data);
+          dataBranch = &branchNodes_[dataBranch->getChildPosition (key.getChildIdxWithDepthMask (depthMask))];
+        }
+        dataBranch->setData (data);
+
+        addDataToLeaf (leafNodes_[dataBranch->getChildPosition (key.getChildIdxWithDepthMask (depthMask))], data);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> typename OctreeLinearBase<DataT, LeafT, BranchT>::LeafNode*
+    OctreeLinearBase<DataT, LeafT, BranchT>::findLeaf (const OctreeKey& key_arg) const
+    {
+      const BranchNode* branch = rootNode_;
+
+      for (unsigned int depthMask = depthMask_; ; depthMask >>= 1)
+      {
+        unsigned char childIdx = key_arg.getChildIdxWithDepthMask (depthMask);
+
+        if (!branch->hasChild (childIdx))
+          return (0);
+
+        if (branch->hasLeafChildren ())
+          return (const_cast<LeafNode*> (&leafNodes_[branch->getChildPosition (childIdx)]));
+
+        branch = &branchNodes_[branch->getChildPosition (childIdx)];
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> typename OctreeLinearBase<DataT, LeafT, BranchT>::LeafNode*
+    OctreeLinearBase<DataT, LeafT, BranchT>::createLeaf (const OctreeKey& key_arg, const DataT& data_arg)
+    {
+      BranchNode* branch = rootNode_;
+      unsigned int depthMask = depthMask_;
+      unsigned char childIdx;
+      unsigned int childPos;
+
+      // descend to the lowest branch level and create missing branch nodes
+      for (; depthMask > 1; depthMask >>= 1)
+      {
+        // add data to branch node container
+        branch->setData (data_arg);
+
+        childIdx = key_arg.getChildIdxWithDepthMask (depthMask);
+
+        if (branch->hasChild (childIdx))
+          childPos = branch->getChildPosition (childIdx);
+        else
+        {
+          childPos = insertBranchChild (branch, childIdx, false);
+          branchCount_++;
+        }
+
+        branch = &branchNodes_[childPos];
+      }
+
+      branch->setData (data_arg);
+
+      childIdx = key_arg.getChildIdxWithDepthMask (depthMask);
+
+      if (branch->hasChild (childIdx))
+        childPos = branch->getChildPosition (childIdx);
+      else
+      {
+        childPos = insertBranchChild (branch, childIdx, true);
+        leafCount_++;
+      }
+
+      return (&leafNodes_[childPos]);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::buildLinearTree (const std::vector<OctreeKey>& leafKeys_arg)
+    {
+      assert (!branchNodes_.size () && !leafNodes_.size ());
+      assert (octreeDepth_ > 0);
+
+      const unsigned int leafKeyCount = static_cast<unsigned int> (leafKeys_arg.size ());
+      unsigned int depth;
+      unsigned int i;
+
+      leafNodes_.resize (leafKeyCount);
+      leafCount_ = leafKeyCount;
+
+      if (!leafKeyCount)
+        return;
+
+      // nodes of every tree level, represented by the first leaf key within the node
+      std::vector<std::vector<unsigned int> > levelNodes (octreeDepth_ + 1);
+
+      levelNodes[0].push_back (0);
+      levelNodes[octreeDepth_].resize (leafKeyCount);
+      for (i = 0; i < leafKeyCount; i++)
+        levelNodes[octreeDepth_][i] = i;
+
+      for (depth = octreeDepth_ - 1; depth > 0; depth--)
+      {
+        const std::vector<unsigned int>& childNodes = levelNodes[depth + 1];
+        std::vector<unsigned int>& nodes = levelNodes[depth];
+        const unsigned int shift = octreeDepth_ - depth;
+
+        for (i = 0; i < childNodes.size (); i++)
+        {
+          // keys of the same node share all bits above the tree level
+          if (!nodes.empty ())
+          {
+            const OctreeKey& nodeKey = leafKeys_arg[nodes.back ()];
+            const OctreeKey& childKey = leafKeys_arg[childNodes[i]];
+            if ((((nodeKey.x ^ childKey.x) | (nodeKey.y ^ childKey.y) | (nodeKey.z ^ childKey.z)) >> shift) == 0)
+              continue;
+          }
+          nodes.push_back (childNodes[i]);
+        }
+      }
+
+      // branch nodes are stored level by level, leaf nodes in separate array
+      std::vector<unsigned int> levelOffsets (octreeDepth_ + 1, 0);
+      unsigned int branchNodeCount = 0;
+      for (depth = 1; depth < octreeDepth_; depth++)
+      {
+        levelOffsets[depth] = branchNodeCount;
+        branchNodeCount += static_cast<unsigned int> (levelNodes[depth].size ());
+      }
+
+      branchNodes_.resize (branchNodeCount);
+      branchCount_ = branchNodeCount + 1;
+
+      // link every branch node to its consecutive children
+      for (depth = 0; depth < octreeDepth_; depth++)
+      {
+        const std::vector<unsigned int>& nodes = levelNodes[depth];
+        const std::vector<unsigned int>& childNodes = levelNodes[depth + 1];
+        const unsigned int depthMask = 1 << (octreeDepth_ - depth - 1);
+        const bool leafChildren = (depth + 1 == octreeDepth_);
+        unsigned int child = 0;
+
+        for (i = 0; i < nodes.size (); i++)
+        {
+          BranchNode& branch = depth ? branchNodes_[levelOffsets[depth] + i] : *rootNode_;
+          const unsigned int childOffset = levelOffsets[depth + 1] + child;
+          const unsigned int nodeEnd = (i + 1 < nodes.size ()) ? nodes[i + 1] : leafKeyCount;
+          unsigned char childMask = 0;
+
+          for (; (child < childNodes.size ()) && (childNodes[child] < nodeEnd); child++)
+            childMask = static_cast<unsigned char> (childMask | (1 << leafKeys_arg[childNodes[child]].getChildIdxWithDepthMask (depthMask)));
+
+          branch.setChildren (childMask, childOffset, leafChildren);
+        }
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> bool
+    OctreeLinearBase<DataT, LeafT, BranchT>::deleteLeafRecursive (const OctreeKey& key_arg, unsigned int depthMask_arg,
+                                                                  BranchNode* branch_arg)
+    {
+      // index to branch child
+      unsigned char childIdx;
+
+      // find branch child from key
+      childIdx = key_arg.getChildIdxWithDepthMask (depthMask_arg);
+
+      if (branch_arg->hasChild (childIdx))
+      {
+        if (branch_arg->hasLeafChildren ())
+        {
+          // our child is a leaf node -> delete it
+          deleteBranchChild (*branch_arg, childIdx);
+          leafCount_--;
+        }
+        else
+        {
+          // recursively explore the indexed child branch
+          bool bNoChilds = deleteLeafRecursive (key_arg, depthMask_arg / 2,
+                                                &branchNodes_[branch_arg->getChildPosition (childIdx)]);
+
+          if (!bNoChilds)
+          {
+            // child branch does not own any sub-child nodes anymore -> delete child branch
+            deleteBranchChild (*branch_arg, childIdx);
+            branchCount_--;
+          }
+        }
+      }
+
+      // return true if current branch still owns childs
+      return (branch_arg->getChildCount () != 0);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::serializeTreeRecursive (const BranchNode* branch_arg, OctreeKey& key_arg,
+                                                                     std::vector<char>* binaryTreeOut_arg,
+                                                                     typename std::vector<DataT>* dataVector_arg) const
+    {
+      // child iterator
+      unsigned char childIdx;
+
+      // write bit pattern to output vector
+      if (binaryTreeOut_arg)
+        binaryTreeOut_arg->push_back (getBranchBitPattern (*branch_arg));
+
+      // iterate over all children
+      for (childIdx = 0; childIdx < 8; childIdx++)
+      {
+        // if child exist
+        if (branch_arg->hasChild (childIdx))
+        {
+          // add current branch voxel to key
+          key_arg.pushBranch (childIdx);
+
+          if (branch_arg->hasLeafChildren ())
+          {
+            const LeafNode& childLeaf = leafNodes_[branch_arg->getChildPosition (childIdx)];
+
+            if (dataVector_arg)
+              childLeaf.getData (*dataVector_arg);
+
+            // we reached a leaf node -> execute serialization callback
+            serializeTreeCallback (childLeaf, key_arg);
+          }
+          else
+          {
+            // recursively proceed with indexed child branch
+            serializeTreeRecursive (&branchNodes_[branch_arg->getChildPosition (childIdx)], key_arg,
+                                    binaryTreeOut_arg, dataVector_arg);
+          }
+
+          // pop current branch voxel from key
+          key_arg.popBranch ();
+        }
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeLinearBase<DataT, LeafT, BranchT>::deserializeTreeRecursive (unsigned int depthMask_arg, OctreeKey& key_arg,
+        typename std::vector<char>::const_iterator& binaryTreeIT_arg,
+        typename std::vector<char>::const_iterator& binaryTreeIT_End_arg,
+        std::vector<OctreeKey>& leafKeys_arg) const
+    {
+      // child iterator
+      unsigned char childIdx;
+      char nodeBits;
+
+      if (binaryTreeIT_arg != binaryTreeIT_End_arg)
+      {
+        // read branch occupancy bit pattern from input vector
+        nodeBits = (*binaryTreeIT_arg);
+        binaryTreeIT_arg++;
+
+        // iterate over all children
+        for (childIdx = 0; childIdx < 8; childIdx++)
+        {
+          // if occupancy bit for childIdx is set..
+          if (nodeBits & (1 << childIdx))
+          {
+            // add current branch voxel to key
+            key_arg.pushBranch (childIdx);
+
+            if (depthMask_arg > 1)
+            {
+              // we have not reached maximum tree depth
+              deserializeTreeRecursive (depthMask_arg / 2, key_arg, binaryTreeIT_arg, binaryTreeIT_End_arg, leafKeys_arg);
+            }
+            else
+            {
+              // we reached leaf node level
+              leafKeys_arg.push_back (key_arg);
+            }
+
+            // pop current branch voxel from key
+            key_arg.popBranch ();
+          }
+        }
+      }
+    }
+
+  }
+}
+
+#define PCL_INSTANTIATE_OctreeLinearBase(T) template class PCL_EXPORTS pcl::octree::OctreeLinearBase<T>;
+
+#endif
@@ -44,12 +44,16 @@
 
 #include <pcl/common/common.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
 pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::OctreePointCloud (const double resolution) :
     OctreeT (), input_ (PointCloudConstPtr ()), indices_ (IndicesConstPtr ()),
     epsilon_ (0), resolution_ (resolution), minX_ (0.0f), maxX_ (resolution), minY_ (0.0f),
-    maxY_ (resolution), minZ_ (0.0f), maxZ_ (resolution), boundingBoxDefined_ (false)
+    maxY_ (resolution), minZ_ (0.0f), maxZ_ (resolution), boundingBoxDefined_ (false), threads_ (0)
 {
   assert (resolution > 0.0f);
 }
@@ -92,6 +96,83 @@ pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::addPointsFromInp
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::addPointsFromInputCloudBulk ()
+{
+  std::vector<int> pointIndices;
+
+  // collect the finite points, in the order addPointsFromInputCloud adds them
+  if (indices_)
+  {
+    pointIndices.reserve (indices_->size ());
+    for (std::vector<int>::const_iterator current = indices_->begin (); current != indices_->end (); ++current)
+    {
+      assert( (*current>=0) && (*current < static_cast<int> (input_->points.size ())));
+      if (isFinite (input_->points[*current]))
+        pointIndices.push_back (*current);
+    }
+  }
+  else
+  {
+    pointIndices.reserve (input_->points.size ());
+    for (size_t i = 0; i < input_->points.size (); i++)
+      if (isFinite (input_->points[i]))
+        pointIndices.push_back (static_cast<int> (i));
+  }
+
+  if (pointIndices.empty ())
+    return;
+
+  // grow the bounding box the way adding the points one by one would
+  for (size_t i = 0; i < pointIndices.size (); i++)
+    adoptBoundingBoxToPoint (input_->points[pointIndices[i]]);
+
+  if (this->octreeDepth_ > MORTON_MAX_TREE_DEPTH)
+  {
+    for (size_t i = 0; i < pointIndices.size (); i++)
+      this->addPointIdx (pointIndices[i]);
+    return;
+  }
+
+#ifdef _OPENMP
+  const int threadCount = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#else
+  const int threadCount = 1;
+#endif
+  const int pointCount = static_cast<int> (pointIndices.size ());
+
+  // generate the octree key and Morton code of every point
+  std::vector<OctreeKey> keys (pointCount);
+  std::vector<MortonCode> codes (pointCount);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threadCount)
+#endif
+  for (int i = 0; i < pointCount; i++)
+  {
+    genOctreeKeyforPoint (input_->points[pointIndices[i]], keys[i]);
+    codes[i].code = encodeMortonCode (keys[i]);
+    codes[i].index = i;
+  }
+
+  sortMortonCodes (codes, 3 * this->octreeDepth_, threadCount);
+
+  // reorder keys and point indices
+  std::vector<OctreeKey> sortedKeys (pointCount);
+  std::vector<int> sortedIndices (pointCount);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threadCount)
+#endif
+  for (int i = 0; i < pointCount; i++)
+  {
+    sortedKeys[i] = keys[codes[i].index];
+    sortedIndices[i] = pointIndices[codes[i].index];
+  }
+
+  // build the octree in a single pass over the sorted keys
+  this->addDataSorted (sortedKeys, sortedIndices);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
 pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::addPointFromCloud (const int pointIdx_arg, IndicesPtr indices_arg)
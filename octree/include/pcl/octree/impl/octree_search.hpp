@@ -45,9 +45,13 @@
 #include <pcl/common/common.h>
 #include <assert.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> bool
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::voxelSearch (const PointT& point,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> bool
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::voxelSearch (const PointT& point,
                                                                           std::vector<int>& pointIdx_data)
 {
   assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
@@ -69,8 +73,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::voxelSearch (const
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> bool
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::voxelSearch (const int index,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> bool
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::voxelSearch (const int index,
                                                                           std::vector<int>& pointIdx_data)
 {
   const PointT search_point = this->getPointByIndex (index);
@@ -78,8 +82,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::voxelSearch (const
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> int
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::nearestKSearch (const PointT &p_q, int k,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::nearestKSearch (const PointT &p_q, int k,
                                                                              std::vector<int> &k_indices,
                                                                              std::vector<float> &k_sqr_distances)
 {
@@ -121,8 +125,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::nearestKSearch (con
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> int
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::nearestKSearch (int index, int k,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::nearestKSearch (int index, int k,
                                                                              std::vector<int> &k_indices,
                                                                              std::vector<float> &k_sqr_distances)
 {
@@ -131,8 +135,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::nearestKSearch (int
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> void
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::approxNearestSearch (const PointT &p_q,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::approxNearestSearch (const PointT &p_q,
                                                                                   int &result_index,
                                                                                   float &sqr_distance)
 {
@@ -148,8 +152,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::approxNearestSearch
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> void
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::approxNearestSearch (int query_index, int &result_index,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::approxNearestSearch (int query_index, int &result_index,
                                                                                   float &sqr_distance)
 {
   const PointT searchPoint = this->getPointByIndex (query_index);
@@ -158,8 +162,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::approxNearestSearch
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> int
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::radiusSearch (const PointT &p_q, const double radius,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::radiusSearch (const PointT &p_q, const double radius,
                                                                            std::vector<int> &k_indices,
                                                                            std::vector<float> &k_sqr_distances,
                                                                            unsigned int max_nn) const
@@ -178,8 +182,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::radiusSearch (const
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> int
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::radiusSearch (int index, const double radius,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::radiusSearch (int index, const double radius,
                                                                            std::vector<int> &k_indices,
                                                                            std::vector<float> &k_sqr_distances,
                                                                            unsigned int max_nn) const
@@ -190,8 +194,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::radiusSearch (int i
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> int
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::boxSearch (const Eigen::Vector3f &min_pt,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::boxSearch (const Eigen::Vector3f &min_pt,
                                                                         const Eigen::Vector3f &max_pt,
                                                                         std::vector<int> &k_indices) const
 {
@@ -208,8 +212,146 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::boxSearch (const Ei
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> double
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getKNearestNeighborRecursive (
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::nearestKSearch (const PointCloud &cloud,
+                                                                             const std::vector<int> &indices, int k,
+                                                                             std::vector<std::vector<int> > &k_indices,
+                                                                             std::vector<std::vector<float> > &k_sqr_distances) const
+{
+  assert(this->leafCount_>0);
+
+  const int queryCount = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+
+  k_indices.resize (queryCount);
+  k_sqr_distances.resize (queryCount);
+
+#ifdef _OPENMP
+  const int threadCount = this->threads_ ? static_cast<int> (this->threads_) : omp_get_max_threads ();
+#else
+  const int threadCount = 1;
+#endif
+  const int chunkSize = 256;
+  const int chunkCount = (queryCount + chunkSize - 1) / chunkSize;
+
+  std::vector<int> queryOrder;
+  sortBatchQueries (cloud, indices, threadCount, queryOrder);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threadCount)
+#endif
+  {
+    BatchSearchState state;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int chunk = 0; chunk < chunkCount; ++chunk)
+    {
+      const int end = std::min (queryCount, (chunk + 1) * chunkSize);
+      int previousQuery = -1;
+
+      for (int i = chunk * chunkSize; i < end; ++i)
+      {
+        const int query = queryOrder[i];
+        const PointT& point = cloud.points[indices.empty () ? query : indices[query]];
+
+        k_indices[query].clear ();
+        k_sqr_distances[query].clear ();
+
+        if (k < 1 || !isFinite (point))
+          continue;
+
+        // the K neighbors of the previous query bound the distance of the K-th neighbor of this query
+        double squaredSearchRadius = numeric_limits<double>::max ();
+        if (previousQuery >= 0 && k_indices[previousQuery].size () == static_cast<size_t> (k))
+        {
+          squaredSearchRadius = 0.0;
+          for (int j = 0; j < k; ++j)
+            squaredSearchRadius = std::max (squaredSearchRadius, static_cast<double> (
+                pointSquaredDist (this->getPointByIndex (k_indices[previousQuery][j]), point)));
+        }
+
+        OctreeKey key;
+        unsigned int treeDepth;
+        const BranchNode* node = getBatchSearchStartNode (point, squaredSearchRadius, state, key, treeDepth);
+
+        getKNearestNeighborBatch (point, k, node, key, treeDepth, squaredSearchRadius, state,
+                                  k_indices[query], k_sqr_distances[query]);
+        previousQuery = query;
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::radiusSearch (const PointCloud &cloud,
+                                                                           const std::vector<int> &indices, double radius,
+                                                                           std::vector<std::vector<int> > &k_indices,
+                                                                           std::vector<std::vector<float> > &k_sqr_distances,
+                                                                           unsigned int max_nn) const
+{
+  const int queryCount = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+  const double radiusSquared = radius * radius;
+
+  k_indices.resize (queryCount);
+  k_sqr_distances.resize (queryCount);
+
+#ifdef _OPENMP
+  const int threadCount = this->threads_ ? static_cast<int> (this->threads_) : omp_get_max_threads ();
+#else
+  const int threadCount = 1;
+#endif
+  const int chunkSize = 256;
+  const int chunkCount = (queryCount + chunkSize - 1) / chunkSize;
+
+  std::vector<int> queryOrder;
+  sortBatchQueries (cloud, indices, threadCount, queryOrder);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threadCount)
+#endif
+  {
+    BatchSearchState state;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int chunk = 0; chunk < chunkCount; ++chunk)
+    {
+      const int end = std::min (queryCount, (chunk + 1) * chunkSize);
+      size_t previousCount = 0;
+
+      for (int i = chunk * chunkSize; i < end; ++i)
+      {
+        const int query = queryOrder[i];
+        const PointT& point = cloud.points[indices.empty () ? query : indices[query]];
+
+        k_indices[query].clear ();
+        k_sqr_distances[query].clear ();
+
+        if (!isFinite (point))
+          continue;
+
+        // neighboring queries find a similar number of points
+        k_indices[query].reserve (previousCount);
+        k_sqr_distances[query].reserve (previousCount);
+
+        OctreeKey key;
+        unsigned int treeDepth;
+        const BranchNode* node = getBatchSearchStartNode (point, radiusSquared, state, key, treeDepth);
+
+        getNeighborsWithinRadiusBatch (point, radiusSquared, node, key, treeDepth, state,
+                                       k_indices[query], k_sqr_distances[query], max_nn);
+        previousCount = k_indices[query].size ();
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> double
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::getKNearestNeighborRecursive (
     const PointT & point, unsigned int K, const BranchNode* node, const OctreeKey& key, unsigned int treeDepth,
     const double squaredSearchRadius, std::vector<prioPointQueueEntry>& pointCandidates) const
 {
@@ -319,8 +461,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getKNearestNeighbor
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> void
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getNeighborsWithinRadiusRecursive (
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::getNeighborsWithinRadiusRecursive (
     const PointT & point, const double radiusSquared, const BranchNode* node, const OctreeKey& key,
     unsigned int treeDepth, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances,
     unsigned int max_nn) const
@@ -404,8 +546,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getNeighborsWithinR
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> void
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::approxNearestSearchRecursive (const PointT & point,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::approxNearestSearchRecursive (const PointT & point,
                                                                                            const BranchNode* node,
                                                                                            const OctreeKey& key,
                                                                                            unsigned int treeDepth,
@@ -500,16 +642,331 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::approxNearestSearch
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> float
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::pointSquaredDist (const PointT & pointA,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> float
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::pointSquaredDist (const PointT & pointA,
                                                                                const PointT & pointB) const
 {
   return (pointA.getVector3fMap () - pointB.getVector3fMap ()).squaredNorm ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> void
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::boxSearchRecursive (const Eigen::Vector3f &min_pt,
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> double
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::pointSquaredVoxelDist (const PointT & point,
+                                                                                    const OctreeKey& key,
+                                                                                    unsigned int treeDepth) const
+{
+  // side length of the voxel at the given tree depth
+  const double voxelSideLen = this->resolution_ * static_cast<double> (1 << (this->octreeDepth_ - treeDepth));
+
+  const double minX = static_cast<double> (key.x) * voxelSideLen + this->minX_;
+  const double minY = static_cast<double> (key.y) * voxelSideLen + this->minY_;
+  const double minZ = static_cast<double> (key.z) * voxelSideLen + this->minZ_;
+
+  const double dx = std::max (std::max (minX - point.x, point.x - minX - voxelSideLen), 0.0);
+  const double dy = std::max (std::max (minY - point.y, point.y - minY - voxelSideLen), 0.0);
+  const double dz = std::max (std::max (minZ - point.z, point.z - minZ - voxelSideLen), 0.0);
+
+  return (dx * dx + dy * dy + dz * dz);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::sortBatchQueries (const PointCloud &cloud,
+                                                                               const std::vector<int> &indices,
+                                                                               int threadCount,
+                                                                               std::vector<int> &queryOrder) const
+{
+  const int queryCount = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+
+  queryOrder.resize (queryCount);
+
+  if (this->octreeDepth_ > MORTON_MAX_TREE_DEPTH)
+  {
+    for (int i = 0; i < queryCount; i++)
+      queryOrder[i] = i;
+    return;
+  }
+
+  const double maxKey = static_cast<double> ((1 << this->octreeDepth_) - 1);
+  std::vector<MortonCode> codes (queryCount);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threadCount)
+#endif
+  for (int i = 0; i < queryCount; i++)
+  {
+    const PointT& point = cloud.points[indices.empty () ? i : indices[i]];
+    OctreeKey key;
+    key.x = key.y = key.z = 0;
+
+    // clamp the query to the bounding box of the octree
+    if (isFinite (point))
+    {
+      key.x = static_cast<unsigned int> (std::min (std::max ((point.x - this->minX_) / this->resolution_, 0.0), maxKey));
+      key.y = static_cast<unsigned int> (std::min (std::max ((point.y - this->minY_) / this->resolution_, 0.0), maxKey));
+      key.z = static_cast<unsigned int> (std::min (std::max ((point.z - this->minZ_) / this->resolution_, 0.0), maxKey));
+    }
+
+    codes[i].code = encodeMortonCode (key);
+    codes[i].index = i;
+  }
+
+  sortMortonCodes (codes, 3 * this->octreeDepth_, threadCount);
+
+  for (int i = 0; i < queryCount; i++)
+    queryOrder[i] = codes[i].index;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT>
+const typename pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::BranchNode*
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::getBatchSearchStartNode (
+    const PointT& point, const double squaredSearchRadius, BatchSearchState& state, OctreeKey& key,
+    unsigned int& treeDepth) const
+{
+  const unsigned int octreeDepth = this->octreeDepth_;
+
+  if (state.pathNodes.size () != octreeDepth)
+  {
+    state.pathNodes.resize (octreeDepth);
+    state.pathDepth = 0;
+  }
+  state.pathNodes[0] = this->rootNode_;
+
+  key.x = key.y = key.z = 0;
+  treeDepth = 0;
+
+  if (!this->isPointWithinBoundingBox (point))
+  {
+    state.pathDepth = 1;
+    return (this->rootNode_);
+  }
+
+  OctreeKey pointKey;
+  this->genOctreeKeyforPoint (point, pointKey);
+
+  // keep the path of the previous query down to the deepest voxel containing both queries
+  unsigned int pathDepth = 1;
+  while (pathDepth < state.pathDepth)
+  {
+    const unsigned int shift = octreeDepth - pathDepth;
+    if (((pointKey.x ^ state.pathKey.x) >> shift) | ((pointKey.y ^ state.pathKey.y) >> shift)
+        | ((pointKey.z ^ state.pathKey.z) >> shift))
+      break;
+    pathDepth++;
+  }
+
+  // descend to the deepest existing branch node containing the query
+  while (pathDepth < octreeDepth)
+  {
+    const BranchNode* parent = state.pathNodes[pathDepth - 1];
+    const unsigned char childIdx = pointKey.getChildIdxWithDepthMask (1 << (octreeDepth - pathDepth));
+
+    if (!this->branchHasChild (*parent, childIdx))
+      break;
+
+    state.pathNodes[pathDepth++] = static_cast<const BranchNode*> (this->getBranchChildPtr (*parent, childIdx));
+  }
+
+  state.pathKey = pointKey;
+  state.pathDepth = pathDepth;
+
+  if (squaredSearchRadius == numeric_limits<double>::max ())
+    return (this->rootNode_);
+
+  // search radius with some slack for rounding in the distance and key computations
+  const double searchRadius = sqrt (squaredSearchRadius * (1.0 + 1e-5)) + this->resolution_ * 1e-6;
+
+  // find the deepest voxel on the path enclosing the search sphere
+  for (unsigned int depth = pathDepth - 1; depth > 0; depth--)
+  {
+    const unsigned int shift = octreeDepth - depth;
+    const double voxelSideLen = this->resolution_ * static_cast<double> (1 << shift);
+    const double minX = static_cast<double> (pointKey.x >> shift) * voxelSideLen + this->minX_;
+    const double minY = static_cast<double> (pointKey.y >> shift) * voxelSideLen + this->minY_;
+    const double minZ = static_cast<double> (pointKey.z >> shift) * voxelSideLen + this->minZ_;
+
+    if ((point.x - searchRadius >= minX) && (point.x + searchRadius < minX + voxelSideLen)
+        && (point.y - searchRadius >= minY) && (point.y + searchRadius < minY + voxelSideLen)
+        && (point.z - searchRadius >= minZ) && (point.z + searchRadius < minZ + voxelSideLen))
+    {
+      key.x = pointKey.x >> shift;
+      key.y = pointKey.y >> shift;
+      key.z = pointKey.z >> shift;
+      treeDepth = depth;
+      return (state.pathNodes[depth]);
+    }
+  }
+
+  return (this->rootNode_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::getKNearestNeighborBatch (
+    const PointT& point, unsigned int K, const BranchNode* node, const OctreeKey& key, unsigned int treeDepth,
+    const double squaredSearchRadius, BatchSearchState& state, std::vector<int>& k_indices,
+    std::vector<float>& k_sqr_distances) const
+{
+  std::vector<batchQueueEntry>& nodeQueue = state.nodeQueue;
+  std::vector<prioPointQueueEntry>& pointQueue = state.pointQueue;
+
+  nodeQueue.clear ();
+  pointQueue.clear ();
+
+  // voxels further away than the current search radius (with some slack for rounding) are skipped
+  double pruneDistance = squaredSearchRadius * (1.0 + 1e-5) - this->epsilon_;
+
+  nodeQueue.push_back (batchQueueEntry (node, key, treeDepth, 0.0f));
+
+  while (!nodeQueue.empty ())
+  {
+    std::pop_heap (nodeQueue.begin (), nodeQueue.end ());
+    const batchQueueEntry entry = nodeQueue.back ();
+    nodeQueue.pop_back ();
+
+    // all remaining voxels are further away
+    if (entry.pointDistance > pruneDistance)
+      break;
+
+    if (entry.depth == this->octreeDepth_)
+    {
+      // we reached leaf node level
+      state.leafData.clear ();
+      static_cast<const LeafNode*> (entry.node)->getData (state.leafData);
+
+      for (size_t i = 0; i < state.leafData.size (); i++)
+      {
+        const float squaredDist = pointSquaredDist (this->getPointByIndex (state.leafData[i]), point);
+
+        if (pointQueue.size () < K)
+        {
+          pointQueue.push_back (prioPointQueueEntry ());
+        }
+        else if (squaredDist < pointQueue.front ().pointDistance_)
+        {
+          std::pop_heap (pointQueue.begin (), pointQueue.end ());
+        }
+        else
+          continue;
+
+        pointQueue.back ().pointIdx_ = state.leafData[i];
+        pointQueue.back ().pointDistance_ = squaredDist;
+        std::push_heap (pointQueue.begin (), pointQueue.end ());
+      }
+
+      if (pointQueue.size () == K)
+        pruneDistance = std::min (pruneDistance,
+                                  pointQueue.front ().pointDistance_ * (1.0 + 1e-5) - this->epsilon_);
+      continue;
+    }
+
+    const BranchNode* branch = static_cast<const BranchNode*> (entry.node);
+
+    // queue all children that may hold closer points
+    for (unsigned char childIdx = 0; childIdx < 8; childIdx++)
+    {
+      if (!this->branchHasChild (*branch, childIdx))
+        continue;
+
+      OctreeKey childKey;
+      childKey.x = (entry.key.x << 1) + (!!(childIdx & (1 << 2)));
+      childKey.y = (entry.key.y << 1) + (!!(childIdx & (1 << 1)));
+      childKey.z = (entry.key.z << 1) + (!!(childIdx & (1 << 0)));
+
+      const double voxelDist = pointSquaredVoxelDist (point, childKey, entry.depth + 1);
+      if (voxelDist > pruneDistance)
+        continue;
+
+      nodeQueue.push_back (batchQueueEntry (this->getBranchChildPtr (*branch, childIdx), childKey, entry.depth + 1,
+                                            static_cast<float> (voxelDist)));
+      std::push_heap (nodeQueue.begin (), nodeQueue.end ());
+    }
+  }
+
+  // the heap sorted in ascending order of distance
+  std::sort_heap (pointQueue.begin (), pointQueue.end ());
+
+  k_indices.resize (pointQueue.size ());
+  k_sqr_distances.resize (pointQueue.size ());
+
+  for (size_t i = 0; i < pointQueue.size (); i++)
+  {
+    k_indices[i] = pointQueue[i].pointIdx_;
+    k_sqr_distances[i] = pointQueue[i].pointDistance_;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::getNeighborsWithinRadiusBatch (
+    const PointT& point, const double radiusSquared, const BranchNode* node, const OctreeKey& key,
+    unsigned int treeDepth, BatchSearchState& state, std::vector<int>& k_indices,
+    std::vector<float>& k_sqr_distances, unsigned int max_nn) const
+{
+  std::vector<batchQueueEntry>& nodeStack = state.nodeQueue;
+
+  nodeStack.clear ();
+
+  // voxels further away than the search radius (with some slack for rounding) are skipped
+  const double pruneDistance = radiusSquared * (1.0 + 1e-5);
+
+  nodeStack.push_back (batchQueueEntry (node, key, treeDepth, 0.0f));
+
+  while (!nodeStack.empty ())
+  {
+    const batchQueueEntry entry = nodeStack.back ();
+    nodeStack.pop_back ();
+
+    if (entry.depth == this->octreeDepth_)
+    {
+      // we reached leaf node level
+      state.leafData.clear ();
+      static_cast<const LeafNode*> (entry.node)->getData (state.leafData);
+
+      for (size_t i = 0; i < state.leafData.size (); i++)
+      {
+        const float squaredDist = pointSquaredDist (this->getPointByIndex (state.leafData[i]), point);
+
+        // check if a match is found
+        if (squaredDist > radiusSquared)
+          continue;
+
+        k_indices.push_back (state.leafData[i]);
+        k_sqr_distances.push_back (squaredDist);
+
+        if (max_nn != 0 && k_indices.size () == static_cast<unsigned int> (max_nn))
+          return;
+      }
+      continue;
+    }
+
+    const BranchNode* branch = static_cast<const BranchNode*> (entry.node);
+
+    // push children in reverse order to visit them in the order of the recursive search
+    for (int childIdx = 7; childIdx >= 0; childIdx--)
+    {
+      if (!this->branchHasChild (*branch, static_cast<unsigned char> (childIdx)))
+        continue;
+
+      OctreeKey childKey;
+      childKey.x = (entry.key.x << 1) + (!!(childIdx & (1 << 2)));
+      childKey.y = (entry.key.y << 1) + (!!(childIdx & (1 << 1)));
+      childKey.z = (entry.key.z << 1) + (!!(childIdx & (1 << 0)));
+
+      const double voxelDist = pointSquaredVoxelDist (point, childKey, entry.depth + 1);
+      if (voxelDist > pruneDistance)
+        continue;
+
+      nodeStack.push_back (batchQueueEntry (this->getBranchChildPtr (*branch, static_cast<unsigned char> (childIdx)),
+                                            childKey, entry.depth + 1, static_cast<float> (voxelDist)));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::boxSearchRecursive (const Eigen::Vector3f &min_pt,
                                                                                  const Eigen::Vector3f &max_pt,
                                                                                  const BranchNode* node,
                                                                                  const OctreeKey& key,
@@ -585,8 +1042,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::boxSearchRecursive
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> int
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getIntersectedVoxelCenters (
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::getIntersectedVoxelCenters (
     Eigen::Vector3f origin, Eigen::Vector3f direction, AlignedPointTVector &voxelCenterList,
     int maxVoxelCount) const
 {
@@ -610,8 +1067,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getIntersectedVoxel
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> int
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getIntersectedVoxelIndices (
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::getIntersectedVoxelIndices (
     Eigen::Vector3f origin, Eigen::Vector3f direction, std::vector<int> &k_indices,
     int maxVoxelCount) const
 {
@@ -633,8 +1090,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getIntersectedVoxel
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> int
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getIntersectedVoxelCentersRecursive (
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::getIntersectedVoxelCentersRecursive (
     double minX, double minY, double minZ, double maxX, double maxY, double maxZ, unsigned char a,
     const OctreeNode* node, const OctreeKey& key, AlignedPointTVector &voxelCenterList, int maxVoxelCount) const
 {
@@ -751,8 +1208,8 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getIntersectedVoxel
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename LeafT, typename BranchT> int
-pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT>::getIntersectedVoxelIndicesRecursive (
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeBaseT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT>::getIntersectedVoxelIndicesRecursive (
     double minX, double minY, double minZ, double maxX, double maxY, double maxZ, unsigned char a,
     const OctreeNode* node, const OctreeKey& key, std::vector<int> &k_indices, int maxVoxelCount) const
 {
@@ -446,6 +446,20 @@ namespace pcl
           }
         }
 
+        /** \brief Add DataT objects at octree keys sorted in Morton order (see encodeMortonCode).
+         *  \note Double buffered octrees reuse the nodes of the previous buffer while creating leaf nodes, so the objects
+         *  \note are added one by one; the Morton order still keeps consecutive tree paths in cache.
+         *  \param keys_arg: octree keys, sorted in Morton order.
+         *  \param data_arg: DataT objects to be added, one per key.
+         * */
+        void
+        addDataSorted (const std::vector<OctreeKey>& keys_arg, const std::vector<DataT>& data_arg)
+        {
+          assert (keys_arg.size () == data_arg.size ());
+          for (size_t i = 0; i < keys_arg.size (); ++i)
+            addData (keys_arg[i], data_arg[i]);
+        }
+
         /** \brief Find leaf node
          *  \param key_arg: octree key addressing a leaf node.
          *  \return pointer to leaf node. If leaf node is not found, this pointer returns 0.
@@ -306,13 +306,30 @@ namespace pcl
           createLeafRecursive (key_arg, depthMask_,data_arg, rootNode_, newLeaf);
 
           if (newLeaf)
-          {
-            // add data to leaf
-            newLeaf->setData (data_arg);
-            objectCount_++;
-          }
+            addDataToLeaf (*newLeaf, data_arg);
         }
 
+        /** \brief Add DataT object to a leaf node. Called by addData and addDataSorted for every added object.
+         *  \param leaf_arg: leaf node at the octree key of the object.
+         *  \param data_arg: DataT object to be added.
+         * */
+        virtual void
+        addDataToLeaf (LeafNode& leaf_arg, const DataT& data_arg)
+        {
+          leaf_arg.setData (data_arg);
+          objectCount_++;
+        }
+
+        /** \brief Add DataT objects at octree keys sorted in Morton order (see encodeMortonCode).
+         *  \note Leaf nodes and branches are created in a single pass over the keys: consecutive keys share the path from
+         *  \note the root down to the tree level where they differ, and only the nodes below it are visited. The result
+         *  \note is identical to calling addData for every key in the given order.
+         *  \param keys_arg: octree keys, sorted in Morton order.
+         *  \param data_arg: DataT objects to be added, one per key.
+         * */
+        void
+        addDataSorted (const std::vector<OctreeKey>& keys_arg, const std::vector<DataT>& data_arg);
+
         /** \brief Find leaf node
          *  \param key_arg: octree key addressing a leaf node.
          *  \return pointer to leaf node. If leaf node is not found, this pointer returns 0.
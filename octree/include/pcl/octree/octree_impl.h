@@ -43,6 +43,7 @@
 
 #include <pcl/octree/impl/octree_base.hpp>
 #include <pcl/octree/impl/octree2buf_base.hpp>
+#include <pcl/octree/impl/octree_linear_base.hpp>
 #include <pcl/octree/impl/octree_pointcloud.hpp>
 #include <pcl/octree/impl/octree_iterator.hpp>
 #include <pcl/octree/impl/octree_search.hpp>
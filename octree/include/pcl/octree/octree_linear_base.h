@@ -0,0 +1,820 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_LINEAR_BASE_H
+#define PCL_OCTREE_LINEAR_BASE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "octree_nodes.h"
+#include "octree_container.h"
+#include "octree_key.h"
+#include "octree_iterator.h"
+#include "octree_node_pool.h"
+
+namespace pcl
+{
+  namespace octree
+  {
+    /** \brief Linear octree class
+      * \note Octree with the same interface as OctreeBase, which stores its nodes by value in two contiguous node
+      * \note arrays (branch nodes and leaf nodes) instead of allocating them individually. A branch node addresses its
+      * \note children by a child bit mask and the array offset of its first child (see OctreeLinearBranchNode), which
+      * \note removes the eight child pointers from every branch node and keeps sibling nodes adjacent in memory.
+      * \note It can be used as OctreeT implementation of OctreePointCloud and OctreePointCloudSearch.
+      * \note Node pointers (e.g. held by iterators) are invalidated when leaf or branch nodes are added or removed.
+      * \note Leaf nodes are always located at the maximum tree depth, a dynamic tree depth is not supported.
+      * \ingroup octree
+      * \author Open Perception
+      */
+    template<typename DataT, typename LeafT = OctreeContainerDataT<DataT>,
+        typename BranchT = OctreeContainerEmpty<DataT> >
+    class OctreeLinearBase
+    {
+
+      public:
+
+        typedef OctreeLinearBase<DataT, LeafT, BranchT> OctreeT;
+
+        // iterators are friends
+        friend class OctreeIteratorBase<DataT, OctreeT> ;
+        friend class OctreeDepthFirstIterator<DataT, OctreeT> ;
+        friend class OctreeBreadthFirstIterator<DataT, OctreeT> ;
+        friend class OctreeLeafNodeIterator<DataT, OctreeT> ;
+
+        typedef OctreeLinearBranchNode<BranchT> BranchNode;
+        typedef OctreeLeafNode<LeafT> LeafNode;
+
+        // Octree default iterators
+        typedef OctreeDepthFirstIterator<int, OctreeT> Iterator;
+        typedef const OctreeDepthFirstIterator<int, OctreeT> ConstIterator;
+        Iterator begin(unsigned int maxDepth_arg = 0) {return Iterator(this, maxDepth_arg);};
+        const Iterator end() {return Iterator();};
+
+        // Octree leaf node iterators
+        typedef OctreeLeafNodeIterator<int, OctreeT> LeafNodeIterator;
+        typedef const OctreeLeafNodeIterator<int, OctreeT> ConstLeafNodeIterator;
+        LeafNodeIterator leaf_begin(unsigned int maxDepth_arg = 0) {return LeafNodeIterator(this, maxDepth_arg);};
+        const LeafNodeIterator leaf_end() {return LeafNodeIterator();};
+
+        // Octree depth-first iterators
+        typedef OctreeDepthFirstIterator<int, OctreeT> DepthFirstIterator;
+        typedef const OctreeDepthFirstIterator<int, OctreeT> ConstDepthFirstIterator;
+        DepthFirstIterator depth_begin(unsigned int maxDepth_arg = 0) {return DepthFirstIterator(this, maxDepth_arg);};
+        const DepthFirstIterator depth_end() {return DepthFirstIterator();};
+
+        // Octree breadth-first iterators
+        typedef OctreeBreadthFirstIterator<int, OctreeT> BreadthFirstIterator;
+        typedef const OctreeBreadthFirstIterator<int, OctreeT> ConstBreadthFirstIterator;
+        BreadthFirstIterator breadth_begin(unsigned int maxDepth_arg = 0) {return BreadthFirstIterator(this, maxDepth_arg);};
+        const BreadthFirstIterator breadth_end() {return BreadthFirstIterator();};
+
+
+        /** \brief Empty constructor. */
+        OctreeLinearBase ();
+
+        /** \brief Empty deconstructor. */
+        virtual
+        ~OctreeLinearBase ();
+
+        /** \brief Copy constructor. */
+        OctreeLinearBase (const OctreeLinearBase& source) :
+          leafCount_ (source.leafCount_),
+          branchCount_ (source.branchCount_),
+          objectCount_ (source.objectCount_),
+          rootNode_ (new BranchNode (*(source.rootNode_))),
+          depthMask_ (source.depthMask_),
+          octreeDepth_ (source.octreeDepth_),
+          maxKey_ (source.maxKey_),
+          branchNodes_ (source.branchNodes_),
+          leafNodes_ (source.leafNodes_),
+          branchNodePool_ ()
+        {
+          for (unsigned int i = 0; i < 8; i++)
+          {
+            freeBranchBlocks_[i] = source.freeBranchBlocks_[i];
+            freeLeafBlocks_[i] = source.freeLeafBlocks_[i];
+          }
+        }
+
+        /** \brief Copy operator. */
+        inline OctreeLinearBase&
+        operator = (const OctreeLinearBase &source)
+        {
+          leafCount_ = source.leafCount_;
+          branchCount_ = source.branchCount_;
+          objectCount_ = source.objectCount_;
+          *rootNode_ = *(source.rootNode_);
+          depthMask_ = source.depthMask_;
+          maxKey_ = source.maxKey_;
+          octreeDepth_ = source.octreeDepth_;
+          branchNodes_ = source.branchNodes_;
+          leafNodes_ = source.leafNodes_;
+          for (unsigned int i = 0; i < 8; i++)
+          {
+            freeBranchBlocks_[i] = source.freeBranchBlocks_[i];
+            freeLeafBlocks_[i] = source.freeLeafBlocks_[i];
+          }
+          return (*this);
+        }
+
+        /** \brief Set the maximum amount of voxels per dimension.
+          * \param[in] maxVoxelIndex_arg maximum amount of voxels per dimension
+          */
+        void
+        setMaxVoxelIndex (unsigned int maxVoxelIndex_arg);
+
+        /** \brief Set the maximum depth of the octree.
+         *  \param depth_arg: maximum depth of octree
+         * */
+        void
+        setTreeDepth (unsigned int depth_arg);
+
+        /** \brief Get the maximum depth of the octree.
+         *  \return depth_arg: maximum depth of octree
+         * */
+        inline unsigned int
+        getTreeDepth () const
+        {
+          return this->octreeDepth_;
+        }
+
+        /** \brief Add a const DataT element to leaf node at (idxX, idxY, idxZ). If leaf node does not exist, it is created and added to the octree.
+         *  \param idxX_arg: index of leaf node in the X axis.
+         *  \param idxY_arg: index of leaf node in the Y axis.
+         *  \param idxZ_arg: index of leaf node in the Z axis.
+         *  \param data_arg: const reference to DataT object to be added.
+         * */
+        void
+        addData (unsigned int idxX_arg, unsigned int idxY_arg, unsigned int idxZ_arg,
+             const DataT& data_arg);
+
+        /** \brief Retrieve a DataT element from leaf node at (idxX, idxY, idxZ). It returns false if leaf node does not exist.
+         *  \param idxX_arg: index of leaf node in the X axis.
+         *  \param idxY_arg: index of leaf node in the Y axis.
+         *  \param idxZ_arg: index of leaf node in the Z axis.
+         *  \param data_arg: reference to DataT object that contains content of leaf node if search was successful.
+         *  \return "true" if leaf node search is successful, otherwise it returns "false".
+         * */
+        bool
+        getData (unsigned int idxX_arg, unsigned int idxY_arg, unsigned int idxZ_arg, DataT& data_arg) const ;
+
+        /** \brief Check for the existence of leaf node at (idxX, idxY, idxZ).
+         *  \param idxX_arg: index of leaf node in the X axis.
+         *  \param idxY_arg: index of leaf node in the Y axis.
+         *  \param idxZ_arg: index of leaf node in the Z axis.
+         *  \return "true" if leaf node search is successful, otherwise it returns "false".
+         * */
+        bool
+        existLeaf (unsigned int idxX_arg, unsigned int idxY_arg, unsigned int idxZ_arg) const ;
+
+        /** \brief Remove leaf node at (idxX_arg, idxY_arg, idxZ_arg).
+         *  \param idxX_arg: index of leaf node in the X axis.
+         *  \param idxY_arg: index of leaf node in the Y axis.
+         *  \param idxZ_arg: index of leaf node in the Z axis.
+         * */
+        void
+        removeLeaf (unsigned int idxX_arg, unsigned int idxY_arg, unsigned int idxZ_arg);
+
+        /** \brief Return the amount of existing leafs in the octree.
+         *  \return amount of registered leaf nodes.
+         * */
+        inline std::size_t
+        getLeafCount () const
+        {
+          return leafCount_;
+        }
+
+        /** \brief Return the amount of existing branches in the octree.
+         *  \return amount of branch nodes.
+         * */
+        inline std::size_t
+        getBranchCount () const
+        {
+          return branchCount_;
+        }
+
+        /** \brief Return the amount of memory allocated for octree nodes, including unused node array capacity.
+         *  \return size of the node arrays in bytes.
+         * */
+        inline std::size_t
+        getNodeMemory () const
+        {
+          return (sizeof (BranchNode) * (branchNodes_.capacity () + 1) + sizeof (LeafNode) * leafNodes_.capacity ());
+        }
+
+        /** \brief Delete the octree structure and its leaf nodes.
+         *  \param freeMemory_arg: if "true", the memory of the node arrays is released, otherwise it is kept for reuse
+         * */
+        void
+        deleteTree ( bool freeMemory_arg = true );
+
+        /** \brief Serialize octree into a binary output vector describing its branch node structure.
+         *  \param binaryTreeOut_arg: reference to output vector for writing binary tree structure.
+         * */
+        void
+        serializeTree (std::vector<char>& binaryTreeOut_arg);
+
+        /** \brief Serialize octree into a binary output vector describing its branch node structure and push all DataT elements stored in the octree to a vector.
+         * \param binaryTreeOut_arg: reference to output vector for writing binary tree structure.
+         * \param dataVector_arg: reference of DataT vector that receives a copy of all DataT objects in the octree
+         * */
+        void
+        serializeTree (std::vector<char>& binaryTreeOut_arg, std::vector<DataT>& dataVector_arg);
+
+        /** \brief Outputs a vector of all DataT elements that are stored within the octree leaf nodes.
+         *  \param dataVector_arg: reference to DataT vector that receives a copy of all DataT objects in the octree.
+         * */
+        void
+        serializeLeafs (std::vector<DataT>& dataVector_arg);
+
+        /** \brief Deserialize a binary octree description vector and create a corresponding octree structure. Leaf nodes are initialized with getDataTByKey(..).
+         *  \param binaryTreeIn_arg: reference to input vector for reading binary tree structure.
+         * */
+        void
+        deserializeTree (std::vector<char>& binaryTreeIn_arg);
+
+        /** \brief Deserialize a binary octree description and create a corresponding octree structure. Leaf nodes are initialized with DataT elements from the dataVector.
+         *  \param binaryTreeIn_arg: reference to input vector for reading binary tree structure.
+         *  \param dataVector_arg: reference to DataT vector that provides DataT objects for initializing leaf nodes.
+         * */
+        void
+        deserializeTree (std::vector<char>& binaryTreeIn_arg, std::vector<DataT>& dataVector_arg);
+
+      protected:
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Protected octree methods based on octree keys
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        /** \brief Virtual method for generating an octree key for a given DataT object.
+          * \param[in] data_arg reference to DataT object
+          * \param[in] key_arg write generated octree key to this octree key reference
+          * \return "true" if octree could be generated based on DataT object; "false" otherwise
+          */
+        virtual bool
+        genOctreeKeyForDataT (const DataT &, OctreeKey &) const
+        {
+          // this class cannot relate DataT objects to octree keys
+          return (false);
+        }
+
+        /** \brief Virtual method for initializing new leaf node during deserialization (in case no DataT information is provided)
+          * \param[in] key_arg write generated octree key to this octree key reference
+          * \param[in] data_arg generated DataT object
+          * \return "true" if DataT object could be generated; "false" otherwise
+          */
+        virtual bool
+        genDataTByOctreeKey (const OctreeKey &, DataT &) const
+        {
+          // this class cannot relate DataT objects to octree keys
+          return (false);
+        }
+
+        /** \brief Add DataT object to leaf node at octree key.
+         *  \param key_arg: octree key addressing a leaf node.
+         *  \param data_arg: DataT object to be added.
+         * */
+        virtual void
+        addData (const OctreeKey& key_arg, const DataT& data_arg)
+        {
+          addDataToLeaf (*createLeaf (key_arg, data_arg), data_arg);
+        }
+
+        /** \brief Add DataT object to a leaf node. Called by addData and addDataSorted for every added object.
+         *  \param leaf_arg: leaf node at the octree key of the object.
+         *  \param data_arg: DataT object to be added.
+         * */
+        virtual void
+        addDataToLeaf (LeafNode& leaf_arg, const DataT& data_arg)
+        {
+          leaf_arg.setData (data_arg);
+          objectCount_++;
+        }
+
+        /** \brief Add DataT objects at octree keys sorted in Morton order (see encodeMortonCode).
+         *  \note If the octree does not contain leaf nodes yet, the node arrays are generated level by level from the
+         *  \note sorted keys, so that the children of every branch are allocated exactly once. Otherwise, the objects are
+         *  \note added one by one. The result is identical to calling addData for every key in the given order.
+         *  \param keys_arg: octree keys, sorted in Morton order.
+         *  \param data_arg: DataT objects to be added, one per key.
+         * */
+        void
+        addDataSorted (const std::vector<OctreeKey>& keys_arg, const std::vector<DataT>& data_arg);
+
+        /** \brief Find leaf node
+         *  \param key_arg: octree key addressing a leaf node.
+         *  \return pointer to leaf node. If leaf node is not found, this pointer returns 0.
+         * */
+        LeafNode*
+        findLeaf (const OctreeKey& key_arg) const;
+
+        /** \brief Check for existance of a leaf node in the octree
+         *  \param key_arg: octree key addressing a leaf node.
+         *  \return "true" if leaf node is found; "false" otherwise
+         * */
+        inline bool
+        existLeaf (const OctreeKey& key_arg) const
+        {
+          return ((key_arg <= maxKey_) && (findLeaf (key_arg) != 0));
+        }
+
+        /** \brief Remove leaf node from octree
+         *  \param key_arg: octree key addressing a leaf node.
+         * */
+        inline void
+        removeLeaf (const OctreeKey& key_arg)
+        {
+          if (key_arg <= maxKey_)
+            deleteLeafRecursive (key_arg, depthMask_, rootNode_);
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Branch node accessor inline functions
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        /** \brief Retrieve root node */
+        OctreeNode*
+        getRootNode () const
+        {
+          return this->rootNode_;
+        }
+
+        /** \brief Check if branch is pointing to a particular child node
+         *  \param branch_arg: reference to octree branch class
+         *  \param childIdx_arg: index to child node
+         *  \return "true" if pointer to child node exists; "false" otherwise
+         * */
+        inline bool
+        branchHasChild (const BranchNode& branch_arg, unsigned char childIdx_arg) const
+        {
+          return (branch_arg.hasChild (childIdx_arg));
+        }
+
+        /** \brief Retrieve a child node pointer for child node at childIdx.
+         * \param branch_arg: reference to octree branch class
+         * \param childIdx_arg: index to child node
+         * \return pointer to octree child node class
+         */
+        inline OctreeNode*
+        getBranchChildPtr (const BranchNode& branch_arg,
+            unsigned char childIdx_arg) const
+        {
+          if (!branch_arg.hasChild (childIdx_arg))
+            return (0);
+
+          if (branch_arg.hasLeafChildren ())
+            return (const_cast<LeafNode*> (&leafNodes_[branch_arg.getChildPosition (childIdx_arg)]));
+
+          return (const_cast<BranchNode*> (&branchNodes_[branch_arg.getChildPosition (childIdx_arg)]));
+        }
+
+        /** \brief Assign new child node to branch
+         *  \note Nodes are stored by value: the child branch node is copied to the branch node array and returned to
+         *  \note the branch node pool it has to be allocated from (e.g. a previous root node).
+         *  \param branch_arg: reference to octree branch class
+         *  \param childIdx_arg: index to child node
+         *  \param newChild_arg: pointer to new child node
+         * */
+        inline void setBranchChildPtr (BranchNode& branch_arg,
+            unsigned char childIdx_arg, OctreeNode* newChild_arg)
+        {
+          assert (newChild_arg->getNodeType () == BRANCH_NODE);
+
+          BranchNode* branch = &branch_arg;
+          unsigned int childPos;
+
+          if (branch->hasChild (childIdx_arg))
+            childPos = branch->getChildPosition (childIdx_arg);
+          else
+            childPos = insertBranchChild (branch, childIdx_arg, false);
+
+          branchNodes_[childPos] = *static_cast<BranchNode*> (newChild_arg);
+          branchNodePool_.pushNode (static_cast<BranchNode*> (newChild_arg));
+        }
+
+        /** \brief Get data from octree node
+         *  \param node_arg: node in octree
+         *  \param data_arg: obtain single DataT object from octree node
+         * */
+        inline void getDataFromOctreeNode (const OctreeNode* node_arg,
+            DataT& data_arg)
+        {
+          if (node_arg->getNodeType () == LEAF_NODE)
+          {
+            const LeafT* leafContainer = dynamic_cast<const LeafT*> (node_arg);
+            leafContainer->getData (data_arg);
+          }
+          else
+          {
+            const BranchT* branchContainer =
+                dynamic_cast<const BranchT*> (node_arg);
+            branchContainer->getData (data_arg);
+          }
+        }
+
+        /** \brief Get data from octree node
+         *  \param node_arg: node in octree
+         *  \param data_arg: obtain vector of all DataT objects stored in octree node
+         * */
+        inline void getDataFromOctreeNode (const OctreeNode* node_arg,
+            std::vector<DataT>& data_arg)
+        {
+          if (node_arg->getNodeType () == LEAF_NODE)
+          {
+            const LeafT* leafContainer = dynamic_cast<const LeafT*> (node_arg);
+            leafContainer->getData (data_arg);
+          }
+          else
+          {
+            const BranchT* branchContainer =
+                dynamic_cast<const BranchT*> (node_arg);
+            branchContainer->getData (data_arg);
+          }
+        }
+
+        /** \brief Get data size of octree node container
+         *  \param node_arg: node in octree
+         *  \return data_arg: returns number of DataT objects stored in node container
+         * */
+        inline size_t getDataSizeFromOctreeNode (const OctreeNode* node_arg)
+        {
+          size_t nodeSize;
+          if (node_arg->getNodeType () == LEAF_NODE)
+          {
+            const LeafT* leafContainer = dynamic_cast<const LeafT*> (node_arg);
+            nodeSize = leafContainer->getSize ();
+          }
+          else
+          {
+            const BranchT* branchContainer =
+                dynamic_cast<const BranchT*> (node_arg);
+            nodeSize = branchContainer->getSize ();
+          }
+          return nodeSize;
+        }
+
+        /** \brief Generate bit pattern reflecting the existence of child nodes
+         *  \param branch_arg: reference to octree branch class
+         *  \return a single byte with 8 bits of child node information
+         * */
+        inline char
+        getBranchBitPattern (const BranchNode& branch_arg) const
+        {
+          return (static_cast<char> (branch_arg.getChildMask ()));
+        }
+
+        /** \brief Delete all branch nodes from octree node pool
+         * */
+        inline void
+        poolCleanUp ()
+        {
+          branchNodePool_.deletePool();
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Node array management
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        /** \brief Create a new child node of a branch. The children of the branch are moved to a node array block with
+         *  \brief room for the new child unless their block is located at the end of the node array.
+         *  \param branch_arg: pointer to branch node; updated if the branch node array is reallocated
+         *  \param childIdx_arg: index to child node
+         *  \param leafChild_arg: create a leaf node ("true") or a branch node ("false")
+         *  \return position of the new child node in its node array
+         * */
+        inline unsigned int
+        insertBranchChild (BranchNode*& branch_arg, unsigned char childIdx_arg, bool leafChild_arg)
+        {
+          assert (!branch_arg->hasChild (childIdx_arg));
+          assert (!branch_arg->getChildCount () || (branch_arg->hasLeafChildren () == leafChild_arg));
+
+          // the branch node moves when the branch node array grows
+          const bool arrayBranch = !branchNodes_.empty () && (branch_arg >= &branchNodes_.front ())
+              && (branch_arg <= &branchNodes_.back ());
+          const std::size_t branchPos = arrayBranch ? static_cast<std::size_t> (branch_arg - &branchNodes_.front ()) : 0;
+
+          const unsigned int childCount = branch_arg->getChildCount ();
+          const unsigned int childRank = branch_arg->getChildPosition (childIdx_arg) - branch_arg->getChildOffset ();
+          unsigned int childOffset;
+
+          if (leafChild_arg)
+          {
+            childOffset = insertNode (leafNodes_, freeLeafBlocks_, branch_arg->getChildOffset (), childCount, childRank);
+          }
+          else
+          {
+            childOffset = insertNode (branchNodes_, freeBranchBlocks_, branch_arg->getChildOffset (), childCount, childRank);
+            if (arrayBranch)
+              branch_arg = &branchNodes_[branchPos];
+          }
+
+          branch_arg->setChildren (static_cast<unsigned char> (branch_arg->getChildMask () | (1 << childIdx_arg)),
+                                   childOffset, leafChild_arg);
+
+          return (childOffset + childRank);
+        }
+
+        /** \brief Delete a leaf node or an empty branch node from a branch
+         *  \param branch_arg: reference to octree branch class
+         *  \param childIdx_arg: index to child node
+         * */
+        inline void
+        deleteBranchChild (BranchNode& branch_arg, unsigned char childIdx_arg)
+        {
+          if (!branch_arg.hasChild (childIdx_arg))
+            return;
+
+          const unsigned int childCount = branch_arg.getChildCount ();
+          const unsigned int childRank = branch_arg.getChildPosition (childIdx_arg) - branch_arg.getChildOffset ();
+
+          if (branch_arg.hasLeafChildren ())
+            eraseNode (leafNodes_, freeLeafBlocks_, branch_arg.getChildOffset (), childCount, childRank);
+          else
+          {
+            assert (!branchNodes_[branch_arg.getChildOffset () + childRank].getChildCount ());
+            eraseNode (branchNodes_, freeBranchBlocks_, branch_arg.getChildOffset (), childCount, childRank);
+          }
+
+          if (childCount > 1)
+            branch_arg.setChildren (static_cast<unsigned char> (branch_arg.getChildMask () & ~(1 << childIdx_arg)),
+                                    branch_arg.getChildOffset (), branch_arg.hasLeafChildren ());
+          else
+            branch_arg.setChildren (0, 0, false);
+        }
+
+        /** \brief Allocate a block of consecutive nodes. Blocks released before are reused.
+         *  \param nodes_arg: node array
+         *  \param freeBlocks_arg: offsets of released blocks, one vector per block size
+         *  \param size_arg: number of nodes in block (1..8)
+         *  \return offset of first node of the block
+         * */
+        template<typename NodeT> inline unsigned int
+        allocateNodeBlock (std::vector<NodeT>& nodes_arg, std::vector<unsigned int>* freeBlocks_arg, unsigned int size_arg)
+        {
+          unsigned int offset;
+          std::vector<unsigned int>& freeBlocks = freeBlocks_arg[size_arg - 1];
+
+          if (!freeBlocks.empty ())
+          {
+            offset = freeBlocks.back ();
+            freeBlocks.pop_back ();
+          }
+          else
+          {
+            offset = static_cast<unsigned int> (nodes_arg.size ());
+            nodes_arg.resize (nodes_arg.size () + size_arg);
+          }
+
+          return (offset);
+        }
+
+        /** \brief Release a block of consecutive nodes for reuse.
+         *  \param nodes_arg: node array
+         *  \param freeBlocks_arg: offsets of released blocks, one vector per block size
+         *  \param offset_arg: offset of first node of the block
+         *  \param size_arg: number of nodes in block (1..8)
+         * */
+        template<typename NodeT> inline void
+        releaseNodeBlock (std::vector<NodeT>& nodes_arg, std::vector<unsigned int>* freeBlocks_arg,
+                          unsigned int offset_arg, unsigned int size_arg)
+        {
+          for (unsigned int i = 0; i < size_arg; i++)
+            nodes_arg[offset_arg + i].reset ();
+
+          freeBlocks_arg[size_arg - 1].push_back (offset_arg);
+        }
+
+        /** \brief Insert a node into a block of sibling nodes.
+         *  \param nodes_arg: node array
+         *  \param freeBlocks_arg: offsets of released blocks, one vector per block size
+         *  \param offset_arg: offset of the sibling block
+         *  \param count_arg: number of nodes in sibling block
+         *  \param rank_arg: position of the new node within the sibling block
+         *  \return offset of the enlarged sibling block
+         * */
+        template<typename NodeT> inline unsigned int
+        insertNode (std::vector<NodeT>& nodes_arg, std::vector<unsigned int>* freeBlocks_arg,
+                    unsigned int offset_arg, unsigned int count_arg, unsigned int rank_arg)
+        {
+          unsigned int newOffset;
+          unsigned int i;
+
+          if (count_arg && (offset_arg + count_arg == nodes_arg.size ()))
+          {
+            // block is located at the end of the node array and grows in place
+            newOffset = offset_arg;
+            nodes_arg.resize (nodes_arg.size () + 1);
+            for (i = count_arg; i > rank_arg; i--)
+              nodes_arg[newOffset + i] = nodes_arg[newOffset + i - 1];
+          }
+          else
+          {
+            // move siblings to a larger block
+            newOffset = allocateNodeBlock (nodes_arg, freeBlocks_arg, count_arg + 1);
+            for (i = 0; i < count_arg; i++)
+              nodes_arg[newOffset + i + (i >= rank_arg)] = nodes_arg[offset_arg + i];
+            if (count_arg)
+              releaseNodeBlock (nodes_arg, freeBlocks_arg, offset_arg, count_arg);
+          }
+
+          nodes_arg[newOffset + rank_arg].reset ();
+
+          return (newOffset);
+        }
+
+        /** \brief Erase a node from a block of sibling nodes. The last node of the block is released.
+         *  \param nodes_arg: node array
+         *  \param freeBlocks_arg: offsets of released blocks, one vector per block size
+         *  \param offset_arg: offset of the sibling block
+         *  \param count_arg: number of nodes in sibling block
+         *  \param rank_arg: position of the node within the sibling block
+         * */
+        template<typename NodeT> inline void
+        eraseNode (std::vector<NodeT>& nodes_arg, std::vector<unsigned int>* freeBlocks_arg,
+                   unsigned int offset_arg, unsigned int count_arg, unsigned int rank_arg)
+        {
+          for (unsigned int i = rank_arg + 1; i < count_arg; i++)
+            nodes_arg[offset_arg + i - 1] = nodes_arg[offset_arg + i];
+
+          if (offset_arg + count_arg == nodes_arg.size ())
+            nodes_arg.pop_back ();
+          else
+            releaseNodeBlock (nodes_arg, freeBlocks_arg, offset_arg + count_arg - 1, 1);
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Octree construction methods
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        /** \brief Create a leaf node at octree key. If leaf node does already exist, it is returned.
+         *  \param key_arg: reference to an octree key
+         *  \param data_arg data to be added
+         *  \return pointer to leaf node
+         **/
+        LeafNode*
+        createLeaf (const OctreeKey& key_arg, const DataT& data_arg);
+
+        /** \brief Generate the node arrays of an empty octree for a set of leaf nodes.
+         *  \note Branch nodes are stored level by level, leaf nodes in the order of their keys.
+         *  \param leafKeys_arg: unique octree keys of the leaf nodes, sorted in Morton order
+         **/
+        void
+        buildLinearTree (const std::vector<OctreeKey>& leafKeys_arg);
+
+        /** \brief Recursively search and delete leaf node
+         *  \param key_arg: reference to an octree key
+         *  \param depthMask_arg: depth mask used for octree key analysis and branch depth indicator
+         *  \param branch_arg: current branch node
+         *  \return "true" if branch does not contain any childs; "false" otherwise. This indicates if current branch can be deleted, too.
+         **/
+        bool
+        deleteLeafRecursive (const OctreeKey& key_arg, unsigned int depthMask_arg, BranchNode* branch_arg);
+
+        /** \brief Recursively explore the octree and output binary octree description together with a vector of leaf node DataT content.
+          *  \param binaryTreeOut_arg: binary output vector
+          *  \param branch_arg: current branch node
+          *  \param key_arg: reference to an octree key
+         *  \param dataVector_arg: writes DataT content to this DataT vector.
+         **/
+        void
+        serializeTreeRecursive (const BranchNode* branch_arg, OctreeKey& key_arg,
+            std::vector<char>* binaryTreeOut_arg,
+            typename std::vector<DataT>* dataVector_arg) const;
+
+        /** \brief Recursively read a binary octree description and collect the keys of its leaf nodes.
+          *  \param depthMask_arg: depth mask used for octree key analysis and branch depth indicator
+          *  \param key_arg: reference to an octree key
+          *  \param binaryTreeIT_arg: iterator to input vector
+          *  \param binaryTreeIT_End_arg: end iterator of input vector
+          *  \param leafKeys_arg: receives the keys of the leaf nodes in Morton order
+          **/
+        void
+        deserializeTreeRecursive (unsigned int depthMask_arg, OctreeKey& key_arg,
+            typename std::vector<char>::const_iterator& binaryTreeIT_arg,
+            typename std::vector<char>::const_iterator& binaryTreeIT_End_arg,
+            std::vector<OctreeKey>& leafKeys_arg) const;
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Serialization callbacks
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        /** \brief Callback executed for every leaf node during serialization
+         **/
+        virtual void serializeTreeCallback (const LeafNode &,
+            const OctreeKey &) const
+        {
+
+        }
+
+        /** \brief Callback executed for every leaf node during deserialization
+         **/
+        virtual void deserializeTreeCallback (LeafNode&, const OctreeKey&)
+        {
+
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Helpers
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        /** \brief Helper function to calculate the binary logarithm
+         * \param n_arg: some value
+         * \return binary logarithm (log2) of argument n_arg
+         */
+        inline double
+        Log2 (double n_arg)
+        {
+          return log( n_arg ) / log( 2.0 );
+        }
+
+        /** \brief Test if octree is able to dynamically change its depth. This is required for adaptive bounding box adjustment.
+         *  \return "true"
+         **/
+        inline bool
+        octreeCanResize ()
+        {
+          return (true);
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Globals
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        /** \brief Amount of leaf nodes   **/
+        std::size_t leafCount_;
+
+        /** \brief Amount of branch nodes   **/
+        std::size_t branchCount_;
+
+        /** \brief Amount of objects assigned to leaf nodes   **/
+        std::size_t objectCount_;
+
+        /** \brief Pointer to root branch node of octree   **/
+        BranchNode* rootNode_;
+
+        /** \brief Depth mask based on octree depth   **/
+        unsigned int depthMask_;
+
+        /** \brief Octree depth */
+        unsigned int octreeDepth_;
+
+        /** \brief key range */
+        OctreeKey maxKey_;
+
+        /** \brief Branch nodes below the root node   **/
+        std::vector<BranchNode> branchNodes_;
+
+        /** \brief Leaf nodes   **/
+        std::vector<LeafNode> leafNodes_;
+
+        /** \brief Offsets of released branch node blocks, per block size   **/
+        std::vector<unsigned int> freeBranchBlocks_[8];
+
+        /** \brief Offsets of released leaf node blocks, per block size   **/
+        std::vector<unsigned int> freeLeafBlocks_[8];
+
+        /** \brief Pool of unused root branch nodes   **/
+        OctreeNodePool<BranchNode> branchNodePool_;
+    };
+  }
+}
+
+//#include "impl/octree_linear_base.hpp"
+
+#endif
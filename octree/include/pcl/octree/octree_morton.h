@@ -0,0 +1,161 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_MORTON_H
+#define PCL_OCTREE_MORTON_H
+
+#include <vector>
+#include <algorithm>
+
+#include <boost/cstdint.hpp>
+
+#include "octree_key.h"
+
+namespace pcl
+{
+  namespace octree
+  {
+    /** \brief Maximum octree depth for which an octree key fits into a 64 bit Morton code. */
+    const unsigned int MORTON_MAX_TREE_DEPTH = 21;
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief @b Morton code of an octree key, together with the index of the element it was computed for.
+     *  \note Sorting Morton codes orders the octree keys depth-first, visiting children in the order of their child
+     *  \note index. Elements sharing a voxel at any tree level are therefore contiguous once sorted.
+     *  \author Open Perception
+     */
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct MortonCode
+    {
+      /** \brief Interleaved key bits. */
+      boost::uint64_t code;
+      /** \brief Index of the element this code was computed for. */
+      int index;
+    };
+
+    /** \brief Spread the lower 21 bits of a value so that two zero bits separate consecutive bits.
+     *  \param[in] value_arg value to spread
+     *  \return spread bits
+     */
+    inline boost::uint64_t
+    spreadMortonBits (unsigned int value_arg)
+    {
+      boost::uint64_t x = value_arg & 0x1fffff;
+      x = (x | x << 32) & 0x1f00000000ffffULL;
+      x = (x | x << 16) & 0x1f0000ff0000ffULL;
+      x = (x | x << 8)  & 0x100f00f00f00f00fULL;
+      x = (x | x << 4)  & 0x10c30c30c30c30c3ULL;
+      x = (x | x << 2)  & 0x1249249249249249ULL;
+      return (x);
+    }
+
+    /** \brief Compute the Morton code of an octree key, for trees up to MORTON_MAX_TREE_DEPTH levels.
+     *  \note Every group of 3 bits holds the child index (see OctreeKey::getChildIdxWithDepthMask) of one tree level, the
+     *  \note root level being the most significant one.
+     *  \param[in] key_arg octree key
+     *  \return Morton code of the key
+     */
+    inline boost::uint64_t
+    encodeMortonCode (const OctreeKey& key_arg)
+    {
+      return ((spreadMortonBits (key_arg.x) << 2) | (spreadMortonBits (key_arg.y) << 1) | spreadMortonBits (key_arg.z));
+    }
+
+    /** \brief Stable least significant digit radix sort of Morton codes.
+     *  \note Every pass sorts one byte of the codes. Each thread counts and scatters a contiguous chunk of the codes,
+     *  \note which keeps the sort stable for any number of threads.
+     *  \param[in,out] codes_arg Morton codes to sort
+     *  \param[in] bitCount_arg number of significant bits in the codes (3 x tree depth)
+     *  \param[in] threadCount_arg number of threads to use
+     */
+    inline void
+    sortMortonCodes (std::vector<MortonCode>& codes_arg, unsigned int bitCount_arg, unsigned int threadCount_arg = 1)
+    {
+      const int codeCount = static_cast<int> (codes_arg.size ());
+      const int chunkCount = std::max (1, std::min (static_cast<int> (threadCount_arg), codeCount));
+      const int chunkSize = (codeCount + chunkCount - 1) / chunkCount;
+      const unsigned int passCount = (bitCount_arg + 7) / 8;
+
+      std::vector<MortonCode> buffer (codes_arg.size ());
+      std::vector<int> offsets (chunkCount * 256);
+
+      for (unsigned int pass = 0; pass < passCount; ++pass)
+      {
+        const unsigned int shift = pass * 8;
+        std::fill (offsets.begin (), offsets.end (), 0);
+
+        // count the digits of every chunk
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(chunkCount) schedule(static, 1)
+#endif
+        for (int chunk = 0; chunk < chunkCount; ++chunk)
+        {
+          int* histogram = &offsets[chunk * 256];
+          const int end = std::min (codeCount, (chunk + 1) * chunkSize);
+          for (int i = chunk * chunkSize; i < end; ++i)
+            ++histogram[(codes_arg[i].code >> shift) & 0xff];
+        }
+
+        // turn the counts into output offsets: digits first, then chunks in order
+        int offset = 0;
+        for (int digit = 0; digit < 256; ++digit)
+          for (int chunk = 0; chunk < chunkCount; ++chunk)
+          {
+            const int count = offsets[chunk * 256 + digit];
+            offsets[chunk * 256 + digit] = offset;
+            offset += count;
+          }
+
+        // scatter every chunk to its offsets
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(chunkCount) schedule(static, 1)
+#endif
+        for (int chunk = 0; chunk < chunkCount; ++chunk)
+        {
+          int* chunkOffsets = &offsets[chunk * 256];
+          const int end = std::min (codeCount, (chunk + 1) * chunkSize);
+          for (int i = chunk * chunkSize; i < end; ++i)
+            buffer[chunkOffsets[(codes_arg[i].code >> shift) & 0xff]++] = codes_arg[i];
+        }
+
+        codes_arg.swap (buffer);
+      }
+    }
+  }
+}
+
+#endif
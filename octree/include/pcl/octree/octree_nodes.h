@@ -265,6 +265,171 @@ namespace pcl
       protected:
         OctreeNode* childNodeArray_[8];
       };
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief @b Branch node class of linear octrees (see OctreeLinearBase)
+     *  \note Instead of eight child pointers, the branch stores a bit mask of its existing children and the offset of its
+     *  \note first child within the node array of the octree. The children of a branch are stored contiguously in the
+     *  \note order of their child index, so a child is found at the offset plus the number of children with smaller index.
+     *  \author Open Perception
+     */
+    template<typename ContainerT>
+      class OctreeLinearBranchNode : public OctreeNode, ContainerT
+      {
+      public:
+
+        using ContainerT::getSize;
+        using ContainerT::getData;
+        using ContainerT::setData;
+
+        /** \brief Empty constructor. */
+        OctreeLinearBranchNode () :
+            OctreeNode (), ContainerT (), childMask_ (0), leafChildren_ (false), childOffset_ (0)
+        {
+        }
+
+        /** \brief Copy constructor. Child offsets refer to the node arrays of the owning octree. */
+        OctreeLinearBranchNode (const OctreeLinearBranchNode& source) :
+            OctreeNode (), ContainerT (source), childMask_ (source.childMask_),
+            leafChildren_ (source.leafChildren_), childOffset_ (source.childOffset_)
+        {
+        }
+
+        /** \brief Copy operator. */
+        inline OctreeLinearBranchNode&
+        operator = (const OctreeLinearBranchNode &source)
+        {
+          ContainerT::operator= (source);
+          childMask_ = source.childMask_;
+          leafChildren_ = source.leafChildren_;
+          childOffset_ = source.childOffset_;
+          return (*this);
+        }
+
+        /** \brief Octree deep copy method. Only the node itself is copied, its children are owned by the octree. */
+        virtual OctreeLinearBranchNode*
+        deepCopy () const
+        {
+          return (new OctreeLinearBranchNode<ContainerT> (*this));
+        }
+
+        /** \brief Empty deconstructor. */
+        virtual
+        ~OctreeLinearBranchNode ()
+        {
+        }
+
+        /** \brief Reset branch node container and remove all children. */
+        inline
+        void
+        reset ()
+        {
+          childMask_ = 0;
+          leafChildren_ = false;
+          childOffset_ = 0;
+          ContainerT::reset ();
+        }
+
+        /** \brief Check if branch has a particular child node
+         *  \param childIdx_arg: index to child node
+         *  \return "true" if child node exists; "false" otherwise
+         * */
+        inline bool
+        hasChild (unsigned char childIdx_arg) const
+        {
+          assert(childIdx_arg < 8);
+          return ((childMask_ & (1 << childIdx_arg)) != 0);
+        }
+
+        /** \brief Get bit pattern of existing children
+         *  \return child mask with one bit per child index
+         * */
+        inline unsigned char
+        getChildMask () const
+        {
+          return childMask_;
+        }
+
+        /** \brief Get number of child nodes
+         *  \return number of existing children
+         * */
+        inline unsigned int
+        getChildCount () const
+        {
+          return countBits (childMask_);
+        }
+
+        /** \brief Check if the children of this branch are leaf nodes
+         *  \return "true" if children are leaf nodes; "false" if they are branch nodes
+         * */
+        inline bool
+        hasLeafChildren () const
+        {
+          return leafChildren_;
+        }
+
+        /** \brief Get offset of first child node in the node array of the octree
+         *  \return offset of the first child
+         * */
+        inline unsigned int
+        getChildOffset () const
+        {
+          return childOffset_;
+        }
+
+        /** \brief Get position of a child node in the node array of the octree
+         *  \param childIdx_arg: index to child node
+         *  \return array position of the child; if the child does not exist, the position it would be inserted at
+         * */
+        inline unsigned int
+        getChildPosition (unsigned char childIdx_arg) const
+        {
+          assert(childIdx_arg < 8);
+          return childOffset_ + countBits (childMask_ & ((1 << childIdx_arg) - 1));
+        }
+
+        /** \brief Set child configuration of branch
+         *  \param childMask_arg: bit pattern of existing children
+         *  \param childOffset_arg: offset of first child node in the node array of the octree
+         *  \param leafChildren_arg: "true" if children are leaf nodes
+         * */
+        inline void
+        setChildren (unsigned char childMask_arg, unsigned int childOffset_arg, bool leafChildren_arg)
+        {
+          childMask_ = childMask_arg;
+          childOffset_ = childOffset_arg;
+          leafChildren_ = leafChildren_arg;
+        }
+
+        /** \brief Get the type of octree node. Returns BRANCH_NODE type */
+        virtual node_type_t
+        getNodeType () const
+        {
+          return BRANCH_NODE;
+        }
+
+      protected:
+        /** \brief Count set bits of a child mask
+         *  \param mask_arg: child mask
+         *  \return number of set bits
+         * */
+        static inline unsigned int
+        countBits (unsigned int mask_arg)
+        {
+          mask_arg = mask_arg - ((mask_arg >> 1) & 0x55);
+          mask_arg = (mask_arg & 0x33) + ((mask_arg >> 2) & 0x33);
+          return ((mask_arg + (mask_arg >> 4)) & 0x0f);
+        }
+
+        /** \brief Bit pattern of existing children. */
+        unsigned char childMask_;
+
+        /** \brief Children are leaf nodes. */
+        bool leafChildren_;
+
+        /** \brief Offset of first child in node array. */
+        unsigned int childOffset_;
+      };
   }
 }
 
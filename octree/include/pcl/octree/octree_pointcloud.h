@@ -47,6 +47,7 @@
 
 #include "octree_nodes.h"
 #include "octree_iterator.h"
+#include "octree_morton.h"
 
 #include <queue>
 #include <vector>
@@ -206,10 +207,36 @@ namespace pcl
           return this->octreeDepth_;
         }
 
+        /** \brief Set the number of threads used by addPointsFromInputCloudBulk, by the batch searches of
+         * OctreePointCloudSearch and by the entropy coding of OctreePointCloudCompression.
+         * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+         */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+        }
+
+        /** \brief Get the number of threads used by the parallel operations of the octree (0 means automatic). */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
         /** \brief Add points from input point cloud to octree. */
         void
         addPointsFromInputCloud ();
 
+        /** \brief Add points from input point cloud to octree in bulk.
+         * \note The octree keys and their Morton codes are computed for all points in parallel and radix sorted, then the
+         * \note branch and leaf nodes are created in a single pass over the sorted keys. The resulting octree is the same
+         * \note as the one built by addPointsFromInputCloud, and the point indices within every leaf keep their order.
+         * \note Octrees deeper than MORTON_MAX_TREE_DEPTH levels fall back to addPointsFromInputCloud.
+         */
+        void
+        addPointsFromInputCloudBulk ();
+
         /** \brief Add point at given index from input point cloud to octree. Index will be also added to indices vector.
          * \param[in] pointIdx_arg index of point to be added
          * \param[in] indices_arg pointer to indices vector of the dataset (given by \a setInputCloud)
@@ -540,6 +567,9 @@ namespace pcl
 
         /** \brief Flag indicating if octree has defined bounding box. */
         bool boundingBoxDefined_;
+
+        /** \brief The number of threads used by addPointsFromInputCloudBulk and the batch searches (0 means automatic). */
+        unsigned int threads_;
     };
   }
 }
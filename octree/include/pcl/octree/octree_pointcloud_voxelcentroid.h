@@ -158,25 +158,19 @@ namespace pcl
         {
         }
 
-        /** \brief Add DataT object to leaf node at octree key.
-          * \param[in] key_arg octree key addressing a leaf node.
-          * \param[in] data_arg DataT object to be added.
+        /** \brief Add DataT object to a leaf node: accumulate the point it refers to in the voxel centroid.
+          * \param[in] leaf_arg leaf node at the octree key of the point.
+          * \param[in] data_arg index of the point to be added.
           */
         virtual void 
-        addData (const OctreeKey& key_arg, const int& data_arg)
+        addDataToLeaf (LeafNode& leaf_arg, const int& data_arg)
         {
-          LeafNode* new_leaf = 0;
-          this->createLeafRecursive (key_arg, this->depthMask_, data_arg, this->rootNode_, new_leaf);
+          const PointT& cloudPoint = this->getPointByIndex (data_arg);
 
-          if (new_leaf)
-          {
-            const PointT& cloudPoint = this->getPointByIndex (data_arg);
-
-            // add data to leaf
-            LeafT* container = new_leaf;
-            container->addPoint (cloudPoint);
-            this->objectCount_++;
-          }
+          // add data to leaf
+          LeafT* container = &leaf_arg;
+          container->addPoint (cloudPoint);
+          this->objectCount_++;
         }
 
         /** \brief Get centroid for a single voxel addressed by a PointT point.
@@ -55,11 +55,13 @@ namespace pcl
     /** \brief @b Octree pointcloud search class
       * \note This class provides several methods for spatial neighbor search based on octree structure
       * \note typename: PointT: type of point used in pointcloud
+      * \note typename: OctreeBaseT: octree implementation (e.g. OctreeBase or OctreeLinearBase)
       * \ingroup octree
       * \author Julius Kammerl (julius@kammerl.de)
       */
-    template<typename PointT, typename LeafT = OctreeContainerDataTVector<int> ,  typename BranchT = OctreeContainerEmpty<int> >
-    class OctreePointCloudSearch : public OctreePointCloud<PointT, LeafT, BranchT>
+    template<typename PointT, typename LeafT = OctreeContainerDataTVector<int> ,  typename BranchT = OctreeContainerEmpty<int>,
+        typename OctreeBaseT = OctreeBase<int, LeafT, BranchT> >
+    class OctreePointCloudSearch : public OctreePointCloud<PointT, LeafT, BranchT, OctreeBaseT>
     {
       public:
         // public typedefs
@@ -71,13 +73,13 @@ namespace pcl
         typedef boost::shared_ptr<const PointCloud> PointCloudConstPtr;
 
         // Boost shared pointers
-        typedef boost::shared_ptr<OctreePointCloudSearch<PointT, LeafT, BranchT> > Ptr;
-        typedef boost::shared_ptr<const OctreePointCloudSearch<PointT, LeafT, BranchT> > ConstPtr;
+        typedef boost::shared_ptr<OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT> > Ptr;
+        typedef boost::shared_ptr<const OctreePointCloudSearch<PointT, LeafT, BranchT, OctreeBaseT> > ConstPtr;
 
         // Eigen aligned allocator
         typedef std::vector<PointT, Eigen::aligned_allocator<PointT> > AlignedPointTVector;
 
-        typedef OctreePointCloud<PointT, LeafT, BranchT> OctreeT;
+        typedef OctreePointCloud<PointT, LeafT, BranchT, OctreeBaseT> OctreeT;
         typedef typename OctreeT::LeafNode LeafNode;
         typedef typename OctreeT::BranchNode BranchNode;
 
@@ -85,7 +87,7 @@ namespace pcl
           * \param[in] resolution octree resolution at lowest octree level
           */
         OctreePointCloudSearch (const double resolution) :
-          OctreePointCloud<PointT, LeafT, BranchT> (resolution)
+          OctreePointCloud<PointT, LeafT, BranchT, OctreeBaseT> (resolution)
         {
         }
 
@@ -225,6 +227,41 @@ namespace pcl
         radiusSearch (int index, const double radius, std::vector<int> &k_indices,
                       std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
 
+        /** \brief Search for k-nearest neighbors of a batch of query points.
+          * \note The queries are sorted in Morton order and processed in chunks by parallel threads (see
+          * \note setNumberOfThreads). Every query continues from the tree path of the previous query of its thread and
+          * \note bounds its search by the neighbors of that query, so that it only explores the subtree around its voxel.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all points of \a cloud are queried.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i] corresponds to query i
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, k_sqr_distances[i]
+          * corresponds to query i
+          */
+        void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        std::vector<std::vector<int> > &k_indices,
+                        std::vector<std::vector<float> > &k_sqr_distances) const;
+
+        /** \brief Search for all neighbors within a given radius of a batch of query points.
+          * \note The queries are sorted in Morton order and processed in chunks by parallel threads (see
+          * \note setNumberOfThreads). Every query continues from the tree path of the previous query of its thread and
+          * \note starts its search at the deepest node that encloses the search sphere. The neighbors of every query are
+          * \note returned in the same order as by the single query radiusSearch.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all points of \a cloud are queried.
+          * \param[in] radius the radius of the spheres bounding the neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i] corresponds to query i
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, k_sqr_distances[i]
+          * corresponds to query i
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+          */
+        void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                      std::vector<std::vector<int> > &k_indices,
+                      std::vector<std::vector<float> > &k_sqr_distances,
+                      unsigned int max_nn = 0) const;
+
         /** \brief Get a PointT vector of centers of all voxels that intersected by a ray (origin, direction).
           * \param[in] origin ray origin
           * \param[in] direction ray direction vector
@@ -344,6 +381,86 @@ namespace pcl
             float pointDistance_;
         };
 
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        /** \brief @b Priority queue entry for the batch searches
+          * \note In contrast to prioBranchQueueEntry, entries store the depth of their node, as the batch searches keep
+          * \note branch and leaf nodes of all tree levels in a single queue.
+          * \author Open Perception
+          */
+        class batchQueueEntry
+        {
+          public:
+            /** \brief Empty constructor  */
+            batchQueueEntry () : node (), pointDistance (0), key (), depth (0)
+            {
+            }
+
+            /** \brief Constructor for initializing queue entry.
+              * \param[in] _node pointer to octree node
+              * \param[in] _key octree key addressing voxel in octree structure
+              * \param[in] _depth depth of the voxel in the octree
+              * \param[in] _point_distance squared distance of query point to voxel
+              */
+            batchQueueEntry (const OctreeNode* _node, const OctreeKey& _key, unsigned int _depth, float _point_distance) :
+              node (_node), pointDistance (_point_distance), key (_key), depth (_depth)
+            {
+            }
+
+            /** \brief Operator< for comparing queue entries with each other, the closest entry has the highest priority.
+              * \param[in] rhs the queue entry to compare this against
+              */
+            bool
+            operator < (const batchQueueEntry& rhs) const
+            {
+              return (this->pointDistance > rhs.pointDistance);
+            }
+
+            /** \brief Pointer to octree node. */
+            const OctreeNode* node;
+
+            /** \brief Squared distance of query point to voxel. */
+            float pointDistance;
+
+            /** \brief Octree key. */
+            OctreeKey key;
+
+            /** \brief Depth of the voxel in the octree. */
+            unsigned int depth;
+        };
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        /** \brief @b State of a thread running batch searches
+          * \note Holds the branch nodes on the path from the root to the voxel of the last query, and the search buffers.
+          * \note Queries in Morton order share most of their path, and the buffers stop growing after a few queries.
+          * \author Open Perception
+          */
+        class BatchSearchState
+        {
+          public:
+            /** \brief Empty constructor  */
+            BatchSearchState () : pathNodes (), pathKey (), pathDepth (0), nodeQueue (), pointQueue (), leafData ()
+            {
+            }
+
+            /** \brief Branch nodes on the path to the voxel of the last query, pathNodes[0] is the root node. */
+            std::vector<const BranchNode*> pathNodes;
+
+            /** \brief Leaf key of the last query. */
+            OctreeKey pathKey;
+
+            /** \brief Number of valid entries in pathNodes. */
+            unsigned int pathDepth;
+
+            /** \brief Queue (k-NN search) or stack (radius search) of nodes to be explored. */
+            std::vector<batchQueueEntry> nodeQueue;
+
+            /** \brief Max-heap of the k nearest point candidates. */
+            std::vector<prioPointQueueEntry> pointQueue;
+
+            /** \brief Buffer for the point indices of a leaf node. */
+            std::vector<int> leafData;
+        };
+
         /** \brief Helper function to calculate the squared distance between two points
           * \param[in] pointA point A
           * \param[in] pointB point B
@@ -352,6 +469,76 @@ namespace pcl
         float
         pointSquaredDist (const PointT& pointA, const PointT& pointB) const;
 
+        /** \brief Helper function to calculate the squared distance between a point and an octree voxel
+          * \param[in] point query point
+          * \param[in] key octree key addressing the voxel
+          * \param[in] treeDepth depth of the voxel in the octree
+          * \return squared distance between the point and the closest point of the voxel (0 if the voxel contains it)
+          */
+        double
+        pointSquaredVoxelDist (const PointT& point, const OctreeKey& key, unsigned int treeDepth) const;
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Batch search routine methods
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        /** \brief Sort the query points of a batch search in Morton order of their voxels.
+          * \note Queries outside the bounding box of the octree are sorted by the closest voxel of the bounding box.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices in \a cloud of the query points (empty: all points)
+          * \param[in] threadCount number of threads to use
+          * \param[out] queryOrder positions of the queries in \a indices (or \a cloud) in Morton order
+          */
+        void
+        sortBatchQueries (const PointCloud &cloud, const std::vector<int> &indices, int threadCount,
+                          std::vector<int> &queryOrder) const;
+
+        /** \brief Update the tree path of a batch search state for a query point and find the node to start the search at.
+          * \note The path of the previous query is kept down to the deepest voxel shared by both queries.
+          * \param[in] point query point
+          * \param[in] squaredSearchRadius squared radius of a sphere around the query point holding all search results
+          * \param[in,out] state batch search state holding the tree path
+          * \param[out] key octree key addressing the start node
+          * \param[out] treeDepth depth of the start node in the octree
+          * \return deepest branch node on the path whose voxel encloses the search sphere
+          */
+        const BranchNode*
+        getBatchSearchStartNode (const PointT& point, const double squaredSearchRadius, BatchSearchState& state,
+                                 OctreeKey& key, unsigned int& treeDepth) const;
+
+        /** \brief Best-first search for the K nearest neighbors of a query point within the subtree of a node
+          * \param[in] point query point
+          * \param[in] K amount of nearest neighbors to be found
+          * \param[in] node octree node to start the search at
+          * \param[in] key octree key addressing the start node
+          * \param[in] treeDepth depth of the start node in the octree
+          * \param[in] squaredSearchRadius squared distance of the K-th nearest neighbor is known to be at most this value
+          * \param[in,out] state batch search state providing the search buffers
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          */
+        void
+        getKNearestNeighborBatch (const PointT& point, unsigned int K, const BranchNode* node, const OctreeKey& key,
+                                  unsigned int treeDepth, const double squaredSearchRadius, BatchSearchState& state,
+                                  std::vector<int>& k_indices, std::vector<float>& k_sqr_distances) const;
+
+        /** \brief Depth-first search for the neighbors within a given radius of a query point within the subtree of a node
+          * \param[in] point query point
+          * \param[in] radiusSquared squared search radius
+          * \param[in] node octree node to start the search at
+          * \param[in] key octree key addressing the start node
+          * \param[in] treeDepth depth of the start node in the octree
+          * \param[in,out] state batch search state providing the search buffers
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn maximum of neighbors to be found
+          */
+        void
+        getNeighborsWithinRadiusBatch (const PointT& point, const double radiusSquared, const BranchNode* node,
+                                       const OctreeKey& key, unsigned int treeDepth, BatchSearchState& state,
+                                       std::vector<int>& k_indices, std::vector<float>& k_sqr_distances,
+                                       unsigned int max_nn) const;
+
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         // Recursive search routine methods
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -55,6 +55,10 @@ template class PCL_EXPORTS pcl::octree::Octree2BufBase<int,
     pcl::octree::OctreeContainerDataTVector<int>,
     pcl::octree::OctreeContainerEmpty<int> >;
 
+template class PCL_EXPORTS pcl::octree::OctreeLinearBase<int,
+    pcl::octree::OctreeContainerDataTVector<int>,
+    pcl::octree::OctreeContainerEmpty<int> >;
+
 PCL_INSTANTIATE(OctreePointCloudSingleBufferWithLeafDataTVector,
     PCL_XYZ_POINT_TYPES)
 PCL_INSTANTIATE(OctreePointCloudDoubleBufferWithLeafDataTVector,
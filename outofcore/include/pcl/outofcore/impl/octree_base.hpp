@@ -53,6 +53,10 @@
 #include <string>
 #include <exception>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace pcl
 {
   namespace outofcore
@@ -73,6 +77,8 @@ namespace pcl
       : root_ ()
       , read_write_mutex_ ()
       , lodPoints_ ()
+      , lod_mutex_ ()
+      , threads_ (0)
       , max_depth_ ()
       , treepath_ ()
       , coord_system_ ()
@@ -103,6 +109,8 @@ namespace pcl
       : root_ ()
       , read_write_mutex_ ()
       , lodPoints_ ()
+      , lod_mutex_ ()
+      , threads_ (0)
       , max_depth_ ()
       , treepath_ ()
       , coord_system_ ()
@@ -148,6 +156,8 @@ namespace pcl
       : root_ ()
       , read_write_mutex_ ()
       , lodPoints_ ()
+      , lod_mutex_ ()
+      , threads_ (0)
       , max_depth_ ()
       , treepath_ ()
       , coord_system_ ()
@@ -571,6 +581,33 @@ namespace pcl
       return (result);
     }
 
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> bool
+    OutofcoreOctreeBase<ContainerT, PointT>::setPayloadEncoding (const OutofcoreOctreeNodeMetadata::PayloadEncoding encoding)
+    {
+      boost::unique_lock < boost::shared_mutex > lock (read_write_mutex_);
+
+      if (root_->num_child_ != 0 || root_->hasUnloadedChildren () || !root_->payload_->empty ())
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBase::%s] The payload encoding can only be changed on an empty tree\n", __FUNCTION__);
+        return (false);
+      }
+
+      root_->node_metadata_->setPayloadEncoding (encoding);
+      root_->applyPayloadEncoding ();
+      root_->saveIdx (false);
+      return (true);
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> OutofcoreOctreeNodeMetadata::PayloadEncoding
+    OutofcoreOctreeBase<ContainerT, PointT>::getPayloadEncoding () const
+    {
+      return (root_->node_metadata_->getPayloadEncoding ());
+    }
+
 ////////////////////////////////////////////////////////////////////////////////
 
     template<typename ContainerT, typename PointT> void
@@ -583,88 +620,66 @@ namespace pcl
       }
       boost::unique_lock < boost::shared_mutex > lock (read_write_mutex_);
 
-      const int current_dims = 1;
-      OutofcoreOctreeBaseNode<ContainerT, PointT>* current_branch[current_dims] = {root_};
-      this->buildLODRecursive (current_branch, current_dims);
+      //the point counts of every level are rebuilt from the leaves up
+      lodPoints_.assign (max_depth_ + 1, 0);
+      this->buildLODRecursive (root_);
     }
 ////////////////////////////////////////////////////////////////////////////////
 
     template<typename ContainerT, typename PointT> void
-    OutofcoreOctreeBase<ContainerT, PointT>::buildLODRecursive (OutofcoreOctreeBaseNode<ContainerT, PointT>** current_branch, const int current_dims)
+    OutofcoreOctreeBase<ContainerT, PointT>::buildLODRecursive (OutofcoreOctreeBaseNode<ContainerT, PointT>* node)
     {
-      //stop if this brach does not exist
-      if (!current_branch[current_dims - 1])
+      typedef OutofcoreOctreeBaseNode<ContainerT, PointT> NodeT;
+
+      if ((node->num_child_ < 8) && (node->hasUnloadedChildren ()))
+        node->loadChildren (false);
+
+      //at leaf: the points stay where they are, they are the finest level of detail
+      if (node->num_child_ == 0)
       {
+        incrementPointsInLOD (node->depth_, node->payload_->size ());
         return;
       }
 
-      if ((current_branch[current_dims - 1]->numchildren () == 0)
-          && (!current_branch[current_dims - 1]->hasUnloadedChildren ()))//at leaf: subsample, remove, and copy to higher nodes
-      {
-        //this node's idx is (current_dims-1)
-        OutofcoreOctreeBaseNode<ContainerT, PointT>* leaf = current_branch[current_dims - 1];
+      //clear this node, in case we are updating the LOD
+      node->payload_->clear ();
 
-        boost::uint64_t leaf_start_size = leaf->payload->size ();
-        if (leaf_start_size > 0)//skip empty
-        {
-          for (boost::uint64_t startp = 0; startp < leaf_start_size; startp += LOAD_COUNT_)
-          {
-            //there are (current_dims-1) nodes above this one, indexed 0 thru (current_dims-2)
-            for (size_t level = (current_dims - 1); level >= 1; level--)
-            {
-              //the target
-              OutofcoreOctreeBaseNode<ContainerT, PointT>* target_parent = current_branch[level - 1];
-
-              //the percent to copy
-              //each level up the chain gets sample_precent^l of the leaf's data
-              double percent = pow (double (OutofcoreOctreeBaseNode<ContainerT, PointT>::sample_precent), double (current_dims - level));
-
-              //read in percent of node
-              AlignedPointTVector v;
-              if ((startp + LOAD_COUNT_) < leaf_start_size)
-              {
-                leaf->payload->readRangeSubSample (startp, LOAD_COUNT_, percent, v);
-              }
-              else
-              {
-                leaf->payload->readRangeSubSample (startp, leaf_start_size - startp, percent, v);
-              }
-
-              //write to the target
-              if (!v.empty ())
-              {
-                target_parent->payload->insertRange ( v );
-//                target_parent->payload->insertRange (&(v.front ()), v.size ());
-                this->incrementPointsInLOD (target_parent->depth, v.size ());
-              }
-
-            }
-          }
-        }
-      }
-      else//not at leaf, keep going down
+      //build the children first; the subtrees of the root do not share any
+      //node, so each of them is handed to its own worker
+#ifdef _OPENMP
+      const int threads = (node == root_) ? static_cast<int> (threads_ ? threads_ : omp_get_max_threads ()) : 1;
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threads) if(threads > 1)
+#endif
+      for (int i = 0; i < 8; i++)
       {
-        //clear this node, in case we are updating the LOD
-        current_branch[current_dims - 1]->payload->clear ();
+        if (node->children_[i])
+          buildLODRecursive (node->children_[i]);
+      }
 
-        const int next_dims = current_dims + 1;
-        OutofcoreOctreeBaseNode<ContainerT, PointT>** next_branch = new OutofcoreOctreeBaseNode<ContainerT, PointT>*[next_dims];
-        memcpy (next_branch, current_branch, current_dims * sizeof(OutofcoreOctreeBaseNode<ContainerT, PointT>**));
+      //then pull a random subsample of each child's points up into this node;
+      //children hold sample_precent of their own subtree, so a node ends up with
+      //sample_precent^l of the points l levels below it. the children are read
+      //in chunks of LOAD_COUNT_ points so a large leaf is never loaded at once
+      for (int i = 0; i < 8; i++)
+      {
+        NodeT* child = node->children_[i];
+        if (!child)
+          continue;
 
-        size_t numchild = current_branch[current_dims - 1]->numchildren ();
-        if ((numchild != 8) && (current_branch[current_dims - 1]->hasUnloadedChildren ()))
+        const uint64_t child_size = child->payload_->size ();
+        for (uint64_t startp = 0; startp < child_size; startp += LOAD_COUNT_)
         {
-          current_branch[current_dims - 1]->loadChildren (false);
-          numchild = current_branch[current_dims - 1]->numchildren ();
-        }
+          const uint64_t count = ((startp + LOAD_COUNT_) < child_size) ? LOAD_COUNT_ : (child_size - startp);
 
-        for (size_t i = 0; i < numchild; i++)
-        {
-          next_branch[next_dims - 1] = next_branch[current_dims - 1]->children[i];
-          buildLODRecursive (next_branch, next_dims);
-        }
+          AlignedPointTVector lod_points;
+          child->payload_->readRangeSubSample (startp, count, NodeT::sample_precent, lod_points);
 
-        delete[] next_branch;
+          if (!lod_points.empty ())
+          {
+            node->payload_->insertRange (lod_points);
+            incrementPointsInLOD (node->depth_, lod_points.size ());
+          }
+        }
       }
     }
   }//namespace outofcore
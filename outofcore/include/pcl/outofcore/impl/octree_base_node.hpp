@@ -48,6 +48,10 @@
 #include <string>
 #include <exception>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // PCL (Urban Robotics)
 #include <pcl/outofcore/octree_base_node.h>
 
@@ -255,6 +259,14 @@ namespace pcl
     }
 ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBaseNode<ContainerT, PointT>::applyPayloadEncoding ()
+    {
+      const bool quantize = (node_metadata_->getPayloadEncoding () == OutofcoreOctreeNodeMetadata::PCD_QUANTIZED_XYZ);
+      payload_->setPointQuantization (quantize, node_metadata_->getBoundingBoxMin (), node_metadata_->getBoundingBoxMax ());
+    }
+////////////////////////////////////////////////////////////////////////////////
+
     template<typename ContainerT, typename PointT>
     OutofcoreOctreeBaseNode<ContainerT, PointT>::OutofcoreOctreeBaseNode (const Eigen::Vector3d& bb_min, const Eigen::Vector3d& bb_max, const double node_dim_meters, OutofcoreOctreeBase<ContainerT, PointT> * const tree, const boost::filesystem::path& root_name)
       : m_tree_ ()
@@ -305,6 +317,17 @@ namespace pcl
     }
 ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBaseNode<ContainerT, PointT>::prefetchChildren (const Eigen::Vector3d& min_bb, const Eigen::Vector3d& max_bb) const
+    {
+      for (size_t i = 0; i < 8; i++)
+      {
+        if (children_[i] && children_[i]->intersectsWithBoundingBox (min_bb, max_bb))
+          children_[i]->payload_->prefetch ();
+      }
+    }
+////////////////////////////////////////////////////////////////////////////////
+
     template<typename ContainerT, typename PointT> inline bool
     OutofcoreOctreeBaseNode<ContainerT, PointT>::hasUnloadedChildren () const
     {
@@ -419,13 +442,23 @@ namespace pcl
         c[static_cast<size_t>(box)].push_back (&pt);
       }
       
+      //create the children up front; the subtrees below them share no state
+      //and are filled in parallel when this is the root
+      for (int i = 0; i < 8; i++)
+      {
+        if (!c[i].empty () && !children_[i])
+          createChild (i);
+      }
+
       boost::uint64_t points_added = 0;
+#ifdef _OPENMP
+      const int threads = getSubtreeThreads ();
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:points_added) num_threads(threads) if(threads > 1)
+#endif
       for (int i = 0; i < 8; i++)
       {
         if (c[i].empty ())
           continue;
-        if (!children_[i])
-          createChild (i);
         points_added += children_[i]->addDataToLeaf (c[i], true);
         c[i].clear ();
       }
@@ -562,16 +595,21 @@ namespace pcl
 
         boost::uint64_t points_added = 0;
 
+        for(int i=0; i<8; i++)
+        {
+          if ( !indices[i].empty () && children_[i] == false )
+            createChild (i);
+        }
+
+#ifdef _OPENMP
+        const int threads = getSubtreeThreads ();
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:points_added) num_threads(threads) if(threads > 1)
+#endif
         for(int i=0; i<8; i++)
         {
           if ( indices[i].empty () )
             continue;
 
-          if ( children_[i] == false )
-          {
-            createChild (i);
-          }
-
           sensor_msgs::PointCloud2::Ptr dst_cloud (new sensor_msgs::PointCloud2 () );
 
 //              PCL_INFO ( "[pcl::outofcore::OutofcoreOctreeBaseNode::%s] Extracting indices to bins\n", __FUNCTION__);
@@ -713,20 +751,78 @@ namespace pcl
     {
       // Reserve space for children nodes
       c.resize(8);
-      for(int i = 0; i < 8; i++)
-        c[i].reserve(p.size() / 8);
 
-      const size_t len = p.size();
-      for(size_t i = 0; i < len; i++)
+      const int threads = getSubtreeThreads ();
+      if (threads <= 1)
       {
-        const PointT& pt = p[i];
+        for(int i = 0; i < 8; i++)
+          c[i].reserve(p.size() / 8);
 
-        if(!skip_bb_check)
-          if(!this->pointInBoundingBox(pt))
-            continue;
+        const size_t len = p.size();
+        for(size_t i = 0; i < len; i++)
+        {
+          const PointT& pt = p[i];
+
+          if(!skip_bb_check)
+            if(!this->pointInBoundingBox(pt))
+              continue;
 
-        subdividePoint (pt, c);
+          subdividePoint (pt, c);
+        }
+        return;
       }
+
+#ifdef _OPENMP
+      // Each worker partitions one contiguous chunk of the input into its own
+      // buckets; appending the buckets in worker order keeps the serial ordering
+      std::vector< std::vector< AlignedPointTVector > > chunk_c (threads);
+      const int len = static_cast<int> (p.size ());
+#pragma omp parallel num_threads(threads)
+      {
+        std::vector< AlignedPointTVector >& local_c = chunk_c[omp_get_thread_num ()];
+        local_c.resize (8);
+#pragma omp for schedule(static)
+        for(int i = 0; i < len; i++)
+        {
+          const PointT& pt = p[i];
+
+          if(!skip_bb_check)
+            if(!this->pointInBoundingBox(pt))
+              continue;
+
+          subdividePoint (pt, local_c);
+        }
+      }
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+      for(int i = 0; i < 8; i++)
+      {
+        size_t octant_size = 0;
+        for(size_t t = 0; t < chunk_c.size (); t++)
+          octant_size += chunk_c[t][i].size ();
+
+        c[i].reserve (octant_size);
+        for(size_t t = 0; t < chunk_c.size (); t++)
+        {
+          c[i].insert (c[i].end (), chunk_c[t][i].begin (), chunk_c[t][i].end ());
+          AlignedPointTVector ().swap (chunk_c[t][i]);
+        }
+      }
+#endif
+    }
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> int
+    OutofcoreOctreeBaseNode<ContainerT, PointT>::getSubtreeThreads () const
+    {
+#ifdef _OPENMP
+      if (depth_ == 0 && root_ && root_->m_tree_)
+      {
+        const unsigned int threads = root_->m_tree_->getNumberOfThreads ();
+        return (threads ? static_cast<int> (threads) : omp_get_max_threads ());
+      }
+#endif
+      return (1);
     }
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -782,7 +878,11 @@ namespace pcl
       sensor_msgs::PointCloud2::Ptr downsampled_cloud ( new sensor_msgs::PointCloud2 () );
       //create destination for indices
       pcl::IndicesPtr downsampled_cloud_indices ( new std::vector< int > () );
-      random_sampler.filter (*downsampled_cloud_indices);
+      {
+        //RandomSample draws from the global rand () state, which the subtrees share
+        boost::mutex::scoped_lock lock (rng_mutex_);
+        random_sampler.filter (*downsampled_cloud_indices);
+      }
       //extract the "random subset", size by setSampleSize
       pcl::ExtractIndices<sensor_msgs::PointCloud2> extractor;
       extractor.setInputCloud ( input_cloud );
@@ -811,16 +911,23 @@ namespace pcl
 
       this->sortOctantIndices (remaining_points, indices, node_metadata_->getVoxelCenter ());
 
+      for(int i=0; i<8; i++)
+      {
+        if( !indices[i].empty () && children_[i] == false )
+          createChild (i);
+      }
+
       //pass each set of points to the appropriate child octant
+#ifdef _OPENMP
+      const int threads = getSubtreeThreads ();
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:points_added) num_threads(threads) if(threads > 1)
+#endif
       for(int i=0; i<8; i++)
       {
 
         if(indices[i].empty ())
           continue;
 
-        if( children_[i] == false )
-          createChild (i);
-
         //copy correct indices into a temporary cloud
         sensor_msgs::PointCloud2::Ptr tmp_local_point_cloud ( new sensor_msgs::PointCloud2 () );
         pcl::copyPointCloud ( *remaining_points, indices[i], *tmp_local_point_cloud );
@@ -871,18 +978,26 @@ namespace pcl
       std::vector< AlignedPointTVector > c;
       subdividePoints(p, c, skip_bb_check);
 
+      // Create the children that receive points before descending, so the
+      // subtrees can be built independently
+      for(int i = 0; i < 8; i++)
+      {
+        if(!c[i].empty() && !children_[i])
+          createChild(i);
+      }
+
       /// \todo: Perhaps do a quick loop through the lists here and dealloc the reserved mem for empty lists
       boost::uint64_t points_added = 0;
+#ifdef _OPENMP
+      const int threads = getSubtreeThreads ();
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:points_added) num_threads(threads) if(threads > 1)
+#endif
       for(int i = 0; i < 8; i++)
       {
         // If child doesn't have points
         if(c[i].empty())
           continue;
 
-        // If child doesn't exist
-        if(!children_[i])
-          createChild(i);
-
         /// \todo: Why are there no bounding box checks on the way down?
         // Recursively build children
         points_added += children_[i]->addDataToLeaf_and_genLOD(c[i], true);
@@ -1148,6 +1263,10 @@ namespace pcl
           //if this node has children
           if (num_child_ > 0)
           {
+            //the children are read by this query; start loading all of them at once
+            if (this->depth_ + 1 == query_depth)
+              prefetchChildren (min_bb, max_bb);
+
             //recursively store any points that fall into the queried bounding box into v and return
             for (size_t i = 0; i < 8; i++)
             {
@@ -1272,6 +1391,10 @@ namespace pcl
           //if this node has children
           if (num_child_ > 0)
           {
+            //the children are read by this query; start loading all of them at once
+            if (this->depth_ + 1 == query_depth)
+              prefetchChildren (min_bb, max_bb);
+
             //recursively store any points that fall into the queried bounding box into v and return
             for (size_t i = 0; i < 8; i++)
             {
@@ -1421,6 +1544,7 @@ namespace pcl
       num_child_ = 0;
 
       node_metadata_->setBoundingBox (bb_min, bb_max);
+      node_metadata_->setPayloadEncoding (super->node_metadata_->getPayloadEncoding ());
 
       std::string uuid_idx;
       std::string uuid_cont;
@@ -1446,6 +1570,7 @@ namespace pcl
       boost::filesystem::create_directory (node_metadata_->getDirectoryPathname ());
 
       payload_ = boost::shared_ptr<ContainerT> (new ContainerT (node_metadata_->getPCDFilename ()));
+      applyPayloadEncoding ();
       saveIdx (false);
     }
 ////////////////////////////////////////////////////////////////////////////////
@@ -1612,6 +1737,7 @@ namespace pcl
       memset (children_, 0, 8 * sizeof(OutofcoreOctreeBaseNode<ContainerT, PointT>*));
       this->num_child_ = 0;
       this->payload_ = boost::shared_ptr<ContainerT> ( new ContainerT (node_metadata_->getPCDFilename ()) );
+      applyPayloadEncoding ();
     }
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -1809,9 +1935,25 @@ namespace pcl
       int x_offset = input_cloud->fields[x_idx].offset;
       int y_offset = input_cloud->fields[y_idx].offset;
       int z_offset = input_cloud->fields[z_idx].offset;
+
+      const int threads = getSubtreeThreads ();
+      const int nr_points = static_cast<int> (input_cloud->data.size () / input_cloud->point_step);
+
+      //each worker sorts one contiguous chunk of the cloud into its own lists,
+      //which are appended in worker order so the indices stay sorted
+      std::vector< std::vector< std::vector<int> > > chunk_indices (threads, std::vector< std::vector<int> > (8));
       
-      for ( size_t point_idx =0; point_idx < input_cloud->data.size (); point_idx +=input_cloud->point_step )
-      {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+#endif
+      for (int i = 0; i < nr_points; i++)
+      {
+#ifdef _OPENMP
+        std::vector< std::vector<int> >& local_indices = chunk_indices[omp_get_thread_num ()];
+#else
+        std::vector< std::vector<int> >& local_indices = chunk_indices[0];
+#endif
+        const size_t point_idx = static_cast<size_t> (i) * input_cloud->point_step;
         PointT local_pt;
 
         local_pt.x = * (reinterpret_cast<float*>(&input_cloud->data[point_idx + x_offset]));
@@ -1830,7 +1972,13 @@ namespace pcl
         assert ( box < 8 );
               
         //insert to the vector of indices
-        indices[box].push_back ( static_cast<int> ( point_idx / input_cloud->point_step ) );
+        local_indices[box].push_back (i);
+      }
+
+      for (size_t box = 0; box < 8; box++)
+      {
+        for (size_t t = 0; t < chunk_indices.size (); t++)
+          indices[box].insert (indices[box].end (), chunk_indices[t][box].begin (), chunk_indices[t][box].end ());
       }
     }
 
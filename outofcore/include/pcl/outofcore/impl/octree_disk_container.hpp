@@ -44,11 +44,13 @@
 #include <sstream>
 #include <cassert>
 #include <ctime>
+#include <cstring>
 
 // Boost
 #include <pcl/outofcore/boost.h>
 
 // PCL
+#include <pcl/common/io.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_types.h>
 #include <sensor_msgs/PointCloud2.h>
@@ -61,6 +63,13 @@
 #define _fseeki64 fseeko
 #endif
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 namespace pcl
 {
   namespace outofcore
@@ -101,6 +110,9 @@ namespace pcl
       getRandomUUIDString (temp);
       disk_storage_filename_ = boost::shared_ptr<std::string> (new std::string (temp));
       filelen_ = 0;
+      quantize_ = false;
+      quantize_min_.setZero ();
+      quantize_max_.setZero ();
     }
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -109,6 +121,9 @@ namespace pcl
       : writebuff_ ()
       , disk_storage_filename_ ()
       , filelen_ ()
+      , quantize_ (false)
+      , quantize_min_ (Eigen::Vector3d::Zero ())
+      , quantize_max_ (Eigen::Vector3d::Zero ())
     {
       if (boost::filesystem::exists (path))
       {
@@ -175,14 +190,10 @@ namespace pcl
 
         cloud->points = writebuff_;
 
-        //write data to a pcd file
-        pcl::PCDWriter writer;
-
-
         PCL_WARN ("[pcl::outofcore::OutofcoreOctreeDiskContainer::%s] Flushing writebuffer in a dangerous way to file %s. This might overwrite data in destination file\n", __FUNCTION__, disk_storage_filename_->c_str ());
         
         // Write ascii for now to debug
-        int res = writer.writeBinaryCompressed (*disk_storage_filename_, *cloud);
+        int res = writeCloud (*cloud);
         (void)res;
         assert (res == 0);
       }
@@ -270,10 +281,9 @@ namespace pcl
         PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeDiskContainer] Outofcore Octree Exception: Read indices exceed range");
       }
 
-      pcl::PCDReader reader;
       typename pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT> ());
       
-      int res = reader.read (*disk_storage_filename_, *cloud);
+      int res = readCloud (*cloud);
       (void)res;
       assert (res == 0);
       
@@ -549,8 +559,7 @@ namespace pcl
       if (boost::filesystem::exists (*disk_storage_filename_))
       {
         // Open the existing file
-        pcl::PCDReader reader;
-        int res = reader.read (*disk_storage_filename_, *tmp_cloud);
+        int res = readCloud (*tmp_cloud);
         (void)res;
         assert (res == 0);
       }
@@ -573,13 +582,14 @@ namespace pcl
       //assume unorganized point cloud
       tmp_cloud->width = static_cast<uint32_t> (tmp_cloud->points.size ());
             
-      //save and close
-      PCDWriter writer;
-      
       /// \todo allow appending to pcd file without loading all of the point data into memory
-      int res = writer.writeBinaryCompressed (*disk_storage_filename_, *tmp_cloud);
+      int res = writeCloud (*tmp_cloud);
       (void)res;
       assert (res == 0);
+
+      //the write cache is now part of the file
+      filelen_ = tmp_cloud->points.size ();
+      writebuff_.clear ();
     }
   
 ////////////////////////////////////////////////////////////////////////////////
@@ -594,20 +604,17 @@ namespace pcl
       if (boost::filesystem::exists (*disk_storage_filename_))
       {
         //open the existing file
-        pcl::PCDReader reader;
-        int res = reader.read (*disk_storage_filename_, *tmp_cloud);
+        int res = readCloud (*tmp_cloud);
         (void)res;
         assert (res == 0);
-        pcl::PCDWriter writer;
 //            PCL_INFO ("[pcl::outofcore::OutofcoreOctreeDiskContainer::%s] Concatenating point cloud from %s to new cloud\n", __FUNCTION__, disk_storage_filename_->c_str ());
         pcl::concatenatePointCloud (*tmp_cloud, *input_cloud, *tmp_cloud);
-        writer.writeBinaryCompressed (*disk_storage_filename_, *input_cloud);
+        writeCloud (*input_cloud);
             
       }
       else //otherwise create the point cloud which will be saved to the pcd file for the first time
       {
-        pcl::PCDWriter writer;
-        int res = writer.writeBinaryCompressed (*disk_storage_filename_, *input_cloud);
+        int res = writeCloud (*input_cloud);
         (void)res;
         assert (res == 0);
       }            
@@ -619,16 +626,10 @@ namespace pcl
     template<typename PointT> void
     OutofcoreOctreeDiskContainer<PointT>::readRange (const uint64_t, const uint64_t, sensor_msgs::PointCloud2::Ptr& dst)
     {
-      pcl::PCDReader reader;
-
-      Eigen::Vector4f  origin;
-      Eigen::Quaternionf  orientation;
-      int  pcd_version;
-          
       if (boost::filesystem::exists (*disk_storage_filename_))
       {
 //            PCL_INFO ("[pcl::outofcore::OutofcoreOctreeDiskContainer::%s] Reading points from disk from %s.\n", __FUNCTION__ , disk_storage_filename_->c_str ());
-        int res = reader.read (*disk_storage_filename_, *dst, origin, orientation, pcd_version);
+        int res = readCloud (*dst);
         (void)res;
         assert (res != -1);
       }
@@ -638,6 +639,335 @@ namespace pcl
       }
     }
 
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::prefetch () const
+    {
+#ifndef _WIN32
+      int fd = ::open (disk_storage_filename_->c_str (), O_RDONLY);
+      if (fd == -1)
+        return;
+
+#ifdef POSIX_FADV_WILLNEED
+      // Starts asynchronous read-ahead of the whole file
+      int res = ::posix_fadvise (fd, 0, 0, POSIX_FADV_WILLNEED);
+      (void)res;
+#else
+      // No fadvise available: map the file and advise on the mapping instead
+      struct stat file_stat;
+      if (::fstat (fd, &file_stat) == 0 && file_stat.st_size > 0)
+      {
+        size_t len = static_cast<size_t> (file_stat.st_size);
+        void *map = ::mmap (0, len, PROT_READ, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED)
+        {
+          ::madvise (map, len, MADV_WILLNEED);
+          ::munmap (map, len);
+        }
+      }
+#endif
+      ::close (fd);
+#endif
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::setPointQuantization (const bool enable, const Eigen::Vector3d &min_bb, const Eigen::Vector3d &max_bb)
+    {
+      quantize_ = enable;
+      quantize_min_ = min_bb;
+      quantize_max_ = max_bb;
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeDiskContainer<PointT>::readCloud (pcl::PointCloud<PointT> &cloud) const
+    {
+      // PCDReader reads into a PointCloud2 and converts it anyway; quantized
+      // files are widened straight into the points instead of being converted twice
+      sensor_msgs::PointCloud2 blob;
+      pcl::PCDReader reader;
+      int res = reader.read (*disk_storage_filename_, blob);
+      if (res != 0)
+        return (res);
+
+      if (hasQuantizedFields (blob))
+        dequantizeCloud (blob, cloud);
+      else
+        pcl::fromROSMsg (blob, cloud);
+      return (res);
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeDiskContainer<PointT>::readCloud (sensor_msgs::PointCloud2 &cloud) const
+    {
+      pcl::PCDReader reader;
+      int res = reader.read (*disk_storage_filename_, cloud);
+      if (res == 0 && hasQuantizedFields (cloud))
+      {
+        const sensor_msgs::PointCloud2 quantized (cloud);
+        dequantizeCloud (quantized, cloud);
+      }
+      return (res);
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> bool
+    OutofcoreOctreeDiskContainer<PointT>::hasQuantizedFields (const sensor_msgs::PointCloud2 &cloud)
+    {
+      for (size_t f = 0; f < cloud.fields.size (); ++f)
+      {
+        const sensor_msgs::PointField &field = cloud.fields[f];
+        if (field.datatype == sensor_msgs::PointField::UINT16 && field.count == 1
+            && (field.name == "x" || field.name == "y" || field.name == "z"))
+          return (true);
+      }
+      return (false);
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeDiskContainer<PointT>::writeCloud (const pcl::PointCloud<PointT> &cloud) const
+    {
+      if (!quantize_)
+      {
+        pcl::PCDWriter writer;
+        return (writer.writeBinaryCompressed (*disk_storage_filename_, cloud));
+      }
+
+      sensor_msgs::PointCloud2 blob;
+      pcl::toROSMsg (cloud, blob);
+      return (writeCloud (blob));
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeDiskContainer<PointT>::writeCloud (const sensor_msgs::PointCloud2 &cloud) const
+    {
+      pcl::PCDWriter writer;
+      if (!quantize_)
+        return (writer.writeBinaryCompressed (*disk_storage_filename_, cloud));
+
+      sensor_msgs::PointCloud2 quantized;
+      quantizeCloud (cloud, quantized);
+      return (writer.writeBinaryCompressed (*disk_storage_filename_, quantized));
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::quantizeCloud (const sensor_msgs::PointCloud2 &input, sensor_msgs::PointCloud2 &output) const
+    {
+      output.header = input.header;
+      output.height = input.height;
+      output.width = input.width;
+      output.is_bigendian = input.is_bigendian;
+      output.is_dense = input.is_dense;
+      output.fields.clear ();
+
+      // Pack the fields, dropping padding; x, y and z become 16 bit grid coordinates
+      std::vector<int> axis;
+      std::vector<uint32_t> input_offsets;
+      std::vector<uint32_t> sizes;
+      uint32_t offset = 0;
+      for (size_t f = 0; f < input.fields.size (); ++f)
+      {
+        const sensor_msgs::PointField &field = input.fields[f];
+        if (field.name == "_")
+          continue;
+
+        int a = -1;
+        if (field.datatype == sensor_msgs::PointField::FLOAT32 && field.count == 1)
+          a = (field.name == "x") ? 0 : (field.name == "y") ? 1 : (field.name == "z") ? 2 : -1;
+
+        sensor_msgs::PointField packed = field;
+        packed.offset = offset;
+        if (a != -1)
+          packed.datatype = sensor_msgs::PointField::UINT16;
+
+        axis.push_back (a);
+        input_offsets.push_back (field.offset);
+        sizes.push_back (field.count * pcl::getFieldSize (packed.datatype));
+        offset += sizes.back ();
+        output.fields.push_back (packed);
+      }
+      output.point_step = offset;
+      output.row_step = output.point_step * output.width;
+
+      const size_t nr_points = static_cast<size_t> (input.width) * input.height;
+      output.data.resize (nr_points * output.point_step);
+
+      Eigen::Vector3d scale;
+      for (int a = 0; a < 3; ++a)
+      {
+        const double range = quantize_max_[a] - quantize_min_[a];
+        scale[a] = (range > 0) ? 65535.0 / range : 0.0;
+      }
+
+      for (size_t i = 0; i < nr_points; ++i)
+      {
+        const uint8_t *src = &input.data[i * input.point_step];
+        uint8_t *dst = &output.data[i * output.point_step];
+
+        for (size_t f = 0; f < output.fields.size (); ++f)
+        {
+          if (axis[f] == -1)
+          {
+            memcpy (dst + output.fields[f].offset, src + input_offsets[f], sizes[f]);
+            continue;
+          }
+
+          float value;
+          memcpy (&value, src + input_offsets[f], sizeof (float));
+          double q = (value - quantize_min_[axis[f]]) * scale[axis[f]] + 0.5;
+          // Clamp to the box; this also maps NaNs to the lower corner
+          if (!(q > 0.0))
+            q = 0.0;
+          else if (q > 65535.0)
+            q = 65535.0;
+          uint16_t grid = static_cast<uint16_t> (q);
+          memcpy (dst + output.fields[f].offset, &grid, sizeof (uint16_t));
+        }
+      }
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::dequantizeCloud (const sensor_msgs::PointCloud2 &input, sensor_msgs::PointCloud2 &output) const
+    {
+      output.header = input.header;
+      output.height = input.height;
+      output.width = input.width;
+      output.is_bigendian = input.is_bigendian;
+      output.is_dense = input.is_dense;
+      output.fields = input.fields;
+
+      // Widen the 16 bit x, y and z fields back to floats; all other fields keep their layout
+      std::vector<int> axis (input.fields.size (), -1);
+      std::vector<uint32_t> sizes (input.fields.size ());
+      uint32_t offset = 0;
+      for (size_t f = 0; f < input.fields.size (); ++f)
+      {
+        const sensor_msgs::PointField &field = input.fields[f];
+        if (field.datatype == sensor_msgs::PointField::UINT16 && field.count == 1)
+          axis[f] = (field.name == "x") ? 0 : (field.name == "y") ? 1 : (field.name == "z") ? 2 : -1;
+
+        if (axis[f] != -1)
+          output.fields[f].datatype = sensor_msgs::PointField::FLOAT32;
+        output.fields[f].offset = offset;
+        sizes[f] = field.count * pcl::getFieldSize (field.datatype);
+        offset += field.count * pcl::getFieldSize (output.fields[f].datatype);
+      }
+      output.point_step = offset;
+      output.row_step = output.point_step * output.width;
+
+      const size_t nr_points = static_cast<size_t> (input.width) * input.height;
+      output.data.resize (nr_points * output.point_step);
+
+      Eigen::Vector3d step;
+      for (int a = 0; a < 3; ++a)
+        step[a] = (quantize_max_[a] - quantize_min_[a]) / 65535.0;
+
+      for (size_t i = 0; i < nr_points; ++i)
+      {
+        const uint8_t *src = &input.data[i * input.point_step];
+        uint8_t *dst = &output.data[i * output.point_step];
+
+        for (size_t f = 0; f < input.fields.size (); ++f)
+        {
+          if (axis[f] == -1)
+          {
+            memcpy (dst + output.fields[f].offset, src + input.fields[f].offset, sizes[f]);
+            continue;
+          }
+
+          uint16_t grid;
+          memcpy (&grid, src + input.fields[f].offset, sizeof (uint16_t));
+          float value = static_cast<float> (quantize_min_[axis[f]] + grid * step[axis[f]]);
+          memcpy (dst + output.fields[f].offset, &value, sizeof (float));
+        }
+      }
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::dequantizeCloud (const sensor_msgs::PointCloud2 &input, pcl::PointCloud<PointT> &output) const
+    {
+      output.header = input.header;
+      output.width = input.width;
+      output.height = input.height;
+      output.is_dense = input.is_dense == 1;
+
+      // Map the fields of the file to the fields of PointT by name; the 16 bit
+      // x, y and z fields are widened to floats, all others are copied as they are
+      std::vector<sensor_msgs::PointField> point_fields;
+      pcl::getFields (output, point_fields);
+
+      std::vector<int> axis;
+      std::vector<uint32_t> input_offsets;
+      std::vector<uint32_t> output_offsets;
+      std::vector<uint32_t> sizes;
+      for (size_t f = 0; f < input.fields.size (); ++f)
+      {
+        const sensor_msgs::PointField &field = input.fields[f];
+        for (size_t p = 0; p < point_fields.size (); ++p)
+        {
+          const sensor_msgs::PointField &point_field = point_fields[p];
+          if (point_field.name != field.name || point_field.count != field.count)
+            continue;
+
+          int a = -1;
+          if (field.datatype == sensor_msgs::PointField::UINT16 && point_field.datatype == sensor_msgs::PointField::FLOAT32)
+            a = (field.name == "x") ? 0 : (field.name == "y") ? 1 : (field.name == "z") ? 2 : -1;
+          if (a == -1 && field.datatype != point_field.datatype)
+            break;
+
+          axis.push_back (a);
+          input_offsets.push_back (field.offset);
+          output_offsets.push_back (point_field.offset);
+          sizes.push_back (field.count * pcl::getFieldSize (field.datatype));
+          break;
+        }
+      }
+
+      const size_t nr_points = static_cast<size_t> (input.width) * input.height;
+      output.points.resize (nr_points);
+
+      Eigen::Vector3d step;
+      for (int a = 0; a < 3; ++a)
+        step[a] = (quantize_max_[a] - quantize_min_[a]) / 65535.0;
+
+      for (size_t i = 0; i < nr_points; ++i)
+      {
+        const uint8_t *src = &input.data[i * input.point_step];
+        uint8_t *dst = reinterpret_cast<uint8_t*> (&output.points[i]);
+
+        for (size_t f = 0; f < axis.size (); ++f)
+        {
+          if (axis[f] == -1)
+          {
+            memcpy (dst + output_offsets[f], src + input_offsets[f], sizes[f]);
+            continue;
+          }
+
+          uint16_t grid;
+          memcpy (&grid, src + input_offsets[f], sizeof (uint16_t));
+          float value = static_cast<float> (quantize_min_[axis[f]] + grid * step[axis[f]]);
+          memcpy (dst + output_offsets[f], &value, sizeof (float));
+        }
+      }
+    }
+
 ////////////////////////////////////////////////////////////////////////////////
 
     template<typename PointT> void
@@ -678,9 +1008,8 @@ namespace pcl
         // If there's a pcd file with data, read it in from disk for appending
         if (boost::filesystem::exists (*disk_storage_filename_))
         {
-          pcl::PCDReader reader;
           // Open it
-          int res = reader.read (disk_storage_filename_->c_str (), *tmp_cloud);
+          int res = readCloud (*tmp_cloud);
           (void)res; 
           assert (res == 0);
         }
@@ -705,11 +1034,8 @@ namespace pcl
         tmp_cloud->width = static_cast<uint32_t> (tmp_cloud->points.size ());
         tmp_cloud->height = 1;
             
-        //save and close
-        PCDWriter writer;
-
         /// \todo allow appending to pcd file without loading all of the point data into memory
-        int res = writer.writeBinaryCompressed (*disk_storage_filename_, *tmp_cloud);
+        int res = writeCloud (*tmp_cloud);
         (void)res;
         assert (res == 0);
       }
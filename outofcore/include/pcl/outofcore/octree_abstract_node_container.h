@@ -88,6 +88,20 @@ namespace pcl
         virtual void
         convertToXYZ (const boost::filesystem::path& path)=0;
 
+        /** \brief Hint that the contents of this container will be read soon. Containers
+         * backed by slow storage may start loading the data asynchronously; the default
+         * implementation does nothing.
+         */
+        virtual void
+        prefetch () const {}
+
+        /** \brief Store the x, y and z coordinates of this container quantized to the
+         * given bounding box. Containers that do not serialize their points ignore this;
+         * the default implementation does nothing.
+         */
+        virtual void
+        setPointQuantization (const bool, const Eigen::Vector3d&, const Eigen::Vector3d&) {}
+
 ////////////////////////////////////////////////////////////////////////////////
 //METHODS IMPLEMENTED IN ONLY DISK OR RAM THAT PROBABLY COULD BE IN BOTH
 ////////////////////////////////////////////////////////////////////////////////
@@ -343,9 +343,46 @@ namespace pcl
         // Mutators
         // -----------------------------------------------------------------------
 
-        /** \brief Generate LODs for the tree 
+        /** \brief Set the number of threads used to build the tree. Insertion and \ref buildLOD
+         *  partition the input by top-level octant and fill the (up to eight) subtrees of the
+         *  root on separate workers; each worker only holds the points of its own octant.
+         *  \param[in] nr_threads the number of worker threads (0 sets the value back to automatic)
+         */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+        }
+
+        /** \brief Get the number of threads used to build the tree (0 means automatic) */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
+        /** \brief Set how the point data of every node is encoded on disk. With
+         *  \ref OutofcoreOctreeNodeMetadata::PCD_QUANTIZED_XYZ, coordinates are stored as 16 bit
+         *  integers relative to each node's bounding box (an error of at most half a step of
+         *  side_length / 65535 per axis), which shrinks the payload files; other fields such
+         *  as the packed rgb are stored unchanged. The encoding is recorded in the "encoding"
+         *  field of each node's JSON metadata and inherited by new child nodes, so it can only
+         *  be changed while the tree is still empty.
+         *  \param[in] encoding the payload encoding used for all nodes
+         *  \return true on success, false if the tree already holds points
+         */
+        bool
+        setPayloadEncoding (const OutofcoreOctreeNodeMetadata::PayloadEncoding encoding);
+
+        /** \brief Get the payload encoding of the tree, as stored in the root node's metadata */
+        OutofcoreOctreeNodeMetadata::PayloadEncoding
+        getPayloadEncoding () const;
+
+        /** \brief Generate LODs for the tree bottom-up: every branch node is
+         *  cleared and refilled with a random \ref OutofcoreOctreeBaseNode::sample_precent
+         *  subsample of each of its children. The subtrees of the root are processed in
+         *  parallel (see \ref setNumberOfThreads).
          *  \note This is not implemented for PointCloud2 yet
-         *  \throws PCLException, not implemented
          */
         void
         buildLOD ();
@@ -455,14 +492,14 @@ namespace pcl
         void
         loadFromFile ();
 
-        /** \brief recursive portion of lod builder
-         * \todo does this need to be public? 
-         * loads chunks of up to 2e9 pts at a time; this is a completely arbitrary number, and should be parameterized.
+        /** \brief recursive portion of lod builder; fills \b node from the subsampled
+         * payloads of its children after the children have been built
          * TODO rewrite for new point container (PointCloud2) support */
         void
-        buildLODRecursive (OutofcoreOctreeBaseNode<ContainerT, PointT>** current_branch, const int current_dims);
+        buildLODRecursive (OutofcoreOctreeBaseNode<ContainerT, PointT>* node);
 
         /** \brief Increment current depths (LOD for branch nodes) point count; called by addDataAtMaxDepth in OutofcoreOctreeBaseNode
+         * \note Subtrees are built concurrently, so the update is guarded by \ref lod_mutex_
          * \todo rename count_point to something more informative
          */
         inline void
@@ -471,6 +508,7 @@ namespace pcl
           //if we overflow here, we've got one massive octree
           assert ( std::numeric_limits<uint64_t>::max () - inc > inc );
 
+          boost::mutex::scoped_lock lock (lod_mutex_);
           lodPoints_[depth] += inc;
         }
     
@@ -480,6 +518,10 @@ namespace pcl
         mutable boost::shared_mutex read_write_mutex_;
         /** \brief vector indexed by depth containing number of points at each level of detail */
         std::vector<boost::uint64_t> lodPoints_;
+        /** \brief mutex guarding \ref lodPoints_ while subtrees are built in parallel */
+        boost::mutex lod_mutex_;
+        /** \brief number of threads used to build the tree; 0 means automatic */
+        unsigned int threads_;
         /** \brief the pre-set maximum depth of the tree */
         boost::uint64_t max_depth_;
         /** \brief boost::filesystem::path to the location of the root of
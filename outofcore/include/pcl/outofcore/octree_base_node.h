@@ -260,6 +260,10 @@ namespace pcl
         void
         saveIdx (bool recursive);
 
+        /** \brief Configures \ref payload_ for the payload encoding recorded in this node's metadata */
+        void
+        applyPayloadEncoding ();
+
         /** \brief Randomly sample point data 
          *  \todo This needs to be deprecated; random sampling has its own class
          *  \todo Parameterize random sampling, uniform downsampling, etc...
@@ -267,9 +271,16 @@ namespace pcl
         void
         randomSample (const AlignedPointTVector &p, AlignedPointTVector &insertBuff, const bool skip_bb_check);
 
-        /** \brief Subdivide points to pass to child nodes */
+        /** \brief Subdivide points to pass to child nodes; at the root the input is
+         *  partitioned in parallel chunks */
         void
         subdividePoints (const AlignedPointTVector &p, std::vector< AlignedPointTVector > &c, const bool skip_bb_check);
+        /** \brief Number of workers used to fill the subtrees below this node: the
+         *  tree's \ref OutofcoreOctreeBase::getNumberOfThreads setting at the root (so each
+         *  top-level octant is built by one worker), 1 everywhere else */
+        int
+        getSubtreeThreads () const;
+
         /** \brief Subdivide a single point into a specific child node */
         void
         subdividePoint (const PointT &point, std::vector< AlignedPointTVector > &c);
@@ -420,6 +431,15 @@ namespace pcl
         void
         loadChildren (bool recursive);
 
+        /** \brief Issues an asynchronous prefetch of the payloads of all children
+         *  intersecting the queried bounding box, so that the loads of sibling
+         *  nodes overlap instead of being served one at a time
+         *  \param[in] min_bb The minimum corner of the queried bounding box
+         *  \param[in] max_bb The maximum corner of the queried bounding box
+         */
+        void
+        prefetchChildren (const Eigen::Vector3d &min_bb, const Eigen::Vector3d &max_bb) const;
+
         /** \brief Gets a vector of occupied voxel centers
          * \param[out] voxel_centers
          * \param[in] query_depth
@@ -435,7 +455,7 @@ namespace pcl
         getVoxelCentersRecursive (std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > &voxel_centers, const size_t query_depth);
 
         /** \brief Sorts the indices based on x,y,z fields and pushes the index into the proper octant's vector;
-         *  This could be overloaded with a parallelized implementation
+         *  at the root the cloud is split into chunks that are sorted in parallel
          */
         void
         sortOctantIndices (const sensor_msgs::PointCloud2::Ptr &input_cloud, std::vector< std::vector<int> > &indices, const Eigen::Vector3d &mid_xyz);
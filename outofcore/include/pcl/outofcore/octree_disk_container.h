@@ -136,7 +136,9 @@ namespace pcl
 
         /** \brief Reads \b count points into memory from the disk container
          *
-         * Reads \b count points into memory from the disk container, reading at most 2 million elements at a time
+         * Reads \b count points into memory from the disk container. The PCD file is
+         * memory mapped by the reader, so pages brought in by \ref prefetch are used
+         * directly from the page cache.
          *
          * \param[in] start index of first point to read from disk
          * \param[in] count offset of last point to read from disk
@@ -149,6 +151,34 @@ namespace pcl
         void
         readRange (const uint64_t, const uint64_t, sensor_msgs::PointCloud2::Ptr &dst);
 
+        /** \brief Asks the operating system to start reading this container's file
+         * into the page cache in the background, and returns immediately.
+         *
+         * Issuing this for several nodes before reading them lets their disk loads
+         * overlap with each other and with the decoding of the nodes read first.
+         * This is a no-op on platforms without read-ahead advice (e.g. Windows) and
+         * when the file has not been written yet.
+         */
+        void
+        prefetch () const;
+
+        /** \brief Enables or disables quantized storage of the point coordinates.
+         *
+         * When enabled, the x, y and z fields are written to the PCD file as 16 bit
+         * unsigned integers relative to [\b min_bb, \b max_bb], i.e. with a step of
+         * (max_bb - min_bb) / 65535 per axis; all other fields are stored unchanged.
+         * Files are still LZF compressed binary PCD files. Whether a file is dequantized
+         * on read depends only on its x, y and z fields being UINT16, not on this
+         * setting, but the box given here is used to dequantize it. This must be set
+         * before any data is written to the container.
+         *
+         * \param[in] enable true to quantize the coordinates written from now on
+         * \param[in] min_bb lower corner of the box the coordinates are quantized to
+         * \param[in] max_bb upper corner of the box the coordinates are quantized to
+         */
+        void
+        setPointQuantization (const bool enable, const Eigen::Vector3d &min_bb, const Eigen::Vector3d &max_bb);
+
         /** \brief  grab percent*count random points. points are \b not guaranteed to be
          * unique (could have multiple identical points!)
          *
@@ -285,6 +315,38 @@ namespace pcl
 
         void
         flushWritebuff (const bool force_cache_dealloc);
+
+        /** \brief Reads the whole PCD file, dequantizing the coordinates if needed */
+        int
+        readCloud (pcl::PointCloud<PointT> &cloud) const;
+
+        /** \brief Reads the whole PCD file, dequantizing the coordinates if needed */
+        int
+        readCloud (sensor_msgs::PointCloud2 &cloud) const;
+
+        /** \brief Overwrites the PCD file with \b cloud, quantizing the coordinates if enabled */
+        int
+        writeCloud (const pcl::PointCloud<PointT> &cloud) const;
+
+        /** \brief Overwrites the PCD file with \b cloud, quantizing the coordinates if enabled */
+        int
+        writeCloud (const sensor_msgs::PointCloud2 &cloud) const;
+
+        /** \brief Packs \b input into \b output with x, y and z stored as UINT16 relative to the quantization box */
+        void
+        quantizeCloud (const sensor_msgs::PointCloud2 &input, sensor_msgs::PointCloud2 &output) const;
+
+        /** \brief Converts the UINT16 x, y and z fields of \b input back to FLOAT32; other fields are copied */
+        void
+        dequantizeCloud (const sensor_msgs::PointCloud2 &input, sensor_msgs::PointCloud2 &output) const;
+
+        /** \brief Converts the UINT16 x, y and z fields of \b input directly into the points of \b output */
+        void
+        dequantizeCloud (const sensor_msgs::PointCloud2 &input, pcl::PointCloud<PointT> &output) const;
+
+        /** \brief Whether any of the x, y and z fields of \b cloud is stored quantized as UINT16 */
+        static bool
+        hasQuantizedFields (const sensor_msgs::PointCloud2 &cloud);
     
         /** \brief elements [0,...,size()-1] map to [filelen, ..., filelen + size()-1] */
         AlignedPointTVector writebuff_;
@@ -297,6 +359,13 @@ namespace pcl
         /// \todo This value was originally computed by the number of bytes in the binary dump to disk. Now, since we are using binary compressed, it needs to be computed in a different way (!). This is causing Unit Tests: PCL.Outofcore_Point_Query, OutofcoreTest.PointCloud2_Query and OutofcoreTest.PointCloud2_Insert( on post-insert query test) to fail as of 4 July 2012. SDF
         uint64_t filelen_;
 
+        /** \brief Whether coordinates are quantized when written (see \ref setPointQuantization) */
+        bool quantize_;
+        /** \brief Lower corner of the quantization box */
+        Eigen::Vector3d quantize_min_;
+        /** \brief Upper corner of the quantization box */
+        Eigen::Vector3d quantize_max_;
+
         const static uint64_t READ_BLOCK_SIZE_;
 
         /** \todo Consult with the literature about optimizing out of core read/write */
@@ -66,9 +66,13 @@ namespace pcl
      *    "version": 3,
      *    "bb_min":  [xxx,yyy,zzz],
      *    "bb_max":  [xxx,yyy,zzz],
-     *    "bin":     "path_to_data.pcd"
+     *    "bin":     "path_to_data.pcd",
+     *    "encoding": "pcd_binary_compressed"
      *  }
      *
+     *  The "encoding" field is optional; metadata files written before it
+     *  existed are read as \ref PCD_BINARY_COMPRESSED.
+     *
      *  Any properties not stored in the metadata file are computed
      *  when the file is loaded (e.g. \ref midpoint_xyz_). By
      *  convention, the JSON files are stored on disk with .oct_idx
@@ -80,6 +84,17 @@ namespace pcl
     class PCL_EXPORTS OutofcoreOctreeNodeMetadata
     {
       public:
+        /** \brief On-disk encoding of the points stored in a node's PCD file */
+        enum PayloadEncoding
+        {
+          /** \brief Fields are stored as-is in an LZF compressed binary PCD file */
+          PCD_BINARY_COMPRESSED = 0,
+          /** \brief Like \ref PCD_BINARY_COMPRESSED, but x, y and z are stored as 16 bit
+           *  integers quantized to the node's bounding box
+           */
+          PCD_QUANTIZED_XYZ = 1
+        };
+
         /** \brief Empty constructor */
         OutofcoreOctreeNodeMetadata ();
         ~OutofcoreOctreeNodeMetadata ();
@@ -125,6 +140,13 @@ namespace pcl
         void 
         setOutofcoreVersion (const int version);
 
+        /** \brief Get the encoding of the node's point data, stored in the "encoding" field */
+        PayloadEncoding
+        getPayloadEncoding () const;
+        /** \brief Set the encoding of the node's point data */
+        void
+        setPayloadEncoding (const PayloadEncoding encoding);
+
         /** \brief Sets the name of the JSON file */
         boost::filesystem::path 
         getMetadataFilename () const;
@@ -162,6 +184,8 @@ namespace pcl
         boost::filesystem::path metadata_filename_;
         /** \brief Outofcore library version identifier */
         int outofcore_version_;
+        /** \brief Encoding of the point data in \ref binary_point_filename_ */
+        PayloadEncoding payload_encoding_;
 
         /** \brief Computes the midpoint; used when bounding box is changed */
         void 
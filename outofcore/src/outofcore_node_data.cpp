@@ -56,7 +56,9 @@ namespace pcl
         binary_point_filename_ (),
         midpoint_xyz_ (),
         directory_ (),
-        metadata_filename_ ()
+        metadata_filename_ (),
+        outofcore_version_ (),
+        payload_encoding_ (PCD_BINARY_COMPRESSED)
     {
     }
 
@@ -167,6 +169,22 @@ namespace pcl
       outofcore_version_ = version;
     }
 
+////////////////////////////////////////////////////////////////////////////////
+
+    OutofcoreOctreeNodeMetadata::PayloadEncoding
+    OutofcoreOctreeNodeMetadata::getPayloadEncoding () const
+    {
+      return (payload_encoding_);
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcoreOctreeNodeMetadata::setPayloadEncoding (const PayloadEncoding encoding)
+    {
+      payload_encoding_ = encoding;
+    }
+
 ////////////////////////////////////////////////////////////////////////////////
 
     boost::filesystem::path 
@@ -221,6 +239,11 @@ namespace pcl
       cJSON_AddItemToObject (idx.get (), "bb_max", cjson_bb_max);
       cJSON_AddItemToObject (idx.get (), "bin", cjson_bin_point_filename);
 
+      if (payload_encoding_ == PCD_QUANTIZED_XYZ)
+        cJSON_AddItemToObject (idx.get (), "encoding", cJSON_CreateString ("pcd_quantized_xyz"));
+      else
+        cJSON_AddItemToObject (idx.get (), "encoding", cJSON_CreateString ("pcd_binary_compressed"));
+
       char* idx_txt = cJSON_Print (idx.get ());
 
       std::ofstream f (metadata_filename_.c_str (), std::ios::out | std::ios::trunc);
@@ -268,6 +291,7 @@ namespace pcl
       cJSON* cjson_bb_min = cJSON_GetObjectItem (idx.get (), "bb_min");
       cJSON* cjson_bb_max = cJSON_GetObjectItem (idx.get (), "bb_max");
       cJSON* cjson_bin_point_filename = cJSON_GetObjectItem (idx.get (), "bin");
+      cJSON* cjson_encoding = cJSON_GetObjectItem (idx.get (), "encoding");
       
       for (int i = 0; i < 3; i++)
       {
@@ -277,6 +301,16 @@ namespace pcl
       outofcore_version_ = cjson_outofcore_version->valueint;
 
       binary_point_filename_= directory_ / cjson_bin_point_filename->valuestring;
+
+      //metadata written before the encoding field existed holds plain binary compressed PCD files
+      payload_encoding_ = PCD_BINARY_COMPRESSED;
+      if (cjson_encoding != NULL && cjson_encoding->type == cJSON_String)
+      {
+        if (std::string (cjson_encoding->valuestring) == "pcd_quantized_xyz")
+          payload_encoding_ = PCD_QUANTIZED_XYZ;
+        else if (std::string (cjson_encoding->valuestring) != "pcd_binary_compressed")
+          PCL_WARN ("[pcl::outofcore::OutofcoreOctreeNodeMetadata] Unknown payload encoding \"%s\" in %s; assuming pcd_binary_compressed.\n", cjson_encoding->valuestring, metadata_filename_.c_str ());
+      }
       midpoint_xyz_ = (max_bb_+min_bb_)/static_cast<double>(2.0);
       
       //return success
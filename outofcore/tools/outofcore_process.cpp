@@ -95,7 +95,7 @@ getCloudFromFile (boost::filesystem::path pcd_path)
 
 int
 outofcoreProcess (std::vector<boost::filesystem::path> pcd_paths, boost::filesystem::path root_dir, 
-                  int depth, double resolution, int build_octree_with, bool gen_lod, bool overwrite)
+                  int depth, double resolution, int build_octree_with, bool gen_lod, bool overwrite, int threads)
 {
   // Bounding box min/max pts
   PointT min_pt, max_pt;
@@ -176,6 +176,9 @@ outofcoreProcess (std::vector<boost::filesystem::path> pcd_paths, boost::filesys
     outofcore_octree = new octree_disk (bounding_box_min, bounding_box_max, resolution, octree_path_on_disk, "ECEF");
   }
 
+  //each top-level octant of the tree is built on its own worker
+  outofcore_octree->setNumberOfThreads (static_cast<unsigned int> (threads));
+
   uint64_t total_pts = 0;
 
   // Iterate over all pcd files adding points to the octree
@@ -231,6 +234,7 @@ printHelp (int, char **argv)
   print_info ("\t -resolution <resolution>      \t Octree resolution\n");
   print_info ("\t -gen_lod                      \t Generate octree LODs\n");
   print_info ("\t -overwrite                    \t Overwrite existing octree\n");
+  print_info ("\t -threads <n>                  \t Number of build threads (default: 0, automatic)\n");
   print_info ("\t -h                            \t Display help\n");
   print_info ("\n");
 }
@@ -265,6 +269,7 @@ main (int argc, char* argv[])
   double resolution = .1;
   bool gen_lod = false;
   bool overwrite = false;
+  int threads = 0;
   int build_octree_with = OCTREE_DEPTH;
 
   // If both depth and resolution specified
@@ -283,6 +288,7 @@ main (int argc, char* argv[])
   parse_argument (argc, argv, "-resolution", resolution);
   gen_lod = find_switch (argc, argv, "-gen_lod");
   overwrite = find_switch (argc, argv, "-overwrite");
+  parse_argument (argc, argv, "-threads", threads);
 
   // Parse non-option arguments for pcd files
   std::vector<int> file_arg_indices = parse_file_extension_argument (argc, argv, ".pcd");
@@ -314,5 +320,5 @@ main (int argc, char* argv[])
   if (root_dir.extension () == ".pcd")
     root_dir = root_dir.parent_path () / (root_dir.stem().string() + "_tree").c_str();
 
-  return outofcoreProcess (pcd_paths, root_dir, depth, resolution, build_octree_with, gen_lod, overwrite);
+  return outofcoreProcess (pcd_paths, root_dir, depth, resolution, build_octree_with, gen_lod, overwrite, threads);
 }
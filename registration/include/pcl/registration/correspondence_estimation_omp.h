@@ -0,0 +1,120 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_REGISTRATION_CORRESPONDENCE_ESTIMATION_OMP_H_
+#define PCL_REGISTRATION_CORRESPONDENCE_ESTIMATION_OMP_H_
+
+#include <pcl/registration/correspondence_estimation.h>
+
+namespace pcl
+{
+  namespace registration
+  {
+    /** \brief @b CorrespondenceEstimationOMP is a parallel version of \ref CorrespondenceEstimation. The nearest
+      * neighbor queries of the source points are distributed over the available threads; the correspondences are
+      * returned in the same order as the serial version.
+      *
+      * \author Open Perception
+      * \ingroup registration
+      */
+    template <typename PointSource, typename PointTarget>
+    class CorrespondenceEstimationOMP : public CorrespondenceEstimation<PointSource, PointTarget>
+    {
+      public:
+        typedef boost::shared_ptr<CorrespondenceEstimationOMP<PointSource, PointTarget> > Ptr;
+        typedef boost::shared_ptr<const CorrespondenceEstimationOMP<PointSource, PointTarget> > ConstPtr;
+
+        using CorrespondenceEstimation<PointSource, PointTarget>::initCompute;
+        using CorrespondenceEstimation<PointSource, PointTarget>::deinitCompute;
+        using CorrespondenceEstimation<PointSource, PointTarget>::input_;
+        using CorrespondenceEstimation<PointSource, PointTarget>::indices_;
+        using CorrespondenceEstimation<PointSource, PointTarget>::target_;
+        using CorrespondenceEstimation<PointSource, PointTarget>::tree_;
+        using CorrespondenceEstimation<PointSource, PointTarget>::corr_name_;
+        using CorrespondenceEstimation<PointSource, PointTarget>::point_representation_;
+
+        /** \brief Initialize the scheduler and set the number of threads to use.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          */
+        CorrespondenceEstimationOMP (unsigned int nr_threads = 0) : threads_ (nr_threads)
+        {
+          corr_name_ = "CorrespondenceEstimationOMP";
+        }
+
+        /** \brief Initialize the scheduler and set the number of threads to use.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+        /** \brief Determine the correspondences between input and target cloud.
+          * \param[out] correspondences the found correspondences (index of query point, index of target point, distance)
+          * \param[in] max_distance maximum allowed distance between correspondences
+          */
+        virtual void 
+        determineCorrespondences (pcl::Correspondences &correspondences,
+                                  double max_distance = std::numeric_limits<double>::max ());
+
+        /** \brief Determine the reciprocal correspondences between input and target cloud.
+          * A correspondence is considered reciprocal if both Src_i has Tgt_i as a 
+          * correspondence, and Tgt_i has Src_i as one.
+          *
+          * \param[out] correspondences the found correspondences (index of query and target point, distance)
+          * \param[in] max_distance maximum allowed distance between correspondences
+          */
+        virtual void 
+        determineReciprocalCorrespondences (pcl::Correspondences &correspondences,
+                                            double max_distance = std::numeric_limits<double>::max ());
+
+      protected:
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+
+      private:
+        /** \brief Move the valid entries of a per source index correspondence array to its front.
+          * \param[in] valid whether the entry of each source index is a correspondence
+          * \param[in,out] correspondences the correspondences
+          */
+        void
+        compact (const std::vector<char> &valid, pcl::Correspondences &correspondences) const;
+     };
+  }
+}
+
+#include <pcl/registration/impl/correspondence_estimation_omp.hpp>
+
+#endif /* PCL_REGISTRATION_CORRESPONDENCE_ESTIMATION_OMP_H_ */
@@ -0,0 +1,144 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ICP_OMP_H_
+#define PCL_ICP_OMP_H_
+
+#include <pcl/registration/icp.h>
+#include <pcl/registration/transformation_estimation_svd_omp.h>
+
+namespace pcl
+{
+  /** \brief @b IterativeClosestPointOMP is a parallel version of \ref IterativeClosestPoint. The nearest neighbor
+    * search, the distance based correspondence selection, the accumulation of the SVD transformation estimation
+    * and the transformation of the source cloud are distributed over the available threads. The RANSAC outlier
+    * rejection scores its hypotheses on the same threads, but draws and processes them in the same order as the
+    * serial version, so both produce the same results.
+    *
+    * Usage example:
+    * \code
+    * IterativeClosestPointOMP<PointXYZ, PointXYZ> icp (4);
+    * icp.setInputCloud (cloud_source);
+    * icp.setInputTarget (cloud_target);
+    * icp.setMaxCorrespondenceDistance (0.05);
+    * icp.setMaximumIterations (50);
+    * icp.align (cloud_source_registered);
+    * \endcode
+    *
+    * \author Open Perception
+    * \ingroup registration
+    */
+  template <typename PointSource, typename PointTarget>
+  class IterativeClosestPointOMP : public IterativeClosestPoint<PointSource, PointTarget>
+  {
+    typedef typename Registration<PointSource, PointTarget>::PointCloudSource PointCloudSource;
+    typedef typename Registration<PointSource, PointTarget>::PointCloudTarget PointCloudTarget;
+
+    typedef pcl::registration::TransformationEstimationSVDOMP<PointSource, PointTarget> TransformationEstimationSVDOMP;
+
+    public:
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      IterativeClosestPointOMP (unsigned int nr_threads = 0) : threads_ (nr_threads)
+      {
+        reg_name_ = "IterativeClosestPointOMP";
+        transformation_estimation_.reset (new TransformationEstimationSVDOMP (nr_threads));
+      };
+
+      /** \brief Initialize the scheduler and set the number of threads to use. The value is also used by the RANSAC
+        * outlier rejection, and passed on to the transformation estimation if it supports multithreading.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+        boost::shared_ptr<TransformationEstimationSVDOMP> te = 
+          boost::dynamic_pointer_cast<TransformationEstimationSVDOMP> (transformation_estimation_);
+        if (te)
+          te->setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Get the number of threads to use (0 means automatic). */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
+    protected:
+      /** \brief Rigid transformation computation method  with initial guess.
+        * \param output the transformed input point cloud dataset using the rigid transformation found
+        * \param guess the initial guess of the transformation to compute
+        */
+      virtual void 
+      computeTransformation (PointCloudSource &output, const Eigen::Matrix4f &guess);
+
+      /** \brief Apply a rigid transformation to the xyz coordinates of a point cloud in place, in parallel.
+        * \param[in,out] cloud the point cloud to transform
+        * \param[in] transform the rigid transformation to apply
+        */
+      void
+      transformCloud (PointCloudSource &cloud, const Eigen::Matrix4f &transform) const;
+
+      using IterativeClosestPoint<PointSource, PointTarget>::reg_name_;
+      using IterativeClosestPoint<PointSource, PointTarget>::getClassName;
+      using IterativeClosestPoint<PointSource, PointTarget>::input_;
+      using IterativeClosestPoint<PointSource, PointTarget>::indices_;
+      using IterativeClosestPoint<PointSource, PointTarget>::target_;
+      using IterativeClosestPoint<PointSource, PointTarget>::nr_iterations_;
+      using IterativeClosestPoint<PointSource, PointTarget>::max_iterations_;
+      using IterativeClosestPoint<PointSource, PointTarget>::ransac_iterations_;
+      using IterativeClosestPoint<PointSource, PointTarget>::previous_transformation_;
+      using IterativeClosestPoint<PointSource, PointTarget>::final_transformation_;
+      using IterativeClosestPoint<PointSource, PointTarget>::transformation_;
+      using IterativeClosestPoint<PointSource, PointTarget>::transformation_epsilon_;
+      using IterativeClosestPoint<PointSource, PointTarget>::converged_;
+      using IterativeClosestPoint<PointSource, PointTarget>::corr_dist_threshold_;
+      using IterativeClosestPoint<PointSource, PointTarget>::inlier_threshold_;
+      using IterativeClosestPoint<PointSource, PointTarget>::min_number_correspondences_;
+      using IterativeClosestPoint<PointSource, PointTarget>::update_visualizer_;
+      using IterativeClosestPoint<PointSource, PointTarget>::correspondence_distances_;
+      using IterativeClosestPoint<PointSource, PointTarget>::euclidean_fitness_epsilon_;
+      using IterativeClosestPoint<PointSource, PointTarget>::transformation_estimation_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+  };
+}
+
+#include <pcl/registration/impl/icp_omp.hpp>
+
+#endif  //#ifndef PCL_ICP_OMP_H_
@@ -0,0 +1,230 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_REGISTRATION_IMPL_CORRESPONDENCE_ESTIMATION_OMP_H_
+#define PCL_REGISTRATION_IMPL_CORRESPONDENCE_ESTIMATION_OMP_H_
+
+#include <pcl/common/concatenate.h>
+#include <pcl/registration/correspondence_estimation_omp.h>
+#include <pcl/common/io.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> void
+pcl::registration::CorrespondenceEstimationOMP<PointSource, PointTarget>::determineCorrespondences (
+    pcl::Correspondences &correspondences, double max_distance)
+{
+  if (!initCompute ())
+    return;
+
+  double max_dist_sqr = max_distance * max_distance;
+
+  typedef typename pcl::traits::fieldList<PointTarget>::type FieldListTarget;
+  const int nr_queries = static_cast<int> (indices_->size ());
+  correspondences.resize (nr_queries);
+  std::vector<char> valid (nr_queries, 0);
+
+  std::vector<int> index (1);
+  std::vector<float> distance (1);
+  
+  // Check if the template types are the same. If true, avoid a copy.
+  // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
+  if (isSamePointType<PointSource, PointTarget> ())
+  {
+#ifdef _OPENMP
+    const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for shared (correspondences, valid) private (index, distance) num_threads(threads)
+#endif
+    for (int i = 0; i < nr_queries; ++i)
+    {
+      const int idx = (*indices_)[i];
+      tree_->nearestKSearch (input_->points[idx], 1, index, distance);
+      if (distance[0] > max_dist_sqr)
+        continue;
+
+      correspondences[i].index_query = idx;
+      correspondences[i].index_match = index[0];
+      correspondences[i].distance = distance[0];
+      valid[i] = 1;
+    }
+  }
+  else
+  {
+    PointTarget pt;
+    
+#ifdef _OPENMP
+    const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for shared (correspondences, valid) private (index, distance, pt) num_threads(threads)
+#endif
+    for (int i = 0; i < nr_queries; ++i)
+    {
+      const int idx = (*indices_)[i];
+      // Copy the source data to a target PointTarget format so we can search in the tree
+      pcl::for_each_type <FieldListTarget> (pcl::NdConcatenateFunctor <PointSource, PointTarget> (
+            input_->points[idx], 
+            pt));
+
+      tree_->nearestKSearch (pt, 1, index, distance);
+      if (distance[0] > max_dist_sqr)
+        continue;
+
+      correspondences[i].index_query = idx;
+      correspondences[i].index_match = index[0];
+      correspondences[i].distance = distance[0];
+      valid[i] = 1;
+    }
+  }
+  compact (valid, correspondences);
+  deinitCompute ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> void
+pcl::registration::CorrespondenceEstimationOMP<PointSource, PointTarget>::determineReciprocalCorrespondences (
+    pcl::Correspondences &correspondences, double max_distance)
+{
+  if (!initCompute ())
+    return;
+  
+  typedef typename pcl::traits::fieldList<PointSource>::type FieldListSource;
+  typedef typename pcl::traits::fieldList<PointTarget>::type FieldListTarget;
+  typedef typename pcl::intersect<FieldListSource, FieldListTarget>::type FieldList;
+  
+  // setup tree for reciprocal search
+  pcl::KdTreeFLANN<PointSource> tree_reciprocal;
+  // Set the internal point representation of choice
+  if (point_representation_)
+    tree_reciprocal.setPointRepresentation (point_representation_);
+
+  tree_reciprocal.setInputCloud (input_, indices_);
+
+  double max_dist_sqr = max_distance * max_distance;
+
+  const int nr_queries = static_cast<int> (indices_->size ());
+  correspondences.resize (nr_queries);
+  std::vector<char> valid (nr_queries, 0);
+
+  std::vector<int> index (1);
+  std::vector<float> distance (1);
+  std::vector<int> index_reciprocal (1);
+  std::vector<float> distance_reciprocal (1);
+
+  // Check if the template types are the same. If true, avoid a copy.
+  // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
+  if (isSamePointType<PointSource, PointTarget> ())
+  {
+#ifdef _OPENMP
+    const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for shared (correspondences, valid, tree_reciprocal) private (index, distance, index_reciprocal, distance_reciprocal) num_threads(threads)
+#endif
+    for (int i = 0; i < nr_queries; ++i)
+    {
+      const int idx = (*indices_)[i];
+      tree_->nearestKSearch (input_->points[idx], 1, index, distance);
+      if (distance[0] > max_dist_sqr)
+        continue;
+
+      tree_reciprocal.nearestKSearch (target_->points[index[0]], 1, index_reciprocal, distance_reciprocal);
+      if (distance_reciprocal[0] > max_dist_sqr || idx != index_reciprocal[0])
+        continue;
+
+      correspondences[i].index_query = idx;
+      correspondences[i].index_match = index[0];
+      correspondences[i].distance = distance[0];
+      valid[i] = 1;
+    }
+  }
+  else
+  {
+    PointTarget pt_src;
+    PointSource pt_tgt;
+   
+#ifdef _OPENMP
+    const int threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for shared (correspondences, valid, tree_reciprocal) private (index, distance, index_reciprocal, distance_reciprocal, pt_src, pt_tgt) num_threads(threads)
+#endif
+    for (int i = 0; i < nr_queries; ++i)
+    {
+      const int idx = (*indices_)[i];
+      // Copy the source data to a target PointTarget format so we can search in the tree
+      pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointSource, PointTarget> (
+            input_->points[idx], 
+            pt_src));
+
+      tree_->nearestKSearch (pt_src, 1, index, distance);
+      if (distance[0] > max_dist_sqr)
+        continue;
+
+      // Copy the target data to a target PointSource format so we can search in the tree_reciprocal
+      pcl::for_each_type<FieldList> (pcl::NdConcatenateFunctor <PointTarget, PointSource> (
+            target_->points[index[0]],
+            pt_tgt));
+
+      tree_reciprocal.nearestKSearch (pt_tgt, 1, index_reciprocal, distance_reciprocal);
+      if (distance_reciprocal[0] > max_dist_sqr || idx != index_reciprocal[0])
+        continue;
+
+      correspondences[i].index_query = idx;
+      correspondences[i].index_match = index[0];
+      correspondences[i].distance = distance[0];
+      valid[i] = 1;
+    }
+  }
+  compact (valid, correspondences);
+  deinitCompute ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> void
+pcl::registration::CorrespondenceEstimationOMP<PointSource, PointTarget>::compact (
+    const std::vector<char> &valid, pcl::Correspondences &correspondences) const
+{
+  size_t nr_valid_correspondences = 0;
+  for (size_t i = 0; i < valid.size (); ++i)
+  {
+    if (!valid[i])
+      continue;
+    if (i != nr_valid_correspondences)
+      correspondences[nr_valid_correspondences] = correspondences[i];
+    ++nr_valid_correspondences;
+  }
+  correspondences.resize (nr_valid_correspondences);
+}
+
+#endif /* PCL_REGISTRATION_IMPL_CORRESPONDENCE_ESTIMATION_OMP_H_ */
@@ -142,11 +142,22 @@ pcl::registration::TransformationEstimationSVD<PointSource, PointTarget, Scalar>
     const Eigen::Matrix<Scalar, 4, 1> &centroid_tgt,
     Matrix4 &transformation_matrix) const
 {
-  transformation_matrix.setIdentity ();
-
   // Assemble the correlation matrix H = source * target'
   Eigen::Matrix<Scalar, 3, 3> H = (cloud_src_demean * cloud_tgt_demean.transpose ()).topLeftCorner (3, 3);
 
+  getTransformationFromCorrelation (H, centroid_src, centroid_tgt, transformation_matrix);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename Scalar> void
+pcl::registration::TransformationEstimationSVD<PointSource, PointTarget, Scalar>::getTransformationFromCorrelation (
+    const Eigen::Matrix<Scalar, 3, 3> &H,
+    const Eigen::Matrix<Scalar, 4, 1> &centroid_src,
+    const Eigen::Matrix<Scalar, 4, 1> &centroid_tgt,
+    Matrix4 &transformation_matrix) const
+{
+  transformation_matrix.setIdentity ();
+
   // Compute the Singular Value Decomposition
   Eigen::JacobiSVD<Eigen::Matrix<Scalar, 3, 3> > svd (H, Eigen::ComputeFullU | Eigen::ComputeFullV);
   Eigen::Matrix<Scalar, 3, 3> u = svd.matrixU ();
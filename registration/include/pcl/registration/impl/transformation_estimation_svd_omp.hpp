@@ -0,0 +1,208 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_SVD_OMP_HPP_
+#define PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_SVD_OMP_HPP_
+
+#include <pcl/registration/transformation_estimation_svd_omp.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename Scalar> void
+pcl::registration::TransformationEstimationSVDOMP<PointSource, PointTarget, Scalar>::estimateRigidTransformation (
+    const pcl::PointCloud<PointSource> &cloud_src,
+    const pcl::PointCloud<PointTarget> &cloud_tgt,
+    Matrix4 &transformation_matrix) const
+{
+  size_t nr_points = cloud_src.points.size ();
+  if (cloud_tgt.points.size () != nr_points)
+  {
+    PCL_ERROR ("[pcl::TransformationEstimationSVDOMP::estimateRigidTransformation] Number or points in source (%zu) differs than target (%zu)!\n", nr_points, cloud_tgt.points.size ());
+    return;
+  }
+  estimateRigidTransformationOMP (cloud_src, NULL, cloud_tgt, NULL, static_cast<int> (nr_points), transformation_matrix);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename Scalar> void
+pcl::registration::TransformationEstimationSVDOMP<PointSource, PointTarget, Scalar>::estimateRigidTransformation (
+    const pcl::PointCloud<PointSource> &cloud_src,
+    const std::vector<int> &indices_src,
+    const pcl::PointCloud<PointTarget> &cloud_tgt,
+    Matrix4 &transformation_matrix) const
+{
+  if (indices_src.size () != cloud_tgt.points.size ())
+  {
+    PCL_ERROR ("[pcl::TransformationEstimationSVDOMP::estimateRigidTransformation] Number or points in source (%zu) differs than target (%zu)!\n", indices_src.size (), cloud_tgt.points.size ());
+    return;
+  }
+  estimateRigidTransformationOMP (cloud_src, indices_src.empty () ? NULL : &indices_src[0], cloud_tgt, NULL,
+                                  static_cast<int> (indices_src.size ()), transformation_matrix);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename Scalar> void
+pcl::registration::TransformationEstimationSVDOMP<PointSource, PointTarget, Scalar>::estimateRigidTransformation (
+    const pcl::PointCloud<PointSource> &cloud_src,
+    const std::vector<int> &indices_src,
+    const pcl::PointCloud<PointTarget> &cloud_tgt,
+    const std::vector<int> &indices_tgt,
+    Matrix4 &transformation_matrix) const
+{
+  if (indices_src.size () != indices_tgt.size ())
+  {
+    PCL_ERROR ("[pcl::TransformationEstimationSVDOMP::estimateRigidTransformation] Number or points in source (%zu) differs than target (%zu)!\n", indices_src.size (), indices_tgt.size ());
+    return;
+  }
+  estimateRigidTransformationOMP (cloud_src, indices_src.empty () ? NULL : &indices_src[0],
+                                  cloud_tgt, indices_tgt.empty () ? NULL : &indices_tgt[0],
+                                  static_cast<int> (indices_src.size ()), transformation_matrix);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename Scalar> void
+pcl::registration::TransformationEstimationSVDOMP<PointSource, PointTarget, Scalar>::estimateRigidTransformation (
+    const pcl::PointCloud<PointSource> &cloud_src,
+    const pcl::PointCloud<PointTarget> &cloud_tgt,
+    const pcl::Correspondences &correspondences,
+    Matrix4 &transformation_matrix) const
+{
+  const int nr_correspondences = static_cast<int> (correspondences.size ());
+  std::vector<int> indices_src (nr_correspondences), indices_tgt (nr_correspondences);
+  for (int i = 0; i < nr_correspondences; ++i)
+  {
+    indices_src[i] = correspondences[i].index_query;
+    indices_tgt[i] = correspondences[i].index_match;
+  }
+  estimateRigidTransformation (cloud_src, indices_src, cloud_tgt, indices_tgt, transformation_matrix);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename Scalar> int
+pcl::registration::TransformationEstimationSVDOMP<PointSource, PointTarget, Scalar>::getNumberOfBlocks () const
+{
+  if (threads_ != 0)
+    return (static_cast<int> (threads_));
+#ifdef _OPENMP
+  return (omp_get_max_threads ());
+#else
+  return (1);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename Scalar> void
+pcl::registration::TransformationEstimationSVDOMP<PointSource, PointTarget, Scalar>::estimateRigidTransformationOMP (
+    const pcl::PointCloud<PointSource> &cloud_src,
+    const int *indices_src,
+    const pcl::PointCloud<PointTarget> &cloud_tgt,
+    const int *indices_tgt,
+    int nr_correspondences,
+    Matrix4 &transformation_matrix) const
+{
+  transformation_matrix.setIdentity ();
+  if (nr_correspondences == 0)
+    return;
+
+  // Split the correspondences into one contiguous block per thread, so that the reduction order (and
+  // therefore the result) does not depend on the scheduling
+  const int nr_blocks = std::max (1, std::min (getNumberOfBlocks (), nr_correspondences));
+  const int block_size = (nr_correspondences + nr_blocks - 1) / nr_blocks;
+
+  // First pass: the centroids
+  std::vector<Eigen::Vector3d> sum_src (nr_blocks, Eigen::Vector3d::Zero ());
+  std::vector<Eigen::Vector3d> sum_tgt (nr_blocks, Eigen::Vector3d::Zero ());
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_blocks)
+#endif
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    const int end = std::min (nr_correspondences, (b + 1) * block_size);
+    Eigen::Vector3d s (Eigen::Vector3d::Zero ()), t (Eigen::Vector3d::Zero ());
+    for (int i = b * block_size; i < end; ++i)
+    {
+      const PointSource &p_src = cloud_src.points[indices_src ? indices_src[i] : i];
+      const PointTarget &p_tgt = cloud_tgt.points[indices_tgt ? indices_tgt[i] : i];
+      s[0] += p_src.x; s[1] += p_src.y; s[2] += p_src.z;
+      t[0] += p_tgt.x; t[1] += p_tgt.y; t[2] += p_tgt.z;
+    }
+    sum_src[b] = s;
+    sum_tgt[b] = t;
+  }
+  Eigen::Vector3d centroid_src (Eigen::Vector3d::Zero ()), centroid_tgt (Eigen::Vector3d::Zero ());
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    centroid_src += sum_src[b];
+    centroid_tgt += sum_tgt[b];
+  }
+  centroid_src /= static_cast<double> (nr_correspondences);
+  centroid_tgt /= static_cast<double> (nr_correspondences);
+
+  // Second pass: the correlation matrix H = source * target' of the demeaned points
+  std::vector<Eigen::Matrix3d> sum_corr (nr_blocks, Eigen::Matrix3d::Zero ());
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_blocks)
+#endif
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    const int end = std::min (nr_correspondences, (b + 1) * block_size);
+    Eigen::Matrix3d h (Eigen::Matrix3d::Zero ());
+    for (int i = b * block_size; i < end; ++i)
+    {
+      const PointSource &p_src = cloud_src.points[indices_src ? indices_src[i] : i];
+      const PointTarget &p_tgt = cloud_tgt.points[indices_tgt ? indices_tgt[i] : i];
+      const Eigen::Vector3d s (p_src.x - centroid_src[0], p_src.y - centroid_src[1], p_src.z - centroid_src[2]);
+      const Eigen::Vector3d t (p_tgt.x - centroid_tgt[0], p_tgt.y - centroid_tgt[1], p_tgt.z - centroid_tgt[2]);
+      h.noalias () += s * t.transpose ();
+    }
+    sum_corr[b] = h;
+  }
+  Eigen::Matrix3d correlation (Eigen::Matrix3d::Zero ());
+  for (int b = 0; b < nr_blocks; ++b)
+    correlation += sum_corr[b];
+
+  Eigen::Matrix<Scalar, 4, 1> centroid_src_s, centroid_tgt_s;
+  centroid_src_s.head (3) = centroid_src.cast<Scalar> ();
+  centroid_tgt_s.head (3) = centroid_tgt.cast<Scalar> ();
+  centroid_src_s[3] = centroid_tgt_s[3] = 0;
+  this->getTransformationFromCorrelation (Eigen::Matrix<Scalar, 3, 3> (correlation.cast<Scalar> ()),
+                                          centroid_src_s, centroid_tgt_s, transformation_matrix);
+}
+
+#endif /* PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_SVD_OMP_HPP_ */
@@ -141,6 +141,22 @@ namespace pcl
             const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> &cloud_tgt_demean,
             const Eigen::Matrix<Scalar, 4, 1> &centroid_tgt,
             Matrix4 &transformation_matrix) const;
+
+        /** \brief Solve the rigid transformation for a 3x3 correlation matrix that has already been accumulated,
+          * e.g. in parallel blocks. The rotation is R = V * U' from the SVD H = U * S * V', with the sign of the
+          * last column of V flipped if that would otherwise yield a reflection, and the translation moves the
+          * rotated source centroid onto the target centroid.
+          * \param[in] correlation the correlation matrix H = src * tgt' of the demeaned source and target points
+          * \param[in] centroid_src the source centroid
+          * \param[in] centroid_tgt the target centroid
+          * \param[out] transformation_matrix the resultant 4x4 rigid transformation matrix
+          */ 
+        void
+        getTransformationFromCorrelation (
+            const Eigen::Matrix<Scalar, 3, 3> &correlation,
+            const Eigen::Matrix<Scalar, 4, 1> &centroid_src,
+            const Eigen::Matrix<Scalar, 4, 1> &centroid_tgt,
+            Matrix4 &transformation_matrix) const;
      };
 
   }
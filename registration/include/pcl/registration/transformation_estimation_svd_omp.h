@@ -0,0 +1,158 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_SVD_OMP_H_
+#define PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_SVD_OMP_H_
+
+#include <pcl/registration/transformation_estimation_svd.h>
+
+namespace pcl
+{
+  namespace registration
+  {
+    /** @b TransformationEstimationSVDOMP is a parallel version of \ref TransformationEstimationSVD. The centroids
+      * and the 3x3 correlation matrix are accumulated in double precision over blocks of correspondences, one
+      * partial sum per thread, and reduced before the SVD. No demeaned copy of the clouds is created.
+      *
+      * \author Open Perception
+      * \ingroup registration
+      */
+    template <typename PointSource, typename PointTarget, typename Scalar = float>
+    class TransformationEstimationSVDOMP : public TransformationEstimationSVD<PointSource, PointTarget, Scalar>
+    {
+      public:
+        typedef typename TransformationEstimationSVD<PointSource, PointTarget, Scalar>::Matrix4 Matrix4;
+
+        /** \brief Initialize the scheduler and set the number of threads to use.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          */
+        TransformationEstimationSVDOMP (unsigned int nr_threads = 0) : threads_ (nr_threads) {};
+        virtual ~TransformationEstimationSVDOMP () {};
+
+        /** \brief Initialize the scheduler and set the number of threads to use.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+        /** \brief Get the number of threads the scheduler uses (0 means automatic). */
+        inline unsigned int
+        getNumberOfThreads () const { return (threads_); }
+
+        /** \brief Estimate a rigid rotation transformation between a source and a target point cloud using SVD.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        void
+        estimateRigidTransformation (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            Matrix4 &transformation_matrix) const;
+
+        /** \brief Estimate a rigid rotation transformation between a source and a target point cloud using SVD.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] indices_src the vector of indices describing the points of interest in \a cloud_src
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        void
+        estimateRigidTransformation (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const std::vector<int> &indices_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            Matrix4 &transformation_matrix) const;
+
+        /** \brief Estimate a rigid rotation transformation between a source and a target point cloud using SVD.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] indices_src the vector of indices describing the points of interest in \a cloud_src
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[in] indices_tgt the vector of indices describing the correspondences of the interst points from \a indices_src
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        void
+        estimateRigidTransformation (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const std::vector<int> &indices_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            const std::vector<int> &indices_tgt,
+            Matrix4 &transformation_matrix) const;
+
+        /** \brief Estimate a rigid rotation transformation between a source and a target point cloud using SVD.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[in] correspondences the vector of correspondences between source and target point cloud
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        void
+        estimateRigidTransformation (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            const pcl::Correspondences &correspondences,
+            Matrix4 &transformation_matrix) const;
+
+      protected:
+        /** \brief Estimate the transformation from \a nr_correspondences pairs, accumulating in parallel.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] indices_src the source indices (NULL for the first \a nr_correspondences points)
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[in] indices_tgt the target indices (NULL for the first \a nr_correspondences points)
+          * \param[in] nr_correspondences the number of correspondences
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        void
+        estimateRigidTransformationOMP (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const int *indices_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            const int *indices_tgt,
+            int nr_correspondences,
+            Matrix4 &transformation_matrix) const;
+
+        /** \brief Get the number of blocks the correspondences are split into (one per thread). */
+        int
+        getNumberOfBlocks () const;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+    };
+  }
+}
+
+#include <pcl/registration/impl/transformation_estimation_svd_omp.hpp>
+
+#endif /* PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_SVD_OMP_H_ */
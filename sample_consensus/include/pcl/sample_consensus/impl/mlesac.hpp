@@ -55,10 +55,8 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   double d_best_penalty = std::numeric_limits<double>::max();
   double k = 1.0;
 
-  std::vector<int> best_model;
-  std::vector<int> selection;
-  Eigen::VectorXf model_coefficients;
   std::vector<double> distances;
+  std::vector<Hypothesis> hypotheses;
 
   // Compute sigma - remember to set threshold_ correctly !
   sigma_ = computeMedianAbsoluteDeviation (sac_model_->getInputCloud (), sac_model_->getIndices (), threshold_);
@@ -69,93 +67,70 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   Eigen::Vector4f min_pt, max_pt;
   getMinMax (sac_model_->getInputCloud (), sac_model_->getIndices (), min_pt, max_pt);
   max_pt -= min_pt;
-  double v = sqrt (max_pt.dot (max_pt));
+  bbox_diagonal_ = sqrt (max_pt.dot (max_pt));
 
   int n_inliers_count = 0;
-  size_t indices_size;
   unsigned skipped_count = 0;
   // supress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
+  bool done = false;
   
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  while (!done && iterations_ < k && skipped_count < max_skip)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
+    // Get X samples which satisfy the model criteria, and score their models
+    drawHypotheses (getHypothesisBatchSize (k), hypotheses);
 
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    // Process the hypotheses in the order they were drawn
+    for (size_t h = 0; h < hypotheses.size () && iterations_ < k && skipped_count < max_skip; ++h)
     {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-    }
-
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-
-    // Use Expectiation-Maximization to find out the right value for d_cur_penalty
-    // ---[ Initial estimate for the gamma mixing parameter = 1/2
-    double gamma = 0.5;
-    double p_outlier_prob = 0;
-
-    indices_size = sac_model_->getIndices ()->size ();
-    std::vector<double> p_inlier_prob (indices_size);
-    for (int j = 0; j < iterations_EM_; ++j)
-    {
-      // Likelihood of a datum given that it is an inlier
-      for (size_t i = 0; i < indices_size; ++i)
-        p_inlier_prob[i] = gamma * exp (- (distances[i] * distances[i] ) / 2 * (sigma_ * sigma_) ) /
-                           (sqrt (2 * M_PI) * sigma_);
-
-      // Likelihood of a datum given that it is an outlier
-      p_outlier_prob = (1 - gamma) / v;
-
-      gamma = 0;
-      for (size_t i = 0; i < indices_size; ++i)
-        gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
-      gamma /= static_cast<double>(sac_model_->getIndices ()->size ());
-    }
-
-    // Find the log likelihood of the model -L = -sum [log (pInlierProb + pOutlierProb)]
-    double d_cur_penalty = 0;
-    for (size_t i = 0; i < indices_size; ++i)
-      d_cur_penalty += log (p_inlier_prob[i] + p_outlier_prob);
-    d_cur_penalty = - d_cur_penalty;
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      n_inliers_count = 0;
-      // Need to compute the number of inliers for this model to adapt k
-      for (size_t i = 0; i < distances.size (); ++i)
-        if (distances[i] <= 2 * sigma_)
-          n_inliers_count++;
-
-      // Compute the k parameter (k=log(z)/log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1 - pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log (1 - probability_) / log (p_no_outliers);
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
-      break;
+      const Hypothesis &hypothesis = hypotheses[h];
+      if (hypothesis.status == Hypothesis::NO_SAMPLE)
+      {
+        done = true;
+        break;
+      }
+
+      // Search for inliers in the point cloud for the current plane model M
+      if (hypothesis.status != Hypothesis::SCORED)
+      {
+        //iterations_++;
+        ++ skipped_count;
+        continue;
+      }
+
+      double d_cur_penalty = hypothesis.penalty;
+
+      // Better match ?
+      if (d_cur_penalty < d_best_penalty)
+      {
+        d_best_penalty = d_cur_penalty;
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = hypothesis.sample;
+        model_coefficients_ = hypothesis.coefficients;
+
+        // Need the number of inliers for this model to adapt k
+        n_inliers_count = hypothesis.nr_inliers;
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1 - pow (w, static_cast<double> (hypothesis.sample.size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
     }
   }
 
@@ -191,6 +166,50 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::MaximumLikelihoodSampleConsensus<PointT>::scoreHypothesis (Hypothesis &hypothesis)
+{
+  // Iterate through the 3d points and calculate the distances from them to the model
+  std::vector<double> distances;
+  sac_model_->getDistancesToModel (hypothesis.coefficients, distances);
+
+  // Use Expectiation-Maximization to find out the right value for d_cur_penalty
+  // ---[ Initial estimate for the gamma mixing parameter = 1/2
+  double gamma = 0.5;
+  double p_outlier_prob = 0;
+
+  const size_t indices_size = sac_model_->getIndices ()->size ();
+  std::vector<double> p_inlier_prob (indices_size);
+  for (int j = 0; j < iterations_EM_; ++j)
+  {
+    // Likelihood of a datum given that it is an inlier
+    for (size_t i = 0; i < indices_size; ++i)
+      p_inlier_prob[i] = gamma * exp (- (distances[i] * distances[i] ) / 2 * (sigma_ * sigma_) ) /
+                         (sqrt (2 * M_PI) * sigma_);
+
+    // Likelihood of a datum given that it is an outlier
+    p_outlier_prob = (1 - gamma) / bbox_diagonal_;
+
+    gamma = 0;
+    for (size_t i = 0; i < indices_size; ++i)
+      gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
+    gamma /= static_cast<double>(indices_size);
+  }
+
+  // Find the log likelihood of the model -L = -sum [log (pInlierProb + pOutlierProb)]
+  double d_cur_penalty = 0;
+  for (size_t i = 0; i < indices_size; ++i)
+    d_cur_penalty += log (p_inlier_prob[i] + p_outlier_prob);
+  hypothesis.penalty = - d_cur_penalty;
+
+  hypothesis.nr_inliers = 0;
+  for (size_t i = 0; i < distances.size (); ++i)
+    if (distances[i] <= 2 * sigma_)
+      hypothesis.nr_inliers++;
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> double
 pcl::MaximumLikelihoodSampleConsensus<PointT>::computeMedianAbsoluteDeviation (
@@ -55,73 +55,86 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
   double d_best_penalty = std::numeric_limits<double>::max();
   double k = 1.0;
 
-  std::vector<int> best_model;
-  std::vector<int> selection;
-  Eigen::VectorXf model_coefficients;
   std::vector<double> distances;
 
   int n_inliers_count = 0;
+
+  if (preemptive_)
+  {
+    Hypothesis best;
+    if (selectHypothesisPreemptive (best))
+    {
+      model_              = best.sample;
+      model_coefficients_ = best.coefficients;
+      d_best_penalty      = best.penalty;
+    }
+    else
+      model_.clear ();
+  }
+
+  std::vector<Hypothesis> hypotheses;
+
   unsigned skipped_count = 0;
   // supress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
+  bool done = preemptive_;
   
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  while (!done && iterations_ < k && skipped_count < max_skip)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
+    // Get X samples which satisfy the model criteria, and score their models
+    drawHypotheses (getHypothesisBatchSize (k), hypotheses);
 
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-     }
-
-    double d_cur_penalty = 0;
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-    
-    if (distances.empty () && k > 1.0)
-      continue;
-
-    for (size_t i = 0; i < distances.size (); ++i)
-      d_cur_penalty += (std::min) (distances[i], threshold_);
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      n_inliers_count = 0;
-      // Need to compute the number of inliers for this model to adapt k
-      for (size_t i = 0; i < distances.size (); ++i)
-        if (distances[i] <= threshold_)
-          ++n_inliers_count;
-
-      // Compute the k parameter (k=log(z)/log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1.0 - pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log (1.0 - probability_) / log (p_no_outliers);
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
+    // Process the hypotheses in the order they were drawn
+    for (size_t h = 0; h < hypotheses.size () && iterations_ < k && skipped_count < max_skip; ++h)
     {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
-      break;
+      const Hypothesis &hypothesis = hypotheses[h];
+      if (hypothesis.status == Hypothesis::NO_SAMPLE)
+      {
+        done = true;
+        break;
+      }
+
+      // Search for inliers in the point cloud for the current plane model M
+      if (hypothesis.status != Hypothesis::SCORED)
+      {
+        //iterations_++;
+        ++ skipped_count;
+        continue;
+      }
+
+      double d_cur_penalty = hypothesis.penalty;
+
+      // Better match ?
+      if (d_cur_penalty < d_best_penalty)
+      {
+        d_best_penalty = d_cur_penalty;
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = hypothesis.sample;
+        model_coefficients_ = hypothesis.coefficients;
+
+        // Need the number of inliers for this model to adapt k
+        n_inliers_count = hypothesis.nr_inliers;
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1.0 - pow (w, static_cast<double> (hypothesis.sample.size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1.0 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
     }
   }
 
@@ -158,6 +171,27 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::MEstimatorSampleConsensus<PointT>::scoreHypothesis (Hypothesis &hypothesis)
+{
+  // Iterate through the 3d points and calculate the distances from them to the model
+  std::vector<double> distances;
+  sac_model_->getDistancesToModel (hypothesis.coefficients, distances);
+  if (distances.empty ())
+    return (false);
+
+  hypothesis.penalty = 0;
+  hypothesis.nr_inliers = 0;
+  for (size_t i = 0; i < distances.size (); ++i)
+  {
+    hypothesis.penalty += (std::min) (distances[i], threshold_);
+    if (distances[i] <= threshold_)
+      ++hypothesis.nr_inliers;
+  }
+  return (true);
+}
+
 #define PCL_INSTANTIATE_MEstimatorSampleConsensus(T) template class PCL_EXPORTS pcl::MEstimatorSampleConsensus<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_MSAC_H_
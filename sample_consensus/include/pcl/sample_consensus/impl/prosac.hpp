@@ -75,9 +75,8 @@ pcl::ProgressiveSampleConsensus<PointT>::computeModel (int debug_verbosity_level
   // Initialize the usual RANSAC parameters
   iterations_ = 0;
 
-  std::vector<int> inliers;
-  std::vector<int> selection;
-  Eigen::VectorXf model_coefficients;
+  std::vector<Hypothesis> hypotheses;
+  bool done = false;
 
   // We will increase the pool so the indices_ vector can only contain m elements at first
   std::vector<int> index_pool;
@@ -86,133 +85,158 @@ pcl::ProgressiveSampleConsensus<PointT>::computeModel (int debug_verbosity_level
     index_pool.push_back (sac_model_->indices_->operator[](i));
 
   // Iterate
-  while (static_cast<unsigned int> (iterations_) < k_n_star)
+  while (!done && static_cast<unsigned int> (iterations_) < k_n_star)
   {
-    // Choose the samples
-
-    // Step 1
-    // According to Equation 5 in the text text, not the algorithm
-    if ((iterations_ == T_prime_n) && (n < n_star))
+    // Choose the samples of the next iterations. The pool only depends on the iteration number, so the samples
+    // can be drawn ahead and their models scored in parallel
+    hypotheses.resize (getHypothesisBatchSize (static_cast<double> (k_n_star)));
+    int iterations = iterations_;
+    for (size_t h = 0; h < hypotheses.size (); ++h, ++iterations)
     {
-      // Increase the pool
-      ++n;
-      if (n >= N)
-        break;
-      index_pool.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
-      // Update other variables
-      float T_n_minus_1 = T_n;
-      T_n *= (static_cast<float>(n) + 1.0f) / (static_cast<float>(n) + 1.0f - static_cast<float>(m));
-      T_prime_n += ceilf (T_n - T_n_minus_1);
-    }
+      std::vector<int> &selection = hypotheses[h].sample;
 
-    // Step 2
-    sac_model_->indices_->swap (index_pool);
-    selection.clear ();
-    sac_model_->getSamples (iterations_, selection);
-    if (T_prime_n < iterations_)
-    {
-      selection.pop_back ();
-      selection.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
-    }
+      // Step 1
+      // According to Equation 5 in the text text, not the algorithm
+      if ((iterations == T_prime_n) && (n < n_star))
+      {
+        // Increase the pool
+        ++n;
+        if (n >= N)
+        {
+          hypotheses.resize (h);
+          done = true;
+          break;
+        }
+        index_pool.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
+        // Update other variables
+        float T_n_minus_1 = T_n;
+        T_n *= (static_cast<float>(n) + 1.0f) / (static_cast<float>(n) + 1.0f - static_cast<float>(m));
+        T_prime_n += ceilf (T_n - T_n_minus_1);
+      }
 
-    // Make sure we use the right indices for testing
-    sac_model_->indices_->swap (index_pool);
+      // Step 2
+      sac_model_->indices_->swap (index_pool);
+      selection.clear ();
+      sac_model_->getSamples (iterations, selection);
+      if (T_prime_n < iterations)
+      {
+        selection.pop_back ();
+        selection.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
+      }
 
-    if (selection.empty ())
-    {
-      PCL_ERROR ("[pcl::ProgressiveSampleConsensus::computeModel] No samples could be selected!\n");
-      break;
-    }
+      // Make sure we use the right indices for testing
+      sac_model_->indices_->swap (index_pool);
 
-    // Search for inliers in the point cloud for the current model
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      ++iterations_;
-      continue;
+      if (selection.empty ())
+      {
+        hypotheses.resize (h + 1);
+        break;
+      }
     }
 
-    // Select the inliers that are within threshold_ from the model
-    inliers.clear ();
-    sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
-
-    size_t I_N = inliers.size ();
+    // Search for inliers in the point cloud for the current models
+    evaluateHypotheses (hypotheses);
 
-    // If we find more inliers than before
-    if (I_N > I_N_best)
+    // Process the hypotheses in the order they were drawn
+    for (size_t h = 0; h < hypotheses.size () && static_cast<unsigned int> (iterations_) < k_n_star; ++h)
     {
-      I_N_best = I_N;
-
-      // Save the current model/inlier/coefficients selection as being the best so far
-      inliers_ = inliers;
-      model_ = selection;
-      model_coefficients_ = model_coefficients;
-
-      // We estimate I_n_star for different possible values of n_star by using the inliers
-      std::sort (inliers.begin (), inliers.end ());
-
-      // Try to find a better n_star
-      // We minimize k_n_star and therefore maximize epsilon_n_star = I_n_star / n_star
-      size_t possible_n_star_best = N, I_possible_n_star_best = I_N;
-      float epsilon_possible_n_star_best = static_cast<float>(I_possible_n_star_best) / static_cast<float>(possible_n_star_best);
-
-      // We only need to compute possible better epsilon_n_star for when _n is just about to be removed an inlier
-      size_t I_possible_n_star = I_N;
-      for (std::vector<int>::const_reverse_iterator last_inlier = inliers.rbegin (), 
-                                                    inliers_end = inliers.rend (); 
-           last_inlier != inliers_end; 
-           ++last_inlier, --I_possible_n_star)
+      Hypothesis &hypothesis = hypotheses[h];
+      if (hypothesis.status == Hypothesis::NO_SAMPLE)
       {
-        // The best possible_n_star for a given I_possible_n_star is the index of the last inlier
-        unsigned int possible_n_star = (*last_inlier) + 1;
-        if (possible_n_star <= m)
-          break;
+        PCL_ERROR ("[pcl::ProgressiveSampleConsensus::computeModel] No samples could be selected!\n");
+        done = true;
+        break;
+      }
+
+      if (hypothesis.status != Hypothesis::SCORED)
+      {
+        ++iterations_;
+        continue;
+      }
+
+      // The inliers that are within threshold_ from the model
+      std::vector<int> &inliers = hypothesis.inliers;
+
+      size_t I_N = inliers.size ();
 
-        // If we find a better epsilon_n_star
-        float epsilon_possible_n_star = static_cast<float>(I_possible_n_star) / static_cast<float>(possible_n_star);
-        // Make sure we have a better epsilon_possible_n_star
-        if ((epsilon_possible_n_star > epsilon_n_star) && (epsilon_possible_n_star > epsilon_possible_n_star_best))
+      // If we find more inliers than before
+      if (I_N > I_N_best)
+      {
+        I_N_best = I_N;
+
+        // Save the current model/inlier/coefficients selection as being the best so far
+        inliers_ = inliers;
+        model_ = hypothesis.sample;
+        model_coefficients_ = hypothesis.coefficients;
+
+        // We estimate I_n_star for different possible values of n_star by using the inliers
+        std::sort (inliers.begin (), inliers.end ());
+
+        // Try to find a better n_star
+        // We minimize k_n_star and therefore maximize epsilon_n_star = I_n_star / n_star
+        size_t possible_n_star_best = N, I_possible_n_star_best = I_N;
+        float epsilon_possible_n_star_best = static_cast<float>(I_possible_n_star_best) / static_cast<float>(possible_n_star_best);
+
+        // We only need to compute possible better epsilon_n_star for when _n is just about to be removed an inlier
+        size_t I_possible_n_star = I_N;
+        for (std::vector<int>::const_reverse_iterator last_inlier = inliers.rbegin (), 
+                                                      inliers_end = inliers.rend (); 
+             last_inlier != inliers_end; 
+             ++last_inlier, --I_possible_n_star)
         {
-          // Typo in Equation 7, not (n-m choose i-m) but (n choose i-m)
-          size_t I_possible_n_star_min = m
-                           + static_cast<size_t> (ceil (boost::math::quantile (boost::math::complement (boost::math::binomial_distribution<float>(static_cast<float> (possible_n_star), 0.1f), 0.05))));
-          // If Equation 9 is not verified, exit
-          if (I_possible_n_star < I_possible_n_star_min)
+          // The best possible_n_star for a given I_possible_n_star is the index of the last inlier
+          unsigned int possible_n_star = (*last_inlier) + 1;
+          if (possible_n_star <= m)
             break;
 
-          possible_n_star_best = possible_n_star;
-          I_possible_n_star_best = I_possible_n_star;
-          epsilon_possible_n_star_best = epsilon_possible_n_star;
+          // If we find a better epsilon_n_star
+          float epsilon_possible_n_star = static_cast<float>(I_possible_n_star) / static_cast<float>(possible_n_star);
+          // Make sure we have a better epsilon_possible_n_star
+          if ((epsilon_possible_n_star > epsilon_n_star) && (epsilon_possible_n_star > epsilon_possible_n_star_best))
+          {
+            // Typo in Equation 7, not (n-m choose i-m) but (n choose i-m)
+            size_t I_possible_n_star_min = m
+                             + static_cast<size_t> (ceil (boost::math::quantile (boost::math::complement (boost::math::binomial_distribution<float>(static_cast<float> (possible_n_star), 0.1f), 0.05))));
+            // If Equation 9 is not verified, exit
+            if (I_possible_n_star < I_possible_n_star_min)
+              break;
+
+            possible_n_star_best = possible_n_star;
+            I_possible_n_star_best = I_possible_n_star;
+            epsilon_possible_n_star_best = epsilon_possible_n_star;
+          }
+        }
+
+        // Check if we get a better epsilon
+        if (epsilon_possible_n_star_best > epsilon_n_star)
+        {
+          // update the best value
+          epsilon_n_star = epsilon_possible_n_star_best;
+
+          // Compute the new k_n_star
+          float bottom_log = 1 - std::pow (epsilon_n_star, static_cast<float>(m));
+          if (bottom_log == 0)
+            k_n_star = 1;
+          else if (bottom_log == 1)
+            k_n_star = T_N;
+          else
+            k_n_star = static_cast<int> (ceil (log (0.05) / log (bottom_log)));
+          // It seems weird to have very few iterations, so do have a few (totally empirical)
+          k_n_star = (std::max)(k_n_star, 2 * m);
         }
       }
 
-      // Check if we get a better epsilon
-      if (epsilon_possible_n_star_best > epsilon_n_star)
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] Trial %d out of %d: %d inliers (best is: %d so far).\n", iterations_, k_n_star, I_N, I_N_best);
+      if (iterations_ > max_iterations_)
       {
-        // update the best value
-        epsilon_n_star = epsilon_possible_n_star_best;
-
-        // Compute the new k_n_star
-        float bottom_log = 1 - std::pow (epsilon_n_star, static_cast<float>(m));
-        if (bottom_log == 0)
-          k_n_star = 1;
-        else if (bottom_log == 1)
-          k_n_star = T_N;
-        else
-          k_n_star = static_cast<int> (ceil (log (0.05) / log (bottom_log)));
-        // It seems weird to have very few iterations, so do have a few (totally empirical)
-        k_n_star = (std::max)(k_n_star, 2 * m);
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+        done = true;
+        break;
       }
     }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] Trial %d out of %d: %d inliers (best is: %d so far).\n", iterations_, k_n_star, I_N, I_N_best);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
-      break;
-    }
   }
 
   if (debug_verbosity_level > 0)
@@ -229,6 +253,18 @@ pcl::ProgressiveSampleConsensus<PointT>::computeModel (int debug_verbosity_level
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool 
+pcl::ProgressiveSampleConsensus<PointT>::scoreHypothesis (Hypothesis &hypothesis)
+{
+  // Select the inliers that are within threshold_ from the model
+  hypothesis.inliers.clear ();
+  sac_model_->selectWithinDistance (hypothesis.coefficients, threshold_, hypothesis.inliers);
+  hypothesis.nr_inliers = static_cast<int> (hypothesis.inliers.size ());
+  hypothesis.penalty = -static_cast<double> (hypothesis.nr_inliers);
+  return (true);
+}
+
 #define PCL_INSTANTIATE_ProgressiveSampleConsensus(T) template class PCL_EXPORTS pcl::ProgressiveSampleConsensus<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_PROSAC_H_
@@ -55,64 +55,78 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int)
   int n_best_inliers_count = -INT_MAX;
   double k = 1.0;
 
-  std::vector<int> selection;
-  Eigen::VectorXf model_coefficients;
+  if (preemptive_)
+  {
+    Hypothesis best;
+    if (selectHypothesisPreemptive (best))
+    {
+      model_              = best.sample;
+      model_coefficients_ = best.coefficients;
+      n_best_inliers_count = best.nr_inliers;
+    }
+    else
+      model_.clear ();
+  }
+
+  std::vector<Hypothesis> hypotheses;
 
-  int n_inliers_count = 0;
   unsigned skipped_count = 0;
   // supress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
+  bool done = preemptive_;
   
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  while (!done && iterations_ < k && skipped_count < max_skip)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) 
-    {
-      PCL_ERROR ("[pcl::RandomSampleConsensus::computeModel] No samples could be selected!\n");
-      break;
-    }
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //++iterations_;
-      ++skipped_count;
-      continue;
-    }
-
-    // Select the inliers that are within threshold_ from the model
-    //sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
-    //if (inliers.empty () && k > 1.0)
-    //  continue;
-
-    n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_);
-
-    // Better match ?
-    if (n_inliers_count > n_best_inliers_count)
-    {
-      n_best_inliers_count = n_inliers_count;
-
-      // Save the current model/inlier/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      // Compute the k parameter (k=log(z)/log(1-w^n))
-      double w = static_cast<double> (n_best_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1.0 - pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log (1.0 - probability_) / log (p_no_outliers);
-    }
+    // Get X samples which satisfy the model criteria, and score their models
+    drawHypotheses (getHypothesisBatchSize (k), hypotheses);
 
-    ++iterations_;
-    PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %d inliers (best is: %d so far).\n", iterations_, k, n_inliers_count, n_best_inliers_count);
-    if (iterations_ > max_iterations_)
+    // Process the hypotheses in the order they were drawn
+    for (size_t h = 0; h < hypotheses.size () && iterations_ < k && skipped_count < max_skip; ++h)
     {
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
-      break;
+      const Hypothesis &hypothesis = hypotheses[h];
+      if (hypothesis.status == Hypothesis::NO_SAMPLE) 
+      {
+        PCL_ERROR ("[pcl::RandomSampleConsensus::computeModel] No samples could be selected!\n");
+        done = true;
+        break;
+      }
+
+      // Search for inliers in the point cloud for the current plane model M
+      if (hypothesis.status != Hypothesis::SCORED)
+      {
+        //++iterations_;
+        ++skipped_count;
+        continue;
+      }
+
+      const int n_inliers_count = hypothesis.nr_inliers;
+
+      // Better match ?
+      if (n_inliers_count > n_best_inliers_count)
+      {
+        n_best_inliers_count = n_inliers_count;
+
+        // Save the current model/inlier/coefficients selection as being the best so far
+        model_              = hypothesis.sample;
+        model_coefficients_ = hypothesis.coefficients;
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_best_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1.0 - pow (w, static_cast<double> (hypothesis.sample.size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1.0 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %d inliers (best is: %d so far).\n", iterations_, k, n_inliers_count, n_best_inliers_count);
+      if (iterations_ > max_iterations_)
+      {
+        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
     }
   }
 
@@ -0,0 +1,207 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SAMPLE_CONSENSUS_IMPL_SAC_H_
+#define PCL_SAMPLE_CONSENSUS_IMPL_SAC_H_
+
+#include <pcl/sample_consensus/sac.h>
+#include <algorithm>
+#include <cmath>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+template <typename T> void
+pcl::SampleConsensus<T>::drawHypotheses (size_t nr_hypotheses, std::vector<Hypothesis> &hypotheses)
+{
+  hypotheses.resize (nr_hypotheses);
+
+  // The samples are drawn sequentially, so that the sequence does not depend on the number of threads
+  int iterations = iterations_;
+  for (size_t i = 0; i < nr_hypotheses; ++i)
+  {
+    sac_model_->getSamples (iterations, hypotheses[i].sample);
+    if (hypotheses[i].sample.empty ())
+    {
+      hypotheses.resize (i + 1);
+      break;
+    }
+  }
+
+  evaluateHypotheses (hypotheses);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename T> void
+pcl::SampleConsensus<T>::evaluateHypotheses (std::vector<Hypothesis> &hypotheses, bool score)
+{
+  const int nr_hypotheses = static_cast<int> (hypotheses.size ());
+  const int nr_threads = (std::min) (getNumberOfHypothesisThreads (), (std::max) (nr_hypotheses, 1));
+
+#ifdef _OPENMP
+#pragma omp parallel for shared (hypotheses) schedule (dynamic) num_threads(nr_threads) if (nr_hypotheses > 1)
+#endif
+  for (int i = 0; i < nr_hypotheses; ++i)
+  {
+    Hypothesis &hypothesis = hypotheses[i];
+    hypothesis.penalty = 0;
+    hypothesis.nr_inliers = 0;
+
+    if (hypothesis.sample.empty ())
+      hypothesis.status = Hypothesis::NO_SAMPLE;
+    else if (!sac_model_->computeModelCoefficients (hypothesis.sample, hypothesis.coefficients))
+      hypothesis.status = Hypothesis::INVALID_MODEL;
+    else if (score && !scoreHypothesis (hypothesis))
+      hypothesis.status = Hypothesis::NOT_SCORED;
+    else
+      hypothesis.status = Hypothesis::SCORED;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename T> bool
+pcl::SampleConsensus<T>::scoreHypothesis (Hypothesis &hypothesis)
+{
+  hypothesis.nr_inliers = sac_model_->countWithinDistance (hypothesis.coefficients, threshold_);
+  hypothesis.penalty = -static_cast<double> (hypothesis.nr_inliers);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename T> bool
+pcl::SampleConsensus<T>::selectHypothesisPreemptive (Hypothesis &best)
+{
+  const size_t nr_points = sac_model_->indices_->size ();
+  const size_t block_size = static_cast<size_t> ((std::max) (preemptive_block_size_, 1));
+
+  // Generate all the hypotheses up front
+  std::vector<Hypothesis> hypotheses ((std::max) (max_iterations_, 1));
+  int iterations = 0;
+  for (size_t i = 0; i < hypotheses.size (); ++i)
+  {
+    sac_model_->getSamples (iterations, hypotheses[i].sample);
+    if (hypotheses[i].sample.empty ())
+    {
+      PCL_ERROR ("[pcl::SampleConsensus::selectHypothesisPreemptive] No samples could be selected!\n");
+      hypotheses.resize (i);
+      break;
+    }
+  }
+  evaluateHypotheses (hypotheses, false);
+  iterations_ = static_cast<int> (hypotheses.size ());
+
+  // (penalty, hypothesis) pairs of the surviving hypotheses; sorting them breaks ties by drawing order
+  std::vector<std::pair<double, int> > alive;
+  alive.reserve (hypotheses.size ());
+  for (size_t i = 0; i < hypotheses.size (); ++i)
+    if (hypotheses[i].status == Hypothesis::SCORED)
+      alive.push_back (std::make_pair (0.0, static_cast<int> (i)));
+  if (alive.empty ())
+    return (false);
+
+  // Score the hypotheses on the points in random order, given as positions in the indices of the model
+  std::vector<int> order (nr_points);
+  for (size_t i = 0; i < nr_points; ++i)
+    order[i] = static_cast<int> (i);
+  for (size_t i = 0; i + 1 < nr_points; ++i)
+    std::swap (order[i], order[i + static_cast<size_t> (static_cast<double> (nr_points - i) * rnd ())]);
+
+  std::vector<int> nr_inliers (hypotheses.size (), 0);
+  std::vector<int> block;
+  const int nr_threads = getNumberOfHypothesisThreads ();
+  for (size_t start = 0; start < nr_points && alive.size () > 1; start += block_size)
+  {
+    block.assign (order.begin () + start, order.begin () + (std::min) (start + block_size, nr_points));
+
+    // The model is scored on the current block only
+    sac_model_->setIndicesSubset (block);
+    const int nr_alive = static_cast<int> (alive.size ());
+#ifdef _OPENMP
+#pragma omp parallel for shared (alive, hypotheses, nr_inliers) schedule (dynamic) num_threads(nr_threads)
+#endif
+    for (int i = 0; i < nr_alive; ++i)
+    {
+      Hypothesis &hypothesis = hypotheses[alive[i].second];
+      if (!scoreHypothesis (hypothesis))
+        continue;
+      alive[i].first += hypothesis.penalty;
+      nr_inliers[alive[i].second] += hypothesis.nr_inliers;
+    }
+    sac_model_->resetIndicesSubset ();
+
+    // Keep the best half
+    std::sort (alive.begin (), alive.end ());
+    alive.resize ((alive.size () + 1) / 2);
+  }
+
+  std::sort (alive.begin (), alive.end ());
+  best = hypotheses[alive[0].second];
+  best.penalty = alive[0].first;
+  best.nr_inliers = nr_inliers[alive[0].second];
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename T> size_t
+pcl::SampleConsensus<T>::getHypothesisBatchSize (double k) const
+{
+  const int nr_threads = getNumberOfHypothesisThreads ();
+  if (nr_threads <= 1)
+    return (1);
+
+  // Do not draw many more hypotheses than are still required
+  const double remaining = (std::min) (std::ceil (k), static_cast<double> (max_iterations_) + 1.0) - static_cast<double> (iterations_);
+  if (remaining <= 1.0)
+    return (1);
+  return (static_cast<size_t> ((std::min) (remaining, static_cast<double> (nr_threads))));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename T> int
+pcl::SampleConsensus<T>::getNumberOfHypothesisThreads () const
+{
+#ifdef _OPENMP
+  if (threads_ != 0)
+    return (static_cast<int> (threads_));
+  return (omp_get_max_threads ());
+#else
+  return (1);
+#endif
+}
+
+#endif    // PCL_SAMPLE_CONSENSUS_IMPL_SAC_H_
@@ -40,6 +40,7 @@
 
 #include <pcl/sample_consensus/eigen.h>
 #include <pcl/sample_consensus/sac_model_circle.h>
+#include <pcl/sample_consensus/sac_simd.h>
 #include <pcl/common/concatenate.h>
 
 //////////////////////////////////////////////////////////////////////////
@@ -107,19 +108,10 @@ pcl::SampleConsensusModelCircle2D<PointT>::getDistancesToModel (const Eigen::Vec
     distances.clear ();
     return;
   }
-  distances.resize (indices_->size ());
-
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (size_t i = 0; i < indices_->size (); ++i)
-    // Calculate the distance from the point to the circle as the difference between
-    // dist(point,circle_origin) and circle_radius
-    distances[i] = fabsf (sqrtf (
-                                ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) *
-                                ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) +
-
-                                ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) *
-                                ( input_->points[(*indices_)[i]].y - model_coefficients[1] )
-                                ) - model_coefficients[2]);
+
+  // Compute the distances from the points to the circle, several points at a time
+  sac_simd::Circle2DDistance<PointT> distance_kernel (*input_, model_coefficients);
+  sac_simd::getDistances (distance_kernel, *indices_, distances);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -134,29 +126,9 @@ pcl::SampleConsensusModelCircle2D<PointT>::selectWithinDistance (
     inliers.clear ();
     return;
   }
-  int nr_p = 0;
-  inliers.resize (indices_->size ());
-
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the sphere as the difference between
-    // dist(point,sphere_origin) and sphere_radius
-    float distance = fabsf (sqrtf (
-                                  ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) *
-                                  ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) +
-
-                                  ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) *
-                                  ( input_->points[(*indices_)[i]].y - model_coefficients[1] )
-                                  ) - model_coefficients[2]);
-    if (distance < threshold)
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers[nr_p] = (*indices_)[i];
-      nr_p++;
-    }
-  }
-  inliers.resize (nr_p);
+  // Select the points whose distances to the circle are smaller than the threshold, several points at a time
+  sac_simd::Circle2DDistance<PointT> distance_kernel (*input_, model_coefficients);
+  sac_simd::selectWithinDistance (distance_kernel, *indices_, threshold, inliers);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -167,24 +139,9 @@ pcl::SampleConsensusModelCircle2D<PointT>::countWithinDistance (
   // Check if the model is valid given the user constraints
   if (!isModelValid (model_coefficients))
     return (0);
-  int nr_p = 0;
-
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the sphere as the difference between
-    // dist(point,sphere_origin) and sphere_radius
-    float distance = fabsf (sqrtf (
-                                  ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) *
-                                  ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) +
-
-                                  ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) *
-                                  ( input_->points[(*indices_)[i]].y - model_coefficients[1] )
-                                  ) - model_coefficients[2]);
-    if (distance < threshold)
-      nr_p++;
-  }
-  return (nr_p);
+  // Count the points whose distances to the circle are smaller than the threshold, several points at a time
+  sac_simd::Circle2DDistance<PointT> distance_kernel (*input_, model_coefficients);
+  return (sac_simd::countWithinDistance (distance_kernel, *indices_, threshold));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -39,6 +39,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_LINE_H_
 
 #include <pcl/sample_consensus/sac_model_line.h>
+#include <pcl/sample_consensus/sac_simd.h>
 #include <pcl/common/centroid.h>
 #include <pcl/common/concatenate.h>
 
@@ -91,21 +92,9 @@ pcl::SampleConsensusModelLine<PointT>::getDistancesToModel (
   if (!isModelValid (model_coefficients))
     return;
 
-  distances.resize (indices_->size ());
-
-  // Obtain the line point and direction
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
-  line_dir.normalize ();
-
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    // Need to estimate sqrt here to keep MSAC and friends general
-    distances[i] = sqrt ((line_pt - input_->points[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ());
-  }
+  // Compute the distances from the points to the line, several points at a time
+  sac_simd::LineDistance<PointT> distance_kernel (*input_, model_coefficients);
+  sac_simd::getDistances (distance_kernel, *indices_, distances);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -117,31 +106,9 @@ pcl::SampleConsensusModelLine<PointT>::selectWithinDistance (
   if (!isModelValid (model_coefficients))
     return;
 
-  double sqr_threshold = threshold * threshold;
-
-  int nr_p = 0;
-  inliers.resize (indices_->size ());
-
-  // Obtain the line point and direction
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
-  line_dir.normalize ();
-
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    double sqr_distance = (line_pt - input_->points[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ();
-
-    if (sqr_distance < sqr_threshold)
-    {
-      // Returns the indices of the points whose squared distances are smaller than the threshold
-      inliers[nr_p] = (*indices_)[i];
-      nr_p++;
-    }
-  }
-  inliers.resize (nr_p);
+  // Select the points whose distances to the line are smaller than the threshold, several points at a time
+  sac_simd::LineDistance<PointT> distance_kernel (*input_, model_coefficients);
+  sac_simd::selectWithinDistance (distance_kernel, *indices_, threshold, inliers);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -153,26 +120,9 @@ pcl::SampleConsensusModelLine<PointT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
-  double sqr_threshold = threshold * threshold;
-
-  int nr_p = 0;
-
-  // Obtain the line point and direction
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
-  line_dir.normalize ();
-
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    double sqr_distance = (line_pt - input_->points[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ();
-
-    if (sqr_distance < sqr_threshold)
-      nr_p++;
-  }
-  return (nr_p);
+  // Count the points whose distances to the line are smaller than the threshold, several points at a time
+  sac_simd::LineDistance<PointT> distance_kernel (*input_, model_coefficients);
+  return (sac_simd::countWithinDistance (distance_kernel, *indices_, threshold));
 }
 
 //////////////////////////////////////////////////////////////////////////
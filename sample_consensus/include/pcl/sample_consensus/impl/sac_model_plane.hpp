@@ -39,6 +39,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_PLANE_H_
 
 #include <pcl/sample_consensus/sac_model_plane.h>
+#include <pcl/sample_consensus/sac_simd.h>
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
 #include <pcl/common/concatenate.h>
@@ -115,23 +116,9 @@ pcl::SampleConsensusModelPlane<PointT>::getDistancesToModel (
     return;
   }
 
-  distances.resize (indices_->size ());
-
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    /*distances[i] = fabs (model_coefficients[0] * input_->points[(*indices_)[i]].x +
-                         model_coefficients[1] * input_->points[(*indices_)[i]].y +
-                         model_coefficients[2] * input_->points[(*indices_)[i]].z +
-                         model_coefficients[3]);*/
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x,
-                        input_->points[(*indices_)[i]].y,
-                        input_->points[(*indices_)[i]].z,
-                        1);
-    distances[i] = fabs (model_coefficients.dot (pt));
-  }
+  // Compute the distances from the points to the plane, several points at a time
+  sac_simd::PlaneDistance<PointT> distance_kernel (*input_, model_coefficients);
+  sac_simd::getDistances (distance_kernel, *indices_, distances);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -146,26 +133,9 @@ pcl::SampleConsensusModelPlane<PointT>::selectWithinDistance (
     return;
   }
 
-  int nr_p = 0;
-  inliers.resize (indices_->size ());
-
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x,
-                        input_->points[(*indices_)[i]].y,
-                        input_->points[(*indices_)[i]].z,
-                        1);
-    if (fabs (model_coefficients.dot (pt)) < threshold)
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers[nr_p] = (*indices_)[i];
-      nr_p++;
-    }
-  }
-  inliers.resize (nr_p);
+  // Select the points whose distances to the plane are smaller than the threshold, several points at a time
+  sac_simd::PlaneDistance<PointT> distance_kernel (*input_, model_coefficients);
+  sac_simd::selectWithinDistance (distance_kernel, *indices_, threshold, inliers);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -180,21 +150,9 @@ pcl::SampleConsensusModelPlane<PointT>::countWithinDistance (
     return (0);
   }
 
-  int nr_p = 0;
-
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x,
-                        input_->points[(*indices_)[i]].y,
-                        input_->points[(*indices_)[i]].z,
-                        1);
-    if (fabs (model_coefficients.dot (pt)) < threshold)
-      nr_p++;
-  }
-  return (nr_p);
+  // Count the points whose distances to the plane are smaller than the threshold, several points at a time
+  sac_simd::PlaneDistance<PointT> distance_kernel (*input_, model_coefficients);
+  return (sac_simd::countWithinDistance (distance_kernel, *indices_, threshold));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -72,9 +72,16 @@ pcl::SampleConsensusModelRegistration<PointT>::computeModelCoefficients (const s
   if (samples.size () != 3)
     return (false);
 
+  // Hypotheses may be computed concurrently, so only look the correspondences up
+  const boost::unordered_map<int, int> &correspondences = correspondences_;
   std::vector<int> indices_tgt (3);
   for (int i = 0; i < 3; ++i)
-    indices_tgt[i] = correspondences_[samples[i]];
+  {
+    boost::unordered_map<int, int>::const_iterator it = correspondences.find (samples[i]);
+    if (it == correspondences.end ())
+      return (false);
+    indices_tgt[i] = it->second;
+  }
 
   estimateRigidTransformationSVD (*input_, samples, *target_, indices_tgt, model_coefficients);
   return (true);
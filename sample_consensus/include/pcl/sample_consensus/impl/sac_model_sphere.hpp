@@ -40,6 +40,7 @@
 
 #include <pcl/sample_consensus/eigen.h>
 #include <pcl/sample_consensus/sac_model_sphere.h>
+#include <pcl/sample_consensus/sac_simd.h>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -126,22 +127,10 @@ pcl::SampleConsensusModelSphere<PointT>::getDistancesToModel (
     distances.clear ();
     return;
   }
-  distances.resize (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (size_t i = 0; i < indices_->size (); ++i)
-    // Calculate the distance from the point to the sphere as the difference between
-    //dist(point,sphere_origin) and sphere_radius
-    distances[i] = fabs (sqrtf (
-                               ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) *
-                               ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) +
-
-                               ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) *
-                               ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) +
-
-                               ( input_->points[(*indices_)[i]].z - model_coefficients[2] ) *
-                               ( input_->points[(*indices_)[i]].z - model_coefficients[2] )
-                               ) - model_coefficients[3]);
+  // Compute the distances from the points to the sphere, several points at a time
+  sac_simd::SphereDistance<PointT> distance_kernel (*input_, model_coefficients);
+  sac_simd::getDistances (distance_kernel, *indices_, distances);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -156,31 +145,9 @@ pcl::SampleConsensusModelSphere<PointT>::selectWithinDistance (
     return;
   }
 
-  int nr_p = 0;
-  inliers.resize (indices_->size ());
-
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the sphere as the difference between
-    // dist(point,sphere_origin) and sphere_radius
-    if (fabs (sqrtf (
-                    ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) *
-                    ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) +
-
-                    ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) *
-                    ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) +
-
-                    ( input_->points[(*indices_)[i]].z - model_coefficients[2] ) *
-                    ( input_->points[(*indices_)[i]].z - model_coefficients[2] )
-                    ) - model_coefficients[3]) < threshold)
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers[nr_p] = (*indices_)[i];
-      nr_p++;
-    }
-  }
-  inliers.resize (nr_p);
+  // Select the points whose distances to the sphere are smaller than the threshold, several points at a time
+  sac_simd::SphereDistance<PointT> distance_kernel (*input_, model_coefficients);
+  sac_simd::selectWithinDistance (distance_kernel, *indices_, threshold, inliers);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -192,26 +159,9 @@ pcl::SampleConsensusModelSphere<PointT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
-  int nr_p = 0;
-
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the sphere as the difference between
-    // dist(point,sphere_origin) and sphere_radius
-    if (fabs (sqrtf (
-                    ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) *
-                    ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) +
-
-                    ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) *
-                    ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) +
-
-                    ( input_->points[(*indices_)[i]].z - model_coefficients[2] ) *
-                    ( input_->points[(*indices_)[i]].z - model_coefficients[2] )
-                    ) - model_coefficients[3]) < threshold)
-      nr_p++;
-  }
-  return (nr_p);
+  // Count the points whose distances to the sphere are smaller than the threshold, several points at a time
+  sac_simd::SphereDistance<PointT> distance_kernel (*input_, model_coefficients);
+  return (sac_simd::countWithinDistance (distance_kernel, *indices_, threshold));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -62,8 +62,11 @@ namespace pcl
     using SampleConsensus<PointT>::model_coefficients_;
     using SampleConsensus<PointT>::inliers_;
     using SampleConsensus<PointT>::probability_;
+    using SampleConsensus<PointT>::drawHypotheses;
+    using SampleConsensus<PointT>::getHypothesisBatchSize;
 
     typedef typename SampleConsensusModel<PointT>::Ptr SampleConsensusModelPtr;
+    typedef typename SampleConsensus<PointT>::Hypothesis Hypothesis;
     typedef typename SampleConsensusModel<PointT>::PointCloudConstPtr PointCloudConstPtr; 
 
     public:
@@ -73,7 +76,8 @@ namespace pcl
       MaximumLikelihoodSampleConsensus (const SampleConsensusModelPtr &model) : 
         SampleConsensus<PointT> (model),
         iterations_EM_ (3),      // Max number of EM (Expectation Maximization) iterations
-        sigma_ (0)
+        sigma_ (0),
+        bbox_diagonal_ (0)
       {
         max_iterations_ = 10000; // Maximum number of trials before we give up.
       }
@@ -85,7 +89,8 @@ namespace pcl
       MaximumLikelihoodSampleConsensus (const SampleConsensusModelPtr &model, double threshold) : 
         SampleConsensus<PointT> (model, threshold),
         iterations_EM_ (3),      // Max number of EM (Expectation Maximization) iterations
-        sigma_ (0)
+        sigma_ (0),
+        bbox_diagonal_ (0)
       {
         max_iterations_ = 10000; // Maximum number of trials before we give up.
       }
@@ -108,6 +113,12 @@ namespace pcl
 
 
     protected:
+      /** \brief Score a model hypothesis by its negative log likelihood, estimated with Expectation-Maximization.
+        * \param[in,out] hypothesis the hypothesis to score
+        */
+      virtual bool
+      scoreHypothesis (Hypothesis &hypothesis);
+
       /** \brief Compute the median absolute deviation:
         * \f[
         * MAD = \sigma * median_i (| Xi - median_j(Xj) |)
@@ -149,6 +160,8 @@ namespace pcl
       int iterations_EM_;
       /** \brief The MLESAC sigma parameter. */
       double sigma_;
+      /** \brief The length of the bounding box diagonal of the input points, used by the outlier likelihood. */
+      double bbox_diagonal_;
   };
 }
 
@@ -62,8 +62,13 @@ namespace pcl
     using SampleConsensus<PointT>::model_coefficients_;
     using SampleConsensus<PointT>::inliers_;
     using SampleConsensus<PointT>::probability_;
+    using SampleConsensus<PointT>::preemptive_;
+    using SampleConsensus<PointT>::drawHypotheses;
+    using SampleConsensus<PointT>::selectHypothesisPreemptive;
+    using SampleConsensus<PointT>::getHypothesisBatchSize;
 
     typedef typename SampleConsensusModel<PointT>::Ptr SampleConsensusModelPtr;
+    typedef typename SampleConsensus<PointT>::Hypothesis Hypothesis;
 
     public:
       /** \brief MSAC (M-estimator SAmple Consensus) main constructor
@@ -89,6 +94,13 @@ namespace pcl
         * \param debug_verbosity_level enable/disable on-screen debug information and set the verbosity level
         */
       bool computeModel (int debug_verbosity_level = 0);
+
+    protected:
+      /** \brief Score a model hypothesis by the sum of the point to model distances, truncated at threshold_.
+        * \param[in,out] hypothesis the hypothesis to score
+        */
+      virtual bool
+      scoreHypothesis (Hypothesis &hypothesis);
   };
 }
 
@@ -61,8 +61,11 @@ namespace pcl
     using SampleConsensus<PointT>::model_coefficients_;
     using SampleConsensus<PointT>::inliers_;
     using SampleConsensus<PointT>::probability_;
+    using SampleConsensus<PointT>::evaluateHypotheses;
+    using SampleConsensus<PointT>::getHypothesisBatchSize;
 
     typedef typename SampleConsensusModel<PointT>::Ptr SampleConsensusModelPtr;
+    typedef typename SampleConsensus<PointT>::Hypothesis Hypothesis;
 
     public:
       /** \brief PROSAC (Progressive SAmple Consensus) main constructor
@@ -91,6 +94,13 @@ namespace pcl
         */
       bool 
       computeModel (int debug_verbosity_level = 0);
+
+    protected:
+      /** \brief Score a model hypothesis by its number of inliers, and keep the inliers in the hypothesis.
+        * \param[in,out] hypothesis the hypothesis to score
+        */
+      virtual bool
+      scoreHypothesis (Hypothesis &hypothesis);
   };
 }
 
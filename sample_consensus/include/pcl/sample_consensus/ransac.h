@@ -61,8 +61,13 @@ namespace pcl
     using SampleConsensus<PointT>::model_coefficients_;
     using SampleConsensus<PointT>::inliers_;
     using SampleConsensus<PointT>::probability_;
+    using SampleConsensus<PointT>::preemptive_;
+    using SampleConsensus<PointT>::drawHypotheses;
+    using SampleConsensus<PointT>::selectHypothesisPreemptive;
+    using SampleConsensus<PointT>::getHypothesisBatchSize;
 
     typedef typename SampleConsensusModel<PointT>::Ptr SampleConsensusModelPtr;
+    typedef typename SampleConsensus<PointT>::Hypothesis Hypothesis;
 
     public:
       /** \brief RANSAC (RAndom SAmple Consensus) main constructor
@@ -77,6 +77,9 @@ namespace pcl
         iterations_ (0), 
         threshold_ (std::numeric_limits<double>::max()),
         max_iterations_ (1000), 
+        threads_ (1),
+        preemptive_ (false),
+        preemptive_block_size_ (100),
         rng_alg_ (), 
         rng_ (new boost::uniform_01<boost::mt19937> (rng_alg_))
       {
@@ -101,6 +104,9 @@ namespace pcl
         iterations_ (0), 
         threshold_ (threshold), 
         max_iterations_ (1000), 
+        threads_ (1),
+        preemptive_ (false),
+        preemptive_block_size_ (100),
         rng_alg_ (), 
         rng_ (new boost::uniform_01<boost::mt19937> (rng_alg_))
       {
@@ -145,6 +151,43 @@ namespace pcl
       inline double 
       getProbability () { return (probability_); }
 
+      /** \brief Set the number of threads used to compute and score the model hypotheses.
+        * Samples are always drawn sequentially and the hypotheses are processed in the order they were drawn, so
+        * the result does not depend on the number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic, 1 by default)
+        */
+      inline void 
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads, as set by the user. */
+      inline unsigned int 
+      getNumberOfThreads () const { return (threads_); }
+
+      /** \brief Enable or disable preemptive scoring (D. Nister, "Preemptive RANSAC for live structure and motion
+        * estimation", ICCV 2003). Instead of iterating until the required number of trials is reached, a fixed
+        * number of hypotheses (the maximum number of iterations) is drawn up front. They are scored on
+        * consecutive blocks of randomly ordered points, and the worse half is dropped after each block, until a
+        * single hypothesis is left.
+        * \note only used by methods whose score is a sum over the points (RANSAC and MSAC)
+        * \param[in] preemptive true to enable preemptive scoring (default: false)
+        */
+      inline void 
+      setPreemptiveScoring (bool preemptive) { preemptive_ = preemptive; }
+
+      /** \brief Get whether preemptive scoring is enabled. */
+      inline bool 
+      getPreemptiveScoring () const { return (preemptive_); }
+
+      /** \brief Set the number of points each surviving hypothesis is scored on between two preemption steps.
+        * \param[in] block_size the number of points per block (default: 100)
+        */
+      inline void 
+      setPreemptiveBlockSize (int block_size) { preemptive_block_size_ = block_size; }
+
+      /** \brief Get the number of points per preemption block. */
+      inline int 
+      getPreemptiveBlockSize () const { return (preemptive_block_size_); }
+
       /** \brief Compute the actual model. Pure virtual. */
       virtual bool 
       computeModel (int debug_verbosity_level = 0) = 0;
@@ -184,6 +227,79 @@ namespace pcl
       getModelCoefficients (Eigen::VectorXf &model_coefficients) { model_coefficients = model_coefficients_; }
 
     protected:
+      /** \brief A model hypothesis, as generated and scored by \ref drawHypotheses. */
+      struct Hypothesis
+      {
+        /** \brief The state of a hypothesis after it has been evaluated. */
+        enum Status
+        {
+          NO_SAMPLE,      /**< no sample could be drawn */
+          INVALID_MODEL,  /**< the sample does not produce a valid model */
+          NOT_SCORED,     /**< the model could not be scored */
+          SCORED          /**< the model is valid and has been scored */
+        };
+
+        Hypothesis () : sample (), coefficients (), status (NO_SAMPLE), penalty (0), nr_inliers (0), inliers () {}
+
+        /** \brief The point indices the model was computed from. */
+        std::vector<int> sample;
+        /** \brief The model coefficients. */
+        Eigen::VectorXf coefficients;
+        /** \brief The state of the hypothesis. */
+        Status status;
+        /** \brief The score of the model; lower is better. */
+        double penalty;
+        /** \brief The number of inliers supporting the model. */
+        int nr_inliers;
+        /** \brief The inliers supporting the model, only filled by methods that need them. */
+        std::vector<int> inliers;
+      };
+
+      /** \brief Draw a batch of samples from the model, in order, then compute and score their model
+        * coefficients in parallel.
+        * \param[in] nr_hypotheses the number of hypotheses to generate
+        * \param[out] hypotheses the resultant hypotheses, in the order their samples were drawn
+        */
+      void
+      drawHypotheses (size_t nr_hypotheses, std::vector<Hypothesis> &hypotheses);
+
+      /** \brief Compute and score the model coefficients of hypotheses whose samples are already set, in parallel.
+        * \param[in,out] hypotheses the hypotheses to evaluate
+        * \param[in] score false to only compute the model coefficients
+        */
+      void
+      evaluateHypotheses (std::vector<Hypothesis> &hypotheses, bool score = true);
+
+      /** \brief Score a model hypothesis against the current model indices. Called concurrently from several
+        * threads. The default implementation counts the points within threshold_ (RANSAC); the penalty is the
+        * negated count.
+        * \param[in,out] hypothesis the hypothesis to score
+        * \return true if the hypothesis could be scored
+        */
+      virtual bool
+      scoreHypothesis (Hypothesis &hypothesis);
+
+      /** \brief Select the best hypothesis using preemptive scoring (see \ref setPreemptiveScoring).
+        * Sets iterations_ to the number of hypotheses drawn.
+        * \param[out] best the best hypothesis; its penalty and number of inliers are accumulated over the points
+        * it has been scored on
+        * \return true if a valid hypothesis was found
+        */
+      bool
+      selectHypothesisPreemptive (Hypothesis &best);
+
+      /** \brief Get the number of hypotheses to draw in the next batch, given the current required number of
+        * iterations. Returns 1 when running on a single thread, which makes the batch engine equivalent to the
+        * sequential loop.
+        * \param[in] k the required number of iterations
+        */
+      size_t
+      getHypothesisBatchSize (double k) const;
+
+      /** \brief Get the number of threads to use for the hypothesis engine. */
+      int
+      getNumberOfHypothesisThreads () const;
+
       /** \brief The underlying data model used (i.e. what is it that we attempt to search for). */
       SampleConsensusModelPtr sac_model_;
 
@@ -208,6 +324,15 @@ namespace pcl
       /** \brief Maximum number of iterations before giving up. */
       int max_iterations_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Whether hypotheses are selected by preemptive scoring. */
+      bool preemptive_;
+
+      /** \brief The number of points per preemption block. */
+      int preemptive_block_size_;
+
       /** \brief Boost-based random number generator algorithm. */
       boost::mt19937 rng_alg_;
 
@@ -223,4 +348,6 @@ namespace pcl
    };
 }
 
+#include <pcl/sample_consensus/impl/sac.hpp>
+
 #endif  //#ifndef PCL_SAMPLE_CONSENSUS_H_
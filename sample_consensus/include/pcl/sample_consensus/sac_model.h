@@ -55,6 +55,7 @@
 namespace pcl
 {
   template<class T> class ProgressiveSampleConsensus;
+  template<class T> class SampleConsensus;
 
   /** \brief @b SampleConsensusModel represents the base model class. All sample consensus models must inherit 
     * from this class.
@@ -80,6 +81,7 @@ namespace pcl
       SampleConsensusModel (bool random = false) : 
         input_ (),
         indices_ (),
+        full_indices_ (),
         radius_min_ (-std::numeric_limits<double>::max ()), radius_max_ (std::numeric_limits<double>::max ()), 
         samples_radius_ (0.),
         samples_radius_search_ (),
@@ -105,6 +107,7 @@ namespace pcl
       SampleConsensusModel (const PointCloudConstPtr &cloud, bool random = false) : 
         input_ (),
         indices_ (),
+        full_indices_ (),
         radius_min_ (-std::numeric_limits<double>::max ()), radius_max_ (std::numeric_limits<double>::max ()), 
         samples_radius_ (0.),
         samples_radius_search_ (),
@@ -133,6 +136,7 @@ namespace pcl
       SampleConsensusModel (const PointCloudConstPtr &cloud, const std::vector<int> &indices, bool random = false) :
                             input_ (cloud),
                             indices_ (new std::vector<int> (indices)),
+                            full_indices_ (),
                             radius_min_ (-std::numeric_limits<double>::max()), radius_max_ (std::numeric_limits<double>::max()), 
                             samples_radius_ (0.),
                             samples_radius_search_ (),
@@ -332,6 +336,32 @@ namespace pcl
       inline boost::shared_ptr <std::vector<int> > 
       getIndices () const { return (indices_); }
 
+      /** \brief Restrict the model to a subset of its points, e.g. to score hypotheses on a block of the data.
+        * The subset is given by positions in the indices of the model, so that models which keep other data paired
+        * with their indices (see SampleConsensusModelRegistration) can restrict it the same way. The vector of
+        * indices given by the user is left untouched, and is used again after \ref resetIndicesSubset.
+        * \param[in] positions the positions in the indices of the model of the points to use
+        */
+      virtual void
+      setIndicesSubset (const std::vector<int> &positions)
+      {
+        if (!full_indices_)
+          full_indices_ = indices_;
+        indices_.reset (new std::vector<int> (positions.size ()));
+        for (size_t i = 0; i < positions.size (); ++i)
+          (*indices_)[i] = (*full_indices_)[positions[i]];
+      }
+
+      /** \brief Use all the indices of the model again, after \ref setIndicesSubset. */
+      virtual void
+      resetIndicesSubset ()
+      {
+        if (!full_indices_)
+          return;
+        indices_ = full_indices_;
+        full_indices_.reset ();
+      }
+
       /** \brief Return an unique id for each type of model employed. */
       virtual SacModel 
       getModelType () const = 0;
@@ -393,6 +423,7 @@ namespace pcl
       }
 
       friend class ProgressiveSampleConsensus<PointT>;
+      friend class SampleConsensus<PointT>;
 
 		protected:
       /** \brief Fills a sample array with random samples from the indices_ vector
@@ -466,6 +497,9 @@ namespace pcl
       /** \brief A pointer to the vector of point indices to use. */
       boost::shared_ptr <std::vector<int> > indices_;
 
+      /** \brief The complete vector of point indices, while the model is restricted to a subset of it. */
+      boost::shared_ptr <std::vector<int> > full_indices_;
+
       /** The maximum number of samples to try until we get a good one */
       static const unsigned int max_sample_checks_ = 1000;
 
@@ -73,6 +73,7 @@ namespace pcl
         SampleConsensusModel<PointT> (cloud),
         target_ (),
         indices_tgt_ (),
+        full_indices_tgt_ (),
         correspondences_ (),
         sample_dist_thresh_ (0)
       {
@@ -89,6 +90,7 @@ namespace pcl
         SampleConsensusModel<PointT> (cloud, indices),
         target_ (),
         indices_tgt_ (),
+        full_indices_tgt_ (),
         correspondences_ (),
         sample_dist_thresh_ (0)
       {
@@ -136,6 +138,33 @@ namespace pcl
         computeOriginalIndexMapping ();
       }
 
+      /** \brief Restrict the model to a subset of its correspondences. The source and the target indices are
+        * restricted to the same positions, so that they stay paired.
+        * \param[in] positions the positions in the indices of the model of the correspondences to use
+        */
+      virtual void
+      setIndicesSubset (const std::vector<int> &positions)
+      {
+        if (!full_indices_tgt_)
+          full_indices_tgt_ = indices_tgt_;
+        indices_tgt_.reset (new std::vector<int> (positions.size ()));
+        for (size_t i = 0; i < positions.size (); ++i)
+          (*indices_tgt_)[i] = (*full_indices_tgt_)[positions[i]];
+        SampleConsensusModel<PointT>::setIndicesSubset (positions);
+      }
+
+      /** \brief Use all the correspondences again, after \ref setIndicesSubset. */
+      virtual void
+      resetIndicesSubset ()
+      {
+        if (full_indices_tgt_)
+        {
+          indices_tgt_ = full_indices_tgt_;
+          full_indices_tgt_.reset ();
+        }
+        SampleConsensusModel<PointT>::resetIndicesSubset ();
+      }
+
       /** \brief Compute a 4x4 rigid transformation matrix from the samples given
         * \param[in] samples the indices found as good candidates for creating a valid model
         * \param[out] model_coefficients the resultant model coefficients
@@ -314,6 +343,9 @@ namespace pcl
       /** \brief A pointer to the vector of target point indices to use. */
       boost::shared_ptr <std::vector<int> > indices_tgt_;
 
+      /** \brief The complete vector of target point indices, while the model is restricted to a subset of it. */
+      boost::shared_ptr <std::vector<int> > full_indices_tgt_;
+
       /** \brief Given the index in the original point cloud, give the matching original index in the target cloud */
       boost::unordered_map<int, int> correspondences_;
 
@@ -0,0 +1,430 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SAMPLE_CONSENSUS_SAC_SIMD_H_
+#define PCL_SAMPLE_CONSENSUS_SAC_SIMD_H_
+
+#include <pcl/point_cloud.h>
+#include <Eigen/Core>
+#include <cmath>
+#include <vector>
+
+// Pick the widest instruction set the compiler was asked to target
+#if defined (__AVX__)
+#  include <immintrin.h>
+#  define PCL_SAC_SIMD_AVX
+#  define PCL_SAC_SIMD_WIDTH 8
+#elif defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define PCL_SAC_SIMD_SSE
+#  define PCL_SAC_SIMD_WIDTH 4
+#else
+#  define PCL_SAC_SIMD_WIDTH 1
+#endif
+
+namespace pcl
+{
+  /** \brief Vectorized point to model distance kernels for the sample consensus models.
+    *
+    * The points referenced by a packet of PCL_SAC_SIMD_WIDTH indices are gathered into structure of arrays
+    * registers, and the distances of the whole packet are computed at once with AVX, SSE2 or scalar code,
+    * depending on the instruction set selected at compile time. A kernel is a functor computing the distances
+    * of one packet; \ref countWithinDistance, \ref selectWithinDistance and \ref getDistances apply it to a
+    * vector of indices.
+    *
+    * \author Open Perception
+    * \ingroup sample_consensus
+    */
+  namespace sac_simd
+  {
+    /** \brief The number of points processed at once. */
+    const int PACKET_SIZE = PCL_SAC_SIMD_WIDTH;
+
+#if defined (PCL_SAC_SIMD_AVX)
+    typedef __m256 Packet;
+    inline Packet load (const float *p)        { return (_mm256_loadu_ps (p)); }
+    inline void   store (float *p, Packet a)   { _mm256_storeu_ps (p, a); }
+    inline Packet set1 (float a)               { return (_mm256_set1_ps (a)); }
+    inline Packet add (Packet a, Packet b)     { return (_mm256_add_ps (a, b)); }
+    inline Packet sub (Packet a, Packet b)     { return (_mm256_sub_ps (a, b)); }
+    inline Packet mul (Packet a, Packet b)     { return (_mm256_mul_ps (a, b)); }
+    inline Packet sqrt (Packet a)              { return (_mm256_sqrt_ps (a)); }
+    inline Packet abs (Packet a)               { return (_mm256_andnot_ps (_mm256_set1_ps (-0.0f), a)); }
+#elif defined (PCL_SAC_SIMD_SSE)
+    typedef __m128 Packet;
+    inline Packet load (const float *p)        { return (_mm_loadu_ps (p)); }
+    inline void   store (float *p, Packet a)   { _mm_storeu_ps (p, a); }
+    inline Packet set1 (float a)               { return (_mm_set1_ps (a)); }
+    inline Packet add (Packet a, Packet b)     { return (_mm_add_ps (a, b)); }
+    inline Packet sub (Packet a, Packet b)     { return (_mm_sub_ps (a, b)); }
+    inline Packet mul (Packet a, Packet b)     { return (_mm_mul_ps (a, b)); }
+    inline Packet sqrt (Packet a)              { return (_mm_sqrt_ps (a)); }
+    inline Packet abs (Packet a)               { return (_mm_andnot_ps (_mm_set1_ps (-0.0f), a)); }
+#else
+    typedef float Packet;
+    inline Packet load (const float *p)        { return (*p); }
+    inline void   store (float *p, Packet a)   { *p = a; }
+    inline Packet set1 (float a)               { return (a); }
+    inline Packet add (Packet a, Packet b)     { return (a + b); }
+    inline Packet sub (Packet a, Packet b)     { return (a - b); }
+    inline Packet mul (Packet a, Packet b)     { return (a * b); }
+    inline Packet sqrt (Packet a)              { return (sqrtf (a)); }
+    inline Packet abs (Packet a)               { return (fabsf (a)); }
+#endif
+
+    /** \brief Compute the dot product of two packets of 3D vectors. */
+    inline Packet
+    dot3 (Packet ax, Packet ay, Packet az, Packet bx, Packet by, Packet bz)
+    {
+      return (add (add (mul (ax, bx), mul (ay, by)), mul (az, bz)));
+    }
+
+    /** \brief Gather the xyz coordinates of a packet of points into structure of arrays registers.
+      * \param[in] cloud the input point cloud
+      * \param[in] indices PACKET_SIZE indices into the cloud
+      * \param[out] x the x coordinates
+      * \param[out] y the y coordinates
+      * \param[out] z the z coordinates
+      */
+    template <typename PointT> inline void
+    gatherXYZ (const pcl::PointCloud<PointT> &cloud, const int *indices, Packet &x, Packet &y, Packet &z)
+    {
+      float bx[PACKET_SIZE], by[PACKET_SIZE], bz[PACKET_SIZE];
+      for (int i = 0; i < PACKET_SIZE; ++i)
+      {
+        const PointT &p = cloud.points[indices[i]];
+        bx[i] = p.x; by[i] = p.y; bz[i] = p.z;
+      }
+      x = load (bx); y = load (by); z = load (bz);
+    }
+
+    /** \brief Gather the normals of a packet of points into structure of arrays registers.
+      * \param[in] normals the input normals
+      * \param[in] indices PACKET_SIZE indices into the cloud
+      * \param[out] x the x components
+      * \param[out] y the y components
+      * \param[out] z the z components
+      */
+    template <typename PointNT> inline void
+    gatherNormals (const pcl::PointCloud<PointNT> &normals, const int *indices, Packet &x, Packet &y, Packet &z)
+    {
+      float bx[PACKET_SIZE], by[PACKET_SIZE], bz[PACKET_SIZE];
+      for (int i = 0; i < PACKET_SIZE; ++i)
+      {
+        const PointNT &n = normals.points[indices[i]];
+        bx[i] = n.normal[0]; by[i] = n.normal[1]; bz[i] = n.normal[2];
+      }
+      x = load (bx); y = load (by); z = load (bz);
+    }
+
+    /** \brief Distance to a plane: |a*x + b*y + c*z + d|. */
+    template <typename PointT>
+    class PlaneDistance
+    {
+      public:
+        /** \param[in] cloud the input point cloud
+          * \param[in] model_coefficients the plane coefficients (a, b, c, d)
+          */
+        PlaneDistance (const pcl::PointCloud<PointT> &cloud, const Eigen::VectorXf &model_coefficients) :
+          cloud_ (&cloud), 
+          a_ (set1 (model_coefficients[0])), b_ (set1 (model_coefficients[1])), 
+          c_ (set1 (model_coefficients[2])), d_ (set1 (model_coefficients[3])) {}
+
+        inline void
+        operator () (const int *indices, float *distances) const
+        {
+          Packet x, y, z;
+          gatherXYZ (*cloud_, indices, x, y, z);
+          store (distances, abs (add (dot3 (a_, b_, c_, x, y, z), d_)));
+        }
+
+      private:
+        const pcl::PointCloud<PointT> *cloud_;
+        Packet a_, b_, c_, d_;
+    };
+
+    /** \brief Distance to a sphere: |dist (point, center) - radius|. */
+    template <typename PointT>
+    class SphereDistance
+    {
+      public:
+        /** \param[in] cloud the input point cloud
+          * \param[in] model_coefficients the sphere coefficients (center x, y, z, radius)
+          */
+        SphereDistance (const pcl::PointCloud<PointT> &cloud, const Eigen::VectorXf &model_coefficients) :
+          cloud_ (&cloud), 
+          cx_ (set1 (model_coefficients[0])), cy_ (set1 (model_coefficients[1])), 
+          cz_ (set1 (model_coefficients[2])), r_ (set1 (model_coefficients[3])) {}
+
+        inline void
+        operator () (const int *indices, float *distances) const
+        {
+          Packet x, y, z;
+          gatherXYZ (*cloud_, indices, x, y, z);
+          x = sub (x, cx_); y = sub (y, cy_); z = sub (z, cz_);
+          store (distances, abs (sub (sqrt (dot3 (x, y, z, x, y, z)), r_)));
+        }
+
+      private:
+        const pcl::PointCloud<PointT> *cloud_;
+        Packet cx_, cy_, cz_, r_;
+    };
+
+    /** \brief Distance to a 2D circle in the XY plane: |dist (point, center) - radius|. */
+    template <typename PointT>
+    class Circle2DDistance
+    {
+      public:
+        /** \param[in] cloud the input point cloud
+          * \param[in] model_coefficients the circle coefficients (center x, y, radius)
+          */
+        Circle2DDistance (const pcl::PointCloud<PointT> &cloud, const Eigen::VectorXf &model_coefficients) :
+          cloud_ (&cloud), 
+          cx_ (set1 (model_coefficients[0])), cy_ (set1 (model_coefficients[1])), r_ (set1 (model_coefficients[2])) {}
+
+        inline void
+        operator () (const int *indices, float *distances) const
+        {
+          Packet x, y, z;
+          gatherXYZ (*cloud_, indices, x, y, z);
+          x = sub (x, cx_); y = sub (y, cy_);
+          store (distances, abs (sub (sqrt (add (mul (x, x), mul (y, y))), r_)));
+        }
+
+      private:
+        const pcl::PointCloud<PointT> *cloud_;
+        Packet cx_, cy_, r_;
+    };
+
+    /** \brief Distance to a 3D line: ||(line_pt - point) x line_dir|| / ||line_dir||. */
+    template <typename PointT>
+    class LineDistance
+    {
+      public:
+        /** \param[in] cloud the input point cloud
+          * \param[in] model_coefficients the line coefficients (point on line, direction)
+          */
+        LineDistance (const pcl::PointCloud<PointT> &cloud, const Eigen::VectorXf &model_coefficients) :
+          cloud_ (&cloud), 
+          px_ (set1 (model_coefficients[0])), py_ (set1 (model_coefficients[1])), pz_ (set1 (model_coefficients[2])),
+          dx_ (), dy_ (), dz_ ()
+        {
+          Eigen::Vector3f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5]);
+          line_dir.normalize ();
+          dx_ = set1 (line_dir[0]); dy_ = set1 (line_dir[1]); dz_ = set1 (line_dir[2]);
+        }
+
+        inline void
+        operator () (const int *indices, float *distances) const
+        {
+          Packet x, y, z;
+          gatherXYZ (*cloud_, indices, x, y, z);
+          x = sub (px_, x); y = sub (py_, y); z = sub (pz_, z);
+          Packet cx = sub (mul (y, dz_), mul (z, dy_));
+          Packet cy = sub (mul (z, dx_), mul (x, dz_));
+          Packet cz = sub (mul (x, dy_), mul (y, dx_));
+          store (distances, sqrt (dot3 (cx, cy, cz, cx, cy, cz)));
+        }
+
+      private:
+        const pcl::PointCloud<PointT> *cloud_;
+        Packet px_, py_, pz_, dx_, dy_, dz_;
+    };
+
+    /** \brief Distance to a cylinder, as a weighted sum of the Euclidean distance to the cylinder surface and the
+      * angle between the point normal and the surface normal. Everything but the arc cosine is vectorized.
+      */
+    template <typename PointT, typename PointNT>
+    class CylinderDistance
+    {
+      public:
+        /** \param[in] cloud the input point cloud
+          * \param[in] normals the normals of the input point cloud
+          * \param[in] model_coefficients the cylinder coefficients (point on axis, axis direction, radius)
+          * \param[in] normal_distance_weight the weight of the angular distance
+          */
+        CylinderDistance (const pcl::PointCloud<PointT> &cloud, const pcl::PointCloud<PointNT> &normals,
+                          const Eigen::VectorXf &model_coefficients, double normal_distance_weight) :
+          cloud_ (&cloud), normals_ (&normals),
+          px_ (set1 (model_coefficients[0])), py_ (set1 (model_coefficients[1])), pz_ (set1 (model_coefficients[2])),
+          dx_ (set1 (model_coefficients[3])), dy_ (set1 (model_coefficients[4])), dz_ (set1 (model_coefficients[5])),
+          inv_sqr_length_ (set1 (1.0f / model_coefficients.segment<3> (3).squaredNorm ())),
+          r_ (set1 (model_coefficients[6])),
+          weight_ (normal_distance_weight) {}
+
+        inline void
+        operator () (const int *indices, float *distances) const
+        {
+          Packet x, y, z, nx, ny, nz;
+          gatherXYZ (*cloud_, indices, x, y, z);
+          gatherNormals (*normals_, indices, nx, ny, nz);
+
+          // Distance to the axis
+          x = sub (x, px_); y = sub (y, py_); z = sub (z, pz_);
+          Packet cx = sub (mul (dy_, z), mul (dz_, y));
+          Packet cy = sub (mul (dz_, x), mul (dx_, z));
+          Packet cz = sub (mul (dx_, y), mul (dy_, x));
+          float d_euclid[PACKET_SIZE];
+          store (d_euclid, abs (sub (sqrt (mul (dot3 (cx, cy, cz, cx, cy, cz), inv_sqr_length_)), r_)));
+
+          // Direction from the projection of the point on the axis to the point
+          Packet k = mul (dot3 (x, y, z, dx_, dy_, dz_), inv_sqr_length_);
+          x = sub (x, mul (k, dx_)); y = sub (y, mul (k, dy_)); z = sub (z, mul (k, dz_));
+          float dots[PACKET_SIZE], norms[PACKET_SIZE];
+          store (dots, dot3 (nx, ny, nz, x, y, z));
+          store (norms, sqrt (mul (dot3 (nx, ny, nz, nx, ny, nz), dot3 (x, y, z, x, y, z))));
+
+          for (int i = 0; i < PACKET_SIZE; ++i)
+          {
+            double rad = static_cast<double> (dots[i]) / norms[i];
+            if (rad < -1.0) rad = -1.0;
+            if (rad >  1.0) rad = 1.0;
+            double d_normal = fabs (acos (rad));
+            d_normal = (std::min) (d_normal, M_PI - d_normal);
+            distances[i] = static_cast<float> (fabs (weight_ * d_normal + (1 - weight_) * d_euclid[i]));
+          }
+        }
+
+      private:
+        const pcl::PointCloud<PointT> *cloud_;
+        const pcl::PointCloud<PointNT> *normals_;
+        Packet px_, py_, pz_, dx_, dy_, dz_, inv_sqr_length_, r_;
+        double weight_;
+    };
+
+    /** \brief Apply a kernel to all the given indices, PACKET_SIZE points at a time, and pass each distance to
+      * \a sink together with its position in \a indices.
+      */
+    template <typename Kernel, typename Sink> inline void
+    forEachDistance (const Kernel &kernel, const std::vector<int> &indices, Sink &sink)
+    {
+      const size_t nr_indices = indices.size ();
+      float distances[PACKET_SIZE];
+      size_t i = 0;
+      for (; i + PACKET_SIZE <= nr_indices; i += PACKET_SIZE)
+      {
+        kernel (&indices[i], distances);
+        for (int j = 0; j < PACKET_SIZE; ++j)
+          sink (i + j, distances[j]);
+      }
+
+      // Pad the last packet with copies of the last index
+      if (i < nr_indices)
+      {
+        int tail[PACKET_SIZE];
+        for (int j = 0; j < PACKET_SIZE; ++j)
+          tail[j] = indices[(std::min) (i + j, nr_indices - 1)];
+        kernel (tail, distances);
+        for (size_t j = 0; i + j < nr_indices; ++j)
+          sink (i + j, distances[j]);
+      }
+    }
+
+    /** \brief Count the distances below a threshold. */
+    struct CountSink
+    {
+      CountSink (double threshold) : threshold (threshold), count (0) {}
+      inline void operator () (size_t, float distance) { if (distance < threshold) ++count; }
+      double threshold;
+      int count;
+    };
+
+    /** \brief Collect the indices whose distance is below a threshold. */
+    struct SelectSink
+    {
+      SelectSink (const std::vector<int> &indices, double threshold, std::vector<int> &inliers) : 
+        indices (indices), threshold (threshold), inliers (inliers), count (0) {}
+      inline void operator () (size_t i, float distance) { if (distance < threshold) inliers[count++] = indices[i]; }
+      const std::vector<int> &indices;
+      double threshold;
+      std::vector<int> &inliers;
+      int count;
+    };
+
+    /** \brief Store all the distances. */
+    struct DistanceSink
+    {
+      DistanceSink (std::vector<double> &distances) : distances (distances) {}
+      inline void operator () (size_t i, float distance) { distances[i] = distance; }
+      std::vector<double> &distances;
+    };
+
+    /** \brief Count the number of points whose distance to the model is smaller than a threshold.
+      * \param[in] kernel the distance kernel of the model
+      * \param[in] indices the indices of the points to test
+      * \param[in] threshold the distance threshold
+      */
+    template <typename Kernel> inline int
+    countWithinDistance (const Kernel &kernel, const std::vector<int> &indices, double threshold)
+    {
+      CountSink sink (threshold);
+      forEachDistance (kernel, indices, sink);
+      return (sink.count);
+    }
+
+    /** \brief Select the points whose distance to the model is smaller than a threshold.
+      * \param[in] kernel the distance kernel of the model
+      * \param[in] indices the indices of the points to test
+      * \param[in] threshold the distance threshold
+      * \param[out] inliers the indices of the selected points
+      */
+    template <typename Kernel> inline void
+    selectWithinDistance (const Kernel &kernel, const std::vector<int> &indices, double threshold, 
+                          std::vector<int> &inliers)
+    {
+      inliers.resize (indices.size ());
+      SelectSink sink (indices, threshold, inliers);
+      forEachDistance (kernel, indices, sink);
+      inliers.resize (sink.count);
+    }
+
+    /** \brief Compute the distances from the points to the model.
+      * \param[in] kernel the distance kernel of the model
+      * \param[in] indices the indices of the points
+      * \param[out] distances the resultant distances
+      */
+    template <typename Kernel> inline void
+    getDistances (const Kernel &kernel, const std::vector<int> &indices, std::vector<double> &distances)
+    {
+      distances.resize (indices.size ());
+      DistanceSink sink (distances);
+      forEachDistance (kernel, indices, sink);
+    }
+  }
+}
+
+#endif  //#ifndef PCL_SAMPLE_CONSENSUS_SAC_SIMD_H_
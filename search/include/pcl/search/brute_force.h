@@ -85,6 +85,9 @@ namespace pcl
       // replace by some metric functor
       float getDistSqr (const PointT& point1, const PointT& point2) const;
       public:
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+
         BruteForce (bool sorted_results = false)
         : Search<PointT> ("BruteForce", sorted_results)
         {
@@ -150,6 +150,24 @@ namespace pcl
           return (tree_->nearestKSearch (point, k, k_indices, k_sqr_distances));
         }
 
+        /** \brief Search for the k-nearest neighbors for the given query point, writing directly into the storage
+          * of a reusable NeighborList (inline storage for k <= NeighborList::INLINE_CAPACITY).
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] neighbors the resultant neighbors
+          * \return number of neighbors found
+          */
+        inline int
+        nearestKSearch (const PointT &point, int k, NeighborList &neighbors) const
+        {
+          neighbors.resize (k > 0 ? k : 0);
+          if (k <= 0)
+            return (0);
+          int nr_found = tree_->nearestKSearch (point, k, neighbors.indices (), neighbors.sqrDistances ());
+          neighbors.resize (nr_found);
+          return (nr_found);
+        }
+
         /** \brief Search for all the nearest neighbors of the query point in a given radius.
           * \param[in] point the given query point
           * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
@@ -168,6 +186,41 @@ namespace pcl
           return (tree_->radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
         }
 
+        /** \brief Search for all the nearest neighbors of the query point in a given radius, writing directly into
+          * the storage of a reusable NeighborList. The search starts with the room the list already has, and is
+          * repeated with a larger buffer only when the result might have been truncated.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] neighbors the resultant neighbors
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \return number of neighbors found in radius
+          */
+        inline int
+        radiusSearch (const PointT &point, double radius, NeighborList &neighbors, unsigned int max_nn = 0) const
+        {
+          const size_t nr_points = input_->points.size ();
+          size_t capacity = (std::max) (static_cast<size_t> (NeighborList::INLINE_CAPACITY),
+                                        neighbors.getIndicesVector ().size ());
+          if (max_nn != 0 && max_nn < nr_points)
+            capacity = (std::min) (capacity, static_cast<size_t> (max_nn));
+          for (;;)
+          {
+            neighbors.resize (capacity);
+            int nr_found = tree_->radiusSearch (point, radius, neighbors.indices (), neighbors.sqrDistances (),
+                                                static_cast<int> (capacity), max_nn);
+            // The result is complete if it did not fill the buffer, or if the buffer could hold every candidate
+            if (static_cast<size_t> (nr_found) < capacity || capacity >= nr_points ||
+                (max_nn != 0 && capacity >= max_nn))
+            {
+              neighbors.resize (nr_found > 0 ? nr_found : 0);
+              return (nr_found);
+            }
+            capacity = (std::min) (2 * capacity, nr_points);
+          }
+        }
+
       protected:
         /** \brief A pointer to the internal KdTreeFLANN object. */
         KdTreeFLANNPtr tree_;
@@ -0,0 +1,209 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_NEIGHBOR_LIST_H_
+#define PCL_SEARCH_NEIGHBOR_LIST_H_
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief NeighborList is a reusable container for the result of a single neighbor query. Up to
+      * \ref INLINE_CAPACITY neighbors are stored in fixed-size arrays inside the object, so that k-nearest neighbor
+      * queries with small k do not touch the heap at all. Larger results spill into heap buffers that only ever grow,
+      * so a list that is reused across queries (e.g., one per thread) stops allocating once it has seen its largest
+      * result.
+      *
+      * \author Open Perception
+      * \ingroup search
+      */
+    class NeighborList
+    {
+      public:
+        /** \brief The number of neighbors that can be stored without heap allocation. */
+        static const size_t INLINE_CAPACITY = 32;
+
+        /** \brief Empty constructor. */
+        NeighborList () : size_ (0), on_heap_ (false), heap_indices_ (), heap_sqr_distances_ ()
+        {
+        }
+
+        /** \brief Get the number of neighbors stored. */
+        inline size_t
+        size () const { return (size_); }
+
+        /** \brief Check whether the list is empty. */
+        inline bool
+        empty () const { return (size_ == 0); }
+
+        /** \brief Check whether the neighbors are currently stored inline (i.e., not on the heap). */
+        inline bool
+        isInline () const { return (!on_heap_); }
+
+        /** \brief Remove all neighbors. The heap buffers, if any, are kept for reuse. */
+        inline void
+        clear () { size_ = 0; on_heap_ = false; }
+
+        /** \brief Change the number of neighbors stored. Existing neighbors are preserved up to the new size.
+          * \param[in] n the new number of neighbors
+          */
+        inline void
+        resize (size_t n)
+        {
+          if (n <= INLINE_CAPACITY)
+          {
+            if (on_heap_ && size_ > 0)
+            {
+              size_t nr_kept = (n < size_) ? n : size_;
+              memcpy (inline_indices_, &heap_indices_[0], nr_kept * sizeof (int));
+              memcpy (inline_sqr_distances_, &heap_sqr_distances_[0], nr_kept * sizeof (float));
+            }
+            on_heap_ = false;
+          }
+          else
+          {
+            if (heap_indices_.size () < n)
+            {
+              heap_indices_.resize (n);
+              heap_sqr_distances_.resize (n);
+            }
+            if (!on_heap_ && size_ > 0)
+            {
+              memcpy (&heap_indices_[0], inline_indices_, size_ * sizeof (int));
+              memcpy (&heap_sqr_distances_[0], inline_sqr_distances_, size_ * sizeof (float));
+            }
+            on_heap_ = true;
+          }
+          size_ = n;
+        }
+
+        /** \brief Append a neighbor to the list.
+          * \param[in] index the index of the neighboring point
+          * \param[in] sqr_distance the squared distance to the neighboring point
+          */
+        inline void
+        push_back (int index, float sqr_distance)
+        {
+          resize (size_ + 1);
+          indices ()[size_ - 1] = index;
+          sqrDistances ()[size_ - 1] = sqr_distance;
+        }
+
+        /** \brief Get a pointer to the indices of the neighboring points. */
+        inline int*
+        indices () { return (on_heap_ ? &heap_indices_[0] : inline_indices_); }
+
+        /** \brief Get a pointer to the indices of the neighboring points. */
+        inline const int*
+        indices () const { return (on_heap_ ? &heap_indices_[0] : inline_indices_); }
+
+        /** \brief Get a pointer to the squared distances to the neighboring points. */
+        inline float*
+        sqrDistances () { return (on_heap_ ? &heap_sqr_distances_[0] : inline_sqr_distances_); }
+
+        /** \brief Get a pointer to the squared distances to the neighboring points. */
+        inline const float*
+        sqrDistances () const { return (on_heap_ ? &heap_sqr_distances_[0] : inline_sqr_distances_); }
+
+        /** \brief Get the index of the i-th neighbor. */
+        inline int
+        index (size_t i) const { return (indices ()[i]); }
+
+        /** \brief Get the squared distance to the i-th neighbor. */
+        inline float
+        sqrDistance (size_t i) const { return (sqrDistances ()[i]); }
+
+        /** \brief Copy the neighbors into a pair of std::vector.
+          * \param[out] k_indices the indices of the neighboring points
+          * \param[out] k_sqr_distances the squared distances to the neighboring points
+          */
+        inline void
+        copyTo (std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+        {
+          k_indices.assign (indices (), indices () + size_);
+          k_sqr_distances.assign (sqrDistances (), sqrDistances () + size_);
+        }
+
+        /** \brief Get the heap buffer holding the indices, for search methods that produce std::vector results.
+          * Call \ref useVectors once both vectors have been filled.
+          */
+        inline std::vector<int>&
+        getIndicesVector () { return (heap_indices_); }
+
+        /** \brief Get the heap buffer holding the squared distances, for search methods that produce std::vector
+          * results. Call \ref useVectors once both vectors have been filled.
+          */
+        inline std::vector<float>&
+        getSqrDistancesVector () { return (heap_sqr_distances_); }
+
+        /** \brief Make the list hold the neighbors written into \ref getIndicesVector and
+          * \ref getSqrDistancesVector. The vectors must have the same size.
+          */
+        inline void
+        useVectors ()
+        {
+          size_ = heap_indices_.size ();
+          on_heap_ = (size_ > 0);
+        }
+
+      private:
+        /** \brief The number of neighbors stored. */
+        size_t size_;
+
+        /** \brief Whether the neighbors are stored in the heap buffers. */
+        bool on_heap_;
+
+        /** \brief Inline storage for the neighbor indices. */
+        int inline_indices_[INLINE_CAPACITY];
+
+        /** \brief Inline storage for the squared distances. */
+        float inline_sqr_distances_[INLINE_CAPACITY];
+
+        /** \brief Heap storage for the neighbor indices. Never shrinks. */
+        std::vector<int> heap_indices_;
+
+        /** \brief Heap storage for the squared distances. Never shrinks. */
+        std::vector<float> heap_sqr_distances_;
+    };
+  }
+}
+
+#endif    // PCL_SEARCH_NEIGHBOR_LIST_H_
@@ -76,20 +76,22 @@ namespace pcl
         typedef boost::shared_ptr<const PointCloud> PointCloudConstPtr;
 
         // Boost shared pointers
-        typedef boost::shared_ptr<pcl::octree::OctreePointCloudSearch<PointT, LeafTWrap, BranchTWrap> > Ptr;
-        typedef boost::shared_ptr<const pcl::octree::OctreePointCloudSearch<PointT, LeafTWrap, BranchTWrap> > ConstPtr;
+        typedef boost::shared_ptr<pcl::octree::OctreePointCloudSearch<PointT, LeafTWrap, BranchTWrap, OctreeT> > Ptr;
+        typedef boost::shared_ptr<const pcl::octree::OctreePointCloudSearch<PointT, LeafTWrap, BranchTWrap, OctreeT> > ConstPtr;
         Ptr tree_;
 
         using pcl::search::Search<PointT>::input_;
         using pcl::search::Search<PointT>::indices_;
         using pcl::search::Search<PointT>::sorted_results_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
 
         /** \brief Octree constructor.
           * \param[in] resolution octree resolution at lowest octree level
           */
         Octree (const double resolution)
           : Search<PointT> ("Octree")
-          , tree_ (new pcl::octree::OctreePointCloudSearch<PointT, LeafTWrap, BranchTWrap> (resolution))
+          , tree_ (new pcl::octree::OctreePointCloudSearch<PointT, LeafTWrap, BranchTWrap, OctreeT> (resolution))
         {
         }
 
@@ -236,6 +238,45 @@ namespace pcl
           return (static_cast<int> (k_indices.size ()));
         }
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points.
+          * \note The octree processes the queries in Morton order and in parallel, see
+          * \note pcl::octree::OctreePointCloudSearch::nearestKSearch.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices a vector of point cloud indices to query for nearest neighbors (empty: all points)
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i] corresponds to the neighbors of the query point i
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, k_sqr_distances[i] corresponds to the neighbors of the query point i
+          */
+        void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        std::vector< std::vector<int> > &k_indices,
+                        std::vector< std::vector<float> > &k_sqr_distances) const
+        {
+          tree_->nearestKSearch (cloud, indices, k, k_indices, k_sqr_distances);
+        }
+
+        /** \brief Search for all the nearest neighbors of a batch of query points in a given radius.
+          * \note The octree processes the queries in Morton order and in parallel, see
+          * \note pcl::octree::OctreePointCloudSearch::radiusSearch.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i] corresponds to the neighbors of the query point i
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, k_sqr_distances[i] corresponds to the neighbors of the query point i
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          */
+        void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                      std::vector< std::vector<int> > &k_indices,
+                      std::vector< std::vector<float> > &k_sqr_distances,
+                      unsigned int max_nn = 0) const
+        {
+          tree_->radiusSearch (cloud, indices, radius, k_indices, k_sqr_distances, max_nn);
+          if (sorted_results_)
+            for (size_t i = 0; i < k_indices.size (); ++i)
+              this->sortResults (k_indices[i], k_sqr_distances[i]);
+        }
+
 
         /** \brief Search for approximate nearest neighbor at the query point.
           * \param[in] cloud the point cloud data
@@ -42,6 +42,7 @@
 
 #include <pcl/point_cloud.h>
 #include <pcl/common/io.h>
+#include <pcl/search/neighbor_list.h>
 
 namespace pcl
 {
@@ -234,6 +235,72 @@ namespace pcl
           }
         }
 
+        /** \brief Search for the k-nearest neighbors for the given query point, storing the result in a reusable
+          * NeighborList. The default implementation goes through the std::vector interface, using the heap buffers
+          * of \a neighbors; search methods that can write into a raw buffer should override it.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] neighbors the resultant neighbors
+          * \return number of neighbors found
+          */
+        virtual int
+        nearestKSearch (const PointT &point, int k, NeighborList &neighbors) const
+        {
+          std::vector<int> &k_indices = neighbors.getIndicesVector ();
+          std::vector<float> &k_sqr_distances = neighbors.getSqrDistancesVector ();
+          k_indices.resize (k);
+          k_sqr_distances.resize (k);
+          int nr_found = nearestKSearch (point, k, k_indices, k_sqr_distances);
+          neighbors.useVectors ();
+          if (nr_found < static_cast<int> (neighbors.size ()))
+            neighbors.resize (nr_found > 0 ? nr_found : 0);
+          return (nr_found);
+        }
+
+        /** \brief Search for k-nearest neighbors for the given query point, storing the result in a reusable
+          * NeighborList.
+          * \param[in] cloud the point cloud data
+          * \param[in] index a \a valid index in \a cloud representing a \a valid (i.e., finite) query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] neighbors the resultant neighbors
+          * \return number of neighbors found
+          */
+        inline int
+        nearestKSearch (const PointCloud &cloud, int index, int k, NeighborList &neighbors) const
+        {
+          assert (index >= 0 && index < static_cast<int> (cloud.points.size ()) && "Out-of-bounds error in nearestKSearch!");
+          return (nearestKSearch (cloud.points[index], k, neighbors));
+        }
+
+        /** \brief Search for k-nearest neighbors for the given query point (zero-copy), storing the result in a
+          * reusable NeighborList.
+          * \param[in] index a \a valid index representing a \a valid query point in the dataset given
+          * by \a setInputCloud. If indices were given in setInputCloud, index will be the position in
+          * the indices vector.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] neighbors the resultant neighbors
+          * \return number of neighbors found
+          */
+        inline int
+        nearestKSearch (int index, int k, NeighborList &neighbors) const
+        {
+          if (indices_ == NULL)
+          {
+            assert (index >= 0 && index < static_cast<int> (input_->points.size ()) && "Out-of-bounds error in nearestKSearch!");
+            return (nearestKSearch (input_->points[index], k, neighbors));
+          }
+          else
+          {
+            assert (index >= 0 && index < static_cast<int> (indices_->size ()) && "Out-of-bounds error in nearestKSearch!");
+            if (index >= static_cast<int> (indices_->size ()) || index < 0)
+            {
+              neighbors.clear ();
+              return (0);
+            }
+            return (nearestKSearch (input_->points[(*indices_)[index]], k, neighbors));
+          }
+        }
+
         /** \brief Search for the k-nearest neighbors for the given query point.
           * \param[in] cloud the point cloud data
           * \param[in] indices a vector of point cloud indices to query for nearest neighbors
@@ -399,6 +466,68 @@ namespace pcl
           }
         }
 
+        /** \brief Search for all the nearest neighbors of the query point in a given radius, storing the result in
+          * a reusable NeighborList. The default implementation goes through the std::vector interface, using the
+          * heap buffers of \a neighbors; search methods that can write into a raw buffer should override it.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] neighbors the resultant neighbors
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \return number of neighbors found in radius
+          */
+        virtual int
+        radiusSearch (const PointT &point, double radius, NeighborList &neighbors, unsigned int max_nn = 0) const
+        {
+          int nr_found = radiusSearch (point, radius, neighbors.getIndicesVector (),
+                                       neighbors.getSqrDistancesVector (), max_nn);
+          neighbors.useVectors ();
+          return (nr_found);
+        }
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius, storing the result in
+          * a reusable NeighborList.
+          * \param[in] cloud the point cloud data
+          * \param[in] index a \a valid index in \a cloud representing a \a valid (i.e., finite) query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] neighbors the resultant neighbors
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        inline int
+        radiusSearch (const PointCloud &cloud, int index, double radius, NeighborList &neighbors,
+                      unsigned int max_nn = 0) const
+        {
+          assert (index >= 0 && index < static_cast<int> (cloud.points.size ()) && "Out-of-bounds error in radiusSearch!");
+          return (radiusSearch (cloud.points[index], radius, neighbors, max_nn));
+        }
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius (zero-copy), storing
+          * the result in a reusable NeighborList.
+          * \param[in] index a \a valid index representing a \a valid query point in the dataset given
+          * by \a setInputCloud. If indices were given in setInputCloud, index will be the position in
+          * the indices vector.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] neighbors the resultant neighbors
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        inline int
+        radiusSearch (int index, double radius, NeighborList &neighbors, unsigned int max_nn = 0) const
+        {
+          if (indices_ == NULL)
+          {
+            assert (index >= 0 && index < static_cast<int> (input_->points.size ()) && "Out-of-bounds error in radiusSearch!");
+            return (radiusSearch (input_->points[index], radius, neighbors, max_nn));
+          }
+          else
+          {
+            assert (index >= 0 && index < static_cast<int> (indices_->size ()) && "Out-of-bounds error in radiusSearch!");
+            return (radiusSearch (input_->points[(*indices_)[index]], radius, neighbors, max_nn));
+          }
+        }
+
         /** \brief Search for all the nearest neighbors of the query point in a given radius.
           * \param[in] cloud the point cloud data
           * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
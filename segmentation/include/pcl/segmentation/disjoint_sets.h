@@ -0,0 +1,135 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEGMENTATION_DISJOINT_SETS_H_
+#define PCL_SEGMENTATION_DISJOINT_SETS_H_
+
+#include <algorithm>
+#include <vector>
+#include <pcl/common/atomic.h>
+
+namespace pcl
+{
+  /** \brief ConcurrentDisjointSets is a union-find structure over the elements 0..size-1 that can be updated
+    * from several threads at once without locks.
+    *
+    * Sets are always linked from the larger root to the smaller one with a compare-and-swap, so the root of
+    * every set is its smallest element, independently of the order in which the unions were made. Lookups
+    * compress the paths they walk by halving (also with compare-and-swap), which keeps the trees shallow.
+    *
+    * \author Open Perception
+    * \ingroup segmentation
+    */
+  class ConcurrentDisjointSets
+  {
+    public:
+      /** \brief Constructor.
+        * \param[in] size the number of elements, each one starting in a set of its own
+        */
+      ConcurrentDisjointSets (int size = 0) : parent_ ()
+      {
+        reset (size);
+      }
+
+      /** \brief Put each of the \a size elements back into a set of its own.
+        * \param[in] size the number of elements
+        */
+      inline void
+      reset (int size)
+      {
+        parent_.resize (size);
+        for (int i = 0; i < size; ++i)
+          parent_[i] = i;
+      }
+
+      /** \brief Get the number of elements. */
+      inline int
+      size () const
+      {
+        return (static_cast<int> (parent_.size ()));
+      }
+
+      /** \brief Get the root of the set containing \a x, i.e. its smallest element.
+        * \param[in] x the element to look up
+        */
+      inline int
+      find (int x)
+      {
+        volatile int *parent = &parent_[0];
+        int p = parent[x];
+        while (p != x)
+        {
+          const int gp = parent[p];
+          // Path halving: a failed swap only means another thread already moved x closer to the root
+          if (gp != p)
+            atomicCompareAndSwap (&parent[x], p, gp);
+          x = gp;
+          p = parent[x];
+        }
+        return (x);
+      }
+
+      /** \brief Merge the sets containing \a a and \a b.
+        * \param[in] a an element of the first set
+        * \param[in] b an element of the second set
+        * \return true if the two sets were disjoint before the call
+        */
+      inline bool
+      unite (int a, int b)
+      {
+        volatile int *parent = &parent_[0];
+        while (true)
+        {
+          a = find (a);
+          b = find (b);
+          if (a == b)
+            return (false);
+          if (a < b)
+            std::swap (a, b);
+          // a is only linked if it is still a root; otherwise look both roots up again
+          if (atomicCompareAndSwap (&parent[a], a, b))
+            return (true);
+        }
+      }
+
+    protected:
+      /** \brief The parent of every element; roots are their own parent. */
+      std::vector<int> parent_;
+  };
+}
+
+#endif  // PCL_SEGMENTATION_DISJOINT_SETS_H_
@@ -43,6 +43,7 @@
 #include <pcl/pcl_base.h>
 
 #include <pcl/search/pcl_search.h>
+#include <pcl/segmentation/disjoint_sets.h>
 
 namespace pcl
 {
@@ -55,13 +56,18 @@ namespace pcl
     * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
     * \param min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
     * \param max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \param nr_threads the number of threads running the radius searches (default: 1, 0 means automatic). With
+    * more than one thread, the neighborhoods are merged in a \ref ConcurrentDisjointSets instead of being flood
+    * filled; the resulting clusters are the same, in the same order.
+    * \note with more than one thread, \a tree must support concurrent queries (all pcl::search methods do)
     * \ingroup segmentation
     */
   template <typename PointT> void 
   extractEuclideanClusters (
       const PointCloud<PointT> &cloud, const boost::shared_ptr<search::Search<PointT> > &tree, 
       float tolerance, std::vector<PointIndices> &clusters, 
-      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) (),
+      unsigned int nr_threads = 1);
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief Decompose a region of space into clusters based on the Euclidean distance between points
@@ -73,13 +79,42 @@ namespace pcl
     * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
     * \param min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
     * \param max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \param nr_threads the number of threads running the radius searches (default: 1, 0 means automatic). With
+    * more than one thread, the neighborhoods are merged in a \ref ConcurrentDisjointSets instead of being flood
+    * filled; the resulting clusters are the same, in the same order.
+    * \note with more than one thread, \a tree must support concurrent queries (all pcl::search methods do)
     * \ingroup segmentation
     */
   template <typename PointT> void 
   extractEuclideanClusters (
       const PointCloud<PointT> &cloud, const std::vector<int> &indices, 
       const boost::shared_ptr<search::Search<PointT> > &tree, float tolerance, std::vector<PointIndices> &clusters, 
-      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) (),
+      unsigned int nr_threads = 1);
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Decompose a region of space into clusters based on the Euclidean distance between points, without a
+    * search tree. The points are binned with the cell indexing of a \ref VoxelGrid whose leaf size is \a tolerance,
+    * so the neighbors of a point can only lie in its own cell and the 26 cells around it, and the points of adjacent
+    * cells are compared directly. The clusters are the same as the ones of the search based version (up to
+    * points exactly at the tolerance), in the same order. Points with non-finite coordinates are ignored.
+    * \param cloud the point cloud message
+    * \param indices a list of point indices to use from \a cloud
+    * \param tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+    * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
+    * \param min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
+    * \param max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \param nr_threads the number of threads comparing the cells (default: 1, 0 means automatic)
+    * \note the grid needs no setup, which pays off on large unorganized clouds; it gets slow when many points share
+    * a cell, i.e. when the tolerance is large compared to the point spacing
+    * \ingroup segmentation
+    */
+  template <typename PointT> void 
+  extractEuclideanClustersVoxelGrid (
+      const PointCloud<PointT> &cloud, const std::vector<int> &indices, 
+      float tolerance, std::vector<PointIndices> &clusters, 
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) (),
+      unsigned int nr_threads = 1);
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief Decompose a region of space into clusters based on the euclidean distance between points, and the normal
@@ -312,7 +347,9 @@ namespace pcl
       EuclideanClusterExtraction () : tree_ (), 
                                       cluster_tolerance_ (0),
                                       min_pts_per_cluster_ (1), 
-                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ())
+                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ()),
+                                      threads_ (1),
+                                      use_voxel_grid_ (false)
       {};
 
       /** \brief Provide a pointer to the search object.
@@ -381,6 +418,29 @@ namespace pcl
         return (max_pts_per_cluster_); 
       }
 
+      /** \brief Set the number of threads running the radius searches of \ref extract. Extraction runs on a single
+        * thread unless this is set.
+        * \param[in] nr_threads the number of hardware threads to use (0 means automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads running the radius searches (0 means automatic). */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
+      /** \brief Set whether \ref extract finds the neighbors of the points with a voxel grid of leaf size
+        * \ref getClusterTolerance (see \ref extractEuclideanClustersVoxelGrid) instead of the search method. The
+        * grid needs no search tree, so none is built, and \ref setSearchMethod is ignored.
+        * \param[in] use_voxel_grid true to use the voxel grid, false to use the search method (default)
+        */
+      inline void
+      setUseVoxelGrid (bool use_voxel_grid) { use_voxel_grid_ = use_voxel_grid; }
+
+      /** \brief Get whether \ref extract uses a voxel grid instead of the search method. */
+      inline bool
+      getUseVoxelGrid () const { return (use_voxel_grid_); }
+
       /** \brief Cluster extraction in a PointCloud given by <setInputCloud (), setIndices ()>
         * \param[out] clusters the resultant point clusters
         */
@@ -406,6 +466,12 @@ namespace pcl
       /** \brief The maximum number of points that a cluster needs to contain in order to be considered valid (default = MAXINT). */
       int max_pts_per_cluster_;
 
+      /** \brief The number of threads the scheduler should use (default = 1, 0 means automatic). */
+      unsigned int threads_;
+
+      /** \brief Whether the neighbors are found with a voxel grid instead of \a tree_. */
+      bool use_voxel_grid_;
+
       /** \brief Class getName method. */
       virtual std::string getClassName () const { return ("EuclideanClusterExtraction"); }
 
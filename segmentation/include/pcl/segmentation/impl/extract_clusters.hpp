@@ -39,6 +39,167 @@
 #define PCL_SEGMENTATION_IMPL_EXTRACT_CLUSTERS_H_
 
 #include <pcl/segmentation/extract_clusters.h>
+#include <pcl/filters/voxel_grid.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Turn the sets of a \ref ConcurrentDisjointSets over the positions in \a indices into clusters,
+      * ordered by their smallest position and with sorted point indices, and append those whose size lies in
+      * [\a min_pts_per_cluster, \a max_pts_per_cluster] to \a clusters. Positions \a i for which
+      * position[indices[i]] != i (repeated or skipped points) are left out.
+      */
+    template <typename PointT> void
+    collectClusters (const PointCloud<PointT> &cloud, const std::vector<int> &indices,
+                     const std::vector<int> &position, ConcurrentDisjointSets &sets,
+                     std::vector<PointIndices> &clusters,
+                     unsigned int min_pts_per_cluster, unsigned int max_pts_per_cluster)
+    {
+      const int nr_indices = static_cast<int> (indices.size ());
+
+      // Count the members of every set, then give each valid set its cluster
+      const size_t first_cluster = clusters.size ();
+      std::vector<int> cluster_of (nr_indices, 0);
+      for (int i = 0; i < nr_indices; ++i)
+        if (position[indices[i]] == i)
+          cluster_of[sets.find (i)]++;
+
+      for (int i = 0; i < nr_indices; ++i)
+      {
+        const int size = cluster_of[i];
+        cluster_of[i] = -1;
+        if (position[indices[i]] != i || sets.find (i) != i)
+          continue;
+        if (static_cast<unsigned int> (size) < min_pts_per_cluster || static_cast<unsigned int> (size) > max_pts_per_cluster)
+          continue;
+
+        cluster_of[i] = static_cast<int> (clusters.size ());
+        clusters.push_back (PointIndices ());
+        clusters.back ().header = cloud.header;
+        clusters.back ().indices.reserve (size);
+      }
+
+      for (int i = 0; i < nr_indices; ++i)
+      {
+        if (position[indices[i]] != i)
+          continue;
+        const int cluster = cluster_of[sets.find (i)];
+        if (cluster != -1)
+          clusters[cluster].indices.push_back (indices[i]);
+      }
+
+      for (size_t c = first_cluster; c < clusters.size (); ++c)
+        std::sort (clusters[c].indices.begin (), clusters[c].indices.end ());
+    }
+
+    /** \brief A point of \ref extractEuclideanClustersVoxelGrid, with the coordinates of its grid cell. */
+    struct GridCellEntry
+    {
+      int ix, iy, iz;
+      int position;
+      float x, y, z;
+    };
+
+    /** \brief Order grid entries by cell (x major), then by position. */
+    inline bool
+    operator< (const GridCellEntry &a, const GridCellEntry &b)
+    {
+      if (a.ix != b.ix)
+        return (a.ix < b.ix);
+      if (a.iy != b.iy)
+        return (a.iy < b.iy);
+      if (a.iz != b.iz)
+        return (a.iz < b.iz);
+      return (a.position < b.position);
+    }
+
+    /** \brief Merge the points of two grid cells (or of a cell with itself, if \a first_a == \a first_b) that
+      * are at most sqrt (\a sqr_tolerance) apart.
+      */
+    inline void
+    uniteCloseEntries (const std::vector<GridCellEntry> &entries, int first_a, int last_a, int first_b, int last_b,
+                       float sqr_tolerance, ConcurrentDisjointSets &sets)
+    {
+      for (int a = first_a; a < last_a; ++a)
+      {
+        const GridCellEntry &pa = entries[a];
+        for (int b = (first_a == first_b) ? a + 1 : first_b; b < last_b; ++b)
+        {
+          const GridCellEntry &pb = entries[b];
+          const float dx = pa.x - pb.x, dy = pa.y - pb.y, dz = pa.z - pb.z;
+          if (dx * dx + dy * dy + dz * dz <= sqr_tolerance)
+            sets.unite (pa.position, pb.position);
+        }
+      }
+    }
+
+    /** \brief Parallel core of \ref extractEuclideanClusters: the radius searches of all points run concurrently
+      * and every neighbor pair is merged in a \ref ConcurrentDisjointSets over the positions in \a indices. As the
+      * root of a set is its smallest position, the clusters come out in the order the flood fill would find them.
+      * \return false if the search method reported an error
+      */
+    template <typename PointT> bool
+    extractEuclideanClustersUnionFind (const PointCloud<PointT> &cloud, const std::vector<int> &indices,
+                                       const boost::shared_ptr<search::Search<PointT> > &tree,
+                                       float tolerance, std::vector<PointIndices> &clusters,
+                                       unsigned int min_pts_per_cluster, unsigned int max_pts_per_cluster,
+                                       int threads)
+    {
+      const int nr_indices = static_cast<int> (indices.size ());
+
+      // The position of every point in indices (its first occurrence if listed twice), -1 for unused points
+      std::vector<int> position (cloud.points.size (), -1);
+      for (int i = nr_indices - 1; i >= 0; --i)
+        position[indices[i]] = i;
+
+      ConcurrentDisjointSets sets (nr_indices);
+      int nr_failed = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads)
+#endif
+      {
+        std::vector<int> nn_indices;
+        std::vector<float> nn_distances;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256) reduction(+:nr_failed)
+#endif
+        for (int i = 0; i < nr_indices; ++i)
+        {
+          if (position[indices[i]] != i)
+            continue;
+
+          int ret = tree->radiusSearch (cloud.points[indices[i]], tolerance, nn_indices, nn_distances);
+          if (ret == -1)
+          {
+            nr_failed++;
+            continue;
+          }
+
+          for (int j = 0; j < ret; ++j)
+          {
+            if (nn_indices[j] == -1)
+              continue;
+            const int neighbor = position[nn_indices[j]];
+            if (neighbor != -1 && neighbor != i)
+              sets.unite (i, neighbor);
+          }
+        }
+      }
+
+      if (nr_failed > 0)
+        return (false);
+
+      collectClusters (cloud, indices, position, sets, clusters, min_pts_per_cluster, max_pts_per_cluster);
+      return (true);
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -46,13 +207,31 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
                                const boost::shared_ptr<search::Search<PointT> > &tree,
                                float tolerance, std::vector<PointIndices> &clusters,
                                unsigned int min_pts_per_cluster, 
-                               unsigned int max_pts_per_cluster)
+                               unsigned int max_pts_per_cluster,
+                               unsigned int nr_threads)
 {
   if (tree->getInputCloud ()->points.size () != cloud.points.size ())
   {
     PCL_ERROR ("[pcl::extractEuclideanClusters] Tree built for a different point cloud dataset (%zu) than the input cloud (%zu)!\n", tree->getInputCloud ()->points.size (), cloud.points.size ());
     return;
   }
+
+#ifdef _OPENMP
+  const int threads = nr_threads ? static_cast<int> (nr_threads) : omp_get_max_threads ();
+#else
+  const int threads = 1;
+  (void)nr_threads;
+#endif
+  if (threads > 1)
+  {
+    std::vector<int> indices (cloud.points.size ());
+    for (size_t i = 0; i < indices.size (); ++i)
+      indices[i] = static_cast<int> (i);
+    if (!detail::extractEuclideanClustersUnionFind (cloud, indices, tree, tolerance, clusters, min_pts_per_cluster, max_pts_per_cluster, threads))
+      PCL_ERROR ("[pcl::extractEuclideanClusters] Received error code -1 from radiusSearch\n");
+    return;
+  }
+
   // Create a bool vector of processed point indices, and initialize it to false
   std::vector<bool> processed (cloud.points.size (), false);
 
@@ -79,7 +258,7 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
         continue;
       }
 
-      for (size_t j = 1; j < nn_indices.size (); ++j)             // nn_indices[0] should be sq_idx
+      for (size_t j = 0; j < nn_indices.size (); ++j)             // results may be unsorted; sq_idx itself is processed
       {
         if (nn_indices[j] == -1 || processed[nn_indices[j]])        // Has this point been processed before ?
           continue;
@@ -118,7 +297,8 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
                                const boost::shared_ptr<search::Search<PointT> > &tree,
                                float tolerance, std::vector<PointIndices> &clusters,
                                unsigned int min_pts_per_cluster, 
-                               unsigned int max_pts_per_cluster)
+                               unsigned int max_pts_per_cluster,
+                               unsigned int nr_threads)
 {
   // \note If the tree was created over <cloud, indices>, we guarantee a 1-1 mapping between what the tree returns
   //and indices[i]
@@ -133,6 +313,19 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
     return;
   }
 
+#ifdef _OPENMP
+  const int threads = nr_threads ? static_cast<int> (nr_threads) : omp_get_max_threads ();
+#else
+  const int threads = 1;
+  (void)nr_threads;
+#endif
+  if (threads > 1)
+  {
+    if (!detail::extractEuclideanClustersUnionFind (cloud, indices, tree, tolerance, clusters, min_pts_per_cluster, max_pts_per_cluster, threads))
+      PCL_ERROR ("[pcl::extractEuclideanClusters] Received error code -1 from radiusSearch\n");
+    return;
+  }
+
   // Create a bool vector of processed point indices, and initialize it to false
   std::vector<bool> processed (cloud.points.size (), false);
 
@@ -165,7 +358,7 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
         continue;
       }
 
-      for (size_t j = 1; j < nn_indices.size (); ++j)             // nn_indices[0] should be sq_idx
+      for (size_t j = 0; j < nn_indices.size (); ++j)             // results may be unsorted; sq_idx itself is processed
       {
         if (nn_indices[j] == -1 || processed[nn_indices[j]])        // Has this point been processed before ?
           continue;
@@ -198,6 +391,129 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractEuclideanClustersVoxelGrid (const PointCloud<PointT> &cloud, 
+                                        const std::vector<int> &indices,
+                                        float tolerance, std::vector<PointIndices> &clusters,
+                                        unsigned int min_pts_per_cluster, 
+                                        unsigned int max_pts_per_cluster,
+                                        unsigned int nr_threads)
+{
+  if (!(tolerance > 0))
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersVoxelGrid] Invalid cluster tolerance (%f)!\n", tolerance);
+    return;
+  }
+  if (indices.empty ())
+    return;
+
+  // The cell coordinates must fit in an int, as in VoxelGrid
+  Eigen::Vector4f min_p, max_p;
+  getMinMax3D (cloud, indices, min_p, max_p);
+  const float max_coordinate = (std::max) (min_p.head<3> ().cwiseAbs ().maxCoeff (), max_p.head<3> ().cwiseAbs ().maxCoeff ());
+  if (max_coordinate / tolerance >= static_cast<float> (std::numeric_limits<int>::max ()))
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersVoxelGrid] Cluster tolerance is too small for the input dataset. Integer grid coordinates would overflow.\n");
+    return;
+  }
+
+#ifdef _OPENMP
+  const int threads = nr_threads ? static_cast<int> (nr_threads) : omp_get_max_threads ();
+#else
+  (void)nr_threads;
+#endif
+
+  const int nr_indices = static_cast<int> (indices.size ());
+
+  // The position of every point in indices (its first occurrence if listed twice), -1 for unused and non-finite points
+  std::vector<int> position (cloud.points.size (), -1);
+  for (int i = nr_indices - 1; i >= 0; --i)
+    position[indices[i]] = i;
+
+  // Bin the points with the cell indexing of a VoxelGrid whose leaf size is the tolerance, so that all the
+  // neighbors of a point lie in its own cell or in one of the 26 cells around it
+  VoxelGrid<PointT> grid;
+  grid.setLeafSize (tolerance, tolerance, tolerance);
+
+  std::vector<detail::GridCellEntry> entries;
+  entries.reserve (nr_indices);
+  for (int i = 0; i < nr_indices; ++i)
+  {
+    const PointT &point = cloud.points[indices[i]];
+    if (position[indices[i]] != i)
+      continue;
+    if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+    {
+      position[indices[i]] = -1;
+      continue;
+    }
+
+    Eigen::Vector3i ijk = grid.getGridCoordinates (point.x, point.y, point.z);
+    detail::GridCellEntry entry;
+    entry.ix = ijk[0]; entry.iy = ijk[1]; entry.iz = ijk[2];
+    entry.position = i;
+    entry.x = point.x; entry.y = point.y; entry.z = point.z;
+    entries.push_back (entry);
+  }
+  std::sort (entries.begin (), entries.end ());
+
+  // First entry of every occupied cell
+  std::vector<int> cell_start;
+  for (int e = 0; e < static_cast<int> (entries.size ()); ++e)
+    if (e == 0 || entries[e].ix != entries[e - 1].ix || entries[e].iy != entries[e - 1].iy || entries[e].iz != entries[e - 1].iz)
+      cell_start.push_back (e);
+  const int nr_cells = static_cast<int> (cell_start.size ());
+  cell_start.push_back (static_cast<int> (entries.size ()));
+
+  // Each pair of adjacent cells is visited once: from the cell that comes first in the sort order
+  static const int forward_offsets[13][3] = { { 0, 0, 1},
+                                              { 0, 1,-1}, { 0, 1, 0}, { 0, 1, 1},
+                                              { 1,-1,-1}, { 1,-1, 0}, { 1,-1, 1},
+                                              { 1, 0,-1}, { 1, 0, 0}, { 1, 0, 1},
+                                              { 1, 1,-1}, { 1, 1, 0}, { 1, 1, 1} };
+  const float sqr_tolerance = tolerance * tolerance;
+  ConcurrentDisjointSets sets (nr_indices);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) num_threads(threads)
+#endif
+  for (int c = 0; c < nr_cells; ++c)
+  {
+    const detail::GridCellEntry &cell = entries[cell_start[c]];
+    detail::uniteCloseEntries (entries, cell_start[c], cell_start[c + 1], cell_start[c], cell_start[c + 1], sqr_tolerance, sets);
+
+    for (int o = 0; o < 13; ++o)
+    {
+      detail::GridCellEntry key;
+      key.ix = cell.ix + forward_offsets[o][0];
+      key.iy = cell.iy + forward_offsets[o][1];
+      key.iz = cell.iz + forward_offsets[o][2];
+      key.position = -1;
+
+      // Binary search for the neighboring cell among the cells after this one
+      int lo = c + 1, hi = nr_cells;
+      while (lo < hi)
+      {
+        const int mid = (lo + hi) / 2;
+        if (entries[cell_start[mid]] < key)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      if (lo == nr_cells)
+        continue;
+      const detail::GridCellEntry &neighbor = entries[cell_start[lo]];
+      if (neighbor.ix != key.ix || neighbor.iy != key.iy || neighbor.iz != key.iz)
+        continue;
+
+      detail::uniteCloseEntries (entries, cell_start[c], cell_start[c + 1], cell_start[lo], cell_start[lo + 1], sqr_tolerance, sets);
+    }
+  }
+
+  detail::collectClusters (cloud, indices, position, sets, clusters, min_pts_per_cluster, max_pts_per_cluster);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -213,6 +529,14 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
     return;
   }
 
+  if (use_voxel_grid_)
+  {
+    extractEuclideanClustersVoxelGrid (*input_, *indices_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_, threads_);
+    std::sort (clusters.rbegin (), clusters.rend (), comparePointClusters);
+    deinitCompute ();
+    return;
+  }
+
   // Initialize the spatial locator
   if (!tree_)
   {
@@ -224,7 +548,7 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_, indices_);
-  extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_);
+  extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_, threads_);
 
   //tree_->setInputCloud (input_);
   //extractEuclideanClusters (*input_, tree_, cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_);
@@ -236,7 +560,8 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 }
 
 #define PCL_INSTANTIATE_EuclideanClusterExtraction(T) template class PCL_EXPORTS pcl::EuclideanClusterExtraction<T>;
-#define PCL_INSTANTIATE_extractEuclideanClusters(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
-#define PCL_INSTANTIATE_extractEuclideanClusters_indices(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const std::vector<int> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClusters(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClustersVoxelGrid(T) template void PCL_EXPORTS pcl::extractEuclideanClustersVoxelGrid<T>(const pcl::PointCloud<T> &, const std::vector<int> &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClusters_indices(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const std::vector<int> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int);
 
 #endif        // PCL_EXTRACT_CLUSTERS_IMPL_H_
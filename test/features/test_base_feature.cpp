@@ -40,6 +40,10 @@
 #include <gtest/gtest.h>
 #include <pcl/point_cloud.h>
 #include <pcl/features/feature.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/features/pfh.h>
+#include <pcl/features/boundary.h>
+#include <pcl/features/principal_curvatures.h>
 #include <pcl/io/pcd_io.h>
 
 using namespace pcl;
@@ -151,6 +155,92 @@ TEST (PCL, BaseFeature)
   EXPECT_NEAR (curvature, 0.0693136, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename FeatureT, typename PointOutT> void
+computeWithThreads (FeatureT &estimator, unsigned int nr_threads, PointCloud<PointOutT> &output)
+{
+  estimator.setNumberOfThreads (nr_threads);
+  EXPECT_EQ (nr_threads, estimator.getNumberOfThreads ());
+  estimator.compute (output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FeatureThreads)
+{
+  boost::shared_ptr<vector<int> > subset (new vector<int>);
+  for (size_t i = 0; i < indices.size (); i += 3)
+    subset->push_back (indices[i]);
+
+  // Normals
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  PointCloud<Normal> normals_threaded;
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  EXPECT_EQ (1u, n.getNumberOfThreads ());
+  computeWithThreads (n, 1, *normals);
+  computeWithThreads (n, 4, normals_threaded);
+  ASSERT_EQ (normals->points.size (), normals_threaded.points.size ());
+  EXPECT_EQ (normals->is_dense, normals_threaded.is_dense);
+  for (size_t i = 0; i < normals->points.size (); ++i)
+  {
+    EXPECT_EQ (normals->points[i].normal_x, normals_threaded.points[i].normal_x);
+    EXPECT_EQ (normals->points[i].normal_y, normals_threaded.points[i].normal_y);
+    EXPECT_EQ (normals->points[i].normal_z, normals_threaded.points[i].normal_z);
+    EXPECT_EQ (normals->points[i].curvature, normals_threaded.points[i].curvature);
+  }
+
+  // PFH, on a subset of the points
+  PFHEstimation<PointXYZ, Normal, PFHSignature125> pfh;
+  PointCloud<PFHSignature125> pfhs, pfhs_threaded;
+  pfh.setInputCloud (cloud.makeShared ());
+  pfh.setInputNormals (normals);
+  pfh.setIndices (subset);
+  pfh.setSearchMethod (tree);
+  pfh.setKSearch (10);
+  computeWithThreads (pfh, 1, pfhs);
+  computeWithThreads (pfh, 4, pfhs_threaded);
+  ASSERT_EQ (subset->size (), pfhs_threaded.points.size ());
+  EXPECT_EQ (pfhs.width, pfhs_threaded.width);
+  for (size_t i = 0; i < pfhs.points.size (); ++i)
+    for (int d = 0; d < 125; ++d)
+      EXPECT_EQ (pfhs.points[i].histogram[d], pfhs_threaded.points[i].histogram[d]);
+
+  // Boundaries
+  BoundaryEstimation<PointXYZ, Normal, Boundary> b;
+  PointCloud<Boundary> boundaries, boundaries_threaded;
+  b.setInputCloud (cloud.makeShared ());
+  b.setInputNormals (normals);
+  b.setSearchMethod (tree);
+  b.setKSearch (10);
+  computeWithThreads (b, 1, boundaries);
+  computeWithThreads (b, 0, boundaries_threaded);
+  ASSERT_EQ (boundaries.points.size (), boundaries_threaded.points.size ());
+  for (size_t i = 0; i < boundaries.points.size (); ++i)
+    EXPECT_EQ (boundaries.points[i].boundary_point, boundaries_threaded.points[i].boundary_point);
+
+  // Principal curvatures, with a chunk per point
+  PrincipalCurvaturesEstimation<PointXYZ, Normal, PrincipalCurvatures> pc;
+  PointCloud<PrincipalCurvatures> curvatures, curvatures_threaded;
+  boost::shared_ptr<vector<int> > few (new vector<int> (subset->begin (), subset->begin () + 5));
+  pc.setInputCloud (cloud.makeShared ());
+  pc.setInputNormals (normals);
+  pc.setIndices (few);
+  pc.setSearchMethod (tree);
+  pc.setKSearch (10);
+  computeWithThreads (pc, 1, curvatures);
+  computeWithThreads (pc, 8, curvatures_threaded);
+  ASSERT_EQ (few->size (), curvatures_threaded.points.size ());
+  for (size_t i = 0; i < curvatures.points.size (); ++i)
+  {
+    for (int d = 0; d < 3; ++d)
+      EXPECT_EQ (curvatures.points[i].principal_curvature[d], curvatures_threaded.points[i].principal_curvature[d]);
+    EXPECT_EQ (curvatures.points[i].pc1, curvatures_threaded.points[i].pc1);
+    EXPECT_EQ (curvatures.points[i].pc2, curvatures_threaded.points[i].pc2);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
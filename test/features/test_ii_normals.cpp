@@ -342,6 +342,88 @@ TEST(PCL, IntegralImage3D)
   delete[] data;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PCL, IntegralImageThreads)
+{
+  const unsigned width = 640;
+  const unsigned height = 480;
+  const unsigned element_stride = 4;
+  const unsigned row_stride = width * element_stride;
+  float* data = new float[row_stride * height];
+  srand (0);
+  for (unsigned idx = 0; idx < width * height; ++idx)
+  {
+    data[idx * element_stride]     = static_cast<float> (rand () % 100);
+    data[idx * element_stride + 1] = static_cast<float> (rand () % 100);
+    data[idx * element_stride + 2] = (rand () % 10 == 0) ? std::numeric_limits<float>::quiet_NaN () : static_cast<float> (rand () % 100);
+    data[idx * element_stride + 3] = -1000.0f;
+  }
+
+  IntegralImage2D<float, 3> serial (true);
+  serial.setInput (data, width, height, element_stride, row_stride);
+
+  // the bands integrated by several threads add up to the same sums
+  IntegralImage2D<float, 3> threaded (true);
+  threaded.setNumberOfThreads (4);
+  threaded.setInput (data, width, height, element_stride, row_stride);
+
+  IntegralImage2D<float, 3> compensated (true);
+  compensated.setNumberOfThreads (3);
+  compensated.setCompensatedSummation (true);
+  compensated.setInput (data, width, height, element_stride, row_stride);
+
+  for (unsigned yIdx = 0; yIdx < height - 7; yIdx += 7)
+  {
+    for (unsigned xIdx = 0; xIdx < width - 5; xIdx += 5)
+    {
+      EXPECT_EQ (serial.getFiniteElementsCount (xIdx, yIdx, 5, 7), threaded.getFiniteElementsCount (xIdx, yIdx, 5, 7));
+      EXPECT_EQ (serial.getFiniteElementsCount (xIdx, yIdx, 5, 7), compensated.getFiniteElementsCount (xIdx, yIdx, 5, 7));
+      EXPECT_EQ (serial.getFirstOrderSum (xIdx, yIdx, 5, 7), threaded.getFirstOrderSum (xIdx, yIdx, 5, 7));
+      EXPECT_EQ (serial.getFirstOrderSum (xIdx, yIdx, 5, 7), compensated.getFirstOrderSum (xIdx, yIdx, 5, 7));
+      EXPECT_EQ (serial.getSecondOrderSum (xIdx, yIdx, 5, 7), threaded.getSecondOrderSum (xIdx, yIdx, 5, 7));
+      EXPECT_EQ (serial.getSecondOrderSum (xIdx, yIdx, 5, 7), compensated.getSecondOrderSum (xIdx, yIdx, 5, 7));
+    }
+  }
+
+  // a smaller frame reuses the buffers of the larger one
+  const unsigned sub_width = width / 2;
+  const unsigned sub_height = height / 3;
+  IntegralImage2D<float, 3> sub_image (true);
+  sub_image.setInput (data, sub_width, sub_height, element_stride, row_stride);
+  threaded.setInput (data, sub_width, sub_height, element_stride, row_stride);
+  for (unsigned yIdx = 0; yIdx < sub_height - 3; yIdx += 3)
+  {
+    for (unsigned xIdx = 0; xIdx < sub_width - 3; xIdx += 3)
+    {
+      EXPECT_EQ (sub_image.getFiniteElementsCount (xIdx, yIdx, 3, 3), threaded.getFiniteElementsCount (xIdx, yIdx, 3, 3));
+      EXPECT_EQ (sub_image.getFirstOrderSum (xIdx, yIdx, 3, 3), threaded.getFirstOrderSum (xIdx, yIdx, 3, 3));
+      EXPECT_EQ (sub_image.getSecondOrderSum (xIdx, yIdx, 3, 3), threaded.getSecondOrderSum (xIdx, yIdx, 3, 3));
+    }
+  }
+  delete[] data;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PCL, IntegralImageCompensatedSummation)
+{
+  const unsigned width = 640;
+  const unsigned height = 480;
+  std::vector<float> data (width * height, 0.1f);
+
+  IntegralImage2D<float, 1, float> integral_image (false);
+  IntegralImage2D<float, 1, float> compensated (false);
+  compensated.setCompensatedSummation (true);
+  integral_image.setInput (&data[0], width, height, 1, width);
+  compensated.setInput (&data[0], width, height, 1, width);
+
+  const double sum = static_cast<double> (0.1f) * width * height;
+  const double error = fabs (integral_image.getFirstOrderSum (0, 0, width, height) - sum);
+  const double compensated_error = fabs (compensated.getFirstOrderSum (0, 0, width, height) - sum);
+  EXPECT_LT (compensated_error, error);
+  EXPECT_NEAR (compensated.getFirstOrderSum (0, 0, width, height), sum, 1e-2);
+  EXPECT_EQ (width * height, compensated.getFiniteElementsCount (0, 0, width, height));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, NormalEstimation)
 {
@@ -490,6 +572,55 @@ TEST (PCL, IINormalEstimationSimple3DGradient)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IINormalEstimationChangedDepthROI)
+{
+  PointCloud<PointXYZ>::Ptr frame (new PointCloud<PointXYZ> (cloud));
+  IntegralImageNormalEstimation<PointXYZ, Normal> streaming;
+  streaming.setNormalEstimationMethod (streaming.COVARIANCE_MATRIX);
+  streaming.setChangedDepthROI (true);
+
+  PointCloud<Normal> output;
+  streaming.setInputCloud (frame);
+  streaming.compute (output);
+  EXPECT_EQ (output.points.size (), streaming.getNumberOfUpdatedNormals ());
+
+  // raise a bump in the middle of the plane
+  for (size_t v = 200; v < 240; ++v)
+    for (size_t u = 300; u < 340; ++u)
+      (*frame) (u, v).z = 10.0f + 0.05f * sinf (static_cast<float> (u + v) * 0.2f);
+
+  streaming.setInputCloud (frame);
+  streaming.compute (output);
+  EXPECT_GT (streaming.getNumberOfUpdatedNormals (), 40u * 40u);
+  EXPECT_LT (streaming.getNumberOfUpdatedNormals (), output.points.size () / 4);
+
+  // the normals match those computed from scratch
+  IntegralImageNormalEstimation<PointXYZ, Normal> full;
+  full.setNormalEstimationMethod (full.COVARIANCE_MATRIX);
+  full.setInputCloud (frame);
+  PointCloud<Normal> full_output;
+  full.compute (full_output);
+
+  ASSERT_EQ (full_output.points.size (), output.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    if (!pcl_isfinite (full_output.points[i].normal_x))
+    {
+      EXPECT_FALSE (pcl_isfinite (output.points[i].normal_x));
+      continue;
+    }
+    EXPECT_NEAR (full_output.points[i].normal_x, output.points[i].normal_x, 1e-4);
+    EXPECT_NEAR (full_output.points[i].normal_y, output.points[i].normal_y, 1e-4);
+    EXPECT_NEAR (full_output.points[i].normal_z, output.points[i].normal_z, 1e-4);
+  }
+
+  // nothing changed: only the borders are set again
+  streaming.setInputCloud (frame);
+  streaming.compute (output);
+  EXPECT_LT (streaming.getNumberOfUpdatedNormals (), output.points.size () / 10);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IINormalEstimationSimple3DGradientUnorganized)
 {
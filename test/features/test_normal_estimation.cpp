@@ -176,6 +176,83 @@ TEST (PCL, NormalEstimationOpenMP)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalEstimationPlaneFitBatch)
+{
+  // Shift the cloud far from the origin, where the covariance matrices lose precision in single precision
+  PointCloud<PointXYZ> shifted = cloud;
+  for (size_t i = 0; i < shifted.points.size (); ++i)
+    shifted.points[i].getVector3fMap () += Eigen::Vector3f (100.0f, -50.0f, 20.0f);
+
+  KdTreePtr neighbors_tree (new search::KdTree<PointXYZ> (false));
+  neighbors_tree->setInputCloud (cloud.makeShared ());
+
+  const int k = 10;
+  vector<int> nn_indices;
+  vector<float> nn_dists;
+  normal_simd::PlaneFitBatch batch;
+  vector<vector<int> > batch_neighbors;
+  float nx[normal_simd::PACKET_SIZE], ny[normal_simd::PACKET_SIZE], nz[normal_simd::PACKET_SIZE];
+  float curvature[normal_simd::PACKET_SIZE];
+  for (size_t idx = 0; idx < indices.size (); ++idx)
+  {
+    neighbors_tree->nearestKSearch (indices[idx], k, nn_indices, nn_dists);
+    EXPECT_EQ (k, static_cast<int> (batch.addCovariance (shifted, nn_indices)));
+    batch_neighbors.push_back (nn_indices);
+    if (!batch.full () && idx + 1 < indices.size ())
+      continue;
+
+    batch.solvePlaneParameters (nx, ny, nz, curvature);
+    for (int i = 0; i < batch.size (); ++i)
+    {
+      // Compare with the plane fit in double precision
+      Eigen::Vector3d centroid = Eigen::Vector3d::Zero ();
+      for (size_t j = 0; j < batch_neighbors[i].size (); ++j)
+        centroid += shifted.points[batch_neighbors[i][j]].getVector3fMap ().cast<double> ();
+      centroid /= static_cast<double> (batch_neighbors[i].size ());
+      Eigen::Matrix3d covariance_matrix = Eigen::Matrix3d::Zero ();
+      for (size_t j = 0; j < batch_neighbors[i].size (); ++j)
+      {
+        Eigen::Vector3d d = shifted.points[batch_neighbors[i][j]].getVector3fMap ().cast<double> () - centroid;
+        covariance_matrix += d * d.transpose ();
+      }
+      covariance_matrix /= static_cast<double> (batch_neighbors[i].size ());
+      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (covariance_matrix);
+      Eigen::Vector3d normal = solver.eigenvectors ().col (0);
+      if (normal.dot (Eigen::Vector3d (nx[i], ny[i], nz[i])) < 0)
+        normal = -normal;
+
+      EXPECT_NEAR (nx[i], normal[0], 1e-4);
+      EXPECT_NEAR (ny[i], normal[1], 1e-4);
+      EXPECT_NEAR (nz[i], normal[2], 1e-4);
+      EXPECT_NEAR (curvature[i], solver.eigenvalues ()[0] / covariance_matrix.trace (), 1e-4);
+    }
+    batch.clear ();
+    batch_neighbors.clear ();
+  }
+  EXPECT_EQ (0, batch.size ());
+
+  // Degenerate neighborhoods fall back to pcl::solvePlaneParameters
+  PointCloud<PointXYZ> line;
+  for (int i = 0; i < 8; ++i)
+    line.points.push_back (PointXYZ (0.01f * static_cast<float> (i), 0.5f, 1.0f));
+  nn_indices.resize (line.points.size ());
+  for (int i = 0; i < static_cast<int> (nn_indices.size ()); ++i)
+    nn_indices[i] = i;
+  EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
+  Eigen::Vector4f xyz_centroid;
+  float lx, ly, lz, lcurvature;
+  computeMeanAndCovarianceMatrix (line, nn_indices, covariance_matrix, xyz_centroid);
+  solvePlaneParameters (covariance_matrix, lx, ly, lz, lcurvature);
+  batch.addCovariance (line, nn_indices);
+  batch.solvePlaneParameters (nx, ny, nz, curvature);
+  // A line has no unique normal, which pcl::solvePlaneParameters reports with NaN values
+  EXPECT_EQ (pcl_isfinite (lx), pcl_isfinite (nx[0]));
+  EXPECT_EQ (pcl_isfinite (ly), pcl_isfinite (ny[0]));
+  EXPECT_EQ (pcl_isfinite (lz), pcl_isfinite (nz[0]));
+  EXPECT_NEAR (curvature[0], lcurvature, 1e-4);
+}
+
 #ifndef PCL_ONLY_CORE_POINT_TYPES
   /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   TEST (PCL, NormalEstimationEigen)
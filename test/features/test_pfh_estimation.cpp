@@ -262,6 +262,107 @@ TEST (PCL, PFHEstimation)
   (cloud.makeShared (), normals, test_indices, 125);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PFHEstimationCache)
+{
+  // The cache is keyed by the unordered pair, and always gives the features computed from the smaller index
+  PairFeatureCache cache (100);
+  EXPECT_EQ (cache.getCapacity (), 64);
+  Eigen::Vector4f features;
+  EXPECT_FALSE (cache.find (3, 7, features));
+  cache.insert (7, 3, Eigen::Vector4f (1.0f, 2.0f, 3.0f, 4.0f));
+  ASSERT_TRUE (cache.find (3, 7, features));
+  EXPECT_EQ (features, Eigen::Vector4f (1.0f, 2.0f, 3.0f, 4.0f));
+  ASSERT_TRUE (cache.find (7, 3, features));
+  EXPECT_EQ (features, Eigen::Vector4f (1.0f, 2.0f, 3.0f, 4.0f));
+  cache.reset (64);
+  EXPECT_FALSE (cache.find (3, 7, features));
+
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  PFHEstimation<PointXYZ, Normal, PFHSignature125> pfh;
+  pfh.setInputCloud (cloud.makeShared ());
+  pfh.setInputNormals (normals);
+  pfh.setSearchMethod (tree);
+  pfh.setKSearch (20);
+
+  PointCloud<PFHSignature125> uncached, cached, threaded;
+  pfh.compute (uncached);
+  EXPECT_EQ (pfh.getCacheHitRate (), 0.0);
+
+  pfh.setUseInternalCache (true);
+  pfh.compute (cached);
+  double hit_rate = pfh.getCacheHitRate ();
+  EXPECT_GT (hit_rate, 0.5);
+  EXPECT_LE (hit_rate, 1.0);
+
+  // All the threads share the cache, and get the same features whoever computed the pair first
+  pfh.setNumberOfThreads (4);
+  pfh.compute (threaded);
+  EXPECT_NEAR (pfh.getCacheHitRate (), hit_rate, 0.05);
+
+  ASSERT_EQ (cached.size (), uncached.size ());
+  ASSERT_EQ (threaded.size (), uncached.size ());
+  for (size_t i = 0; i < cached.size (); ++i)
+  {
+    float sum = 0.0f;
+    for (int j = 0; j < 125; ++j)
+    {
+      ASSERT_EQ (cached.points[i].histogram[j], threaded.points[i].histogram[j]);
+      sum += cached.points[i].histogram[j];
+    }
+    EXPECT_NEAR (sum, 100.0f, 1e-2);
+  }
+
+  // Copies get their own cache, so they can compute on other clouds at the same time
+  PointCloud<PointXYZ>::Ptr half_cloud (new PointCloud<PointXYZ> ());
+  PointCloud<Normal>::Ptr half_normals (new PointCloud<Normal> ());
+  for (size_t i = 0; i < cloud.size (); i += 2)
+  {
+    half_cloud->push_back (cloud.points[i]);
+    half_normals->push_back (normals->points[i]);
+  }
+
+  PFHEstimation<PointXYZ, Normal, PFHSignature125> half_pfh (pfh);
+  half_pfh.setNumberOfThreads (1);
+  half_pfh.setInputCloud (half_cloud);
+  half_pfh.setInputNormals (half_normals);
+  half_pfh.setSearchMethod (KdTreePtr (new search::KdTree<PointXYZ> ()));
+
+  PointCloud<PFHSignature125> half_serial;
+  half_pfh.compute (half_serial);
+  const double half_hit_rate = half_pfh.getCacheHitRate ();
+  EXPECT_GT (half_hit_rate, 0.0);
+
+  pfh.compute (threaded);
+  EXPECT_EQ (half_pfh.getCacheHitRate (), half_hit_rate);
+
+  PointCloud<PFHSignature125> concurrent[2];
+#pragma omp parallel for num_threads(2)
+  for (int e = 0; e < 2; ++e)
+  {
+    if (e == 0)
+      pfh.compute (concurrent[e]);
+    else
+      half_pfh.compute (concurrent[e]);
+  }
+
+  ASSERT_EQ (concurrent[0].size (), cached.size ());
+  ASSERT_EQ (concurrent[1].size (), half_serial.size ());
+  for (size_t i = 0; i < cached.size (); ++i)
+    for (int j = 0; j < 125; ++j)
+      ASSERT_EQ (cached.points[i].histogram[j], concurrent[0].points[i].histogram[j]);
+  for (size_t i = 0; i < half_serial.size (); ++i)
+    for (int j = 0; j < 125; ++j)
+      ASSERT_EQ (half_serial.points[i].histogram[j], concurrent[1].points[i].histogram[j]);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, FPFHEstimation)
 {
@@ -499,6 +600,71 @@ TEST (PCL, FPFHEstimationOpenMP)
   (cloud.makeShared (), normals, test_indices, 33);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FPFHEstimationThreads)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  boost::shared_ptr<vector<int> > test_indices (new vector<int> (0));
+  for (size_t i = 0; i < cloud.size (); i+=3)
+    test_indices->push_back (static_cast<int> (i));
+
+  // Every point with the whole cloud as surface, and every third point, with k and radius neighborhoods
+  for (int test = 0; test < 4; ++test)
+  {
+    FPFHEstimation<PointXYZ, Normal, FPFHSignature33> fpfh;
+    FPFHEstimationOMP<PointXYZ, Normal, FPFHSignature33> fpfh_omp (4);
+    fpfh.setInputCloud (cloud.makeShared ());
+    fpfh_omp.setInputCloud (cloud.makeShared ());
+    fpfh.setInputNormals (normals);
+    fpfh_omp.setInputNormals (normals);
+    fpfh.setSearchMethod (tree);
+    fpfh_omp.setSearchMethod (tree);
+    if (test & 1)
+    {
+      fpfh.setIndices (test_indices);
+      fpfh_omp.setIndices (test_indices);
+    }
+    if (test & 2)
+    {
+      fpfh.setRadiusSearch (0.02);
+      fpfh_omp.setRadiusSearch (0.02);
+    }
+    else
+    {
+      fpfh.setKSearch (20);
+      fpfh_omp.setKSearch (20);
+    }
+
+    PointCloud<FPFHSignature33> serial, threaded, omp;
+    fpfh.compute (serial);
+    fpfh.setNumberOfThreads (4);
+    fpfh.compute (threaded);
+    fpfh_omp.compute (omp);
+
+    // The neighborhoods are searched once and shared by both steps, in any number of threads
+    ASSERT_EQ (serial.size (), test & 1 ? test_indices->size () : cloud.size ());
+    ASSERT_EQ (serial.size (), threaded.size ());
+    ASSERT_EQ (serial.size (), omp.size ());
+    EXPECT_EQ (serial.is_dense, threaded.is_dense);
+    EXPECT_EQ (serial.is_dense, omp.is_dense);
+    for (size_t i = 0; i < serial.size (); ++i)
+    {
+      for (int j = 0; j < 33; ++j)
+      {
+        ASSERT_EQ (serial.points[i].histogram[j], threaded.points[i].histogram[j]);
+        ASSERT_EQ (serial.points[i].histogram[j], omp.points[i].histogram[j]);
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, VFHEstimation)
 {
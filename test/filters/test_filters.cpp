@@ -46,6 +46,8 @@
 #include <pcl/filters/shadowpoints.h>
 #include <pcl/filters/sampling_surface_normal.h>
 #include <pcl/filters/voxel_grid.h>
+#include <pcl/filters/voxel_grid_omp.h>
+#include <pcl/filters/hash_voxel_grid.h>
 #include <pcl/filters/voxel_grid_covariance.h>
 #include <pcl/filters/extract_indices.h>
 #include <pcl/filters/project_inliers.h>
@@ -965,6 +967,154 @@ TEST (VoxelGrid_XYZNormal, Filters)
 
 #endif
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGridOMP, Filters)
+{
+  PointCloud<PointXYZ> output, output_omp;
+  VoxelGrid<PointXYZ> grid;
+  VoxelGridOMP<PointXYZ> grid_omp (4);
+
+  grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid.setInputCloud (cloud);
+  grid.filter (output);
+
+  grid_omp.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid_omp.setInputCloud (cloud);
+  grid_omp.filter (output_omp);
+
+  // The parallel filter must produce exactly the same centroids, in the same order
+  EXPECT_EQ (int (output_omp.points.size ()), 103);
+  EXPECT_EQ (int (output_omp.width), 103);
+  EXPECT_EQ (int (output_omp.height), 1);
+  EXPECT_EQ (bool (output_omp.is_dense), true);
+  ASSERT_EQ (output.points.size (), output_omp.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (output.points[i].x, output_omp.points[i].x);
+    EXPECT_EQ (output.points[i].y, output_omp.points[i].y);
+    EXPECT_EQ (output.points[i].z, output_omp.points[i].z);
+  }
+
+  grid.setFilterFieldName ("z");
+  grid.setFilterLimits (0.05, 0.1);
+  grid.setFilterLimitsNegative (true);
+  grid.setSaveLeafLayout (true);
+  grid.filter (output);
+
+  // Try a different number of threads than blocks of data
+  grid_omp.setNumberOfThreads (3);
+  grid_omp.setFilterFieldName ("z");
+  grid_omp.setFilterLimits (0.05, 0.1);
+  grid_omp.setFilterLimitsNegative (true);
+  grid_omp.setSaveLeafLayout (true);
+  grid_omp.filter (output_omp);
+
+  EXPECT_EQ (int (output_omp.points.size ()), 100);
+  ASSERT_EQ (output.points.size (), output_omp.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (output.points[i].x, output_omp.points[i].x);
+    EXPECT_EQ (output.points[i].y, output_omp.points[i].y);
+    EXPECT_EQ (output.points[i].z, output_omp.points[i].z);
+  }
+  EXPECT_EQ (grid.getLeafLayout (), grid_omp.getLeafLayout ());
+  EXPECT_EQ (grid_omp.getCentroidIndex (output_omp.points[0]), 0);
+  EXPECT_EQ (grid_omp.getCentroidIndex (output_omp.points[99]), 99);
+
+  // A grid with more than 2^32 cells only works with the 64-bit cell keys
+  PointCloud<PointXYZ>::Ptr sparse (new PointCloud<PointXYZ>);
+  sparse->points.push_back (PointXYZ (0.0f, 0.0f, 0.0f));
+  sparse->points.push_back (PointXYZ (0.0005f, 0.0f, 0.0f));
+  sparse->points.push_back (PointXYZ (1000.0f, 1000.0f, 1000.0f));
+  sparse->width = static_cast<uint32_t> (sparse->points.size ());
+  sparse->height = 1;
+
+  grid_omp.setFilterFieldName ("");
+  grid_omp.setSaveLeafLayout (false);
+  grid_omp.setLeafSize (0.001f, 0.001f, 0.001f);
+  grid_omp.setInputCloud (sparse);
+  grid_omp.filter (output_omp);
+
+  EXPECT_EQ (int (output_omp.points.size ()), 2);
+  EXPECT_NEAR (output_omp.points[0].x, 0.00025f, 1e-6);
+  EXPECT_NEAR (output_omp.points[1].x, 1000.0f, 1e-3);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (HashVoxelGrid, Filters)
+{
+  PointCloud<PointXYZ> output, output_hash;
+  VoxelGrid<PointXYZ> grid;
+  HashVoxelGrid<PointXYZ> grid_hash;
+
+  grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid.setSaveLeafLayout (true);
+  grid.setInputCloud (cloud);
+  grid.filter (output);
+
+  grid_hash.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid_hash.setInputCloud (cloud);
+  grid_hash.filter (output_hash);
+
+  EXPECT_EQ (int (output_hash.points.size ()), 103);
+  EXPECT_EQ (int (output_hash.width), 103);
+  EXPECT_EQ (int (output_hash.height), 1);
+  EXPECT_EQ (bool (output_hash.is_dense), true);
+  EXPECT_EQ (grid_hash.getNrOccupiedCells (), output_hash.points.size ());
+  EXPECT_EQ (grid.getMinBoxCoordinates (), grid_hash.getMinBoxCoordinates ());
+  EXPECT_EQ (grid.getMaxBoxCoordinates (), grid_hash.getMaxBoxCoordinates ());
+
+  // The order differs, but every input point must map to exactly the same centroid
+  for (size_t i = 0; i < cloud->points.size (); ++i)
+  {
+    int idx = grid.getCentroidIndex (cloud->points[i]);
+    int idx_hash = grid_hash.getCentroidIndex (cloud->points[i]);
+    ASSERT_NE (idx_hash, -1);
+    EXPECT_EQ (output.points[idx].x, output_hash.points[idx_hash].x);
+    EXPECT_EQ (output.points[idx].y, output_hash.points[idx_hash].y);
+    EXPECT_EQ (output.points[idx].z, output_hash.points[idx_hash].z);
+  }
+  EXPECT_EQ (grid_hash.getCentroidIndexAt (grid_hash.getGridCoordinates (-1, -1, -1)), -1);
+  EXPECT_EQ (grid_hash.getNeighborCentroidIndices (output_hash.points[0], Eigen::MatrixXi::Zero (3, 1))[0], 0);
+
+  // Filtering along a field, and reusing the hash table of the previous call
+  size_t table_size = grid_hash.getHashTableSize ();
+  grid.setFilterFieldName ("z");
+  grid.setFilterLimits (0.05, 0.1);
+  grid.filter (output);
+  grid_hash.setFilterFieldName ("z");
+  grid_hash.setFilterLimits (0.05, 0.1);
+  grid_hash.filter (output_hash);
+
+  EXPECT_EQ (int (output_hash.points.size ()), 14);
+  EXPECT_EQ (grid_hash.getHashTableSize (), table_size);
+  for (size_t i = 0; i < output_hash.points.size (); ++i)
+  {
+    int idx = grid.getCentroidIndex (output_hash.points[i]);
+    EXPECT_EQ (output.points[idx].x, output_hash.points[i].x);
+    EXPECT_EQ (output.points[idx].y, output_hash.points[i].y);
+    EXPECT_EQ (output.points[idx].z, output_hash.points[i].z);
+  }
+
+  // Cells far apart cost no more memory than cells close together
+  PointCloud<PointXYZ>::Ptr sparse (new PointCloud<PointXYZ>);
+  sparse->points.push_back (PointXYZ (-1e6f, -1e6f, -1e6f));
+  sparse->points.push_back (PointXYZ (1e6f + 0.25f, 1e6f, 1e6f));
+  sparse->points.push_back (PointXYZ (1e6f + 0.75f, 1e6f, 1e6f));
+  sparse->width = static_cast<uint32_t> (sparse->points.size ());
+  sparse->height = 1;
+
+  grid_hash.setFilterFieldName ("");
+  grid_hash.setLeafSize (1.0f, 1.0f, 1.0f);
+  grid_hash.setInputCloud (sparse);
+  grid_hash.filter (output_hash);
+
+  EXPECT_EQ (int (output_hash.points.size ()), 2);
+  EXPECT_EQ (grid_hash.getHashTableSize (), table_size);
+  EXPECT_EQ (output_hash.points[0].x, -1e6f);
+  EXPECT_EQ (output_hash.points[1].x, 1e6f + 0.5f);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (VoxelGridCovariance, Filters)
 {
@@ -44,6 +44,8 @@
 #include <pcl/common/io.h>
 #include <pcl/console/print.h>
 #include <pcl/io/pcd_io.h>
+#include <pcl/io/pcd_mapped_cloud.h>
+#include <pcl/io/pcd_stream.h>
 #include <pcl/io/ply_io.h>
 #include <fstream>
 #include <locale>
@@ -720,6 +722,310 @@ TEST (PCL, PCDReaderWriter)
   EXPECT_FLOAT_EQ (cloud.points[nr_p - 1].intensity, last.intensity); // test for fromROSMsg ()
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCDMappedCloud)
+{
+  PointCloud<PointXYZI> cloud;
+  cloud.width  = 64;
+  cloud.height = 48;
+  cloud.points.resize (cloud.width * cloud.height);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    cloud.points[i].x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].intensity = static_cast<float> (i);
+  }
+
+  PCDWriter writer;
+  sensor_msgs::PointCloud2 cloud_blob;
+  toROSMsg (cloud, cloud_blob);
+  writer.writeBinary ("test_pcl_io_mapped_blob.pcd", cloud_blob);
+  // The aligned writer keeps the memory layout of PointXYZI: the mapped points
+  // can be used in place
+  writer.writeBinaryAligned ("test_pcl_io_mapped.pcd", cloud);
+  std::vector<int> indices (cloud.points.size () / 2);
+  for (size_t i = 0; i < indices.size (); ++i)
+    indices[i] = static_cast<int> (2 * i + 1);
+  writer.writeBinaryAligned ("test_pcl_io_mapped_indices.pcd", cloud, indices);
+  writer.writeBinary ("test_pcl_io_mapped_packed.pcd", cloud);
+  writer.writeBinaryCompressed ("test_pcl_io_mapped_compressed.pcd", cloud);
+
+  PCDMappedCloud<PointXYZI> mapped;
+  ASSERT_EQ (mapped.open ("test_pcl_io_mapped.pcd"), 0);
+  EXPECT_TRUE (mapped.isDirect ());
+  EXPECT_EQ (mapped.width (), cloud.width);
+  EXPECT_EQ (mapped.height (), cloud.height);
+  ASSERT_EQ (mapped.size (), cloud.points.size ());
+  EXPECT_EQ (size_t (mapped.end () - mapped.begin ()), cloud.points.size ());
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    EXPECT_EQ (mapped[i].x, cloud.points[i].x);
+    EXPECT_EQ (mapped[i].y, cloud.points[i].y);
+    EXPECT_EQ (mapped[i].z, cloud.points[i].z);
+    EXPECT_EQ (mapped[i].intensity, cloud.points[i].intensity);
+  }
+
+  PCDMappedCloud<PointXYZI> mapped_blob;
+  ASSERT_EQ (mapped_blob.open ("test_pcl_io_mapped_blob.pcd"), 0);
+  EXPECT_TRUE (mapped_blob.isDirect ());
+  ASSERT_EQ (mapped_blob.size (), cloud.points.size ());
+  EXPECT_EQ (mapped_blob[cloud.points.size () - 1].intensity, cloud.points.back ().intensity);
+
+  PCDMappedCloud<PointXYZI> mapped_indices;
+  ASSERT_EQ (mapped_indices.open ("test_pcl_io_mapped_indices.pcd"), 0);
+  EXPECT_TRUE (mapped_indices.isDirect ());
+  ASSERT_EQ (mapped_indices.size (), indices.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+    EXPECT_EQ (mapped_indices[i].intensity, cloud.points[indices[i]].intensity);
+
+  // A type with a different layout has its points assembled
+  PCDMappedCloud<PointXYZ> xyz;
+  ASSERT_EQ (xyz.open ("test_pcl_io_mapped.pcd"), 0);
+  EXPECT_FALSE (xyz.isDirect ());
+  ASSERT_EQ (xyz.size (), cloud.points.size ());
+  PCDMappedFieldView<float> intensity = xyz.getFieldView<float> ("intensity");
+  ASSERT_FALSE (intensity.empty ());
+  EXPECT_EQ (intensity.stride (), sizeof (PointXYZI));
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    PointXYZ p = xyz.at (i);
+    EXPECT_EQ (p.x, cloud.points[i].x);
+    EXPECT_EQ (p.y, cloud.points[i].y);
+    EXPECT_EQ (p.z, cloud.points[i].z);
+    EXPECT_EQ (intensity[i], cloud.points[i].intensity);
+  }
+  EXPECT_TRUE (xyz.getFieldView<float> ("rgb").empty ());
+  EXPECT_TRUE (xyz.getFieldView<double> ("x").empty ());
+
+  // Several typed views can share a single mapping
+  PCDMappedCloud<PointXYZI> shared;
+  ASSERT_EQ (shared.setInputFile (xyz.getInputFile ()), 0);
+  EXPECT_TRUE (shared.isDirect ());
+  EXPECT_EQ (shared[cloud.points.size () - 1].intensity, cloud.points.back ().intensity);
+
+  PointCloud<PointXYZ> copy;
+  xyz.copyTo (copy);
+  ASSERT_EQ (copy.points.size (), cloud.points.size ());
+  EXPECT_EQ (copy.width, cloud.width);
+  EXPECT_EQ (copy.points.back ().z, cloud.points.back ().z);
+
+  // The default binary writer packs the fields, so the points are assembled
+  PCDMappedCloud<PointXYZI> packed;
+  ASSERT_EQ (packed.open ("test_pcl_io_mapped_packed.pcd"), 0);
+  EXPECT_FALSE (packed.isDirect ());
+  ASSERT_EQ (packed.size (), cloud.points.size ());
+  EXPECT_EQ (packed.at (cloud.points.size () - 1).intensity, cloud.points.back ().intensity);
+
+  // The padding of the aligned points is written as zeros
+  EXPECT_EQ (mapped[0].data[3], 0.0f);
+  EXPECT_EQ (mapped[0].data_c[1], 0.0f);
+  EXPECT_EQ (mapped[0].data_c[3], 0.0f);
+
+  // Compressed files cannot be mapped
+  PCDMappedCloud<PointXYZI> compressed;
+  EXPECT_LT (compressed.open ("test_pcl_io_mapped_compressed.pcd"), 0);
+  EXPECT_EQ (compressed.size (), 0u);
+
+  // The regular reader still reads the padded header
+  PointCloud<PointXYZI> cloud_in;
+  ASSERT_EQ (loadPCDFile ("test_pcl_io_mapped.pcd", cloud_in), 0);
+  ASSERT_EQ (cloud_in.points.size (), cloud.points.size ());
+  EXPECT_EQ (cloud_in.width, cloud.width);
+  EXPECT_EQ (cloud_in.points.back ().intensity, cloud.points.back ().intensity);
+
+  // The fields of PointXYZRGBNormal are not registered in the order of their offsets
+  PointCloud<PointXYZRGBNormal> normals;
+  normals.width  = 10;
+  normals.height = 1;
+  normals.points.resize (normals.width);
+  for (size_t i = 0; i < normals.points.size (); ++i)
+  {
+    normals.points[i].x = normals.points[i].normal_x = static_cast<float> (i);
+    normals.points[i].y = normals.points[i].normal_y = static_cast<float> (2 * i);
+    normals.points[i].z = normals.points[i].normal_z = static_cast<float> (3 * i);
+    normals.points[i].rgb = static_cast<float> (4 * i);
+    normals.points[i].curvature = static_cast<float> (5 * i);
+  }
+  writer.writeBinaryAligned ("test_pcl_io_mapped_normals.pcd", normals);
+  PCDMappedCloud<PointXYZRGBNormal> mapped_normals;
+  ASSERT_EQ (mapped_normals.open ("test_pcl_io_mapped_normals.pcd"), 0);
+  EXPECT_TRUE (mapped_normals.isDirect ());
+  PointCloud<PointXYZRGBNormal> normals_in;
+  ASSERT_EQ (loadPCDFile ("test_pcl_io_mapped_normals.pcd", normals_in), 0);
+  ASSERT_EQ (normals_in.points.size (), normals.points.size ());
+  for (size_t i = 0; i < normals.points.size (); ++i)
+  {
+    EXPECT_EQ (mapped_normals[i].normal_y, normals.points[i].normal_y);
+    EXPECT_EQ (mapped_normals[i].rgb, normals.points[i].rgb);
+    EXPECT_EQ (normals_in.points[i].z, normals.points[i].z);
+    EXPECT_EQ (normals_in.points[i].normal_z, normals.points[i].normal_z);
+    EXPECT_EQ (normals_in.points[i].rgb, normals.points[i].rgb);
+    EXPECT_EQ (normals_in.points[i].curvature, normals.points[i].curvature);
+  }
+
+  remove ("test_pcl_io_mapped.pcd");
+  remove ("test_pcl_io_mapped_blob.pcd");
+  remove ("test_pcl_io_mapped_indices.pcd");
+  remove ("test_pcl_io_mapped_packed.pcd");
+  remove ("test_pcl_io_mapped_compressed.pcd");
+  remove ("test_pcl_io_mapped_normals.pcd");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCDReaderWriterChunked)
+{
+  PointCloud<PointXYZI> cloud;
+  cloud.width  = 10007;
+  cloud.height = 1;
+  cloud.points.resize (cloud.width * cloud.height);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    // Random coordinates do not compress, the intensity planes do
+    cloud.points[i].x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].intensity = static_cast<float> (i / 1000);
+  }
+
+  PCDWriter writer;
+  writer.setNumberOfThreads (4);
+  writer.setChunkSize (1000);
+  EXPECT_EQ (writer.getChunkSize (), 1000u);
+  ASSERT_EQ (writer.writeBinaryChunked ("test_pcl_io_chunked.pcd", cloud), 0);
+  writer.writeBinary ("test_pcl_io_chunked_binary.pcd", cloud);
+
+  PCDReader reader;
+  reader.setNumberOfThreads (4);
+  PointCloud<PointXYZI> cloud_in;
+  ASSERT_EQ (reader.read ("test_pcl_io_chunked.pcd", cloud_in), 0);
+  ASSERT_EQ (cloud_in.points.size (), cloud.points.size ());
+  EXPECT_EQ (cloud_in.width, cloud.width);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    EXPECT_EQ (cloud_in.points[i].x, cloud.points[i].x);
+    EXPECT_EQ (cloud_in.points[i].y, cloud.points[i].y);
+    EXPECT_EQ (cloud_in.points[i].z, cloud.points[i].z);
+    EXPECT_EQ (cloud_in.points[i].intensity, cloud.points[i].intensity);
+  }
+
+  // Ranges spanning several chunks, a single chunk, and the last partial chunk
+  const unsigned int ranges[][2] = { {1500, 3000}, {2000, 1000}, {9990, 17}, {0, 1} };
+  const char* files[] = { "test_pcl_io_chunked.pcd", "test_pcl_io_chunked_binary.pcd" };
+  for (int f = 0; f < 2; ++f)
+  {
+    for (int r = 0; r < 4; ++r)
+    {
+      PointCloud<PointXYZI> range;
+      ASSERT_EQ (reader.readPointRange (files[f], ranges[r][0], ranges[r][1], range), 0);
+      ASSERT_EQ (range.points.size (), ranges[r][1]);
+      for (size_t i = 0; i < range.points.size (); ++i)
+      {
+        EXPECT_EQ (range.points[i].x, cloud.points[ranges[r][0] + i].x);
+        EXPECT_EQ (range.points[i].intensity, cloud.points[ranges[r][0] + i].intensity);
+      }
+    }
+  }
+  PointCloud<PointXYZI> out_of_range;
+  EXPECT_LT (reader.readPointRange ("test_pcl_io_chunked.pcd", 10000, 8, out_of_range), 0);
+
+  remove ("test_pcl_io_chunked.pcd");
+  remove ("test_pcl_io_chunked_binary.pcd");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCDStreamReaderWriter)
+{
+  PointCloud<PointXYZRGB> cloud;
+  cloud.width  = 10000;
+  cloud.height = 1;
+  cloud.points.resize (cloud.width * cloud.height);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    cloud.points[i].x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].z = static_cast<float> (i);
+    cloud.points[i].r = static_cast<uint8_t> (i % 255);
+    cloud.points[i].g = 10;
+    cloud.points[i].b = 20;
+    cloud.points[i].a = 0;
+  }
+
+  const PCDStreamWriter::DataType types[] = { PCDStreamWriter::ASCII, PCDStreamWriter::BINARY, PCDStreamWriter::BINARY_CHUNKED };
+  for (int t = 0; t < 3; ++t)
+  {
+    // Append the cloud in uneven batches
+    PCDStreamWriter writer;
+    writer.setChunkSize (t == 2 ? 4 : 1000);  // many small chunks: the index is written after the data
+    ASSERT_EQ (writer.open<PointXYZRGB> ("test_pcl_io_stream.pcd", types[t]), 0);
+    for (size_t first = 0; first < cloud.points.size (); first += 777)
+    {
+      PointCloud<PointXYZRGB> batch;
+      for (size_t i = first; i < std::min (first + 777, cloud.points.size ()); ++i)
+        batch.points.push_back (cloud.points[i]);
+      batch.width = static_cast<uint32_t> (batch.points.size ());
+      batch.height = 1;
+      ASSERT_EQ (writer.write (batch), 0);
+    }
+    EXPECT_EQ (writer.getNumberOfPoints (), cloud.points.size ());
+    ASSERT_EQ (writer.close (), 0);
+
+    // The header has been patched: the regular reader sees all points
+    PointCloud<PointXYZRGB> cloud_in;
+    ASSERT_EQ (loadPCDFile ("test_pcl_io_stream.pcd", cloud_in), 0);
+    ASSERT_EQ (cloud_in.points.size (), cloud.points.size ());
+    EXPECT_EQ (cloud_in.width, cloud.width);
+    EXPECT_EQ (cloud_in.points.back ().z, cloud.points.back ().z);
+    EXPECT_EQ (cloud_in.points.back ().rgba, cloud.points.back ().rgba);
+    PointCloud<PointXYZRGB> range;
+    ASSERT_EQ (PCDReader ().readPointRange ("test_pcl_io_stream.pcd", 6543, 21, range), 0);
+    ASSERT_EQ (range.points.size (), size_t (21));
+    EXPECT_EQ (range.points[20].z, cloud.points[6563].z);
+
+    // Read it back in batches
+    PCDStreamReader reader;
+    ASSERT_EQ (reader.open ("test_pcl_io_stream.pcd"), 0);
+    EXPECT_EQ (reader.getNumberOfPoints (), cloud.points.size ());
+    size_t nr_read = 0;
+    PointCloud<PointXYZRGB> batch;
+    int res;
+    while ((res = reader.read (batch, 1234)) > 0)
+    {
+      ASSERT_EQ (batch.points.size (), size_t (res));
+      for (size_t i = 0; i < batch.points.size (); ++i)
+      {
+        EXPECT_FLOAT_EQ (batch.points[i].x, cloud.points[nr_read + i].x);
+        EXPECT_EQ (batch.points[i].z, cloud.points[nr_read + i].z);
+        EXPECT_EQ (batch.points[i].rgba, cloud.points[nr_read + i].rgba);
+      }
+      nr_read += batch.points.size ();
+    }
+    EXPECT_EQ (res, 0);
+    EXPECT_EQ (nr_read, cloud.points.size ());
+    EXPECT_TRUE (reader.eof ());
+
+    // Seek backwards and forwards
+    ASSERT_EQ (reader.seek (5000), 0);
+    ASSERT_EQ (reader.read (batch, 3), 3);
+    EXPECT_EQ (batch.points[0].z, cloud.points[5000].z);
+    ASSERT_EQ (reader.seek (9999), 0);
+    ASSERT_EQ (reader.read (batch, 3), 1);
+    EXPECT_EQ (batch.points[0].z, cloud.points[9999].z);
+    EXPECT_LT (reader.seek (10001), 0);
+  }
+
+  // binary_compressed files are decoded on the first read
+  PCDWriter w;
+  w.writeBinaryCompressed ("test_pcl_io_stream.pcd", cloud);
+  PCDStreamReader reader;
+  ASSERT_EQ (reader.open ("test_pcl_io_stream.pcd"), 0);
+  PointCloud<PointXYZRGB> batch;
+  ASSERT_EQ (reader.seek (4321), 0);
+  ASSERT_EQ (reader.read (batch, 100), 100);
+  EXPECT_EQ (batch.points[99].z, cloud.points[4420].z);
+  remove ("test_pcl_io_stream.pcd");
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PCDReaderWriterEigen)
 {
@@ -0,0 +1,299 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/octree/octree.h>
+#include <pcl/octree/octree_impl.h>
+#include <pcl/compression/entropy_range_coder.h>
+#include <pcl/compression/impl/entropy_range_coder.hpp>
+#include <pcl/compression/octree_occupancy_coder.h>
+#include <pcl/compression/impl/octree_occupancy_coder.hpp>
+#include <pcl/compression/octree_pointcloud_compression.h>
+#include <pcl/compression/impl/octree_pointcloud_compression.hpp>
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace pcl;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static std::string
+encodeCloud (const PointCloud<PointXYZRGB>::ConstPtr& cloud, unsigned int threads)
+{
+  io::OctreePointCloudCompression<PointXYZRGB> encoder (io::MED_RES_ONLINE_COMPRESSION_WITH_COLOR, false);
+  encoder.setNumberOfThreads (threads);
+
+  std::stringstream compressedData;
+  encoder.encodePointCloud (cloud, compressedData);
+  return (compressedData.str ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static PointCloud<PointXYZRGB>::Ptr
+decodeCloud (const std::string& data, unsigned int threads)
+{
+  io::OctreePointCloudCompression<PointXYZRGB> decoder;
+  decoder.setNumberOfThreads (threads);
+
+  PointCloud<PointXYZRGB>::Ptr cloud (new PointCloud<PointXYZRGB>);
+  std::stringstream compressedData (data);
+  decoder.decodePointCloud (compressedData, cloud);
+  return (cloud);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Compression_Segments_Test)
+{
+  const unsigned int pointCount = 100000;
+
+  PointCloud<PointXYZRGB>::Ptr cloud (new PointCloud<PointXYZRGB>);
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  // generate random point cloud
+  for (unsigned int i = 0; i < pointCount; i++)
+  {
+    PointXYZRGB point;
+    point.x = static_cast<float> (2.0 * rand () / RAND_MAX);
+    point.y = static_cast<float> (2.0 * rand () / RAND_MAX);
+    point.z = static_cast<float> (2.0 * rand () / RAND_MAX);
+    point.r = static_cast<uint8_t> (255.0 * point.x / 2.0);
+    point.g = static_cast<uint8_t> (255.0 * point.y / 2.0);
+    point.b = static_cast<uint8_t> (255.0 * point.z / 2.0);
+    cloud->push_back (point);
+  }
+
+  // a single thread stores every data vector in one segment, more threads split it into several segments
+  std::string singleSegmentData = encodeCloud (cloud, 1);
+  std::string multiSegmentData = encodeCloud (cloud, 4);
+
+  PointCloud<PointXYZRGB>::Ptr singleSegmentCloud = decodeCloud (singleSegmentData, 1);
+  PointCloud<PointXYZRGB>::Ptr multiSegmentCloud = decodeCloud (multiSegmentData, 4);
+  PointCloud<PointXYZRGB>::Ptr crossCloud = decodeCloud (multiSegmentData, 1);
+
+  ASSERT_EQ (singleSegmentCloud->points.size (), cloud->points.size ());
+  ASSERT_EQ (multiSegmentCloud->points.size (), singleSegmentCloud->points.size ());
+  ASSERT_EQ (crossCloud->points.size (), singleSegmentCloud->points.size ());
+
+  // the segmentation must not change the decoded point cloud
+  for (size_t i = 0; i < singleSegmentCloud->points.size (); i++)
+  {
+    const PointXYZRGB& a = singleSegmentCloud->points[i];
+    const PointXYZRGB& b = multiSegmentCloud->points[i];
+    const PointXYZRGB& c = crossCloud->points[i];
+
+    EXPECT_EQ (a.x, b.x);
+    EXPECT_EQ (a.y, b.y);
+    EXPECT_EQ (a.z, b.z);
+    EXPECT_EQ (a.rgba, b.rgba);
+
+    EXPECT_EQ (a.x, c.x);
+    EXPECT_EQ (a.y, c.y);
+    EXPECT_EQ (a.z, c.z);
+    EXPECT_EQ (a.rgba, c.rgba);
+  }
+
+  // decoded points lie in the neighborhood of the input points
+  octree::OctreePointCloudSearch<PointXYZRGB> octree (0.1);
+  octree.setInputCloud (cloud);
+  octree.addPointsFromInputCloud ();
+
+  for (size_t i = 0; i < singleSegmentCloud->points.size (); i += 100)
+  {
+    std::vector<int> k_indices;
+    std::vector<float> k_sqr_distances;
+    octree.nearestKSearch (singleSegmentCloud->points[i], 1, k_indices, k_sqr_distances);
+
+    ASSERT_EQ (k_indices.size (), 1u);
+    EXPECT_LE (k_sqr_distances[0], 3.0f * 0.005f * 0.005f);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Compression_Context_Adaptive_Tree_Test)
+{
+  const unsigned int pointCount = 20000;
+  const unsigned int frameCount = 4;
+
+  io::OctreePointCloudCompression<PointXYZRGB> staticEncoder (io::MED_RES_ONLINE_COMPRESSION_WITH_COLOR, false);
+  io::OctreePointCloudCompression<PointXYZRGB> contextEncoder (io::MED_RES_ONLINE_COMPRESSION_WITH_COLOR, false);
+  io::OctreePointCloudCompression<PointXYZRGB> staticDecoder;
+  io::OctreePointCloudCompression<PointXYZRGB> contextDecoder;
+
+  contextEncoder.setContextAdaptiveTreeCoding (true);
+  EXPECT_TRUE (contextEncoder.getContextAdaptiveTreeCoding ());
+  EXPECT_FALSE (staticEncoder.getContextAdaptiveTreeCoding ());
+
+  PointCloud<PointXYZRGB>::Ptr cloud (new PointCloud<PointXYZRGB>);
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  // generate random point cloud
+  for (unsigned int i = 0; i < pointCount; i++)
+  {
+    PointXYZRGB point;
+    point.x = static_cast<float> (1.0 * rand () / RAND_MAX);
+    point.y = static_cast<float> (1.0 * rand () / RAND_MAX);
+    point.z = static_cast<float> (0.1 * rand () / RAND_MAX);
+    point.rgba = static_cast<uint32_t> (rand ());
+    cloud->push_back (point);
+  }
+
+  // the first frame is an I-frame, the following frames are XOR encoded P-frames
+  for (unsigned int frame = 0; frame < frameCount; frame++)
+  {
+    PointCloud<PointXYZRGB>::Ptr frameCloud (new PointCloud<PointXYZRGB>);
+    for (unsigned int i = 0; i < pointCount; i++)
+    {
+      // drop and move some of the points in every frame
+      if (rand () % 10 == 0)
+        continue;
+      PointXYZRGB point = cloud->points[i];
+      point.x += 0.01f * static_cast<float> (frame);
+      frameCloud->push_back (point);
+    }
+
+    std::stringstream staticData, contextData;
+    staticEncoder.encodePointCloud (frameCloud, staticData);
+    contextEncoder.encodePointCloud (frameCloud, contextData);
+
+    PointCloud<PointXYZRGB>::Ptr staticCloud (new PointCloud<PointXYZRGB>);
+    PointCloud<PointXYZRGB>::Ptr contextCloud (new PointCloud<PointXYZRGB>);
+    staticDecoder.decodePointCloud (staticData, staticCloud);
+    contextDecoder.decodePointCloud (contextData, contextCloud);
+
+    // the tree coder must not change the decoded point cloud
+    ASSERT_EQ (staticCloud->points.size (), frameCloud->points.size ());
+    ASSERT_EQ (contextCloud->points.size (), staticCloud->points.size ());
+
+    for (size_t i = 0; i < staticCloud->points.size (); i++)
+    {
+      EXPECT_EQ (staticCloud->points[i].x, contextCloud->points[i].x);
+      EXPECT_EQ (staticCloud->points[i].y, contextCloud->points[i].y);
+      EXPECT_EQ (staticCloud->points[i].z, contextCloud->points[i].z);
+      EXPECT_EQ (staticCloud->points[i].rgba, contextCloud->points[i].rgba);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Compression_Legacy_Stream_Test)
+{
+  const unsigned int pointCount = 20000;
+
+  PointCloud<PointXYZRGB>::Ptr cloud (new PointCloud<PointXYZRGB>);
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  // generate random point cloud
+  for (unsigned int i = 0; i < pointCount; i++)
+  {
+    PointXYZRGB point;
+    point.x = static_cast<float> (1.0 * rand () / RAND_MAX);
+    point.y = static_cast<float> (1.0 * rand () / RAND_MAX);
+    point.z = static_cast<float> (0.1 * rand () / RAND_MAX);
+    point.rgba = static_cast<uint32_t> (rand ());
+    cloud->push_back (point);
+  }
+
+  // with a single thread every data vector is one segment, which is coded exactly like a legacy data vector
+  const std::string data = encodeCloud (cloud, 1);
+  const std::string headerId = "<PCL-OCT-COMPRESSED-V2>";
+  const std::string legacyHeaderId = "<PCL-OCT-COMPRESSED>";
+  ASSERT_EQ (data.compare (0, headerId.size (), headerId), 0);
+
+  // frame ID, frame type, voxel grid and color flags precede the context-adaptive flag, which legacy frames lack
+  const size_t flagsLen = sizeof (uint32_t) + 3 * sizeof (bool);
+  const size_t configLen = sizeof (uint64_t) + 2 * sizeof (double) + sizeof (unsigned char) + 6 * sizeof (double);
+  size_t pos = headerId.size ();
+
+  std::string legacyData = legacyHeaderId + data.substr (pos, flagsLen);
+  pos += flagsLen + sizeof (bool);
+  legacyData += data.substr (pos, configLen);
+  pos += configLen;
+
+  // tree, average color, points per voxel, differential point and differential color vectors
+  for (int i = 0; i < 5; i++)
+  {
+    uint64_t dataVector_size;
+    unsigned char segmentCount;
+    memcpy (&dataVector_size, &data[pos], sizeof (dataVector_size));
+    memcpy (&segmentCount, &data[pos + sizeof (dataVector_size)], sizeof (segmentCount));
+    legacyData += data.substr (pos, sizeof (dataVector_size));
+    pos += sizeof (dataVector_size) + sizeof (segmentCount);
+
+    if (segmentCount)
+    {
+      ASSERT_EQ (segmentCount, 1);
+      uint64_t compressedData_size;
+      memcpy (&compressedData_size, &data[pos + sizeof (uint64_t)], sizeof (compressedData_size));
+      pos += 2 * sizeof (uint64_t);
+      legacyData += data.substr (pos, static_cast<size_t> (compressedData_size));
+      pos += static_cast<size_t> (compressedData_size);
+    }
+    else
+    {
+      std::ostringstream emptyData;
+      std::vector<char> emptyVector;
+      StaticRangeCoder entropyCoder;
+      entropyCoder.encodeCharVectorToStream (emptyVector, emptyData);
+      legacyData += emptyData.str ();
+    }
+  }
+  ASSERT_EQ (pos, data.size ());
+
+  PointCloud<PointXYZRGB>::Ptr decodedCloud = decodeCloud (data, 1);
+  PointCloud<PointXYZRGB>::Ptr legacyCloud = decodeCloud (legacyData, 1);
+
+  ASSERT_EQ (decodedCloud->points.size (), cloud->points.size ());
+  ASSERT_EQ (legacyCloud->points.size (), decodedCloud->points.size ());
+
+  for (size_t i = 0; i < decodedCloud->points.size (); i++)
+  {
+    EXPECT_EQ (decodedCloud->points[i].x, legacyCloud->points[i].x);
+    EXPECT_EQ (decodedCloud->points[i].y, legacyCloud->points[i].y);
+    EXPECT_EQ (decodedCloud->points[i].z, legacyCloud->points[i].z);
+    EXPECT_EQ (decodedCloud->points[i].rgba, legacyCloud->points[i].rgba);
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -39,6 +39,7 @@
 #include <gtest/gtest.h>
 #include <iostream>  // For debug
 #include <map>
+#include <set>
 #include <pcl/common/time.h>
 #include <pcl/kdtree/kdtree_flann.h>
 #include <pcl/point_cloud.h>
@@ -267,7 +268,83 @@ TEST (PCL, KdTreeFLANN_nearestKSearch)
   }
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTreeFLANN_batchSearch)
+{
+  // Build the tree on a subset of the points, so that the returned indices need to be mapped
+  boost::shared_ptr<vector<int> > tree_indices (new vector<int>);
+  for (int i = 0; i < static_cast<int> (cloud.points.size ()); i += 2)
+    tree_indices->push_back (i);
+
+  KdTreeFLANN<MyPoint> kdtree;
+  kdtree.setNumberOfThreads (2);
+  EXPECT_EQ (kdtree.getNumberOfThreads (), 2u);
+  kdtree.setInputCloud (cloud.makeShared (), tree_indices);
+
+  PointCloud<MyPoint> queries (cloud);
+  queries.points[3].x = numeric_limits<float>::quiet_NaN ();
+  vector<int> query_indices;
+  for (int i = 0; i < static_cast<int> (queries.points.size ()); i += 3)
+    query_indices.push_back (i);
+
+  const int k = 10;
+  NeighborsCSR knn;
+  int nr_found = kdtree.nearestKSearch (queries, query_indices, k, knn);
+  ASSERT_EQ (knn.size (), query_indices.size ());
+  EXPECT_EQ (nr_found, k * static_cast<int> (query_indices.size () - 1));
+  EXPECT_EQ (knn.indices.size (), static_cast<size_t> (nr_found));
+  EXPECT_EQ (knn.getNumberOfNeighbors (1), 0);       // the NaN query
+
+  vector<int> k_indices (k);
+  vector<float> k_distances (k);
+  for (size_t i = 0; i < query_indices.size (); ++i)
+  {
+    if (i == 1)
+      continue;
+    kdtree.nearestKSearch (queries.points[query_indices[i]], k, k_indices, k_distances);
+    ASSERT_EQ (knn.getNumberOfNeighbors (i), k);
+    for (int j = 0; j < k; ++j)
+    {
+      EXPECT_NEAR (knn.sqr_distances[knn.offsets[i] + j], k_distances[j], 1e-6);
+      EXPECT_EQ (knn.indices[knn.offsets[i] + j] % 2, 0);
+    }
+  }
+
+  const double radius = 0.15;
+  NeighborsCSR radius_neighbors;
+  nr_found = kdtree.radiusSearch (queries, vector<int> (), radius, radius_neighbors);
+  ASSERT_EQ (radius_neighbors.size (), queries.points.size ());
+  EXPECT_EQ (radius_neighbors.offsets.back (), nr_found);
+  EXPECT_EQ (radius_neighbors.getNumberOfNeighbors (3), 0);
+
+  for (size_t i = 0; i < queries.points.size (); ++i)
+  {
+    if (i == 3)
+      continue;
+    int nr_single = kdtree.radiusSearch (queries.points[i], radius, k_indices, k_distances);
+    ASSERT_EQ (radius_neighbors.getNumberOfNeighbors (i), nr_single);
+    set<int> single (k_indices.begin (), k_indices.end ());
+    for (int j = radius_neighbors.offsets[i]; j < radius_neighbors.offsets[i + 1]; ++j)
+    {
+      EXPECT_TRUE (single.count (radius_neighbors.indices[j]) == 1);
+      EXPECT_LE (radius_neighbors.sqr_distances[j], radius * radius);
+    }
+  }
+
+  // Bounded radius search
+  kdtree.radiusSearch (queries, query_indices, radius, radius_neighbors, 5);
+  for (size_t i = 0; i < radius_neighbors.size (); ++i)
+    EXPECT_LE (radius_neighbors.getNumberOfNeighbors (i), 5);
+
+  ScopeTime scopeTime ("FLANN batch nearestKSearch");
+  {
+    KdTreeFLANN<MyPoint> kdtree;
+    kdtree.setInputCloud (cloud_big.makeShared ());
+    kdtree.nearestKSearch (cloud_big, vector<int> (), 20, knn);
+  }
+}
+
+//////
 TEST (PCL, KdTreeFLANN_nearestKSearchEigen)
 {
   KdTreeFLANN<Eigen::MatrixXf> kdtree;
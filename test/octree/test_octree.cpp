@@ -1161,6 +1161,244 @@ TEST (PCL, Octree_Pointcloud_Voxel_Centroid_Test)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Bulk_Build_Test)
+{
+  const int pointcount = 5000;
+  const double resolution = 0.1;
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> (pointcount, 1));
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  // generate point data for point cloud, with duplicate voxels and an invalid point
+  for (int i = 0; i < pointcount; i++)
+    cloudIn->points[i] = PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX - 5.0),
+                                   static_cast<float> (10.0 * rand () / RAND_MAX - 5.0),
+                                   static_cast<float> (2.0 * rand () / RAND_MAX));
+  cloudIn->points[pointcount / 2].x = std::numeric_limits<float>::quiet_NaN ();
+
+  // bulk build with and without predefined bounding box, with one and several threads
+  for (int run = 0; run < 4; run++)
+  {
+    OctreePointCloudPointVector<PointXYZ> octreeA (resolution);
+    OctreePointCloudPointVector<PointXYZ> octreeB (resolution);
+    if (run & 1)
+    {
+      octreeA.defineBoundingBox (-5.0, -5.0, -5.0, 5.0, 5.0, 5.0);
+      octreeB.defineBoundingBox (-5.0, -5.0, -5.0, 5.0, 5.0, 5.0);
+    }
+    octreeB.setNumberOfThreads ((run & 2) ? 4 : 1);
+
+    octreeA.setInputCloud (cloudIn);
+    octreeB.setInputCloud (cloudIn);
+    octreeA.addPointsFromInputCloud ();
+    octreeB.addPointsFromInputCloudBulk ();
+
+    ASSERT_EQ (octreeA.getTreeDepth (), octreeB.getTreeDepth ());
+    ASSERT_EQ (octreeA.getLeafCount (), octreeB.getLeafCount ());
+    ASSERT_EQ (octreeA.getBranchCount (), octreeB.getBranchCount ());
+
+    double minXA, minYA, minZA, maxXA, maxYA, maxZA;
+    double minXB, minYB, minZB, maxXB, maxYB, maxZB;
+    octreeA.getBoundingBox (minXA, minYA, minZA, maxXA, maxYA, maxZA);
+    octreeB.getBoundingBox (minXB, minYB, minZB, maxXB, maxYB, maxZB);
+    EXPECT_EQ (minXA, minXB);
+    EXPECT_EQ (minYA, minYB);
+    EXPECT_EQ (minZA, minZB);
+    EXPECT_EQ (maxXA, maxXB);
+    EXPECT_EQ (maxYA, maxYB);
+    EXPECT_EQ (maxZA, maxZB);
+
+    // same tree structure and same point indices in the same order
+    std::vector<char> treeA, treeB;
+    std::vector<int> dataA, dataB;
+    octreeA.serializeTree (treeA, dataA);
+    octreeB.serializeTree (treeB, dataB);
+    EXPECT_TRUE (treeA == treeB);
+    EXPECT_TRUE (dataA == dataB);
+    EXPECT_EQ (static_cast<int> (dataB.size ()), pointcount - 1);
+  }
+
+  // leaf containers with custom data
+  OctreePointCloudVoxelCentroid<PointXYZ> centroidsA (resolution);
+  OctreePointCloudVoxelCentroid<PointXYZ> centroidsB (resolution);
+  centroidsA.setInputCloud (cloudIn);
+  centroidsB.setInputCloud (cloudIn);
+  centroidsA.addPointsFromInputCloud ();
+  centroidsB.addPointsFromInputCloudBulk ();
+
+  pcl::PointCloud<PointXYZ>::VectorType voxelCentroidsA, voxelCentroidsB;
+  centroidsA.getVoxelCentroids (voxelCentroidsA);
+  centroidsB.getVoxelCentroids (voxelCentroidsB);
+  ASSERT_EQ (voxelCentroidsA.size (), voxelCentroidsB.size ());
+  for (size_t i = 0; i < voxelCentroidsA.size (); i++)
+  {
+    EXPECT_NEAR (voxelCentroidsA[i].x, voxelCentroidsB[i].x, 1e-5);
+    EXPECT_NEAR (voxelCentroidsA[i].y, voxelCentroidsB[i].y, 1e-5);
+    EXPECT_NEAR (voxelCentroidsA[i].z, voxelCentroidsB[i].z, 1e-5);
+  }
+
+  // double buffered octrees
+  OctreePointCloudChangeDetector<PointXYZ> changeA (resolution);
+  OctreePointCloudChangeDetector<PointXYZ> changeB (resolution);
+  changeA.setInputCloud (cloudIn);
+  changeB.setInputCloud (cloudIn);
+  changeA.addPointsFromInputCloud ();
+  changeB.addPointsFromInputCloudBulk ();
+
+  std::vector<char> treeA, treeB;
+  changeA.serializeTree (treeA);
+  changeB.serializeTree (treeB);
+  EXPECT_EQ (changeA.getLeafCount (), changeB.getLeafCount ());
+  EXPECT_TRUE (treeA == treeB);
+}
+
+TEST (PCL, Octree_Linear_Test)
+{
+  typedef OctreeContainerDataTVector<int> LeafT;
+  typedef OctreeContainerEmpty<int> BranchT;
+  typedef OctreeLinearBase<int, LeafT, BranchT> LinearOctree;
+  typedef OctreePointCloudSearch<PointXYZ, LeafT, BranchT, LinearOctree> LinearOctreeSearch;
+
+  const int pointcount = 3000;
+  const double resolution = 0.2;
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> (pointcount, 1));
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  for (int i = 0; i < pointcount; i++)
+    cloudIn->points[i] = PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX - 5.0),
+                                   static_cast<float> (10.0 * rand () / RAND_MAX - 5.0),
+                                   static_cast<float> (2.0 * rand () / RAND_MAX));
+
+  // linear branch nodes do not store child pointers
+  EXPECT_LT (sizeof (LinearOctreeSearch::BranchNode), sizeof (OctreePointCloudSearch<PointXYZ>::BranchNode));
+
+  // incremental and bulk construction
+  for (int run = 0; run < 2; run++)
+  {
+    OctreePointCloudSearch<PointXYZ> octreeA (resolution);
+    LinearOctreeSearch octreeB (resolution);
+
+    octreeA.setInputCloud (cloudIn);
+    octreeB.setInputCloud (cloudIn);
+    if (run)
+    {
+      octreeA.addPointsFromInputCloudBulk ();
+      octreeB.addPointsFromInputCloudBulk ();
+    }
+    else
+    {
+      octreeA.addPointsFromInputCloud ();
+      octreeB.addPointsFromInputCloud ();
+    }
+
+    ASSERT_EQ (octreeA.getTreeDepth (), octreeB.getTreeDepth ());
+    ASSERT_EQ (octreeA.getLeafCount (), octreeB.getLeafCount ());
+    ASSERT_EQ (octreeA.getBranchCount (), octreeB.getBranchCount ());
+
+    std::vector<char> treeA, treeB;
+    std::vector<int> dataA, dataB;
+    octreeA.serializeTree (treeA, dataA);
+    octreeB.serializeTree (treeB, dataB);
+    EXPECT_TRUE (treeA == treeB);
+    EXPECT_TRUE (dataA == dataB);
+
+    // iterators visit the same nodes
+    OctreePointCloudSearch<PointXYZ>::DepthFirstIterator itA = octreeA.depth_begin ();
+    LinearOctreeSearch::DepthFirstIterator itB = octreeB.depth_begin ();
+    unsigned int leafNodeCount = 0;
+    while (*++itA && *++itB)
+    {
+      ASSERT_EQ (itA.isLeafNode (), itB.isLeafNode ());
+      ASSERT_EQ (itA.getNodeConfiguration (), itB.getNodeConfiguration ());
+      ASSERT_EQ (itA.getCurrentOctreeDepth (), itB.getCurrentOctreeDepth ());
+      if (itB.isLeafNode ())
+      {
+        std::vector<int> leafDataA, leafDataB;
+        itA.getData (leafDataA);
+        itB.getData (leafDataB);
+        ASSERT_TRUE (leafDataA == leafDataB);
+        leafNodeCount++;
+      }
+    }
+    EXPECT_EQ (leafNodeCount, octreeB.getLeafCount ());
+
+    // searches return identical results
+    for (int test_id = 0; test_id < 50; test_id++)
+    {
+      PointXYZ searchPoint (static_cast<float> (10.0 * rand () / RAND_MAX - 5.0),
+                            static_cast<float> (10.0 * rand () / RAND_MAX - 5.0),
+                            static_cast<float> (2.0 * rand () / RAND_MAX));
+
+      std::vector<int> indicesA, indicesB;
+      std::vector<float> distancesA, distancesB;
+
+      octreeA.nearestKSearch (searchPoint, 10, indicesA, distancesA);
+      octreeB.nearestKSearch (searchPoint, 10, indicesB, distancesB);
+      EXPECT_TRUE (indicesA == indicesB);
+      EXPECT_TRUE (distancesA == distancesB);
+
+      octreeA.radiusSearch (searchPoint, 0.5, indicesA, distancesA);
+      octreeB.radiusSearch (searchPoint, 0.5, indicesB, distancesB);
+      EXPECT_TRUE (indicesA == indicesB);
+      EXPECT_TRUE (distancesA == distancesB);
+
+      EXPECT_EQ (octreeA.voxelSearch (searchPoint, indicesA), octreeB.voxelSearch (searchPoint, indicesB));
+      EXPECT_TRUE (indicesA == indicesB);
+
+      Eigen::Vector3f minPt (searchPoint.x - 0.5f, searchPoint.y - 0.5f, searchPoint.z - 0.5f);
+      Eigen::Vector3f maxPt (searchPoint.x + 0.5f, searchPoint.y + 0.5f, searchPoint.z + 0.5f);
+      octreeA.boxSearch (minPt, maxPt, indicesA);
+      octreeB.boxSearch (minPt, maxPt, indicesB);
+      EXPECT_TRUE (indicesA == indicesB);
+    }
+
+    // remove every second voxel
+    for (int i = 0; i < pointcount; i += 2)
+    {
+      octreeA.deleteVoxelAtPoint (cloudIn->points[i]);
+      octreeB.deleteVoxelAtPoint (cloudIn->points[i]);
+    }
+    EXPECT_EQ (octreeA.getLeafCount (), octreeB.getLeafCount ());
+    EXPECT_EQ (octreeA.getBranchCount (), octreeB.getBranchCount ());
+    octreeA.serializeTree (treeA, dataA);
+    octreeB.serializeTree (treeB, dataB);
+    EXPECT_TRUE (treeA == treeB);
+    EXPECT_TRUE (dataA == dataB);
+
+    // add the removed points again
+    for (int i = 0; i < pointcount; i += 2)
+    {
+      octreeA.addPointFromCloud (i, OctreePointCloudSearch<PointXYZ>::IndicesPtr ());
+      octreeB.addPointFromCloud (i, LinearOctreeSearch::IndicesPtr ());
+    }
+    EXPECT_EQ (octreeA.getLeafCount (), octreeB.getLeafCount ());
+    EXPECT_EQ (octreeA.getBranchCount (), octreeB.getBranchCount ());
+    octreeA.serializeTree (treeA, dataA);
+    octreeB.serializeTree (treeB, dataB);
+    EXPECT_TRUE (treeA == treeB);
+    EXPECT_TRUE (dataA == dataB);
+
+    // deserialization
+    OctreeBase<int, LeafT, BranchT> octreeC;
+    LinearOctree octreeD;
+    octreeC.setTreeDepth (octreeA.getTreeDepth ());
+    octreeD.setTreeDepth (octreeB.getTreeDepth ());
+    octreeC.deserializeTree (treeA, dataA);
+    octreeD.deserializeTree (treeB, dataB);
+    std::vector<char> treeC, treeD;
+    std::vector<int> dataC, dataD;
+    octreeC.serializeTree (treeC, dataC);
+    octreeD.serializeTree (treeD, dataD);
+    EXPECT_EQ (octreeB.getLeafCount (), octreeD.getLeafCount ());
+    EXPECT_EQ (octreeB.getBranchCount (), octreeD.getBranchCount ());
+    EXPECT_TRUE (treeB == treeD);
+    EXPECT_TRUE (dataC == dataD);
+  }
+}
+
 // helper class for priority queue
 class prioPointQueueEntry
 {
@@ -1539,6 +1777,111 @@ TEST (PCL, Octree_Pointcloud_Neighbours_Within_Radius_Search)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Batch_Search)
+{
+  typedef OctreeContainerDataTVector<int> LeafT;
+  typedef OctreeContainerEmpty<int> BranchT;
+  typedef OctreePointCloudSearch<PointXYZ, LeafT, BranchT, OctreeLinearBase<int, LeafT, BranchT> > LinearOctreeSearch;
+
+  const int pointcount = 5000;
+  const int querycount = 2000;
+  const double resolution = 0.05;
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> (pointcount, 1));
+  PointCloud<PointXYZ> queries (querycount, 1);
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  for (int i = 0; i < pointcount; i++)
+    cloudIn->points[i] = PointXYZ (static_cast<float> (4.0 * rand () / RAND_MAX),
+                                   static_cast<float> (4.0 * rand () / RAND_MAX),
+                                   static_cast<float> (1.0 * rand () / RAND_MAX));
+
+  // queries partly outside of the bounding box of the octree
+  for (int i = 0; i < querycount; i++)
+    queries.points[i] = PointXYZ (static_cast<float> (5.0 * rand () / RAND_MAX - 0.5),
+                                  static_cast<float> (5.0 * rand () / RAND_MAX - 0.5),
+                                  static_cast<float> (1.5 * rand () / RAND_MAX - 0.25));
+  queries.points[querycount / 2].x = std::numeric_limits<float>::quiet_NaN ();
+
+  std::vector<int> queryIndices;
+  for (int i = 0; i < querycount; i += 3)
+    queryIndices.push_back (i);
+
+  OctreePointCloudSearch<PointXYZ> octree (resolution);
+  octree.setInputCloud (cloudIn);
+  octree.addPointsFromInputCloud ();
+
+  LinearOctreeSearch octreeLinear (resolution);
+  octreeLinear.setInputCloud (cloudIn);
+  octreeLinear.addPointsFromInputCloudBulk ();
+
+  for (unsigned int threads = 1; threads <= 4; threads += 3)
+  {
+    octree.setNumberOfThreads (threads);
+    octreeLinear.setNumberOfThreads (threads);
+
+    for (int run = 0; run < 2; run++)
+    {
+      const std::vector<int> indices = run ? queryIndices : std::vector<int> ();
+      const size_t batchSize = run ? queryIndices.size () : queries.points.size ();
+
+      std::vector<std::vector<int> > kIndices, kIndicesLinear, rIndices, rIndicesLinear;
+      std::vector<std::vector<float> > kDistances, kDistancesLinear, rDistances, rDistancesLinear;
+
+      octree.nearestKSearch (queries, indices, 10, kIndices, kDistances);
+      octreeLinear.nearestKSearch (queries, indices, 10, kIndicesLinear, kDistancesLinear);
+      octree.radiusSearch (queries, indices, 0.15, rIndices, rDistances);
+      octreeLinear.radiusSearch (queries, indices, 0.15, rIndicesLinear, rDistancesLinear, 5);
+
+      ASSERT_EQ (kIndices.size (), batchSize);
+      ASSERT_EQ (kIndicesLinear.size (), batchSize);
+      ASSERT_EQ (rIndices.size (), batchSize);
+      ASSERT_EQ (rIndicesLinear.size (), batchSize);
+
+      // batch searches return the results of the single query searches
+      for (size_t i = 0; i < batchSize; i++)
+      {
+        const PointXYZ& query = queries.points[run ? queryIndices[i] : i];
+
+        if (!pcl_isfinite (query.x))
+        {
+          ASSERT_EQ (kIndices[i].size (), 0);
+          ASSERT_EQ (rIndices[i].size (), 0);
+          continue;
+        }
+
+        std::vector<int> k_indices;
+        std::vector<float> k_sqr_distances;
+
+        octree.nearestKSearch (query, 10, k_indices, k_sqr_distances);
+        ASSERT_EQ (kIndices[i].size (), 10);
+        ASSERT_EQ (kIndicesLinear[i].size (), 10);
+        for (size_t j = 0; j < 10; j++)
+        {
+          EXPECT_EQ (kDistances[i][j], k_sqr_distances[j]);
+          EXPECT_EQ (kDistancesLinear[i][j], k_sqr_distances[j]);
+          EXPECT_EQ (kIndices[i][j], k_indices[j]);
+          EXPECT_EQ (kIndicesLinear[i][j], k_indices[j]);
+        }
+
+        octree.radiusSearch (query, 0.15, k_indices, k_sqr_distances);
+        ASSERT_EQ (rIndices[i].size (), k_indices.size ());
+        ASSERT_EQ (rIndicesLinear[i].size (), std::min<size_t> (k_indices.size (), 5));
+        for (size_t j = 0; j < k_indices.size (); j++)
+        {
+          EXPECT_EQ (rIndices[i][j], k_indices[j]);
+          EXPECT_EQ (rDistances[i][j], k_sqr_distances[j]);
+          if (j < 5)
+          {
+            EXPECT_EQ (rIndicesLinear[i][j], k_indices[j]);
+          }
+        }
+      }
+    }
+  }
+}
+
 TEST (PCL, Octree_Pointcloud_Ray_Traversal)
 {
 
@@ -827,6 +827,281 @@ TEST_F (OutofcoreTest, PointCloud2_Query)
   cleanUpFilesystem ();
 }
 
+TEST_F (OutofcoreTest, Outofcore_DiskContainerPrefetch)
+{
+  cleanUpFilesystem ();
+
+  boost::filesystem::create_directories (outofcore_path.parent_path ());
+  const boost::filesystem::path payload_path = outofcore_path.parent_path () / "prefetch_test.pcd";
+
+  AlignedPointTVector some_points;
+  for (unsigned int i = 0; i < numPts; i++)
+    some_points.push_back (PointT (static_cast<float>(rand () % 1024), static_cast<float>(rand () % 1024), static_cast<float>(rand () % 1024)));
+
+  {
+    OutofcoreOctreeDiskContainer<PointT> container (payload_path);
+    //nothing has been written yet; prefetching must be harmless
+    container.prefetch ();
+    container.insertRange (&some_points[0], some_points.size ());
+  }
+
+  OutofcoreOctreeDiskContainer<PointT> container (payload_path);
+  ASSERT_EQ (some_points.size (), container.size ());
+
+  container.prefetch ();
+
+  AlignedPointTVector read_points;
+  container.readRange (0, container.size (), read_points);
+  ASSERT_EQ (some_points.size (), read_points.size ());
+  for (size_t i = 0; i < some_points.size (); i++)
+    EXPECT_TRUE (compPt (some_points[i], read_points[i])) << "Point " << i << " differs after prefetch\n";
+
+  //query through the tree, which prefetches sibling nodes before reading them
+  const Eigen::Vector3d min (-1.0, -1.0, -1.0);
+  const Eigen::Vector3d max (1025.0, 1025.0, 1025.0);
+  const Eigen::Vector3d query_min (100.5, 200.5, 300.5);
+  const Eigen::Vector3d query_max (700.5, 800.5, 900.5);
+
+  octree_disk octreeA (3, min, max, filename_otreeA, "ECEF");
+  ASSERT_EQ (some_points.size (), octreeA.addDataToLeaf (some_points));
+
+  size_t expected = 0;
+  for (size_t i = 0; i < some_points.size (); i++)
+  {
+    const PointT &p = some_points[i];
+    if (p.x >= query_min[0] && p.x <= query_max[0] &&
+        p.y >= query_min[1] && p.y <= query_max[1] &&
+        p.z >= query_min[2] && p.z <= query_max[2])
+      expected++;
+  }
+
+  AlignedPointTVector query_points;
+  octreeA.queryBBIncludes (query_min, query_max, octreeA.getDepth (), query_points);
+  EXPECT_EQ (expected, query_points.size ());
+
+  sensor_msgs::PointCloud2::Ptr query_blob (new sensor_msgs::PointCloud2 ());
+  octreeA.queryBBIncludes (query_min, query_max, int (octreeA.getDepth ()), query_blob);
+  EXPECT_EQ (expected, query_blob->width*query_blob->height);
+
+  cleanUpFilesystem ();
+}
+
+TEST_F (OutofcoreTest, Outofcore_ParallelBuild)
+{
+  cleanUpFilesystem ();
+
+  const Eigen::Vector3d min (-1.0, -1.0, -1.0);
+  const Eigen::Vector3d max (1025.0, 1025.0, 1025.0);
+
+  AlignedPointTVector some_points;
+  for (unsigned int i = 0; i < numPts; i++)
+    some_points.push_back (PointT (static_cast<float>(rand () % 1024), static_cast<float>(rand () % 1024), static_cast<float>(rand () % 1024)));
+
+  PointCloud<PointT>::Ptr test_cloud (new PointCloud<PointT> ());
+  test_cloud->points.assign (some_points.begin (), some_points.end ());
+  test_cloud->width = static_cast<uint32_t> (some_points.size ());
+  test_cloud->height = 1;
+
+  sensor_msgs::PointCloud2::Ptr test_blob (new sensor_msgs::PointCloud2 ());
+  pcl::toROSMsg (*test_cloud, *test_blob);
+
+  //the same input built serially and with several workers per top-level octant
+  octree_disk serial_tree (3, min, max, filename_otreeA, "ECEF");
+  serial_tree.setNumberOfThreads (1);
+  EXPECT_EQ (1u, serial_tree.getNumberOfThreads ());
+
+  octree_disk parallel_tree (3, min, max, filename_otreeB, "ECEF");
+  parallel_tree.setNumberOfThreads (4);
+  EXPECT_EQ (4u, parallel_tree.getNumberOfThreads ());
+
+  ASSERT_EQ (some_points.size (), serial_tree.addDataToLeaf (some_points));
+  ASSERT_EQ (some_points.size (), parallel_tree.addDataToLeaf (some_points));
+  EXPECT_EQ (serial_tree.getNumPointsAtDepth (3), parallel_tree.getNumPointsAtDepth (3));
+
+  AlignedPointTVector serial_points, parallel_points;
+  serial_tree.queryBBIncludes (min, max, serial_tree.getDepth (), serial_points);
+  parallel_tree.queryBBIncludes (min, max, parallel_tree.getDepth (), parallel_points);
+  EXPECT_EQ (some_points.size (), serial_points.size ());
+  EXPECT_EQ (some_points.size (), parallel_points.size ());
+
+  //bottom-up LOD: each level holds a subsample of the one below it
+  parallel_tree.buildLOD ();
+  EXPECT_EQ (some_points.size (), parallel_tree.getNumPointsAtDepth (3));
+  for (boost::uint64_t depth = 0; depth < 3; depth++)
+  {
+    EXPECT_GT (parallel_tree.getNumPointsAtDepth (depth), 0u);
+    EXPECT_LT (parallel_tree.getNumPointsAtDepth (depth), parallel_tree.getNumPointsAtDepth (depth + 1));
+
+    AlignedPointTVector lod_points;
+    parallel_tree.queryBBIncludes (min, max, depth, lod_points);
+    EXPECT_EQ (parallel_tree.getNumPointsAtDepth (depth), lod_points.size ());
+  }
+
+  cleanUpFilesystem ();
+
+  //the LOD generating insertion paths
+  octree_disk lod_tree (3, min, max, filename_otreeA_LOD, "ECEF");
+  lod_tree.setNumberOfThreads (4);
+  lod_tree.addPointCloud_and_genLOD (test_cloud);
+
+  //every point reaches the leaves; the branch nodes hold sampled copies
+  EXPECT_EQ (some_points.size (), lod_tree.getNumPointsAtDepth (lod_tree.getDepth ()));
+  for (boost::uint64_t depth = 0; depth < lod_tree.getDepth (); depth++)
+    EXPECT_LT (lod_tree.getNumPointsAtDepth (depth), some_points.size ());
+
+  octree_disk blob_tree (3, min, max, filename_otreeB_LOD, "ECEF");
+  blob_tree.setNumberOfThreads (4);
+  EXPECT_EQ (some_points.size (), blob_tree.addPointCloud_and_genLOD (test_blob));
+
+  sensor_msgs::PointCloud2::Ptr query_blob (new sensor_msgs::PointCloud2 ());
+  blob_tree.queryBBIncludes (min, max, int (blob_tree.getDepth ()), query_blob);
+  EXPECT_GT (query_blob->width*query_blob->height, 0u);
+
+  cleanUpFilesystem ();
+}
+
+/** \brief Sums the sizes of the files below \b dir that have extension \b extension, and counts them */
+boost::uintmax_t
+getFilesSize (const boost::filesystem::path &dir, const std::string &extension, size_t &nr_files)
+{
+  boost::uintmax_t total = 0;
+  nr_files = 0;
+  boost::filesystem::recursive_directory_iterator it (dir), end;
+  for (; it != end; ++it)
+  {
+    if (boost::filesystem::is_regular_file (it->path ()) && boost::filesystem::extension (it->path ()) == extension)
+    {
+      total += boost::filesystem::file_size (it->path ());
+      nr_files++;
+    }
+  }
+  return (total);
+}
+
+TEST_F (OutofcoreTest, Outofcore_QuantizedPayload)
+{
+  cleanUpFilesystem ();
+
+  const Eigen::Vector3d min (-1.0, -1.0, -1.0);
+  const Eigen::Vector3d max (1025.0, 1025.0, 1025.0);
+
+  AlignedPointTVector some_points;
+  for (unsigned int i = 0; i < numPts; i++)
+    some_points.push_back (PointT (static_cast<float>(rand ()) / RAND_MAX * 1024.0f, static_cast<float>(rand ()) / RAND_MAX * 1024.0f, static_cast<float>(rand ()) / RAND_MAX * 1024.0f));
+
+  octree_disk plain_tree (3, min, max, filename_otreeA, "ECEF");
+  EXPECT_EQ (OutofcoreOctreeNodeMetadata::PCD_BINARY_COMPRESSED, plain_tree.getPayloadEncoding ());
+
+  octree_disk quantized_tree (3, min, max, filename_otreeB, "ECEF");
+  ASSERT_TRUE (quantized_tree.setPayloadEncoding (OutofcoreOctreeNodeMetadata::PCD_QUANTIZED_XYZ));
+  EXPECT_EQ (OutofcoreOctreeNodeMetadata::PCD_QUANTIZED_XYZ, quantized_tree.getPayloadEncoding ());
+
+  ASSERT_EQ (some_points.size (), plain_tree.addDataToLeaf (some_points));
+  ASSERT_EQ (some_points.size (), quantized_tree.addDataToLeaf (some_points));
+
+  //the encoding of a tree holding points can't be changed anymore
+  EXPECT_FALSE (quantized_tree.setPayloadEncoding (OutofcoreOctreeNodeMetadata::PCD_BINARY_COMPRESSED));
+  EXPECT_EQ (OutofcoreOctreeNodeMetadata::PCD_QUANTIZED_XYZ, quantized_tree.getPayloadEncoding ());
+
+  //both trees store the points in the same nodes and order; the coordinates differ by at most half a step
+  AlignedPointTVector plain_points, quantized_points;
+  plain_tree.queryBBIncludes (min, max, plain_tree.getDepth (), plain_points);
+  quantized_tree.queryBBIncludes (min, max, quantized_tree.getDepth (), quantized_points);
+  ASSERT_EQ (some_points.size (), plain_points.size ());
+  ASSERT_EQ (some_points.size (), quantized_points.size ());
+
+  const double step = quantized_tree.getVoxelSideLength (quantized_tree.getDepth ()) / 65535.0;
+  for (size_t i = 0; i < plain_points.size (); i++)
+  {
+    EXPECT_NEAR (plain_points[i].x, quantized_points[i].x, step);
+    EXPECT_NEAR (plain_points[i].y, quantized_points[i].y, step);
+    EXPECT_NEAR (plain_points[i].z, quantized_points[i].z, step);
+  }
+
+  sensor_msgs::PointCloud2::Ptr query_blob (new sensor_msgs::PointCloud2 ());
+  quantized_tree.queryBBIncludes (min, max, int (quantized_tree.getDepth ()), query_blob);
+  ASSERT_EQ (some_points.size (), query_blob->width*query_blob->height);
+  for (size_t i = 0; i < query_blob->fields.size (); i++)
+    EXPECT_EQ (sensor_msgs::PointField::FLOAT32, query_blob->fields[i].datatype);
+
+  //every node records the encoding, and the payload files shrink
+  size_t nr_plain_pcd, nr_quantized_pcd, nr_idx;
+  boost::uintmax_t plain_size = getFilesSize (filename_otreeA.parent_path (), ".pcd", nr_plain_pcd);
+  boost::uintmax_t quantized_size = getFilesSize (filename_otreeB.parent_path (), ".pcd", nr_quantized_pcd);
+  EXPECT_EQ (nr_plain_pcd, nr_quantized_pcd);
+  EXPECT_LT (quantized_size, plain_size);
+
+  getFilesSize (filename_otreeB.parent_path (), ".oct_idx", nr_idx);
+  EXPECT_GT (nr_idx, 1u);
+  boost::filesystem::recursive_directory_iterator it (filename_otreeB.parent_path ()), end;
+  for (; it != end; ++it)
+  {
+    if (boost::filesystem::extension (it->path ()) != ".oct_idx")
+      continue;
+    OutofcoreOctreeNodeMetadata metadata;
+    ASSERT_TRUE (metadata.loadMetadataFromDisk (it->path ()));
+    EXPECT_EQ (OutofcoreOctreeNodeMetadata::PCD_QUANTIZED_XYZ, metadata.getPayloadEncoding ());
+  }
+
+  //a tree loaded from disk decodes its nodes the same way
+  octree_disk reloaded_tree (filename_otreeB, true);
+  EXPECT_EQ (OutofcoreOctreeNodeMetadata::PCD_QUANTIZED_XYZ, reloaded_tree.getPayloadEncoding ());
+
+  AlignedPointTVector reloaded_points;
+  reloaded_tree.queryBBIncludes (min, max, reloaded_tree.getDepth (), reloaded_points);
+  ASSERT_EQ (quantized_points.size (), reloaded_points.size ());
+  for (size_t i = 0; i < quantized_points.size (); i++)
+    EXPECT_TRUE (compPt (quantized_points[i], reloaded_points[i])) << "Point " << i << " differs after reloading\n";
+
+  cleanUpFilesystem ();
+}
+
+TEST_F (OutofcoreTest, Outofcore_QuantizedPayloadFieldTypes)
+{
+  cleanUpFilesystem ();
+
+  boost::filesystem::create_directories (outofcore_path.parent_path ());
+  const boost::filesystem::path payload_path = outofcore_path.parent_path () / "quantized_test.pcd";
+
+  const Eigen::Vector3d min (-1.0, -1.0, -1.0);
+  const Eigen::Vector3d max (1025.0, 1025.0, 1025.0);
+
+  AlignedPointTVector some_points;
+  for (unsigned int i = 0; i < numPts; i++)
+    some_points.push_back (PointT (static_cast<float>(rand ()) / RAND_MAX * 1024.0f, static_cast<float>(rand ()) / RAND_MAX * 1024.0f, static_cast<float>(rand ()) / RAND_MAX * 1024.0f));
+
+  {
+    OutofcoreOctreeDiskContainer<PointT> container (payload_path);
+    container.setPointQuantization (true, min, max);
+    container.insertRange (&some_points[0], some_points.size ());
+  }
+
+  //the file's UINT16 fields select the dequantization, not the container setting
+  OutofcoreOctreeDiskContainer<PointT> container (payload_path);
+  container.setPointQuantization (false, min, max);
+  ASSERT_EQ (some_points.size (), container.size ());
+
+  AlignedPointTVector read_points;
+  container.readRange (0, container.size (), read_points);
+  ASSERT_EQ (some_points.size (), read_points.size ());
+
+  const double step = (max[0] - min[0]) / 65535.0;
+  for (size_t i = 0; i < some_points.size (); i++)
+  {
+    EXPECT_NEAR (some_points[i].x, read_points[i].x, step);
+    EXPECT_NEAR (some_points[i].y, read_points[i].y, step);
+    EXPECT_NEAR (some_points[i].z, read_points[i].z, step);
+  }
+
+  sensor_msgs::PointCloud2::Ptr read_blob (new sensor_msgs::PointCloud2 ());
+  container.readRange (0, container.size (), read_blob);
+  ASSERT_EQ (some_points.size (), read_blob->width*read_blob->height);
+  for (size_t i = 0; i < read_blob->fields.size (); i++)
+    EXPECT_EQ (sensor_msgs::PointField::FLOAT32, read_blob->fields[i].datatype);
+
+  cleanUpFilesystem ();
+}
+
 /* [--- */
 int
 main (int argc, char** argv)
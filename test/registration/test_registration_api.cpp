@@ -42,6 +42,7 @@
 #include <pcl/point_types.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/registration/correspondence_estimation.h>
+#include <pcl/registration/correspondence_estimation_omp.h>
 #include <pcl/registration/correspondence_rejection_distance.h>
 #include <pcl/registration/correspondence_rejection_median_distance.h>
 #include <pcl/registration/correspondence_rejection_surface_normal.h>
@@ -52,6 +53,7 @@
 #include <pcl/registration/correspondence_rejection_var_trimmed.h>
 #include <pcl/registration/transformation_estimation_lm.h>
 #include <pcl/registration/transformation_estimation_svd.h>
+#include <pcl/registration/transformation_estimation_svd_omp.h>
 #include <pcl/features/normal_3d.h>
 
 #include "test_registration_api_data.h"
@@ -102,6 +104,54 @@ TEST (PCL, CorrespondenceEstimationReciprocal)
     }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, CorrespondenceEstimationOMP)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr source (new pcl::PointCloud<pcl::PointXYZ>(cloud_source));
+  pcl::PointCloud<pcl::PointXYZ>::Ptr target (new pcl::PointCloud<pcl::PointXYZ>(cloud_target));
+
+  pcl::registration::CorrespondenceEstimationOMP<pcl::PointXYZ, pcl::PointXYZ> corr_est (4);
+  corr_est.setInputCloud (source);
+  corr_est.setInputTarget (target);
+
+  // check for correct order and number of matches
+  boost::shared_ptr<pcl::Correspondences> correspondences (new pcl::Correspondences);
+  corr_est.determineCorrespondences (*correspondences);
+  EXPECT_EQ (int (correspondences->size ()), nr_original_correspondences);
+  if (int (correspondences->size ()) == nr_original_correspondences)
+    for (int i = 0; i < nr_original_correspondences; ++i)
+    {
+      EXPECT_EQ ((*correspondences)[i].index_query, i);
+      EXPECT_EQ ((*correspondences)[i].index_match, correspondences_original[i][1]);
+    }
+
+  // check for correct matches and number of reciprocal matches
+  corr_est.determineReciprocalCorrespondences (*correspondences);
+  EXPECT_EQ (int (correspondences->size ()), nr_reciprocal_correspondences);
+  if (int (correspondences->size ()) == nr_reciprocal_correspondences)
+    for (int i = 0; i < nr_reciprocal_correspondences; ++i)
+    {
+      EXPECT_EQ ((*correspondences)[i].index_query, correspondences_reciprocal[i][0]);
+      EXPECT_EQ ((*correspondences)[i].index_match, correspondences_reciprocal[i][1]);
+    }
+
+  // a maximum distance must remove the same correspondences as the serial version
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> corr_est_serial;
+  corr_est_serial.setInputCloud (source);
+  corr_est_serial.setInputTarget (target);
+  pcl::Correspondences correspondences_serial;
+  corr_est_serial.determineCorrespondences (correspondences_serial, 0.05);
+  corr_est.setNumberOfThreads (0);
+  corr_est.determineCorrespondences (*correspondences, 0.05);
+  ASSERT_EQ (correspondences->size (), correspondences_serial.size ());
+  for (size_t i = 0; i < correspondences_serial.size (); ++i)
+  {
+    EXPECT_EQ ((*correspondences)[i].index_query, correspondences_serial[i].index_query);
+    EXPECT_EQ ((*correspondences)[i].index_match, correspondences_serial[i].index_match);
+    EXPECT_EQ ((*correspondences)[i].distance, correspondences_serial[i].distance);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, CorrespondenceRejectorDistance)
 {
@@ -365,6 +415,44 @@ TEST (PCL, TransformationEstimationSVD)
       EXPECT_NEAR (transform_res_from_SVD(i, j), transform_from_SVD[i][j], 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TransformationEstimationSVDOMP)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr source (new pcl::PointCloud<pcl::PointXYZ>(cloud_source));
+  pcl::PointCloud<pcl::PointXYZ>::Ptr target (new pcl::PointCloud<pcl::PointXYZ>(cloud_target));
+
+  // re-do reciprocal correspondence estimation
+  boost::shared_ptr<pcl::Correspondences> correspondences (new pcl::Correspondences);
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> corr_est;
+  corr_est.setInputCloud (source);
+  corr_est.setInputTarget (target);
+  corr_est.determineReciprocalCorrespondences (*correspondences);
+
+  Eigen::Matrix4f transform_res_from_SVD;
+  pcl::registration::TransformationEstimationSVDOMP<pcl::PointXYZ, pcl::PointXYZ> trans_est_svd (4);
+  trans_est_svd.estimateRigidTransformation(*source, *target,
+                                            *correspondences,
+                                            transform_res_from_SVD);
+
+  // check for correct transformation
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (transform_res_from_SVD(i, j), transform_from_SVD[i][j], 1e-4);
+
+  // the index based version must give the same result
+  std::vector<int> indices_src (correspondences->size ()), indices_tgt (correspondences->size ());
+  for (size_t i = 0; i < correspondences->size (); ++i)
+  {
+    indices_src[i] = (*correspondences)[i].index_query;
+    indices_tgt[i] = (*correspondences)[i].index_match;
+  }
+  trans_est_svd.setNumberOfThreads (1);
+  trans_est_svd.estimateRigidTransformation (*source, indices_src, *target, indices_tgt, transform_res_from_SVD);
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (transform_res_from_SVD(i, j), transform_from_SVD[i][j], 1e-4);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, TransformationEstimationLM)
 {
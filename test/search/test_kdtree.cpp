@@ -36,6 +36,7 @@
  *
  */
 #include <iostream>
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <pcl/common/time.h>
 #include <pcl/search/pcl_search.h>
@@ -195,6 +196,70 @@ TEST (PCL, KdTree_multipointKnnSearch)
   }
 }
 
+/* Test for KdTree searches into a reusable NeighborList */
+TEST (PCL, KdTree_neighborList)
+{
+  pcl::search::KdTree<PointXYZ> kdtree;
+  kdtree.setInputCloud (cloud.makeShared ());
+  const pcl::search::Search<PointXYZ> &search = kdtree;
+
+  pcl::search::NeighborList neighbors;
+  vector<int> k_indices;
+  vector<float> k_distances;
+
+  // k below the inline capacity stays off the heap, k above it spills
+  int ks[] = {10, 50};
+  for (int ki = 0; ki < 2; ++ki)
+  {
+    int k = ks[ki];
+    for (size_t i = 0; i < cloud.points.size (); i += 7)
+    {
+      int nr_found = search.nearestKSearch (cloud, static_cast<int> (i), k, neighbors);
+      kdtree.nearestKSearch (cloud, static_cast<int> (i), k, k_indices, k_distances);
+      ASSERT_EQ (nr_found, k);
+      ASSERT_EQ (neighbors.size (), k_indices.size ());
+      EXPECT_EQ (neighbors.isInline (), k <= static_cast<int> (pcl::search::NeighborList::INLINE_CAPACITY));
+      for (int j = 0; j < k; ++j)
+        EXPECT_EQ (neighbors.sqrDistance (j), k_distances[j]);
+    }
+  }
+
+  // Radius search writes into the list, and grows it when the neighbors do not fit
+  for (size_t i = 0; i < cloud.points.size (); i += 7)
+  {
+    int nr_found = search.radiusSearch (static_cast<int> (i), 0.25, neighbors);
+    kdtree.radiusSearch (cloud, static_cast<int> (i), 0.25, k_indices, k_distances);
+    ASSERT_EQ (nr_found, static_cast<int> (k_indices.size ()));
+    ASSERT_EQ (neighbors.size (), k_indices.size ());
+    vector<int> list_indices;
+    vector<float> list_distances;
+    neighbors.copyTo (list_indices, list_distances);
+    sort (list_indices.begin (), list_indices.end ());
+    sort (k_indices.begin (), k_indices.end ());
+    EXPECT_TRUE (list_indices == k_indices);
+
+    // A bounded search keeps the closest neighbors
+    nr_found = search.radiusSearch (static_cast<int> (i), 0.25, neighbors, 40);
+    kdtree.radiusSearch (cloud, static_cast<int> (i), 0.25, k_indices, k_distances, 40);
+    ASSERT_EQ (nr_found, static_cast<int> (k_indices.size ()));
+    ASSERT_EQ (neighbors.size (), k_indices.size ());
+    float max_distance = 0;
+    for (size_t j = 0; j < neighbors.size (); ++j)
+      max_distance = (std::max) (max_distance, neighbors.sqrDistance (j));
+    EXPECT_NEAR (max_distance, *std::max_element (k_distances.begin (), k_distances.end ()), 1e-6);
+  }
+
+  // Growing and shrinking preserves the stored neighbors
+  neighbors.clear ();
+  for (int i = 0; i < 40; ++i)
+    neighbors.push_back (i, static_cast<float> (i));
+  EXPECT_FALSE (neighbors.isInline ());
+  neighbors.resize (5);
+  EXPECT_TRUE (neighbors.isInline ());
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ (neighbors.index (i), i);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -46,6 +46,7 @@
 #include <pcl/sample_consensus/msac.h>
 #include <pcl/sample_consensus/rmsac.h>
 #include <pcl/sample_consensus/mlesac.h>
+#include <pcl/sample_consensus/prosac.h>
 #include <pcl/sample_consensus/sac_model.h>
 #include <pcl/sample_consensus/sac_model_plane.h>
 #include <pcl/sample_consensus/sac_model_sphere.h>
@@ -57,6 +58,8 @@
 #include <pcl/sample_consensus/sac_model_normal_sphere.h>
 #include <pcl/sample_consensus/sac_model_parallel_plane.h>
 #include <pcl/sample_consensus/sac_model_normal_parallel_plane.h>
+#include <pcl/sample_consensus/sac_model_registration.h>
+#include <pcl/common/transforms.h>
 #include <pcl/features/normal_3d.h>
 
 using namespace pcl;
@@ -74,6 +77,7 @@ typedef SampleConsensusModelNormalPlane<PointXYZ, Normal>::Ptr SampleConsensusMo
 typedef SampleConsensusModelNormalSphere<PointXYZ, Normal>::Ptr SampleConsensusModelNormalSpherePtr;
 typedef SampleConsensusModelParallelPlane<PointXYZ>::Ptr SampleConsensusModelParallelPlanePtr;
 typedef SampleConsensusModelNormalParallelPlane<PointXYZ, Normal>::Ptr SampleConsensusModelNormalParallelPlanePtr;
+typedef SampleConsensusModelRegistration<PointXYZ>::Ptr SampleConsensusModelRegistrationPtr;
 
 PointCloud<PointXYZ>::Ptr cloud_ (new PointCloud<PointXYZ> ());
 PointCloud<Normal>::Ptr normals_ (new PointCloud<Normal> ());
@@ -131,6 +135,40 @@ void verifyPlaneSac (ModelType & model, SacType & sac, unsigned int inlier_numbe
   EXPECT_NEAR (proj_points.points[50].z,  0.0587, refined_tol);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename SacType>
+void verifyPlaneSacThreads (float threshold = 0.03f)
+{
+  // The hypotheses are processed in the order they are drawn, so the result must not depend on the number of threads
+  SampleConsensusModelPlanePtr model_serial (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+  SacType sac_serial (model_serial, threshold);
+  ASSERT_EQ (sac_serial.getNumberOfThreads (), 1u);
+  ASSERT_TRUE (sac_serial.computeModel ());
+
+  SampleConsensusModelPlanePtr model_parallel (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+  SacType sac_parallel (model_parallel, threshold);
+  sac_parallel.setNumberOfThreads (4);
+  ASSERT_EQ (sac_parallel.getNumberOfThreads (), 4u);
+  ASSERT_TRUE (sac_parallel.computeModel ());
+
+  std::vector<int> sample_serial, sample_parallel;
+  sac_serial.getModel (sample_serial);
+  sac_parallel.getModel (sample_parallel);
+  EXPECT_TRUE (sample_serial == sample_parallel);
+
+  std::vector<int> inliers_serial, inliers_parallel;
+  sac_serial.getInliers (inliers_serial);
+  sac_parallel.getInliers (inliers_parallel);
+  EXPECT_TRUE (inliers_serial == inliers_parallel);
+
+  Eigen::VectorXf coeff_serial, coeff_parallel;
+  sac_serial.getModelCoefficients (coeff_serial);
+  sac_parallel.getModelCoefficients (coeff_parallel);
+  ASSERT_EQ (coeff_serial.size (), coeff_parallel.size ());
+  for (int i = 0; i < coeff_serial.size (); ++i)
+    EXPECT_EQ (coeff_serial[i], coeff_parallel[i]);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelPlane, Base)
 {
@@ -325,6 +363,97 @@ TEST (MLESAC, SampleConsensusModelPlane)
   verifyPlaneSac(model, sac, 1000, 0.3f, 0.2f, 0.01f);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SAC, NumberOfThreads)
+{
+  verifyPlaneSacThreads<RandomSampleConsensus<PointXYZ> > ();
+  verifyPlaneSacThreads<MEstimatorSampleConsensus<PointXYZ> > ();
+  verifyPlaneSacThreads<MaximumLikelihoodSampleConsensus<PointXYZ> > ();
+  verifyPlaneSacThreads<ProgressiveSampleConsensus<PointXYZ> > ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RANSAC, PreemptiveScoring)
+{
+  srand (0);
+  // Create a shared plane model pointer directly
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+
+  // Create the RANSAC object
+  RandomSampleConsensus<PointXYZ> sac (model, 0.03);
+  sac.setMaxIterations (200);
+  sac.setPreemptiveScoring (true);
+  ASSERT_TRUE (sac.getPreemptiveScoring ());
+  sac.setPreemptiveBlockSize (50);
+  ASSERT_EQ (sac.getPreemptiveBlockSize (), 50);
+  sac.setNumberOfThreads (0);
+
+  // Preemption selects the model on a subset of the points only
+  verifyPlaneSac (model, sac, 1000, 0.3f, 0.2f, 0.01f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (MSAC, PreemptiveScoring)
+{
+  srand (0);
+  // Create a shared plane model pointer directly
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+
+  // Create the MSAC object
+  MEstimatorSampleConsensus<PointXYZ> sac (model, 0.03);
+  sac.setMaxIterations (200);
+  sac.setPreemptiveScoring (true);
+  sac.setNumberOfThreads (0);
+
+  // Preemption selects the model on a subset of the points only
+  verifyPlaneSac (model, sac, 1000, 0.3f, 0.2f, 0.01f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RANSAC, PreemptiveScoringRegistration)
+{
+  srand (0);
+  // Move the cloud rigidly, and break every fifth correspondence
+  Eigen::Affine3f transform (Eigen::AngleAxisf (0.3f, Eigen::Vector3f::UnitZ ()));
+  transform.translation () << 0.5f, -0.2f, 0.1f;
+  PointCloud<PointXYZ>::Ptr target (new PointCloud<PointXYZ>);
+  transformPointCloud (*cloud_, *target, transform);
+
+  const int nr_points = static_cast<int> (cloud_->points.size ());
+  vector<int> indices_src (nr_points), indices_tgt (nr_points);
+  int nr_good = 0;
+  for (int i = 0; i < nr_points; ++i)
+  {
+    indices_src[i] = i;
+    indices_tgt[i] = (i % 5 == 0) ? (i + nr_points / 2) % nr_points : i;
+    if (indices_tgt[i] == i)
+      ++nr_good;
+  }
+
+  SampleConsensusModelRegistrationPtr model (new SampleConsensusModelRegistration<PointXYZ> (cloud_, indices_src));
+  model->setInputTarget (target, indices_tgt);
+
+  // The blocks restrict the source and the target indices together
+  RandomSampleConsensus<PointXYZ> sac (model, 0.01);
+  sac.setMaxIterations (200);
+  sac.setPreemptiveScoring (true);
+  sac.setPreemptiveBlockSize (50);
+  sac.setNumberOfThreads (0);
+  ASSERT_TRUE (sac.computeModel ());
+
+  vector<int> inliers;
+  sac.getInliers (inliers);
+  EXPECT_EQ (nr_good, static_cast<int> (inliers.size ()));
+  EXPECT_EQ (nr_points, static_cast<int> (model->getIndices ()->size ()));
+
+  Eigen::VectorXf coeff;
+  sac.getModelCoefficients (coeff);
+  ASSERT_EQ (16, coeff.size ());
+  for (int r = 0; r < 4; ++r)
+    for (int c = 0; c < 4; ++c)
+      EXPECT_NEAR (transform.matrix () (r, c), coeff[r * 4 + c], 1e-3);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RANSAC, SampleConsensusModelSphere)
 {
@@ -795,6 +924,115 @@ TEST (RANSAC, SampleConsensusModelLine)
   EXPECT_NEAR (proj_points.points[5].z, 18.0, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModel, VectorizedDistances)
+{
+  // Use a number of indices which is not a multiple of the SIMD packet size, to exercise the padded tail
+  vector<int> indices (cloud_->points.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+    indices[i] = static_cast<int> (indices.size () - 1 - i);
+
+  Eigen::VectorXf plane (4), sphere (4), circle (3), line (6);
+  plane  << 0.1f, -0.5f, 0.8f, 0.02f;
+  sphere << 0.01f, 0.12f, 0.03f, 0.05f;
+  circle << -0.02f, 0.11f, 0.04f;
+  line   << 0.0f, 0.1f, 0.0f, 1.0f, 2.0f, -0.5f;
+
+  SampleConsensusModelPlane<PointXYZ> plane_model (cloud_, indices);
+  SampleConsensusModelSphere<PointXYZ> sphere_model (cloud_, indices);
+  SampleConsensusModelCircle2D<PointXYZ> circle_model (cloud_, indices);
+  SampleConsensusModelLine<PointXYZ> line_model (cloud_, indices);
+
+  vector<double> plane_distances, sphere_distances, circle_distances, line_distances;
+  plane_model.getDistancesToModel (plane, plane_distances);
+  sphere_model.getDistancesToModel (sphere, sphere_distances);
+  circle_model.getDistancesToModel (circle, circle_distances);
+  line_model.getDistancesToModel (line, line_distances);
+  ASSERT_EQ (plane_distances.size (), indices.size ());
+  ASSERT_EQ (sphere_distances.size (), indices.size ());
+  ASSERT_EQ (circle_distances.size (), indices.size ());
+  ASSERT_EQ (line_distances.size (), indices.size ());
+
+  // Compare against the plain scalar formulas
+  Eigen::Vector3f line_dir = line.segment<3> (3).normalized ();
+  int nr_plane_inliers = 0;
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    Eigen::Vector3f p = cloud_->points[indices[i]].getVector3fMap ();
+    double d_plane = fabs (plane.head<3> ().dot (p) + plane[3]);
+    double d_sphere = fabs ((p - sphere.head<3> ()).norm () - sphere[3]);
+    double d_circle = fabs ((p.head<2> () - circle.head<2> ()).norm () - circle[2]);
+    double d_line = (line.head<3> () - p).cross (line_dir).norm ();
+    EXPECT_NEAR (plane_distances[i], d_plane, 1e-5);
+    EXPECT_NEAR (sphere_distances[i], d_sphere, 1e-5);
+    EXPECT_NEAR (circle_distances[i], d_circle, 1e-5);
+    EXPECT_NEAR (line_distances[i], d_line, 1e-5);
+    if (plane_distances[i] < 0.01)
+      ++nr_plane_inliers;
+  }
+
+  // Counting and selecting agree with the distances
+  vector<int> inliers;
+  plane_model.selectWithinDistance (plane, 0.01, inliers);
+  EXPECT_EQ (plane_model.countWithinDistance (plane, 0.01), nr_plane_inliers);
+  EXPECT_EQ (int (inliers.size ()), nr_plane_inliers);
+  for (size_t i = 1; i < inliers.size (); ++i)
+    EXPECT_LT (inliers[i], inliers[i - 1]);
+
+  // Cylinder: points on, inside and outside the surface, and close to the axis, where the direction from the
+  // axis to the point is short. The axis direction is deliberately not normalized.
+  Eigen::VectorXf cylinder (7);
+  cylinder << 0.1f, -0.2f, 0.3f, 0.3f, 0.4f, 1.0f, 0.05f;
+  const Eigen::Vector3f axis = cylinder.segment<3> (3).normalized ();
+  const Eigen::Vector3f u = axis.unitOrthogonal (), v = axis.cross (u);
+  const float radii[] = { 0.05f, 0.045f, 0.08f, 0.01f, 1e-3f, 1e-4f };
+  PointCloud<PointXYZ>::Ptr cylinder_cloud (new PointCloud<PointXYZ>);
+  PointCloud<Normal>::Ptr cylinder_normals (new PointCloud<Normal>);
+  for (int i = 0; i < 103; ++i)
+  {
+    const Eigen::Vector3f radial = cosf (0.37f * static_cast<float> (i)) * u + sinf (0.37f * static_cast<float> (i)) * v;
+    PointXYZ p;
+    p.getVector3fMap () = cylinder.head<3> () + 0.01f * static_cast<float> (i - 50) * axis + radii[i % 6] * radial;
+    Normal n;
+    n.getNormalVector3fMap () = (radial + 0.3f * static_cast<float> (i % 4) * axis).normalized ();
+    cylinder_cloud->points.push_back (p);
+    cylinder_normals->points.push_back (n);
+  }
+  vector<int> cylinder_indices (cylinder_cloud->points.size ());
+  for (size_t i = 0; i < cylinder_indices.size (); ++i)
+    cylinder_indices[i] = static_cast<int> (i);
+
+  SampleConsensusModelCylinder<PointXYZ, Normal> cylinder_model (cylinder_cloud, cylinder_indices);
+  cylinder_model.setInputNormals (cylinder_normals);
+  cylinder_model.setNormalDistanceWeight (0.1);
+  vector<double> cylinder_distances;
+  cylinder_model.getDistancesToModel (cylinder, cylinder_distances);
+  ASSERT_EQ (cylinder_distances.size (), cylinder_indices.size ());
+
+  // Scalar reference: the Euclidean distance to the surface, blended with the angle between the normal and the
+  // direction from the projection of the point on the axis to the point
+  const Eigen::Vector4f axis_pt (cylinder[0], cylinder[1], cylinder[2], 0);
+  const Eigen::Vector4f axis_dir (cylinder[3], cylinder[4], cylinder[5], 0);
+  int nr_cylinder_inliers = 0;
+  for (size_t i = 0; i < cylinder_indices.size (); ++i)
+  {
+    const Eigen::Vector4f pt (cylinder_cloud->points[i].x, cylinder_cloud->points[i].y, cylinder_cloud->points[i].z, 0);
+    const Eigen::Vector4f n (cylinder_normals->points[i].normal_x, cylinder_normals->points[i].normal_y,
+                             cylinder_normals->points[i].normal_z, 0);
+    double d_euclid = fabs (sqrt (sqrPointToLineDistance (pt, axis_pt, axis_dir)) - cylinder[6]);
+    float k = (pt - axis_pt).dot (axis_dir) / axis_dir.dot (axis_dir);
+    double d_normal = fabs (getAngle3D (n, pt - (axis_pt + k * axis_dir)));
+    d_normal = (std::min) (d_normal, M_PI - d_normal);
+    double d_cylinder = fabs (0.1 * d_normal + 0.9 * d_euclid);
+    EXPECT_NEAR (cylinder_distances[i], d_cylinder, 2e-4);
+    if (cylinder_distances[i] < 0.01)
+      ++nr_cylinder_inliers;
+  }
+  cylinder_model.selectWithinDistance (cylinder, 0.01, inliers);
+  EXPECT_EQ (cylinder_model.countWithinDistance (cylinder, 0.01), nr_cylinder_inliers);
+  EXPECT_EQ (int (inliers.size ()), nr_cylinder_inliers);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RANSAC, SampleConsensusModelNormalPlane)
 {
@@ -45,6 +45,7 @@
 #include <pcl/search/search.h>
 #include <pcl/features/normal_3d.h>
 
+#include <pcl/segmentation/extract_clusters.h>
 #include <pcl/segmentation/extract_polygonal_prism_data.h>
 #include <pcl/segmentation/segment_differences.h>
 #include <pcl/segmentation/region_growing.h>
@@ -386,6 +387,128 @@ TEST (ExtractPolygonalPrism, Segmentation)
   EXPECT_EQ (static_cast<int> (output.indices.size ()), 0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, ParallelMatchesSerial)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> (*cloud_));
+
+  // Every other point only, to go through the indices mapping
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (int i = 0; i < static_cast<int> (cloud->points.size ()); i += 2)
+    indices->push_back (i);
+
+  const double tolerances[] = { 0.004, 0.008, 0.012 };
+  for (size_t t = 0; t < sizeof (tolerances) / sizeof (tolerances[0]); ++t)
+  {
+    for (int use_indices = 0; use_indices < 2; ++use_indices)
+    {
+      EuclideanClusterExtraction<PointXYZ> ec;
+      ec.setInputCloud (cloud);
+      if (use_indices)
+        ec.setIndices (indices);
+      ec.setClusterTolerance (tolerances[t]);
+      ec.setMinClusterSize (2);
+      ec.setMaxClusterSize (150);
+
+      std::vector<PointIndices> serial_clusters, parallel_clusters;
+      ec.setNumberOfThreads (1);
+      EXPECT_EQ (1u, ec.getNumberOfThreads ());
+      ec.extract (serial_clusters);
+      ec.setNumberOfThreads (4);
+      ec.extract (parallel_clusters);
+
+      ASSERT_EQ (serial_clusters.size (), parallel_clusters.size ());
+      for (size_t c = 0; c < serial_clusters.size (); ++c)
+      {
+        EXPECT_GE (serial_clusters[c].indices.size (), 2u);
+        EXPECT_LE (serial_clusters[c].indices.size (), 150u);
+        EXPECT_EQ (serial_clusters[c].indices, parallel_clusters[c].indices);
+      }
+    }
+  }
+
+  // Three well separated blobs, one of them too small to be reported
+  PointCloud<PointXYZ>::Ptr blobs (new PointCloud<PointXYZ>);
+  const int blob_sizes[] = { 300, 150, 3 };
+  for (int b = 0; b < 3; ++b)
+    for (int i = 0; i < blob_sizes[b]; ++i)
+      blobs->points.push_back (PointXYZ (10.0f * static_cast<float> (b) + 0.01f * static_cast<float> (i % 10),
+                                         0.01f * static_cast<float> (i / 10), 0.0f));
+  blobs->width = static_cast<uint32_t> (blobs->points.size ());
+  blobs->height = 1;
+
+  search::Search<PointXYZ>::Ptr tree (new search::KdTree<PointXYZ>);
+  tree->setInputCloud (blobs);
+  std::vector<PointIndices> clusters;
+  extractEuclideanClusters (*blobs, tree, 0.015f, clusters, 5, 1000, 4);
+  ASSERT_EQ (2u, clusters.size ());
+  EXPECT_EQ (300u, clusters[0].indices.size ());
+  EXPECT_EQ (150u, clusters[1].indices.size ());
+  EXPECT_EQ (0, clusters[0].indices.front ());
+  EXPECT_EQ (300, clusters[1].indices.front ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, VoxelGridMatchesSearch)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> (*cloud_));
+
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (int i = 0; i < static_cast<int> (cloud->points.size ()); i += 2)
+    indices->push_back (i);
+
+  const double tolerances[] = { 0.004, 0.008, 0.012 };
+  for (size_t t = 0; t < sizeof (tolerances) / sizeof (tolerances[0]); ++t)
+  {
+    for (int use_indices = 0; use_indices < 2; ++use_indices)
+    {
+      EuclideanClusterExtraction<PointXYZ> ec;
+      ec.setInputCloud (cloud);
+      if (use_indices)
+        ec.setIndices (indices);
+      ec.setClusterTolerance (tolerances[t]);
+      ec.setMinClusterSize (2);
+      ec.setMaxClusterSize (150);
+
+      std::vector<PointIndices> search_clusters, grid_clusters, parallel_grid_clusters;
+      ec.extract (search_clusters);
+      ec.setUseVoxelGrid (true);
+      EXPECT_TRUE (ec.getUseVoxelGrid ());
+      ec.extract (grid_clusters);
+      ec.setNumberOfThreads (4);
+      ec.extract (parallel_grid_clusters);
+
+      ASSERT_EQ (search_clusters.size (), grid_clusters.size ());
+      ASSERT_EQ (search_clusters.size (), parallel_grid_clusters.size ());
+      for (size_t c = 0; c < search_clusters.size (); ++c)
+      {
+        EXPECT_EQ (search_clusters[c].indices, grid_clusters[c].indices);
+        EXPECT_EQ (search_clusters[c].indices, parallel_grid_clusters[c].indices);
+      }
+    }
+  }
+
+  // Points in neighboring cells, across the origin, and a non-finite point
+  PointCloud<PointXYZ> line;
+  for (int i = -20; i < 20; ++i)
+    line.points.push_back (PointXYZ (0.009f * static_cast<float> (i), 0.0f, 0.0f));
+  line.points.push_back (PointXYZ (std::numeric_limits<float>::quiet_NaN (), 0.0f, 0.0f));
+  line.points.push_back (PointXYZ (1.0f, 1.0f, 1.0f));
+  line.width = static_cast<uint32_t> (line.points.size ());
+  line.height = 1;
+
+  std::vector<int> all (line.points.size ());
+  for (size_t i = 0; i < all.size (); ++i)
+    all[i] = static_cast<int> (i);
+
+  std::vector<PointIndices> clusters;
+  extractEuclideanClustersVoxelGrid (line, all, 0.01f, clusters, 1, 1000, 4);
+  ASSERT_EQ (2u, clusters.size ());
+  EXPECT_EQ (40u, clusters[0].indices.size ());
+  ASSERT_EQ (1u, clusters[1].indices.size ());
+  EXPECT_EQ (41, clusters[1].indices[0]);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -0,0 +1,271 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl/common/common.h>
+#include <pcl/octree/octree.h>
+#include <pcl/octree/octree_impl.h>
+#include <pcl/compression/entropy_range_coder.h>
+#include <pcl/compression/octree_occupancy_coder.h>
+#include <pcl/compression/octree_pointcloud_compression.h>
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/time.h>
+#include <pcl/common/time.h>
+#include <sstream>
+
+using namespace pcl;
+using namespace pcl::io;
+using namespace pcl::console;
+using namespace pcl::octree;
+
+typedef OctreeContainerDataTVector<int> LeafT;
+typedef OctreeContainerEmpty<int> BranchT;
+typedef OctreePointCloud<PointXYZRGB, LeafT, BranchT, Octree2BufBase<int, LeafT, BranchT> > DoubleBufferOctree;
+
+double default_resolution = 0.002;
+int    default_profile = MED_RES_ONLINE_COMPRESSION_WITH_COLOR;
+int    default_frames = 0;
+int    default_iframe_rate = 30;
+
+void
+printHelp (int, char **argv)
+{
+  print_error ("Syntax is: %s input1.pcd [input2.pcd ...] <options>\n", argv[0]);
+  print_info ("  where options are:\n");
+  print_info ("                     -resolution X = octree leaf voxel size of the octree structure benchmark (default: ");
+  print_value ("%f", default_resolution); print_info (")\n");
+  print_info ("                     -profile X    = compression profile of the point cloud compression benchmark (default: ");
+  print_value ("%d", default_profile); print_info (")\n");
+  print_info ("                     -frames X     = amount of frames, the input files are repeated (default: ");
+  print_value ("%d", default_frames); print_info (", one frame per input file)\n");
+  print_info ("                     -iframe_rate X = amount of P-frames between two I-frames of the octree structure benchmark (default: ");
+  print_value ("%d", default_iframe_rate); print_info (")\n");
+}
+
+bool
+loadCloud (const std::string &filename, PointCloud<PointXYZRGB> &cloud)
+{
+  TicToc tt;
+  print_highlight ("Loading "); print_value ("%s ", filename.c_str ());
+
+  PointCloud<PointXYZRGB> input;
+  tt.tic ();
+  if (loadPCDFile (filename, input) < 0)
+    return (false);
+
+  // the octree does not accept NaN points
+  cloud.points.clear ();
+  for (size_t i = 0; i < input.points.size (); ++i)
+    if (isFinite (input.points[i]))
+      cloud.points.push_back (input.points[i]);
+  cloud.width = static_cast<uint32_t> (cloud.points.size ());
+  cloud.height = 1;
+
+  print_info ("[done, "); print_value ("%g", tt.toc ()); print_info (" ms : "); print_value ("%d", cloud.width * cloud.height); print_info (" finite points]\n");
+
+  return (true);
+}
+
+/** \brief Entropy code the serialized octree structure of every frame with the static range coder and with the
+  * context-adaptive occupancy coder, and check that the occupancy coder restores the structure.
+  */
+void
+benchmarkTreeCoding (const std::vector<PointCloud<PointXYZRGB>::Ptr> &frames, double resolution, int iframe_rate)
+{
+  DoubleBufferOctree octree (resolution);
+  StaticRangeCoder static_coder;
+  OctreeOccupancyCoder occupancy_coder, occupancy_decoder;
+  std::vector<char> tree, decoded_tree, occupancy, prev_occupancy, decoded_occupancy, prev_decoded_occupancy;
+  size_t points = 0, tree_bytes = 0, static_bytes = 0, occupancy_bytes = 0;
+  double static_time = 0, occupancy_time = 0;
+  bool restored = true;
+  double start;
+
+  // use a common bounding box for all frames
+  PointXYZRGB min_pt, max_pt, frame_min, frame_max;
+  getMinMax3D (*frames[0], min_pt, max_pt);
+  for (size_t i = 1; i < frames.size (); ++i)
+  {
+    getMinMax3D (*frames[i], frame_min, frame_max);
+    min_pt.getVector3fMap () = min_pt.getVector3fMap ().cwiseMin (frame_min.getVector3fMap ());
+    max_pt.getVector3fMap () = max_pt.getVector3fMap ().cwiseMax (frame_max.getVector3fMap ());
+  }
+  octree.defineBoundingBox (min_pt.x, min_pt.y, min_pt.z, max_pt.x, max_pt.y, max_pt.z);
+
+  for (size_t i = 0; i < frames.size (); ++i)
+  {
+    bool p_frame = (i % (iframe_rate + 1)) != 0;
+
+    octree.setInputCloud (frames[i]);
+    octree.addPointsFromInputCloud ();
+    octree.serializeTree (tree, p_frame);
+    octree.switchBuffers ();
+
+    std::stringstream static_stream, occupancy_stream;
+
+    start = getTime ();
+    static_coder.encodeCharVectorToStream (tree, static_stream);
+    static_time += getTime () - start;
+
+    start = getTime ();
+    occupancy_coder.encodeTreeToStream (tree, prev_occupancy, octree.getTreeDepth (), p_frame, occupancy,
+                                        occupancy_stream);
+    occupancy_time += getTime () - start;
+    prev_occupancy.swap (occupancy);
+
+    occupancy_decoder.decodeStreamToTree (occupancy_stream, prev_decoded_occupancy, octree.getTreeDepth (), p_frame,
+                                          decoded_tree, decoded_occupancy);
+    prev_decoded_occupancy.swap (decoded_occupancy);
+    restored &= (decoded_tree == tree);
+
+    points += frames[i]->points.size ();
+    tree_bytes += tree.size ();
+    static_bytes += static_stream.str ().size ();
+    occupancy_bytes += occupancy_stream.str ().size ();
+  }
+
+  print_info ("Octree structure, resolution "); print_value ("%g", resolution);
+  print_info (", "); print_value ("%zu", tree_bytes / frames.size ()); print_info (" branch nodes per frame\n");
+  print_info ("  static range coder    : "); print_value ("%6.3f", 8.0 * static_bytes / points);
+  print_info (" bits per point, encode "); print_value ("%7.2f", tree_bytes / (1.0e6 * static_time)); print_info (" MB/s\n");
+  print_info ("  context-adaptive coder: "); print_value ("%6.3f", 8.0 * occupancy_bytes / points);
+  print_info (" bits per point, encode "); print_value ("%7.2f", tree_bytes / (1.0e6 * occupancy_time)); print_info (" MB/s\n");
+
+  if (!restored)
+    print_error ("Decoded octree structure differs!\n");
+}
+
+/** \brief Compress all frames with OctreePointCloudCompression, coding the octree structure with the static range
+  * coder or the context-adaptive occupancy coder.
+  */
+void
+benchmarkCompression (const std::vector<PointCloud<PointXYZRGB>::Ptr> &frames, int profile, bool context_adaptive)
+{
+  OctreePointCloudCompression<PointXYZRGB> encoder (static_cast<compression_Profiles_e> (profile), false);
+  OctreePointCloudCompression<PointXYZRGB> decoder;
+  size_t points = 0, bytes = 0;
+  double time = 0;
+
+  encoder.setContextAdaptiveTreeCoding (context_adaptive);
+
+  for (size_t i = 0; i < frames.size (); ++i)
+  {
+    std::stringstream stream;
+
+    double start = getTime ();
+    encoder.encodePointCloud (frames[i], stream);
+    time += getTime () - start;
+
+    PointCloud<PointXYZRGB>::Ptr decoded (new PointCloud<PointXYZRGB>);
+    decoder.decodePointCloud (stream, decoded);
+
+    points += frames[i]->points.size ();
+    bytes += stream.str ().size ();
+  }
+
+  // input size of a point: 3 coordinates and color
+  size_t input_bytes = points * (3 * sizeof (float) + sizeof (uint32_t));
+
+  print_info (context_adaptive ? "  context-adaptive coder: " : "  static range coder    : ");
+  print_value ("%6.3f", 8.0 * bytes / points);
+  print_info (" bits per point, encode "); print_value ("%7.2f", input_bytes / (1.0e6 * time)); print_info (" MB/s\n");
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Compare the static range coder and the context-adaptive occupancy coder on octree streams. For more information, use: %s -h\n", argv[0]);
+
+  if (argc < 2)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  // Parse the command line arguments for .pcd files
+  std::vector<int> p_file_indices;
+  p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
+  if (p_file_indices.empty ())
+  {
+    print_error ("Need at least one input PCD file to continue.\n");
+    return (-1);
+  }
+
+  // Command line parsing
+  double resolution = default_resolution;
+  parse_argument (argc, argv, "-resolution", resolution);
+  int profile = default_profile;
+  parse_argument (argc, argv, "-profile", profile);
+  int frame_count = default_frames;
+  parse_argument (argc, argv, "-frames", frame_count);
+  int iframe_rate = default_iframe_rate;
+  parse_argument (argc, argv, "-iframe_rate", iframe_rate);
+
+  if (profile < 0 || profile >= COMPRESSION_PROFILE_COUNT)
+  {
+    print_error ("Invalid compression profile %d.\n", profile);
+    return (-1);
+  }
+
+  // Load the files
+  std::vector<PointCloud<PointXYZRGB>::Ptr> clouds;
+  for (size_t i = 0; i < p_file_indices.size (); ++i)
+  {
+    PointCloud<PointXYZRGB>::Ptr cloud (new PointCloud<PointXYZRGB>);
+    if (!loadCloud (argv[p_file_indices[i]], *cloud))
+      return (-1);
+    clouds.push_back (cloud);
+  }
+
+  if (frame_count <= 0)
+    frame_count = static_cast<int> (clouds.size ());
+
+  std::vector<PointCloud<PointXYZRGB>::Ptr> frames;
+  for (int i = 0; i < frame_count; ++i)
+    frames.push_back (clouds[i % clouds.size ()]);
+
+  benchmarkTreeCoding (frames, resolution, iframe_rate);
+
+  print_info ("Point cloud compression, profile "); print_value ("%d\n", profile);
+  benchmarkCompression (frames, profile, false);
+  benchmarkCompression (frames, profile, true);
+
+  return (0);
+}
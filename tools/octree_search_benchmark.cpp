@@ -0,0 +1,245 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl/octree/octree.h>
+#include <pcl/octree/octree_impl.h>
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/time.h>
+
+using namespace pcl;
+using namespace pcl::io;
+using namespace pcl::console;
+using namespace pcl::octree;
+
+typedef OctreeContainerDataTVector<int> LeafT;
+typedef OctreeContainerEmpty<int> BranchT;
+typedef OctreePointCloudSearch<PointXYZ, LeafT, BranchT> PointerOctree;
+typedef OctreePointCloudSearch<PointXYZ, LeafT, BranchT, OctreeLinearBase<int, LeafT, BranchT> > LinearOctree;
+
+double default_resolution = 0.01;
+int    default_k = 10;
+double default_radius = 0.02;
+int    default_threads = 0;
+
+void
+printHelp (int, char **argv)
+{
+  print_error ("Syntax is: %s input.pcd <options>\n", argv[0]);
+  print_info ("  where options are:\n");
+  print_info ("                     -resolution X = octree leaf voxel size (default: ");
+  print_value ("%f", default_resolution); print_info (")\n");
+  print_info ("                     -k X          = number of nearest neighbors (default: ");
+  print_value ("%d", default_k); print_info (")\n");
+  print_info ("                     -radius X     = radius search radius (default: ");
+  print_value ("%f", default_radius); print_info (")\n");
+  print_info ("                     -threads X    = number of threads of the bulk build and batch searches (default: ");
+  print_value ("%d", default_threads); print_info (", automatic)\n");
+}
+
+bool
+loadCloud (const std::string &filename, PointCloud<PointXYZ> &cloud)
+{
+  TicToc tt;
+  print_highlight ("Loading "); print_value ("%s ", filename.c_str ());
+
+  tt.tic ();
+  if (loadPCDFile (filename, cloud) < 0)
+    return (false);
+  print_info ("[done, "); print_value ("%g", tt.toc ()); print_info (" ms : "); print_value ("%d", cloud.width * cloud.height); print_info (" points]\n");
+
+  return (true);
+}
+
+/** \brief Build an octree and time voxel, k nearest neighbor and radius searches at every point of the cloud, one by
+  * one and as batch.
+  * \return checksum of the search results, equal for octree implementations that find the same neighbors
+  */
+template <typename OctreeT> size_t
+benchmark (const char *name, const PointCloud<PointXYZ>::ConstPtr &cloud, double resolution, int k, double radius,
+           unsigned int threads, std::vector<double> &times)
+{
+  OctreeT octree (resolution);
+  std::vector<int> indices;
+  std::vector<float> distances;
+  std::vector<std::vector<int> > batch_indices;
+  std::vector<std::vector<float> > batch_distances;
+  size_t voxel_checksum = 0, radius_checksum = 0, batch_radius_checksum = 0;
+  double knn_checksum = 0, batch_knn_checksum = 0;
+  TicToc tt;
+
+  times.clear ();
+  octree.setNumberOfThreads (threads);
+
+  tt.tic ();
+  octree.setInputCloud (cloud);
+  octree.addPointsFromInputCloudBulk ();
+  times.push_back (tt.toc ());
+
+  tt.tic ();
+  for (size_t i = 0; i < cloud->points.size (); ++i)
+  {
+    if (!isFinite (cloud->points[i]))
+      continue;
+    octree.voxelSearch (cloud->points[i], indices);
+    voxel_checksum += indices.size ();
+  }
+  times.push_back (tt.toc ());
+
+  tt.tic ();
+  for (size_t i = 0; i < cloud->points.size (); ++i)
+  {
+    if (!isFinite (cloud->points[i]))
+      continue;
+    octree.nearestKSearch (cloud->points[i], k, indices, distances);
+    if (!distances.empty ())
+      knn_checksum += distances.back ();
+  }
+  times.push_back (tt.toc ());
+
+  tt.tic ();
+  for (size_t i = 0; i < cloud->points.size (); ++i)
+  {
+    if (!isFinite (cloud->points[i]))
+      continue;
+    octree.radiusSearch (cloud->points[i], radius, indices, distances);
+    radius_checksum += indices.size ();
+  }
+  times.push_back (tt.toc ());
+
+  tt.tic ();
+  octree.nearestKSearch (*cloud, std::vector<int> (), k, batch_indices, batch_distances);
+  times.push_back (tt.toc ());
+  for (size_t i = 0; i < batch_indices.size (); ++i)
+    if (!batch_distances[i].empty ())
+      batch_knn_checksum += batch_distances[i].back ();
+
+  tt.tic ();
+  octree.radiusSearch (*cloud, std::vector<int> (), radius, batch_indices, batch_distances);
+  times.push_back (tt.toc ());
+  for (size_t i = 0; i < batch_indices.size (); ++i)
+    batch_radius_checksum += batch_indices[i].size ();
+
+  print_info ("%-8s : ", name);
+  print_value ("%zu", octree.getBranchCount ()); print_info (" branch nodes, ");
+  print_value ("%zu", octree.getLeafCount ()); print_info (" leaf nodes, build ");
+  print_value ("%g", times[0]); print_info (" ms, voxel search ");
+  print_value ("%g", times[1]); print_info (" ms, %d-NN search ", k);
+  print_value ("%g", times[2]); print_info (" ms (batch ");
+  print_value ("%g", times[4]); print_info (" ms), radius search ");
+  print_value ("%g", times[3]); print_info (" ms (batch ");
+  print_value ("%g", times[5]); print_info (" ms)\n");
+
+  if (batch_knn_checksum != knn_checksum || batch_radius_checksum != radius_checksum)
+    print_error ("Batch search results differ!\n");
+
+  return (voxel_checksum + radius_checksum + static_cast<size_t> (knn_checksum));
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Compare memory and search times of pointer based and linear octrees. For more information, use: %s -h\n", argv[0]);
+
+  if (argc < 2)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  // Parse the command line arguments for .pcd files
+  std::vector<int> p_file_indices;
+  p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
+  if (p_file_indices.size () != 1)
+  {
+    print_error ("Need one input PCD file to continue.\n");
+    return (-1);
+  }
+
+  // Command line parsing
+  double resolution = default_resolution;
+  parse_argument (argc, argv, "-resolution", resolution);
+  int k = default_k;
+  parse_argument (argc, argv, "-k", k);
+  double radius = default_radius;
+  parse_argument (argc, argv, "-radius", radius);
+  int threads = default_threads;
+  parse_argument (argc, argv, "-threads", threads);
+
+  // Load the first file
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  if (!loadCloud (argv[p_file_indices[0]], *cloud))
+    return (-1);
+
+  std::vector<double> pointer_times, linear_times;
+  size_t pointer_checksum = benchmark<PointerOctree> ("Pointer", cloud, resolution, k, radius, threads, pointer_times);
+  size_t linear_checksum = benchmark<LinearOctree> ("Linear", cloud, resolution, k, radius, threads, linear_times);
+
+  if (pointer_checksum != linear_checksum)
+    print_error ("Search results differ!\n");
+
+  // node memory: pointer based nodes are allocated one by one, linear nodes are stored in two arrays
+  PointerOctree pointer_octree (resolution);
+  pointer_octree.setInputCloud (cloud);
+  pointer_octree.addPointsFromInputCloudBulk ();
+  LinearOctree linear_octree (resolution);
+  linear_octree.setInputCloud (cloud);
+  linear_octree.addPointsFromInputCloudBulk ();
+
+  size_t pointer_memory = pointer_octree.getBranchCount () * sizeof (PointerOctree::BranchNode)
+                        + pointer_octree.getLeafCount () * sizeof (PointerOctree::LeafNode);
+  size_t linear_memory = linear_octree.getNodeMemory ();
+
+  print_info ("Node memory: pointer "); print_value ("%zu", pointer_memory);
+  print_info (" bytes (without allocator overhead), linear "); print_value ("%zu", linear_memory);
+  print_info (" bytes, ratio "); print_value ("%4.2f\n", static_cast<double> (pointer_memory) / static_cast<double> (linear_memory));
+
+  const char *names[] = { "build", "voxel search", "k-NN search", "radius search", "batch k-NN", "batch radius" };
+  for (size_t i = 0; i < pointer_times.size (); ++i)
+  {
+    print_info ("Speedup %-13s: ", names[i]);
+    if (linear_times[i] > 0)
+      print_value ("%5.2f\n", pointer_times[i] / linear_times[i]);
+    else
+      print_info ("n/a\n");
+  }
+
+  return (0);
+}
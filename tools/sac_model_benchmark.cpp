@@ -0,0 +1,254 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl/common/centroid.h>
+#include <pcl/sample_consensus/sac_model_plane.h>
+#include <pcl/sample_consensus/sac_model_sphere.h>
+#include <pcl/sample_consensus/sac_model_circle.h>
+#include <pcl/sample_consensus/sac_model_line.h>
+#include <pcl/sample_consensus/sac_model_cylinder.h>
+#include <pcl/sample_consensus/sac_simd.h>
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/time.h>
+
+using namespace pcl;
+using namespace pcl::io;
+using namespace pcl::console;
+
+double default_threshold = 0.01;
+int    default_iterations = 1000;
+
+void
+printHelp (int, char **argv)
+{
+  print_error ("Syntax is: %s input.pcd <options>\n", argv[0]);
+  print_info ("  where options are:\n");
+  print_info ("                     -threshold X  = the inlier distance threshold (default: "); 
+  print_value ("%f", default_threshold); print_info (")\n");
+  print_info ("                     -iterations X = number of runs averaged for every measurement (default: "); 
+  print_value ("%d", default_iterations); print_info (")\n");
+}
+
+bool
+loadCloud (const std::string &filename, PointCloud<PointXYZ> &cloud)
+{
+  TicToc tt;
+  print_highlight ("Loading "); print_value ("%s ", filename.c_str ());
+
+  tt.tic ();
+  if (loadPCDFile (filename, cloud) < 0)
+    return (false);
+  print_info ("[done, "); print_value ("%g", tt.toc ()); print_info (" ms : "); print_value ("%d", cloud.width * cloud.height); print_info (" points]\n");
+
+  return (true);
+}
+
+/** \brief Scalar reference implementations of the point to model distances, as computed before vectorization. */
+struct ScalarPlane
+{
+  static double
+  distance (const PointXYZ &p, const PointCloud<Normal> &, int, const Eigen::VectorXf &c)
+  {
+    return (fabs (c.dot (Eigen::Vector4f (p.x, p.y, p.z, 1))));
+  }
+};
+
+struct ScalarSphere
+{
+  static double
+  distance (const PointXYZ &p, const PointCloud<Normal> &, int, const Eigen::VectorXf &c)
+  {
+    return (fabs (sqrtf ((p.x - c[0]) * (p.x - c[0]) + (p.y - c[1]) * (p.y - c[1]) + (p.z - c[2]) * (p.z - c[2])) - c[3]));
+  }
+};
+
+struct ScalarCircle2D
+{
+  static double
+  distance (const PointXYZ &p, const PointCloud<Normal> &, int, const Eigen::VectorXf &c)
+  {
+    return (fabsf (sqrtf ((p.x - c[0]) * (p.x - c[0]) + (p.y - c[1]) * (p.y - c[1])) - c[2]));
+  }
+};
+
+struct ScalarLine
+{
+  static double
+  distance (const PointXYZ &p, const PointCloud<Normal> &, int, const Eigen::VectorXf &c)
+  {
+    Eigen::Vector4f line_pt  (c[0], c[1], c[2], 0);
+    Eigen::Vector4f line_dir (c[3], c[4], c[5], 0);
+    line_dir.normalize ();
+    return (sqrt ((line_pt - p.getVector4fMap ()).cross3 (line_dir).squaredNorm ()));
+  }
+};
+
+struct ScalarCylinder
+{
+  static double
+  distance (const PointXYZ &p, const PointCloud<Normal> &normals, int index, const Eigen::VectorXf &c)
+  {
+    Eigen::Vector4f line_pt  (c[0], c[1], c[2], 0);
+    Eigen::Vector4f line_dir (c[3], c[4], c[5], 0);
+    Eigen::Vector4f pt (p.x, p.y, p.z, 0);
+    Eigen::Vector4f n  (normals.points[index].normal[0], normals.points[index].normal[1], normals.points[index].normal[2], 0);
+    double d_euclid = fabs (sqrt (sqrPointToLineDistance (pt, line_pt, line_dir)) - c[6]);
+
+    float k = (pt.dot (line_dir) - line_pt.dot (line_dir)) / line_dir.dot (line_dir);
+    Eigen::Vector4f dir = pt - (line_pt + k * line_dir);
+    dir.normalize ();
+    double d_normal = fabs (getAngle3D (n, dir));
+    d_normal = (std::min) (d_normal, M_PI - d_normal);
+    // The benchmark uses a normal distance weight of 0.1
+    return (fabs (0.1 * d_normal + 0.9 * d_euclid));
+  }
+};
+
+/** \brief Time the scalar reference loop and the model's countWithinDistance, and print the average time per run, in us. */
+template <typename Scalar> void
+benchmark (const char *name, SampleConsensusModel<PointXYZ> &model, const PointCloud<Normal> &normals,
+           const Eigen::VectorXf &coefficients, double threshold, int iterations)
+{
+  const PointCloud<PointXYZ> &cloud = *model.getInputCloud ();
+  const std::vector<int> &indices = *model.getIndices ();
+  TicToc tt;
+
+  int reference_count = 0;
+  tt.tic ();
+  for (int it = 0; it < iterations; ++it)
+  {
+    reference_count = 0;
+    for (size_t i = 0; i < indices.size (); ++i)
+      if (Scalar::distance (cloud.points[indices[i]], normals, indices[i], coefficients) < threshold)
+        ++reference_count;
+  }
+  double reference_time = tt.toc () * 1000.0 / iterations;
+
+  int count = 0;
+  tt.tic ();
+  for (int it = 0; it < iterations; ++it)
+    count = model.countWithinDistance (coefficients, threshold);
+  double time = tt.toc () * 1000.0 / iterations;
+
+  print_info ("%-10s : scalar ", name); print_value ("%10.2f", reference_time); 
+  print_info (" us, vectorized "); print_value ("%10.2f", time); 
+  print_info (" us, speedup "); print_value ("%5.2f", reference_time / time);
+  print_info (", inliers "); print_value ("%d", count);
+  if (count == reference_count)
+    print_info (" (identical)\n");
+  else
+    print_error (" (scalar loop found %d)\n", reference_count);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Benchmark the point to model distance kernels of the sample consensus models. For more information, use: %s -h\n", argv[0]);
+
+  if (argc < 2)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  // Parse the command line arguments for .pcd files
+  std::vector<int> p_file_indices;
+  p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
+  if (p_file_indices.size () != 1)
+  {
+    print_error ("Need one input PCD file to continue.\n");
+    return (-1);
+  }
+
+  // Command line parsing
+  double threshold = default_threshold;
+  parse_argument (argc, argv, "-threshold", threshold);
+  int iterations = default_iterations;
+  parse_argument (argc, argv, "-iterations", iterations);
+  if (iterations < 1)
+  {
+    print_error ("The number of iterations must be positive.\n");
+    return (-1);
+  }
+  print_info ("Processing "); print_value ("%d", sac_simd::PACKET_SIZE); print_info (" points at a time\n");
+
+  // Load the first file
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  if (!loadCloud (argv[p_file_indices[0]], *cloud)) 
+    return (-1);
+
+  // Place every model around the centroid of the cloud, so that part of the points are inliers
+  Eigen::Vector4f centroid;
+  compute3DCentroid (*cloud, centroid);
+  double mean_radius = 0;
+  for (size_t i = 0; i < cloud->points.size (); ++i)
+    mean_radius += (cloud->points[i].getVector4fMap () - centroid).head<3> ().norm ();
+  mean_radius /= static_cast<double> (cloud->points.size ());
+
+  // The cylinder model needs normals: use the directions from the centroid, the timings do not depend on them
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  normals->points.resize (cloud->points.size ());
+  for (size_t i = 0; i < cloud->points.size (); ++i)
+    normals->points[i].getNormalVector4fMap () = (cloud->points[i].getVector4fMap () - centroid).normalized ();
+
+  Eigen::VectorXf plane (4), sphere (4), circle (3), line (6), cylinder (7);
+  plane    << 0, 0, 1, -centroid[2];
+  sphere   << centroid[0], centroid[1], centroid[2], static_cast<float> (mean_radius);
+  circle   << centroid[0], centroid[1], static_cast<float> (mean_radius);
+  line     << centroid[0], centroid[1], centroid[2], 1, 0, 0;
+  cylinder << centroid[0], centroid[1], centroid[2], 0, 0, 1, static_cast<float> (mean_radius);
+
+  SampleConsensusModelPlane<PointXYZ> plane_model (cloud);
+  SampleConsensusModelSphere<PointXYZ> sphere_model (cloud);
+  SampleConsensusModelCircle2D<PointXYZ> circle_model (cloud);
+  SampleConsensusModelLine<PointXYZ> line_model (cloud);
+  SampleConsensusModelCylinder<PointXYZ, Normal> cylinder_model (cloud);
+  cylinder_model.setInputNormals (normals);
+  cylinder_model.setNormalDistanceWeight (0.1);
+
+  benchmark<ScalarPlane> ("Plane", plane_model, *normals, plane, threshold, iterations);
+  benchmark<ScalarSphere> ("Sphere", sphere_model, *normals, sphere, threshold, iterations);
+  benchmark<ScalarCircle2D> ("Circle2D", circle_model, *normals, circle, threshold, iterations);
+  benchmark<ScalarLine> ("Line", line_model, *normals, line, threshold, iterations);
+  benchmark<ScalarCylinder> ("Cylinder", cylinder_model, *normals, cylinder, threshold, iterations);
+
+  return (0);
+}
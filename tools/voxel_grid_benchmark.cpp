@@ -0,0 +1,189 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/filters/voxel_grid_omp.h>
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/time.h>
+
+using namespace pcl;
+using namespace pcl::io;
+using namespace pcl::console;
+
+float default_leaf_size = 0.01f;
+int   default_max_threads = 8;
+int   default_iterations = 10;
+
+void
+printHelp (int, char **argv)
+{
+  print_error ("Syntax is: %s input.pcd <options>\n", argv[0]);
+  print_info ("  where options are:\n");
+  print_info ("                     -leaf x,y,z   = the VoxelGrid leaf size (default: "); 
+  print_value ("%f, %f, %f", default_leaf_size, default_leaf_size, default_leaf_size); print_info (")\n");
+  print_info ("                     -threads X    = benchmark VoxelGridOMP with 1 up to this number of threads (default: "); 
+  print_value ("%d", default_max_threads); print_info (")\n");
+  print_info ("                     -iterations X = number of runs averaged for every measurement (default: "); 
+  print_value ("%d", default_iterations); print_info (")\n");
+}
+
+bool
+loadCloud (const std::string &filename, PointCloud<PointXYZ> &cloud)
+{
+  TicToc tt;
+  print_highlight ("Loading "); print_value ("%s ", filename.c_str ());
+
+  tt.tic ();
+  if (loadPCDFile (filename, cloud) < 0)
+    return (false);
+  print_info ("[done, "); print_value ("%g", tt.toc ()); print_info (" ms : "); print_value ("%d", cloud.width * cloud.height); print_info (" points]\n");
+
+  return (true);
+}
+
+/** \brief Run the filter \a iterations times and return the average time per run, in ms. */
+double
+benchmark (Filter<PointXYZ> &grid, int iterations, PointCloud<PointXYZ> &output)
+{
+  TicToc tt;
+  tt.tic ();
+  for (int i = 0; i < iterations; ++i)
+    grid.filter (output);
+  return (tt.toc () / iterations);
+}
+
+/** \brief Check that two downsampled clouds hold exactly the same centroids. */
+bool
+isIdentical (const PointCloud<PointXYZ> &a, const PointCloud<PointXYZ> &b)
+{
+  if (a.points.size () != b.points.size ())
+    return (false);
+  for (size_t i = 0; i < a.points.size (); ++i)
+    if (a.points[i].x != b.points[i].x || a.points[i].y != b.points[i].y || a.points[i].z != b.points[i].z)
+      return (false);
+  return (true);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Benchmark pcl::VoxelGrid against pcl::VoxelGridOMP. For more information, use: %s -h\n", argv[0]);
+
+  if (argc < 2)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  // Parse the command line arguments for .pcd files
+  std::vector<int> p_file_indices;
+  p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
+  if (p_file_indices.size () != 1)
+  {
+    print_error ("Need one input PCD file to continue.\n");
+    return (-1);
+  }
+
+  // Command line parsing
+  float leaf_x = default_leaf_size,
+        leaf_y = default_leaf_size,
+        leaf_z = default_leaf_size;
+
+  std::vector<double> values;
+  parse_x_arguments (argc, argv, "-leaf", values);
+  if (values.size () == 1)
+  {
+    leaf_x = static_cast<float> (values[0]);
+    leaf_y = static_cast<float> (values[0]);
+    leaf_z = static_cast<float> (values[0]);
+  }
+  else if (values.size () == 3)
+  {
+    leaf_x = static_cast<float> (values[0]);
+    leaf_y = static_cast<float> (values[1]);
+    leaf_z = static_cast<float> (values[2]);
+  }
+  print_info ("Using a leaf size of: "); print_value ("%f, %f, %f\n", leaf_x, leaf_y, leaf_z);
+
+  int max_threads = default_max_threads;
+  parse_argument (argc, argv, "-threads", max_threads);
+  int iterations = default_iterations;
+  parse_argument (argc, argv, "-iterations", iterations);
+  if (max_threads < 1 || iterations < 1)
+  {
+    print_error ("The number of threads and iterations must be positive.\n");
+    return (-1);
+  }
+
+  // Load the first file
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  if (!loadCloud (argv[p_file_indices[0]], *cloud)) 
+    return (-1);
+  const double nr_points = static_cast<double> (cloud->width * cloud->height);
+
+  // The serial filter is the reference, both for the output and for the timings
+  PointCloud<PointXYZ> reference;
+  VoxelGrid<PointXYZ> grid;
+  grid.setInputCloud (cloud);
+  grid.setLeafSize (leaf_x, leaf_y, leaf_z);
+  double reference_time = benchmark (grid, iterations, reference);
+  print_info ("VoxelGrid            : "); print_value ("%10.3f", reference_time); print_info (" ms, ");
+  print_value ("%12.0f", nr_points / reference_time * 1000.0); print_info (" points/s, ");
+  print_value ("%d", reference.width); print_info (" output points\n");
+
+  for (int nr_threads = 1; nr_threads <= max_threads; ++nr_threads)
+  {
+    PointCloud<PointXYZ> output;
+    VoxelGridOMP<PointXYZ> grid_omp (nr_threads);
+    grid_omp.setInputCloud (cloud);
+    grid_omp.setLeafSize (leaf_x, leaf_y, leaf_z);
+    double time = benchmark (grid_omp, iterations, output);
+    print_info ("VoxelGridOMP (%2d thr) : ", nr_threads); print_value ("%10.3f", time); print_info (" ms, ");
+    print_value ("%12.0f", nr_points / time * 1000.0); print_info (" points/s, speedup ");
+    print_value ("%5.2f", reference_time / time);
+    if (isIdentical (reference, output))
+      print_info (", identical output\n");
+    else
+      print_error (", output differs from VoxelGrid!\n");
+  }
+
+  return (0);
+}